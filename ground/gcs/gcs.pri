@@ -267,6 +267,12 @@ win32 {
 # Explicit setting of C++11
 CONFIG += c++11
 
+# Compile the QML files found in the resources ahead of time (Qt 5.11 or newer)
+# add "no_qml_precompile" to your root config file to load them from source
+!no_qml_precompile:greaterThan(QT_MAJOR_VERSION, 4):greaterThan(QT_MINOR_VERSION, 10) {
+    CONFIG += qtquickcompiler
+}
+
 address_sanitizer {
     # enable asan by adding "address_sanitizer" to your root config file
     # see https://github.com/google/sanitizers
@@ -29,6 +29,12 @@
 #include "aggregate.h"
 
 #include <QtCore/QWriteLocker>
+#include <QtCore/QAtomicInt>
+
+namespace {
+// bumped whenever any aggregate changes its components, see Aggregate::revision()
+QAtomicInt aggregateRevision;
+}
 
 /*!
     \namespace Aggregation
@@ -213,6 +219,7 @@ Aggregate::~Aggregate()
     qDeleteAll(m_components);
     m_components.clear();
     aggregateMap().remove(this);
+    aggregateRevision.ref();
 }
 
 void Aggregate::deleteSelf(QObject *obj)
@@ -221,6 +228,7 @@ void Aggregate::deleteSelf(QObject *obj)
         QWriteLocker locker(&lock());
         aggregateMap().remove(obj);
         m_components.removeAll(obj);
+        aggregateRevision.ref();
     }
     delete this;
 }
@@ -248,6 +256,7 @@ void Aggregate::add(QObject *component)
     m_components.append(component);
     connect(component, SIGNAL(destroyed(QObject *)), this, SLOT(deleteSelf(QObject *)));
     aggregateMap().insert(component, this);
+    aggregateRevision.ref();
 }
 
 /*!
@@ -266,4 +275,16 @@ void Aggregate::remove(QObject *component)
     aggregateMap().remove(component);
     m_components.removeAll(component);
     disconnect(component, SIGNAL(destroyed(QObject *)), this, SLOT(deleteSelf(QObject *)));
+    aggregateRevision.ref();
+}
+
+/*!
+    \fn int Aggregate::revision()
+
+    Returns a counter that changes whenever the components of any aggregate change.
+    Used by caches of query() results to detect that they are stale.
+ */
+int Aggregate::revision()
+{
+    return aggregateRevision.load();
 }
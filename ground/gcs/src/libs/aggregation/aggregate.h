@@ -73,6 +73,7 @@ public:
 
     static Aggregate *parentAggregate(QObject *obj);
     static QReadWriteLock &lock();
+    static int revision();
 
 private slots:
     void deleteSelf(QObject *obj);
@@ -27,6 +27,7 @@
  */
 
 #include "optionsparser.h"
+#include "startuptrace.h"
 
 #include <QtCore/QCoreApplication>
 
@@ -36,6 +37,7 @@ using namespace ExtensionSystem::Internal;
 static const char *END_OF_OPTIONS = "--";
 const char *OptionsParser::NO_LOAD_OPTION = "-noload";
 const char *OptionsParser::TEST_OPTION    = "-test";
+const char *OptionsParser::TRACE_STARTUP_OPTION = "-trace-startup";
 
 OptionsParser::OptionsParser(const QStringList &args,
                              const QMap<QString, bool> &appOptions,
@@ -76,6 +78,9 @@ bool OptionsParser::parse()
         if (checkForTestOption()) {
             continue;
         }
+        if (checkForTraceStartupOption()) {
+            continue;
+        }
         if (checkForAppOption()) {
             continue;
         }
@@ -125,6 +130,17 @@ bool OptionsParser::checkForTestOption()
     return true;
 }
 
+bool OptionsParser::checkForTraceStartupOption()
+{
+    if (m_currentArg != QLatin1String(TRACE_STARTUP_OPTION)) {
+        return false;
+    }
+    if (nextToken(RequiredToken)) {
+        StartupTrace::setOutputFile(m_currentArg);
+    }
+    return true;
+}
+
 bool OptionsParser::checkForNoLoadOption()
 {
     if (m_currentArg != QLatin1String(NO_LOAD_OPTION)) {
@@ -32,11 +32,13 @@
 #include "pluginspec_p.h"
 #include "optionsparser.h"
 #include "iplugin.h"
+#include "startuptrace.h"
 
 #include <QtCore/QMetaProperty>
 #include <QtCore/QDir>
 #include <QtCore/QTextStream>
 #include <QtCore/QWriteLocker>
+#include <QtConcurrent/QtConcurrentMap>
 #include <QtDebug>
 #ifdef WITH_TESTS
 #include <QTest>
@@ -231,6 +233,38 @@ QList<QObject *> PluginManager::allObjects() const
     return d->allObjects;
 }
 
+/*!
+    \fn QList<QObject *> PluginManager::objectsOfType(const QMetaObject *type, ObjectQuery query) const
+    \internal
+    Returns the pool objects (or aggregate components) of \a type, in pool order.
+    The result of running \a query over the pool is cached per type until an object
+    is added or removed, or an aggregate changes.
+ */
+QList<QObject *> PluginManager::objectsOfType(const QMetaObject *type, ObjectQuery query) const
+{
+    QReadLocker lock(&m_lock);
+    QMutexLocker cacheLock(&d->typeCacheMutex);
+
+    const int revision = Aggregation::Aggregate::revision();
+
+    if (revision != d->typeCacheRevision) {
+        d->typeCache.clear();
+        d->typeCacheRevision = revision;
+    }
+
+    QHash<const QMetaObject *, QList<QObject *> >::const_iterator it = d->typeCache.constFind(type);
+    if (it != d->typeCache.constEnd()) {
+        return it.value();
+    }
+
+    QList<QObject *> results;
+    foreach(QObject * obj, d->allObjects) {
+        results += query(obj);
+    }
+    d->typeCache.insert(type, results);
+    return results;
+}
+
 /*!
     \fn void PluginManager::loadPlugins()
     Tries to load all the plugins that were previously found when
@@ -382,6 +416,9 @@ void PluginManager::formatOptions(QTextStream &str, int optionIndentation, int d
     formatOption(str, QLatin1String(OptionsParser::NO_LOAD_OPTION),
                  QLatin1String("plugin"), QLatin1String("Do not load <plugin>"),
                  optionIndentation, descriptionIndentation);
+    formatOption(str, QLatin1String(OptionsParser::TRACE_STARTUP_OPTION),
+                 QLatin1String("file"), QLatin1String("Write a Chrome trace of the startup to <file>"),
+                 optionIndentation, descriptionIndentation);
 }
 
 /*!
@@ -494,7 +531,7 @@ PluginSpecPrivate *PluginManagerPrivate::privateSpec(PluginSpec *spec)
     \internal
  */
 PluginManagerPrivate::PluginManagerPrivate(PluginManager *pluginManager)
-    : extension("xml"), q(pluginManager)
+    : extension("xml"), typeCacheRevision(0), q(pluginManager)
 {}
 
 /*!
@@ -545,6 +582,7 @@ void PluginManagerPrivate::addObject(QObject *obj)
         }
 
         allObjects.append(obj);
+        typeCache.clear();
     }
     emit q->objectAdded(obj);
 }
@@ -572,6 +610,18 @@ void PluginManagerPrivate::removeObject(QObject *obj)
     emit q->aboutToRemoveObject(obj);
     QWriteLocker lock(&(q->m_lock));
     allObjects.removeAll(obj);
+    typeCache.clear();
+}
+
+/*!
+    \fn void PluginManagerPrivate::preloadLibrary(PluginSpec * &spec)
+    \internal
+ */
+void PluginManagerPrivate::preloadLibrary(PluginSpec * &spec)
+{
+    StartupTrace::Scope trace("preload", spec->name());
+
+    spec->d->preloadLibrary();
 }
 
 /*!
@@ -581,6 +631,24 @@ void PluginManagerPrivate::removeObject(QObject *obj)
 void PluginManagerPrivate::loadPlugins()
 {
     QList<PluginSpec *> queue = loadQueue();
+
+    // Map the plugin libraries on the thread pool first, reading them and
+    // running their static initialization overlap as far as the platform
+    // dynamic loader allows. The load order does not matter for this, each
+    // library links against the libraries of its dependencies.
+    // Creating the plugin instances and all later steps stay in queue order
+    // on the main thread.
+    QList<PluginSpec *> preloadQueue;
+    foreach(PluginSpec * spec, queue) {
+        if (!spec->hasError() && spec->state() == PluginSpec::Resolved) {
+            preloadQueue.append(spec);
+        }
+    }
+    {
+        StartupTrace::Scope trace("startup", QLatin1String("preloadLibraries"));
+        QtConcurrent::blockingMap(preloadQueue, &PluginManagerPrivate::preloadLibrary);
+    }
+
     foreach(PluginSpec * spec, queue) {
         loadPlugin(spec, PluginSpec::Loaded);
     }
@@ -597,6 +665,10 @@ void PluginManagerPrivate::loadPlugins()
     emit q->pluginsChanged();
     q->m_allPluginsLoaded = true;
     emit q->pluginsLoadEnded();
+
+    if (!StartupTrace::outputFile().isEmpty()) {
+        StartupTrace::write();
+    }
 }
 
 /*!
@@ -668,6 +740,7 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
         return;
     }
     if (destState == PluginSpec::Running) {
+        StartupTrace::Scope trace("extensionsInitialized", spec->name());
         spec->d->initializeExtensions();
         return;
     } else if (destState == PluginSpec::Deleted) {
@@ -684,8 +757,10 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
         }
     }
     if (destState == PluginSpec::Loaded) {
+        StartupTrace::Scope trace("load", spec->name());
         spec->d->loadLibrary();
     } else if (destState == PluginSpec::Initialized) {
+        StartupTrace::Scope trace("initialize", spec->name());
         spec->d->initializePlugin();
     } else if (destState == PluginSpec::Stopped) {
         spec->d->stop();
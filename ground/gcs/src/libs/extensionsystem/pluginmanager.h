@@ -67,31 +67,17 @@ public:
     QList<QObject *> allObjects() const;
     template <typename T> QList<T *> getObjects() const
     {
-        QReadLocker lock(&m_lock);
-
         QList<T *> results;
-        QList<QObject *> all = allObjects();
-        QList<T *> result;
-        foreach(QObject * obj, all) {
-            result = Aggregation::query_all<T>(obj);
-            if (!result.isEmpty()) {
-                results += result;
-            }
+        foreach(QObject * obj, objectsOfType(&T::staticMetaObject, &queryObjects<T>)) {
+            results.append(static_cast<T *>(obj));
         }
         return results;
     }
     template <typename T> T *getObject() const
     {
-        QReadLocker lock(&m_lock);
-
-        QList<QObject *> all = allObjects();
-        T *result = 0;
-        foreach(QObject * obj, all) {
-            if ((result = Aggregation::query<T>(obj)) != 0) {
-                break;
-            }
-        }
-        return result;
+        const QList<QObject *> objects = objectsOfType(&T::staticMetaObject, &queryObjects<T>);
+
+        return objects.isEmpty() ? 0 : static_cast<T *>(objects.first());
     }
 
     // Plugin operations
@@ -126,6 +112,17 @@ private slots:
     void startTests();
 
 private:
+    typedef QList<QObject *> (*ObjectQuery)(QObject *obj);
+    template <typename T> static QList<QObject *> queryObjects(QObject *obj)
+    {
+        QList<QObject *> results;
+        foreach(T * result, Aggregation::query_all<T>(obj)) {
+            results.append(result);
+        }
+        return results;
+    }
+    QList<QObject *> objectsOfType(const QMetaObject *type, ObjectQuery query) const;
+
     Internal::PluginManagerPrivate *d;
     static PluginManager *m_instance;
     mutable QReadWriteLock m_lock;
@@ -31,7 +31,9 @@
 
 #include "pluginspec.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QList>
+#include <QtCore/QMutex>
 #include <QtCore/QSet>
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
@@ -64,6 +66,11 @@ public:
     QString extension;
     QList<QObject *> allObjects; // ### make this a QList<QPointer<QObject> > > ?
 
+    // getObject()/getObjects() results per type, flushed when the pool or an aggregate changes
+    QHash<const QMetaObject *, QList<QObject *> > typeCache;
+    int typeCacheRevision;
+    QMutex typeCacheMutex; // readers only hold the pool lock for reading
+
     QStringList arguments;
 
     // Look in argument descriptions of the specs for the option.
@@ -81,6 +88,7 @@ private:
                    QList<PluginSpec *> &queue,
                    QList<PluginSpec *> &circularityCheckQueue);
     void stopAll();
+    static void preloadLibrary(PluginSpec * &spec);
 };
 } // namespace Internal
 } // namespace ExtensionSystem
@@ -770,22 +770,11 @@ bool PluginSpecPrivate::resolveDependencies(const QList<PluginSpec *> &specs)
 }
 
 /*!
-    \fn bool PluginSpecPrivate::loadLibrary()
+    \fn QString PluginSpecPrivate::libraryPath() const
     \internal
  */
-bool PluginSpecPrivate::loadLibrary()
+QString PluginSpecPrivate::libraryPath() const
 {
-    if (hasError) {
-        return false;
-    }
-    if (state != PluginSpec::Resolved) {
-        if (state == PluginSpec::Loaded) {
-            return true;
-        }
-        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
-        hasError    = true;
-        return false;
-    }
 #ifdef QT_NO_DEBUG
 
 #ifdef Q_OS_WIN
@@ -807,6 +796,42 @@ bool PluginSpecPrivate::loadLibrary()
 #endif
 
 #endif
+    return libName;
+}
+
+/*!
+    \fn void PluginSpecPrivate::preloadLibrary() const
+    \internal
+
+    Map the plugin library without creating the plugin instance, so that loadLibrary()
+    finds it loaded already. Only reads the spec, it is safe to call from other threads.
+    Errors are ignored here, loadLibrary() reports them.
+ */
+void PluginSpecPrivate::preloadLibrary() const
+{
+    PluginLoader loader(libraryPath());
+
+    loader.load();
+}
+
+/*!
+    \fn bool PluginSpecPrivate::loadLibrary()
+    \internal
+ */
+bool PluginSpecPrivate::loadLibrary()
+{
+    if (hasError) {
+        return false;
+    }
+    if (state != PluginSpec::Resolved) {
+        if (state == PluginSpec::Loaded) {
+            return true;
+        }
+        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
+        hasError    = true;
+        return false;
+    }
+    QString libName = libraryPath();
 
     PluginLoader loader(libName);
     if (!loader.load()) {
@@ -30,6 +30,7 @@
 #include "pluginview_p.h"
 #include "pluginmanager.h"
 #include "pluginspec.h"
+#include "startuptrace.h"
 #include "ui_pluginview.h"
 
 #include <QtCore/QDir>
@@ -125,9 +126,12 @@ void PluginView::updateList()
                                                     << spec->name()
                                                     << QString("%1 (%2)").arg(spec->version()).arg(spec->compatVersion())
                                                     << spec->vendor()
+                                                    << QString("%1 ms").arg(StartupTrace::duration(spec->name()) / 1000.0, 0, 'f', 1)
                                                     << QDir::toNativeSeparators(spec->filePath()));
 
-        item->setToolTip(4, QDir::toNativeSeparators(spec->filePath()));
+        item->setToolTip(4, tr("Time spent loading and initializing the plugin, resident memory grew by %1 kB")
+                         .arg(StartupTrace::memoryDelta(spec->name()) / 1024));
+        item->setToolTip(5, QDir::toNativeSeparators(spec->filePath()));
         item->setIcon(0, spec->hasError() ? errorIcon : okIcon);
         item->setData(0, Qt::UserRole, qVariantFromValue(spec));
         items.append(item);
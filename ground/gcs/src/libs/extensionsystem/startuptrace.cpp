@@ -0,0 +1,216 @@
+/**
+ ******************************************************************************
+ *
+ * @file       startuptrace.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Records the wall time and memory of the GCS startup phases
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "startuptrace.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtDebug>
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#  include <psapi.h>
+#elif defined(Q_OS_MAC)
+#  include <mach/mach.h>
+#elif defined(Q_OS_LINUX)
+#  include <unistd.h>
+#endif
+
+namespace {
+struct TraceEvent {
+    const char *category;
+    QString     name;
+    qint64      start; // us since the first event
+    qint64      duration; // us
+    qint64      memory; // bytes, resident memory growth
+    quintptr    thread;
+};
+
+struct TraceData {
+    TraceData()
+    {
+        clock.start();
+    }
+    QMutex mutex;
+    QElapsedTimer clock;
+    QVector<TraceEvent> events;
+    QString outputFile;
+};
+
+TraceData *traceData()
+{
+    static TraceData data;
+
+    return &data;
+}
+
+QByteArray jsonString(const QString &str)
+{
+    QByteArray out = str.toUtf8();
+
+    out.replace('\\', "\\\\").replace('"', "\\\"");
+    return out;
+}
+}
+
+namespace ExtensionSystem {
+StartupTrace::Scope::Scope(const char *category, const QString &name) :
+    m_category(category), m_name(name)
+{
+    m_memory = residentMemory();
+    m_start  = traceData()->clock.nsecsElapsed() / 1000;
+}
+
+StartupTrace::Scope::~Scope()
+{
+    TraceData *data = traceData();
+    TraceEvent event;
+
+    event.category = m_category;
+    event.name     = m_name;
+    event.start    = m_start;
+    event.duration = data->clock.nsecsElapsed() / 1000 - m_start;
+    qint64 memory = residentMemory();
+    event.memory   = (memory >= 0 && m_memory >= 0) ? memory - m_memory : 0;
+    event.thread   = (quintptr)QThread::currentThreadId();
+
+    QMutexLocker locker(&data->mutex);
+    data->events.append(event);
+}
+
+void StartupTrace::setOutputFile(const QString &fileName)
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+
+    data->outputFile = fileName;
+}
+
+QString StartupTrace::outputFile()
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+
+    return data->outputFile;
+}
+
+/**
+ * Write all events recorded so far in the Chrome trace event format.
+ * @returns false if there is no output file or it can't be written
+ */
+bool StartupTrace::write()
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+
+    if (data->outputFile.isEmpty()) {
+        return false;
+    }
+    QFile file(data->outputFile);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "StartupTrace - can't write" << data->outputFile << file.errorString();
+        return false;
+    }
+
+    qint64 pid = QCoreApplication::applicationPid();
+    file.write("{\"traceEvents\":[\n");
+    for (int i = 0; i < data->events.size(); i++) {
+        const TraceEvent &event = data->events.at(i);
+        file.write(QString("%1{\"name\":\"").arg(i > 0 ? "," : "").toLatin1());
+        file.write(jsonString(event.name));
+        file.write(QString("\",\"cat\":\"%1\",\"ph\":\"X\",\"ts\":%2,\"dur\":%3,\"pid\":%4,\"tid\":%5,"
+                           "\"args\":{\"memoryDelta\":%6}}\n")
+                   .arg(event.category).arg(event.start).arg(event.duration).arg(pid)
+                   .arg((qulonglong)event.thread).arg(event.memory).toLatin1());
+    }
+    file.write("],\"displayTimeUnit\":\"ms\"}\n");
+    return file.error() == QFile::NoError;
+}
+
+qint64 StartupTrace::duration(const QString &name)
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    qint64 total = 0;
+
+    foreach(const TraceEvent &event, data->events) {
+        if (event.name == name) {
+            total += event.duration;
+        }
+    }
+    return total;
+}
+
+qint64 StartupTrace::memoryDelta(const QString &name)
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    qint64 total = 0;
+
+    foreach(const TraceEvent &event, data->events) {
+        if (event.name == name) {
+            total += event.memory;
+        }
+    }
+    return total;
+}
+
+qint64 StartupTrace::residentMemory()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return -1;
+
+#elif defined(Q_OS_MAC)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS) {
+        return info.resident_size;
+    }
+    return -1;
+
+#elif defined(Q_OS_LINUX)
+    // second field of statm is the resident set in pages
+    QFile statm("/proc/self/statm");
+    if (statm.open(QFile::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+    return -1;
+
+#else
+    return -1;
+
+#endif
+}
+} // namespace ExtensionSystem
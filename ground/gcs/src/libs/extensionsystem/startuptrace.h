@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ *
+ * @file       startuptrace.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Records the wall time and memory of the GCS startup phases
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef EXTENSIONSYSTEM_STARTUPTRACE_H
+#define EXTENSIONSYSTEM_STARTUPTRACE_H
+
+#include "extensionsystem_global.h"
+
+#include <QtCore/QString>
+
+namespace ExtensionSystem {
+/**
+ * Collects timed events of the application startup: the plugin load steps
+ * of the PluginManager and whatever else wraps itself in a Scope.
+ * The events are always recorded, there are only a few hundred of them.
+ * With the -trace-startup option they are written as Chrome tracing JSON
+ * (chrome://tracing, https://ui.perfetto.dev) once all plugins are loaded.
+ * Thread safe.
+ */
+class EXTENSIONSYSTEM_EXPORT StartupTrace {
+public:
+    /**
+     * Records one event from its construction to its destruction.
+     */
+    class EXTENSIONSYSTEM_EXPORT Scope {
+public:
+        Scope(const char *category, const QString &name);
+        ~Scope();
+
+private:
+        const char *m_category;
+        QString m_name;
+        qint64 m_start;
+        qint64 m_memory;
+
+        Q_DISABLE_COPY(Scope)
+    };
+
+    // file written by write(), nothing is written while empty
+    static void setOutputFile(const QString &fileName);
+    static QString outputFile();
+    static bool write();
+
+    // accumulated duration in us and resident memory growth in bytes of the
+    // events with this name
+    static qint64 duration(const QString &name);
+    static qint64 memoryDelta(const QString &name);
+
+    // resident memory of the process in bytes, -1 if unknown on this platform
+    static qint64 residentMemory();
+};
+} // namespace ExtensionSystem
+
+#endif // EXTENSIONSYSTEM_STARTUPTRACE_H
@@ -36,31 +36,36 @@ static GstBusSyncReply my_bus_sync_func(GstBus *bus, GstMessage *message, gpoint
 {
     Q_UNUSED(bus)
 
-    DeviceMonitor * dm;
+    DeviceMonitor *dm = (DeviceMonitor *)user_data;
     GstDevice *device;
-    gchar *name;
 
+    // the device is described here, on the monitor thread, so the slow caps query never blocks the GUI
     switch (GST_MESSAGE_TYPE(message)) {
     case GST_MESSAGE_DEVICE_ADDED:
+    {
         gst_message_parse_device_added(message, &device);
-        name = gst_device_get_display_name(device);
+        Device d = Device::fromGstDevice(device);
+        gst_object_unref(device);
 
-        dm   = (DeviceMonitor *)user_data;
         QMetaObject::invokeMethod(dm, "device_added", Qt::QueuedConnection,
-                                  Q_ARG(QString, QString(name)));
-
-        g_free(name);
+                                  Q_ARG(QString, d.displayName()), Q_ARG(QString, d.deviceClass()),
+                                  Q_ARG(QString, d.caps()));
         break;
+    }
     case GST_MESSAGE_DEVICE_REMOVED:
+    {
         gst_message_parse_device_removed(message, &device);
-        name = gst_device_get_display_name(device);
+        gchar *name         = gst_device_get_display_name(device);
+        gchar *device_class = gst_device_get_device_class(device);
+        gst_object_unref(device);
 
-        dm   = (DeviceMonitor *)user_data;
         QMetaObject::invokeMethod(dm, "device_removed", Qt::QueuedConnection,
-                                  Q_ARG(QString, QString(name)));
+                                  Q_ARG(QString, QString(name)), Q_ARG(QString, QString(device_class)));
 
         g_free(name);
+        g_free(device_class);
         break;
+    }
     default:
         break;
     }
@@ -89,6 +94,17 @@ DeviceMonitor::DeviceMonitor(QObject *parent) : QObject(parent)
 
     if (!gst_device_monitor_start(monitor)) {
         qWarning() << "Failed to start device monitor";
+        return;
+    }
+
+    // devices already present are not announced on the bus, list them once
+    GList *list = gst_device_monitor_get_devices(monitor);
+    while (list != NULL) {
+        GstDevice *device = (GstDevice *)list->data;
+        m_devices << Device::fromGstDevice(device);
+
+        gst_object_unref(device);
+        list = g_list_remove_link(list, list);
     }
 }
 
@@ -98,39 +114,61 @@ DeviceMonitor::~DeviceMonitor()
     gst_object_unref(monitor);
 }
 
-QList<Device> DeviceMonitor::devices() const
+Device Device::fromGstDevice(GstDevice *device)
 {
-    QList<Device> devices;
+    gchar *name         = gst_device_get_display_name(device);
+    gchar *device_class = gst_device_get_device_class(device);
+    GstCaps *caps       = gst_device_get_caps(device);
+    gchar *caps_str     = caps ? gst_caps_to_string(caps) : NULL;
 
-    GList *list = gst_device_monitor_get_devices(monitor);
-    while (list != NULL) {
-        gchar *name;
-        gchar *device_class;
+    Device d(name, device_class, caps_str);
 
-        GstDevice *device = (GstDevice *)list->data;
-        name = gst_device_get_display_name(device);
-        device_class = gst_device_get_device_class(device);
-
-        devices << Device(name, device_class);
+    g_free(name);
+    g_free(device_class);
+    g_free(caps_str);
+    if (caps) {
+        gst_caps_unref(caps);
+    }
+    return d;
+}
 
-        g_free(name);
-        g_free(device_class);
+QList<Device> DeviceMonitor::devices() const
+{
+    return m_devices;
+}
 
-        gst_object_unref(device);
-        list = g_list_remove_link(list, list);
+int DeviceMonitor::indexOf(const QString &name, const QString &deviceClass) const
+{
+    for (int i = 0; i < m_devices.size(); i++) {
+        if (m_devices[i].displayName() == name && m_devices[i].deviceClass() == deviceClass) {
+            return i;
+        }
     }
-
-    return devices;
+    return -1;
 }
 
-void DeviceMonitor::device_added(QString name)
+void DeviceMonitor::device_added(QString name, QString deviceClass, QString caps)
 {
     // qDebug() << "**** ADDED:" << name;
+    // a device plugged while the initial list was built can be reported twice
+    int index = indexOf(name, deviceClass);
+
+    if (index >= 0) {
+        m_devices[index] = Device(name, deviceClass, caps);
+        return;
+    }
+    m_devices << Device(name, deviceClass, caps);
     emit deviceAdded(name);
 }
 
-void DeviceMonitor::device_removed(QString name)
+void DeviceMonitor::device_removed(QString name, QString deviceClass)
 {
     // qDebug() << "**** REMOVED:" << name;
+    int index = indexOf(name, deviceClass);
+
+    if (index < 0) {
+        return;
+    }
+    m_devices.removeAt(index);
     emit deviceRemoved(name);
 }
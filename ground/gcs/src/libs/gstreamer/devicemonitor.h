@@ -30,12 +30,15 @@
 #include "gst_global.h"
 
 #include <QObject>
+#include <QList>
 
 typedef struct _GstDeviceMonitor GstDeviceMonitor;
+typedef struct _GstDevice GstDevice;
 
 class Device {
 public:
-    Device(QString displayName, QString deviceClass) : m_displayName(displayName), m_deviceClass(deviceClass)
+    Device(QString displayName, QString deviceClass, QString caps = QString()) :
+        m_displayName(displayName), m_deviceClass(deviceClass), m_caps(caps)
     {}
     QString displayName() const
     {
@@ -45,9 +48,17 @@ public:
     {
         return m_deviceClass;
     }
+    // capabilities queried once when the device was found
+    QString caps() const
+    {
+        return m_caps;
+    }
+    static Device fromGstDevice(GstDevice *device);
+
 private:
     QString m_displayName;
     QString m_deviceClass;
+    QString m_caps;
 };
 
 class GST_LIB_EXPORT DeviceMonitor : public QObject {
@@ -56,6 +67,7 @@ public:
     DeviceMonitor(QObject *parent = NULL);
     virtual ~DeviceMonitor();
 
+    // cached list, kept up to date by the monitor bus messages
     QList<Device> devices() const;
 
 signals:
@@ -64,10 +76,13 @@ signals:
 
 private:
     GstDeviceMonitor *monitor;
+    QList<Device> m_devices;
+
+    int indexOf(const QString &name, const QString &deviceClass) const;
 
 private slots:
-    void device_added(QString name);
-    void device_removed(QString name);
+    void device_added(QString name, QString deviceClass, QString caps);
+    void device_removed(QString name, QString deviceClass);
 };
 
 #endif /* DEVICEMONITOR_H_ */
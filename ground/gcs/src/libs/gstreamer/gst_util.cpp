@@ -28,6 +28,8 @@
 
 #include <gst/gst.h>
 
+#include "plugins/sharedvideo/gstsharedvideosrc.h"
+
 #ifdef USE_OPENCV
 #include "plugins/cameracalibration/gstcameracalibration.h"
 #include "plugins/cameracalibration/gstcameraundistort.h"
@@ -39,8 +41,46 @@
 
 static bool initialized = false;
 
+// hardware decoders by API: VA-API, NVDEC, D3D11, VideoToolbox, Media SDK and V4L2 (SoCs)
+static const char *const hwDecoderNames[] = {
+    "vaapih264dec", "vaapih265dec", "vaapivp8dec", "vaapivp9dec", "vaapijpegdec",
+    "nvh264dec", "nvh265dec", "nvvp8dec", "nvvp9dec", "nvjpegdec", "nvv4l2decoder",
+    "d3d11h264dec", "d3d11h265dec", "d3d11vp8dec", "d3d11vp9dec",
+    "vtdec_hw",
+    "msdkh264dec", "msdkh265dec",
+    "v4l2h264dec", "v4l2h265dec",
+    NULL
+};
+
+static QStringList hwDecoders;
+
+/**
+ * Raise the hardware decoders above the software ones (avdec_h264 & co are PRIMARY) so that
+ * decodebin and the other autoplugging elements select them when present.
+ */
+static void preferHardwareDecoders()
+{
+    GstRegistry *reg = gst_registry_get();
+
+    for (int i = 0; hwDecoderNames[i]; i++) {
+        GstPluginFeature *feature = gst_registry_lookup_feature(reg, hwDecoderNames[i]);
+        if (!feature) {
+            continue;
+        }
+        if (gst_plugin_feature_get_rank(feature) < GST_RANK_PRIMARY + 1) {
+            gst_plugin_feature_set_rank(feature, GST_RANK_PRIMARY + 1);
+        }
+        hwDecoders << hwDecoderNames[i];
+        gst_object_unref(feature);
+    }
+    qDebug() << "gstreamer - hardware decoders:" << (hwDecoders.isEmpty() ? QStringList("none") : hwDecoders);
+}
+
 gboolean gst_plugin_librepilot_register(GstPlugin *plugin)
 {
+    if (!gst_shared_video_src_plugin_init(plugin)) {
+        return FALSE;
+    }
 #ifdef USE_OPENCV
     if (!gst_camera_calibration_plugin_init(plugin)) {
         return FALSE;
@@ -48,8 +88,6 @@ gboolean gst_plugin_librepilot_register(GstPlugin *plugin)
     if (!gst_camera_undistort_plugin_init(plugin)) {
         return FALSE;
     }
-#else
-    Q_UNUSED(plugin)
 #endif
     return TRUE;
 }
@@ -108,6 +146,8 @@ void gst::init(int *argc, char * *argv[])
     }
 #endif
 
+    preferHardwareDecoders();
+
 #ifdef USE_OPENCV
     // see http://stackoverflow.com/questions/32477403/how-to-know-if-sse2-is-activated-in-opencv
     // see http://answers.opencv.org/question/696/how-to-enable-vectorization-in-opencv/
@@ -134,3 +174,88 @@ QString gst::version(void)
     init(NULL, NULL);
     return QString(gst_version_string());
 }
+
+// jitter buffer latency in low latency mode, enough for a local link
+static const guint LOW_LATENCY_JITTER_MS = 20;
+
+static bool hasProperty(GstElement *element, const char *name)
+{
+    return g_object_class_find_property(G_OBJECT_GET_CLASS(element), name) != NULL;
+}
+
+static void setElementLowLatency(GstElement *element)
+{
+    GstElementFactory *factory = gst_element_get_factory(element);
+
+    if (!factory) {
+        return;
+    }
+    QString name(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)));
+
+    if (name == "queue") {
+        // keep a couple of frames and drop the old ones instead of blocking
+        g_object_set(element, "leaky", 2 /* downstream */, "max-size-buffers", 2, "max-size-bytes", 0, "max-size-time", (guint64)0, NULL);
+    } else if (name == "rtpjitterbuffer" || name == "rtspsrc") {
+        g_object_set(element, "latency", LOW_LATENCY_JITTER_MS, NULL);
+        if (hasProperty(element, "drop-on-latency")) {
+            g_object_set(element, "drop-on-latency", TRUE, NULL);
+        }
+    } else if (name == "appsink") {
+        g_object_set(element, "max-buffers", 1, "drop", TRUE, "sync", FALSE, NULL);
+    } else if (GST_OBJECT_FLAG_IS_SET(element, GST_ELEMENT_FLAG_SINK) && !GST_IS_BIN(element)) {
+        // render the frames as soon as they are decoded
+        if (hasProperty(element, "sync")) {
+            g_object_set(element, "sync", FALSE, NULL);
+        }
+    }
+}
+
+static void on_deep_element_added(GstBin *bin, GstBin *subBin, GstElement *element, gpointer data)
+{
+    Q_UNUSED(bin);
+    Q_UNUSED(subBin);
+    Q_UNUSED(data);
+    setElementLowLatency(element);
+}
+
+void gst::setLowLatency(GstElement *pipeline)
+{
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    GValue item     = G_VALUE_INIT;
+    bool done = false;
+
+    while (!done) {
+        switch (gst_iterator_next(it, &item)) {
+        case GST_ITERATOR_OK:
+            setElementLowLatency(GST_ELEMENT(g_value_get_object(&item)));
+            g_value_reset(&item);
+            break;
+        case GST_ITERATOR_RESYNC:
+            gst_iterator_resync(it);
+            break;
+        default:
+            done = true;
+            break;
+        }
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+
+    g_signal_connect(pipeline, "deep-element-added", G_CALLBACK(on_deep_element_added), NULL);
+}
+
+QStringList gst::hardwareDecoders()
+{
+    init(NULL, NULL);
+    return hwDecoders;
+}
+
+bool gst::isHardwareDecoder(const QString &factoryName)
+{
+    for (int i = 0; hwDecoderNames[i]; i++) {
+        if (factoryName == hwDecoderNames[i]) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -30,10 +30,19 @@
 #include "gst_global.h"
 
 #include <QString>
+#include <QStringList>
+
+typedef struct _GstElement GstElement;
 
 namespace gst {
 GST_LIB_EXPORT void init(int *argc, char * *argv[]);
 GST_LIB_EXPORT QString version();
+// hardware video decoders found, preferred by decodebin over the software ones
+GST_LIB_EXPORT QStringList hardwareDecoders();
+GST_LIB_EXPORT bool isHardwareDecoder(const QString &factoryName);
+// tune the pipeline for live video: unsynced sinks, leaky queues, short jitter buffers...
+// also applies to the elements added later on (decodebin, rtspsrc)
+GST_LIB_EXPORT void setLowLatency(GstElement *pipeline);
 }
 
 #endif // GST_UTIL_H
@@ -14,6 +14,8 @@ include(plugins/plugins.pro)
 HEADERS += \
     gst_global.h \
     gst_util.h \
+    latencyprobe.h \
+    sharedvideosource.h \
     devicemonitor.h \
     pipeline.h \
     pipelineevent.h \
@@ -22,6 +24,8 @@ HEADERS += \
 
 SOURCES += \
     gst_util.cpp \
+    latencyprobe.cpp \
+    sharedvideosource.cpp \
     devicemonitor.cpp \
     pipeline.cpp \
     videowidget.cpp
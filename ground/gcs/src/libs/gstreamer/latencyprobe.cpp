@@ -0,0 +1,199 @@
+/**
+ ******************************************************************************
+ *
+ * @file       latencyprobe.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Measures the delay of the frames reaching a video sink
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "latencyprobe.h"
+
+#include <gst/gst.h>
+
+#include <QDebug>
+
+static GstPadProbeReturn latency_probe_cb(GstPad *pad, GstPadProbeInfo *info, LatencyProbe *probe)
+{
+    probe->addSample(pad, info);
+    return GST_PAD_PROBE_OK;
+}
+
+static gboolean property_exists(GstElement *element, const char *name)
+{
+    return g_object_class_find_property(G_OBJECT_GET_CLASS(element), name) != NULL;
+}
+
+/**
+ * The video sink, looking into the bins (autovideosink)
+ */
+static GstElement *findVideoSink(GstElement *pipeline)
+{
+    GstElement *sink = NULL;
+    GstIterator *it  = gst_bin_iterate_sinks(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    bool done   = false;
+
+    while (!done) {
+        switch (gst_iterator_next(it, &item)) {
+        case GST_ITERATOR_OK:
+        {
+            GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+            if (GST_IS_BIN(element)) {
+                GstElement *child = findVideoSink(element);
+                if (child) {
+                    if (sink) {
+                        gst_object_unref(sink);
+                    }
+                    sink = child;
+                    done = true;
+                }
+            } else if (!sink || property_exists(element, "force-aspect-ratio")) {
+                // prefer the video sinks, an appsink is fine too
+                if (sink) {
+                    gst_object_unref(sink);
+                }
+                sink = GST_ELEMENT(gst_object_ref(element));
+            }
+            g_value_reset(&item);
+            break;
+        }
+        case GST_ITERATOR_RESYNC:
+            gst_iterator_resync(it);
+            break;
+        default:
+            done = true;
+            break;
+        }
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return sink;
+}
+
+LatencyProbe::LatencyProbe() : pipeline(NULL), sink(NULL), pad(NULL), probeId(0), count(0), sumMs(0), maxMs(0)
+{}
+
+LatencyProbe::~LatencyProbe()
+{
+    detach();
+}
+
+bool LatencyProbe::attach(GstElement *pipeline)
+{
+    detach();
+
+    sink = findVideoSink(pipeline);
+    if (!sink) {
+        return false;
+    }
+    pad = gst_element_get_static_pad(sink, "sink");
+    if (!pad) {
+        gst_object_unref(sink);
+        sink = NULL;
+        return false;
+    }
+    this->pipeline = GST_ELEMENT(gst_object_ref(pipeline));
+    probeId = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, (GstPadProbeCallback)latency_probe_cb, this, NULL);
+    qDebug() << "LatencyProbe::attach - probing" << GST_OBJECT_NAME(sink);
+    return true;
+}
+
+void LatencyProbe::detach()
+{
+    if (pad) {
+        gst_pad_remove_probe(pad, probeId);
+        gst_object_unref(pad);
+        pad = NULL;
+    }
+    if (sink) {
+        gst_object_unref(sink);
+        sink = NULL;
+    }
+    if (pipeline) {
+        gst_object_unref(pipeline);
+        pipeline = NULL;
+    }
+    QMutexLocker locker(&mutex);
+    count = 0;
+    sumMs = 0;
+    maxMs = 0;
+}
+
+int LatencyProbe::takeStats(double &averageMs, double &maxMs)
+{
+    QMutexLocker locker(&mutex);
+    int frames = count;
+
+    averageMs = count ? sumMs / count : 0;
+    maxMs     = this->maxMs;
+    count     = 0;
+    sumMs     = 0;
+    this->maxMs = 0;
+    return frames;
+}
+
+void LatencyProbe::addSample(GstPad *pad, GstPadProbeInfo *info)
+{
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) {
+        return;
+    }
+    GstClock *clock = gst_element_get_clock(sink);
+    if (!clock) {
+        return;
+    }
+    GstClockTime now = gst_clock_get_time(clock) - gst_element_get_base_time(sink);
+    gst_object_unref(clock);
+
+    GstEvent *event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+    if (!event) {
+        return;
+    }
+    const GstSegment *segment;
+    gst_event_parse_segment(event, &segment);
+    GstClockTime runningTime = gst_segment_to_running_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+    gst_event_unref(event);
+    if (!GST_CLOCK_TIME_IS_VALID(runningTime)) {
+        return;
+    }
+
+    gint64 delay = (gint64)now - (gint64)runningTime;
+    gboolean sync = FALSE;
+    if (property_exists(sink, "sync")) {
+        g_object_get(sink, "sync", &sync, NULL);
+    }
+    if (sync) {
+        // the sink waits for running time + latency before rendering
+        gint64 latency = (gint64)gst_pipeline_get_latency(GST_PIPELINE(pipeline));
+        if (latency > delay) {
+            delay = latency;
+        }
+    }
+    double ms = delay / 1000000.0;
+
+    QMutexLocker locker(&mutex);
+    count++;
+    sumMs += ms;
+    if (ms > maxMs) {
+        maxMs = ms;
+    }
+}
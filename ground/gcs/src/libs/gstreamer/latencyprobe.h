@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ *
+ * @file       latencyprobe.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Measures the delay of the frames reaching a video sink
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include "gst_global.h"
+
+#include <QMutex>
+
+typedef struct _GstElement GstElement;
+typedef struct _GstPad GstPad;
+typedef struct _GstPadProbeInfo GstPadProbeInfo;
+
+/**
+ * Buffer probe on the sink pad of the video sink.
+ *
+ * For each frame it compares the running time of the buffer (its capture time for live
+ * sources) with the pipeline clock. When the sink syncs the frame is rendered no earlier
+ * than its running time plus the pipeline latency, which is accounted for.
+ * This is the delay inside the pipeline: the camera exposure and what happens before
+ * the source element (encoder, radio link) are not seen.
+ */
+class GST_LIB_EXPORT LatencyProbe {
+public:
+    LatencyProbe();
+    ~LatencyProbe();
+
+    // attach to the video sink of the pipeline, false if none was found
+    bool attach(GstElement *pipeline);
+    void detach();
+
+    // average and maximum delay since the last call, in ms, returns the number of frames
+    int takeStats(double &averageMs, double &maxMs);
+
+    // called from the streaming thread
+    void addSample(GstPad *pad, GstPadProbeInfo *info);
+
+private:
+    GstElement *pipeline;
+    GstElement *sink;
+    GstPad *pad;
+    unsigned long probeId;
+
+    QMutex mutex;
+    int count;
+    double sumMs;
+    double maxMs;
+};
+
+#endif // LATENCYPROBE_H
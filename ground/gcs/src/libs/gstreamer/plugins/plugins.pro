@@ -3,6 +3,12 @@ DEFINES += GST_PLUGIN_BUILD_STATIC
 #CONFIG += link_pkgconfig
 PKGCONFIG += gstreamer-base-1.0
 
+HEADERS += \
+    plugins/sharedvideo/gstsharedvideosrc.h
+
+SOURCES += \
+    plugins/sharedvideo/gstsharedvideosrc.cpp
+
 opencv {
     # there is no package for gst opencv yet...
     GSTREAMER_SDK_DIR = $$system(pkg-config --variable=exec_prefix gstreamer-1.0)
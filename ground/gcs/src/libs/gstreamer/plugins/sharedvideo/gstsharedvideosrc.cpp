@@ -0,0 +1,210 @@
+/**
+ ******************************************************************************
+ *
+ * @file       gstsharedvideosrc.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Source element fed by a shared video source
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * SECTION:element-sharedvideosrc
+ *
+ * Outputs the decoded frames of a source shared with the other pipelines of the GCS,
+ * the source is only decoded once whatever the number of consumers.
+ *
+ * <refsect2>
+ * <title>Example pipelines</title>
+ * |[
+ * sharedvideosrc source="udpsrc port=5600 ! application/x-rtp ! rtph264depay ! avdec_h264" ! videoconvert ! autovideosink
+ * ]| The PFD can use the same source with "! videoconvert ! video/x-raw,format=RGB ! appsink name=sink".
+ * </refsect2>
+ */
+
+#include "gstsharedvideosrc.h"
+
+#include "sharedvideosource.h"
+
+#include <gst/app/gstappsrc.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_shared_video_src_debug);
+#define GST_CAT_DEFAULT gst_shared_video_src_debug
+
+// about three raw 720p frames, the frames in excess are dropped
+#define DEFAULT_MAX_BYTES (8 * 1024 * 1024)
+
+enum
+{
+  PROP_0,
+  PROP_SOURCE
+};
+
+static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+G_DEFINE_TYPE (GstSharedVideoSrc, gst_shared_video_src, GST_TYPE_BIN);
+
+static void gst_shared_video_src_dispose (GObject * object);
+static void gst_shared_video_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_shared_video_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+static GstStateChangeReturn gst_shared_video_src_change_state (GstElement * element,
+    GstStateChange transition);
+
+static void
+gst_shared_video_src_class_init (GstSharedVideoSrcClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->dispose = gst_shared_video_src_dispose;
+  gobject_class->set_property = gst_shared_video_src_set_property;
+  gobject_class->get_property = gst_shared_video_src_get_property;
+
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_shared_video_src_change_state);
+
+  g_object_class_install_property (gobject_class, PROP_SOURCE,
+      g_param_spec_string ("source", "Source",
+          "Description of the shared source pipeline, decoder included",
+          NULL, (GParamFlags) (G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+  gst_element_class_set_static_metadata (element_class,
+      "sharedvideosrc",
+      "Source/Video",
+      "Outputs the frames of a video source decoded once for all its consumers",
+      "The LibrePilot Project");
+
+  gst_element_class_add_static_pad_template (element_class, &src_factory);
+}
+
+static void
+gst_shared_video_src_init (GstSharedVideoSrc * src)
+{
+  src->source = NULL;
+  src->attached = FALSE;
+
+  src->appsrc = gst_element_factory_make ("appsrc", "appsrc");
+  g_object_set (src->appsrc, "is-live", TRUE, "format", GST_FORMAT_TIME,
+      "max-bytes", (guint64) DEFAULT_MAX_BYTES, NULL);
+  gst_bin_add (GST_BIN (src), src->appsrc);
+
+  GstPad *pad = gst_element_get_static_pad (src->appsrc, "src");
+  src->srcpad = gst_ghost_pad_new_from_template ("src", pad,
+      gst_static_pad_template_get (&src_factory));
+  gst_object_unref (pad);
+  gst_element_add_pad (GST_ELEMENT (src), src->srcpad);
+}
+
+static void
+gst_shared_video_src_dispose (GObject * object)
+{
+  GstSharedVideoSrc *src = GST_SHARED_VIDEO_SRC (object);
+
+  if (src->attached) {
+    SharedVideoSource::detach (src->appsrc);
+    src->attached = FALSE;
+  }
+  g_free (src->source);
+  src->source = NULL;
+
+  G_OBJECT_CLASS (gst_shared_video_src_parent_class)->dispose (object);
+}
+
+static void
+gst_shared_video_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSharedVideoSrc *src = GST_SHARED_VIDEO_SRC (object);
+
+  switch (prop_id) {
+    case PROP_SOURCE:
+      g_free (src->source);
+      src->source = g_value_dup_string (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_shared_video_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSharedVideoSrc *src = GST_SHARED_VIDEO_SRC (object);
+
+  switch (prop_id) {
+    case PROP_SOURCE:
+      g_value_set_string (value, src->source);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static GstStateChangeReturn
+gst_shared_video_src_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstSharedVideoSrc *src = GST_SHARED_VIDEO_SRC (element);
+  GstStateChangeReturn ret;
+
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED) {
+    if (!src->source || !*src->source) {
+      GST_ELEMENT_ERROR (src, RESOURCE, NOT_FOUND,
+          ("No shared source set"), (NULL));
+      return GST_STATE_CHANGE_FAILURE;
+    }
+    QString error;
+    if (!SharedVideoSource::attach (QString (src->source), src->appsrc, error)) {
+      GST_ELEMENT_ERROR (src, RESOURCE, OPEN_READ,
+          ("%s", error.toUtf8 ().constData ()), ("source: %s", src->source));
+      return GST_STATE_CHANGE_FAILURE;
+    }
+    src->attached = TRUE;
+  }
+
+  ret = GST_ELEMENT_CLASS (gst_shared_video_src_parent_class)->change_state (element,
+      transition);
+
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY && src->attached) {
+    SharedVideoSource::detach (src->appsrc);
+    src->attached = FALSE;
+  }
+
+  return ret;
+}
+
+gboolean
+gst_shared_video_src_plugin_init (GstPlugin * plugin)
+{
+  GST_DEBUG_CATEGORY_INIT (gst_shared_video_src_debug, "sharedvideosrc",
+      0, "Shared video source");
+
+  return gst_element_register (plugin, "sharedvideosrc", GST_RANK_NONE,
+      GST_TYPE_SHARED_VIDEO_SRC);
+}
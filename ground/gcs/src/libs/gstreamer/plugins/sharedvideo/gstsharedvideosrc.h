@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ *
+ * @file       gstsharedvideosrc.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Source element fed by a shared video source
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef __GST_SHARED_VIDEO_SRC_H__
+#define __GST_SHARED_VIDEO_SRC_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_SHARED_VIDEO_SRC \
+  (gst_shared_video_src_get_type())
+#define GST_SHARED_VIDEO_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_SHARED_VIDEO_SRC,GstSharedVideoSrc))
+#define GST_SHARED_VIDEO_SRC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_SHARED_VIDEO_SRC,GstSharedVideoSrcClass))
+#define GST_IS_SHARED_VIDEO_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_SHARED_VIDEO_SRC))
+#define GST_IS_SHARED_VIDEO_SRC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_SHARED_VIDEO_SRC))
+typedef struct _GstSharedVideoSrc GstSharedVideoSrc;
+typedef struct _GstSharedVideoSrcClass GstSharedVideoSrcClass;
+
+struct _GstSharedVideoSrc
+{
+  GstBin bin;
+
+  GstElement *appsrc;
+  GstPad *srcpad;
+
+  // description of the shared source, up to and including the decoder
+  gchar *source;
+  gboolean attached;
+};
+
+struct _GstSharedVideoSrcClass
+{
+  GstBinClass parent_class;
+};
+
+GType gst_shared_video_src_get_type (void);
+
+gboolean gst_shared_video_src_plugin_init (GstPlugin * plugin);
+
+G_END_DECLS
+
+#endif /* __GST_SHARED_VIDEO_SRC_H__ */
@@ -0,0 +1,317 @@
+/**
+ ******************************************************************************
+ *
+ * @file       sharedvideosource.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Decodes a video source once for several pipelines
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "sharedvideosource.h"
+
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+
+#include <QDebug>
+
+QMutex SharedVideoSource::registryMutex;
+QHash<QString, SharedVideoSource *> SharedVideoSource::registry;
+
+class SharedVideoSourceCallbacks {
+public:
+    static GstFlowReturn newSample(GstAppSink *appsink, gpointer data)
+    {
+        GstElement *appsrc = GST_ELEMENT(data);
+        GstSample *sample  = gst_app_sink_pull_sample(appsink);
+
+        if (!sample) {
+            return GST_FLOW_EOS;
+        }
+
+        // a slow consumer drops its frames instead of queuing them
+        guint64 maxBytes = gst_app_src_get_max_bytes(GST_APP_SRC(appsrc));
+        if (maxBytes > 0 && gst_app_src_get_current_level_bytes(GST_APP_SRC(appsrc)) >= maxBytes) {
+            gst_sample_unref(sample);
+            return GST_FLOW_OK;
+        }
+
+        GstCaps *caps = gst_sample_get_caps(sample);
+        GstCaps *currentCaps = gst_app_src_get_caps(GST_APP_SRC(appsrc));
+        if (caps && (!currentCaps || !gst_caps_is_equal(caps, currentCaps))) {
+            gst_app_src_set_caps(GST_APP_SRC(appsrc), caps);
+        }
+        if (currentCaps) {
+            gst_caps_unref(currentCaps);
+        }
+
+        // the timestamps of the source pipeline mean nothing in the consumer one
+        // the copy is shallow, the frame memory is shared
+        GstBuffer *buffer = gst_buffer_copy(gst_sample_get_buffer(sample));
+        gst_sample_unref(sample);
+
+        GstClock *clock   = gst_element_get_clock(appsrc);
+        if (clock) {
+            GST_BUFFER_PTS(buffer) = gst_clock_get_time(clock) - gst_element_get_base_time(appsrc);
+            gst_object_unref(clock);
+        } else {
+            GST_BUFFER_PTS(buffer) = GST_CLOCK_TIME_NONE;
+        }
+        GST_BUFFER_DTS(buffer) = GST_BUFFER_PTS(buffer);
+
+        // takes ownership of the buffer
+        GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(appsrc), buffer);
+        // a flushing consumer is about to be detached, don't stop the source for it
+        return (ret == GST_FLOW_FLUSHING) ? GST_FLOW_OK : ret;
+    }
+
+    static GstBusSyncReply busMessage(GstBus *bus, GstMessage *msg, gpointer data)
+    {
+        Q_UNUSED(bus);
+        SharedVideoSource *source = static_cast<SharedVideoSource *>(data);
+
+        switch (GST_MESSAGE_TYPE(msg)) {
+        case GST_MESSAGE_ERROR:
+        case GST_MESSAGE_WARNING:
+        case GST_MESSAGE_EOS:
+            source->forwardMessage(msg);
+            break;
+        default:
+            break;
+        }
+        return GST_BUS_DROP;
+    }
+};
+
+SharedVideoSource::SharedVideoSource(const QString &desc) : desc(desc), pipeline(NULL), tee(NULL)
+{}
+
+SharedVideoSource::~SharedVideoSource()
+{
+    if (pipeline) {
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        if (tee) {
+            gst_object_unref(tee);
+        }
+        gst_object_unref(pipeline);
+    }
+}
+
+bool SharedVideoSource::attach(const QString &desc, GstElement *appsrc, QString &error)
+{
+    QMutexLocker locker(&registryMutex);
+
+    SharedVideoSource *source = registry.value(desc);
+
+    if (!source) {
+        source = new SharedVideoSource(desc);
+        if (!source->start(error)) {
+            delete source;
+            return false;
+        }
+        registry.insert(desc, source);
+    }
+    if (!source->addBranch(appsrc)) {
+        error = "failed to link to the shared source";
+        if (source->isEmpty()) {
+            registry.remove(desc);
+            delete source;
+        }
+        return false;
+    }
+    return true;
+}
+
+void SharedVideoSource::detach(GstElement *appsrc)
+{
+    QMutexLocker locker(&registryMutex);
+
+    foreach(SharedVideoSource * source, registry) {
+        Branch *branch = source->takeBranch(appsrc);
+
+        if (!branch) {
+            continue;
+        }
+        source->removeBranch(branch);
+        if (source->isEmpty()) {
+            qDebug() << "SharedVideoSource::detach - stopping" << source->desc;
+            registry.remove(source->desc);
+            delete source;
+        }
+        return;
+    }
+}
+
+bool SharedVideoSource::start(QString &error)
+{
+    qDebug() << "SharedVideoSource::start - starting" << desc;
+
+    QString pipelineDesc = desc + " ! tee name=tee allow-not-linked=true";
+    GError *err = NULL;
+    pipeline = gst_parse_launch_full(pipelineDesc.toUtf8().constData(), NULL, GST_PARSE_FLAG_FATAL_ERRORS, &err);
+    if (!pipeline) {
+        error = err ? QString(err->message) : QString("failed to create the shared source");
+        if (err) {
+            g_error_free(err);
+        }
+        return false;
+    }
+    tee = gst_bin_get_by_name(GST_BIN(pipeline), "tee");
+    if (!tee) {
+        error = "the shared source must be a single chain";
+        return false;
+    }
+
+    GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
+    gst_bus_set_sync_handler(bus, SharedVideoSourceCallbacks::busMessage, this, NULL);
+    gst_object_unref(bus);
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        error = "failed to start the shared source";
+        return false;
+    }
+    return true;
+}
+
+bool SharedVideoSource::addBranch(GstElement *appsrc)
+{
+    GstElement *queue   = gst_element_factory_make("queue", NULL);
+    GstElement *appsink = gst_element_factory_make("appsink", NULL);
+
+    if (!queue || !appsink) {
+        if (queue) {
+            gst_object_unref(queue);
+        }
+        if (appsink) {
+            gst_object_unref(appsink);
+        }
+        return false;
+    }
+
+    // keep the latest frames only, the consumer pipeline syncs on its own clock
+    g_object_set(queue, "leaky", 2 /* downstream */, "max-size-buffers", 2, "max-size-bytes", 0, "max-size-time", (guint64)0, NULL);
+    g_object_set(appsink, "sync", FALSE, "max-buffers", 1, "drop", TRUE, NULL);
+
+    GstAppSinkCallbacks callbacks = { NULL, NULL, SharedVideoSourceCallbacks::newSample, { NULL } };
+    gst_app_sink_set_callbacks(GST_APP_SINK(appsink), &callbacks, gst_object_ref(appsrc), (GDestroyNotify)gst_object_unref);
+
+    gst_bin_add_many(GST_BIN(pipeline), queue, appsink, NULL);
+    gst_element_link(queue, appsink);
+
+    GstPad *teePad  = gst_element_get_request_pad(tee, "src_%u");
+    GstPad *sinkPad = gst_element_get_static_pad(queue, "sink");
+    bool linked     = (gst_pad_link(teePad, sinkPad) == GST_PAD_LINK_OK);
+    gst_object_unref(sinkPad);
+
+    gst_element_sync_state_with_parent(appsink);
+    gst_element_sync_state_with_parent(queue);
+
+    Branch *branch  = new Branch;
+    branch->appsrc  = GST_ELEMENT(gst_object_ref(appsrc));
+    branch->queue   = queue;
+    branch->appsink = appsink;
+    branch->teePad  = teePad;
+
+    if (!linked) {
+        removeBranch(branch);
+        return false;
+    }
+
+    QMutexLocker locker(&mutex);
+    branches.append(branch);
+    return true;
+}
+
+SharedVideoSource::Branch *SharedVideoSource::takeBranch(GstElement *appsrc)
+{
+    QMutexLocker locker(&mutex);
+
+    for (int i = 0; i < branches.size(); i++) {
+        if (branches[i]->appsrc == appsrc) {
+            return branches.takeAt(i);
+        }
+    }
+    return NULL;
+}
+
+void SharedVideoSource::removeBranch(Branch *branch)
+{
+    // called without the mutex, stopping the queue joins its streaming thread
+    GstPad *sinkPad = gst_element_get_static_pad(branch->queue, "sink");
+
+    gst_pad_unlink(branch->teePad, sinkPad);
+    gst_object_unref(sinkPad);
+    gst_element_release_request_pad(tee, branch->teePad);
+    gst_object_unref(branch->teePad);
+
+    gst_element_set_state(branch->queue, GST_STATE_NULL);
+    gst_element_set_state(branch->appsink, GST_STATE_NULL);
+    gst_bin_remove_many(GST_BIN(pipeline), branch->queue, branch->appsink, NULL);
+
+    gst_object_unref(branch->appsrc);
+    delete branch;
+}
+
+bool SharedVideoSource::isEmpty()
+{
+    QMutexLocker locker(&mutex);
+
+    return branches.isEmpty();
+}
+
+void SharedVideoSource::forwardMessage(GstMessage *msg)
+{
+    QMutexLocker locker(&mutex);
+
+    foreach(Branch * branch, branches) {
+        GstMessage *copy = NULL;
+
+        switch (GST_MESSAGE_TYPE(msg)) {
+        case GST_MESSAGE_ERROR:
+        {
+            GError *err  = NULL;
+            gchar *debug = NULL;
+            gst_message_parse_error(msg, &err, &debug);
+            copy = gst_message_new_error(GST_OBJECT(branch->appsrc), err, debug);
+            g_error_free(err);
+            g_free(debug);
+            break;
+        }
+        case GST_MESSAGE_WARNING:
+        {
+            GError *err  = NULL;
+            gchar *debug = NULL;
+            gst_message_parse_warning(msg, &err, &debug);
+            copy = gst_message_new_warning(GST_OBJECT(branch->appsrc), err, debug);
+            g_error_free(err);
+            g_free(debug);
+            break;
+        }
+        case GST_MESSAGE_EOS:
+            gst_app_src_end_of_stream(GST_APP_SRC(branch->appsrc));
+            break;
+        default:
+            break;
+        }
+        if (copy) {
+            gst_element_post_message(branch->appsrc, copy);
+        }
+    }
+}
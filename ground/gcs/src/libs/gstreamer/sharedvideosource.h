@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ *
+ * @file       sharedvideosource.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Decodes a video source once for several pipelines
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SHAREDVIDEOSOURCE_H
+#define SHAREDVIDEOSOURCE_H
+
+#include "gst_global.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+typedef struct _GstElement GstElement;
+typedef struct _GstMessage GstMessage;
+typedef struct _GstPad GstPad;
+
+/**
+ * Registry of the video sources shared between pipelines.
+ *
+ * A source is a pipeline description ending with the decoder, for example
+ * "udpsrc port=5600 caps=... ! rtph264depay ! avdec_h264". It runs in its own pipeline
+ * ending with a tee, each consumer gets a queue and an appsink on that tee and the
+ * decoded frames are pushed into the consumer appsrc.
+ * The source is started with its first consumer and stopped with its last one.
+ *
+ * The consumers normally use the sharedvideosrc element, see gstsharedvideosrc.h.
+ */
+class GST_LIB_EXPORT SharedVideoSource {
+public:
+    // feed the appsrc with the frames of the source, starting it if needed
+    static bool attach(const QString &desc, GstElement *appsrc, QString &error);
+    static void detach(GstElement *appsrc);
+
+private:
+    // the gstreamer callbacks
+    friend class SharedVideoSourceCallbacks;
+
+    struct Branch {
+        GstElement *appsrc;
+        GstElement *queue;
+        GstElement *appsink;
+        GstPad *teePad;
+    };
+
+    SharedVideoSource(const QString &desc);
+    ~SharedVideoSource();
+
+    bool start(QString &error);
+    bool addBranch(GstElement *appsrc);
+    Branch *takeBranch(GstElement *appsrc);
+    void removeBranch(Branch *branch);
+    bool isEmpty();
+
+    // errors and end of stream are passed on to the consumers
+    void forwardMessage(GstMessage *msg);
+
+    QString desc;
+    GstElement *pipeline;
+    GstElement *tee;
+
+    // protects the branches, they are also read from the bus handler
+    QMutex mutex;
+    QList<Branch *> branches;
+
+    static QMutex registryMutex;
+    static QHash<QString, SharedVideoSource *> registry;
+};
+
+#endif // SHAREDVIDEOSOURCE_H
@@ -41,6 +41,7 @@
 #include <QTextDocument>
 
 #include <string>
+#include <string.h>
 
 // TODO find a better way and move away from this file
 static Pipeline::State cvt(GstState state);
@@ -74,11 +75,12 @@ private:
 };
 
 static GstElement *createPipelineFromDesc(const char *, QString &lastError);
+static QString findVideoDecoder(GstElement *pipeline);
 
 static GstBusSyncReply gst_bus_sync_handler(GstBus *, GstMessage *, BusSyncHandler *);
 
 VideoWidget::VideoWidget(QWidget *parent) :
-    QWidget(parent), pipeline(NULL), overlay(NULL)
+    QWidget(parent), pipeline(NULL), overlay(NULL), m_lowLatency(false)
 {
     qDebug() << "VideoWidget::VideoWidget";
 
@@ -115,6 +117,9 @@ VideoWidget::VideoWidget(QWidget *parent) :
 
     // init state
     lastError = "";
+
+    m_latencyTimer.setInterval(1000);
+    connect(&m_latencyTimer, &QTimer::timeout, this, &VideoWidget::updateLatency);
 }
 
 VideoWidget::~VideoWidget()
@@ -133,6 +138,61 @@ bool VideoWidget::isPlaying()
     return pipeline && (GST_STATE(pipeline) == GST_STATE_PLAYING);
 }
 
+QString VideoWidget::decoderName()
+{
+    return m_decoder;
+}
+
+quint64 VideoWidget::processedFrames()
+{
+    quint64 processed = 0;
+
+    // the elements along the video path see the same frames
+    foreach(quint64 count, m_processed) {
+        processed = qMax(processed, count);
+    }
+    return processed;
+}
+
+quint64 VideoWidget::droppedFrames()
+{
+    quint64 dropped = 0;
+
+    // but each one drops its own
+    foreach(quint64 count, m_dropped) {
+        dropped += count;
+    }
+    return dropped;
+}
+
+bool VideoWidget::lowLatency()
+{
+    return m_lowLatency;
+}
+
+void VideoWidget::setLowLatency(bool lowLatency)
+{
+    m_lowLatency = lowLatency;
+}
+
+void VideoWidget::updateLatency()
+{
+    double averageMs;
+    double maxMs;
+
+    if (m_latencyProbe.takeStats(averageMs, maxMs) > 0) {
+        emit latencyChanged(averageMs, maxMs);
+    }
+}
+
+void VideoWidget::resetStats()
+{
+    m_decoder.clear();
+    m_processed.clear();
+    m_dropped.clear();
+    emit frameStatsChanged(0, 0);
+}
+
 QString VideoWidget::pipelineDesc()
 {
     return m_pipelineDesc;
@@ -192,6 +252,7 @@ void VideoWidget::init()
 
     // reset state
     lastError = "";
+    resetStats();
 
     // create pipeline
     qDebug() << "VideoWidget::init - initializing pipeline :" << m_pipelineDesc;
@@ -199,6 +260,10 @@ void VideoWidget::init()
     if (pipeline) {
         gst_pipeline_set_auto_flush_bus(GST_PIPELINE(pipeline), true);
 
+        if (m_lowLatency) {
+            gst::setLowLatency(pipeline);
+        }
+
         // register bus synchronous handler
         GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
         gst_bus_set_sync_handler(bus, (GstBusSyncHandler)gst_bus_sync_handler, handler, NULL);
@@ -215,8 +280,12 @@ void VideoWidget::dispose()
 
     setOverlay(NULL);
 
+    m_latencyTimer.stop();
+
     if (pipeline) {
         gst_element_set_state(pipeline, GST_STATE_NULL);
+        // the streaming threads are stopped, safe to remove the probe
+        m_latencyProbe.detach();
         gst_object_unref(pipeline);
         pipeline = NULL;
     }
@@ -419,6 +488,20 @@ bool VideoWidget::event(QEvent *event)
         if (sce->getNewState() == Pipeline::Playing) {
             if (pipeline) {
                 toDotFile("pipeline");
+
+                // decodebin plugs the decoder when the stream starts
+                QString decoder = findVideoDecoder(pipeline);
+                if (decoder != m_decoder) {
+                    m_decoder = decoder;
+                    bool hardware = gst::isHardwareDecoder(decoder);
+                    emitEventMessage(QString("Decoder: %0 (%1)").arg(decoder).arg(hardware ? "hardware" : "software"));
+                    emit decoderChanged(decoder, hardware);
+                }
+
+                // the sink and its pad exist by now
+                if (!m_latencyTimer.isActive() && m_latencyProbe.attach(pipeline)) {
+                    m_latencyTimer.start();
+                }
             }
         }
 
@@ -471,6 +554,16 @@ bool VideoWidget::event(QEvent *event)
             qe->getData().values()).arg(qe->getData().stats());
         emitEventMessage(msg);
 
+        // -1 means unknown
+        QosData data = qe->getData();
+        if (data.processed != (quint64)-1) {
+            m_processed[qe->src] = data.processed;
+        }
+        if (data.dropped != (quint64)-1) {
+            m_dropped[qe->src] = data.dropped;
+        }
+        emit frameStatsChanged(processedFrames(), droppedFrames());
+
         if (pipeline) {
             toDotFile("pipeline_qos");
         }
@@ -589,6 +682,45 @@ static GstElement *createPipelineFromDesc(const char *desc, QString &lastError)
     return pipeline;
 }
 
+/**
+ * Find the video decoder in the pipeline, looking into the bins (decodebin)
+ */
+static QString findVideoDecoder(GstElement *pipeline)
+{
+    QString decoder;
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    GValue item     = G_VALUE_INIT;
+    bool done = false;
+
+    while (!done) {
+        switch (gst_iterator_next(it, &item)) {
+        case GST_ITERATOR_OK:
+        {
+            GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+            GstElementFactory *factory = gst_element_get_factory(element);
+            if (factory) {
+                const gchar *klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+                if (klass && strstr(klass, "Decoder") && strstr(klass, "Video")) {
+                    decoder = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory));
+                    done    = true;
+                }
+            }
+            g_value_reset(&item);
+            break;
+        }
+        case GST_ITERATOR_RESYNC:
+            gst_iterator_resync(it);
+            break;
+        default:
+            done = true;
+            break;
+        }
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return decoder;
+}
+
 bool BusSyncHandler::handleMessage(GstMessage *message)
 {
     // this method is called by gstreamer as a callback
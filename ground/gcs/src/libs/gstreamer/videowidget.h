@@ -30,11 +30,14 @@
 #include "gst_global.h"
 #include "pipeline.h"
 #include "overlay.h"
+#include "latencyprobe.h"
 
 #include <QWidget>
 #include <QResizeEvent>
 #include <QPaintEvent>
 #include <QMouseEvent>
+#include <QMap>
+#include <QTimer>
 
 typedef struct _GstElement GstElement;
 
@@ -51,6 +54,15 @@ public:
     void setPipelineDesc(QString pipelineDesc);
     bool isPlaying();
 
+    // tune the pipeline for the lowest latency, takes effect on the next start
+    bool lowLatency();
+    void setLowLatency(bool lowLatency);
+
+    // video decoder selected once playing, empty if unknown
+    QString decoderName();
+    quint64 processedFrames();
+    quint64 droppedFrames();
+
 public slots:
     void start();
     void pause();
@@ -59,6 +71,11 @@ public slots:
 signals:
     void message(QString);
     void stateChanged(Pipeline::State oldState, Pipeline::State newState, Pipeline::State pendingState);
+    void decoderChanged(QString decoder, bool hardware);
+    // from the QoS messages, since the pipeline was started
+    void frameStatsChanged(quint64 processed, quint64 dropped);
+    // delay of the frames from the source to the video sink, over the last second
+    void latencyChanged(double averageMs, double maxMs);
 
 protected:
     QString getStatus();
@@ -75,6 +92,8 @@ private:
     void setOverlay(Overlay *);
 
     void emitEventMessage(QString msg);
+    void resetStats();
+    void updateLatency();
 
     void toDotFile(QString name);
 
@@ -88,6 +107,15 @@ private:
     Overlay *overlay;
     BusSyncHandler *handler;
 
+    QString m_decoder;
+    // QoS statistics by element, they are totals since the element went to READY
+    QMap<QString, quint64> m_processed;
+    QMap<QString, quint64> m_dropped;
+
+    bool m_lowLatency;
+    LatencyProbe m_latencyProbe;
+    QTimer m_latencyTimer;
+
     // DeviceMonitor m;
 };
 
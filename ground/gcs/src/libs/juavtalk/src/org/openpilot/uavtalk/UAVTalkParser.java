@@ -0,0 +1,122 @@
+package org.openpilot.uavtalk;
+
+import java.nio.ByteBuffer;
+
+import org.openpilot.uavtalk.CRC8;
+import org.openpilot.uavtalk.UAVObject;
+import org.openpilot.uavtalk.UAVObjectsInterface;
+
+/**
+ ******************************************************************************
+ *
+ * @file       UAVTalkParser.java
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      incremental UAVTalk receiver which does not allocate per package
+ *
+ ****************************************************************************
+*/
+public class UAVTalkParser {
+
+	public final static int MAX_PAYLOAD_LENGTH=256;
+
+	public interface Listener {
+		/**
+		 * called for every package with a valid CRC, after a known object got deserialized
+		 *
+		 * @param type - the package type
+		 * @param obj_id - the object ID
+		 * @param obj - the object or null if the ID is unknown
+		 * @param data - the package, only valid during the call
+		 * @param offset - where the payload starts in data
+		 * @param length - the payload length
+		 */
+		public void onPackage(byte type,int obj_id,UAVObject obj,byte[] data,int offset,int length);
+	}
+
+	private final static int HEADER_LENGTH=UAVTalkHelper.MIN_PACKAGE_SIZE-UAVTalkHelper.PACKAGE_LENGTH_CRC;
+
+	private UAVObjectsInterface objects;
+	private Listener listener;
+
+	// one buffer for all packages, the payload is deserialized in place
+	private byte[] buf=new byte[HEADER_LENGTH+MAX_PAYLOAD_LENGTH+UAVTalkHelper.PACKAGE_LENGTH_CRC];
+	private int pos=0;
+	private int packageLength=0;
+
+	private int crcErrors=0;
+	private int sizeErrors=0;
+
+	public UAVTalkParser(UAVObjectsInterface objects,Listener listener) {
+		this.objects=objects;
+		this.listener=listener;
+	}
+
+	/**
+	 * consume all remaining bytes of the buffer, packages can span several calls
+	 *
+	 * @param in - the received bytes
+	 */
+	public void process(ByteBuffer in) {
+		while (in.hasRemaining()) {
+			if (pos==0) {
+				// wait for the sync byte
+				byte b=in.get();
+				if (b!=UAVTalkDefinitions.SYNC_VAL)
+					continue;
+				buf[pos++]=b;
+				continue;
+			}
+
+			if (pos<HEADER_LENGTH) {
+				int n=Math.min(HEADER_LENGTH-pos,in.remaining());
+				in.get(buf,pos,n);
+				pos+=n;
+				if (pos<HEADER_LENGTH)
+					return;
+				if ((buf[1]&UAVTalkDefinitions.TYPE_MASK_VER)!=UAVTalkDefinitions.TYPE_VER) {
+					pos=0;
+					continue;
+				}
+				int size=(buf[2]&0xFF)|((buf[3]&0xFF)<<8);
+				if (size<HEADER_LENGTH || size>HEADER_LENGTH+MAX_PAYLOAD_LENGTH) {
+					sizeErrors++;
+					pos=0;
+					continue;
+				}
+				packageLength=size+UAVTalkHelper.PACKAGE_LENGTH_CRC;
+			}
+
+			int n=Math.min(packageLength-pos,in.remaining());
+			in.get(buf,pos,n);
+			pos+=n;
+			if (pos==packageLength) {
+				processPackage();
+				pos=0;
+			}
+		}
+	}
+
+	private void processPackage() {
+		int length=packageLength-HEADER_LENGTH-UAVTalkHelper.PACKAGE_LENGTH_CRC;
+		if (CRC8.arrayUpdate((byte)0,buf,packageLength-1)!=buf[packageLength-1]) {
+			crcErrors++;
+			return;
+		}
+		int obj_id=ValueParser.parse_int_from_arr_4(4,buf);
+		UAVObject obj=objects.getObjectByID(obj_id);
+		byte type=buf[1];
+		if (obj!=null && length>0
+			&& (type==UAVTalkDefinitions.TYPE_OBJ || type==UAVTalkDefinitions.TYPE_OBJ_ACK))
+			obj.deserialize(buf,HEADER_LENGTH);
+		if (listener!=null)
+			listener.onPackage(type,obj_id,obj,buf,HEADER_LENGTH,length);
+	}
+
+	public int getCRCErrors() {
+		return crcErrors;
+	}
+
+	public int getSizeErrors() {
+		return sizeErrors;
+	}
+}
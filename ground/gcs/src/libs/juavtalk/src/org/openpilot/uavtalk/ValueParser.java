@@ -23,6 +23,31 @@ public class ValueParser {
 				);
 	}
 
+	/**
+	 * parse a unsigned short value from 2 bytes of some array
+	 *
+	 * @param offset - where to start in the array
+	 * @param arr - the array
+	 * @return - the calculated value
+	 */
+	public final static int parse_uint_from_arr_2(int offset,byte[] arr) {
+		return 	(
+				 ((arr[offset+1]&0xFF)<<8)  |
+				   arr[offset+0]&0xFF
+				);
+	}
+
+	/**
+	 * parse a float value from 4 bytes of some array without boxing
+	 *
+	 * @param offset - where to start in the array
+	 * @param arr - the array
+	 * @return - the calculated value
+	 */
+	public final static float parse_float_from_arr_4(int offset,byte[] arr) {
+		return Float.intBitsToFloat(parse_int_from_arr_4(offset,arr));
+	}
+
 	public final static int parse_int_from_arr_4_2(int offset,byte[] arr) {
 		return 	(
 				 ((arr[offset+3])<<24) |
@@ -41,11 +41,13 @@ Cache *Cache::Instance()
 
 void Cache::setCacheLocation(const QString & value)
 {
-    cache          = value;
-    routeCache     = cache + "RouteCache" + QDir::separator();
-    geoCache       = cache + "GeocoderCache" + QDir::separator();
-    placemarkCache = cache + "PlacemarkCache" + QDir::separator();
+    cache = value;
     ImageCache.setGtileCache(value);
+    QMutexLocker locker(&textsLock);
+    for (int i = 0; i < TextTypeCount; i++) {
+        texts[i].clear();
+        textsLoaded[i] = false;
+    }
 }
 QString Cache::CacheLocation()
 {
@@ -53,137 +55,68 @@ QString Cache::CacheLocation()
 }
 Cache::Cache()
 {
+    for (int i = 0; i < TextTypeCount; i++) {
+        textsLoaded[i] = false;
+    }
     if (cache.isNull() | cache.isEmpty()) {
         cache = Utils::GetStoragePath() + "mapscache" + QDir::separator();
         setCacheLocation(cache);
     }
 }
-QString Cache::GetGeocoderFromCache(const QString &urlEnd)
+QString Cache::GetTextFromCache(TextType type, const QString &key)
 {
-#ifdef DEBUG_GetGeocoderFromCache
-    qDebug() << "Entered GetGeocoderFromCache";
-#endif
-    QString ret = QString::null;
-    QString filename = geoCache + QString(urlEnd) + ".geo";
-#ifdef DEBUG_GetGeocoderFromCache
-    qDebug() << "GetGeocoderFromCache: Does file exist?:" << filename;
-#endif
-    QFileInfo File(filename);
-    if (File.exists()) {
-#ifdef DEBUG_GetGeocoderFromCache
-        qDebug() << "GetGeocoderFromCache:File exists!!";
-#endif
-        QFile file(filename);
-        if (file.open(QIODevice::ReadOnly)) {
-            QTextStream stream(&file);
-            stream.setCodec("UTF-8");
-            stream >> ret;
-        }
+    QMutexLocker locker(&textsLock);
+
+    if (!textsLoaded[type]) {
+        texts[type] = ImageCache.GetTextsFromCache(type);
+        textsLoaded[type] = true;
+#ifdef DEBUG_CACHE
+        qDebug() << "GetTextFromCache: Loaded" << texts[type].count() << "entries of type" << type;
+#endif // DEBUG_CACHE
     }
-#ifdef DEBUG_GetGeocoderFromCache
-    qDebug() << "GetGeocoderFromCache:Returning:" << ret;
-#endif
-    return ret;
+    return texts[type].value(key);
 }
-void Cache::CacheGeocoder(const QString &urlEnd, const QString &content)
+void Cache::CacheText(TextType type, const QString &key, const QString &content)
 {
-    QString ret = QString::null;
-    QString filename = geoCache + QString(urlEnd) + ".geo";
+    QMutexLocker locker(&textsLock);
 
-#ifdef DEBUG_CACHE
-    qDebug() << "CacheGeocoder: Filename:" << filename;
-#endif // DEBUG_CACHE
-    QFileInfo File(filename);;
-    QDir dir     = File.absoluteDir();
-    QString path = dir.absolutePath();
-#ifdef DEBUG_CACHE
-    qDebug() << "CacheGeocoder: Path:" << path;
-#endif // DEBUG_CACHE
-    if (!dir.exists()) {
-#ifdef DEBUG_CACHE
-        qDebug() << "CacheGeocoder: Cache path doesn't exist, try to create";
-#endif // DEBUG_CACHE
-        if (!dir.mkpath(path)) {
-#ifdef DEBUG_CACHE
-            qDebug() << "GetGeocoderFromCache: Could not create path";
-#endif // DEBUG_CACHE
-        }
+    // only once loaded, the next lookup reads the database anyway
+    if (textsLoaded[type]) {
+        texts[type].insert(key, content);
     }
+    if (!ImageCache.PutTextToCache(type, key, content)) {
 #ifdef DEBUG_CACHE
-    qDebug() << "CacheGeocoder: OpenFile:" << filename;
+        qDebug() << "CacheText: Could not store" << key;
 #endif // DEBUG_CACHE
-    QFile file(filename);
-    if (file.open(QIODevice::WriteOnly)) {
-#ifdef DEBUG_CACHE
-        qDebug() << "CacheGeocoder: File Opened!!!:" << filename;
-#endif // DEBUG_CACHE
-        QTextStream stream(&file);
-        stream.setCodec("UTF-8");
-        stream << content;
     }
 }
-QString Cache::GetPlacemarkFromCache(const QString &urlEnd)
+QString Cache::GetGeocoderFromCache(const QString &urlEnd)
 {
-#ifdef DEBUG_CACHE
-    qDebug() << "Entered GetPlacemarkFromCache";
-#endif // DEBUG_CACHE
-    QString ret = QString::null;
-    QString filename = placemarkCache + QString(urlEnd) + ".plc";
-#ifdef DEBUG_CACHE
-    qDebug() << "GetPlacemarkFromCache: Does file exist?:" << filename;
-#endif // DEBUG_CACHE
-    QFileInfo File(filename);
-    if (File.exists()) {
-#ifdef DEBUG_CACHE
-        qDebug() << "GetPlacemarkFromCache:File exists!!";
-#endif // DEBUG_CACHE
-        QFile file(filename);
-        if (file.open(QIODevice::ReadOnly)) {
-            QTextStream stream(&file);
-            stream.setCodec("UTF-8");
-            stream >> ret;
-        }
-    }
-#ifdef DEBUG_CACHE
-    qDebug() << "GetPlacemarkFromCache:Returning:" << ret;
-#endif // DEBUG_CACHE
+    QString ret = GetTextFromCache(GeocoderText, urlEnd);
+
+#ifdef DEBUG_GetGeocoderFromCache
+    qDebug() << "GetGeocoderFromCache:Returning:" << ret;
+#endif
     return ret;
 }
+void Cache::CacheGeocoder(const QString &urlEnd, const QString &content)
+{
+    CacheText(GeocoderText, urlEnd, content);
+}
+QString Cache::GetPlacemarkFromCache(const QString &urlEnd)
+{
+    return GetTextFromCache(PlacemarkText, urlEnd);
+}
 void Cache::CachePlacemark(const QString &urlEnd, const QString &content)
 {
-    QString ret = QString::null;
-    QString filename = placemarkCache + QString(urlEnd) + ".plc";
-
-#ifdef DEBUG_CACHE
-    qDebug() << "CachePlacemark: Filename:" << filename;
-#endif // DEBUG_CACHE
-    QFileInfo File(filename);;
-    QDir dir     = File.absoluteDir();
-    QString path = dir.absolutePath();
-#ifdef DEBUG_CACHE
-    qDebug() << "CachePlacemark: Path:" << path;
-#endif // DEBUG_CACHE
-    if (!dir.exists()) {
-#ifdef DEBUG_CACHE
-        qDebug() << "CachePlacemark: Cache path doesn't exist, try to create";
-#endif // DEBUG_CACHE
-        if (!dir.mkpath(path)) {
-#ifdef DEBUG_CACHE
-            qDebug() << "CachePlacemark: Could not create path";
-#endif // DEBUG_CACHE
-        }
-    }
-#ifdef DEBUG_CACHE
-    qDebug() << "CachePlacemark: OpenFile:" << filename;
-#endif // DEBUG_CACHE
-    QFile file(filename);
-    if (file.open(QIODevice::WriteOnly)) {
-#ifdef DEBUG_CACHE
-        qDebug() << "CachePlacemark: File Opened!!!:" << filename;
-#endif // DEBUG_CACHE
-        QTextStream stream(&file);
-        stream.setCodec("UTF-8");
-        stream << content;
-    }
+    CacheText(PlacemarkText, urlEnd, content);
+}
+QString Cache::GetRouteFromCache(const QString &urlEnd)
+{
+    return GetTextFromCache(RouteText, urlEnd);
+}
+void Cache::CacheRoute(const QString &urlEnd, const QString &content)
+{
+    CacheText(RouteText, urlEnd, content);
 }
 }
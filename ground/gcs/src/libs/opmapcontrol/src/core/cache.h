@@ -29,6 +29,8 @@
 
 #include "pureimagecache.h"
 #include "debugheader.h"
+#include <QMutex>
+#include <QHash>
 
 namespace core {
 class Cache {
@@ -47,6 +49,11 @@ public:
     QString GetRouteFromCache(const QString &urlEnd);
 
 private:
+    // stored in the text table of the tile database
+    enum TextType { GeocoderText, PlacemarkText, RouteText, TextTypeCount };
+    QString GetTextFromCache(TextType type, const QString &key);
+    void CacheText(TextType type, const QString &key, const QString &content);
+
     Cache();
     Cache(Cache const &) {}
     Cache & operator=(Cache const &)
@@ -55,9 +62,10 @@ private:
     }
     static Cache *m_pInstance;
     QString cache;
-    QString routeCache;
-    QString geoCache;
-    QString placemarkCache;
+    // in memory copy of the text table, loaded on first use per type
+    QHash<QString, QString> texts[TextTypeCount];
+    bool textsLoaded[TextTypeCount];
+    QMutex textsLock;
 };
 }
 #endif // CACHE_H
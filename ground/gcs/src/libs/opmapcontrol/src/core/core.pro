@@ -10,12 +10,14 @@ SOURCES += opmaps.cpp \
     providerstrings.cpp \
     cacheitemqueue.cpp \
     tilecachequeue.cpp \
+    tiledownloader.cpp \
     alllayersoftype.cpp \
     urlfactory.cpp \
     placemark.cpp \
     point.cpp \
     size.cpp \
     kibertilecache.cpp \
+    vectortile.cpp \
     diagnostics.cpp
 HEADERS += opmaps.h \
     size.h \
@@ -30,12 +32,14 @@ HEADERS += opmaps.h \
     providerstrings.h \
     cacheitemqueue.h \
     tilecachequeue.h \
+    tiledownloader.h \
     alllayersoftype.h \
     urlfactory.h \
     geodecoderstatus.h \
     placemark.h \
     point.h \
     kibertilecache.h \
+    vectortile.h \
     debugheader.h \
     diagnostics.h
 
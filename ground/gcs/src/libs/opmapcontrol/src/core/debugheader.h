@@ -11,4 +11,5 @@
 // #define DEBUG_GetGeocoderFromCache
 // #define DEBUG_TIMINGS
 // #define DEBUG_CORE
+// #define DEBUG_VECTORTILE
 #endif // DEBUGHEADER_H
@@ -26,43 +26,112 @@
  */
 #include "kibertilecache.h"
 
-// TODO add readwrite lock
-
 namespace core {
-KiberTileCache::KiberTileCache()
+KiberTileCache::KiberTileCache() : capacity(22), memoryCacheSize(0)
 {
-    memoryCacheSize = 0;
-    _MemoryCacheCapacity = 22;
+    for (int i = 0; i < ShardCount; ++i) {
+        shards[i].size = 0;
+    }
 }
 
 void KiberTileCache::setMemoryCacheCapacity(const int &value)
 {
-    kiberCacheLock.lockForWrite();
-    _MemoryCacheCapacity = value;
-    kiberCacheLock.unlock();
+    capacity.store(value);
+    RemoveMemoryOverload();
 }
 int KiberTileCache::MemoryCacheCapacity()
 {
-    kiberCacheLock.lockForRead();
-    return _MemoryCacheCapacity;
+    return capacity.load();
+}
 
-    kiberCacheLock.unlock();
+KiberTileCache::Shard &KiberTileCache::ShardOf(const RawTile &tile)
+{
+    // the top bits, the low ones already pick the bucket inside the shard hash
+    return shards[(qHash(tile) * 2654435761u) >> 28];
 }
 
-void KiberTileCache::RemoveMemoryOverload()
+QByteArray KiberTileCache::Get(const RawTile &tile)
+{
+    Shard &shard = ShardOf(tile);
+    QByteArray pic;
+
+    shard.mutex.lock();
+    QHash<RawTile, Entry>::iterator i = shard.tiles.find(tile);
+    if (i != shard.tiles.end()) {
+        i->referenced = true;
+        pic = i->pic;
+    }
+    shard.mutex.unlock();
+    if (pic.isEmpty()) {
+        misses.ref();
+    } else {
+        hits.ref();
+    }
+    return pic;
+}
+
+void KiberTileCache::Insert(const RawTile &tile, const QByteArray &pic)
 {
-    while (MemoryCacheSize() > MemoryCacheCapacity()) {
-        if (cachequeue.count() > 0 && list.count() > 0) {
+    Shard &shard = ShardOf(tile);
+    int budget = (int)((qint64)capacity.load() * 1048576 / ShardCount);
+    int delta  = pic.size() + EntryOverhead;
+
+    shard.mutex.lock();
+    QHash<RawTile, Entry>::iterator i = shard.tiles.find(tile);
+    if (i != shard.tiles.end()) {
+        delta -= i->pic.size() + EntryOverhead;
+        i->pic = pic;
+        i->referenced = true;
+    } else {
+        Entry entry;
+        entry.pic = pic;
+        entry.referenced = false;
+        shard.tiles.insert(tile, entry);
+        shard.clock.enqueue(tile);
+    }
+    shard.size += delta;
+    memoryCacheSize.fetchAndAddRelaxed(delta);
+    Evict(shard, budget);
 #ifdef DEBUG_MEMORY_CACHE
-            qDebug() << "Cleaning Memory cache=" << " started with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
+    qDebug() << "Current memory=" << memoryCacheSize.load() << " shard has " << shard.tiles.count() << " tiles";
 #endif
-            RawTile first = list.dequeue();
-            memoryCacheSize -= cachequeue.value(first).size();
-            cachequeue.remove(first);
+    shard.mutex.unlock();
+}
+
+void KiberTileCache::Evict(Shard &shard, int budget)
+{
+    // caller holds the shard mutex
+    while (shard.size > budget && !shard.clock.isEmpty()) {
+        RawTile first = shard.clock.dequeue();
+        QHash<RawTile, Entry>::iterator i = shard.tiles.find(first);
+        if (i == shard.tiles.end()) {
+            continue;
+        }
+        if (i->referenced) {
+            // used since the hand last passed, give it a second chance
+            i->referenced = false;
+            shard.clock.enqueue(first);
+            continue;
         }
+        int freed = i->pic.size() + EntryOverhead;
+        shard.size -= freed;
+        memoryCacheSize.fetchAndAddRelaxed(-freed);
+        shard.tiles.erase(i);
+        evictions.ref();
+    }
+}
+
+void KiberTileCache::RemoveMemoryOverload()
+{
+    int budget = (int)((qint64)capacity.load() * 1048576 / ShardCount);
+
+    for (int s = 0; s < ShardCount; ++s) {
+        shards[s].mutex.lock();
+        Evict(shards[s], budget);
+        shards[s].mutex.unlock();
     }
 #ifdef DEBUG_MEMORY_CACHE
-    qDebug() << "Cleaning Memory cache=" << " ended with " << cachequeue.count() << " tile " << "ocupying " << memoryCacheSize << " bytes";
+    qDebug() << "Cleaning Memory cache=" << " ended ocupying " << memoryCacheSize.load() << " bytes";
 #endif
 }
 }
@@ -31,26 +31,75 @@
 #include <QMutex>
 #include <QReadWriteLock>
 #include <QQueue>
+#include <QHash>
+#include <QAtomicInt>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
+/**
+ * In memory tile cache bounded by the bytes it holds.
+ * The tiles are spread over independently locked shards so the loader threads
+ * rarely contend, each shard evicting with the CLOCK (second chance) policy.
+ */
 class KiberTileCache {
 public:
     KiberTileCache();
 
+    /**
+     * Capacity in MB, a smaller value evicts right away.
+     */
     void setMemoryCacheCapacity(const int &value);
     int MemoryCacheCapacity();
+    /**
+     * Memory used in MB.
+     */
     double MemoryCacheSize()
     {
-        return memoryCacheSize / 1048576.0;
+        return memoryCacheSize.load() / 1048576.0;
     }
+    QByteArray Get(const RawTile &tile);
+    void Insert(const RawTile &tile, const QByteArray &pic);
     void RemoveMemoryOverload();
-    QReadWriteLock kiberCacheLock;
-    QHash <RawTile, QByteArray> cachequeue;
-    QQueue <RawTile> list;
-    long memoryCacheSize;
+
+    int Hits()
+    {
+        return hits.load();
+    }
+    int Misses()
+    {
+        return misses.load();
+    }
+    int Evictions()
+    {
+        return evictions.load();
+    }
+
 private:
-    int _MemoryCacheCapacity;
+    struct Entry {
+        QByteArray pic;
+        bool referenced;
+    };
+    struct Shard {
+        QMutex mutex;
+        QHash<RawTile, Entry> tiles;
+        // CLOCK hand order, every cached tile is in it exactly once
+        QQueue<RawTile> clock;
+        int size;
+    };
+
+    static const int ShardCount = 16;
+    // hash node and QByteArray header, counted on top of the tile data
+    static const int EntryOverhead = 64;
+
+    Shard &ShardOf(const RawTile &tile);
+    void Evict(Shard &shard, int budget);
+
+    Shard shards[ShardCount];
+    QAtomicInt capacity;
+    QAtomicInt memoryCacheSize;
+    QAtomicInt hits;
+    QAtomicInt misses;
+    QAtomicInt evictions;
 };
 }
 #endif // KIBERTILECACHE_H
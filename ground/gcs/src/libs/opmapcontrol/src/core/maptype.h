@@ -68,8 +68,15 @@ public:
         GoogleLabelsKorea    = 4003,
         GoogleHybridKorea    = 4005,
 
-        Statkart_Topo2       = 5500
+        Statkart_Topo2       = 5500,
+
+        OpenMapTiles_Vector  = 6001
     };
+    // vector tiles are rendered by the client, the others are images
+    static bool IsVector(Types const & value)
+    {
+        return value == OpenMapTiles_Vector;
+    }
     static QString StrByType(Types const & value)
     {
         QMetaObject metaObject = MapType().staticMetaObject;
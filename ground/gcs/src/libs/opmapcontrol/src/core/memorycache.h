@@ -42,7 +42,6 @@ public:
     KiberTileCache TilesInMemory;
     QByteArray GetTileFromMemoryCache(const RawTile &tile);
     void AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic);
-    QReadWriteLock kiberCacheLock;
 };
 }
 #endif // MEMORYCACHE_H
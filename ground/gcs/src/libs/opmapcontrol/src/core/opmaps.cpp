@@ -43,15 +43,21 @@ OPMaps::OPMaps() : RetryLoadTile(2), useMemoryCache(true)
     accessmode  = AccessMode::ServerAndCache;
     LanguageStr = QLocale().bcp47Name();
     Cache::Instance();
+    downloader  = new TileDownloader;
+    downloader->moveToThread(&downloaderThread);
+    QObject::connect(&downloaderThread, SIGNAL(finished()), downloader, SLOT(deleteLater()));
+    downloaderThread.start();
 }
 
 OPMaps::~OPMaps()
 {
+    downloaderThread.quit();
+    downloaderThread.wait();
     TileDBcacheQueue.wait();
 }
 
 
-QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom)
+QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, const int &zoom, const int &priority, bool *cancelled)
 {
 #ifdef DEBUG_TIMINGS
     QTime time;
@@ -61,12 +67,20 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
     qDebug() << "Entered GetImageFrom";
 #endif // DEBUG_GMAPS
     QByteArray ret;
+    // overzoomed vector tiles are cut out of their ancestor at the deepest zoom of the server
+    Point tilePos = pos;
+    int tileZoom  = zoom;
+    if (MapType::IsVector(type) && zoom > VectorTileMaxZoom) {
+        int dz   = zoom - VectorTileMaxZoom;
+        tilePos  = Point(pos.X() >> dz, pos.Y() >> dz);
+        tileZoom = VectorTileMaxZoom;
+    }
 
     if (useMemoryCache) {
 #ifdef DEBUG_GMAPS
         qDebug() << "Try Tile from memory:Size=" << TilesInMemory.MemoryCacheSize();
 #endif // DEBUG_GMAPS
-        ret = GetTileFromMemoryCache(RawTile(type, pos, zoom));
+        ret = GetTileFromMemoryCache(RawTile(type, tilePos, tileZoom));
         if (!ret.isEmpty()) {
             errorvars.lock();
             ++diag.tilesFromMem;
@@ -81,7 +95,7 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
 #ifdef DEBUG_GMAPS
             qDebug() << "Try tile from DataBase";
 #endif // DEBUG_GMAPS
-            ret = Cache::Instance()->ImageCache.GetImageFromCache(type, pos, zoom);
+            ret = Cache::Instance()->ImageCache.GetImageFromCache(type, tilePos, tileZoom);
             if (!ret.isEmpty()) {
                 errorvars.lock();
                 ++diag.tilesFromDB;
@@ -93,29 +107,26 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
 #ifdef DEBUG_GMAPS
                     qDebug() << "Add Tile to memory";
 #endif // DEBUG_GMAPS
-                    AddTileToMemoryCache(RawTile(type, pos, zoom), ret);
+                    AddTileToMemoryCache(RawTile(type, tilePos, tileZoom), ret);
                 }
                 return ret;
             }
         }
         if (accessmode != AccessMode::CacheOnly) {
-            QNetworkReply *reply;
             QNetworkRequest qheader;
-            QNetworkAccessManager network;
             // This SSL Hack is half assed... technically bad *security* joojoo.
             // Required due to a QT5 bug on linux and Mac
             //
             QSslConfiguration conf = qheader.sslConfiguration();
             conf.setPeerVerifyMode(QSslSocket::VerifyNone);
             qheader.setSslConfiguration(conf);
-            network.setProxy(Proxy);
 #ifdef DEBUG_GMAPS
             qDebug() << "Try Tile from the Internet";
 #endif // DEBUG_GMAPS
 #ifdef DEBUG_TIMINGS
             qDebug() << "opmaps before make image url" << time.elapsed();
 #endif
-            QString url = MakeImageUrl(type, pos, zoom, LanguageStr);
+            QString url = MakeImageUrl(type, tilePos, tileZoom, LanguageStr);
 #ifdef DEBUG_TIMINGS
             qDebug() << "opmaps after make image url" << time.elapsed();
 #endif // url can be hard coded for debugging purposes
@@ -185,27 +196,17 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
             qDebug() << "Timeout is " << Timeout;
             qDebug() << "Get " << qheader.url();
 #endif // DEBUG_GMAPS
-            reply = network.get(qheader);
-#ifdef DEBUG_GMAPS
-            qDebug() << "reply " << reply;
-#endif // DEBUG_GMAPS
-
-            QTime time;
-            while ((!(reply->isFinished()) || (time.elapsed() > (6 * Timeout)))) {
-                QCoreApplication::processEvents(QEventLoop::AllEvents);
+            bool dropped = false;
+            ret = downloader->Get(qheader, Proxy, priority, zoom, pos, 6 * Timeout, &dropped);
+            if (cancelled) {
+                *cancelled = dropped;
             }
-
 #ifdef DEBUG_GMAPS
-            qDebug() << "Finished?" << reply->error() << " abort?" << (time.elapsed() > Timeout * 6);
+            qDebug() << "Finished? size " << ret.size() << " cancelled " << dropped;
 #endif // DEBUG_GMAPS
-            // If you are seeing Error 6 here you are dealing with a QT SSL Bug!!!
-            if ((reply->error() != QNetworkReply::NoError) | (time.elapsed() > Timeout * 6)) {
-                qWarning() << "Reply error: " << reply->errorString() << qheader.url();
+            if (dropped) {
                 return ret;
             }
-            ret = reply->readAll();
-            // qDebug() << "ret " << ret;
-            reply->deleteLater(); // TODO can't this be global??
 
             if (ret.isEmpty()) {
 #ifdef DEBUG_GMAPS
@@ -226,13 +227,13 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
 #ifdef DEBUG_GMAPS
                 qDebug() << "Add Tile to memory cache";
 #endif // DEBUG_GMAPS
-                AddTileToMemoryCache(RawTile(type, pos, zoom), ret);
+                AddTileToMemoryCache(RawTile(type, tilePos, tileZoom), ret);
             }
             if (accessmode != AccessMode::ServerOnly) {
 #ifdef DEBUG_GMAPS
                 qDebug() << "Add tile to DataBase";
 #endif // DEBUG_GMAPS
-                CacheItemQueue *item = new CacheItemQueue(type, pos, ret, zoom);
+                CacheItemQueue *item = new CacheItemQueue(type, tilePos, ret, tileZoom);
                 TileDBcacheQueue.EnqueueCacheTask(item);
             }
         }
@@ -259,6 +260,9 @@ diagnostics OPMaps::GetDiagnostics()
     errorvars.lock();
     i = diag;
     errorvars.unlock();
+    i.memoryCacheMisses    = TilesInMemory.Misses();
+    i.memoryCacheEvictions = TilesInMemory.Evictions();
+    i.memoryCacheKBytes    = (int)(TilesInMemory.MemoryCacheSize() * 1024);
     return i;
 }
 }
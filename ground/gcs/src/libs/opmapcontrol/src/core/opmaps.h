@@ -40,6 +40,8 @@
 #include "alllayersoftype.h"
 #include "urlfactory.h"
 #include "diagnostics.h"
+#include "tiledownloader.h"
+#include <QThread>
 
 // #include "point.h"
 
@@ -56,7 +58,16 @@ public: ~OPMaps();
     /// </summary>
 
 
-    QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom);
+    /**
+     * Returns the tile from the memory cache, the database or the server.
+     * View tiles pass their distance to the view center as priority, so the closest ones are downloaded first;
+     * cancelled is set when the download was dropped by CancelTilesNotIn().
+     */
+    QByteArray GetImageFrom(const MapType::Types &type, const core::Point &pos, const int &zoom, const int &priority = TileDownloader::BackgroundPriority, bool *cancelled = 0);
+    void CancelTilesNotIn(const int &zoom, const QList<core::Point> &wanted)
+    {
+        downloader->CancelTilesNotIn(zoom, wanted);
+    }
     bool UseMemoryCache()
     {
         return useMemoryCache;
@@ -90,6 +101,8 @@ private:
     AccessMode::Types accessmode;
     // PureImageCache ImageCacheLocal;//TODO Criar acesso Get Set
     TileCacheQueue TileDBcacheQueue;
+    QThread downloaderThread;
+    TileDownloader *downloader;
     OPMaps();
     OPMaps(OPMaps const &) {}
     OPMaps & operator=(OPMaps const &)
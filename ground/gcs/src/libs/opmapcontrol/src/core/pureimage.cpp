@@ -35,6 +35,16 @@ QPixmap PureImageProxy::FromStream(const QByteArray &array)
 {
     return QPixmap::fromImage(QImage::fromData(array));
 }
+QImage PureImageProxy::DecodeStream(const QByteArray &array)
+{
+    QImage image = QImage::fromData(array);
+
+    // premultiplied ARGB is what the raster engine blits without conversion
+    if (!image.isNull() && image.format() != QImage::Format_ARGB32_Premultiplied) {
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    return image;
+}
 bool PureImageProxy::Save(const QByteArray &array, QPixmap &pic)
 {
     pic = QPixmap::fromImage(QImage::fromData(array));
@@ -28,6 +28,7 @@
 #define PUREIMAGE_H
 
 #include <QPixmap>
+#include <QImage>
 #include <QByteArray>
 
 
@@ -36,6 +37,8 @@ class PureImageProxy {
 public:
     PureImageProxy();
     static QPixmap FromStream(const QByteArray &array);
+    // Thread safe variant of FromStream, usable from the tile loader threads
+    static QImage DecodeStream(const QByteArray &array);
     static bool Save(const QByteArray &array, QPixmap &pic);
 };
 }
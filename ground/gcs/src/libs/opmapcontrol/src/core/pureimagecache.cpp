@@ -30,14 +30,104 @@
 // #define DEBUG_PUREIMAGECACHE
 namespace core {
 qlonglong PureImageCache::ConnCounter = 0;
+QAtomicInt PureImageCacheConnection::counter;
 
-PureImageCache::PureImageCache()
+PureImageCacheConnection::PureImageCacheConnection(const QString &file, int generation) :
+    name(QString("ImageCacheConn%1").arg(counter.fetchAndAddRelaxed(1))), generation(generation), open(false)
+{
+    QSqlDatabase cn = QSqlDatabase::addDatabase("QSQLITE", name);
+
+    cn.setDatabaseName(file);
+    // separate connections in WAL mode let readers run while the writer commits
+    cn.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    if (!cn.open()) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "PureImageCacheConnection: Unable to open database " << cn.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        return;
+    }
+    QSqlQuery query(cn);
+    query.exec("PRAGMA journal_mode=WAL");
+    query.exec("PRAGMA synchronous=NORMAL");
+    // databases created by older versions lack the lookup index
+    query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+    query.exec("CREATE TABLE IF NOT EXISTS Texts (Type INTEGER NOT NULL, Key TEXT NOT NULL, Text TEXT, Date TEXT, PRIMARY KEY (Type, Key))");
+
+    selectTile = QSqlQuery(cn);
+    selectTile.setForwardOnly(true);
+    existsTile = QSqlQuery(cn);
+    existsTile.setForwardOnly(true);
+    insertTile = QSqlQuery(cn);
+    insertTileData = QSqlQuery(cn);
+    selectTexts    = QSqlQuery(cn);
+    selectTexts.setForwardOnly(true);
+    insertText     = QSqlQuery(cn);
+    open = selectTile.prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=? LIMIT 1)")
+           && existsTile.prepare("SELECT 1 FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=? LIMIT 1")
+           && insertTile.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)")
+           && insertTileData.prepare("INSERT INTO TilesData(id, Tile) VALUES(?, ?)")
+           && selectTexts.prepare("SELECT Key, Text FROM Texts WHERE Type=?")
+           && insertText.prepare("INSERT OR REPLACE INTO Texts(Type, Key, Text, Date) VALUES(?, ?, ?, ?)");
+#ifdef DEBUG_PUREIMAGECACHE
+    if (!open) {
+        qDebug() << "PureImageCacheConnection: Unable to prepare statements " << cn.lastError().driverText();
+    }
+#endif // DEBUG_PUREIMAGECACHE
+}
+PureImageCacheConnection::~PureImageCacheConnection()
+{
+    // the statements must be released before the connection can be removed
+    selectTile     = QSqlQuery();
+    existsTile     = QSqlQuery();
+    insertTile     = QSqlQuery();
+    insertTileData = QSqlQuery();
+    selectTexts    = QSqlQuery();
+    insertText     = QSqlQuery();
+    {
+        QSqlDatabase cn = QSqlDatabase::database(name, false);
+        cn.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+PureImageCache::PureImageCache() : generation(0)
 {}
 
+PureImageCacheConnection *PureImageCache::Connection()
+{
+    // caller holds lock for reading
+    PureImageCacheConnection *cn = connections.localData();
+
+    if (cn && cn->Generation() != generation) {
+        delete cn;
+        cn = 0;
+    }
+    if (!cn) {
+        cn = new PureImageCacheConnection(gtilecache + "Data.qmdb", generation);
+        connections.setLocalData(cn);
+    }
+    return cn->IsOpen() ? cn : 0;
+}
+bool PureImageCache::InsertTile(PureImageCacheConnection *cn, const QByteArray &tile, const MapType::Types &type, const Point &pos, const int &zoom)
+{
+    cn->insertTile.addBindValue(pos.X());
+    cn->insertTile.addBindValue(pos.Y());
+    cn->insertTile.addBindValue(zoom);
+    cn->insertTile.addBindValue((int)type);
+    cn->insertTile.addBindValue(QDateTime::currentDateTime().toString());
+    if (!cn->insertTile.exec()) {
+        return false;
+    }
+    cn->insertTileData.addBindValue(cn->insertTile.lastInsertId());
+    cn->insertTileData.addBindValue(tile);
+    return cn->insertTileData.exec();
+}
+
 void PureImageCache::setGtileCache(const QString &value)
 {
     lock.lockForWrite();
     gtilecache = value;
+    ++generation;
     QDir d;
     if (!d.exists(gtilecache)) {
         d.mkdir(gtilecache);
@@ -101,6 +191,14 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     if (query.numRowsAffected() == -1) {
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        db.close();
+        return false;
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+    if (query.numRowsAffected() == -1) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
 #endif // DEBUG_PUREIMAGECACHE
         db.close();
         return false;
@@ -150,6 +248,14 @@ bool PureImageCache::CreateEmptyDB(const QString &file)
     if (query.numRowsAffected() == -1) {
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        db.close();
+        return false;
+    }
+    query.exec("CREATE TABLE IF NOT EXISTS Texts (Type INTEGER NOT NULL, Key TEXT NOT NULL, Text TEXT, Date TEXT, PRIMARY KEY (Type, Key))");
+    if (query.numRowsAffected() == -1) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "CreateEmptyDB: " << query.lastError().driverText();
 #endif // DEBUG_PUREIMAGECACHE
         db.close();
         return false;
@@ -167,80 +273,140 @@ bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Type
 #ifdef DEBUG_PUREIMAGECACHE
     qDebug() << "PutImageToCache Start:"; // <<pos;
 #endif // DEBUG_PUREIMAGECACHE
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
-    {
-        QSqlDatabase cn;
-        cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
-        QString db = gtilecache + "Data.qmdb";
-        cn.setDatabaseName(db);
-        cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (cn.open()) {
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                query.addBindValue(pos.X());
-                query.addBindValue(pos.Y());
-                query.addBindValue(zoom);
-
-                query.addBindValue((int)type);
-                query.addBindValue(QDateTime::currentDateTime().toString());
-                query.exec();
-            }
-            {
-                QSqlQuery query(cn);
-                query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                query.addBindValue(tile);
-                query.exec();
+    bool ret = false;
+    PureImageCacheConnection *cn = Connection();
+    if (cn) {
+        QSqlDatabase db = cn->Database();
+        db.transaction();
+        if (InsertTile(cn, tile, type, pos, zoom)) {
+            ret = db.commit();
+        } else {
+            db.rollback();
+        }
+    }
+    lock.unlock();
+    return ret;
+}
+bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue *> &tiles)
+{
+    if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        return false;
+    }
+    lock.lockForRead();
+#ifdef DEBUG_PUREIMAGECACHE
+    qDebug() << "PutImagesToCache Start:" << tiles.count();
+#endif // DEBUG_PUREIMAGECACHE
+    bool ret = false;
+    PureImageCacheConnection *cn = Connection();
+    if (cn) {
+        QSqlDatabase db = cn->Database();
+        db.transaction();
+        foreach(CacheItemQueue * task, tiles) {
+            // a failed tile only loses itself, the rest of the batch is still committed
+            if (!InsertTile(cn, task->GetImg(), task->GetMapType(), task->GetPosition(), task->GetZoom())) {
+#ifdef DEBUG_PUREIMAGECACHE
+                qDebug() << "PutImagesToCache: " << db.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
             }
-            cn.close();
         }
+        ret = db.commit();
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
     lock.unlock();
-    return true;
+    return ret;
 }
 QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
 {
-    lock.lockForRead();
     QByteArray ar;
+
+    lock.lockForRead();
     if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        lock.unlock();
         return ar;
     }
-    QString dir  = gtilecache;
-    Mcounter.lock();
-    qlonglong id = ++ConnCounter;
-    Mcounter.unlock();
 #ifdef DEBUG_PUREIMAGECACHE
-    qDebug() << "Cache dir=" << dir << " Try to GET:" << pos.X() + "," + pos.Y();
+    qDebug() << "Cache dir=" << gtilecache << " Try to GET:" << pos.X() + "," + pos.Y();
 #endif // DEBUG_PUREIMAGECACHE
 
-    {
-        QString db = dir + "Data.qmdb";
-        {
-            QSqlDatabase cn;
+    PureImageCacheConnection *cn = Connection();
+    if (cn) {
+        cn->selectTile.addBindValue(pos.X());
+        cn->selectTile.addBindValue(pos.Y());
+        cn->selectTile.addBindValue(zoom);
+        cn->selectTile.addBindValue((int)type);
+        if (cn->selectTile.exec() && cn->selectTile.next()) {
+            ar = cn->selectTile.value(0).toByteArray();
+        }
+        // release the read snapshot so the WAL can be checkpointed
+        cn->selectTile.finish();
+    }
+    lock.unlock();
+    return ar;
+}
+bool PureImageCache::IsImageInCache(MapType::Types type, Point pos, int zoom)
+{
+    bool ret = false;
 
-            cn = QSqlDatabase::addDatabase("QSQLITE", QString::number(id));
+    lock.lockForRead();
+    if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        lock.unlock();
+        return ret;
+    }
+    PureImageCacheConnection *cn = Connection();
+    if (cn) {
+        cn->existsTile.addBindValue(pos.X());
+        cn->existsTile.addBindValue(pos.Y());
+        cn->existsTile.addBindValue(zoom);
+        cn->existsTile.addBindValue((int)type);
+        ret = cn->existsTile.exec() && cn->existsTile.next();
+        cn->existsTile.finish();
+    }
+    lock.unlock();
+    return ret;
+}
+QHash<QString, QString> PureImageCache::GetTextsFromCache(int type)
+{
+    QHash<QString, QString> texts;
 
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if (cn.open()) {
-                {
-                    QSqlQuery query(cn);
-                    query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int)type));
-                    query.next();
-                    if (query.isValid()) {
-                        ar = query.value(0).toByteArray();
-                    }
-                }
-                cn.close();
+    lock.lockForRead();
+    if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        lock.unlock();
+        return texts;
+    }
+    PureImageCacheConnection *cn = Connection();
+    if (cn) {
+        cn->selectTexts.addBindValue(type);
+        if (cn->selectTexts.exec()) {
+            while (cn->selectTexts.next()) {
+                texts.insert(cn->selectTexts.value(0).toString(), cn->selectTexts.value(1).toString());
             }
         }
+        cn->selectTexts.finish();
     }
-    QSqlDatabase::removeDatabase(QString::number(id));
     lock.unlock();
-    return ar;
+    return texts;
+}
+bool PureImageCache::PutTextToCache(int type, const QString &key, const QString &text)
+{
+    if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        return false;
+    }
+    lock.lockForRead();
+    bool ret = false;
+    PureImageCacheConnection *cn = Connection();
+    if (cn) {
+        cn->insertText.addBindValue(type);
+        cn->insertText.addBindValue(key);
+        cn->insertText.addBindValue(text);
+        cn->insertText.addBindValue(QDateTime::currentDateTime().toString());
+        ret = cn->insertText.exec();
+#ifdef DEBUG_PUREIMAGECACHE
+        if (!ret) {
+            qDebug() << "PutTextToCache: " << cn->insertText.lastError().driverText();
+        }
+#endif // DEBUG_PUREIMAGECACHE
+    }
+    lock.unlock();
+    return ret;
 }
 void PureImageCache::deleteOlderTiles(int const & days)
 {
@@ -315,10 +481,12 @@ bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
                 }
             }
             long f;
+            cb.transaction();
             foreach(f, add) {
                 queryb.exec(QString("INSERT INTO Tiles(X, Y, Zoom, Type, Date) SELECT X, Y, Zoom, Type, Date FROM Source.Tiles WHERE id=%1").arg(f));
                 queryb.exec(QString("INSERT INTO TilesData(id, Tile) Values((SELECT last_insert_rowid()), (SELECT Tile FROM Source.TilesData WHERE id=%1))").arg(f));
             }
+            cb.commit();
             add.clear();
             ca.close();
             cb.close();
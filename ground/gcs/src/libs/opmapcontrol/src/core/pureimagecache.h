@@ -40,21 +40,77 @@
 #include <QVariant>
 #include "pureimage.h"
 #include <QList>
+#include <QHash>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
+#include <QAtomicInt>
+#include "cacheitemqueue.h"
 namespace core {
+/**
+ * Database connection owned by a single thread, with its statements prepared once.
+ * QSqlDatabase connections can only be used from the thread that created them.
+ */
+class PureImageCacheConnection {
+public:
+    PureImageCacheConnection(const QString &file, int generation);
+    ~PureImageCacheConnection();
+    bool IsOpen() const
+    {
+        return open;
+    }
+    int Generation() const
+    {
+        return generation;
+    }
+    QSqlDatabase Database() const
+    {
+        return QSqlDatabase::database(name, false);
+    }
+    QSqlQuery selectTile;
+    QSqlQuery existsTile;
+    QSqlQuery insertTile;
+    QSqlQuery insertTileData;
+    QSqlQuery selectTexts;
+    QSqlQuery insertText;
+private:
+    QString name;
+    int generation;
+    bool open;
+    static QAtomicInt counter;
+};
+
 class PureImageCache {
 public:
     PureImageCache();
     static bool CreateEmptyDB(const QString &file);
     bool PutImageToCache(const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
+    /**
+     * Stores several tiles in a single transaction, so they share one journal sync.
+     */
+    bool PutImagesToCache(const QList<CacheItemQueue *> &tiles);
     QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
+    /**
+     * Cheaper than GetImageFromCache when only the presence of the tile matters, the data is not read.
+     */
+    bool IsImageInCache(MapType::Types type, core::Point pos, int zoom);
+    /**
+     * Text results (geocoder, placemark, route) are kept in the tile database, one row per query.
+     * All the entries of a type are read at once as they are small and few.
+     */
+    QHash<QString, QString> GetTextsFromCache(int type);
+    bool PutTextToCache(int type, const QString &key, const QString &text);
     QString GtileCache();
     void setGtileCache(const QString &value);
     static bool ExportMapDataToDB(QString sourceFile, QString destFile);
     void deleteOlderTiles(int const & days);
 private:
+    PureImageCacheConnection *Connection();
+    bool InsertTile(PureImageCacheConnection *cn, const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
     QString gtilecache;
+    // bumped when the cache moves so stale per thread connections get reopened
+    int generation;
+    QThreadStorage<PureImageCacheConnection *> connections;
     QMutex Mcounter;
     QReadWriteLock lock;
     static qlonglong ConnCounter;
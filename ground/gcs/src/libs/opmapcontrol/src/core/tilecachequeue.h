@@ -50,6 +50,8 @@ protected:
     QQueue<CacheItemQueue *> tileCacheQueue;
 private:
     void run();
+    // tiles written per transaction, bounds the time the writer keeps the database locked
+    static const int MaxBatchSize = 64;
     QMutex mutex;
     QMutex waitmutex;
     QWaitCondition waitc;
@@ -0,0 +1,175 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tiledownloader.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      Shared tile downloader with persistent connections
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tiledownloader.h"
+#include <QElapsedTimer>
+#include <climits>
+
+// #define DEBUG_TILEDOWNLOADER
+
+namespace core {
+TileDownloader::TileDownloader() : network(new QNetworkAccessManager(this))
+{}
+
+QByteArray TileDownloader::Get(const QNetworkRequest &request, const QNetworkProxy &proxy, int priority, int zoom, const Point &pos, int timeoutMs, bool *cancelled)
+{
+    TileRequestPtr task(new TileRequest);
+
+    task->request   = request;
+    task->request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    task->request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
+    task->proxy     = proxy;
+    task->priority  = (priority < 0) ? INT_MAX : priority;
+    task->zoom      = zoom;
+    task->pos       = pos;
+    task->reply     = 0;
+    task->done      = false;
+    task->cancelled = false;
+
+    QElapsedTimer time;
+    bool timedOut = false;
+    time.start();
+
+    mutex.lock();
+    pending.append(task);
+    QMetaObject::invokeMethod(this, "startRequests", Qt::QueuedConnection);
+    while (!task->done) {
+        qint64 left = timeoutMs - time.elapsed();
+        if (left <= 0 || !finished.wait(&mutex, left)) {
+            if (!task->done) {
+#ifdef DEBUG_TILEDOWNLOADER
+                qDebug() << "TileDownloader: timeout " << task->request.url();
+#endif // DEBUG_TILEDOWNLOADER
+                timedOut = true;
+                task->cancelled = true;
+                pending.removeOne(task);
+                QMetaObject::invokeMethod(this, "abortCancelled", Qt::QueuedConnection);
+                break;
+            }
+        }
+    }
+    QByteArray data = task->data;
+    if (cancelled) {
+        *cancelled = task->cancelled && !timedOut;
+    }
+    mutex.unlock();
+    return data;
+}
+
+void TileDownloader::CancelTilesNotIn(int zoom, const QList<Point> &wanted)
+{
+    bool abort = false;
+
+    mutex.lock();
+    for (int i = pending.count() - 1; i >= 0; --i) {
+        TileRequestPtr task = pending.at(i);
+        if (task->priority != INT_MAX && (task->zoom != zoom || !wanted.contains(task->pos))) {
+            pending.removeAt(i);
+            task->cancelled = true;
+            task->done = true;
+        }
+    }
+    foreach(TileRequestPtr task, active) {
+        if (task->priority != INT_MAX && (task->zoom != zoom || !wanted.contains(task->pos))) {
+            task->cancelled = true;
+            abort = true;
+        }
+    }
+    finished.wakeAll();
+    mutex.unlock();
+    if (abort) {
+        QMetaObject::invokeMethod(this, "abortCancelled", Qt::QueuedConnection);
+    }
+}
+
+void TileDownloader::startRequests()
+{
+    QMutexLocker locker(&mutex);
+
+    while (active.count() < MaxActiveRequests && !pending.isEmpty()) {
+        int next = 0;
+        for (int i = 1; i < pending.count(); ++i) {
+            if (pending.at(i)->priority < pending.at(next)->priority) {
+                next = i;
+            }
+        }
+        TileRequestPtr task = pending.takeAt(next);
+        if (network->proxy() != task->proxy) {
+            network->setProxy(task->proxy);
+        }
+#ifdef DEBUG_TILEDOWNLOADER
+        qDebug() << "TileDownloader: get " << task->request.url() << " priority " << task->priority;
+#endif // DEBUG_TILEDOWNLOADER
+        task->reply = network->get(task->request);
+        connect(task->reply, SIGNAL(finished()), this, SLOT(requestFinished()));
+        active.insert(task->reply, task);
+    }
+}
+
+void TileDownloader::abortCancelled()
+{
+    QList<QNetworkReply *> aborted;
+
+    mutex.lock();
+    foreach(TileRequestPtr task, active) {
+        if (task->cancelled) {
+            aborted.append(task->reply);
+        }
+    }
+    mutex.unlock();
+    // abort() emits finished() synchronously, so it must run without the mutex held
+    foreach(QNetworkReply * reply, aborted) {
+        reply->abort();
+    }
+}
+
+void TileDownloader::requestFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+
+    if (!reply) {
+        return;
+    }
+    mutex.lock();
+    TileRequestPtr task = active.take(reply);
+    if (task) {
+        if (!task->cancelled) {
+            // If you are seeing Error 6 here you are dealing with a QT SSL Bug!!!
+            if (reply->error() != QNetworkReply::NoError) {
+                qWarning() << "Reply error: " << reply->errorString() << task->request.url();
+            } else {
+                task->data = reply->readAll();
+            }
+        }
+        task->reply = 0;
+        task->done  = true;
+        finished.wakeAll();
+    }
+    mutex.unlock();
+    reply->deleteLater();
+    startRequests();
+}
+}
@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tiledownloader.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      Shared tile downloader with persistent connections
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEDOWNLOADER_H
+#define TILEDOWNLOADER_H
+
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSharedPointer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkProxy>
+#include "point.h"
+
+namespace core {
+/**
+ * Downloads the map tiles through a single QNetworkAccessManager living in its own thread,
+ * so all the loader threads share the same keep-alive (and HTTP/2 when available) connections.
+ * Get() blocks the calling loader thread until its tile arrived, was cancelled or timed out.
+ */
+class TileDownloader : public QObject {
+    Q_OBJECT
+public:
+    // priority of the requests that are not tied to the view, like the map ripper
+    static const int BackgroundPriority = -1;
+
+    TileDownloader();
+
+    /**
+     * Queues the request and waits for the reply.
+     * Requests with a lower priority value are sent first, BackgroundPriority ones last.
+     * Returns the tile data, empty on error, timeout or cancellation.
+     */
+    QByteArray Get(const QNetworkRequest &request, const QNetworkProxy &proxy, int priority, int zoom, const core::Point &pos, int timeoutMs, bool *cancelled = 0);
+    /**
+     * Drops the view requests for tiles which are no longer in the list,
+     * aborting them if they are already on the wire.
+     */
+    void CancelTilesNotIn(int zoom, const QList<core::Point> &wanted);
+
+private slots:
+    void startRequests();
+    void abortCancelled();
+    void requestFinished();
+
+private:
+    struct TileRequest {
+        QNetworkRequest request;
+        QNetworkProxy proxy;
+        int priority;
+        int zoom;
+        core::Point pos;
+        QNetworkReply *reply;
+        QByteArray data;
+        bool done;
+        bool cancelled;
+    };
+    typedef QSharedPointer<TileRequest> TileRequestPtr;
+
+    // enough to keep the pipe full, QNetworkAccessManager itself uses 6 connections per host
+    static const int MaxActiveRequests = 12;
+
+    QNetworkAccessManager *network;
+    QMutex mutex;
+    QWaitCondition finished;
+    QList<TileRequestPtr> pending;
+    QHash<QNetworkReply *, TileRequestPtr> active;
+};
+}
+#endif // TILEDOWNLOADER_H
@@ -50,9 +50,23 @@ UrlFactory::UrlFactory()
     isCorrectedGoogleVersions = false;
     UseGeocoderCache = true;
     UsePlacemarkCache = true;
+    vectorTileUrl     = "http://localhost:8080/data/v3/{z}/{x}/{y}.pbf";
+    VectorTileMaxZoom = 14;
 }
 UrlFactory::~UrlFactory()
 {}
+void UrlFactory::SetVectorTileUrl(const QString &url)
+{
+    QMutexLocker locker(&vectorTileMutex);
+
+    vectorTileUrl = url;
+}
+QString UrlFactory::VectorTileUrl()
+{
+    QMutexLocker locker(&vectorTileMutex);
+
+    return vectorTileUrl;
+}
 QString UrlFactory::TileXYToQuadKey(const int &tileX, const int &tileY, const int &levelOfDetail) const
 {
     QString quadKey;
@@ -460,6 +474,16 @@ QString UrlFactory::MakeImageUrl(const MapType::Types &type, const Point &pos, c
         return QString("http://opencache.statkart.no/gatekeeper/gk/gk.open_gmaps?layers=topo2&zoom=%1&x=%2&y=%3").arg(zoom).arg(pos.X()).arg(pos.Y());
     }
 
+    break;
+    case MapType::OpenMapTiles_Vector:
+    {
+        QString url = VectorTileUrl();
+#ifdef DEBUG_URLFACTORY
+        qDebug() << url;
+#endif
+        return url.replace("{z}", QString::number(zoom)).replace("{x}", QString::number(pos.X())).replace("{y}", QString::number(pos.Y()));
+    }
+
     break;
     default:
         break;
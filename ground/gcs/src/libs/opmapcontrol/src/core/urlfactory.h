@@ -56,6 +56,14 @@ public:
     UrlFactory();
     ~UrlFactory();
     QString MakeImageUrl(const MapType::Types &type, const core::Point &pos, const int &zoom, const QString &language);
+    /**
+     * Url template of the vector tile server, {z} {x} and {y} are replaced by the tile coordinates.
+     * Defaults to a local tileserver-gl serving an OpenMapTiles pack.
+     */
+    void SetVectorTileUrl(const QString &url);
+    QString VectorTileUrl();
+    // deepest zoom the vector tile server has, deeper tiles are cut out of these
+    int VectorTileMaxZoom;
     internals::PointLatLng GetLatLngFromGeodecoder(const QString &keywords, QString &status);
     Placemark GetPlacemarkFromGeocoder(internals::PointLatLng location);
     int Timeout;
@@ -71,6 +79,8 @@ private:
     static const double EarthRadiusKm;
     double GetDistance(internals::PointLatLng p1, internals::PointLatLng p2);
     QMutex mutex;
+    QMutex vectorTileMutex;
+    QString vectorTileUrl;
 
 protected:
     static short timelapse;
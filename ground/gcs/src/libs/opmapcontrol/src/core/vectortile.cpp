@@ -0,0 +1,443 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vectortile.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      Mapbox vector tile decoder and renderer
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "vectortile.h"
+#include "debugheader.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QDebug>
+#include <cstring>
+
+namespace core {
+namespace {
+/**
+ * Minimal protocol buffers reader, just what the MVT messages use.
+ * A truncated or malformed message ends the reader, it never reads past end.
+ */
+struct PbfReader {
+    PbfReader() : p(0), end(0), tag(0), wire(0) {}
+    PbfReader(const char *begin, const char *end) : p(begin), end(end), tag(0), wire(0) {}
+
+    bool Next()
+    {
+        quint64 key;
+
+        if (p >= end || !Varint(key)) {
+            return false;
+        }
+        tag  = (quint32)(key >> 3);
+        wire = (int)(key & 7);
+        return true;
+    }
+    bool Varint(quint64 &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            quint8 b = (quint8)*p++;
+            value |= (quint64)(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return true;
+            }
+        }
+        p = end;
+        return false;
+    }
+    quint32 UInt32()
+    {
+        quint64 value = 0;
+
+        Varint(value);
+        return (quint32)value;
+    }
+    bool Message(PbfReader &sub)
+    {
+        quint64 length;
+
+        if (!Varint(length) || length > (quint64)(end - p)) {
+            p = end;
+            return false;
+        }
+        sub = PbfReader(p, p + length);
+        p  += length;
+        return true;
+    }
+    QString String()
+    {
+        PbfReader sub;
+
+        Message(sub);
+        return QString::fromUtf8(sub.p, (int)(sub.end - sub.p));
+    }
+    template<typename T> T Fixed()
+    {
+        T value = 0;
+
+        if (end - p < (int)sizeof(T)) {
+            p = end;
+            return value;
+        }
+        memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+    void Skip()
+    {
+        switch (wire) {
+        case 0:
+        {
+            quint64 value;
+            Varint(value);
+        }
+        break;
+        case 1:
+            Fixed<quint64>();
+            break;
+        case 2:
+        {
+            PbfReader sub;
+            Message(sub);
+        }
+        break;
+        case 5:
+            Fixed<quint32>();
+            break;
+        default:
+            // groups are not used by MVT
+            p = end;
+            break;
+        }
+    }
+    const char *p;
+    const char *end;
+    quint32 tag;
+    int wire;
+};
+
+// MVT field numbers
+enum {
+    TileLayers      = 3,
+    LayerName       = 1,
+    LayerFeatures   = 2,
+    LayerKeys       = 3,
+    LayerValues     = 4,
+    LayerExtent     = 5,
+    FeatureTags     = 2,
+    FeatureType     = 3,
+    FeatureGeometry = 4,
+    ValueString     = 1
+};
+enum GeomType {
+    GeomUnknown    = 0,
+    GeomPoint      = 1,
+    GeomLineString = 2,
+    GeomPolygon    = 3
+};
+enum Command {
+    MoveTo     = 1,
+    LineTo     = 2,
+    ClosePath  = 7
+};
+
+// OpenMapTiles layers, in drawing order
+const char *const layerOrder[] = {
+    "water", "landcover", "landuse", "park", "aeroway", "waterway", "building", "transportation", "boundary"
+};
+
+struct Style {
+    Style() : width(0), dashed(false) {}
+    QColor fill;
+    QColor line;
+    qreal width;
+    bool dashed;
+};
+
+Style LayerStyle(QString const & layer, QString const & cls, int type)
+{
+    Style s;
+
+    if (layer == "water") {
+        s.fill = QColor(160, 200, 240);
+    } else if (layer == "waterway") {
+        s.line  = QColor(160, 200, 240);
+        s.width = (cls == "river") ? 2 : 1;
+    } else if (layer == "landcover") {
+        if (cls == "wood" || cls == "forest") {
+            s.fill = QColor(214, 230, 198);
+        } else if (cls == "ice") {
+            s.fill = QColor(255, 255, 255);
+        } else if (cls == "sand") {
+            s.fill = QColor(245, 238, 188);
+        } else if (cls == "wetland") {
+            s.fill = QColor(224, 238, 221);
+        } else {
+            s.fill = QColor(227, 239, 209);
+        }
+    } else if (layer == "landuse") {
+        if (cls == "industrial") {
+            s.fill = QColor(233, 226, 228);
+        } else if (cls == "commercial" || cls == "retail") {
+            s.fill = QColor(240, 226, 228);
+        } else if (cls == "cemetery") {
+            s.fill = QColor(221, 229, 215);
+        } else {
+            s.fill = QColor(236, 231, 228);
+        }
+    } else if (layer == "park") {
+        s.fill = QColor(216, 232, 200);
+    } else if (layer == "aeroway") {
+        if (type == GeomPolygon) {
+            s.fill = QColor(229, 229, 229);
+        } else {
+            s.line  = QColor(255, 255, 255);
+            s.width = 2;
+        }
+    } else if (layer == "building") {
+        s.fill  = QColor(223, 216, 211);
+        s.line  = QColor(207, 198, 191);
+        s.width = 0.5;
+    } else if (layer == "transportation") {
+        if (type == GeomPolygon) {
+            s.fill = QColor(255, 255, 255);
+        } else if (cls == "motorway") {
+            s.line  = QColor(232, 146, 162);
+            s.width = 3;
+        } else if (cls == "trunk" || cls == "primary") {
+            s.line  = (cls == "trunk") ? QColor(249, 178, 156) : QColor(252, 214, 164);
+            s.width = 2.5;
+        } else if (cls == "secondary" || cls == "tertiary") {
+            s.line  = (cls == "secondary") ? QColor(247, 250, 191) : QColor(255, 255, 255);
+            s.width = 2;
+        } else if (cls == "rail" || cls == "transit") {
+            s.line   = QColor(154, 154, 154);
+            s.width  = 1;
+            s.dashed = true;
+        } else if (cls == "track" || cls == "path") {
+            s.line   = QColor(160, 142, 126);
+            s.width  = 0.8;
+            s.dashed = true;
+        } else {
+            s.line  = QColor(255, 255, 255);
+            s.width = 1.5;
+        }
+    } else if (layer == "boundary") {
+        s.line   = QColor(158, 156, 171);
+        s.width  = 1;
+        s.dashed = true;
+    }
+    return s;
+}
+
+qint32 ZigZag(quint32 n)
+{
+    return (qint32)(n >> 1) ^ -(qint32)(n & 1);
+}
+
+QPainterPath DecodeGeometry(PbfReader geometry, qreal scale, QPointF const & offset, int type)
+{
+    QPainterPath path;
+    qint32 x = 0;
+    qint32 y = 0;
+
+    path.setFillRule(Qt::OddEvenFill);
+    while (geometry.p < geometry.end) {
+        quint32 command = geometry.UInt32();
+        quint32 count   = command >> 3;
+        switch (command & 7) {
+        case MoveTo:
+        case LineTo:
+            for (quint32 i = 0; i < count && geometry.p < geometry.end; ++i) {
+                x += ZigZag(geometry.UInt32());
+                y += ZigZag(geometry.UInt32());
+                QPointF point(x * scale - offset.x(), y * scale - offset.y());
+                if ((command & 7) == MoveTo) {
+                    path.moveTo(point);
+                } else {
+                    path.lineTo(point);
+                }
+            }
+            break;
+        case ClosePath:
+            if (type == GeomPolygon) {
+                path.closeSubpath();
+            }
+            break;
+        default:
+            // not a vector tile geometry, drop the feature
+            return QPainterPath();
+        }
+    }
+    return path;
+}
+
+void RenderLayer(QPainter &painter, PbfReader layer, int const & size, int const & overzoom, QPointF const & offset)
+{
+    QString name;
+    QStringList keys;
+    QStringList values;
+    QList<PbfReader> features;
+    int extent = 4096;
+
+    // keys and values may follow the features, collect everything first
+    while (layer.Next()) {
+        switch (layer.tag) {
+        case LayerName:
+            name = layer.String();
+            break;
+        case LayerFeatures:
+        {
+            PbfReader feature;
+            if (layer.Message(feature)) {
+                features.append(feature);
+            }
+        }
+        break;
+        case LayerKeys:
+            keys.append(layer.String());
+            break;
+        case LayerValues:
+        {
+            PbfReader value;
+            QString str;
+            layer.Message(value);
+            while (value.Next()) {
+                if (value.tag == ValueString) {
+                    str = value.String();
+                } else {
+                    value.Skip();
+                }
+            }
+            values.append(str);
+        }
+        break;
+        case LayerExtent:
+            extent = qMax(1, (int)layer.UInt32());
+            break;
+        default:
+            layer.Skip();
+            break;
+        }
+    }
+
+    int classKey = keys.indexOf("class");
+    qreal scale  = (qreal)(size << overzoom) / extent;
+    QRectF view(0, 0, size, size);
+    // the style widths are for a 256 pixel tile
+    qreal widthScale = size / 256.0;
+
+    foreach(PbfReader feature, features) {
+        int type = GeomUnknown;
+        QString cls;
+        PbfReader geometry;
+
+        while (feature.Next()) {
+            if (feature.tag == FeatureType) {
+                type = (int)feature.UInt32();
+            } else if (feature.tag == FeatureGeometry && feature.wire == 2) {
+                feature.Message(geometry);
+            } else if (feature.tag == FeatureTags && feature.wire == 2) {
+                PbfReader tags;
+                feature.Message(tags);
+                while (tags.p < tags.end) {
+                    int key   = (int)tags.UInt32();
+                    int value = (int)tags.UInt32();
+                    if (key == classKey && value >= 0 && value < values.size()) {
+                        cls = values.at(value);
+                    }
+                }
+            } else {
+                feature.Skip();
+            }
+        }
+        // points are labels and POIs, which are not drawn on the tiles
+        if (type != GeomLineString && type != GeomPolygon) {
+            continue;
+        }
+        Style style = LayerStyle(name, cls, type);
+        if (!style.fill.isValid() && !style.line.isValid()) {
+            continue;
+        }
+        QPainterPath path = DecodeGeometry(geometry, scale, offset, type);
+        // overzoomed tiles only show a part of the features, the margin keeps straight lines which have no area
+        if (path.isEmpty() || !path.controlPointRect().adjusted(-1, -1, 1, 1).intersects(view)) {
+            continue;
+        }
+        if (type == GeomPolygon && style.fill.isValid()) {
+            painter.fillPath(path, style.fill);
+        }
+        if (style.line.isValid()) {
+            QPen pen(style.line, style.width * widthScale, style.dashed ? Qt::DashLine : Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
+            painter.strokePath(path, pen);
+        }
+    }
+}
+}
+
+QImage VectorTile::Render(const QByteArray &data, int const & size, int const & overzoom, int const & column, int const & row)
+{
+    PbfReader tile(data.constData(), data.constData() + data.size());
+    QHash<QString, QList<PbfReader> > layers;
+
+    while (tile.Next()) {
+        if (tile.tag == TileLayers && tile.wire == 2) {
+            PbfReader layer;
+            if (!tile.Message(layer)) {
+                break;
+            }
+            // peek at the name, the layer is rendered later in style order
+            PbfReader peek = layer;
+            while (peek.Next()) {
+                if (peek.tag == LayerName) {
+                    layers[peek.String()].append(layer);
+                    break;
+                }
+                peek.Skip();
+            }
+        } else {
+            tile.Skip();
+        }
+    }
+    if (layers.isEmpty()) {
+#ifdef DEBUG_VECTORTILE
+        qDebug() << "VectorTile::Render no layers in" << data.size() << "bytes" << (data.startsWith("\x1f\x8b") ? "(gzipped)" : "");
+#endif // DEBUG_VECTORTILE
+        return QImage();
+    }
+
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Background());
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    QPointF offset(column * size, row * size);
+    for (unsigned int i = 0; i < sizeof(layerOrder) / sizeof(layerOrder[0]); ++i) {
+        foreach(PbfReader layer, layers.value(layerOrder[i])) {
+            RenderLayer(painter, layer, size, overzoom, offset);
+        }
+    }
+    painter.end();
+    return image;
+}
+}
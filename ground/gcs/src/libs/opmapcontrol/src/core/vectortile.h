@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vectortile.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      Mapbox vector tile decoder and renderer
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef VECTORTILE_H
+#define VECTORTILE_H
+
+#include <QImage>
+#include <QByteArray>
+#include <QString>
+#include <QColor>
+
+namespace core {
+/**
+ * Renders Mapbox vector tiles (MVT, protobuf encoded) to images.
+ * The layers of the OpenMapTiles schema are styled, other layers are skipped.
+ * Only QImage and QPainter are used so tiles can be rendered by the loader threads.
+ */
+class VectorTile {
+public:
+    // tiles are rendered at this multiple of the tile size so the fractional zoom stays sharp
+    static const int Oversampling = 2;
+    /**
+     * Decodes and renders one tile.
+     *
+     * @param data the raw (not gzipped) tile
+     * @param size side of the image in pixels
+     * @param overzoom zoom levels between data and the rendered tile, which is a part of data when not 0
+     * @param column column of the rendered tile among the 2^overzoom of data
+     * @param row row of the rendered tile among the 2^overzoom of data
+     * @return the rendered tile, a null image if data is not a vector tile
+     */
+    static QImage Render(const QByteArray &data, int const & size, int const & overzoom = 0, int const & column = 0, int const & row = 0);
+    static QColor Background()
+    {
+        return QColor(248, 244, 240);
+    }
+};
+}
+#endif // VECTORTILE_H
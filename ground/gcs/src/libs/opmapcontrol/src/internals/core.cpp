@@ -25,6 +25,8 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "core.h"
+#include "../core/vectortile.h"
+#include <math.h>
 
 #ifdef DEBUG_CORE
 qlonglong internals::Core::debugcounter = 0;
@@ -104,6 +106,10 @@ void Core::run()
 
                         Tile *t = new Tile(task.Zoom, task.Pos);
                         QVector<MapType::Types> layers = OPMaps::Instance()->GetAllLayersOfType(GetMapType());
+                        // tiles closest to the view center are downloaded first
+                        Point center   = GetcenterTileXYLocation();
+                        int priority   = qAbs(task.Pos.X() - center.X()) + qAbs(task.Pos.Y() - center.Y());
+                        bool cancelled = false;
 
                         foreach(MapType::Types tl, layers) {
                             int retry = 0;
@@ -114,21 +120,33 @@ void Core::run()
 #ifdef DEBUG_CORE
                                 qDebug() << "start getting image" << " ID=" << debug;
 #endif // DEBUG_CORE
-                                img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                                img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom, priority, &cancelled);
 #ifdef DEBUG_CORE
                                 qDebug() << "Core::run:gotimage size:" << img.count() << " ID=" << debug << " time=" << t.elapsed();
 #endif // DEBUG_CORE
 
                                 if (img.length() != 0) {
+                                    // decode outside Moverlays so the loader threads decode in parallel
+                                    if (MapType::IsVector(tl)) {
+                                        // deeper than the server, img is the ancestor tile and this one a part of it
+                                        int overzoom = qMax(0, task.Zoom - OPMaps::Instance()->VectorTileMaxZoom);
+                                        int mask     = (1 << overzoom) - 1;
+                                        t->AppendOverlay(img, VectorTile::Render(img, Projection()->TileSize().Width() * VectorTile::Oversampling,
+                                                                                 overzoom, task.Pos.X() & mask, task.Pos.Y() & mask));
+                                    } else {
+                                        t->AppendOverlay(img);
+                                    }
                                     Moverlays.lock();
                                     {
-                                        t->Overlays.append(img);
 #ifdef DEBUG_CORE
                                         qDebug() << "Core::run append img:" << img.length() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
 #endif // DEBUG_CORE
                                     }
                                     Moverlays.unlock();
 
+                                    break;
+                                } else if (cancelled) {
+                                    // scrolled out of view, no point in retrying
                                     break;
                                 } else if (OPMaps::Instance()->RetryLoadTile > 0) {
 #ifdef DEBUG_CORE
@@ -142,9 +160,13 @@ void Core::run()
                                     }
                                 }
                             } while (++retry < OPMaps::Instance()->RetryLoadTile);
+                            if (cancelled) {
+                                break;
+                            }
                         }
 
-                        if (t->Overlays.count() > 0) {
+                        // a cancelled tile may miss some of its layers, it is loaded again when back in view
+                        if (!cancelled && t->Overlays.count() > 0) {
                             Matrix.SetTileAt(task.Pos, t);
                             emit OnNeedInvalidation();
 
@@ -168,9 +190,7 @@ void Core::run()
                 {
                     // last buddy cleans stuff ;}
                     if (last) {
-                        OPMaps::Instance()->kiberCacheLock.lockForWrite();
                         OPMaps::Instance()->TilesInMemory.RemoveMemoryOverload();
-                        OPMaps::Instance()->kiberCacheLock.unlock();
 
                         MtileDrawingList.lock();
                         {
@@ -254,6 +274,7 @@ void Core::SetMapType(const MapType::Types &value)
 {
     if (value != GetMapType()) {
         mapType = value;
+        prefetcher.Clear();
 
         switch (value) {
         case MapType::ArcGIS_Map:
@@ -528,6 +549,7 @@ void Core::UpdateBounds()
     MtileDrawingList.lock();
     {
         FindTilesAround(tileDrawingList);
+        OPMaps::Instance()->CancelTilesNotIn(Zoom(), tileDrawingList);
 
 #ifdef DEBUG_CORE
         qDebug() << "OnTileLoadStart: " << tileDrawingList.count() << " tiles to load at zoom " << Zoom() << ", time: " << QDateTime::currentDateTime().date();
@@ -559,6 +581,56 @@ void Core::UpdateBounds()
     MtileDrawingList.unlock();
     UpdateGroundResolution();
 }
+void Core::PrefetchAlong(QList<PointLatLng> const & path)
+{
+    if (!started || path.isEmpty()) {
+        return;
+    }
+    // the current level first, then the ones the user is most likely to zoom to
+    int levels[3] = { Zoom(), Zoom() + 1, Zoom() - 1 };
+    int step = Projection()->TileSize().Width() / 2;
+    QVector<PointLatLng> coords = path.toVector();
+    QVector<Point> pixels;
+
+    for (int l = 0; l < 3; ++l) {
+        int z = levels[l];
+        if (z < 1 || z > MaxZoom()) {
+            continue;
+        }
+        Size min = Projection()->GetTileMatrixMinXY(z);
+        Size max = Projection()->GetTileMatrixMaxXY(z);
+        QList<Point> tiles;
+        Projection()->FromLatLngToPixel(coords, z, pixels);
+        Point last = pixels.first();
+        AddPrefetchTiles(tiles, last, min, max);
+        for (int i = 1; i < pixels.count(); ++i) {
+            Point next = pixels.at(i);
+            double dx  = next.X() - last.X();
+            double dy  = next.Y() - last.Y();
+            // sample each leg at half a tile so no tile along it is skipped
+            int samples = qMin(1024, (int)ceil(sqrt(dx * dx + dy * dy) / step));
+            for (int s = 1; s <= samples; ++s) {
+                AddPrefetchTiles(tiles, Point(last.X() + dx * s / samples, last.Y() + dy * s / samples), min, max);
+            }
+            last = next;
+        }
+        prefetcher.Enqueue(GetMapType(), tiles, z);
+    }
+}
+void Core::AddPrefetchTiles(QList<Point> &list, Point const & pixel, Size const & min, Size const & max)
+{
+    Point center = Projection()->FromPixelToTileXY(pixel);
+
+    // the tile under the path and its neighbours, so the view around it is covered too
+    for (int i = -1; i <= 1; i++) {
+        for (int j = -1; j <= 1; j++) {
+            Point p(center.X() + i, center.Y() + j);
+            if (p.X() >= min.Width() && p.Y() >= min.Height() && p.X() <= max.Width() && p.Y() <= max.Height()) {
+                list.append(p);
+            }
+        }
+    }
+}
 void Core::FindTilesAround(QList<Point> &list)
 {
     list.clear();;
@@ -38,6 +38,7 @@
 #include "rectangle.h"
 #include "QThreadPool"
 #include "tilematrix.h"
+#include "tileprefetcher.h"
 #include <QQueue>
 #include "loadtask.h"
 #include "copyrightstrings.h"
@@ -250,6 +251,19 @@ public:
 
     void UpdateBounds();
 
+    /**
+     * Warms the tile caches along the path, at the current and the neighbouring zoom levels.
+     */
+    void PrefetchAlong(QList<PointLatLng> const & path);
+    void SetPrefetchBudget(int const & tilesPerSecond)
+    {
+        prefetcher.SetBudget(tilesPerSecond);
+    }
+    int PrefetchBudget() const
+    {
+        return prefetcher.Budget();
+    }
+
     MapType::Types GetMapType()
     {
         return mapType;
@@ -333,6 +347,8 @@ private:
     MouseWheelZoomType::Types mousewheelzoomtype;
 
 
+    void AddPrefetchTiles(QList<core::Point> &list, core::Point const & pixel, Size const & min, Size const & max);
+    TilePrefetcher prefetcher;
     Size sizeOfMapArea;
     Size minOfTiles;
     Size maxOfTiles;
@@ -42,9 +42,8 @@ Point MercatorProjection::FromLatLngToPixel(double lat, double lng, const int &z
     double sinLatitude = sin(lat * M_PI / 180);
     double y     = 0.5 - log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * M_PI);
 
-    Size s       = GetTileMatrixSizePixel(zoom);
-    int mapSizeX = s.Width();
-    int mapSizeY = s.Height();
+    int mapSizeX = MapSize(zoom);
+    int mapSizeY = mapSizeX;
 
     ret.SetX((int)Clip(x * mapSizeX + 0.5, 0, mapSizeX - 1));
     ret.SetY((int)Clip(y * mapSizeY + 0.5, 0, mapSizeY - 1));
@@ -55,9 +54,8 @@ internals::PointLatLng MercatorProjection::FromPixelToLatLng(const int &x, const
 {
     internals::PointLatLng ret; // = internals::PointLatLng.Empty;
 
-    Size s = GetTileMatrixSizePixel(zoom);
-    double mapSizeX = s.Width();
-    double mapSizeY = s.Height();
+    double mapSizeX = MapSize(zoom);
+    double mapSizeY = mapSizeX;
 
     double xx = (Clip(x, 0, mapSizeX - 1) / mapSizeX) - 0.5;
     double yy = 0.5 - (Clip(y, 0, mapSizeY - 1) / mapSizeY);
@@ -67,6 +65,44 @@ internals::PointLatLng MercatorProjection::FromPixelToLatLng(const int &x, const
 
     return ret;
 }
+void MercatorProjection::FromLatLngToPixel(QVector<internals::PointLatLng> const & points, int const & zoom, QVector<core::Point> &pixels)
+{
+    // same math as the single point version with the zoom constants hoisted
+    const double mapSize = MapSize(zoom);
+    const double maxPixel = mapSize - 1;
+    const double lngScale = mapSize / 360;
+    const double latScale = mapSize / (4 * M_PI);
+    const double d2r = M_PI / 180;
+
+    pixels.resize(points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        double lat = Clip(points.at(i).Lat(), MinLatitude, MaxLatitude);
+        double lng = Clip(points.at(i).Lng(), MinLongitude, MaxLongitude);
+        double sinLatitude = sin(lat * d2r);
+        double x = (lng + 180) * lngScale;
+        double y = mapSize * 0.5 - log((1 + sinLatitude) / (1 - sinLatitude)) * latScale;
+        pixels[i] = Point((int)Clip(x + 0.5, 0, maxPixel), (int)Clip(y + 0.5, 0, maxPixel));
+    }
+}
+void MercatorProjection::FromPixelToLatLng(QVector<core::Point> const & pixels, int const & zoom, QVector<internals::PointLatLng> &points)
+{
+    const double mapSize = MapSize(zoom);
+    const double maxPixel = mapSize - 1;
+    const double yScale = 2 * M_PI / mapSize;
+
+    points.resize(pixels.size());
+    for (int i = 0; i < pixels.size(); ++i) {
+        double xx = (Clip(pixels.at(i).X(), 0, maxPixel) / mapSize) - 0.5;
+        double yy = mapSize * 0.5 - Clip(pixels.at(i).Y(), 0, maxPixel);
+        points[i] = internals::PointLatLng(90 - 360 * atan(exp(-yy * yScale)) / M_PI, 360 * xx);
+    }
+}
+Size MercatorProjection::GetTileMatrixSizePixel(const int &zoom)
+{
+    int side = MapSize(zoom);
+
+    return Size(side, side);
+}
 double MercatorProjection::Clip(const double &n, const double &minValue, const double &maxValue) const
 {
     return qMin(qMax(n, minValue), maxValue);
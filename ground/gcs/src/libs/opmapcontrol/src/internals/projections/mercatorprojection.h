@@ -42,14 +42,22 @@ public:
     virtual double Flattening() const;
     virtual core::Point FromLatLngToPixel(double lat, double lng, int const & zoom);
     virtual internals::PointLatLng FromPixelToLatLng(const int &x, const int &y, const int &zoom);
+    virtual void FromLatLngToPixel(QVector<internals::PointLatLng> const & points, int const & zoom, QVector<core::Point> &pixels);
+    virtual void FromPixelToLatLng(QVector<core::Point> const & pixels, int const & zoom, QVector<internals::PointLatLng> &points);
     virtual Size GetTileMatrixMinXY(const int &zoom);
     virtual Size GetTileMatrixMaxXY(const int &zoom);
+    virtual Size GetTileMatrixSizePixel(const int &zoom);
 private:
     const double MinLatitude;
     const double MaxLatitude;
     const double MinLongitude;
     const double MaxLongitude;
     double Clip(double const & n, double const & minValue, double const & maxValue) const;
+    // the tile matrix is square, its side is the tile side shifted by the zoom
+    int MapSize(int const & zoom) const
+    {
+        return tileSize.Width() << zoom;
+    }
     Size tileSize;
 };
 }
@@ -49,6 +49,22 @@ PointLatLng PureProjection::FromPixelToLatLng(const Point &p, const int &zoom)
     return FromPixelToLatLng(p.X(), p.Y(), zoom);
 }
 
+void PureProjection::FromLatLngToPixel(QVector<PointLatLng> const & points, int const & zoom, QVector<core::Point> &pixels)
+{
+    pixels.resize(points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        pixels[i] = FromLatLngToPixel(points.at(i).Lat(), points.at(i).Lng(), zoom);
+    }
+}
+
+void PureProjection::FromPixelToLatLng(QVector<core::Point> const & pixels, int const & zoom, QVector<PointLatLng> &points)
+{
+    points.resize(pixels.size());
+    for (int i = 0; i < pixels.size(); ++i) {
+        points[i] = FromPixelToLatLng(pixels.at(i).X(), pixels.at(i).Y(), zoom);
+    }
+}
+
 Point PureProjection::FromPixelToTileXY(const Point &p)
 {
     return Point((int)(p.X() / TileSize().Width()), (int)(p.Y() / TileSize().Height()));
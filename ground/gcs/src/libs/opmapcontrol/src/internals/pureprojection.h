@@ -34,6 +34,7 @@
 #include "cmath"
 #include "rectlatlng.h"
 #include <QDebug>
+#include <QVector>
 using namespace core;
 
 namespace internals {
@@ -56,6 +57,16 @@ public:
     core::Point FromLatLngToPixel(const PointLatLng &p, const int &zoom);
 
     PointLatLng FromPixelToLatLng(const Point &p, const int &zoom);
+
+    /**
+     * Batched FromLatLngToPixel, pixels gets one entry per point.
+     * Projections override it to compute their per zoom constants once for the whole batch.
+     */
+    virtual void FromLatLngToPixel(QVector<PointLatLng> const & points, int const & zoom, QVector<core::Point> &pixels);
+    /**
+     * Batched FromPixelToLatLng, points gets one entry per pixel.
+     */
+    virtual void FromPixelToLatLng(QVector<core::Point> const & pixels, int const & zoom, QVector<PointLatLng> &points);
     virtual core::Point FromPixelToTileXY(const core::Point &p);
     virtual core::Point FromTileXYToPixel(const core::Point &p);
     virtual Size GetTileMatrixMinXY(const int &zoom) = 0;
@@ -25,6 +25,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "tile.h"
+#include "../core/pureimage.h"
 
 
 namespace internals {
@@ -40,8 +41,32 @@ void Tile::Clear()
 #endif // DEBUG_TILE
     mutex.lock();
     Overlays.clear();
+    decoded.clear();
     mutex.unlock();
 }
+void Tile::AppendOverlay(const QByteArray &data)
+{
+    // decode here so painting never has to, QImage is safe outside the GUI thread
+    AppendOverlay(data, PureImageProxy::DecodeStream(data));
+}
+void Tile::AppendOverlay(const QByteArray &data, const QImage &image)
+{
+    mutex.lock();
+    Overlays.append(data);
+    if (!image.isNull()) {
+        decoded.append(image);
+    }
+    mutex.unlock();
+}
+QList<QImage> Tile::Images()
+{
+    QList<QImage> images;
+
+    mutex.lock();
+    images = decoded;
+    mutex.unlock();
+    return images;
+}
 Tile::Tile() : zoom(0), pos(0, 0)
 {}
 Tile & Tile::operator =(const Tile &cSource)
@@ -66,6 +66,20 @@ public:
     {
         return !(zoom == 0);
     }
+    /**
+     * Stores the raw image data of one layer and decodes it.
+     * Called from the tile loader threads, before the tile is put in the matrix.
+     */
+    void AppendOverlay(const QByteArray &data);
+    /**
+     * Same as above for layers the loader has rendered itself, such as the vector tiles.
+     */
+    void AppendOverlay(const QByteArray &data, const QImage &image);
+    /**
+     * Decoded layers ready to be painted.
+     * Returns a shallow copy so the map compositor can paint them on its own thread.
+     */
+    QList<QImage> Images();
     QList<QByteArray> Overlays;
 protected:
 
@@ -73,6 +87,7 @@ protected:
 private:
     int zoom;
     core::Point pos;
+    QList<QImage> decoded;
 };
 }
 #endif // TILE_H
@@ -0,0 +1,132 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tileprefetcher.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      Background loader warming the tile caches ahead of the view
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tileprefetcher.h"
+#include "../core/opmaps.h"
+#include <QElapsedTimer>
+
+// #define DEBUG_TILEPREFETCHER
+
+namespace internals {
+TilePrefetcher::TilePrefetcher() : budget(2), quit(false)
+{}
+TilePrefetcher::~TilePrefetcher()
+{
+    mutex.lock();
+    quit = true;
+    queue.clear();
+    waitc.wakeAll();
+    mutex.unlock();
+    wait();
+}
+
+void TilePrefetcher::Enqueue(const core::MapType::Types &type, const QList<core::Point> &tiles, const int &zoom)
+{
+    if (budget <= 0 || core::OPMaps::Instance()->GetAccessMode() == core::AccessMode::CacheOnly) {
+        return;
+    }
+    mutex.lock();
+    if (known.count() > MaxKnownTiles) {
+        known.clear();
+    }
+    int added = 0;
+    foreach(core::Point pos, tiles) {
+        if (queue.count() >= MaxQueueSize) {
+            break;
+        }
+        core::RawTile tile(type, pos, zoom);
+        if (!known.contains(tile)) {
+            known.insert(tile);
+            queue.enqueue(tile);
+            ++added;
+        }
+    }
+    mutex.unlock();
+    if (added > 0) {
+#ifdef DEBUG_TILEPREFETCHER
+        qDebug() << "TilePrefetcher: queued " << added << " tiles at zoom " << zoom;
+#endif // DEBUG_TILEPREFETCHER
+        if (isRunning()) {
+            waitc.wakeAll();
+        } else {
+            start(QThread::LowPriority);
+        }
+    }
+}
+
+void TilePrefetcher::Clear()
+{
+    mutex.lock();
+    queue.clear();
+    known.clear();
+    mutex.unlock();
+}
+
+void TilePrefetcher::SetBudget(const int &tilesPerSecond)
+{
+    mutex.lock();
+    budget = qMax(0, tilesPerSecond);
+    if (budget == 0) {
+        queue.clear();
+    }
+    mutex.unlock();
+}
+
+void TilePrefetcher::run()
+{
+    QElapsedTimer time;
+
+    mutex.lock();
+    while (!quit) {
+        if (queue.isEmpty()) {
+            // same idle policy as the cache queue, the thread ends when there is nothing to do
+            if (!waitc.wait(&mutex, 4000) && queue.isEmpty()) {
+                break;
+            }
+            continue;
+        }
+        core::RawTile tile = queue.dequeue();
+        int interval = 1000 / qMax(1, budget);
+        mutex.unlock();
+
+        time.start();
+        int fromNet = core::OPMaps::Instance()->GetDiagnostics().tilesFromNet;
+        core::MapType::Types type = tile.Type();
+        foreach(core::MapType::Types layer, core::OPMaps::Instance()->GetAllLayersOfType(type)) {
+            core::OPMaps::Instance()->GetImageFrom(layer, tile.Pos(), tile.Zoom());
+        }
+        // tiles found in the caches cost no bandwidth, only the downloads are throttled
+        bool downloaded = (core::OPMaps::Instance()->GetDiagnostics().tilesFromNet != fromNet);
+#ifdef DEBUG_TILEPREFETCHER
+        qDebug() << "TilePrefetcher: fetched " << tile.ToString() << " in " << time.elapsed() << "ms, downloaded " << downloaded;
+#endif // DEBUG_TILEPREFETCHER
+
+        mutex.lock();
+        while (downloaded && !quit && time.elapsed() < interval) {
+            waitc.wait(&mutex, interval - time.elapsed());
+        }
+    }
+    mutex.unlock();
+}
+}
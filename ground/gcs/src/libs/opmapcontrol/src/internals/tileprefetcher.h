@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tileprefetcher.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      Background loader warming the tile caches ahead of the view
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEPREFETCHER_H
+#define TILEPREFETCHER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QSet>
+#include "../core/rawtile.h"
+
+namespace internals {
+/**
+ * Loads tiles which are likely to be needed soon, so they are already in the
+ * memory and database caches when they scroll into view.
+ * The tiles are fetched one at a time at background priority, limited to a
+ * number of tiles per second so prefetching never starves a slow link.
+ */
+class TilePrefetcher : public QThread {
+    Q_OBJECT
+public:
+    TilePrefetcher();
+    ~TilePrefetcher();
+    /**
+     * Queues the tiles (of all the layers of type) not queued or fetched before.
+     */
+    void Enqueue(const core::MapType::Types &type, const QList<core::Point> &tiles, const int &zoom);
+    /**
+     * Drops the tiles still waiting, used when the map type changes.
+     */
+    void Clear();
+    /**
+     * Maximum number of tiles fetched per second, 0 disables prefetching.
+     */
+    void SetBudget(const int &tilesPerSecond);
+    int Budget() const
+    {
+        return budget;
+    }
+
+private:
+    void run();
+
+    // bounds both the backlog and the memory used to remember the fetched tiles
+    static const int MaxQueueSize = 1024;
+    static const int MaxKnownTiles = 16384;
+
+    QQueue<core::RawTile> queue;
+    QSet<core::RawTile> known;
+    int budget;
+    bool quit;
+    QMutex mutex;
+    QWaitCondition waitc;
+};
+}
+#endif // TILEPREFETCHER_H
@@ -152,6 +152,25 @@ public:
         core::OPMaps::Instance()->TilesInMemory.setMemoryCacheCapacity(value);
     }
 
+    /**
+     * @brief Sets the url of the vector tile server used by the OpenMapTiles_Vector map type
+     *
+     * @param url template where {z} {x} and {y} are replaced by the tile coordinates
+     */
+    void SetVectorTileUrl(QString const & url)
+    {
+        core::OPMaps::Instance()->SetVectorTileUrl(url);
+    }
+    /**
+     * @brief Returns the url template of the vector tile server
+     *
+     * @return
+     */
+    QString VectorTileUrl()
+    {
+        return core::OPMaps::Instance()->VectorTileUrl();
+    }
+
     /**
      * @brief Sets the location for the SQLite Database used for caching and the geocoding cache files
      *
@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ *
+ * @file       mapcompositor.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      Composites the map tile layer on a worker thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "mapcompositor.h"
+#include <QPainter>
+#include <QMutexLocker>
+
+namespace mapcontrol {
+MapCompositor::MapCompositor() : hasPending(false), back(0)
+{}
+
+void MapCompositor::Compose(const MapCompositeJob &job)
+{
+    bool wake;
+
+    mutex.lock();
+    wake       = !hasPending;
+    pending    = job;
+    hasPending = true;
+    mutex.unlock();
+    // a job already waiting means the worker has been woken up for it
+    if (wake) {
+        QMetaObject::invokeMethod(this, "composePending", Qt::QueuedConnection);
+    }
+}
+
+MapCompositeFrame MapCompositor::Frame()
+{
+    QMutexLocker locker(&mutex);
+
+    return front;
+}
+
+void MapCompositor::composePending()
+{
+    MapCompositeJob job;
+
+    mutex.lock();
+    if (!hasPending) {
+        mutex.unlock();
+        return;
+    }
+    job = pending;
+    pending    = MapCompositeJob();
+    hasPending = false;
+    mutex.unlock();
+
+    QImage &image = buffers[back];
+    Paint(job, image);
+
+    MapCompositeFrame frame;
+    frame.image  = image;
+    frame.area   = job.area;
+    frame.scale  = job.scale;
+    frame.offset = job.offset;
+    frame.zoom   = job.zoom;
+
+    mutex.lock();
+    front = frame;
+    mutex.unlock();
+    back ^= 1;
+    emit frameReady();
+}
+
+void MapCompositor::Paint(const MapCompositeJob &job, QImage &image)
+{
+    QSize size = (job.area.size() * job.scale).toSize();
+
+    if (image.size() != size) {
+        image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    }
+    image.fill(0);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.scale(job.scale, job.scale);
+    painter.translate(-job.area.topLeft());
+    if (!job.last.isNull()) {
+        painter.drawImage(job.lastRect, job.last);
+    }
+    foreach(const MapCompositeJob::TileLayers &tile, job.tiles) {
+        foreach(const QImage &layer, tile.images) {
+            painter.drawImage(tile.rect, layer);
+        }
+        if (job.gridLines) {
+            painter.setPen(job.gridPen);
+            painter.drawRect(tile.rect);
+            painter.setFont(job.gridFont);
+            painter.setPen(Qt::red);
+            painter.drawText(tile.rect, Qt::AlignCenter, tile.label);
+        }
+    }
+    painter.end();
+}
+}
@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ *
+ * @file       mapcompositor.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      Composites the map tile layer on a worker thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef MAPCOMPOSITOR_H
+#define MAPCOMPOSITOR_H
+
+#include <QObject>
+#include <QImage>
+#include <QList>
+#include <QRect>
+#include <QPen>
+#include <QFont>
+#include <QMutex>
+#include "../core/point.h"
+
+namespace mapcontrol {
+/**
+ * @brief What the compositor needs to paint one frame, snapshotted on the GUI thread
+ */
+struct MapCompositeJob {
+    struct TileLayers {
+        QRect rect;
+        QList<QImage> images;
+        QString label;
+    };
+    MapCompositeJob() : scale(1), zoom(0), gridLines(false) {}
+    // item area covered by the frame
+    QRectF area;
+    // image pixels per item pixel
+    qreal scale;
+    // core render offset and zoom the tile rects are relative to
+    core::Point offset;
+    int zoom;
+    QList<TileLayers> tiles;
+    // frame of the previous zoom level, drawn under the tiles still loading
+    QImage last;
+    QRectF lastRect;
+    bool gridLines;
+    QPen gridPen;
+    QFont gridFont;
+};
+
+/**
+ * @brief A composited tile layer and the view it was composited for
+ */
+struct MapCompositeFrame {
+    MapCompositeFrame() : scale(1), zoom(-1) {}
+    bool IsValid() const
+    {
+        return !image.isNull();
+    }
+    QImage image;
+    QRectF area;
+    qreal scale;
+    core::Point offset;
+    int zoom;
+};
+
+/**
+ * @brief Paints the tiles of the map into a double buffered image on its own thread
+ *
+ * The GUI thread only queues jobs and blits the last frame, so large tile loads
+ * and scaled tiles no longer stall the rest of the GCS.
+ * Jobs queued while the worker is busy replace each other, only the latest is painted.
+ *
+ * @class MapCompositor mapcompositor.h "mapcompositor.h"
+ */
+class MapCompositor : public QObject {
+    Q_OBJECT
+public:
+    MapCompositor();
+    /**
+     * @brief Queues job, thread safe
+     */
+    void Compose(const MapCompositeJob &job);
+    /**
+     * @brief Returns the last composited frame, thread safe
+     */
+    MapCompositeFrame Frame();
+signals:
+    void frameReady();
+private slots:
+    void composePending();
+private:
+    void Paint(const MapCompositeJob &job, QImage &image);
+    QMutex mutex;
+    MapCompositeJob pending;
+    bool hasPending;
+    // front is the one handed to the GUI, the other one is painted next
+    QImage buffers[2];
+    int back;
+    MapCompositeFrame front;
+};
+}
+#endif // MAPCOMPOSITOR_H
@@ -32,7 +32,7 @@
 
 namespace mapcontrol {
 MapGraphicItem::MapGraphicItem(internals::Core *core, Configuration *configuration) : core(core), config(configuration), MapRenderTransform(1),
-    maxZoom(17), minZoom(2), zoomReal(0), zoomDigi(0), isSelected(false), rotation(0)
+    maxZoom(17), minZoom(2), zoomReal(0), zoomDigi(0), isSelected(false), rotation(0), requestedGridLines(false), compositeDirty(true)
 {
     // dragons.load(QString::fromUtf8(":/markers/images/dragons1.jpg"));
     showTileGridLines = true;
@@ -46,6 +46,18 @@ MapGraphicItem::MapGraphicItem(internals::Core *core, Configuration *configurati
     connect(core, SIGNAL(OnMapDrag()), this, SLOT(childPosRefresh()));
     connect(core, SIGNAL(OnMapZoomChanged()), this, SLOT(childPosRefresh()));
     setCacheMode(QGraphicsItem::ItemCoordinateCache);
+
+    compositor = new MapCompositor;
+    compositor->moveToThread(&compositorThread);
+    connect(&compositorThread, SIGNAL(finished()), compositor, SLOT(deleteLater()));
+    connect(compositor, SIGNAL(frameReady()), this, SLOT(Compositor_OnFrameReady()));
+    compositorThread.start();
+}
+
+MapGraphicItem::~MapGraphicItem()
+{
+    compositorThread.quit();
+    compositorThread.wait();
 }
 
 void MapGraphicItem::start()
@@ -79,9 +91,14 @@ QRectF MapGraphicItem::boundingRect() const
 }
 void MapGraphicItem::Core_OnNeedInvalidation()
 {
+    compositeDirty = true;
     this->update();
     emit childRefreshPosition();
 }
+void MapGraphicItem::Compositor_OnFrameReady()
+{
+    this->update();
+}
 void MapGraphicItem::childPosRefresh()
 {
     emit childRefreshPosition();
@@ -92,36 +109,17 @@ void MapGraphicItem::setOverlayOpacity(qreal value)
 }
 void MapGraphicItem::ConstructLastImage(int const & zoomdiff)
 {
-    QImage temp;
-    QSize size = boundingRect().size().toSize();
+    // the composited frame is reused, scaled to the new zoom, instead of painting the tiles again
+    MapCompositeFrame frame = compositor->Frame();
 
-    size.setWidth(size.width() * 2 * zoomdiff);
-    size.setHeight(size.height() * 2 * zoomdiff);
-    temp = QImage(size, QImage::Format_ARGB32_Premultiplied);
-    temp.fill(0);
-    QPainter imagePainter(&temp);
-    imagePainter.translate(-boundingRect().topLeft());
-    imagePainter.scale(2 * zoomdiff, 2 * zoomdiff);
-    paintImage(&imagePainter);
-    imagePainter.end();
-    lastimagepoint = Point(core->GetrenderOffset().X() * 2 * zoomdiff, core->GetrenderOffset().Y() * 2 * zoomdiff);
-    lastimage = temp;
-}
-void MapGraphicItem::paintImage(QPainter *painter)
-{
-    if (MapRenderTransform != 1) {
-        QTransform transform;
-        transform.translate(-((boundingRect().width() * MapRenderTransform) - (boundingRect().width())) / 2, -((boundingRect().height() * MapRenderTransform) - (boundingRect().height())) / 2);
-        transform.scale(MapRenderTransform, MapRenderTransform);
-        painter->setWorldTransform(transform);
-        {
-            DrawMap2D(painter);
-        }
-        painter->resetTransform();
-    } else {
-        DrawMap2D(painter);
+    if (!frame.IsValid() || frame.zoom != core->Zoom()) {
+        lastimage = QImage();
+        return;
     }
-    // painter->drawRect(maprect);
+    qreal scale = 1 << zoomdiff;
+    lastimagerect = QRectF((frame.area.x() - frame.offset.X()) * scale, (frame.area.y() - frame.offset.Y()) * scale,
+                           frame.area.width() * scale, frame.area.height() * scale);
+    lastimage     = frame.image;
 }
 void MapGraphicItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
@@ -296,80 +294,85 @@ void MapGraphicItem::wheelEvent(QGraphicsSceneWheelEvent *event)
 }
 void MapGraphicItem::DrawMap2D(QPainter *painter)
 {
-    // painter->drawImage(this->boundingRect(), dragons.toImage());
+    QRectF area  = boundingRect();
+    qreal scale  = qMin(MapRenderTransform, (qreal)MaxCompositeScale);
+    Point offset = core->GetrenderOffset();
+
+    // the tiles are painted by the compositor, ask for a new frame when the view or the tiles changed
+    if (compositeDirty || area != requested.area || scale != requested.scale || offset != requested.offset
+        || core->Zoom() != requested.zoom || showTileGridLines != requestedGridLines) {
+        compositor->Compose(CompositeJob(area, scale));
+        requested.area     = area;
+        requested.scale    = scale;
+        requested.offset   = offset;
+        requested.zoom     = core->Zoom();
+        requestedGridLines = showTileGridLines;
+        compositeDirty     = false;
+    }
+
+    MapCompositeFrame frame = compositor->Frame();
+    if (frame.IsValid() && frame.zoom == core->Zoom()) {
+        // moved by the drag since the frame was composited
+        painter->drawImage(frame.area.translated(offset.X() - frame.offset.X(), offset.Y() - frame.offset.Y()), frame.image);
+    } else if (!lastimage.isNull()) {
+        painter->drawImage(lastimagerect.translated(offset.X(), offset.Y()), lastimage);
+    }
+
+    if (!SelectedArea().IsEmpty()) {
+        core::Point p1 = FromLatLngToLocal(SelectedArea().LocationTopLeft());
+        core::Point p2 = FromLatLngToLocal(SelectedArea().LocationRightBottom());
+        int x1 = p1.X();
+        int y1 = p1.Y();
+        int x2 = p2.X();
+        int y2 = p2.Y();
+        painter->setPen(Qt::black);
+        painter->setBrush(QBrush(QColor(50, 50, 100, 20)));
+        painter->drawRect(x1, y1, x2 - x1, y2 - y1);
+    }
+}
+MapCompositeJob MapGraphicItem::CompositeJob(QRectF const & area, qreal const & scale)
+{
+    MapCompositeJob job;
+
+    job.area      = area;
+    job.scale     = scale;
+    job.offset    = core->GetrenderOffset();
+    job.zoom      = core->Zoom();
+    job.gridLines = showTileGridLines;
+    job.gridPen   = config->EmptyTileBorders;
+    job.gridFont  = config->MissingDataFont;
     if (!lastimage.isNull()) {
-        painter->drawImage(core->GetrenderOffset().X() - lastimagepoint.X(), core->GetrenderOffset().Y() - lastimagepoint.Y(), lastimage);
+        job.last     = lastimage;
+        job.lastRect = lastimagerect.translated(job.offset.X(), job.offset.Y());
     }
 
+    // only the images are copied, they are implicitly shared with the tiles
+    Point center = core->GetcenterTileXYLocation();
+    int width    = core->GettileRect().Width();
+    int height   = core->GettileRect().Height();
     for (int i = -core->GetsizeOfMapArea().Width(); i <= core->GetsizeOfMapArea().Width(); i++) {
         for (int j = -core->GetsizeOfMapArea().Height(); j <= core->GetsizeOfMapArea().Height(); j++) {
-            core->SettilePoint(core->GetcenterTileXYLocation());
-            core->SettilePoint(Point(core->GettilePoint().X() + i, core->GettilePoint().Y() + j));
-            {
-                internals::Tile *t = core->Matrix.TileAt(core->GettilePoint());
-                if (true) {
-                    core->tileRect.SetX(core->GettilePoint().X() * core->tileRect.Width());
-                    core->tileRect.SetY(core->GettilePoint().Y() * core->tileRect.Height());
-                    core->tileRect.Offset(core->GetrenderOffset());
-                    if (core->GetCurrentRegion().IntersectsWith(core->tileRect)) {
-                        bool found = false;
-
-                        // render tile
-                        // lock(t.Overlays)
-                        if (t != 0) {
-                            foreach(QByteArray img, t->Overlays) {
-                                if (img.count() != 0) {
-                                    if (!found) {
-                                        found = true;
-                                    }
-                                    {
-                                        painter->drawPixmap(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(), PureImageProxy::FromStream(img));
-                                    }
-                                }
-                            }
-                        }
-
-                        if (showTileGridLines) {
-                            painter->setPen(config->EmptyTileBorders);
-                            painter->drawRect(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height());
-                            {
-                                painter->setFont(config->MissingDataFont);
-                                painter->setPen(Qt::red);
-                                painter->drawText(QRectF(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height()), Qt::AlignCenter, (core->GettilePoint() == core->GetcenterTileXYLocation() ? "CENTER: " : "TILE: ") + core->GettilePoint().ToString());
-                            }
-                        }
-
-                        // add text if tile is missing
-                        if (false) {
-                            painter->fillRect(QRectF(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height()), config->EmptytileBrush);
-                            painter->setFont(config->MissingDataFont);
-                            painter->drawText(QRectF(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height()), config->EmptyTileText);
-
-
-                            painter->setPen(config->EmptyTileBorders);
-                            painter->drawRect(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height());
-
-                            // raise error
-                        }
-                        if (!SelectedArea().IsEmpty()) {
-                            core::Point p1 = FromLatLngToLocal(SelectedArea().LocationTopLeft());
-                            core::Point p2 = FromLatLngToLocal(SelectedArea().LocationRightBottom());
-                            int x1 = p1.X();
-                            int y1 = p1.Y();
-                            int x2 = p2.X();
-                            int y2 = p2.Y();
-                            painter->setPen(Qt::black);
-                            painter->setBrush(QBrush(QColor(50, 50, 100, 20)));
-                            painter->drawRect(x1, y1, x2 - x1, y2 - y1);
-                        }
-                    }
-                }
+            Point tilePoint(center.X() + i, center.Y() + j);
+            internals::Rectangle rect(tilePoint.X() * width + job.offset.X(), tilePoint.Y() * height + job.offset.Y(), width, height);
+            if (!core->GetCurrentRegion().IntersectsWith(rect)) {
+                continue;
+            }
+            MapCompositeJob::TileLayers layers;
+            layers.rect = QRect(rect.X(), rect.Y(), width, height);
+            internals::Tile *t = core->Matrix.TileAt(tilePoint);
+            if (t != 0) {
+                layers.images = t->Images();
+            }
+            if (showTileGridLines) {
+                layers.label = (tilePoint == center ? "CENTER: " : "TILE: ") + tilePoint.ToString();
+            }
+            if (!layers.images.isEmpty() || showTileGridLines) {
+                job.tiles.append(layers);
             }
         }
     }
+    return job;
 }
-
-
 core::Point MapGraphicItem::FromLatLngToLocal(internals::PointLatLng const & point)
 {
     core::Point ret = core->FromLatLngToLocal(point);
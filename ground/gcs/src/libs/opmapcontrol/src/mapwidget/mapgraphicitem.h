@@ -32,6 +32,7 @@
 #include "../core/diagnostics.h"
 #include "configuration.h"
 #include "waypointitem.h"
+#include "mapcompositor.h"
 
 #include <QGraphicsItem>
 #include <QtGui>
@@ -40,11 +41,13 @@
 #include <QBrush>
 #include <QFont>
 #include <QObject>
+#include <QThread>
 
 namespace mapcontrol {
 class WayPointItem;
 class OPMapWidget;
 class HomeItem;
+class TrailPathItem;
 /**
  * @brief The main graphicsItem used on the widget, contains the map and map logic
  *
@@ -52,6 +55,7 @@ class HomeItem;
  */
 class MapGraphicItem : public QObject, public QGraphicsItem {
     friend class mapcontrol::OPMapWidget;
+    friend class mapcontrol::TrailPathItem;
     Q_OBJECT
         Q_INTERFACES(QGraphicsItem)
 public:
@@ -65,6 +69,7 @@ public:
      * @return
      */
     MapGraphicItem(internals::Core *core, Configuration *configuration);
+    ~MapGraphicItem();
     QRectF boundingRect() const;
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
                QWidget *widget);
@@ -95,9 +100,9 @@ public:
         return core->IsDragging();
     }
 
+    // frame of the previous zoom level and where it goes in map pixels of the current one
     QImage lastimage;
-    core::Point lastimagepoint;
-    void paintImage(QPainter *painter);
+    QRectF lastimagerect;
     void ConstructLastImage(int const & zoomdiff);
     internals::PureProjection *Projection() const
     {
@@ -148,6 +153,21 @@ private:
     bool showTileGridLines;
     qreal MapRenderTransform;
     void DrawMap2D(QPainter *painter);
+    /**
+     * @brief Snapshots the visible tiles for the compositor
+     *
+     * @param area item area to composite
+     * @param scale image pixels per item pixel
+     */
+    MapCompositeJob CompositeJob(QRectF const & area, qreal const & scale);
+    // fractional zoom is composited up to this resolution, deeper it is scaled on blit
+    static const int MaxCompositeScale = 2;
+    QThread compositorThread;
+    MapCompositor *compositor;
+    // view of the last composite request, compared to the current one on paint
+    MapCompositeFrame requested;
+    bool requestedGridLines;
+    bool compositeDirty;
     /**
      * @brief Maximum possible zoom
      *
@@ -246,6 +266,7 @@ private:
     }
 private slots:
     void Core_OnNeedInvalidation();
+    void Compositor_OnFrameReady();
     void childPosRefresh();
 public slots:
     /**
@@ -27,6 +27,7 @@
 
 #include "mapripform.h"
 #include "ui_mapripform.h"
+#include <QTime>
 
 MapRipForm::MapRipForm(QWidget *parent) :
     QWidget(parent),
@@ -48,6 +49,10 @@ void MapRipForm::SetProvider(const QString &prov, const int &zoom)
 {
     ui->mainlabel->setText(QString(tr("Currently ripping from:%1 at Zoom level %2")).arg(prov).arg(zoom));
 }
+void MapRipForm::SetThroughput(const double &tilesPerSecond, const int &secondsLeft)
+{
+    ui->ratelabel->setText(QString(tr("%1 tiles/s, %2 left")).arg(tilesPerSecond, 0, 'f', 1).arg(QTime(0, 0).addSecs(secondsLeft).toString("hh:mm:ss")));
+}
 void MapRipForm::SetNumberOfTiles(const int &total, const int &actual)
 {
     ui->statuslabel->setText(QString(tr("Downloading tile %1 of %2")).arg(actual).arg(total));
@@ -43,6 +43,7 @@ public slots:
     void SetPercentage(int const & perc);
     void SetProvider(QString const & prov, int const & zoom);
     void SetNumberOfTiles(int const & total, int const & actual);
+    void SetThroughput(double const & tilesPerSecond, int const & secondsLeft);
 signals:
     void cancelRequest();
 private:
@@ -25,31 +25,93 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "mapripper.h"
+#include <QThreadPool>
+#include <QSettings>
+#include <QFile>
 namespace mapcontrol {
-MapRipper::MapRipper(internals::Core *core, const internals::RectLatLng & rect) : sleep(100), cancel(false), progressForm(0), core(core), yesToAll(false)
+class MapRipWorker : public QRunnable {
+public:
+    MapRipWorker(MapRipper *ripper) : ripper(ripper) {}
+    void run()
+    {
+        ripper->FetchTiles();
+    }
+private:
+    MapRipper *ripper;
+};
+
+MapRipper::MapRipper(internals::Core *core, const internals::RectLatLng & rect, int const & workers) : nextPoint(0), done(0), failed(0), workers(qMax(1, workers)), cancel(false), progressForm(0), core(core), yesToAll(false)
 {
-    if (!rect.IsEmpty()) {
-        type    = core->GetMapType();
+    type    = core->GetMapType();
+    area    = rect;
+    zoom    = core->Zoom();
+    maxzoom = core->MaxZoom();
+    if (QFileInfo(JobFile()).exists()) {
+        int ret = QMessageBox::question(0, tr("Interrupted map rip"),
+                                        tr("A previous map rip was interrupted before it finished.\n\nDo you want to resume it?"),
+                                        QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+        if (ret != QMessageBox::Yes || !LoadJob()) {
+            ClearJob();
+        }
+    }
+    if (!area.IsEmpty()) {
         progressForm = new MapRipForm;
         connect(progressForm, SIGNAL(cancelRequest()), this, SLOT(stopFetching()));
-        area    = rect;
-        zoom    = core->Zoom();
-        maxzoom = core->MaxZoom();
         points  = core->Projection()->GetAreaTileList(area, zoom, 0);
-        this->start();
-        cancel  = false;
         progressForm->show();
         connect(this, SIGNAL(percentageChanged(int)), progressForm, SLOT(SetPercentage(int)));
         connect(this, SIGNAL(numberOfTilesChanged(int, int)), progressForm, SLOT(SetNumberOfTiles(int, int)));
         connect(this, SIGNAL(providerChanged(QString, int)), progressForm, SLOT(SetProvider(QString, int)));
+        connect(this, SIGNAL(throughputChanged(double, int)), progressForm, SLOT(SetThroughput(double, int)));
         connect(this, SIGNAL(finished()), this, SLOT(finish()));
         emit numberOfTilesChanged(0, 0);
-    } else
+        SaveJob();
+        this->start();
+    } else {
 #ifdef Q_OS_DARWIN
-    { QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <COMMAND>+Left mouse click")); }
+        QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <COMMAND>+Left mouse click"));
 #else
-    { QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <CTRL>+Left mouse click")); }
+        QMessageBox::information(new QWidget(), tr("No valid selection"), tr("This pre-caches map data.\n\nPlease first select the area of the map to rip with <CTRL>+Left mouse click"));
 #endif
+        this->deleteLater();
+    }
+}
+QString MapRipper::JobFile()
+{
+    return Cache::Instance()->CacheLocation() + "ripjob.ini";
+}
+void MapRipper::SaveJob()
+{
+    QSettings job(JobFile(), QSettings::IniFormat);
+
+    job.setValue("type", (int)type);
+    job.setValue("zoom", zoom);
+    job.setValue("maxzoom", maxzoom);
+    job.setValue("yesToAll", yesToAll);
+    job.setValue("lat", area.Lat());
+    job.setValue("lng", area.Lng());
+    job.setValue("widthLng", area.WidthLng());
+    job.setValue("heightLat", area.HeightLat());
+    job.sync();
+}
+bool MapRipper::LoadJob()
+{
+    QSettings job(JobFile(), QSettings::IniFormat);
+
+    if (!job.contains("zoom")) {
+        return false;
+    }
+    type     = (core::MapType::Types)job.value("type").toInt();
+    zoom     = job.value("zoom").toInt();
+    maxzoom  = job.value("maxzoom").toInt();
+    yesToAll = job.value("yesToAll").toBool();
+    area     = internals::RectLatLng(job.value("lat").toDouble(), job.value("lng").toDouble(),
+                                     job.value("widthLng").toDouble(), job.value("heightLat").toDouble());
+    return !area.IsEmpty();
+}
+void MapRipper::ClearJob()
+{
+    QFile::remove(JobFile());
 }
 void MapRipper::finish()
 {
@@ -69,18 +131,22 @@ void MapRipper::finish()
         if (ret == QMessageBox::Yes) {
             points.clear();
             points = core->Projection()->GetAreaTileList(area, zoom, 0);
+            SaveJob();
             this->start();
         } else if (ret == QMessageBox::YesAll) {
             yesToAll = true;
             points.clear();
             points   = core->Projection()->GetAreaTileList(area, zoom, 0);
+            SaveJob();
             this->start();
         } else {
+            ClearJob();
             progressForm->close();
             delete progressForm;
             this->deleteLater();
         }
     } else {
+        ClearJob();
         yesToAll = false;
         progressForm->close();
         delete progressForm;
@@ -91,47 +157,76 @@ void MapRipper::finish()
 
 void MapRipper::run()
 {
-    int countOk   = 0;
-    bool goodtile = false;
+    nextPoint = 0;
+    done   = 0;
+    failed = 0;
+    elapsed.start();
+    emit providerChanged(core::MapType::StrByType(type), zoom);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+    for (int i = 0; i < workers; ++i) {
+        pool.start(new MapRipWorker(this));
+    }
+    pool.waitForDone();
+}
 
-    // Stuff.Shuffle<Point>(ref list);
+void MapRipper::FetchTiles()
+{
     QVector<core::MapType::Types> types = OPMaps::Instance()->GetAllLayersOfType(type);
-    int all = points.count();
-    for (int i = 0; i < all; i++) {
-        emit numberOfTilesChanged(all, i + 1);
-        if (cancel) {
-            break;
-        }
 
-        core::Point p = points[i];
-        {
-            // qDebug()<<"offline fetching:"<<p.ToString();
-            foreach(core::MapType::Types type, types) {
-                emit providerChanged(core::MapType::StrByType(type), zoom);
-                QByteArray img = OPMaps::Instance()->GetImageFrom(type, p, zoom);
+    while (true) {
+        mutex.lock();
+        if (cancel || nextPoint >= points.count()) {
+            mutex.unlock();
+            return;
+        }
+        core::Point p = points.at(nextPoint++);
+        mutex.unlock();
 
-                if (img.length() != 0) {
-                    goodtile = true;
-                    img = NULL;
-                } else {
-                    goodtile = false;
-                }
+        // qDebug()<<"offline fetching:"<<p.ToString();
+        bool goodtile = true;
+        foreach(core::MapType::Types layer, types) {
+            // resumed or overlapping rips find most of their tiles here
+            if (Cache::Instance()->ImageCache.IsImageInCache(layer, p, zoom)) {
+                continue;
             }
-            if (goodtile) {
-                countOk++;
-            } else {
-                i--;
+            bool good = false;
+            for (int retry = 0; retry < MaxRetries && !cancel; ++retry) {
+                if (!OPMaps::Instance()->GetImageFrom(layer, p, zoom).isEmpty()) {
+                    good = true;
+                    break;
+                }
                 QThread::msleep(1000);
-                continue;
             }
+            goodtile &= good;
         }
-        emit percentageChanged((int)((i + 1) * 100 / all)); // , i+1);
-        // worker.ReportProgress((int) ((i+1)*100/all), i+1);
 
-        QThread::msleep(sleep);
+        mutex.lock();
+        ++done;
+        if (!goodtile) {
+            ++failed;
+        }
+        mutex.unlock();
+        ReportProgress();
     }
 }
 
+void MapRipper::ReportProgress()
+{
+    mutex.lock();
+    int all     = points.count();
+    int current = done;
+    mutex.unlock();
+
+    double seconds = elapsed.elapsed() / 1000.0;
+    double rate    = (seconds > 0) ? current / seconds : 0;
+    int left = (rate > 0) ? (int)((all - current) / rate) : 0;
+    emit numberOfTilesChanged(all, current);
+    emit percentageChanged((int)(current * 100 / all));
+    emit throughputChanged(rate, left);
+}
+
 void MapRipper::stopFetching()
 {
     QMutexLocker locker(&mutex);
@@ -32,17 +32,41 @@
 #include "mapripform.h"
 #include <QObject>
 #include <QMessageBox>
+#include <QElapsedTimer>
 namespace mapcontrol {
+class MapRipWorker;
+/**
+ * Downloads all the tiles of an area into the database cache, zoom level after zoom level.
+ * The tiles are fetched by a pool of workers; tiles already in the cache are skipped.
+ * The job is saved next to the cache so an interrupted rip can be resumed on the next start.
+ */
 class MapRipper : public QThread {
     Q_OBJECT
+    friend class MapRipWorker;
 public:
-    MapRipper(internals::Core *, internals::RectLatLng const &);
+    static const int DefaultWorkers = 4;
+
+    MapRipper(internals::Core *, internals::RectLatLng const &, int const & workers = DefaultWorkers);
     void run();
 private:
+    void FetchTiles();
+    void ReportProgress();
+    void SaveJob();
+    bool LoadJob();
+    static void ClearJob();
+    static QString JobFile();
+
+    // attempts per tile before it is counted as failed and skipped
+    static const int MaxRetries = 3;
+
     QList<core::Point> points;
+    int nextPoint;
+    int done;
+    int failed;
+    int workers;
+    QElapsedTimer elapsed;
     int zoom;
     core::MapType::Types type;
-    int sleep;
     internals::RectLatLng area;
     bool cancel;
     MapRipForm *progressForm;
@@ -55,6 +79,7 @@ signals:
     void percentageChanged(int const & perc);
     void numberOfTilesChanged(int const & total, int const & actual);
     void providerChanged(QString const & prov, int const & zoom);
+    void throughputChanged(double const & tilesPerSecond, int const & secondsLeft);
 
 
 public slots:
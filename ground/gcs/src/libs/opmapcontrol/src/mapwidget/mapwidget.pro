@@ -5,17 +5,18 @@ include(../../../../library.pri)
 
 # DESTDIR = ../build
 SOURCES += mapgraphicitem.cpp \
+    mapcompositor.cpp \
     opmapwidget.cpp \
     configuration.cpp \
     waypointitem.cpp \
     uavitem.cpp \
     gpsitem.cpp \
-    trailitem.cpp \
+    trailpathitem.cpp \
     homeitem.cpp \
     navitem.cpp \
+    vehiclesitem.cpp \
     mapripform.cpp \
     mapripper.cpp \
-    traillineitem.cpp \
     waypointline.cpp \
     waypointcircle.cpp
 
@@ -31,6 +32,7 @@ POST_TARGETDEPS  += ../build/libcore.a
 POST_TARGETDEPS  += ../build/libinternals.a
 
 HEADERS += mapgraphicitem.h \
+    mapcompositor.h \
     opmapwidget.h \
     configuration.h \
     waypointitem.h \
@@ -38,12 +40,12 @@ HEADERS += mapgraphicitem.h \
     gpsitem.h \
     uavmapfollowtype.h \
     uavtrailtype.h \
-    trailitem.h \
+    trailpathitem.h \
     homeitem.h \
     navitem.h \
+    vehiclesitem.h \
     mapripform.h \
     mapripper.h \
-    traillineitem.h \
     waypointline.h \
     waypointcircle.h
 QT += opengl
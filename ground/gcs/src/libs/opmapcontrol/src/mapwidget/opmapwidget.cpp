@@ -34,7 +34,7 @@
 #include <QOpenGLWidget>
 
 namespace mapcontrol {
-OPMapWidget::OPMapWidget(QWidget *parent, Configuration *config) : QGraphicsView(parent), configuration(config), UAV(0), GPS(0), Home(0), Nav(0)
+OPMapWidget::OPMapWidget(QWidget *parent, Configuration *config) : QGraphicsView(parent), configuration(config), UAV(0), GPS(0), Home(0), Nav(0), Vehicles(0)
     , followmouse(true), compass(0), showuav(false), showhome(false), diagTimer(0), diagGraphItem(0), showDiag(false), showNav(false), overlayOpacity(1)
 {
     setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Preferred);
@@ -49,6 +49,8 @@ OPMapWidget::OPMapWidget(QWidget *parent, Configuration *config) : QGraphicsView
     Nav = new NavItem(map, this);
     Nav->setParentItem(map);
     Nav->setZValue(-1);
+    Vehicles = new VehiclesItem(map);
+    Vehicles->setZValue(3);
     setStyleSheet("QToolTip {font-size:8pt; color:blue;opacity: 223; padding:2px; border-width:2px; border-style:solid; border-color: rgb(170, 170, 127);border-radius:4px }");
     this->adjustSize();
     connect(map, SIGNAL(zoomChanged(double, double, double)), this, SIGNAL(zoomChanged(double, double, double)));
@@ -483,6 +485,21 @@ void OPMapWidget::ConnectWP(WayPointItem *item)
     connect(this, SIGNAL(WPInserted(int, WayPointItem *)), item, SLOT(WPInserted(int, WayPointItem *)), Qt::DirectConnection);
     connect(this, SIGNAL(WPNumberChanged(int, int, WayPointItem *)), item, SLOT(WPRenumbered(int, int, WayPointItem *)), Qt::DirectConnection);
     connect(this, SIGNAL(WPDeleted(int, WayPointItem *)), item, SLOT(WPDeleted(int, WayPointItem *)), Qt::DirectConnection);
+    connect(item, SIGNAL(WPValuesChanged(WayPointItem *)), this, SLOT(prefetchWaypoints()), Qt::UniqueConnection);
+}
+void OPMapWidget::prefetchWaypoints()
+{
+    QMap<int, internals::PointLatLng> waypoints;
+
+    foreach(QGraphicsItem * i, map->childItems()) {
+        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
+
+        if (w && w->Number() != -1) {
+            waypoints.insert(w->Number(), w->Coord());
+        }
+    }
+    // the flight plan is flown in waypoint number order
+    PrefetchAlong(waypoints.values());
 }
 void OPMapWidget::diagRefresh()
 {
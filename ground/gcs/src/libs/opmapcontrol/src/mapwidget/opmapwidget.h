@@ -39,6 +39,7 @@
 #include "gpsitem.h"
 #include "homeitem.h"
 #include "navitem.h"
+#include "vehiclesitem.h"
 #include "mapripper.h"
 #include "waypointline.h"
 #include "waypointcircle.h"
@@ -53,6 +54,7 @@ class UAVItem;
 class GPSItem;
 class HomeItem;
 class NavItem;
+class VehiclesItem;
 /**
  * @brief Collection of static functions to help dealing with various enums used
  *       Contains functions for enumToString conversio, StringToEnum, QStringList of enum values...
@@ -504,6 +506,8 @@ public:
     GPSItem *GPS;
     HomeItem *Home;
     NavItem *Nav;
+    // other vehicles, fed by the application through SetVehicle
+    VehiclesItem *Vehicles;
     void SetShowUAV(bool const & value);
     bool ShowUAV() const
     {
@@ -520,6 +524,26 @@ public:
         return showNav;
     }
     void SetShowDiagnostics(bool const & value);
+    /**
+     * @brief Loads the tiles along the path in the background, ahead of need
+     *
+     * @param path consecutive points, the tiles between them are loaded too
+     */
+    void PrefetchAlong(QList<internals::PointLatLng> const & path)
+    {
+        map->core->PrefetchAlong(path);
+    }
+    /**
+     * @brief Sets the number of tiles per second the prefetching may download, 0 disables it
+     */
+    void SetPrefetchBudget(int const & tilesPerSecond)
+    {
+        map->core->SetPrefetchBudget(tilesPerSecond);
+    }
+    int PrefetchBudget() const
+    {
+        return map->core->PrefetchBudget();
+    }
     void SetUavPic(QString UAVPic);
     void SetHomePic(QString HomePic);
     WayPointLine *WPLineCreate(WayPointItem *from, WayPointItem *to, QColor color, bool dashed = false, int width = -1);
@@ -554,6 +578,7 @@ private:
     qreal overlayOpacity;
 private slots:
     void diagRefresh();
+    void prefetchWaypoints();
     // WayPointItem* item;//apagar
 protected:
     void resizeEvent(QResizeEvent *event);
@@ -0,0 +1,258 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      A single graphicsItem drawing a whole trail
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "trailpathitem.h"
+#include <QGraphicsSceneHoverEvent>
+#include <QStyleOptionGraphicsItem>
+#include <QPainterPathStroker>
+namespace mapcontrol {
+TrailPathItem::TrailPathItem(QColor const & dotColor, QColor const & lineColor, MapGraphicItem *map) : QGraphicsItem(map),
+    zoom(map->core->Zoom()), m_dotColor(dotColor), m_lineColor(lineColor), showDots(true), showLine(true), m_map(map)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    setAcceptHoverEvents(true);
+    setPosSLOT();
+}
+
+void TrailPathItem::AddPoint(internals::PointLatLng const & coord, int const & altitude)
+{
+    TrailPoint point;
+
+    point.coord    = coord;
+    point.altitude = altitude;
+    point.time     = QDateTime::currentDateTime();
+    points.append(point);
+    if (points.size() > MaxPoints) {
+        points.remove(0, MaxPoints / 10);
+        // the cached paths start at the dropped points, they are rebuilt on use
+        paths.clear();
+    }
+    UpdateBounds();
+    update();
+}
+
+void TrailPathItem::Clear()
+{
+    points.clear();
+    paths.clear();
+    UpdateBounds();
+}
+
+void TrailPathItem::SetShowDots(bool const & value)
+{
+    showDots = value;
+    setVisible(showDots || showLine);
+    update();
+}
+
+void TrailPathItem::SetShowLine(bool const & value)
+{
+    showLine = value;
+    setVisible(showDots || showLine);
+    update();
+}
+
+TrailPathItem::ZoomPath &TrailPathItem::CurrentPath()
+{
+    ZoomPath &path = paths[zoom];
+
+    if (path.raw.size() < points.size()) {
+        QVector<internals::PointLatLng> coords;
+        coords.reserve(points.size() - path.raw.size());
+        for (int i = path.raw.size(); i < points.size(); ++i) {
+            coords.append(points.at(i).coord);
+        }
+        QVector<core::Point> pixels;
+        m_map->Projection()->FromLatLngToPixel(coords, zoom, pixels);
+        foreach(core::Point const & p, pixels) {
+            QPointF pt(p.X(), p.Y());
+            path.raw.append(pt);
+            path.simplified.append(pt);
+            path.bounds = path.bounds.united(QRectF(pt.x() - 2, pt.y() - 2, 4, 4));
+        }
+        if (path.simplified.size() - path.tail >= TailLength) {
+            QPolygonF tail;
+            Simplify(path.simplified.mid(path.tail), 0.5, tail);
+            path.simplified.resize(path.tail);
+            path.simplified += tail;
+            // the last vertex anchors the next tail
+            path.tail = path.simplified.size() - 1;
+        }
+    }
+    return path;
+}
+
+void TrailPathItem::UpdateBounds()
+{
+    prepareGeometryChange();
+    bounds = CurrentPath().bounds;
+}
+
+void TrailPathItem::Simplify(QPolygonF const & in, qreal tolerance, QPolygonF &out)
+{
+    // iterative Douglas-Peucker, keeps the vertices further than tolerance from the chord
+    int count = in.size();
+
+    if (count < 3) {
+        out = in;
+        return;
+    }
+    QVector<bool> keep(count, false);
+    QVector<QPair<int, int> > stack;
+    keep[0] = keep[count - 1] = true;
+    stack.append(qMakePair(0, count - 1));
+    qreal tolerance2 = tolerance * tolerance;
+    while (!stack.isEmpty()) {
+        QPair<int, int> range = stack.takeLast();
+        QPointF a  = in.at(range.first);
+        QPointF ab = in.at(range.second) - a;
+        qreal len2 = QPointF::dotProduct(ab, ab);
+        qreal maxDistance2 = 0;
+        int index = -1;
+        for (int i = range.first + 1; i < range.second; ++i) {
+            QPointF ap = in.at(i) - a;
+            qreal distance2;
+            if (len2 > 0) {
+                qreal cross = ab.x() * ap.y() - ab.y() * ap.x();
+                distance2 = cross * cross / len2;
+            } else {
+                distance2 = QPointF::dotProduct(ap, ap);
+            }
+            if (distance2 > maxDistance2) {
+                maxDistance2 = distance2;
+                index = i;
+            }
+        }
+        if (index != -1 && maxDistance2 > tolerance2) {
+            keep[index] = true;
+            stack.append(qMakePair(range.first, index));
+            stack.append(qMakePair(index, range.second));
+        }
+    }
+    out.clear();
+    for (int i = 0; i < count; ++i) {
+        if (keep.at(i)) {
+            out.append(in.at(i));
+        }
+    }
+}
+
+void TrailPathItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    ZoomPath &path = CurrentPath();
+    if (path.simplified.isEmpty()) {
+        return;
+    }
+    qreal scale = transform().m11();
+    if (showLine) {
+        QPen pen(m_lineColor);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->setBrush(Qt::NoBrush);
+        painter->drawPolyline(path.simplified);
+    }
+    if (showDots) {
+        QPen pen(Qt::black);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->setBrush(m_dotColor);
+        qreal r = 2 / scale;
+        QRectF exposed = option->exposedRect.adjusted(-r, -r, r, r);
+        foreach(const QPointF &pt, path.simplified) {
+            if (exposed.contains(pt)) {
+                painter->drawEllipse(pt, r, r);
+            }
+        }
+    }
+}
+
+QRectF TrailPathItem::boundingRect() const
+{
+    return bounds;
+}
+
+QPainterPath TrailPathItem::shape() const
+{
+    // only the trail itself, so the items below it still get the mouse
+    QPainterPath path;
+    QHash<int, ZoomPath>::const_iterator i = paths.constFind(zoom);
+
+    if (i != paths.constEnd() && !i->simplified.isEmpty()) {
+        QPainterPath line;
+        line.addPolygon(i->simplified);
+        QPainterPathStroker stroker;
+        stroker.setWidth(8 / transform().m11());
+        path = stroker.createStroke(line);
+    }
+    return path;
+}
+
+int TrailPathItem::type() const
+{
+    return Type;
+}
+
+void TrailPathItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    ZoomPath &path = CurrentPath();
+    qreal tolerance = 4 / transform().m11();
+    qreal best = tolerance * tolerance;
+    int index  = -1;
+
+    for (int i = 0; i < path.raw.size(); ++i) {
+        QPointF d = path.raw.at(i) - event->pos();
+        qreal distance2 = QPointF::dotProduct(d, d);
+        if (distance2 <= best) {
+            best  = distance2;
+            index = i;
+        }
+    }
+    if (index == -1) {
+        setToolTip(QString());
+        return;
+    }
+    const TrailPoint &point = points.at(index);
+    QString coord_str = " " + QString::number(point.coord.Lat(), 'f', 6) + "   " + QString::number(point.coord.Lng(), 'f', 6);
+    setToolTip(QString(tr("Position:") + "%1\n" + tr("Altitude:") + "%2\n" + tr("Time:") + "%3").arg(coord_str).arg(QString::number(point.altitude)).arg(point.time.toString()));
+}
+
+void TrailPathItem::setPosSLOT()
+{
+    int z = m_map->core->Zoom();
+
+    if (z != zoom) {
+        zoom = z;
+        UpdateBounds();
+    }
+    // same mapping as MapGraphicItem::FromLatLngToLocal, applied to the map pixels of the current zoom
+    qreal t = m_map->MapRenderTransform;
+    core::Point offset = m_map->core->GetrenderOffset();
+    QRectF rect = m_map->boundingRect();
+    setTransform(QTransform(t, 0, 0, t,
+                            t * offset.X() - (rect.width() * t - rect.width()) / 2,
+                            t * offset.Y() - (rect.height() * t - rect.height()) / 2));
+}
+}
@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ *
+ * @file       trailpathitem.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      A single graphicsItem drawing a whole trail
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TRAILPATHITEM_H
+#define TRAILPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPolygonF>
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+#include "../internals/pointlatlng.h"
+#include <QObject>
+#include "mapgraphicitem.h"
+
+namespace mapcontrol {
+/**
+ * @brief Draws a trail (dots and line) as one item instead of one item per point
+ *
+ * The points are kept in map pixel coordinates per zoom level and simplified with
+ * Douglas-Peucker, so a pan only changes the item transform and painting costs
+ * the simplified vertex count, not the number of recorded points.
+ *
+ * @class TrailPathItem trailpathitem.h "mapwidget/trailpathitem.h"
+ */
+class TrailPathItem : public QObject, public QGraphicsItem {
+    Q_OBJECT Q_INTERFACES(QGraphicsItem)
+public:
+    enum { Type = UserType + 10 };
+    TrailPathItem(QColor const & dotColor, QColor const & lineColor, MapGraphicItem *map);
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget);
+    QRectF boundingRect() const;
+    QPainterPath shape() const;
+    int type() const;
+    void AddPoint(internals::PointLatLng const & coord, int const & altitude);
+    void Clear();
+    void SetShowDots(bool const & value);
+    void SetShowLine(bool const & value);
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+private:
+    struct TrailPoint {
+        internals::PointLatLng coord;
+        int altitude;
+        QDateTime time;
+    };
+    struct ZoomPath {
+        // every recorded point, used to find the one under the mouse
+        QPolygonF raw;
+        // what is drawn, its vertices from tail on are not simplified yet
+        QPolygonF simplified;
+        int tail;
+        QRectF bounds;
+        ZoomPath() : tail(0) {}
+    };
+    ZoomPath &CurrentPath();
+    void UpdateBounds();
+    static void Simplify(QPolygonF const & in, qreal tolerance, QPolygonF &out);
+
+    // oldest points are dropped past this, MaxPoints / 10 at a time
+    static const int MaxPoints = 10000;
+    // unsimplified vertices collected before the tail is simplified
+    static const int TailLength = 64;
+
+    QVector<TrailPoint> points;
+    QHash<int, ZoomPath> paths;
+    int zoom;
+    QRectF bounds;
+    QColor m_dotColor;
+    QColor m_lineColor;
+    bool showDots;
+    bool showLine;
+    MapGraphicItem *m_map;
+public slots:
+    void setPosSLOT();
+};
+}
+#endif // TRAILPATHITEM_H
@@ -0,0 +1,308 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehiclesitem.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      A single graphicsItem drawing many vehicles and their trails
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "vehiclesitem.h"
+#include <QGraphicsSceneHoverEvent>
+#include <QStyleOptionGraphicsItem>
+namespace mapcontrol {
+VehiclesItem::VehiclesItem(MapGraphicItem *map) : QGraphicsItem(map),
+    zoom(map->core->Zoom()), trailLength(1000), trailDistance(5), showTrails(true), m_map(map)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, true);
+    // hover only for the tooltips, clicks go to the items below
+    setAcceptHoverEvents(true);
+    setAcceptedMouseButtons(Qt::NoButton);
+    CreateAtlas(atlas);
+    connect(map, SIGNAL(childRefreshPosition()), this, SLOT(setPosSLOT()));
+    connect(map, SIGNAL(childSetOpacity(qreal)), this, SLOT(setOpacitySlot(qreal)));
+    setPosSLOT();
+}
+
+void VehiclesItem::SetVehicle(int const & id, internals::PointLatLng const & coord, float const & altitude, float const & heading)
+{
+    bool added = !vehicles.contains(id);
+    Vehicle &vehicle = vehicles[id];
+
+    vehicle.coord    = coord;
+    vehicle.altitude = altitude;
+    vehicle.heading  = heading;
+    vehicle.pixel    = ToPixel(coord);
+    if (trailLength > 0 && (added || vehicle.trail.isEmpty() ||
+                            internals::PureProjection::DistanceBetweenLatLng(vehicle.trail.last(), coord) * 1000 >= trailDistance)) {
+        vehicle.trail.append(coord);
+        vehicle.trailPixels.append(vehicle.pixel);
+        if (vehicle.trail.size() > trailLength) {
+            // drop a tenth at a time so the vectors are not shifted on every point
+            int count = qMax(1, trailLength / 10);
+            vehicle.trail.remove(0, count);
+            vehicle.trailPixels.remove(0, count);
+        }
+    }
+    UpdateBounds();
+    update();
+}
+
+void VehiclesItem::RemoveVehicle(int const & id)
+{
+    if (vehicles.remove(id)) {
+        UpdateBounds();
+        update();
+    }
+}
+
+void VehiclesItem::ClearVehicles()
+{
+    vehicles.clear();
+    UpdateBounds();
+    update();
+}
+
+void VehiclesItem::ClearTrails()
+{
+    QMap<int, Vehicle>::iterator i;
+
+    for (i = vehicles.begin(); i != vehicles.end(); ++i) {
+        i->trail.clear();
+        i->trailPixels.clear();
+    }
+    UpdateBounds();
+    update();
+}
+
+QList<int> VehiclesItem::Vehicles() const
+{
+    return vehicles.keys();
+}
+
+void VehiclesItem::SetTrailLength(int const & value)
+{
+    trailLength = qMax(0, value);
+    QMap<int, Vehicle>::iterator i;
+    for (i = vehicles.begin(); i != vehicles.end(); ++i) {
+        int count = i->trail.size() - trailLength;
+        if (count > 0) {
+            i->trail.remove(0, count);
+            i->trailPixels.remove(0, count);
+        }
+    }
+    UpdateBounds();
+    update();
+}
+
+void VehiclesItem::SetTrailDistance(double const & value)
+{
+    trailDistance = value;
+}
+
+void VehiclesItem::SetShowTrails(bool const & value)
+{
+    showTrails = value;
+    UpdateBounds();
+    update();
+}
+
+QPointF VehiclesItem::ToPixel(internals::PointLatLng const & coord) const
+{
+    core::Point p = m_map->Projection()->FromLatLngToPixel(coord, zoom);
+
+    return QPointF(p.X(), p.Y());
+}
+
+void VehiclesItem::RefreshPixels()
+{
+    // one batched conversion for every position and trail point
+    QVector<internals::PointLatLng> coords;
+    QMap<int, Vehicle>::iterator i;
+
+    for (i = vehicles.begin(); i != vehicles.end(); ++i) {
+        coords.append(i->coord);
+        coords += i->trail;
+    }
+    QVector<core::Point> pixels;
+    m_map->Projection()->FromLatLngToPixel(coords, zoom, pixels);
+    int index = 0;
+    for (i = vehicles.begin(); i != vehicles.end(); ++i) {
+        const core::Point &p = pixels.at(index++);
+        i->pixel = QPointF(p.X(), p.Y());
+        i->trailPixels.resize(i->trail.size());
+        for (int j = 0; j < i->trail.size(); ++j) {
+            const core::Point &t = pixels.at(index++);
+            i->trailPixels[j] = QPointF(t.X(), t.Y());
+        }
+    }
+}
+
+void VehiclesItem::UpdateBounds()
+{
+    QRectF rect;
+    QMap<int, Vehicle>::const_iterator i;
+
+    for (i = vehicles.constBegin(); i != vehicles.constEnd(); ++i) {
+        rect = rect.united(QRectF(i->pixel, QSizeF(1, 1)));
+        if (showTrails && !i->trailPixels.isEmpty()) {
+            rect = rect.united(i->trailPixels.boundingRect());
+        }
+    }
+    // the icons keep their size on screen whatever the map transform is
+    qreal r = IconSize / transform().m11();
+    prepareGeometryChange();
+    bounds = vehicles.isEmpty() ? QRectF() : rect.adjusted(-r, -r, r, r);
+}
+
+QColor VehiclesItem::Color(int const & cell)
+{
+    return QColor::fromHsv(cell * 360 / ColorCount, 255, 230);
+}
+
+void VehiclesItem::CreateAtlas(QPixmap &atlas)
+{
+    QPixmap icon = QPixmap(":/uavs/images/mapquad.png").scaled(IconSize, IconSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    atlas = QPixmap(IconSize * ColorCount, IconSize);
+    atlas.fill(Qt::transparent);
+    for (int i = 0; i < ColorCount; ++i) {
+        QPixmap cell(IconSize, IconSize);
+        cell.fill(Qt::transparent);
+        QPainter painter(&cell);
+        painter.drawPixmap((IconSize - icon.width()) / 2, (IconSize - icon.height()) / 2, icon);
+        // tint the opaque pixels only
+        painter.setCompositionMode(QPainter::CompositionMode_SourceAtop);
+        QColor tint = Color(i);
+        tint.setAlpha(120);
+        painter.fillRect(cell.rect(), tint);
+        painter.end();
+        QPainter atlasPainter(&atlas);
+        atlasPainter.drawPixmap(i * IconSize, 0, cell);
+    }
+}
+
+void VehiclesItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    if (vehicles.isEmpty()) {
+        return;
+    }
+    qreal scale = transform().m11();
+    qreal r     = IconSize / scale;
+    QRectF exposed = option->exposedRect.adjusted(-r, -r, r, r);
+    QMap<int, Vehicle>::const_iterator i;
+    if (showTrails) {
+        painter->setBrush(Qt::NoBrush);
+        for (i = vehicles.constBegin(); i != vehicles.constEnd(); ++i) {
+            if (i->trailPixels.size() > 1) {
+                QPen pen(Color((i.key() % ColorCount + ColorCount) % ColorCount));
+                pen.setCosmetic(true);
+                pen.setWidth(2);
+                painter->setPen(pen);
+                painter->drawPolyline(i->trailPixels);
+            }
+        }
+    }
+    QVector<QPainter::PixmapFragment> fragments;
+    fragments.reserve(vehicles.size());
+    for (i = vehicles.constBegin(); i != vehicles.constEnd(); ++i) {
+        if (!exposed.contains(i->pixel)) {
+            continue;
+        }
+        int cell = (i.key() % ColorCount + ColorCount) % ColorCount;
+        fragments.append(QPainter::PixmapFragment::create(i->pixel, QRectF(cell * IconSize, 0, IconSize, IconSize),
+                                                          1 / scale, 1 / scale, i->heading));
+    }
+    if (!fragments.isEmpty()) {
+        painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+        painter->drawPixmapFragments(fragments.constData(), fragments.size(), atlas);
+    }
+}
+
+QRectF VehiclesItem::boundingRect() const
+{
+    return bounds;
+}
+
+QPainterPath VehiclesItem::shape() const
+{
+    // only the icons, so the items below the trails still get the mouse
+    QPainterPath path;
+    qreal r = IconSize / 2 / transform().m11();
+    QMap<int, Vehicle>::const_iterator i;
+
+    for (i = vehicles.constBegin(); i != vehicles.constEnd(); ++i) {
+        path.addEllipse(i->pixel, r, r);
+    }
+    return path;
+}
+
+int VehiclesItem::type() const
+{
+    return Type;
+}
+
+void VehiclesItem::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+{
+    qreal r    = IconSize / 2 / transform().m11();
+    qreal best = r * r;
+    QMap<int, Vehicle>::const_iterator found = vehicles.constEnd();
+    QMap<int, Vehicle>::const_iterator i;
+
+    for (i = vehicles.constBegin(); i != vehicles.constEnd(); ++i) {
+        QPointF d = i->pixel - event->pos();
+        qreal distance2 = QPointF::dotProduct(d, d);
+        if (distance2 <= best) {
+            best  = distance2;
+            found = i;
+        }
+    }
+    if (found == vehicles.constEnd()) {
+        setToolTip(QString());
+        return;
+    }
+    QString coord_str = " " + QString::number(found->coord.Lat(), 'f', 6) + "   " + QString::number(found->coord.Lng(), 'f', 6);
+    setToolTip(QString(tr("Vehicle:") + " %1\n" + tr("Position:") + "%2\n" + tr("Altitude:") + " %3\n" + tr("Heading:") + " %4")
+               .arg(found.key()).arg(coord_str).arg(QString::number(found->altitude, 'f', 1)).arg(QString::number(found->heading, 'f', 0)));
+}
+
+void VehiclesItem::setPosSLOT()
+{
+    int z = m_map->core->Zoom();
+
+    if (z != zoom) {
+        zoom = z;
+        RefreshPixels();
+    }
+    // same mapping as TrailPathItem::setPosSLOT
+    qreal t = m_map->MapRenderTransform;
+    core::Point offset = m_map->core->GetrenderOffset();
+    QRectF rect = m_map->boundingRect();
+    setTransform(QTransform(t, 0, 0, t,
+                            t * offset.X() - (rect.width() * t - rect.width()) / 2,
+                            t * offset.Y() - (rect.height() * t - rect.height()) / 2));
+    UpdateBounds();
+}
+
+void VehiclesItem::setOpacitySlot(qreal opacity)
+{
+    setOpacity(opacity);
+}
+}
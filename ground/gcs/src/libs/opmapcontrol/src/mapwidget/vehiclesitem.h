@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ *
+ * @file       vehiclesitem.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup OPMapWidget
+ * @{
+ * @brief      A single graphicsItem drawing many vehicles and their trails
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef VEHICLESITEM_H
+#define VEHICLESITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPixmap>
+#include <QPolygonF>
+#include <QMap>
+#include <QVector>
+#include "../internals/pointlatlng.h"
+#include <QObject>
+#include "mapgraphicitem.h"
+
+namespace mapcontrol {
+/**
+ * @brief Draws any number of vehicles (icon and trail) as one item
+ *
+ * Vehicles are identified by an id chosen by the caller. Positions and trails are
+ * kept in map pixel coordinates of the current zoom, so a pan only changes the item
+ * transform. Every icon is a tinted cell of one shared pixmap and all of them are
+ * drawn with a single drawPixmapFragments call.
+ *
+ * @class VehiclesItem vehiclesitem.h "mapwidget/vehiclesitem.h"
+ */
+class VehiclesItem : public QObject, public QGraphicsItem {
+    Q_OBJECT Q_INTERFACES(QGraphicsItem)
+public:
+    enum { Type = UserType + 11 };
+    VehiclesItem(MapGraphicItem *map);
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget);
+    QRectF boundingRect() const;
+    QPainterPath shape() const;
+    int type() const;
+    /**
+     * @brief Adds or moves a vehicle, its trail grows when it moved far enough
+     *
+     * @param id caller chosen key, also picks the icon colour
+     * @param heading degrees clockwise from north
+     */
+    void SetVehicle(int const & id, internals::PointLatLng const & coord, float const & altitude, float const & heading);
+    void RemoveVehicle(int const & id);
+    void ClearVehicles();
+    void ClearTrails();
+    QList<int> Vehicles() const;
+    /**
+     * @brief Sets the maximum number of points kept per trail, 0 disables the trails
+     */
+    void SetTrailLength(int const & value);
+    /**
+     * @brief Sets the minimum distance in meters between two trail points
+     */
+    void SetTrailDistance(double const & value);
+    void SetShowTrails(bool const & value);
+protected:
+    void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+private:
+    struct Vehicle {
+        internals::PointLatLng coord;
+        float altitude;
+        float heading;
+        QVector<internals::PointLatLng> trail;
+        // map pixels at zoom
+        QPointF pixel;
+        QPolygonF trailPixels;
+    };
+    void RefreshPixels();
+    void UpdateBounds();
+    QPointF ToPixel(internals::PointLatLng const & coord) const;
+    static void CreateAtlas(QPixmap &atlas);
+    static QColor Color(int const & cell);
+
+    static const int IconSize   = 30;
+    static const int ColorCount = 8;
+
+    QMap<int, Vehicle> vehicles;
+    QPixmap atlas;
+    int zoom;
+    int trailLength;
+    double trailDistance;
+    bool showTrails;
+    QRectF bounds;
+    MapGraphicItem *m_map;
+public slots:
+    void setPosSLOT();
+    void setOpacitySlot(qreal opacity);
+};
+}
+#endif // VEHICLESITEM_H
@@ -30,9 +30,12 @@
 #include <osg/Node>
 #include <osg/NodeVisitor>
 
+#include <QAtomicInt>
 #include <QDebug>
 
 namespace osgQtQuick {
+static QAtomicInt dirtyChangeCount;
+
 class Hidden;
 
 struct DirtySupport::NodeUpdateCallback : public osg::NodeCallback {
@@ -84,6 +87,7 @@ public:
             }
         }
         dirtyFlags |= mask;
+        dirtyChangeCount.ref();
     }
 
     void clearDirty()
@@ -126,6 +130,11 @@ DirtySupport::~DirtySupport()
     delete h;
 }
 
+int DirtySupport::changeCount()
+{
+    return dirtyChangeCount.load();
+}
+
 int DirtySupport::dirty() const
 {
     return h->dirty();
@@ -43,6 +43,10 @@ public:
     explicit DirtySupport();
     virtual ~DirtySupport();
 
+    // incremented each time a node is made dirty, the viewports in on demand mode
+    // do a frame when it changes (can be called from any thread)
+    static int changeCount();
+
 protected:
     int dirty() const;
     bool isDirty(int mask = 0xFFFF) const;
@@ -33,45 +33,103 @@
 #include <QUrl>
 #include <QOpenGLContext>
 #include <QThread>
+#include <QCache>
+#include <QMutex>
 #include <QElapsedTimer>
 #include <QDebug>
 
 namespace osgQtQuick {
-enum DirtyFlag { Source = 1 << 0, Async = 1 << 1, OptimizeMode = 1 << 2 };
+enum DirtyFlag { Source = 1 << 0, Async = 1 << 1, OptimizeMode = 1 << 2, Loaded = 1 << 3 };
+
+// recently loaded (and optimized) nodes, switching back to a model does not read it again
+class OSGFileCache {
+public:
+    // number of files kept once no longer displayed
+    static const int MAX_FILES = 8;
+
+    OSGFileCache()
+    {
+        cache.setMaxCost(MAX_FILES);
+    }
+
+    osg::Node *get(const QString &key)
+    {
+        QMutexLocker locker(&mutex);
+        osg::ref_ptr<osg::Node> *node = cache.object(key);
+
+        return node ? node->get() : NULL;
+    }
+
+    void insert(const QString &key, osg::Node *node)
+    {
+        QMutexLocker locker(&mutex);
+
+        cache.insert(key, new osg::ref_ptr<osg::Node>(node));
+    }
+
+private:
+    QMutex mutex;
+    QCache<QString, osg::ref_ptr<osg::Node> > cache;
+};
+
+Q_GLOBAL_STATIC(OSGFileCache, fileCache)
 
 class OSGFileLoader : public QThread {
     Q_OBJECT
 
 public:
-    OSGFileLoader(const QUrl &url) : url(url)
+    OSGFileLoader(const QUrl &url, OptimizeMode::Enum optimizeMode) : url(url), optimizeMode(optimizeMode)
     {}
 
     void run()
     {
-        osg::Node *node = load();
-        emit loaded(url, node);
+        node = load();
+    }
+
+    static QString cacheKey(const QUrl &url, OptimizeMode::Enum optimizeMode)
+    {
+        return QString("%1:%2").arg(optimizeMode).arg(url.path());
+    }
+
+    static osg::ref_ptr<osg::Node> cached(const QUrl &url, OptimizeMode::Enum optimizeMode)
+    {
+        return fileCache()->get(cacheKey(url, optimizeMode));
     }
 
-    osg::Node *load()
+    // reads and optimizes the file, off the update traversal in async mode
+    osg::ref_ptr<osg::Node> load()
     {
+        QString key = cacheKey(url, optimizeMode);
+        osg::ref_ptr<osg::Node> node = fileCache()->get(key);
+
+        if (node.valid()) {
+            return node;
+        }
+
         QElapsedTimer t;
 
         t.start();
         // qDebug() << "OSGFileLoader::load - reading node file" << url.path();
         // qDebug() << "OSGFileLoader - load - currentContext" << QOpenGLContext::currentContext();
-        osg::Node *node = osgDB::readNodeFile(url.path().toStdString());
-        if (!node) {
+        node = osgDB::readNodeFile(url.path().toStdString());
+        if (!node.valid()) {
             qWarning() << "OSGFileLoader::load - failed to load" << url.path();
+            return NULL;
         }
+        if (optimizeMode != OptimizeMode::None) {
+            // qDebug() << "OSGFileLoader::load - optimize" << node << optimizeMode;
+            osgUtil::Optimizer optimizer;
+            optimizer.optimize(node.get(), osgUtil::Optimizer::DEFAULT_OPTIMIZATIONS);
+        }
+        fileCache()->insert(key, node.get());
         // qDebug() << "OSGFileLoader::load - reading node" << node << "took" << t.elapsed() << "ms";
         return node;
     }
 
-signals:
-    void loaded(const QUrl & url, osg::Node *node);
-
-private:
     QUrl url;
+    OptimizeMode::Enum optimizeMode;
+    // result of an asynchronous load, valid once finished
+    osg::ref_ptr<osg::Node> node;
 };
 
 struct OSGFileNode::Hidden : public QObject {
@@ -85,6 +143,9 @@ public:
     bool async;
     OptimizeMode::Enum optimizeMode;
 
+    // loaded node waiting for the next update traversal
+    osg::ref_ptr<osg::Node> loadedNode;
+
     Hidden(OSGFileNode *self) : QObject(self), self(self), source(), async(false), optimizeMode(OptimizeMode::None)
     {}
 
@@ -97,50 +158,67 @@ public:
                 qWarning() << "OSGFileNode::updateNode - invalid source" << source;
             }
         }
-        if (false /*async*/) {
-            // not supported yet
-            // it is not clear if thread safety is insured...
-            asyncLoad(source);
+        if (async) {
+            osg::ref_ptr<osg::Node> node = OSGFileLoader::cached(source, optimizeMode);
+            if (node.valid()) {
+                setNode(node.get());
+            } else {
+                // the current node is kept until the new one is loaded
+                asyncLoad(source);
+            }
         } else {
-            setNode(syncLoad(source));
+            setNode(syncLoad(source).get());
         }
     }
 
 private:
-    osg::Node *syncLoad(const QUrl &url)
+    osg::ref_ptr<osg::Node> syncLoad(const QUrl &url)
     {
-        OSGFileLoader loader(url);
+        OSGFileLoader loader(url, optimizeMode);
 
         return loader.load();
     }
 
     void asyncLoad(const QUrl &url)
     {
-        OSGFileLoader *loader = new OSGFileLoader(url);
+        OSGFileLoader *loader = new OSGFileLoader(url, optimizeMode);
 
-        connect(loader, &OSGFileLoader::loaded, this, &Hidden::onLoaded);
+        connect(loader, &OSGFileLoader::finished, this, &Hidden::onLoaded);
         connect(loader, &OSGFileLoader::finished, loader, &OSGFileLoader::deleteLater);
         loader->start();
     }
 
+public:
+    void updateLoadedNode()
+    {
+        osg::ref_ptr<osg::Node> node = loadedNode;
+
+        loadedNode = NULL;
+        setNode(node.get());
+    }
+
+private:
+
     void setNode(osg::Node *node)
     {
         // qDebug() << "OSGFileNode::setNode" << node;
-        if (node && optimizeMode != OptimizeMode::None) {
-            // qDebug() << "OSGFileNode::acceptNode - optimize" << node << optimizeMode;
-            osgUtil::Optimizer optimizer;
-            optimizer.optimize(node, osgUtil::Optimizer::DEFAULT_OPTIMIZATIONS);
-        }
+        // already optimized by the loader
         self->setNode(node);
     }
 
 private slots:
-    void onLoaded(const QUrl &url, osg::Node *node)
+    // called in async mode, from the gui thread
+    void onLoaded()
     {
-        // called in async mode
-        // question : is it thread safe to call setNode() ?
-        // could calling setDirty help? is setDirty() thread safe ?
-        setNode(node);
+        OSGFileLoader *loader = static_cast<OSGFileLoader *>(sender());
+
+        if (loader->url != source) {
+            // source changed while loading
+            return;
+        }
+        // the scene graph is only modified during the update traversal, like in sync mode
+        loadedNode = loader->node;
+        self->setDirty(Loaded);
     }
 };
 
@@ -215,6 +293,9 @@ void OSGFileNode::updateNode()
     if (isDirty(Source)) {
         h->updateSource();
     }
+    if (isDirty(Loaded)) {
+        h->updateLoadedNode();
+    }
 }
 } // namespace osgQtQuick
 
@@ -32,12 +32,14 @@
 
 #include "OSGNode.hpp"
 #include "OSGCamera.hpp"
+#include "DirtySupport.hpp"
 
 #include <osg/Node>
 #include <osg/Vec4>
 #include <osg/ApplicationUsage>
 #include <osg/Version>
 #include <osgDB/WriteFile>
+#include <osgDB/DatabasePager>
 #include <osgViewer/CompositeViewer>
 #include <osgViewer/ViewerEventHandlers>
 #include <osgGA/StateSetManipulator>
@@ -50,6 +52,12 @@
 #include <QOpenGLFramebufferObject>
 #include <QSGSimpleTextureNode>
 #include <QOpenGLFunctions>
+#include <QAtomicInt>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QOffscreenSurface>
+#include <QElapsedTimer>
 
 #include <QDebug>
 
@@ -132,16 +140,8 @@ public:
                 // if (view->getDatabasePager()->requiresUpdateSceneGraph()) return true;
                 // if (view->getDatabasePager()->getRequestsInProgress()) return true;
 
-                // if there update callbacks then we need to do frame.
-                if (view->getCamera()->getUpdateCallback()) {
-                    return true;
-                }
-                if (view->getSceneData() && view->getSceneData()->getUpdateCallback()) {
-                    return true;
-                }
-                if (view->getSceneData() && view->getSceneData()->getNumChildrenRequiringUpdateTraversal() > 0) {
-                    return true;
-                }
+                // the update callbacks are not checked: osgEarth always has nodes requiring an update traversal
+                // and that would mean a frame every time. changes are signaled through DirtySupport instead.
             }
         }
 
@@ -161,10 +161,13 @@ public:
     }
 };
 
+class ViewportRenderThread;
+
 struct OSGViewport::Hidden : public QObject {
     Q_OBJECT
 
     friend ViewportRenderer;
+    friend ViewportRenderThread;
 
 private:
     OSGViewport *const self;
@@ -192,13 +195,30 @@ public:
 
     bool busy;
 
+    qreal lodScale;
+    int maximumPagedLODs;
+
+    // DirtySupport change count at the last frame
+    QAtomicInt lastChangeCount;
+
+    bool  threaded;
+    int   targetFrameRate;
+    qreal frameRate;
+    int   droppedFrames;
+
+    // threaded mode only
+    ViewportRenderThread *renderThread;
+    QOffscreenSurface    *surface;
+
     static osg::ref_ptr<osg::GraphicsContext> dummyGC;
 
     static QtKeyboardMap keyMap;
 
     Hidden(OSGViewport *self) : QObject(self), self(self), window(NULL), frameTimer(-1), frameCount(0),
         sceneNode(NULL), cameraNode(NULL), manipulator(NULL),
-        updateMode(UpdateMode::OnDemand), incrementalCompile(false), busy(false)
+        updateMode(UpdateMode::OnDemand), incrementalCompile(false), busy(false),
+        lodScale(1.0), maximumPagedLODs(0), lastChangeCount(DirtySupport::changeCount() - 1),
+        threaded(false), targetFrameRate(30), frameRate(0), droppedFrames(0), renderThread(NULL), surface(NULL)
     {
         OsgEarth::initialize();
 
@@ -218,6 +238,12 @@ public:
     {
         stopTimer();
 
+        stopRenderThread();
+        if (surface) {
+            surface->destroy();
+            delete surface;
+        }
+
         disconnect(self);
     }
 
@@ -259,7 +285,12 @@ private slots:
     void onSceneGraphInvalidated()
     {
         // qDebug() << "OSGViewport::onSceneGraphInvalidated";
-        releaseResources();
+        if (renderThread) {
+            // the render thread owns its gl context and objects
+            stopRenderThread();
+        } else {
+            releaseResources();
+        }
     }
 
     // emitted from the scene graph rendering thread (gl context bound)
@@ -268,6 +299,19 @@ private slots:
         // qDebug() << "OSGViewport::onAfterSynchronizing";
     }
 
+    void onRenderThreadInitialized()
+    {
+        // timers can only be started from the gui thread
+        startTimer();
+    }
+
+    void onFrameStatsChanged(qreal frameRate, int droppedFrames)
+    {
+        this->frameRate     = frameRate;
+        this->droppedFrames = droppedFrames;
+        emit self->frameStatsChanged();
+    }
+
 public:
     bool acceptSceneNode(OSGNode *node)
     {
@@ -365,7 +409,9 @@ private:
         view->init();
         viewer->realize();
 
-        startTimer();
+        if (!renderThread) {
+            startTimer();
+        }
     }
 
     void onAboutToBeDestroyed()
@@ -539,6 +585,102 @@ private:
         }
     }
 
+    // in on demand mode, tells from the gui thread if a frame is needed
+    // what is checked is thread safe, MyViewer::checkNeedToDoFrame() is not
+    bool frameRequested()
+    {
+        if (DirtySupport::changeCount() != lastChangeCount.load()) {
+            return true;
+        }
+        if (!view.valid()) {
+            return false;
+        }
+        if (!view->getEventQueue()->empty()) {
+            return true;
+        }
+        // keep going while tiles are loading
+        osgDB::DatabasePager *pager = view->getDatabasePager();
+        return pager && (pager->getRequestsInProgress()
+                         || (pager->getDataToCompileListSize() > 0) || (pager->getDataToMergeListSize() > 0));
+    }
+
+    // event and update traversals, returns true if a frame needs to be rendered
+    // called from the scene graph rendering thread while the gui thread is blocked
+    bool updateFrame(bool needToDoFrame, bool initFrame)
+    {
+        // draw first frame of freshly initialized renderer
+        needToDoFrame |= initFrame;
+
+        // something changed (camera, uav position, sky...)
+        int changeCount = DirtySupport::changeCount();
+        needToDoFrame |= (changeCount != lastChangeCount.load());
+
+        // level of detail and paging
+        osg::Camera *camera = view->getCamera();
+        if (camera->getLODScale() != lodScale) {
+            camera->setLODScale(lodScale);
+            needToDoFrame = true;
+        }
+        osgDB::DatabasePager *pager = view->getDatabasePager();
+        if (pager && (maximumPagedLODs > 0)
+            && (pager->getTargetMaximumNumberOfPageLOD() != (unsigned int)maximumPagedLODs)) {
+            pager->setTargetMaximumNumberOfPageLOD(maximumPagedLODs);
+        }
+
+        // if not on-demand then do frame
+        if (updateMode != UpdateMode::OnDemand) {
+            needToDoFrame = true;
+        }
+
+        // check if viewport needs to be resized
+        // a redraw will be requested if necessary
+        // not really event driven...
+        int dpr    = self->window()->devicePixelRatio();
+        int width  = self->width() * dpr;
+        int height = self->height() * dpr;
+        osg::Viewport *viewport = view->getCamera()->getViewport();
+        if (initFrame || (viewport->width() != width) || (viewport->height() != height)) {
+            // qDebug() << "*** RESIZE" << frameCount << << initFrame << viewport->width() << "x" << viewport->height() << "->" << width << "x" << height;
+            needToDoFrame = true;
+
+            gc->resized(0, 0, width, height);
+            view->getEventQueue()->windowResize(0, 0, width, height /*, resizeTime*/);
+
+            // trick to force a "home" on first few frames to absorb initial spurious resizes
+            if (frameCount <= 2) {
+                view->home();
+            }
+        }
+
+        if (!needToDoFrame) {
+            // issue : UI events don't trigger a redraw
+            // this issue should be fixed here...
+            // event handling needs a lot of attention :
+            // - sometimes the scene is redrawing continuously (after a drag for example, and single click will stop continuous redraw)
+            // - some events (simple click for instance) trigger a redraw when not needed
+            // - in Earth View : continuous zoom (triggered by holding right button and moving mouse up/down) sometimes stops working when holding mouse still after initiating
+            needToDoFrame = !view->getEventQueue()->empty();
+        }
+
+        if (!needToDoFrame) {
+            needToDoFrame = viewer->checkNeedToDoFrame();
+        }
+        if (needToDoFrame) {
+            // qDebug() << "OSGViewport::updateFrame - update scene" << frameCount;
+            lastChangeCount.store(changeCount);
+            viewer->advance();
+            viewer->eventTraversal();
+            viewer->updateTraversal();
+        }
+
+        // refresh busy state
+        // TODO state becomes busy when scene is loading or downloading tiles (should do it only for download)
+        // TODO also expose request list size to Qml
+        self->setBusy(view->getDatabasePager()->getRequestsInProgress());
+
+        return needToDoFrame;
+    }
+
     void stopTimer()
     {
         if (frameTimer >= 0) {
@@ -552,13 +694,20 @@ protected:
     void timerEvent(QTimerEvent *event)
     {
         if (event->timerId() == frameTimer) {
-            if (self) {
+            // a static scene is not redrawn in on demand mode
+            if (self && ((updateMode != UpdateMode::OnDemand) || frameRequested())) {
                 self->update();
             }
         }
         QObject::timerEvent(event);
     }
 
+public:
+    // called from the scene graph rendering thread (gl context bound)
+    QSGNode *updatePaintNode(QSGNode *node);
+
+    void stopRenderThread();
+
 
 private slots:
     void onSceneNodeChanged(osg::Node *node)
@@ -625,58 +774,7 @@ public:
         // some special care is taken in case a renderer is (re)created;
         // a new renderer will have initFrame set to true for the duration of the first frame
 
-        // draw first frame of freshly initialized renderer
-        needToDoFrame |= initFrame;
-
-        // if not on-demand then do frame
-        if (h->updateMode != UpdateMode::OnDemand) {
-            needToDoFrame = true;
-        }
-
-        // check if viewport needs to be resized
-        // a redraw will be requested if necessary
-        // not really event driven...
-        int dpr    = h->self->window()->devicePixelRatio();
-        int width  = item->width() * dpr;
-        int height = item->height() * dpr;
-        osg::Viewport *viewport = h->view->getCamera()->getViewport();
-        if (initFrame || (viewport->width() != width) || (viewport->height() != height)) {
-            // qDebug() << "*** RESIZE" << h->frameCount << << initFrame << viewport->width() << "x" << viewport->height() << "->" << width << "x" << height;
-            needToDoFrame = true;
-
-            h->gc->resized(0, 0, width, height);
-            h->view->getEventQueue()->windowResize(0, 0, width, height /*, resizeTime*/);
-
-            // trick to force a "home" on first few frames to absorb initial spurious resizes
-            if (h->frameCount <= 2) {
-                h->view->home();
-            }
-        }
-
-        if (!needToDoFrame) {
-            // issue : UI events don't trigger a redraw
-            // this issue should be fixed here...
-            // event handling needs a lot of attention :
-            // - sometimes the scene is redrawing continuously (after a drag for example, and single click will stop continuous redraw)
-            // - some events (simple click for instance) trigger a redraw when not needed
-            // - in Earth View : continuous zoom (triggered by holding right button and moving mouse up/down) sometimes stops working when holding mouse still after initiating
-            needToDoFrame = !h->view->getEventQueue()->empty();
-        }
-
-        if (!needToDoFrame) {
-            needToDoFrame = h->viewer->checkNeedToDoFrame();
-        }
-        if (needToDoFrame) {
-            // qDebug() << "ViewportRenderer::synchronize - update scene" << h->frameCount;
-            h->viewer->advance();
-            h->viewer->eventTraversal();
-            h->viewer->updateTraversal();
-        }
-
-        // refresh busy state
-        // TODO state becomes busy when scene is loading or downloading tiles (should do it only for download)
-        // TODO also expose request list size to Qml
-        h->self->setBusy(h->view->getDatabasePager()->getRequestsInProgress());
+        needToDoFrame = h->updateFrame(needToDoFrame, initFrame);
     }
 
     // This function is called when the FBO should be rendered into.
@@ -724,6 +822,299 @@ public:
     }
 };
 
+/* class ViewportRenderThread */
+
+// Renders the scene into an offscreen framebuffer from a dedicated thread.
+// The event and update traversals are still done from the scene graph rendering thread
+// (when the gui thread is blocked) but the cull and draw traversals are done from this thread.
+// Rendered frames go through three framebuffers (render, ready and display) and are
+// composited by the scene graph as a texture shared between both gl contexts.
+class ViewportRenderThread : public QThread {
+    Q_OBJECT
+
+private:
+    OSGViewport::Hidden *const h;
+
+    QOpenGLContext *context;
+    QOffscreenSurface *surface;
+
+    // protects the state below
+    QMutex mutex;
+    QWaitCondition condition;
+
+    // held while using the viewer
+    QMutex viewerMutex;
+
+    bool resourcesInitialized;
+    bool quit;
+    bool renderRequested;
+    bool readyIsNew;
+    bool initFrame;
+
+    QSize frameSize;
+    int frameInterval;
+
+    QOpenGLFramebufferObject *renderFbo;
+    QOpenGLFramebufferObject *readyFbo;
+    QOpenGLFramebufferObject *displayFbo;
+
+public:
+    ViewportRenderThread(OSGViewport::Hidden *h, QOpenGLContext *shareContext, QOffscreenSurface *surface) :
+        h(h), context(NULL), surface(surface), resourcesInitialized(false), quit(false), renderRequested(false),
+        readyIsNew(false), initFrame(true), frameInterval(33), renderFbo(NULL), readyFbo(NULL), displayFbo(NULL)
+    {
+        context = new QOpenGLContext();
+        context->setFormat(shareContext->format());
+        context->setShareContext(shareContext);
+        if (!context->create()) {
+            qWarning() << "ViewportRenderThread - failed to create gl context";
+        }
+        context->moveToThread(this);
+    }
+
+    ~ViewportRenderThread()
+    {
+        stop();
+        delete context;
+    }
+
+    // starts the thread and waits for the viewer to be realized
+    void startRendering()
+    {
+        QMutexLocker locker(&mutex);
+
+        start();
+        while (!resourcesInitialized) {
+            condition.wait(&mutex);
+        }
+    }
+
+    void stop()
+    {
+        {
+            QMutexLocker locker(&mutex);
+            quit = true;
+            condition.wakeAll();
+        }
+        wait();
+    }
+
+    // called from the scene graph rendering thread while the gui thread is blocked
+    void synchronize()
+    {
+        // don't block the scene graph while a frame is being rendered, next synchronization will catch up
+        if (!viewerMutex.tryLock()) {
+            return;
+        }
+        bool needToDoFrame = h->updateFrame(false, initFrame);
+        initFrame = false;
+        viewerMutex.unlock();
+
+        int dpr = h->self->window()->devicePixelRatio();
+
+        QMutexLocker locker(&mutex);
+        frameSize     = QSize(h->self->width() * dpr, h->self->height() * dpr);
+        frameInterval = 1000 / qMax(1, h->targetFrameRate);
+        if (needToDoFrame) {
+            renderRequested = true;
+            condition.wakeAll();
+        }
+    }
+
+    // returns true if a new frame is available for display
+    bool takeFrame(GLuint &textureId, QSize &size)
+    {
+        QMutexLocker locker(&mutex);
+
+        if (!readyIsNew) {
+            return false;
+        }
+        qSwap(readyFbo, displayFbo);
+        readyIsNew = false;
+        textureId  = displayFbo->texture();
+        size = displayFbo->size();
+        return true;
+    }
+
+signals:
+    void initialized();
+    void frameReady();
+    void statsChanged(qreal frameRate, int droppedFrames);
+
+protected:
+    void run()
+    {
+        context->makeCurrent(surface);
+        QOpenGLFunctions *f = context->functions();
+
+        {
+            QMutexLocker locker(&viewerMutex);
+            h->initializeResources();
+        }
+        {
+            QMutexLocker locker(&mutex);
+            resourcesInitialized = true;
+            condition.wakeAll();
+        }
+        emit initialized();
+
+        QElapsedTimer clock;
+        clock.start();
+        qint64 nextFrame = 0;
+        qint64 statsTime = 0;
+        int frames  = 0;
+        int dropped = 0;
+
+        forever {
+            QSize size;
+            int interval;
+            {
+                QMutexLocker locker(&mutex);
+                while (!quit && !renderRequested) {
+                    condition.wait(&mutex);
+                }
+                if (quit) {
+                    break;
+                }
+                renderRequested = false;
+                size     = frameSize;
+                interval = frameInterval;
+            }
+            if (size.isEmpty()) {
+                continue;
+            }
+
+            // frame pacing
+            qint64 now = clock.elapsed();
+            if (now < nextFrame) {
+                msleep(nextFrame - now);
+            }
+
+            qint64 start = clock.elapsed();
+            {
+                QMutexLocker locker(&viewerMutex);
+
+                if (!renderFbo || (renderFbo->size() != size)) {
+                    delete renderFbo;
+                    renderFbo = createFramebufferObject(size);
+                }
+                renderFbo->bind();
+                f->glViewport(0, 0, size.width(), size.height());
+
+                // needed to properly render models without terrain (Qt bug?)
+                f->glUseProgram(0);
+
+                h->viewer->renderingTraversals();
+
+                // the frame must be complete before it is used from the scene graph context
+                f->glFinish();
+                renderFbo->release();
+
+                ++(h->frameCount);
+            }
+            {
+                QMutexLocker locker(&mutex);
+                qSwap(renderFbo, readyFbo);
+                readyIsNew = true;
+            }
+            qint64 end = clock.elapsed();
+
+            // count the frame slots missed by a slow frame
+            qint64 duration = end - start;
+            if (duration > interval) {
+                dropped += duration / interval;
+            }
+            nextFrame = start + interval;
+            frames++;
+
+            emit frameReady();
+
+            if (end - statsTime >= 1000) {
+                emit statsChanged(frames * 1000.0 / (end - statsTime), dropped);
+                statsTime = end;
+                frames    = 0;
+            }
+        }
+
+        {
+            QMutexLocker locker(&viewerMutex);
+            h->deleteAllGLObjects();
+        }
+        delete renderFbo;
+        delete readyFbo;
+        delete displayFbo;
+        renderFbo  = NULL;
+        readyFbo   = NULL;
+        displayFbo = NULL;
+
+        context->doneCurrent();
+    }
+
+private:
+    QOpenGLFramebufferObject *createFramebufferObject(const QSize &size)
+    {
+        QOpenGLFramebufferObjectFormat format;
+
+        format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+
+        return new QOpenGLFramebufferObject(size, format);
+    }
+};
+
+QSGNode *OSGViewport::Hidden::updatePaintNode(QSGNode *node)
+{
+    if (!renderThread) {
+        if (!surface) {
+            qWarning() << "OSGViewport::updatePaintNode - no offscreen surface";
+            return node;
+        }
+        // qDebug() << "OSGViewport::updatePaintNode - starting render thread";
+        renderThread = new ViewportRenderThread(this, QOpenGLContext::currentContext(), surface);
+        connect(renderThread, &ViewportRenderThread::initialized, this, &Hidden::onRenderThreadInitialized);
+        connect(renderThread, &ViewportRenderThread::statsChanged, this, &Hidden::onFrameStatsChanged);
+        connect(renderThread, &ViewportRenderThread::frameReady, self, &QQuickItem::update);
+        renderThread->startRendering();
+    }
+
+    renderThread->synchronize();
+
+    QSGSimpleTextureNode *textureNode = static_cast<QSGSimpleTextureNode *>(node);
+
+    GLuint textureId;
+    QSize size;
+    if (renderThread->takeFrame(textureId, size)) {
+        if (!textureNode) {
+            textureNode = new QSGSimpleTextureNode();
+            textureNode->setOwnsTexture(true);
+            textureNode->setTextureCoordinatesTransform(QSGSimpleTextureNode::MirrorVertically);
+        }
+        textureNode->setTexture(self->window()->createTextureFromId(textureId, size));
+    }
+    if (textureNode) {
+        textureNode->setRect(self->boundingRect());
+    }
+
+    if (updateMode == UpdateMode::Continuous) {
+        // trigger next update
+        self->update();
+    }
+
+    return textureNode;
+}
+
+void OSGViewport::Hidden::stopRenderThread()
+{
+    if (!renderThread) {
+        return;
+    }
+    // qDebug() << "OSGViewport::stopRenderThread";
+    delete renderThread;
+    renderThread = NULL;
+
+    // the graphics context was bound to the render thread gl context, a new one will be created
+    gc = NULL;
+}
+
 QtKeyboardMap OSGViewport::Hidden::keyMap = QtKeyboardMap();
 
 osg::ref_ptr<osg::GraphicsContext> OSGViewport::Hidden::dummyGC;
@@ -740,9 +1131,12 @@ OSGViewport::OSGViewport(QQuickItem *parent) : Inherited(parent), h(new Hidden(t
     setAcceptedMouseButtons(Qt::AllButtons);
 }
 
-#if QT_VERSION < QT_VERSION_CHECK(5, 6, 0)
 QSGNode *OSGViewport::updatePaintNode(QSGNode *node, QQuickItem::UpdatePaintNodeData *nodeData)
 {
+    if (h->threaded) {
+        return h->updatePaintNode(node);
+    }
+#if QT_VERSION < QT_VERSION_CHECK(5, 6, 0)
     if (!node) {
         node = QQuickFramebufferObject::updatePaintNode(node, nodeData);
         QSGSimpleTextureNode *n = static_cast<QSGSimpleTextureNode *>(node);
@@ -751,9 +1145,9 @@ QSGNode *OSGViewport::updatePaintNode(QSGNode *node, QQuickItem::UpdatePaintNode
         }
         return node;
     }
+#endif
     return QQuickFramebufferObject::updatePaintNode(node, nodeData);
 }
-#endif
 
 OSGViewport::~OSGViewport()
 {
@@ -827,6 +1221,75 @@ void OSGViewport::setIncrementalCompile(bool incrementalCompile)
     }
 }
 
+qreal OSGViewport::lodScale() const
+{
+    return h->lodScale;
+}
+
+void OSGViewport::setLodScale(qreal lodScale)
+{
+    if (h->lodScale != lodScale) {
+        h->lodScale = lodScale;
+        // applied when synchronizing
+        update();
+        emit lodScaleChanged(lodScale);
+    }
+}
+
+int OSGViewport::maximumPagedLODs() const
+{
+    return h->maximumPagedLODs;
+}
+
+void OSGViewport::setMaximumPagedLODs(int maximumPagedLODs)
+{
+    if (h->maximumPagedLODs != maximumPagedLODs) {
+        h->maximumPagedLODs = maximumPagedLODs;
+        update();
+        emit maximumPagedLODsChanged(maximumPagedLODs);
+    }
+}
+
+bool OSGViewport::threaded() const
+{
+    return h->threaded;
+}
+
+void OSGViewport::setThreaded(bool threaded)
+{
+    if (h->threaded != threaded) {
+        if (isComponentComplete()) {
+            qWarning() << "OSGViewport::setThreaded - can't be changed once the component is complete";
+            return;
+        }
+        h->threaded = threaded;
+        emit threadedChanged(threaded);
+    }
+}
+
+int OSGViewport::targetFrameRate() const
+{
+    return h->targetFrameRate;
+}
+
+void OSGViewport::setTargetFrameRate(int targetFrameRate)
+{
+    if (h->targetFrameRate != targetFrameRate) {
+        h->targetFrameRate = targetFrameRate;
+        emit targetFrameRateChanged(targetFrameRate);
+    }
+}
+
+qreal OSGViewport::frameRate() const
+{
+    return h->frameRate;
+}
+
+int OSGViewport::droppedFrames() const
+{
+    return h->droppedFrames;
+}
+
 bool OSGViewport::busy() const
 {
     return h->busy;
@@ -862,6 +1325,13 @@ void OSGViewport::componentComplete()
 {
     // qDebug() << "OSGViewport::componentComplete" << this;
     Inherited::componentComplete();
+
+    if (h->threaded && !h->surface) {
+        // the offscreen surface must be created from the gui thread
+        h->surface = new QOffscreenSurface();
+        h->surface->setFormat(QSurfaceFormat::defaultFormat());
+        h->surface->create();
+    }
 }
 
 void OSGViewport::mousePressEvent(QMouseEvent *event)
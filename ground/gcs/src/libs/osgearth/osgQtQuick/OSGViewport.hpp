@@ -56,6 +56,12 @@ class OSGQTQUICK_EXPORT OSGViewport : public QQuickFramebufferObject {
     Q_PROPERTY(osgQtQuick::OSGCameraManipulator * manipulator READ manipulator WRITE setManipulator NOTIFY manipulatorChanged)
     Q_PROPERTY(osgQtQuick::UpdateMode::Enum updateMode READ updateMode WRITE setUpdateMode NOTIFY updateModeChanged)
     Q_PROPERTY(bool incrementalCompile READ incrementalCompile WRITE setIncrementalCompile NOTIFY incrementalCompileChanged)
+    Q_PROPERTY(qreal lodScale READ lodScale WRITE setLodScale NOTIFY lodScaleChanged)
+    Q_PROPERTY(int maximumPagedLODs READ maximumPagedLODs WRITE setMaximumPagedLODs NOTIFY maximumPagedLODsChanged)
+    Q_PROPERTY(bool threaded READ threaded WRITE setThreaded NOTIFY threadedChanged)
+    Q_PROPERTY(int targetFrameRate READ targetFrameRate WRITE setTargetFrameRate NOTIFY targetFrameRateChanged)
+    Q_PROPERTY(qreal frameRate READ frameRate NOTIFY frameStatsChanged)
+    Q_PROPERTY(int droppedFrames READ droppedFrames NOTIFY frameStatsChanged)
     Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
 
     typedef QQuickFramebufferObject Inherited;
@@ -81,6 +87,26 @@ public:
     bool incrementalCompile() const;
     void setIncrementalCompile(bool busy);
 
+    // greater than 1 lowers the level of detail (and the number of tiles to load)
+    qreal lodScale() const;
+    void setLodScale(qreal lodScale);
+
+    // paged tiles kept in memory, 0 for the osg default
+    int maximumPagedLODs() const;
+    void setMaximumPagedLODs(int maximumPagedLODs);
+
+    // render the scene on a dedicated thread, must be set before the component is complete
+    bool threaded() const;
+    void setThreaded(bool threaded);
+
+    // frame rate cap of the render thread
+    int targetFrameRate() const;
+    void setTargetFrameRate(int targetFrameRate);
+
+    // render thread statistics (threaded mode only)
+    qreal frameRate() const;
+    int droppedFrames() const;
+
     bool busy() const;
     void setBusy(bool busy);
 
@@ -94,6 +120,11 @@ signals:
     void manipulatorChanged(OSGCameraManipulator *);
     void updateModeChanged(UpdateMode::Enum);
     void incrementalCompileChanged(bool);
+    void lodScaleChanged(qreal);
+    void maximumPagedLODsChanged(int);
+    void threadedChanged(bool);
+    void targetFrameRateChanged(int);
+    void frameStatsChanged();
     void busyChanged(bool busy);
 
 protected:
@@ -109,10 +140,8 @@ protected:
     void keyPressEvent(QKeyEvent *event);
     void keyReleaseEvent(QKeyEvent *event);
 
-#if QT_VERSION < QT_VERSION_CHECK(5, 6, 0)
     // QQuickFramebufferObject
     QSGNode *updatePaintNode(QSGNode *node, QQuickItem::UpdatePaintNodeData *nodeData) override;
-#endif
 
 private:
     struct Hidden;
@@ -37,16 +37,26 @@
 #include <osg/Version>
 #include <osg/Notify>
 #include <osgDB/Registry>
+#include <osgDB/ReadFile>
 
 #ifdef USE_OSGEARTH
 #include <osgEarth/Version>
 #include <osgEarth/Cache>
+#include <osgEarth/CacheSeed>
 #include <osgEarth/Capabilities>
+#include <osgEarth/MapNode>
 #include <osgEarth/Registry>
+#include <osgEarth/TileVisitor>
 #include <osgEarthDrivers/cache_filesystem/FileSystemCache>
 #endif
 
 #include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMultiMap>
 
 #ifdef OSG_USE_QT_PRIVATE
 #include <QtGui/private/qguiapplication_p.h>
@@ -57,6 +67,104 @@
 
 bool OsgEarth::registered  = false;
 bool OsgEarth::initialized = false;
+int OsgEarth::cacheSize    = 0;
+bool OsgEarth::cacheOnly   = false;
+
+// removes the least recently written tiles until the cache fits its size
+class CacheTrimmer : public QThread {
+public:
+    CacheTrimmer(const QString &path, qint64 maxBytes) : path(path), maxBytes(maxBytes)
+    {}
+
+    void run()
+    {
+        QMultiMap<QDateTime, QFileInfo> files;
+        qint64 total = 0;
+
+        QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            QFileInfo info = it.fileInfo();
+            files.insert(info.lastModified(), info);
+            total += info.size();
+        }
+        int removed = 0;
+        QMultiMap<QDateTime, QFileInfo>::const_iterator i = files.constBegin();
+        for (; i != files.constEnd() && total > maxBytes; ++i) {
+            if (QFile::remove(i.value().filePath())) {
+                total -= i.value().size();
+                removed++;
+            }
+        }
+        if (removed) {
+            qDebug() << "OsgEarth - removed" << removed << "tiles from the cache, size is now" << total / (1024 * 1024) << "MB";
+        }
+    }
+
+private:
+    QString path;
+    qint64 maxBytes;
+};
+
+#ifdef USE_OSGEARTH
+// downloads the tiles of an area into the cache, for each layer of a terrain file
+class CacheSeeder : public QThread {
+public:
+    CacheSeeder(const QString &terrainFile, const osgEarth::GeoExtent &extent, int maxLevel) :
+        terrainFile(terrainFile), extent(extent), maxLevel(maxLevel)
+    {}
+
+    void run()
+    {
+        osg::ref_ptr<osg::Node> node = osgDB::readNodeFile(terrainFile.toStdString());
+        osgEarth::MapNode *mapNode   = osgEarth::MapNode::findMapNode(node.get());
+
+        if (!mapNode) {
+            qWarning() << "OsgEarth::seedCache - not a terrain file" << terrainFile;
+            return;
+        }
+        osgEarth::Map *map = mapNode->getMap();
+
+        osgEarth::ImageLayerVector imageLayers;
+        osgEarth::ElevationLayerVector elevationLayers;
+#if OSGEARTH_VERSION_LESS_THAN(2, 10, 0)
+        map->getImageLayers(imageLayers);
+        map->getElevationLayers(elevationLayers);
+#else
+        map->getLayers(imageLayers);
+        map->getLayers(elevationLayers);
+#endif
+
+        QElapsedTimer t;
+        t.start();
+        for (unsigned int i = 0; i < imageLayers.size(); i++) {
+            seed(imageLayers[i].get(), map);
+        }
+        for (unsigned int i = 0; i < elevationLayers.size(); i++) {
+            seed(elevationLayers[i].get(), map);
+        }
+        qDebug() << "OsgEarth::seedCache - seeded" << terrainFile << "up to level" << maxLevel << "in" << t.elapsed() / 1000 << "s";
+    }
+
+private:
+    void seed(osgEarth::TerrainLayer *layer, osgEarth::Map *map)
+    {
+        osg::ref_ptr<osgEarth::TileVisitor> visitor = new osgEarth::TileVisitor();
+
+        visitor->setMinLevel(0);
+        visitor->setMaxLevel(maxLevel);
+        visitor->addExtent(extent);
+
+        osgEarth::CacheSeed seeder;
+        seeder.setVisitor(visitor.get());
+        seeder.run(layer, map);
+    }
+
+    QString terrainFile;
+    osgEarth::GeoExtent extent;
+    int maxLevel;
+};
+#endif // ifdef USE_OSGEARTH
 
 class OSGEARTH_LIB_EXPORT QtNotifyHandler : public osg::NotifyHandler {
 public:
@@ -125,23 +233,96 @@ void OsgEarth::initializePathes()
     libraryFilePathList.push_front((Utils::GetLibraryPath() + "osg").toStdString());
 }
 
+QString OsgEarth::cachePath()
+{
+    // same storage root as the opmapcontrol tiles
+    return Utils::GetStoragePath() + "mapscache/osgearth/";
+}
+
+void OsgEarth::setCacheSize(int megabytes)
+{
+    cacheSize = megabytes;
+    if (initialized && cacheSize > 0) {
+        CacheTrimmer *trimmer = new CacheTrimmer(cachePath(), (qint64)cacheSize * 1024 * 1024);
+        QObject::connect(trimmer, SIGNAL(finished()), trimmer, SLOT(deleteLater()));
+        trimmer->start(QThread::LowPriority);
+    }
+}
+
+void OsgEarth::setCacheOnly(bool flag)
+{
+    cacheOnly = flag;
+    if (initialized) {
+        applyCachePolicy();
+    }
+}
+
+bool OsgEarth::seedCache(const QString &terrainFile, double minLatitude, double minLongitude,
+                         double maxLatitude, double maxLongitude, int maxLevel)
+{
+#ifdef USE_OSGEARTH
+    initialize();
+
+    const osgEarth::SpatialReference *wgs84 = osgEarth::SpatialReference::get("wgs84");
+    osgEarth::GeoExtent extent(wgs84, minLongitude, minLatitude, maxLongitude, maxLatitude);
+    if (!extent.isValid()) {
+        return false;
+    }
+    CacheSeeder *seeder = new CacheSeeder(terrainFile, extent, maxLevel);
+    QObject::connect(seeder, SIGNAL(finished()), seeder, SLOT(deleteLater()));
+    seeder->start(QThread::LowPriority);
+    return true;
+
+#else
+    Q_UNUSED(terrainFile);
+    Q_UNUSED(minLatitude);
+    Q_UNUSED(minLongitude);
+    Q_UNUSED(maxLatitude);
+    Q_UNUSED(maxLongitude);
+    Q_UNUSED(maxLevel);
+    return false;
+
+#endif // ifdef USE_OSGEARTH
+}
+
+void OsgEarth::applyCachePolicy()
+{
+#ifdef USE_OSGEARTH
+    // The override cache policy (overrides all others if set)
+    if (cacheOnly) {
+        osgEarth::Registry::instance()->setOverrideCachePolicy(osgEarth::CachePolicy::USAGE_CACHE_ONLY);
+    } else {
+        osgEarth::Registry::instance()->setOverrideCachePolicy(osgEarth::CachePolicy());
+    }
+#endif
+}
+
 void OsgEarth::initializeCache()
 {
 #ifdef USE_OSGEARTH
 
-    QString cachePath = Utils::GetStoragePath() + "osgearth/cache";
+    // the cache is created here instead of letting the terrain files declare one
+    osgEarth::Drivers::FileSystemCacheOptions cacheOptions;
+    cacheOptions.rootPath() = cachePath().toStdString();
 
-    qputenv("OSGEARTH_CACHE_PATH", cachePath.toLatin1());
+    osg::ref_ptr<osgEarth::Cache> cache = osgEarth::CacheFactory::create(cacheOptions);
+    if (cache.valid() && cache->isOK()) {
+        osgEarth::Registry::instance()->setCache(cache.get());
+    } else {
+        qWarning() << "OsgEarth::initializeCache - failed to create cache in" << cachePath();
+    }
 
     const osgEarth::CachePolicy cachePolicy(osgEarth::CachePolicy::USAGE_READ_WRITE);
 
     // The default cache policy used when no policy is set elsewhere
     osgEarth::Registry::instance()->setDefaultCachePolicy(cachePolicy);
 
-    // The override cache policy (overrides all others if set)
-    // osgEarth::Registry::instance()->setOverrideCachePolicy(cachePolicy);
+    applyCachePolicy();
 
 #endif // ifdef USE_OSGEARTH
+
+    // trim the cache with the size set before initialization
+    setCacheSize(cacheSize);
 }
 
 void OsgEarth::displayInfo()
@@ -30,14 +30,30 @@
 
 #include "osgearth_global.h"
 
+#include <QString>
+
 class OSGEARTH_LIB_EXPORT OsgEarth {
 public:
     static void registerQmlTypes();
     static void initialize();
 
+    // terrain and imagery disk cache, next to the map tiles cache
+    static QString cachePath();
+    // oldest tiles are removed above that size, 0 for no limit
+    static void setCacheSize(int megabytes);
+    // tiles are only read from the cache, nothing is downloaded
+    static void setCacheOnly(bool cacheOnly);
+    // downloads in the background the tiles of an area for all the layers of a terrain file
+    static bool seedCache(const QString &terrainFile, double minLatitude, double minLongitude,
+                          double maxLatitude, double maxLongitude, int maxLevel);
+
 private:
     static bool registered;
     static bool initialized;
+    static int cacheSize;
+    static bool cacheOnly;
+
+    static void applyCachePolicy();
 
     static void initializePathes();
     static void initializeCache();
@@ -129,13 +129,26 @@ bool GSTImageStream::setPipeline(const std::string &pipeline)
     // sink
     GstElement *sink = gst_bin_get_by_name(GST_BIN(_pipeline), "sink");
 
-    g_signal_connect(sink, "new-sample", G_CALLBACK(on_new_sample), this);
     g_signal_connect(sink, "new-preroll", G_CALLBACK(on_new_preroll), this);
 
-    gst_object_unref(sink);
+    if (gst_element_set_state(_pipeline, GST_STATE_PAUSED) == GST_STATE_CHANGE_NO_PREROLL) {
+        // live source (camera, network stream): there is no preroll and the sooner the better
+        gst::setLowLatency(_pipeline);
+        gst_element_set_state(_pipeline, GST_STATE_PLAYING);
 
-    gst_element_set_state(_pipeline, GST_STATE_PAUSED);
-    gst_element_get_state(_pipeline, 0, 0, GST_CLOCK_TIME_NONE); // wait until the state changed
+        // wait for the first frame to know the image size
+        GstSample *sample = gst_app_sink_try_pull_sample(GST_APP_SINK(sink), 5 * GST_SECOND);
+        if (sample) {
+            allocateInternalBuffer(sample);
+            gst_sample_unref(sample);
+        }
+    } else {
+        gst_element_get_state(_pipeline, 0, 0, GST_CLOCK_TIME_NONE); // wait until the state changed
+    }
+
+    g_signal_connect(sink, "new-sample", G_CALLBACK(on_new_sample), this);
+
+    gst_object_unref(sink);
 
     if (_width == 0 || _height == 0) {
         // no valid image has been setup by a on_new_preroll() call.
@@ -270,15 +283,11 @@ GstFlowReturn GSTImageStream::on_new_sample(GstAppSink *appsink, GSTImageStream
         return GST_FLOW_ERROR;
     }
 
-    // upload data
-    GstMapInfo info;
-    if (!gst_buffer_map(buffer, &info, GST_MAP_READ)) {
-        qWarning() << "Failed to map buffer";
-        // TODO
-    }
-    gsize size = gst_buffer_extract(buffer, 0, user_data->_internal_buffer, info.size);
-    if (size != info.size) {
-        qWarning() << "GSTImageStream::on_new_sample : extracted" << size << "/" << info.size;
+    // upload data, gst_buffer_extract() does the copy without mapping the whole buffer
+    gsize bufferSize = gst_buffer_get_size(buffer);
+    gsize size = gst_buffer_extract(buffer, 0, user_data->_internal_buffer, bufferSize);
+    if (size != bufferSize) {
+        qWarning() << "GSTImageStream::on_new_sample : extracted" << size << "/" << bufferSize;
         // TODO
     }
 
@@ -286,7 +295,6 @@ GstFlowReturn GSTImageStream::on_new_sample(GstAppSink *appsink, GSTImageStream
     user_data->dirty();
 
     // clean resources
-    gst_buffer_unmap(buffer, &info);
     gst_sample_unref(sample);
 
     return GST_FLOW_OK;
@@ -21,13 +21,22 @@
 /**********************************************************************/
 #include "sdlgamepad.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QMetaMethod>
+#include <chrono>
+#include <string.h>
+
 #include <SDL/SDL.h>
 // #undef main
 
 class SDLGamepadPrivate {
 public:
-    SDLGamepadPrivate() : gamepad(0)
-    {}
+    SDLGamepadPrivate() : gamepad(0), axesCount(0), axesTimestamp(0)
+    {
+        memset(axesValues, 0, sizeof(axesValues));
+    }
 
     /**
      * SDL_Joystick object.
@@ -35,6 +44,21 @@ public:
      * This represents the currently opened SDL_Joystick object.
      */
     SDL_Joystick *gamepad;
+
+    /**
+     * The latest axes values, read by SDLGamepad::readAxes().
+     *
+     * Guarded by axesMutex, axesTimestamp is the time they were read.
+     */
+    qint16 axesValues[MAX_AXES];
+    int axesCount;
+    qint64 axesTimestamp;
+    QMutex axesMutex;
+
+    /**
+     * Set when axesChanged was emitted and readAxes() was not called yet.
+     */
+    QAtomicInt axesNotified;
 };
 
 /**********************************************************************/
@@ -91,6 +115,9 @@ bool SDLGamepad::init()
 void SDLGamepad::run()
 {
     while (loop) {
+        if (priv->gamepad) {
+            SDL_JoystickUpdate();
+        }
         updateAxes();
         updateButtons();
         msleep(tick);
@@ -141,29 +168,64 @@ void SDLGamepad::setTickRate(qint16 ms)
 void SDLGamepad::updateAxes()
 {
     if (priv->gamepad) {
-        QListInt16 values;
-        SDL_JoystickUpdate();
+        qint16 values[MAX_AXES];
+        int count = qMin((int)axes, MAX_AXES);
 
-        for (qint8 i = 0; i < axes; i++) {
+        for (qint8 i = 0; i < count; i++) {
             qint16 value = SDL_JoystickGetAxis(priv->gamepad, i);
 
             if (value > -NULL_RANGE && value < NULL_RANGE) {
                 value = 0;
             }
 
-            values.append(value);
+            values[i] = value;
+        }
+
+        bool changed = false;
+        {
+            QMutexLocker locker(&priv->axesMutex);
+            if (count != priv->axesCount || memcmp(values, priv->axesValues, count * sizeof(qint16)) != 0) {
+                memcpy(priv->axesValues, values, count * sizeof(qint16));
+                priv->axesCount     = count;
+                priv->axesTimestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+                changed = true;
+            }
+        }
+        if (changed && priv->axesNotified.testAndSetOrdered(0, 1)) {
+            emit axesChanged();
+        }
+
+        // the list is allocated for each tick, only build it for the receivers of axesValues
+        static const QMetaMethod axesValuesSignal = QMetaMethod::fromSignal(&SDLGamepad::axesValues);
+        if (isSignalConnected(axesValuesSignal)) {
+            QListInt16 list;
+            for (int i = 0; i < count; i++) {
+                list.append(values[i]);
+            }
+            emit axesValues(list);
         }
+    }
+}
+
+/**********************************************************************/
+int SDLGamepad::readAxes(qint16 *values, int count, qint64 *timestamp)
+{
+    QMutexLocker locker(&priv->axesMutex);
 
-        emit axesValues(values);
+    priv->axesNotified.storeRelease(0);
+    count = qMin(count, priv->axesCount);
+    memcpy(values, priv->axesValues, count * sizeof(qint16));
+    if (timestamp) {
+        *timestamp = priv->axesTimestamp;
     }
+    return count;
 }
 
 /**********************************************************************/
 void SDLGamepad::updateButtons()
 {
     if (priv->gamepad) {
-        SDL_JoystickUpdate();
-
         for (qint8 i = 0; i < buttons; i++) {
             qint16 state = SDL_JoystickGetButton(priv->gamepad, i);
 
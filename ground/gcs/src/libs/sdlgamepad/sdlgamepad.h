@@ -46,6 +46,13 @@
  */
 #define MIN_RATE   10
 
+/**
+ * The maximum number of axes read by SDLGamepad::readAxes().
+ *
+ * Additional axes of the gamepad are ignored.
+ */
+#define MAX_AXES   16
+
 /**
  * Axis enumeration.
  *
@@ -176,6 +183,22 @@ public:
      */
     qint16 getButtons();
 
+    /**
+     * Copy the latest axes values.
+     *
+     * This is the allocation free way to get the axes, to be called
+     * after the axesChanged signal. It can be called from any thread.
+     * The next change will emit axesChanged again.
+     *
+     * @see axesChanged()
+     * @param values The array receiving the values.
+     * @param count The size of values.
+     * @param timestamp If not null, receives the time the values were
+     * read from SDL, in microseconds of the steady clock.
+     * @return The number of values copied.
+     */
+    int readAxes(qint16 *values, int count, qint64 *timestamp = 0);
+
 public slots:
 
     /**
@@ -347,6 +370,18 @@ signals:
      * @param values A QListInt16 Type containing all axes values.
      */
     void axesValues(QListInt16 values);
+
+    /**
+     * A signal that tells the axes values changed.
+     *
+     * This signal is emitted when an axis moves, once until readAxes()
+     * is called, so that the changes made while the receiver is busy do
+     * not pile up in its event queue. Unlike axesValues, it does not
+     * allocate anything.
+     *
+     * @see readAxes()
+     */
+    void axesChanged();
 };
 
 #endif // SDLGAMEPAD_H
@@ -29,6 +29,7 @@
 
 #include "coordinateconversions.h"
 #include <stdint.h>
+#include <string.h>
 #include <QDebug>
 #include <math.h>
 
@@ -212,6 +213,30 @@ void CoordinateConversions::Quaternion2RPY(const float q[4], float rpy[3])
     // TODO: consider the cases where |R13| ~= 1, |pitch| ~= pi/2
 }
 
+/**
+ * Batch version of Quaternion2RPY over separate component arrays
+ */
+void CoordinateConversions::Quaternion2RPY(const float *q0, const float *q1, const float *q2, const float *q3,
+                                           float *roll, float *pitch, float *yaw, int count)
+{
+    for (int i = 0; i < count; i++) {
+        float q0s = q0[i] * q0[i];
+        float q1s = q1[i] * q1[i];
+        float q2s = q2[i] * q2[i];
+        float q3s = q3[i] * q3[i];
+
+        float R13 = 2 * (q1[i] * q3[i] - q0[i] * q2[i]);
+        float R11 = q0s + q1s - q2s - q3s;
+        float R12 = 2 * (q1[i] * q2[i] + q0[i] * q3[i]);
+        float R23 = 2 * (q2[i] * q3[i] + q0[i] * q1[i]);
+        float R33 = q0s - q1s - q2s + q3s;
+
+        pitch[i] = RAD2DEG * asinf(-R13);
+        yaw[i]   = RAD2DEG * atan2f(R12, R11);
+        roll[i]  = RAD2DEG * atan2f(R23, R33);
+    }
+}
+
 // ****** find quaternion from roll, pitch, yaw ********
 void CoordinateConversions::RPY2Quaternion(const float rpy[3], float q[4])
 {
@@ -277,4 +302,102 @@ void CoordinateConversions::R2Quaternion(float const Rbe[3][3], float q[4])
     q[2] = y;
     q[3] = z;
 }
+
+LocalFrame::LocalFrame() :
+    m_valid(false)
+{
+    memset(m_baseLLA, 0, sizeof(m_baseLLA));
+    memset(m_baseECEF, 0, sizeof(m_baseECEF));
+    memset(m_Rne, 0, sizeof(m_Rne));
+}
+
+LocalFrame::LocalFrame(const double baseLLA[3]) :
+    m_valid(false)
+{
+    setBase(baseLLA);
+}
+
+void LocalFrame::setBase(const double baseLLA[3])
+{
+    if (m_valid && !memcmp(m_baseLLA, baseLLA, sizeof(m_baseLLA))) {
+        return;
+    }
+    memcpy(m_baseLLA, baseLLA, sizeof(m_baseLLA));
+    CoordinateConversions().LLA2ECEF(m_baseLLA, m_baseECEF);
+
+    // same as RneFromLLA, kept in double
+    double sinLat = sin(DEG2RAD * baseLLA[0]);
+    double sinLon = sin(DEG2RAD * baseLLA[1]);
+    double cosLat = cos(DEG2RAD * baseLLA[0]);
+    double cosLon = cos(DEG2RAD * baseLLA[1]);
+
+    m_Rne[0][0] = -sinLat * cosLon; m_Rne[0][1] = -sinLat * sinLon; m_Rne[0][2] = cosLat;
+    m_Rne[1][0] = -sinLon; m_Rne[1][1] = cosLon; m_Rne[1][2] = 0;
+    m_Rne[2][0] = -cosLat * cosLon; m_Rne[2][1] = -cosLat * sinLon; m_Rne[2][2] = -sinLat;
+    m_valid     = true;
+}
+
+void LocalFrame::toNED(const double LLA[3], float NED[3]) const
+{
+    toNED(&LLA[0], &LLA[1], &LLA[2], &NED[0], &NED[1], &NED[2], 1);
+}
+
+/**
+ * LLA2Base for count points
+ */
+void LocalFrame::toNED(const double *lat, const double *lon, const double *alt,
+                       float *north, float *east, float *down, int count) const
+{
+    const double a = 6378137.0; // Equatorial Radius
+    const double e = 8.1819190842622e-2; // Eccentricity
+
+    for (int i = 0; i < count; i++) {
+        double sinLat = sin(DEG2RAD * lat[i]);
+        double sinLon = sin(DEG2RAD * lon[i]);
+        double cosLat = cos(DEG2RAD * lat[i]);
+        double cosLon = cos(DEG2RAD * lon[i]);
+        double N = a / sqrt(1.0 - e * e * sinLat * sinLat);
+
+        double dx = (N + alt[i]) * cosLat * cosLon - m_baseECEF[0];
+        double dy = (N + alt[i]) * cosLat * sinLon - m_baseECEF[1];
+        double dz = ((1 - e * e) * N + alt[i]) * sinLat - m_baseECEF[2];
+
+        north[i] = (float)(m_Rne[0][0] * dx + m_Rne[0][1] * dy + m_Rne[0][2] * dz);
+        east[i]  = (float)(m_Rne[1][0] * dx + m_Rne[1][1] * dy + m_Rne[1][2] * dz);
+        down[i]  = (float)(m_Rne[2][0] * dx + m_Rne[2][1] * dy + m_Rne[2][2] * dz);
+    }
+}
+
+void LocalFrame::toLLA(const double NED[3], double LLA[3]) const
+{
+    double ECEF[3];
+
+    /* P = ECEF + Rne' * NED */
+    for (int i = 0; i < 3; i++) {
+        ECEF[i] = m_baseECEF[i] + m_Rne[0][i] * NED[0] + m_Rne[1][i] * NED[1] + m_Rne[2][i] * NED[2];
+    }
+    CoordinateConversions().ECEF2LLA(ECEF, LLA);
+}
+
+/**
+ * NED2LLA_HomeECEF for count points, without recomputing the base frame for each
+ */
+void LocalFrame::toLLA(const float *north, const float *east, const float *down,
+                       double *lat, double *lon, double *alt, int count) const
+{
+    CoordinateConversions conversions;
+
+    for (int i = 0; i < count; i++) {
+        double ECEF[3];
+        double LLA[3];
+
+        for (int j = 0; j < 3; j++) {
+            ECEF[j] = m_baseECEF[j] + m_Rne[0][j] * north[i] + m_Rne[1][j] * east[i] + m_Rne[2][j] * down[i];
+        }
+        conversions.ECEF2LLA(ECEF, LLA);
+        lat[i] = LLA[0];
+        lon[i] = LLA[1];
+        alt[i] = LLA[2];
+    }
+}
 }
@@ -46,10 +46,44 @@ public:
     int ECEF2LLA(double ECEF[3], double LLA[3]);
     void LLA2Base(double LLA[3], double BaseECEF[3], float Rne[3][3], float NED[3]);
     void Quaternion2RPY(const float q[4], float rpy[3]);
+    void Quaternion2RPY(const float *q0, const float *q1, const float *q2, const float *q3,
+                        float *roll, float *pitch, float *yaw, int count);
     void RPY2Quaternion(const float rpy[3], float q[4]);
     void Quaternion2R(const float q[4], float Rbe[3][3]);
     void R2Quaternion(float const Rbe[3][3], float q[4]);
 };
+
+/**
+ * NED frame tangent to the WGS-84 ellipsoid at a base location.
+ * The base ECEF position and rotation are computed once, the batch conversions
+ * take one array per coordinate so the loops vectorise and whole trails or
+ * waypoint lists can be converted in one call.
+ */
+class QTCREATOR_UTILS_EXPORT LocalFrame {
+public:
+    LocalFrame();
+    explicit LocalFrame(const double baseLLA[3]);
+
+    // does nothing if the base is unchanged
+    void setBase(const double baseLLA[3]);
+    bool isValid() const
+    {
+        return m_valid;
+    }
+
+    void toNED(const double LLA[3], float NED[3]) const;
+    void toNED(const double *lat, const double *lon, const double *alt,
+               float *north, float *east, float *down, int count) const;
+    void toLLA(const double NED[3], double LLA[3]) const;
+    void toLLA(const float *north, const float *east, const float *down,
+               double *lat, double *lon, double *alt, int count) const;
+
+private:
+    bool m_valid;
+    double m_baseLLA[3];
+    double m_baseECEF[3];
+    double m_Rne[3][3];
+};
 }
 
 #endif /* COORDINATECONVERSIONS_H */
@@ -65,10 +65,136 @@ quint8 Crc::updateCRC(quint8 crc, const quint8 data)
     return crc_table[crc ^ data];
 }
 
+namespace {
+/*
+ * Slicing tables, crc8_slice[k][b] is the crc of the byte b followed by k zero bytes:
+ * the crc of 8 bytes is the xor of the crc of each byte shifted by its distance to the end.
+ */
+struct Crc8Slices {
+    quint8 table[8][256];
+
+    Crc8Slices()
+    {
+        for (int b = 0; b < 256; b++) {
+            table[0][b] = crc_table[b];
+        }
+        for (int k = 1; k < 8; k++) {
+            for (int b = 0; b < 256; b++) {
+                table[k][b] = crc_table[table[k - 1][b]];
+            }
+        }
+    }
+};
+
+/*
+ * Same for the STM32 crc32 (polynomial 0x04C11DB7, not reflected, 32 bits words),
+ * crc32_slice[k][b] is the crc of the byte b followed by k zero bytes.
+ */
+struct Crc32Slices {
+    quint32 table[4][256];
+
+    Crc32Slices()
+    {
+        for (quint32 b = 0; b < 256; b++) {
+            quint32 crc = b << 24;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+            }
+            table[0][b] = crc;
+        }
+        for (int k = 1; k < 4; k++) {
+            for (int b = 0; b < 256; b++) {
+                quint32 crc = table[k - 1][b];
+                table[k][b] = (crc << 8) ^ table[0][crc >> 24];
+            }
+        }
+    }
+};
+
+/*
+ * CRC-16/CCITT (polynomial 0x1021, not reflected), crc16_table[b] is the crc of the byte b.
+ */
+struct Crc16Table {
+    quint16 table[256];
+
+    Crc16Table()
+    {
+        for (int b = 0; b < 256; b++) {
+            quint16 crc = b << 8;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+            }
+            table[b] = crc;
+        }
+    }
+};
+
+const Crc8Slices &crc8Slices()
+{
+    static const Crc8Slices slices;
+
+    return slices;
+}
+
+const Crc32Slices &crc32Slices()
+{
+    static const Crc32Slices slices;
+
+    return slices;
+}
+
+const Crc16Table &crc16Table()
+{
+    static const Crc16Table table;
+
+    return table;
+}
+}
+
 quint8 Crc::updateCRC(quint8 crc, const quint8 *data, qint32 length)
+{
+    if (length >= 16) {
+        const quint8(*table)[256] = crc8Slices().table;
+
+        // 8 bytes at a time, without any dependency between the lookups
+        while (length >= 8) {
+            crc = table[7][crc ^ data[0]] ^ table[6][data[1]] ^ table[5][data[2]] ^ table[4][data[3]] ^
+                  table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^ table[0][data[7]];
+            data   += 8;
+            length -= 8;
+        }
+    }
+    while (length-- > 0) {
+        crc = crc_table[crc ^ *data++];
+    }
+    return crc;
+}
+
+quint8 Crc::updateCRCBytewise(quint8 crc, const quint8 *data, qint32 length)
 {
     while (length--) {
         crc = crc_table[crc ^ *data++];
     }
     return crc;
 }
+
+quint16 Crc::updateCRC16(quint16 crc, const quint8 *data, qint32 length)
+{
+    const quint16 *table = crc16Table().table;
+
+    while (length-- > 0) {
+        crc = (crc << 8) ^ table[(crc >> 8) ^ *data++];
+    }
+    return crc;
+}
+
+quint32 Crc::updateCRC32(quint32 crc, const quint32 *data, quint32 words)
+{
+    const quint32(*table)[256] = crc32Slices().table;
+
+    while (words--) {
+        crc ^= *data++;
+        crc  = table[3][crc >> 24] ^ table[2][(crc >> 16) & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[0][crc & 0xFF];
+    }
+    return crc;
+}
@@ -52,6 +52,34 @@ public:
      * \return         The updated crc value.
      */
     static quint8 updateCRC(quint8 crc, const quint8 *data, qint32 length);
+
+    /**
+     * Same as updateCRC(), one byte at a time instead of eight.
+     * Kept as a reference for the benchmark.
+     */
+    static quint8 updateCRCBytewise(quint8 crc, const quint8 *data, qint32 length);
+
+    /**
+     * Update the CRC-16/CCITT value (polynomial 0x1021, not reflected),
+     * as used by the UAVTalk v2 framing.
+     *
+     * \param crc      The current crc value, 0xFFFF to start.
+     * \param data     Pointer to a buffer of \a length bytes.
+     * \param length   Number of bytes in the \a data buffer.
+     * \return         The updated crc value.
+     */
+    static quint16 updateCRC16(quint16 crc, const quint8 *data, qint32 length);
+
+    /**
+     * Update the STM32 crc32 value (polynomial 0x04C11DB7, not reflected)
+     * with 32 bits words, as computed by the bootloader and the CRC unit.
+     *
+     * \param crc      The current crc value, 0xFFFFFFFF to start.
+     * \param data     Pointer to a buffer of \a words words.
+     * \param words    Number of words in the \a data buffer.
+     * \return         The updated crc value.
+     */
+    static quint32 updateCRC32(quint32 crc, const quint32 *data, quint32 words);
 };
 } // namespace Utils
 
@@ -31,9 +31,41 @@
 
 #include <stdint.h>
 #include <QDateTime>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "worldmagmodel.h"
 
+namespace {
+// location (at the resolution HomeLocation stores it) and date of a magnetic field query
+struct MagFieldKey {
+    qint64 latitude;
+    qint64 longitude;
+    qint64 altitude;
+    qint64 day;
+
+    bool operator==(const MagFieldKey &other) const
+    {
+        return latitude == other.latitude && longitude == other.longitude
+               && altitude == other.altitude && day == other.day;
+    }
+};
+
+uint qHash(const MagFieldKey &key)
+{
+    return ::qHash(key.latitude) ^ (::qHash(key.longitude) << 1) ^ (::qHash(key.altitude) << 2) ^ ::qHash(key.day);
+}
+
+struct MagField {
+    double Be[3];
+};
+
+// dragging the home marker queries the same few locations over and over
+QCache<MagFieldKey, MagField> magFieldCache(64);
+QMutex magFieldMutex;
+}
+
 namespace Utils {
 HomeLocationUtil::HomeLocationUtil()
 {}
@@ -68,12 +100,35 @@ int HomeLocationUtil::getDetails(double LLA[3], double Be[3])
     if (longitude < -180 || longitude > 180) {
         return -5; // range checking
     }
-    QDateTime dt = QDateTime::currentDateTime().toUTC();
+    QDate date = QDateTime::currentDateTime().toUTC().date();
+
+    MagFieldKey key;
+    key.latitude  = qRound64(latitude * 1e7);
+    key.longitude = qRound64(longitude * 1e7);
+    key.altitude  = qRound64(altitude * 100);
+    key.day = date.toJulianDay();
+
+    QMutexLocker locker(&magFieldMutex);
+    MagField *field = magFieldCache.object(key);
+    if (field) {
+        Be[0] = field->Be[0];
+        Be[1] = field->Be[1];
+        Be[2] = field->Be[2];
+        return 0;
+    }
 
     // Fetch world magnetic model
-    int result   = WorldMagModel().GetMagVector(LLA, dt.date().month(), dt.date().day(), dt.date().year(), Be);
+    int result = WorldMagModel().GetMagVector(LLA, date.month(), date.day(), date.year(), Be);
     Q_ASSERT(result == 0);
 
+    if (result == 0) {
+        field = new MagField;
+        field->Be[0] = Be[0];
+        field->Be[1] = Be[1];
+        field->Be[2] = Be[2];
+        magFieldCache.insert(key, field);
+    }
+
     return result;
 }
 }
@@ -26,10 +26,36 @@
 
 #include <QDebug>
 #include <QtGlobal>
+#include <QtEndian>
 #include <QDataStream>
+#include <QtConcurrent/QtConcurrentRun>
 
 #define TIMESTAMP_SIZE_BYTES 4
 
+// Indexed log format (.oplx)
+//
+//   header  : magic "OPLX", version (u32)
+//   blocks  : raw size (u32), stored size (u32), flags (u8), records (same layout as .opl)
+//   index   : block table and object to blocks table (QDataStream, little endian)
+//   footer  : index offset (u64), block count (u32), magic "XLPO"
+//
+// Blocks only hold whole records so that each one can be decoded on its own.
+#define INDEXED_LOG_SUFFIX        ".oplx"
+#define INDEXED_LOG_MAGIC         "OPLX"
+#define INDEXED_LOG_FOOTER_MAGIC  "XLPO"
+#define INDEXED_LOG_VERSION       1
+#define INDEXED_LOG_HEADER_SIZE   8
+#define INDEXED_LOG_FOOTER_SIZE   16
+#define INDEXED_LOG_BLOCK_SIZE    (64 * 1024)
+#define BLOCK_HEADER_SIZE         9
+#define BLOCK_FLAG_COMPRESSED     0x01
+#define UAVTALK_SYNC_VAL          0x3C
+
+// .opl logging: the write buffer is written to the file when it holds this
+// much, or at the latest after the flush interval
+#define WRITE_BUFFER_SIZE         (256 * 1024)
+#define WRITE_FLUSH_INTERVAL      500
+
 LogFile::LogFile(QObject *parent) : QIODevice(parent),
     m_timer(this),
     m_previousTimeStamp(0),
@@ -42,9 +68,27 @@ LogFile::LogFile(QObject *parent) : QIODevice(parent),
     m_providedTimeStamp(0),
     m_beginTimeStamp(0),
     m_endTimeStamp(0),
-    m_timerTick(0)
+    m_timerTick(0),
+    m_indexed(false),
+    m_compression(true),
+    m_rawSize(0),
+    m_writeBlockFirstTimeStamp(0),
+    m_writeBlockLastTimeStamp(0),
+    m_readBlockPos(0),
+    m_readBlockIndex(-1),
+    m_map(NULL),
+    m_mapSize(0),
+    m_mapPos(0),
+    m_spanIndex(0),
+    m_spanPos(0),
+    m_spanBytes(0),
+    m_indexWatcher(this),
+    m_flushTimer(this)
 {
     connect(&m_timer, &QTimer::timeout, this, &LogFile::timerFired);
+    connect(&m_indexWatcher, &QFutureWatcher<bool>::finished, this, &LogFile::indexBuilt);
+    m_flushTimer.setInterval(WRITE_FLUSH_INTERVAL);
+    connect(&m_flushTimer, &QTimer::timeout, this, &LogFile::flushTimerFired);
 }
 
 bool LogFile::isSequential() const
@@ -76,6 +120,46 @@ bool LogFile::open(OpenMode mode)
         return false;
     }
 
+    m_blocks.clear();
+    m_objectBlocks.clear();
+    m_rawSize = 0;
+    m_writeBlock.clear();
+    m_writeBlockObjects.clear();
+    if (m_file.isWritable()) {
+        // new logs use the indexed format when asked for by the file name
+        m_indexed = fileName().endsWith(INDEXED_LOG_SUFFIX, Qt::CaseInsensitive);
+        if (m_indexed) {
+            QDataStream stream(&m_file);
+            stream.setByteOrder(QDataStream::LittleEndian);
+            stream.writeRawData(INDEXED_LOG_MAGIC, 4);
+            stream << (quint32)INDEXED_LOG_VERSION;
+        } else {
+            // both buffers keep their capacity, see startFlush()
+            m_writeBuffer.reserve(WRITE_BUFFER_SIZE + 4096);
+            m_flushBuffer.reserve(WRITE_BUFFER_SIZE + 4096);
+            m_writeBuffer.resize(0);
+            m_flushBuffer.resize(0);
+            m_flushTimer.start();
+        }
+    } else {
+        // existing logs are recognized by their content
+        m_indexed = (m_file.peek(4) == QByteArray(INDEXED_LOG_MAGIC));
+        if (m_indexed && !readIndex() && !recoverIndex()) {
+            qWarning() << "LogFile - unable to read the index of" << m_file.fileName();
+            m_file.close();
+            return false;
+        }
+        if (!m_indexed && m_file.size() > 0) {
+            // replay from the mapped file, falls back to reading the file if it can't be mapped
+            m_mapSize = m_file.size();
+            m_mapPos  = 0;
+            m_map     = m_file.map(0, m_mapSize);
+            if (!m_map) {
+                qDebug() << "LogFile - unable to map" << m_file.fileName() << m_file.errorString();
+            }
+        }
+    }
+
     // TODO: Write a header at the beginng describing objects so that in future
     // they can be read back if ID's change
 
@@ -91,6 +175,22 @@ void LogFile::close()
 {
     qDebug() << "LogFile - close" << fileName();
     emit aboutToClose();
+    if (m_indexed && m_file.isOpen() && m_file.isWritable()) {
+        writeBlock();
+        writeIndex();
+    }
+    m_flushTimer.stop();
+    {
+        QMutexLocker locker(&m_writeMutex);
+        startFlush();
+        m_flushFuture.waitForFinished();
+    }
+    waitForIndex();
+    clearDataBuffer();
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = NULL;
+    }
     m_file.close();
     QIODevice::close();
 }
@@ -105,25 +205,94 @@ qint64 LogFile::writeData(const char *data, qint64 dataSize)
     // This is used when saving logs from on-board logging
     quint32 timeStamp = m_useProvidedTimeStamp ? m_providedTimeStamp : m_myTime.elapsed();
 
-    m_file.write((char *)&timeStamp, sizeof(timeStamp));
-    m_file.write((char *)&dataSize, sizeof(dataSize));
+    if (m_indexed) {
+        appendRecord(timeStamp, data, dataSize);
+        emit bytesWritten(dataSize);
+        return dataSize;
+    }
 
-    qint64 written = m_file.write(data, dataSize);
+    {
+        QMutexLocker locker(&m_writeMutex);
+        m_writeBuffer.append((const char *)&timeStamp, sizeof(timeStamp));
+        m_writeBuffer.append((const char *)&dataSize, sizeof(dataSize));
+        m_writeBuffer.append(data, dataSize);
+        if (m_writeBuffer.size() >= WRITE_BUFFER_SIZE) {
+            startFlush();
+        }
+    }
+    emit bytesWritten(dataSize);
 
-    // flush (needed to avoid UAVTalk device full errors)
-    m_file.flush();
+    return dataSize;
+}
+
+void LogFile::flushTimerFired()
+{
+    QMutexLocker locker(&m_writeMutex);
 
-    if (written != -1) {
-        emit bytesWritten(written);
+    // don't wait for a write still in flight, the next tick will do
+    if (m_flushFuture.isFinished()) {
+        startFlush();
     }
+}
 
-    return dataSize;
+/**
+ * Hand the write buffer over to the background write (.opl format)
+ * Must be called with m_writeMutex held.
+ */
+void LogFile::startFlush()
+{
+    if (m_writeBuffer.isEmpty()) {
+        return;
+    }
+    // one write at a time keeps the records in order
+    m_flushFuture.waitForFinished();
+    if (!m_file.isOpen()) {
+        return;
+    }
+    qSwap(m_writeBuffer, m_flushBuffer);
+    m_writeBuffer.resize(0);
+    m_flushFuture = QtConcurrent::run(this, &LogFile::flushBuffer);
+}
+
+bool LogFile::flushBuffer()
+{
+    qint64 written = m_file.write(m_flushBuffer);
+    bool ok = (written == m_flushBuffer.size()) && m_file.flush();
+
+    // Checkpoint: the records written so far survive a crash, at worst the last
+    // record is cut short and the replay stops before it (see indexLog()).
+    if (!ok) {
+        qWarning() << "LogFile - failed to write" << m_file.fileName() << m_file.errorString();
+    }
+    return ok;
 }
 
 qint64 LogFile::readData(char *data, qint64 maxlen)
 {
     QMutexLocker locker(&m_mutex);
 
+    if (m_map) {
+        qint64 len = 0;
+        while (len < maxlen && m_spanIndex < m_spans.size()) {
+            const LogSpan &span = m_spans.at(m_spanIndex);
+            qint64 size = qMin(maxlen - len, span.size - m_spanPos);
+            memcpy(data + len, m_map + span.offset + m_spanPos, size);
+            len += size;
+            m_spanPos += size;
+            if (m_spanPos == span.size) {
+                m_spanIndex++;
+                m_spanPos = 0;
+            }
+        }
+        if (m_spanIndex == m_spans.size()) {
+            // keep the capacity, the queue is refilled at every timer tick
+            m_spans.resize(0);
+            m_spanIndex = 0;
+        }
+        m_spanBytes -= len;
+        return len;
+    }
+
     qint64 len = qMin(maxlen, (qint64)m_dataBuffer.size());
 
     if (len) {
@@ -138,7 +307,7 @@ qint64 LogFile::bytesAvailable() const
 {
     QMutexLocker locker(&m_mutex);
 
-    qint64 len = m_dataBuffer.size();
+    qint64 len = m_map ? m_spanBytes : m_dataBuffer.size();
 
     return len;
 }
@@ -156,7 +325,7 @@ void LogFile::timerFired()
     }
     m_timerTick++;
 
-    if (m_file.bytesAvailable() > TIMESTAMP_SIZE_BYTES) {
+    if (logBytesAvailable() > TIMESTAMP_SIZE_BYTES) {
         int time;
         time = m_myTime.elapsed();
 
@@ -180,12 +349,12 @@ void LogFile::timerFired()
 
             // read data size
             qint64 dataSize;
-            if (m_file.bytesAvailable() < (qint64)sizeof(dataSize)) {
+            if (logBytesAvailable() < (qint64)sizeof(dataSize)) {
                 qDebug() << "LogFile replay - end of log file reached";
                 resetReplay();
                 return;
             }
-            m_file.read((char *)&dataSize, sizeof(dataSize));
+            logRead((char *)&dataSize, sizeof(dataSize));
 
             // check size consistency
             if (dataSize < 1 || dataSize > (1024 * 1024)) {
@@ -195,17 +364,27 @@ void LogFile::timerFired()
             }
 
             // read data
-            if (m_file.bytesAvailable() < dataSize) {
+            if (logBytesAvailable() < dataSize) {
                 qDebug() << "LogFile replay - end of log file reached";
                 resetReplay();
                 return;
             }
-            QByteArray data = m_file.read(dataSize);
-
             // make data available
-            m_mutex.lock();
-            m_dataBuffer.append(data);
-            m_mutex.unlock();
+            if (m_map) {
+                LogSpan span = { m_mapPos, dataSize };
+                m_mapPos += dataSize;
+                m_mutex.lock();
+                m_spans.append(span);
+                m_spanBytes += dataSize;
+                m_mutex.unlock();
+            } else {
+                QByteArray data(dataSize, 0);
+                logRead(data.data(), dataSize);
+
+                m_mutex.lock();
+                m_dataBuffer.append(data);
+                m_mutex.unlock();
+            }
 
             emit readyRead();
 
@@ -214,13 +393,13 @@ void LogFile::timerFired()
                 emit playbackPositionChanged(m_nextTimeStamp);
             }
             // read next timestamp
-            if (m_file.bytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
+            if (logBytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
                 qDebug() << "LogFile replay - end of log file reached";
                 resetReplay();
                 return;
             }
             m_previousTimeStamp = m_nextTimeStamp;
-            m_file.read((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
+            logRead((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
 
             // some validity checks
             if ((m_nextTimeStamp < m_previousTimeStamp) // logfile goes back in time
@@ -274,21 +453,20 @@ bool LogFile::startReplay()
     m_lastPlayed        = 0;
     m_previousTimeStamp = 0;
     m_nextTimeStamp     = 0;
-    m_mutex.lock();
-    m_dataBuffer.clear();
-    m_mutex.unlock();
+    clearDataBuffer();
 
     // read next timestamp
-    if (m_file.bytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
+    if (logBytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
         qWarning() << "LogFile - invalid log file!";
         return false;
     }
-    m_file.read((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
+    logRead((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
 
     m_timer.setInterval(10);
     m_timer.start();
     m_replayState = PLAYING;
 
+    emit playbackPositionChanged((quint32)m_lastPlayed);
     emit replayStarted();
     return true;
 }
@@ -358,30 +536,7 @@ bool LogFile::resumeReplay(quint32 desiredPosition)
     }
     qDebug() << "LogFile - resumeReplay";
 
-    // Clear the playout buffer:
-    m_mutex.lock();
-    m_dataBuffer.clear();
-    m_mutex.unlock();
-
-    m_file.seek(0);
-
-    /* Skip through the logfile until we reach the desired position.
-       Looking for the next log timestamp after the desired position
-       has the advantage that it skips over parts of the log
-       where data might be missing.
-     */
-    for (int i = 0; i < m_timeStamps.size(); i++) {
-        if (m_timeStamps.at(i) >= desiredPosition) {
-            int bytesToSkip = m_timeStampPositions.at(i);
-            bool seek_ok    = m_file.seek(bytesToSkip);
-            if (!seek_ok) {
-                qWarning() << "LogFile resumeReplay - an error occurred while seeking through the logfile.";
-            }
-            m_lastPlayed = m_timeStamps.at(i);
-            break;
-        }
-    }
-    m_file.read((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
+    seekTimeStamp(desiredPosition);
 
     // Real-time timestamps don't not need to match the log timestamps.
     // However the delta between real-time variables "m_timeOffset" and "m_myTime" is important.
@@ -396,10 +551,159 @@ bool LogFile::resumeReplay(quint32 desiredPosition)
     m_timer.start();
 
     // Notify UI that playback has resumed
+    emit playbackPositionChanged((quint32)m_lastPlayed);
     emit replayStarted();
     return true;
 }
 
+/**
+ * SLOT: seekReplay()
+ *
+ * Moves the paused replay to the given position, nothing is replayed.
+ * Used with replayUntil() to scrub through the log.
+ *
+ */
+bool LogFile::seekReplay(quint32 desiredPosition)
+{
+    if (!m_file.isOpen() || m_timer.isActive()) {
+        return false;
+    }
+    seekTimeStamp(desiredPosition);
+    m_replayState = PAUSED;
+    emit playbackPositionChanged(desiredPosition);
+    return true;
+}
+
+/**
+ * SLOT: replayUntil()
+ *
+ * Replays the records before the given position at once, without pacing,
+ * the replay stays paused at that position.
+ *
+ */
+bool LogFile::replayUntil(quint32 position)
+{
+    if (!m_file.isOpen() || m_timer.isActive()) {
+        return false;
+    }
+    bool ok = true;
+    while (ok && m_nextTimeStamp < position) {
+        ok = replayRecord();
+    }
+    m_lastPlayed  = position;
+    m_replayState = PAUSED;
+    emit playbackPositionChanged(position);
+    return ok;
+}
+
+/**
+ * FUNCTION: seekTimeStamp()
+ *
+ * Moves the read position to the first record at or after the given position
+ * and reads its time stamp.
+ *
+ */
+void LogFile::seekTimeStamp(quint32 desiredPosition)
+{
+    // Clear the playout buffer:
+    clearDataBuffer();
+
+    // The index is needed to seek
+    waitForIndex();
+
+    rewindLog();
+
+    if (m_indexed) {
+        // Start from the last block beginning before the desired position
+        // and skip the records of that block that are before the desired position.
+        int block = 0;
+        while (block + 1 < m_blocks.size() && m_blocks.at(block + 1).firstTimeStamp <= desiredPosition) {
+            block++;
+        }
+        if (loadBlock(block)) {
+            m_lastPlayed = m_blocks.at(block).firstTimeStamp;
+            while (true) {
+                if (m_readBlockPos >= m_readBlock.size() && !loadBlock(m_readBlockIndex + 1)) {
+                    break;
+                }
+                quint32 timeStamp;
+                qint64 dataSize;
+                memcpy(&timeStamp, m_readBlock.constData() + m_readBlockPos, sizeof(timeStamp));
+                if (timeStamp >= desiredPosition) {
+                    m_lastPlayed = timeStamp;
+                    break;
+                }
+                memcpy(&dataSize, m_readBlock.constData() + m_readBlockPos + sizeof(timeStamp), sizeof(dataSize));
+                m_readBlockPos += sizeof(timeStamp) + sizeof(dataSize) + dataSize;
+            }
+        }
+    } else {
+        /* Skip through the logfile until we reach the desired position.
+           Looking for the next log timestamp after the desired position
+           has the advantage that it skips over parts of the log
+           where data might be missing.
+         */
+        for (int i = 0; i < m_timeStamps.size(); i++) {
+            if (m_timeStamps.at(i) >= desiredPosition) {
+                qint64 bytesToSkip = m_timeStampPositions.at(i);
+                bool seek_ok = seekLog(bytesToSkip);
+                if (!seek_ok) {
+                    qWarning() << "LogFile resumeReplay - an error occurred while seeking through the logfile.";
+                }
+                m_lastPlayed = m_timeStamps.at(i);
+                break;
+            }
+        }
+    }
+    logRead((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
+}
+
+/**
+ * FUNCTION: replayRecord()
+ *
+ * Makes the record at the read position available and reads the time stamp
+ * of the next one. Returns false at the end of the log or on a corrupted record.
+ *
+ */
+bool LogFile::replayRecord()
+{
+    qint64 dataSize;
+
+    if (logBytesAvailable() < (qint64)sizeof(dataSize)) {
+        return false;
+    }
+    logRead((char *)&dataSize, sizeof(dataSize));
+    if (dataSize < 1 || dataSize > (1024 * 1024) || logBytesAvailable() < dataSize) {
+        qWarning() << "LogFile replayRecord - corrupted log file! Unlikely packet size:" << dataSize;
+        return false;
+    }
+
+    if (m_map) {
+        LogSpan span = { m_mapPos, dataSize };
+        m_mapPos += dataSize;
+        m_mutex.lock();
+        m_spans.append(span);
+        m_spanBytes += dataSize;
+        m_mutex.unlock();
+    } else {
+        QByteArray data(dataSize, 0);
+        logRead(data.data(), dataSize);
+
+        m_mutex.lock();
+        m_dataBuffer.append(data);
+        m_mutex.unlock();
+    }
+
+    emit readyRead();
+
+    if (logBytesAvailable() < (qint64)sizeof(m_nextTimeStamp)) {
+        return false;
+    }
+    m_previousTimeStamp = m_nextTimeStamp;
+    logRead((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
+    return m_nextTimeStamp >= m_previousTimeStamp;
+}
+
 /**
  * SLOT: pauseReplay()
  *
@@ -414,6 +718,9 @@ bool LogFile::pauseReplay()
     qDebug() << "LogFile - pauseReplay";
     m_timer.stop();
     m_replayState = PAUSED;
+
+    emit playbackPositionChanged((quint32)m_lastPlayed);
+    emit replayPaused();
     return true;
 }
 
@@ -432,11 +739,14 @@ bool LogFile::pauseReplayAndResetPosition()
     m_timer.stop();
     m_replayState       = STOPPED;
 
+    waitForIndex();
     m_timeOffset        = 0;
-    m_lastPlayed        = m_timeStamps.at(0);
+    m_lastPlayed        = m_timeStamps.isEmpty() ? 0 : m_timeStamps.at(0);
     m_previousTimeStamp = 0;
     m_nextTimeStamp     = 0;
 
+    emit playbackPositionChanged((quint32)m_lastPlayed);
+    emit replayPaused();
     return true;
 }
 
@@ -451,6 +761,71 @@ ReplayState LogFile::getReplayState()
     return m_replayState;
 }
 
+/**
+ * FUNCTION: replayAll()
+ *
+ * Replays the whole log as fast as possible, without the replay timer.
+ * The readyRead() signal is emitted for every record and the receiver is
+ * expected to read the data right away (direct connection). The time stamp
+ * of the record being replayed is given by replayTimeStamp().
+ *
+ * Returns true when the end of the log has been reached without error.
+ *
+ */
+bool LogFile::replayAll()
+{
+    if (!m_file.isOpen() || m_timer.isActive()) {
+        return false;
+    }
+    qDebug() << "LogFile - replayAll";
+
+    clearDataBuffer();
+    rewindLog();
+    m_replayState = PLAYING;
+
+    bool ok = true;
+    m_previousTimeStamp = 0;
+    while (logBytesAvailable() >= (qint64)(sizeof(m_nextTimeStamp) + sizeof(qint64))) {
+        logRead((char *)&m_nextTimeStamp, sizeof(m_nextTimeStamp));
+        if (m_nextTimeStamp < m_previousTimeStamp) {
+            qWarning() << "LogFile replayAll - corrupted log file! Unlikely timestamp:" << m_nextTimeStamp << "after" << m_previousTimeStamp;
+            ok = false;
+            break;
+        }
+        m_previousTimeStamp = m_nextTimeStamp;
+
+        qint64 dataSize;
+        logRead((char *)&dataSize, sizeof(dataSize));
+        if (dataSize < 1 || dataSize > (1024 * 1024) || logBytesAvailable() < dataSize) {
+            qWarning() << "LogFile replayAll - corrupted log file! Unlikely packet size:" << dataSize;
+            ok = false;
+            break;
+        }
+
+        if (m_map) {
+            LogSpan span = { m_mapPos, dataSize };
+            m_mapPos += dataSize;
+            m_mutex.lock();
+            m_spans.append(span);
+            m_spanBytes += dataSize;
+            m_mutex.unlock();
+        } else {
+            QByteArray data(dataSize, 0);
+            logRead(data.data(), dataSize);
+
+            m_mutex.lock();
+            m_dataBuffer.append(data);
+            m_mutex.unlock();
+        }
+
+        emit readyRead();
+    }
+
+    m_replayState = STOPPED;
+    emit replayCompleted();
+    return ok;
+}
+
 /**
  * FUNCTION: buildIndex()
  *
@@ -463,20 +838,76 @@ ReplayState LogFile::getReplayState()
  */
 bool LogFile::buildIndex()
 {
-    quint32 timeStamp;
-    qint64 totalSize;
-    qint64 readPointer = 0;
-    quint64 index = 0;
-    int bytesRead = 0;
-
     qDebug() << "LogFile - buildIndex";
 
+    // Wait for a previous background indexing
+    waitForIndex();
+
     // Ensure empty vectors:
     m_timeStampPositions.clear();
     m_timeStamps.clear();
 
+    if (m_indexed) {
+        // The index was read when opening the log, just use the block start times
+        if (m_blocks.isEmpty()) {
+            qWarning() << "LogFile buildIndex - empty log file";
+            return false;
+        }
+        for (int i = 0; i < m_blocks.size(); i++) {
+            m_timeStamps.append(m_blocks.at(i).firstTimeStamp);
+            m_timeStampPositions.append(i);
+        }
+        m_beginTimeStamp = m_blocks.first().firstTimeStamp;
+        m_endTimeStamp   = m_blocks.last().lastTimeStamp;
+
+        emit timesChanged(m_beginTimeStamp, m_endTimeStamp);
+
+        rewindLog();
+        return true;
+    }
+
+    if (m_map) {
+        // Replay can start as soon as the first time stamp is known, the index
+        // is only needed for seeking and is built in the background.
+        if (m_mapSize < TIMESTAMP_SIZE_BYTES) {
+            qWarning() << "LogFile buildIndex - empty log file";
+            return false;
+        }
+        memcpy(&m_beginTimeStamp, m_map, TIMESTAMP_SIZE_BYTES);
+        m_endTimeStamp = m_beginTimeStamp;
+        m_indexWatcher.setFuture(QtConcurrent::run(this, &LogFile::indexLog, (const char *)m_map, m_mapSize));
+
+        rewindLog();
+        return true;
+    }
+
     QByteArray arr = m_file.readAll();
-    totalSize = arr.size();
+    bool ok = indexLog(arr.constData(), arr.size());
+
+    // reset the read pointer to the start of the file
+    m_file.seek(0);
+
+    if (ok) {
+        emit timesChanged(m_beginTimeStamp, m_endTimeStamp);
+    }
+    return ok;
+}
+
+/**
+ * FUNCTION: indexLog()
+ *
+ * Walks through the log records for buildIndex(),
+ * this can run in a background thread when the log is mapped.
+ *
+ */
+bool LogFile::indexLog(const char *data, qint64 totalSize)
+{
+    quint32 timeStamp;
+    qint64 readPointer = 0;
+    quint64 index = 0;
+    int bytesRead = 0;
+
+    QByteArray arr = QByteArray::fromRawData(data, totalSize);
     QDataStream dataStream(&arr, QIODevice::ReadOnly);
 
     // set the first timestamp
@@ -552,10 +983,389 @@ bool LogFile::buildIndex()
         }
     }
 
+    return true;
+}
+
+/**
+ * Background indexing has completed
+ */
+void LogFile::indexBuilt()
+{
+    if (!m_indexWatcher.result()) {
+        qWarning() << "LogFile - indexing of" << m_file.fileName() << "failed, seeking is not available";
+        return;
+    }
     emit timesChanged(m_beginTimeStamp, m_endTimeStamp);
+}
 
-    // reset the read pointer to the start of the file
-    m_file.seek(0);
+void LogFile::waitForIndex()
+{
+    if (m_indexWatcher.isRunning()) {
+        m_indexWatcher.waitForFinished();
+    }
+}
+
+void LogFile::clearDataBuffer()
+{
+    QMutexLocker locker(&m_mutex);
 
+    m_dataBuffer.clear();
+    m_spans.clear();
+    m_spanIndex = 0;
+    m_spanPos   = 0;
+    m_spanBytes = 0;
+}
+
+/**
+ * Move the replay position in a .opl log
+ */
+bool LogFile::seekLog(qint64 pos)
+{
+    if (!m_map) {
+        return m_file.seek(pos);
+    }
+    if (pos < 0 || pos > m_mapSize) {
+        return false;
+    }
+    m_mapPos = pos;
     return true;
 }
+
+
+/**
+ * Number of log bytes left to replay
+ */
+qint64 LogFile::logBytesAvailable()
+{
+    if (m_map) {
+        return m_mapSize - m_mapPos;
+    }
+    if (!m_indexed) {
+        return m_file.bytesAvailable();
+    }
+    qint64 consumed = (m_readBlockIndex < 0) ? 0 : (m_blocks.at(m_readBlockIndex).rawOffset + m_readBlockPos);
+    return m_rawSize - consumed;
+}
+
+/**
+ * Read log bytes to replay, in the indexed format the blocks are loaded as needed
+ */
+qint64 LogFile::logRead(char *data, qint64 maxlen)
+{
+    if (m_map) {
+        qint64 len = qMin(maxlen, m_mapSize - m_mapPos);
+        memcpy(data, m_map + m_mapPos, len);
+        m_mapPos += len;
+        return len;
+    }
+    if (!m_indexed) {
+        return m_file.read(data, maxlen);
+    }
+    qint64 total = 0;
+    while (total < maxlen) {
+        if (m_readBlockPos >= m_readBlock.size() && !loadBlock(m_readBlockIndex + 1)) {
+            break;
+        }
+        qint64 len = qMin(maxlen - total, (qint64)(m_readBlock.size() - m_readBlockPos));
+        memcpy(data + total, m_readBlock.constData() + m_readBlockPos, len);
+        m_readBlockPos += len;
+        total += len;
+    }
+    return total;
+}
+
+/**
+ * Go back to the start of the log
+ */
+bool LogFile::rewindLog()
+{
+    if (!m_indexed) {
+        return seekLog(0);
+    }
+    m_readBlock.clear();
+    m_readBlockPos   = 0;
+    m_readBlockIndex = -1;
+    return true;
+}
+
+/**
+ * Add a record to the block being written (indexed format)
+ */
+void LogFile::appendRecord(quint32 timeStamp, const char *data, qint64 dataSize)
+{
+    if (m_writeBlock.isEmpty()) {
+        m_writeBlockFirstTimeStamp = timeStamp;
+    }
+    m_writeBlockLastTimeStamp = timeStamp;
+
+    m_writeBlock.append((const char *)&timeStamp, sizeof(timeStamp));
+    m_writeBlock.append((const char *)&dataSize, sizeof(dataSize));
+    m_writeBlock.append(data, dataSize);
+
+    // remember which objects are in the block (UAVTalk header: sync, type, size, object ID)
+    if (dataSize >= 8 && (quint8)data[0] == UAVTALK_SYNC_VAL) {
+        m_writeBlockObjects.insert(qFromLittleEndian<quint32>((const uchar *)&data[4]));
+    }
+
+    if (m_writeBlock.size() >= INDEXED_LOG_BLOCK_SIZE) {
+        writeBlock();
+    }
+}
+
+/**
+ * Write the pending block to the file (indexed format)
+ */
+bool LogFile::writeBlock()
+{
+    if (m_writeBlock.isEmpty()) {
+        return true;
+    }
+
+    LogBlock block;
+    block.offset    = m_file.pos();
+    block.rawOffset = m_rawSize;
+    block.rawSize   = m_writeBlock.size();
+    block.flags     = 0;
+    block.firstTimeStamp = m_writeBlockFirstTimeStamp;
+    block.lastTimeStamp  = m_writeBlockLastTimeStamp;
+
+    QByteArray payload = m_writeBlock;
+    if (m_compression) {
+        // qCompress prepends the uncompressed size, it is already in the block header
+        QByteArray compressed = qCompress(m_writeBlock).mid(4);
+        if (compressed.size() < m_writeBlock.size()) {
+            payload     = compressed;
+            block.flags = BLOCK_FLAG_COMPRESSED;
+        }
+    }
+    block.storedSize = payload.size();
+
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << block.rawSize << block.storedSize << block.flags;
+    if (stream.writeRawData(payload.constData(), payload.size()) != payload.size()) {
+        qWarning() << "LogFile - failed to write block" << m_blocks.size();
+        return false;
+    }
+    // a crash will at worst lose the pending block, see recoverIndex()
+    m_file.flush();
+
+    foreach(quint32 objId, m_writeBlockObjects) {
+        m_objectBlocks[objId].append(m_blocks.size());
+    }
+    m_blocks.append(block);
+    m_rawSize += block.rawSize;
+
+    m_writeBlock.clear();
+    m_writeBlockObjects.clear();
+    return true;
+}
+
+/**
+ * Write the index and the footer at the end of the file (indexed format)
+ */
+bool LogFile::writeIndex()
+{
+    quint64 indexOffset = m_file.pos();
+
+    QDataStream stream(&m_file);
+
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    foreach(const LogBlock &block, m_blocks) {
+        stream << (qint64)block.offset << block.rawSize << block.storedSize << block.flags
+               << block.firstTimeStamp << block.lastTimeStamp;
+    }
+    stream << (quint32)m_objectBlocks.size();
+    QHash<quint32, QVector<quint32> >::const_iterator i;
+    for (i = m_objectBlocks.constBegin(); i != m_objectBlocks.constEnd(); ++i) {
+        stream << i.key() << (quint32)i.value().size();
+        foreach(quint32 blockIndex, i.value()) {
+            stream << blockIndex;
+        }
+    }
+
+    stream << indexOffset << (quint32)m_blocks.size();
+    stream.writeRawData(INDEXED_LOG_FOOTER_MAGIC, 4);
+
+    return stream.status() == QDataStream::Ok;
+}
+
+/**
+ * Read the index from the footer of the file (indexed format)
+ */
+bool LogFile::readIndex()
+{
+    qint64 fileSize = m_file.size();
+
+    if (fileSize < INDEXED_LOG_HEADER_SIZE + INDEXED_LOG_FOOTER_SIZE) {
+        return false;
+    }
+
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint64 indexOffset;
+    quint32 blockCount;
+    char magic[4];
+    m_file.seek(fileSize - INDEXED_LOG_FOOTER_SIZE);
+    stream >> indexOffset >> blockCount;
+    if (stream.readRawData(magic, 4) != 4 || memcmp(magic, INDEXED_LOG_FOOTER_MAGIC, 4) != 0) {
+        qWarning() << "LogFile - missing index, the log was not closed properly";
+        return false;
+    }
+    if (indexOffset < INDEXED_LOG_HEADER_SIZE || indexOffset >= (quint64)fileSize) {
+        return false;
+    }
+
+    m_file.seek(indexOffset);
+    m_blocks.clear();
+    m_objectBlocks.clear();
+    m_rawSize = 0;
+    for (quint32 n = 0; n < blockCount; n++) {
+        LogBlock block;
+        stream >> block.offset >> block.rawSize >> block.storedSize >> block.flags
+        >> block.firstTimeStamp >> block.lastTimeStamp;
+        block.rawOffset = m_rawSize;
+        m_rawSize += block.rawSize;
+        m_blocks.append(block);
+    }
+    quint32 objectCount;
+    stream >> objectCount;
+    for (quint32 n = 0; n < objectCount && stream.status() == QDataStream::Ok; n++) {
+        quint32 objId;
+        quint32 count;
+        stream >> objId >> count;
+        QVector<quint32> &blocks = m_objectBlocks[objId];
+        for (quint32 k = 0; k < count && stream.status() == QDataStream::Ok; k++) {
+            quint32 blockIndex;
+            stream >> blockIndex;
+            blocks.append(blockIndex);
+        }
+    }
+    m_file.seek(INDEXED_LOG_HEADER_SIZE);
+
+    return stream.status() == QDataStream::Ok;
+}
+
+/**
+ * Rebuild the block table by walking the block headers (indexed format without footer).
+ * The object to blocks table is rebuilt while walking the records.
+ */
+bool LogFile::recoverIndex()
+{
+    qDebug() << "LogFile - recovering index of" << m_file.fileName();
+
+    m_blocks.clear();
+    m_objectBlocks.clear();
+    m_rawSize = 0;
+
+    qint64 fileSize = m_file.size();
+    qint64 offset   = INDEXED_LOG_HEADER_SIZE;
+    while (offset + BLOCK_HEADER_SIZE <= fileSize) {
+        LogBlock block;
+        block.offset    = offset;
+        block.rawOffset = m_rawSize;
+        if (!m_file.seek(offset)) {
+            break;
+        }
+        QDataStream stream(&m_file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream >> block.rawSize >> block.storedSize >> block.flags;
+        if (stream.status() != QDataStream::Ok || offset + BLOCK_HEADER_SIZE + block.storedSize > fileSize) {
+            break;
+        }
+        m_blocks.append(block);
+        if (!loadBlock(m_blocks.size() - 1)) {
+            m_blocks.removeLast();
+            break;
+        }
+        // walk the records for the time stamps and object IDs
+        bool first = true;
+        int pos    = 0;
+        while (pos + TIMESTAMP_SIZE_BYTES + (int)sizeof(qint64) <= m_readBlock.size()) {
+            quint32 timeStamp;
+            qint64 dataSize;
+            memcpy(&timeStamp, m_readBlock.constData() + pos, sizeof(timeStamp));
+            memcpy(&dataSize, m_readBlock.constData() + pos + sizeof(timeStamp), sizeof(dataSize));
+            const char *data = m_readBlock.constData() + pos + sizeof(timeStamp) + sizeof(dataSize);
+            if (first) {
+                m_blocks.last().firstTimeStamp = timeStamp;
+                first = false;
+            }
+            m_blocks.last().lastTimeStamp = timeStamp;
+            if (dataSize >= 8 && (quint8)data[0] == UAVTALK_SYNC_VAL) {
+                QVector<quint32> &blocks = m_objectBlocks[qFromLittleEndian<quint32>((const uchar *)&data[4])];
+                if (blocks.isEmpty() || blocks.last() != (quint32)(m_blocks.size() - 1)) {
+                    blocks.append(m_blocks.size() - 1);
+                }
+            }
+            pos += sizeof(timeStamp) + sizeof(dataSize) + dataSize;
+        }
+        m_rawSize += block.rawSize;
+        offset    += BLOCK_HEADER_SIZE + block.storedSize;
+    }
+    rewindLog();
+    m_file.seek(INDEXED_LOG_HEADER_SIZE);
+
+    return !m_blocks.isEmpty();
+}
+
+/**
+ * Load and decode a block for replay (indexed format)
+ */
+bool LogFile::loadBlock(int index)
+{
+    if (index < 0 || index >= m_blocks.size()) {
+        return false;
+    }
+    const LogBlock &block = m_blocks.at(index);
+    if (!m_file.seek(block.offset + BLOCK_HEADER_SIZE)) {
+        return false;
+    }
+    QByteArray payload = m_file.read(block.storedSize);
+    if (payload.size() != (int)block.storedSize) {
+        qWarning() << "LogFile - truncated block" << index;
+        return false;
+    }
+    if (block.flags & BLOCK_FLAG_COMPRESSED) {
+        // restore the size prefix expected by qUncompress
+        QByteArray size(4, 0);
+        qToBigEndian<quint32>(block.rawSize, (uchar *)size.data());
+        m_readBlock = qUncompress(size + payload);
+    } else {
+        m_readBlock = payload;
+    }
+    if (m_readBlock.size() != (int)block.rawSize) {
+        qWarning() << "LogFile - corrupted block" << index;
+        m_readBlock.clear();
+        return false;
+    }
+    m_readBlockIndex = index;
+    m_readBlockPos   = 0;
+    return true;
+}
+
+/**
+ * Get the records of a block, for readers that only need some objects (see blocksForObject())
+ * The records have the same layout as in the .opl format.
+ */
+QByteArray LogFile::readBlock(int index)
+{
+    QByteArray records;
+
+    if (!m_indexed)  {
+        return records;
+    }
+    QByteArray current = m_readBlock;
+    int currentIndex   = m_readBlockIndex;
+    int currentPos     = m_readBlockPos;
+    if (loadBlock(index)) {
+        records = m_readBlock;
+    }
+    // restore the replay position
+    m_readBlock      = current;
+    m_readBlockIndex = currentIndex;
+    m_readBlockPos   = currentPos;
+    return records;
+}
@@ -34,6 +34,9 @@
 #include <QDebug>
 #include <QFile>
 #include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QFutureWatcher>
 
 typedef enum { PLAYING, PAUSED, STOPPED } ReplayState;
 
@@ -61,7 +64,8 @@ public:
     qint64 bytesAvailable() const;
     qint64 bytesToWrite() const
     {
-        return m_file.bytesToWrite();
+        // .opl records are taken by the write buffer, see writeData()
+        return m_indexed ? m_file.bytesToWrite() : 0;
     };
 
     qint64 writeData(const char *data, qint64 dataSize);
@@ -79,26 +83,61 @@ public:
 
     ReplayState getReplayState();
 
+    // Replay the whole log without pacing, for headless processing
+    Q_INVOKABLE bool replayAll();
+    quint32 replayTimeStamp() const
+    {
+        return m_nextTimeStamp;
+    }
+
+    // Indexed log format (.oplx)
+    bool isIndexed() const
+    {
+        return m_indexed;
+    }
+    void setCompression(bool compression)
+    {
+        m_compression = compression;
+    }
+    int blockCount() const
+    {
+        return m_blocks.size();
+    }
+    QVector<quint32> blocksForObject(quint32 objId) const
+    {
+        return m_objectBlocks.value(objId);
+    }
+    QByteArray readBlock(int index);
+
 public slots:
     void setReplaySpeed(double val)
     {
         m_playbackSpeed = val;
         qDebug() << "Playback speed is now" << m_playbackSpeed;
+        emit replaySpeedChanged(m_playbackSpeed);
     };
     bool startReplay();
     bool stopReplay();
 
     bool resumeReplay(quint32);
+    bool seekReplay(quint32);
+    bool replayUntil(quint32);
     bool pauseReplay();
     bool pauseReplayAndResetPosition();
 
 protected slots:
     void timerFired();
 
+private slots:
+    void indexBuilt();
+    void flushTimerFired();
+
 signals:
     void replayStarted();
     void replayFinished(); // Emitted on error during replay or when logfile disconnected
     void replayCompleted(); // Emitted at the end of normal logfile playback
+    void replayPaused();
+    void replaySpeedChanged(double);
     void playbackPositionChanged(quint32);
     void timesChanged(quint32, quint32);
 
@@ -127,8 +166,80 @@ private:
     QVector<quint32> m_timeStamps;
     QVector<qint64> m_timeStampPositions;
 
+    // Indexed log format: the records are stored in blocks (optionally compressed)
+    // and a footer holds the block table and the object to blocks table.
+    typedef struct {
+        qint64  offset; // block position in the file
+        qint64  rawOffset; // block position in the uncompressed record stream
+        quint32 rawSize;
+        quint32 storedSize;
+        quint8  flags;
+        quint32 firstTimeStamp;
+        quint32 lastTimeStamp;
+    } LogBlock;
+
+    bool m_indexed;
+    bool m_compression;
+    QVector<LogBlock> m_blocks;
+    QHash<quint32, QVector<quint32> > m_objectBlocks;
+    qint64 m_rawSize;
+    // block being written
+    QByteArray m_writeBlock;
+    quint32 m_writeBlockFirstTimeStamp;
+    quint32 m_writeBlockLastTimeStamp;
+    QSet<quint32> m_writeBlockObjects;
+    // block being replayed
+    QByteArray m_readBlock;
+    int m_readBlockPos;
+    int m_readBlockIndex;
+
+    // Replay of .opl logs straight from the mapped file: the played records
+    // are queued as spans of the mapping and readData() copies from there.
+    typedef struct {
+        qint64 offset;
+        qint64 size;
+    } LogSpan;
+
+    uchar *m_map;
+    qint64 m_mapSize;
+    qint64 m_mapPos;
+    QVector<LogSpan> m_spans;
+    int m_spanIndex;
+    qint64 m_spanPos;
+    qint64 m_spanBytes;
+    // the .opl index is built in the background while the replay starts
+    QFutureWatcher<bool> m_indexWatcher;
+
+    // .opl logging: the records are collected in m_writeBuffer, which is
+    // written to the file in the background when it is full or when
+    // m_flushTimer fires. One write is in flight at a time (m_flushBuffer).
+    QByteArray m_writeBuffer;
+    QByteArray m_flushBuffer;
+    QFuture<bool> m_flushFuture;
+    QTimer m_flushTimer;
+    QMutex m_writeMutex;
+
+    void startFlush();
+    bool flushBuffer();
     bool buildIndex();
+    bool indexLog(const char *data, qint64 totalSize);
+    void waitForIndex();
     bool resetReplay();
+    void seekTimeStamp(quint32 desiredPosition);
+    bool replayRecord();
+    void clearDataBuffer();
+    bool seekLog(qint64 pos);
+
+    qint64 logBytesAvailable();
+    qint64 logRead(char *data, qint64 maxlen);
+    bool rewindLog();
+
+    void appendRecord(quint32 timeStamp, const char *data, qint64 dataSize);
+    bool writeBlock();
+    bool writeIndex();
+    bool readIndex();
+    bool recoverIndex();
+    bool loadBlock(int index);
 };
 
 #endif // LOGFILE_H
@@ -0,0 +1,144 @@
+/**
+ ******************************************************************************
+ *
+ * @file       matfilewriter.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Minimal MATLAB level 5 MAT-file writer
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "matfilewriter.h"
+
+#include <QIODevice>
+#include <QDateTime>
+#include <QtEndian>
+#include <string.h>
+
+using namespace Utils;
+
+namespace {
+// MAT-file data types and array classes
+const quint32 MI_INT8   = 1;
+const quint32 MI_INT32  = 5;
+const quint32 MI_UINT32 = 6;
+const quint32 MI_DOUBLE = 9;
+const quint32 MI_MATRIX = 14;
+const quint32 MX_STRUCT_CLASS = 2;
+const quint32 MX_DOUBLE_CLASS = 6;
+
+const int HEADER_TEXT_LENGTH = 116;
+const int MAX_NAME_LENGTH    = 63;
+
+void append32(QByteArray &out, quint32 value)
+{
+    char le[4];
+
+    qToLittleEndian<quint32>(value, (uchar *)le);
+    out.append(le, 4);
+}
+
+// a data element: tag then data, padded to 8 bytes
+void appendElement(QByteArray &out, quint32 type, const QByteArray &data)
+{
+    append32(out, type);
+    append32(out, data.size());
+    out.append(data);
+    out.append(QByteArray((8 - data.size() % 8) % 8, 0));
+}
+
+// array flags, dimensions and name, common to all the arrays
+QByteArray arrayHeader(quint32 arrayClass, int rows, int cols, const QByteArray &name)
+{
+    QByteArray header;
+    QByteArray flags;
+    QByteArray dimensions;
+
+    append32(flags, arrayClass);
+    append32(flags, 0);
+    appendElement(header, MI_UINT32, flags);
+    append32(dimensions, rows);
+    append32(dimensions, cols);
+    appendElement(header, MI_INT32, dimensions);
+    appendElement(header, MI_INT8, name);
+    return header;
+}
+
+QByteArray doubleMatrix(const MatFileWriter::Matrix &matrix)
+{
+    QByteArray array = arrayHeader(MX_DOUBLE_CLASS, matrix.rows, matrix.cols, QByteArray());
+    QByteArray values(matrix.values.size() * 8, 0);
+
+    for (int i = 0; i < matrix.values.size(); i++) {
+        quint64 bits;
+        memcpy(&bits, &matrix.values.at(i), 8);
+        qToLittleEndian<quint64>(bits, (uchar *)values.data() + i * 8);
+    }
+    appendElement(array, MI_DOUBLE, values);
+
+    QByteArray element;
+    appendElement(element, MI_MATRIX, array);
+    return element;
+}
+}
+
+MatFileWriter::MatFileWriter(QIODevice *device) :
+    m_device(device), m_headerWritten(false)
+{}
+
+bool MatFileWriter::writeHeader()
+{
+    if (m_headerWritten) {
+        return true;
+    }
+    QByteArray header = QString("MATLAB 5.0 MAT-file, Platform: LibrePilot GCS, Created on: %1")
+                        .arg(QDateTime::currentDateTime().toString("ddd MMM d hh:mm:ss yyyy")).toLatin1();
+    header = header.leftJustified(HEADER_TEXT_LENGTH, ' ', true);
+    // no subsystem data, version 0x0100 and the endian indicator
+    header.append(QByteArray(8, 0));
+    header.append("\x00\x01" "IM", 4);
+    m_headerWritten = m_device->write(header) == header.size();
+    return m_headerWritten;
+}
+
+bool MatFileWriter::writeStruct(const QString &name, const QList<Matrix> &fields)
+{
+    if (!writeHeader()) {
+        return false;
+    }
+
+    // field names are stored in fixed length, null terminated slots
+    int nameLength = 0;
+    foreach(const Matrix &field, fields) {
+        nameLength = qMax(nameLength, qMin(field.name.toLatin1().size(), MAX_NAME_LENGTH) + 1);
+    }
+    QByteArray names;
+    foreach(const Matrix &field, fields) {
+        names.append(field.name.toLatin1().left(MAX_NAME_LENGTH).leftJustified(nameLength, '\0'));
+    }
+
+    QByteArray array = arrayHeader(MX_STRUCT_CLASS, 1, 1, name.toLatin1().left(MAX_NAME_LENGTH));
+    // the field name length is a small data element: size and type packed in the tag
+    append32(array, (4 << 16) | MI_INT32);
+    append32(array, nameLength);
+    appendElement(array, MI_INT8, names);
+    foreach(const Matrix &field, fields) {
+        array.append(doubleMatrix(field));
+    }
+
+    QByteArray element;
+    appendElement(element, MI_MATRIX, array);
+    return m_device->write(element) == element.size();
+}
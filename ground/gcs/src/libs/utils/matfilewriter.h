@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ *
+ * @file       matfilewriter.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Minimal MATLAB level 5 MAT-file writer
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef MATFILEWRITER_H
+#define MATFILEWRITER_H
+
+#include "utils_global.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+namespace Utils {
+/**
+ * Writes MATLAB level 5 MAT-files (read by load() in MATLAB and Octave) holding
+ * 1x1 structs of double matrices, as OPLogConvert.m used to save them.
+ */
+class QTCREATOR_UTILS_EXPORT MatFileWriter {
+public:
+    // A rows x cols double matrix, values in column major order
+    struct Matrix {
+        QString name;
+        int rows;
+        int cols;
+        QVector<double> values;
+    };
+
+    explicit MatFileWriter(QIODevice *device);
+
+    // the file header is written with the first variable
+    bool writeStruct(const QString &name, const QList<Matrix> &fields);
+
+private:
+    QIODevice *m_device;
+    bool m_headerWritten;
+
+    bool writeHeader();
+};
+}
+
+#endif // MATFILEWRITER_H
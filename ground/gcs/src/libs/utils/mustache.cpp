@@ -16,6 +16,7 @@
 
 #include <QtCore/QDebug>
 #include <QtCore/QFile>
+#include <QtCore/QIODevice>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
 
@@ -234,10 +235,17 @@ QString PartialFileLoader::getPartial(const QString & name)
     return m_cache.value(name);
 }
 
+// output is written to the device in chunks of this size
+static const int DeviceChunkSize = 16384;
+// number of templates whose tags are kept
+static const int MaxTagCaches    = 32;
+
 Renderer::Renderer()
     : m_errorPos(-1)
     , m_defaultTagStartMarker("{{")
     , m_defaultTagEndMarker("}}")
+    , m_deviceOutput(0)
+    , m_device(0)
 {}
 
 QString Renderer::error() const
@@ -255,7 +263,7 @@ QString Renderer::errorPartial() const
     return m_errorPartial;
 }
 
-QString Renderer::render(const QString & _template, Context *context)
+void Renderer::beginRender()
 {
     m_error.clear();
     m_errorPos = -1;
@@ -263,16 +271,75 @@ QString Renderer::render(const QString & _template, Context *context)
 
     m_tagStartMarker = m_defaultTagStartMarker;
     m_tagEndMarker   = m_defaultTagEndMarker;
+}
 
-    return render(_template, 0, _template.length(), context);
+QString Renderer::render(const QString & _template, Context *context)
+{
+    // this can be called from Context::eval() while rendering another template
+    QSharedPointer<TagCache> tags = m_tags;
+    QString output;
+
+    beginRender();
+    m_tags = tagCache(_template);
+    render(_template, 0, _template.length(), context, output);
+    m_tags = tags;
+
+    return output;
 }
 
-QString Renderer::render(const QString & _template, int startPos, int endPos, Context *context)
+bool Renderer::render(const QString & _template, Context *context, QIODevice *device)
 {
+    QSharedPointer<TagCache> tags = m_tags;
+    QString *deviceOutput = m_deviceOutput;
+    QIODevice *previousDevice = m_device;
     QString output;
+
+    beginRender();
+    m_tags = tagCache(_template);
+    m_deviceOutput = &output;
+    m_device = device;
+    render(_template, 0, _template.length(), context, output);
+    bool written = writeOutput(output);
+    m_tags = tags;
+    m_deviceOutput = deviceOutput;
+    m_device = previousDevice;
+
+    return written && m_errorPos == -1;
+}
+
+bool Renderer::writeOutput(QString & output)
+{
+    QByteArray data = output.toUtf8();
+
+    output.clear();
+    return m_device->write(data) == data.size();
+}
+
+QSharedPointer<Renderer::TagCache> Renderer::tagCache(const QString & _template)
+{
+    QSharedPointer<TagCache> tags = m_tagCaches.value(_template);
+
+    if (!tags) {
+        if (m_tagCaches.size() >= MaxTagCaches) {
+            m_tagCaches.clear();
+        }
+        tags = QSharedPointer<TagCache>(new TagCache);
+        m_tagCaches.insert(_template, tags);
+    }
+    return tags;
+}
+
+void Renderer::render(const QString & _template, int startPos, int endPos, Context *context, QString & output)
+{
     int lastTagEnd = startPos;
 
     while (m_errorPos == -1) {
+        // the output of render(_template, context, device) goes out in chunks
+        if (&output == m_deviceOutput && output.size() >= DeviceChunkSize && !writeOutput(output)) {
+            setError("Failed to write the output", lastTagEnd);
+            break;
+        }
+
         Tag tag = findTag(_template, lastTagEnd, endPos);
         if (tag.type == Tag::Null) {
             output += _template.midRef(lastTagEnd, endPos - lastTagEnd);
@@ -304,14 +371,14 @@ QString Renderer::render(const QString & _template, int startPos, int endPos, Co
                 if (listCount > 0) {
                     for (int i = 0; i < listCount; i++) {
                         context->push(tag.key, i);
-                        output += render(_template, tag.end, endTag.start, context);
+                        render(_template, tag.end, endTag.start, context, output);
                         context->pop();
                     }
                 } else if (context->canEval(tag.key)) {
                     output += context->eval(tag.key, _template.mid(tag.end, endTag.start - tag.end), this);
                 } else if (!context->isFalse(tag.key)) {
                     context->push(tag.key);
-                    output += render(_template, tag.end, endTag.start, context);
+                    render(_template, tag.end, endTag.start, context, output);
                     context->pop();
                 }
                 lastTagEnd = endTag.end;
@@ -327,7 +394,7 @@ QString Renderer::render(const QString & _template, int startPos, int endPos, Co
                 }
             } else {
                 if (context->isFalse(tag.key)) {
-                    output += render(_template, tag.end, endTag.start, context);
+                    render(_template, tag.end, endTag.start, context, output);
                 }
                 lastTagEnd = endTag.end;
             }
@@ -348,7 +415,10 @@ QString Renderer::render(const QString & _template, int startPos, int endPos, Co
             m_partialStack.push(tag.key);
 
             QString partial = context->partialValue(tag.key);
-            output    += render(partial, 0, partial.length(), context);
+            QSharedPointer<TagCache> tags = m_tags;
+            m_tags     = tagCache(partial);
+            render(partial, 0, partial.length(), context, output);
+            m_tags     = tags;
             lastTagEnd = tag.end;
 
             m_partialStack.pop();
@@ -367,8 +437,6 @@ QString Renderer::render(const QString & _template, int startPos, int endPos, Co
             break;
         }
     }
-
-    return output;
 }
 
 void Renderer::setError(const QString & error, int pos)
@@ -386,25 +454,56 @@ void Renderer::setError(const QString & error, int pos)
 
 Tag Renderer::findTag(const QString & content, int pos, int endPos)
 {
-    int tagStartPos = content.indexOf(m_tagStartMarker, pos);
+    // Only tags found with the default markers are cached: the tag found at a
+    // position then only depends on the template. Set delimiter tags are parsed
+    // each time, for their side effect.
+    bool cacheable = m_tags && m_tagStartMarker == m_defaultTagStartMarker && m_tagEndMarker == m_defaultTagEndMarker;
+    ParsedTag parsed;
 
-    if (tagStartPos == -1 || tagStartPos >= endPos) {
+    if (!cacheable) {
+        parsed = parseTag(content, pos);
+    } else {
+        TagCache::const_iterator cached = m_tags->constFind(pos);
+        if (cached != m_tags->constEnd()) {
+            parsed = cached.value();
+        } else {
+            parsed = parseTag(content, pos);
+            if (parsed.tag.type != Tag::SetDelimiter) {
+                m_tags->insert(pos, parsed);
+            }
+        }
+    }
+
+    if (parsed.markerPos >= endPos) {
         return Tag();
     }
+    return parsed.tag;
+}
+
+Renderer::ParsedTag Renderer::parseTag(const QString & content, int pos)
+{
+    ParsedTag parsed;
+    int tagStartPos = content.indexOf(m_tagStartMarker, pos);
+
+    parsed.markerPos = content.length();
+    if (tagStartPos == -1) {
+        return parsed;
+    }
 
     int tagEndPos = content.indexOf(m_tagEndMarker, tagStartPos + m_tagStartMarker.length());
     if (tagEndPos == -1) {
-        return Tag();
+        return parsed;
     }
     tagEndPos += m_tagEndMarker.length();
 
-    Tag tag;
+    Tag & tag = parsed.tag;
     tag.type   = Tag::Value;
     tag.start  = tagStartPos;
     tag.end    = tagEndPos;
+    parsed.markerPos = tagStartPos;
 
     pos = tagStartPos + m_tagStartMarker.length();
-    endPos     = tagEndPos - m_tagEndMarker.length();
+    int endPos = tagEndPos - m_tagEndMarker.length();
 
     QChar typeChar = content.at(pos);
 
@@ -447,7 +546,7 @@ Tag Renderer::findTag(const QString & content, int pos, int endPos)
         expandTag(tag, content);
     }
 
-    return tag;
+    return parsed;
 }
 
 QString Renderer::readTagName(const QString & content, int pos, int endPos)
@@ -531,6 +630,8 @@ void Renderer::setTagMarkers(const QString & startMarker, const QString & endMar
 {
     m_defaultTagStartMarker = startMarker;
     m_defaultTagEndMarker   = endMarker;
+    // the cached tags were found with the previous markers
+    m_tagCaches.clear();
 }
 
 void Renderer::expandTag(Tag & tag, const QString & content)
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QStack>
 #include <QtCore/QString>
 #include <QtCore/QVariant>
@@ -24,6 +26,8 @@
 #include <functional> /* for std::function */
 #endif
 
+class QIODevice;
+
 namespace Mustache {
 class PartialResolver;
 class Renderer;
@@ -204,6 +208,13 @@ public:
      */
     QString render(const QString & _template, Context *context);
 
+    /** Render a Mustache template and write the output, UTF-8 encoded,
+     * to @p device as it is produced.
+     *
+     * Returns false if rendering or writing to @p device failed.
+     */
+    bool render(const QString & _template, Context *context, QIODevice *device);
+
     /** Returns a message describing the last error encountered by the previous
      * render() call.
      */
@@ -228,8 +239,19 @@ public:
     void setTagMarkers(const QString & startMarker, const QString & endMarker);
 
 private:
-    QString render(const QString & _template, int startPos, int endPos, Context *context);
+    /** A tag found by findTag() and the position of its start marker. */
+    struct ParsedTag {
+        int markerPos;
+        Tag tag;
+    };
+    typedef QHash<int, ParsedTag> TagCache;
+
+    void beginRender();
+    void render(const QString & _template, int startPos, int endPos, Context *context, QString & output);
+    bool writeOutput(QString & output);
+    QSharedPointer<TagCache> tagCache(const QString & _template);
 
+    ParsedTag parseTag(const QString & content, int pos);
     Tag findTag(const QString & content, int pos, int endPos);
     Tag findEndTag(const QString & content, const Tag & startTag, int endPos);
     void setError(const QString & error, int pos);
@@ -257,6 +279,17 @@ private:
 
     QString m_defaultTagStartMarker;
     QString m_defaultTagEndMarker;
+
+    // Tags of the templates rendered so far, by start position. Templates are
+    // rendered many times (sections for each list item, every render call),
+    // this saves scanning them for tags again.
+    QHash<QString, QSharedPointer<TagCache> > m_tagCaches;
+    // tags of the template being rendered
+    QSharedPointer<TagCache> m_tags;
+
+    // output of render(_template, context, device) and its device
+    QString *m_deviceOutput;
+    QIODevice *m_device;
 };
 
 /** A convenience function which renders a template using the given data. */
@@ -0,0 +1,299 @@
+/**
+ ******************************************************************************
+ *
+ * @file       parquetwriter.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Minimal Parquet file writer for columnar exports
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "parquetwriter.h"
+
+#include <QIODevice>
+#include <QtEndian>
+#include <string.h>
+
+using namespace Utils;
+
+namespace {
+const char MAGIC[] = "PAR1";
+
+// parquet.thrift enums
+const int ENCODING_PLAIN = 0;
+const int ENCODING_RLE   = 3;
+const int CODEC_UNCOMPRESSED = 0;
+const int PAGE_DATA = 0;
+const int REPETITION_REQUIRED = 0;
+
+/**
+ * The subset of the Thrift compact protocol used by the Parquet metadata.
+ * Fields are written in increasing id order, each struct tracks the last id.
+ */
+class ThriftWriter {
+public:
+    enum FieldType { I32 = 5, I64 = 6, BINARY = 8, LIST = 9, STRUCT = 12 };
+
+    explicit ThriftWriter(QByteArray &out) : m_out(out), m_lastId(0) {}
+
+    void i32(int id, qint32 value)
+    {
+        field(id, I32);
+        varint(zigzag(value));
+    }
+    void i64(int id, qint64 value)
+    {
+        field(id, I64);
+        varint(zigzag(value));
+    }
+    void string(int id, const QByteArray &value)
+    {
+        field(id, BINARY);
+        varint(value.size());
+        m_out.append(value);
+    }
+    // the elements of the list follow, with listI32(), listString() or beginStruct()
+    void list(int id, FieldType elementType, int size)
+    {
+        field(id, LIST);
+        if (size < 15) {
+            m_out.append((char)((size << 4) | elementType));
+        } else {
+            m_out.append((char)(0xF0 | elementType));
+            varint(size);
+        }
+    }
+    void listI32(qint32 value)
+    {
+        varint(zigzag(value));
+    }
+    void listString(const QByteArray &value)
+    {
+        varint(value.size());
+        m_out.append(value);
+    }
+    // a struct field (id > 0) or a list element (id == 0)
+    void beginStruct(int id = 0)
+    {
+        if (id) {
+            field(id, STRUCT);
+        }
+        m_ids.append(m_lastId);
+        m_lastId = 0;
+    }
+    void endStruct()
+    {
+        m_out.append((char)0);
+        m_lastId = m_ids.takeLast();
+    }
+
+private:
+    QByteArray &m_out;
+    int m_lastId;
+    QList<int> m_ids;
+
+    static quint64 zigzag(qint64 value)
+    {
+        return ((quint64)value << 1) ^ (quint64)(value >> 63);
+    }
+    void varint(quint64 value)
+    {
+        while (value >= 0x80) {
+            m_out.append((char)((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        m_out.append((char)value);
+    }
+    void field(int id, FieldType type)
+    {
+        int delta = id - m_lastId;
+
+        if (delta > 0 && delta <= 15) {
+            m_out.append((char)((delta << 4) | type));
+        } else {
+            m_out.append((char)type);
+            varint(zigzag(id));
+        }
+        m_lastId = id;
+    }
+};
+}
+
+ParquetWriter::RowGroup::RowGroup(int columns) :
+    m_values(columns), m_rows(0)
+{}
+
+void ParquetWriter::RowGroup::appendInt32(int column, qint32 value)
+{
+    char le[4];
+
+    qToLittleEndian<qint32>(value, (uchar *)le);
+    m_values[column].append(le, 4);
+}
+
+void ParquetWriter::RowGroup::appendInt64(int column, qint64 value)
+{
+    char le[8];
+
+    qToLittleEndian<qint64>(value, (uchar *)le);
+    m_values[column].append(le, 8);
+}
+
+void ParquetWriter::RowGroup::appendFloat(int column, float value)
+{
+    quint32 bits;
+
+    memcpy(&bits, &value, 4);
+    appendInt32(column, bits);
+}
+
+void ParquetWriter::RowGroup::appendDouble(int column, double value)
+{
+    quint64 bits;
+
+    memcpy(&bits, &value, 8);
+    appendInt64(column, bits);
+}
+
+void ParquetWriter::RowGroup::appendString(int column, const QByteArray &value)
+{
+    appendInt32(column, value.size());
+    m_values[column].append(value);
+}
+
+ParquetWriter::ParquetWriter(QIODevice *device, const QList<Column> &columns) :
+    m_device(device), m_columns(columns), m_offset(0)
+{}
+
+ParquetWriter::EncodedRowGroup ParquetWriter::encode(const QList<Column> &columns, const RowGroup &group)
+{
+    EncodedRowGroup encoded;
+
+    encoded.rows = group.m_rows;
+    for (int i = 0; i < columns.count(); i++) {
+        const QByteArray &values = group.m_values.at(i);
+        int start = encoded.data.size();
+
+        // a single data page holds the whole column chunk, no levels for required columns
+        ThriftWriter page(encoded.data);
+        page.i32(1, PAGE_DATA);
+        page.i32(2, values.size());
+        page.i32(3, values.size());
+        page.beginStruct(5);
+        page.i32(1, group.m_rows);
+        page.i32(2, ENCODING_PLAIN);
+        page.i32(3, ENCODING_RLE);
+        page.i32(4, ENCODING_RLE);
+        page.endStruct();
+        encoded.data.append((char)0);
+        encoded.data.append(values);
+        encoded.chunkSizes.append(encoded.data.size() - start);
+    }
+    return encoded;
+}
+
+bool ParquetWriter::writeHeader()
+{
+    if (m_offset == 0) {
+        if (m_device->write(MAGIC, 4) != 4) {
+            return false;
+        }
+        m_offset = 4;
+    }
+    return true;
+}
+
+bool ParquetWriter::write(const EncodedRowGroup &group)
+{
+    if (!writeHeader() || m_device->write(group.data) != group.data.size()) {
+        return false;
+    }
+    RowGroupInfo info = { m_offset, group.chunkSizes, group.rows };
+    m_rowGroups.append(info);
+    m_offset += group.data.size();
+    return true;
+}
+
+bool ParquetWriter::close()
+{
+    if (!writeHeader()) {
+        return false;
+    }
+
+    QByteArray footer;
+    ThriftWriter meta(footer);
+    qint64 rows = 0;
+    foreach(const RowGroupInfo &info, m_rowGroups) {
+        rows += info.rows;
+    }
+
+    // FileMetaData
+    meta.i32(1, 1);
+    meta.list(2, ThriftWriter::STRUCT, m_columns.count() + 1);
+    meta.beginStruct();
+    meta.string(4, "schema");
+    meta.i32(5, m_columns.count());
+    meta.endStruct();
+    foreach(const Column &column, m_columns) {
+        meta.beginStruct();
+        meta.i32(1, column.type);
+        meta.i32(3, REPETITION_REQUIRED);
+        meta.string(4, column.name.toUtf8());
+        if (column.convertedType != NONE) {
+            meta.i32(6, column.convertedType);
+        }
+        meta.endStruct();
+    }
+    meta.i64(3, rows);
+    meta.list(4, ThriftWriter::STRUCT, m_rowGroups.count());
+    foreach(const RowGroupInfo &info, m_rowGroups) {
+        qint64 offset = info.offset;
+        qint64 size   = 0;
+        meta.beginStruct();
+        meta.list(1, ThriftWriter::STRUCT, m_columns.count());
+        for (int i = 0; i < m_columns.count(); i++) {
+            // ColumnChunk and its ColumnMetaData
+            meta.beginStruct();
+            meta.i64(2, offset);
+            meta.beginStruct(3);
+            meta.i32(1, m_columns.at(i).type);
+            meta.list(2, ThriftWriter::I32, 2);
+            meta.listI32(ENCODING_PLAIN);
+            meta.listI32(ENCODING_RLE);
+            meta.list(3, ThriftWriter::BINARY, 1);
+            meta.listString(m_columns.at(i).name.toUtf8());
+            meta.i32(4, CODEC_UNCOMPRESSED);
+            meta.i64(5, info.rows);
+            meta.i64(6, info.chunkSizes.at(i));
+            meta.i64(7, info.chunkSizes.at(i));
+            meta.i64(9, offset);
+            meta.endStruct();
+            meta.endStruct();
+            offset += info.chunkSizes.at(i);
+            size   += info.chunkSizes.at(i);
+        }
+        meta.i64(2, size);
+        meta.i64(3, info.rows);
+        meta.endStruct();
+    }
+    meta.string(6, "LibrePilot GCS");
+    footer.append((char)0);
+
+    char length[4];
+    qToLittleEndian<qint32>(footer.size(), (uchar *)length);
+    footer.append(length, 4);
+    footer.append(MAGIC, 4);
+    return m_device->write(footer) == footer.size();
+}
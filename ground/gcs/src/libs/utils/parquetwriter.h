@@ -0,0 +1,122 @@
+/**
+ ******************************************************************************
+ *
+ * @file       parquetwriter.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Minimal Parquet file writer for columnar exports
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PARQUETWRITER_H
+#define PARQUETWRITER_H
+
+#include "utils_global.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+namespace Utils {
+/**
+ * Writes a table as a Parquet file: uncompressed, PLAIN encoded, required (non null)
+ * columns and a single data page per column chunk, which any Parquet reader accepts.
+ *
+ * Rows are gathered in RowGroups, that are encoded with encode() independently of each
+ * other and of the writer (so on several threads) and then written in order with write().
+ */
+class QTCREATOR_UTILS_EXPORT ParquetWriter {
+public:
+    // Parquet physical types
+    enum Type { INT32 = 1, INT64 = 2, FLOAT = 4, DOUBLE = 5, BYTE_ARRAY = 6 };
+    // Parquet converted (logical) types
+    enum ConvertedType { NONE = -1, UTF8 = 0, UINT_8 = 11, UINT_16 = 12, UINT_32 = 13, INT_8 = 15, INT_16 = 16 };
+
+    struct Column {
+        QString name;
+        Type type;
+        ConvertedType convertedType;
+    };
+
+    /**
+     * The values of a group of rows, PLAIN encoded per column.
+     * Each row must append exactly one value per column, in the column types.
+     */
+    class QTCREATOR_UTILS_EXPORT RowGroup {
+    public:
+        explicit RowGroup(int columns = 0);
+
+        void appendInt32(int column, qint32 value);
+        void appendInt64(int column, qint64 value);
+        void appendFloat(int column, float value);
+        void appendDouble(int column, double value);
+        void appendString(int column, const QByteArray &value);
+        // call once all the values of a row are appended
+        void endRow()
+        {
+            m_rows++;
+        }
+        int rows() const
+        {
+            return m_rows;
+        }
+
+    private:
+        friend class ParquetWriter;
+        QVector<QByteArray> m_values;
+        int m_rows;
+    };
+
+    // An encoded row group, ready to be written
+    struct EncodedRowGroup {
+        QByteArray data;
+        QVector<qint64> chunkSizes;
+        int rows;
+    };
+
+    ParquetWriter(QIODevice *device, const QList<Column> &columns);
+
+    const QList<Column> &columns() const
+    {
+        return m_columns;
+    }
+
+    static EncodedRowGroup encode(const QList<Column> &columns, const RowGroup &group);
+
+    // the file header is written with the first row group
+    bool write(const EncodedRowGroup &group);
+    // writes the footer, the file is complete (even without any row)
+    bool close();
+
+private:
+    struct RowGroupInfo {
+        qint64 offset;
+        QVector<qint64> chunkSizes;
+        int rows;
+    };
+
+    QIODevice *m_device;
+    QList<Column> m_columns;
+    QList<RowGroupInfo> m_rowGroups;
+    qint64 m_offset;
+
+    bool writeHeader();
+};
+}
+
+#endif // PARQUETWRITER_H
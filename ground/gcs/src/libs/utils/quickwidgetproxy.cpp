@@ -26,9 +26,14 @@
  */
 
 #include "quickwidgetproxy.h"
+#include "pathutils.h"
+#include "svgimageprovider.h"
 
 #include <QQmlEngine>
 #include <QQmlContext>
+#include <QQmlComponent>
+#include <QQmlProperty>
+#include <QQuickItem>
 #include <QDebug>
 
 /*
@@ -46,38 +51,50 @@
  * resulting in reduced performance and possibly rendering glitches.
  * The entire purpose of QQuickWidget is to render Quick scenes without a separate native window,
  * hence making it a native widget should always be avoided.
+ *
+ * Note: the window container path presents the scene graph directly from the GPU, without the
+ * FBO read back into the widget backing store, and keeps the threaded render loop.
+ * A window container is not rendered while it is hidden and, like QQuickWidget, only renders
+ * a new frame when the scene changes.
  */
+bool QuickWidgetProxy::s_useWindowContainer = false;
+QQmlEngine *QuickWidgetProxy::s_engine     = NULL;
+int QuickWidgetProxy::s_engineRefCount     = 0;
+
 QuickWidgetProxy::QuickWidgetProxy(QWidget *parent) : QObject(parent)
 {
-    m_widget = true;
+    m_widget = !s_useWindowContainer;
 
     m_quickWidget = NULL;
 
     m_container   = NULL;
     m_quickView   = NULL;
 
+    m_rootItem    = NULL;
+
+    QQmlEngine *engine = acquireEngine();
+    m_context = new QQmlContext(engine->rootContext(), this);
+
     if (m_widget) {
-        m_quickWidget = new QQuickWidget(parent);
+        m_quickWidget = new QQuickWidget(engine, parent);
         m_quickWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
 
-        void (QuickWidgetProxy::*f)(QQuickWidget::Status) = &QuickWidgetProxy::onStatusChanged;
-        connect(m_quickWidget, &QQuickWidget::statusChanged, this, f);
         connect(m_quickWidget, &QQuickWidget::sceneGraphError, this, &QuickWidgetProxy::onSceneGraphError);
     } else {
-        m_quickView = new QQuickView();
+        m_quickView = new QQuickView(engine, NULL);
         m_quickView->setResizeMode(QQuickView::SizeRootObjectToView);
         m_container = QWidget::createWindowContainer(m_quickView, parent);
         m_container->setMinimumSize(64, 64);
         m_container->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
 
-        void (QuickWidgetProxy::*f)(QQuickView::Status) = &QuickWidgetProxy::onStatusChanged;
-        connect(m_quickView, &QQuickView::statusChanged, this, f);
         connect(m_quickView, &QQuickView::sceneGraphError, this, &QuickWidgetProxy::onSceneGraphError);
     }
 }
 
 QuickWidgetProxy::~QuickWidgetProxy()
 {
+    // the root item belongs to the proxy's context, drop it while both are alive
+    delete m_rootItem;
     if (m_quickWidget) {
         delete m_quickWidget;
     }
@@ -85,6 +102,38 @@ QuickWidgetProxy::~QuickWidgetProxy()
         delete m_quickView;
         delete m_container;
     }
+    delete m_context;
+    releaseEngine();
+}
+
+QQmlEngine *QuickWidgetProxy::acquireEngine()
+{
+    if (!s_engine) {
+        s_engine = new QQmlEngine();
+        // parsed svg documents are cached across the gadgets, see SvgImageProvider
+        s_engine->addImageProvider("svg", new SvgImageProvider(Utils::GetDataPath() + "qml/"));
+    }
+    s_engineRefCount++;
+    return s_engine;
+}
+
+void QuickWidgetProxy::releaseEngine()
+{
+    // compiled components can refer to types of the plugins, don't outlive them
+    if (--s_engineRefCount == 0) {
+        delete s_engine;
+        s_engine = NULL;
+    }
+}
+
+void QuickWidgetProxy::setUseWindowContainer(bool use)
+{
+    s_useWindowContainer = use;
+}
+
+bool QuickWidgetProxy::useWindowContainer()
+{
+    return s_useWindowContainer;
 }
 
 QWidget *QuickWidgetProxy::widget()
@@ -98,71 +147,66 @@ QWidget *QuickWidgetProxy::widget()
 
 QQmlEngine *QuickWidgetProxy::engine() const
 {
-    if (m_widget) {
-        return m_quickWidget->engine();
-    } else {
-        return m_quickView->engine();
-    }
+    return s_engine;
 }
 
-void QuickWidgetProxy::setSource(const QUrl &url)
+QQmlContext *QuickWidgetProxy::rootContext() const
 {
-    if (m_widget) {
-        m_quickWidget->setSource(url);
-    } else {
-        m_quickView->setSource(url);
-    }
+    return m_context;
 }
 
-QList<QQmlError> QuickWidgetProxy::errors() const
+QQuickWindow *QuickWidgetProxy::quickWindow() const
 {
     if (m_widget) {
-        return m_quickWidget->errors();
+        return m_quickWidget->quickWindow();
     } else {
-        return m_quickView->errors();
+        return m_quickView;
     }
 }
 
-void QuickWidgetProxy::onStatusChanged(QQuickWidget::Status status)
+/*
+ * QQuickWidget::setSource() and QQuickView::setSource() create the root object in the
+ * engine's root context, which is shared by all proxies.
+ * The root item is created here in the proxy's own context instead and fills the window.
+ * The component itself stays in the engine's cache for the next gadget that loads it.
+ */
+void QuickWidgetProxy::setSource(const QUrl &url)
 {
-    switch (status) {
-    case QQuickWidget::Null:
-        qWarning() << "QuickWidgetProxy - status Null";
-        break;
-    case QQuickWidget::Ready:
-        // qDebug() << "QuickWidgetProxy - status Ready";
-        break;
-    case QQuickWidget::Loading:
-        // qDebug() << "QuickWidgetProxy - status Loading";
-        break;
-    case QQuickWidget::Error:
+    delete m_rootItem;
+    m_rootItem = NULL;
+    m_errors.clear();
+
+    if (url.isEmpty()) {
+        return;
+    }
+
+    QQmlComponent component(s_engine, url);
+    QObject *object = component.beginCreate(m_context);
+    m_rootItem = qobject_cast<QQuickItem *>(object);
+    if (m_rootItem) {
+        m_rootItem->setParentItem(quickWindow()->contentItem());
+        QQmlProperty::write(m_rootItem, "anchors.fill", QVariant::fromValue(quickWindow()->contentItem()));
+    }
+    if (object) {
+        component.completeCreate();
+    }
+
+    m_errors = component.errors();
+    if (object && !m_rootItem) {
+        qWarning() << "QuickWidgetProxy - root object is not an Item" << url;
+        delete object;
+    }
+    if (!m_errors.isEmpty()) {
         qWarning() << "QuickWidgetProxy - status Error";
-        foreach(const QQmlError &error, errors()) {
+        foreach(const QQmlError &error, m_errors) {
             qWarning() << error.description();
         }
-        break;
     }
 }
 
-void QuickWidgetProxy::onStatusChanged(QQuickView::Status status)
+QList<QQmlError> QuickWidgetProxy::errors() const
 {
-    switch (status) {
-    case QQuickView::Null:
-        qWarning() << "QuickWidgetProxy - status Null";
-        break;
-    case QQuickView::Ready:
-        // qDebug() << "QuickWidgetProxy - status Ready";
-        break;
-    case QQuickView::Loading:
-        // qDebug() << "QuickWidgetProxy - status Loading";
-        break;
-    case QQuickView::Error:
-        qWarning() << "QuickWidgetProxy - status Error";
-        foreach(const QQmlError &error, errors()) {
-            qWarning() << error.description();
-        }
-        break;
-    }
+    return m_errors;
 }
 
 void QuickWidgetProxy::onSceneGraphError(QQuickWindow::SceneGraphError error, const QString &message)
@@ -33,8 +33,11 @@
 #include <QWidget>
 #include <QQuickWidget>
 #include <QQuickView>
+#include <QQmlError>
 
 class QQmlEngine;
+class QQmlContext;
+class QQuickItem;
 
 /*
  * Very crude proxy that allows to switch between QQuickView and QQuickWindow are runtime
@@ -50,16 +53,34 @@ public:
 
     void setSource(const QUrl &url);
     QQmlEngine *engine() const;
+    // the engine is shared, context properties go to the proxy's own context
+    QQmlContext *rootContext() const;
+    QQuickWindow *quickWindow() const;
     QList<QQmlError> errors() const;
 
+    // proxies created afterwards present through a native QQuickView window
+    // container instead of the FBO backed QQuickWidget
+    static void setUseWindowContainer(bool use);
+    static bool useWindowContainer();
+
 public slots:
-    void onStatusChanged(QQuickWidget::Status status);
-    void onStatusChanged(QQuickView::Status status);
     void onSceneGraphError(QQuickWindow::SceneGraphError error, const QString &message);
 
 private:
+    // one engine for all proxies of the GUI thread, alive while a proxy uses it
+    static QQmlEngine *acquireEngine();
+    static void releaseEngine();
+
+    static bool s_useWindowContainer;
+    static QQmlEngine *s_engine;
+    static int s_engineRefCount;
+
     bool m_widget;
 
+    QQmlContext *m_context;
+    QQuickItem *m_rootItem;
+    QList<QQmlError> m_errors;
+
     QQuickWidget *m_quickWidget;
 
     QWidget *m_container;
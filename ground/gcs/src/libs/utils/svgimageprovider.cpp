@@ -32,6 +32,39 @@
 #include <QUrl>
 #include <QFileInfo>
 #include <QSvgRenderer>
+#include <QHash>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace {
+// budget of the rendered images, in bytes
+const int IMAGE_CACHE_SIZE = 32 * 1024 * 1024;
+
+typedef struct {
+    QImage image;
+    QSize  size;
+} CachedImage;
+
+// shared by all the providers
+// images are requested from the QML image reader thread, the mutex guards the renderers too
+class SvgCache {
+public:
+    SvgCache() : images(IMAGE_CACHE_SIZE) {}
+    ~SvgCache()
+    {
+        qDeleteAll(renderers);
+    }
+
+    QMutex mutex;
+    // parsed documents, keyed by absolute file name
+    QHash<QString, QSvgRenderer *> renderers;
+    // least recently used rendered images, keyed by absolute id and requested size
+    QCache<QString, CachedImage> images;
+};
+}
+
+Q_GLOBAL_STATIC(SvgCache, svgCache)
 
 SvgImageProvider::SvgImageProvider(const QString &basePath) :
     QQuickImageProvider(QQuickImageProvider::Image),
@@ -39,20 +72,22 @@ SvgImageProvider::SvgImageProvider(const QString &basePath) :
 {}
 
 SvgImageProvider::~SvgImageProvider()
+{}
+
+QString SvgImageProvider::filePath(const QString &svgFile) const
 {
-    qDeleteAll(m_renderers);
+    QFileInfo fi(svgFile);
+
+    // if svgFile is relative, make it relative to base
+    return fi.isRelative() ? QUrl::fromLocalFile(m_basePath).resolved(svgFile).toLocalFile() : svgFile;
 }
 
 QSvgRenderer *SvgImageProvider::loadRenderer(const QString &svgFile)
 {
-    QSvgRenderer *renderer = m_renderers.value(svgFile, NULL);
+    QString fn = filePath(svgFile);
+    QSvgRenderer *renderer = svgCache()->renderers.value(fn, NULL);
 
     if (!renderer) {
-        QFileInfo fi(svgFile);
-
-        // if svgFile is relative, make it relative to base
-        QString fn = fi.isRelative() ? QUrl::fromLocalFile(m_basePath).resolved(svgFile).toLocalFile() : svgFile;
-
         renderer = new QSvgRenderer(fn);
         if (!renderer->isValid()) {
             qWarning() << "Failed to load svg file:" << svgFile << fn;
@@ -60,7 +95,7 @@ QSvgRenderer *SvgImageProvider::loadRenderer(const QString &svgFile)
             return 0;
         }
 
-        m_renderers.insert(svgFile, renderer);
+        svgCache()->renderers.insert(fn, renderer);
     }
 
     return renderer;
@@ -79,8 +114,44 @@ QSvgRenderer *SvgImageProvider::loadRenderer(const QString &svgFile)
    Image {
        source: "image://svg/pfd.svg!world"
    }
+
+   The rendered images are kept in a cache shared by all providers.
+   Images can be requested asynchronously (Image.asynchronous), the rendering then happens
+   in the QML image reader thread.
  */
 QImage SvgImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    int separatorPos = id.indexOf('!');
+    QString key = (separatorPos != -1) ? filePath(id.left(separatorPos)) + id.mid(separatorPos) : filePath(id);
+
+    key += QString("@%1x%2").arg(requestedSize.width()).arg(requestedSize.height());
+
+    QMutexLocker locker(&svgCache()->mutex);
+
+    CachedImage *cached = svgCache()->images.object(key);
+    if (cached) {
+        if (size) {
+            *size = cached->size;
+        }
+        return cached->image;
+    }
+
+    QSize imageSize;
+    QImage image = renderImage(id, &imageSize, requestedSize);
+
+    cached = new CachedImage;
+    cached->image = image;
+    cached->size  = imageSize;
+    // images over the budget are not cached, insert() deletes them right away
+    svgCache()->images.insert(key, cached, qMax(image.byteCount(), 1));
+
+    if (size) {
+        *size = imageSize;
+    }
+    return image;
+}
+
+QImage SvgImageProvider::renderImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
     QString svgFile = id;
     QString element;
@@ -225,6 +296,8 @@ QPixmap SvgImageProvider::requestPixmap(const QString &id, QSize *size, const QS
  */
 QRectF SvgImageProvider::scaledElementBounds(const QString &svgFile, const QString &elementName)
 {
+    QMutexLocker locker(&svgCache()->mutex);
+
     QSvgRenderer *renderer = loadRenderer(svgFile);
 
     if (!renderer) {
@@ -31,7 +31,6 @@
 #include "utils_global.h"
 
 #include <QQuickImageProvider>
-#include <QMap>
 
 class QSvgRenderer;
 
@@ -45,11 +44,13 @@ public:
     QPixmap requestPixmap(const QString &id, QSize *size, const QSize & requestedSize);
 
     Q_INVOKABLE QRectF scaledElementBounds(const QString &svgFile, const QString &elementName);
+    // absolute path of svgFile, for image://svg/ urls requested from a shared engine
+    Q_INVOKABLE QString filePath(const QString &svgFile) const;
 
 private:
     QSvgRenderer *loadRenderer(const QString &svgFile);
+    QImage renderImage(const QString &id, QSize *size, const QSize & requestedSize);
 
-    QMap<QString, QSvgRenderer *> m_renderers;
     QString m_basePath;
 };
 
@@ -0,0 +1,18 @@
+# Checks and benchmarks the single point and batched coordinate conversions
+TEMPLATE = app
+TARGET = tst_coordinateconversions
+
+QT += testlib
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../../../../gcs.pri)
+include(../../utils.pri)
+
+INCLUDEPATH += $$GCS_SOURCE_TREE/src/libs
+
+linux-* {
+    QMAKE_RPATHDIR += $$GCS_LIBRARY_PATH
+}
+
+SOURCES += tst_coordinateconversions.cpp
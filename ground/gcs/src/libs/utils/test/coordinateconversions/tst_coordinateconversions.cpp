@@ -0,0 +1,185 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_coordinateconversions.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Checks and benchmarks of the batched coordinate conversions
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "utils/coordinateconversions.h"
+
+#include <QVector>
+#include <QtTest/QtTest>
+
+class tst_CoordinateConversions : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void toNEDMatchesLLA2Base();
+    void toLLARoundTrip();
+    void quaternion2RPYBatchMatches();
+
+    void lla2BaseSingle();
+    void toNEDBatch();
+    void quaternion2RPYSingle();
+    void quaternion2RPYBatch();
+
+private:
+    static const int POINTS = 10000;
+
+    double homeLLA[3];
+    QVector<double> lat, lon, alt;
+    QVector<float> north, east, down;
+    QVector<float> q0, q1, q2, q3;
+    QVector<float> roll, pitch, yaw;
+};
+
+void tst_CoordinateConversions::initTestCase()
+{
+    homeLLA[0] = 46.5;
+    homeLLA[1] = 6.6;
+    homeLLA[2] = 400.0;
+
+    // a spiral trail of 10000 points around the home location
+    for (int i = 0; i < POINTS; i++) {
+        double r = i * 0.1;
+        lat << homeLLA[0] + r * cos(i * 0.01) * 1e-5;
+        lon << homeLLA[1] + r * sin(i * 0.01) * 1e-5;
+        alt << homeLLA[2] + (i % 100);
+
+        float angle = i * 0.001f;
+        q0 << cosf(angle);
+        q1 << sinf(angle) * 0.5f;
+        q2 << sinf(angle) * 0.5f;
+        q3 << sinf(angle) * 0.70710678f;
+    }
+    north.resize(POINTS);
+    east.resize(POINTS);
+    down.resize(POINTS);
+    roll.resize(POINTS);
+    pitch.resize(POINTS);
+    yaw.resize(POINTS);
+}
+
+void tst_CoordinateConversions::toNEDMatchesLLA2Base()
+{
+    Utils::CoordinateConversions conversions;
+    Utils::LocalFrame frame(homeLLA);
+    double homeECEF[3];
+    float Rne[3][3];
+
+    conversions.LLA2ECEF(homeLLA, homeECEF);
+    conversions.RneFromLLA(homeLLA, Rne);
+    frame.toNED(lat.constData(), lon.constData(), alt.constData(), north.data(), east.data(), down.data(), POINTS);
+
+    for (int i = 0; i < POINTS; i += 97) {
+        double LLA[3] = { lat[i], lon[i], alt[i] };
+        float NED[3];
+        conversions.LLA2Base(LLA, homeECEF, Rne, NED);
+        // LLA2Base rotates in single precision
+        QVERIFY(qAbs(NED[0] - north[i]) < 0.01f);
+        QVERIFY(qAbs(NED[1] - east[i]) < 0.01f);
+        QVERIFY(qAbs(NED[2] - down[i]) < 0.01f);
+    }
+}
+
+void tst_CoordinateConversions::toLLARoundTrip()
+{
+    Utils::LocalFrame frame(homeLLA);
+    QVector<double> lat2(POINTS), lon2(POINTS), alt2(POINTS);
+
+    frame.toNED(lat.constData(), lon.constData(), alt.constData(), north.data(), east.data(), down.data(), POINTS);
+    frame.toLLA(north.constData(), east.constData(), down.constData(), lat2.data(), lon2.data(), alt2.data(), POINTS);
+
+    for (int i = 0; i < POINTS; i++) {
+        QVERIFY(qAbs(lat[i] - lat2[i]) < 1e-6);
+        QVERIFY(qAbs(lon[i] - lon2[i]) < 1e-6);
+        QVERIFY(qAbs(alt[i] - alt2[i]) < 0.01);
+    }
+}
+
+void tst_CoordinateConversions::quaternion2RPYBatchMatches()
+{
+    Utils::CoordinateConversions conversions;
+
+    conversions.Quaternion2RPY(q0.constData(), q1.constData(), q2.constData(), q3.constData(),
+                               roll.data(), pitch.data(), yaw.data(), POINTS);
+    for (int i = 0; i < POINTS; i += 97) {
+        float q[4] = { q0[i], q1[i], q2[i], q3[i] };
+        float rpy[3];
+        conversions.Quaternion2RPY(q, rpy);
+        QCOMPARE(roll[i], rpy[0]);
+        QCOMPARE(pitch[i], rpy[1]);
+        QCOMPARE(yaw[i], rpy[2]);
+    }
+}
+
+void tst_CoordinateConversions::lla2BaseSingle()
+{
+    Utils::CoordinateConversions conversions;
+
+    QBENCHMARK {
+        for (int i = 0; i < POINTS; i++) {
+            double homeECEF[3];
+            float Rne[3][3];
+            double LLA[3] = { lat[i], lon[i], alt[i] };
+            float NED[3];
+            // what the callers did for each point
+            conversions.RneFromLLA(homeLLA, Rne);
+            conversions.LLA2ECEF(homeLLA, homeECEF);
+            conversions.LLA2Base(LLA, homeECEF, Rne, NED);
+        }
+    }
+}
+
+void tst_CoordinateConversions::toNEDBatch()
+{
+    Utils::LocalFrame frame(homeLLA);
+
+    QBENCHMARK {
+        frame.toNED(lat.constData(), lon.constData(), alt.constData(), north.data(), east.data(), down.data(), POINTS);
+    }
+}
+
+void tst_CoordinateConversions::quaternion2RPYSingle()
+{
+    Utils::CoordinateConversions conversions;
+
+    QBENCHMARK {
+        for (int i = 0; i < POINTS; i++) {
+            float q[4] = { q0[i], q1[i], q2[i], q3[i] };
+            float rpy[3];
+            conversions.Quaternion2RPY(q, rpy);
+        }
+    }
+}
+
+void tst_CoordinateConversions::quaternion2RPYBatch()
+{
+    Utils::CoordinateConversions conversions;
+
+    QBENCHMARK {
+        conversions.Quaternion2RPY(q0.constData(), q1.constData(), q2.constData(), q3.constData(),
+                                   roll.data(), pitch.data(), yaw.data(), POINTS);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_CoordinateConversions)
+
+#include "tst_coordinateconversions.moc"
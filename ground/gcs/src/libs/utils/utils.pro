@@ -1,7 +1,7 @@
 TEMPLATE = lib
 TARGET = Utils
 
-QT += network xml svg gui widgets qml quick quickwidgets
+QT += network xml svg gui widgets qml quick quickwidgets concurrent
 
 DEFINES += QTCREATOR_UTILS_LIB
 
@@ -38,6 +38,8 @@ SOURCES += \
     hostosinfo.cpp \
     logfile.cpp \
     crc.cpp \
+    parquetwriter.cpp \
+    matfilewriter.cpp \
     mustache.cpp \
     textbubbleslider.cpp \
     xmlconfig.cpp
@@ -72,6 +74,8 @@ HEADERS += \
     hostosinfo.h \
     logfile.h \
     crc.h \
+    parquetwriter.h \
+    matfilewriter.h \
     mustache.h \
     textbubbleslider.h \
     filelogger.h \
@@ -925,33 +925,14 @@ void WorldMagModel::SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *S
     }
 }
 
-// brief Comput the MainFieldCoeffH accounting for the date
+// brief Comput the MainFieldCoeffG accounting for the date
 double WorldMagModel::get_main_field_coeff_g(int index)
 {
     if (index >= WMM_NUMTERMS) {
         return 0;
     }
 
-    double coeff = CoeffFile[index][2];
-
-    int a = MagneticModel.nMaxSecVar;
-    int b = (a * (a + 1) / 2 + a);
-    for (int n = 1; n <= MagneticModel.nMax; n++) {
-        for (int m = 0; m <= n; m++) {
-            int sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
-
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel.epoch) * get_secular_var_coeff_g(sum_index);
-            }
-        }
-    }
-
-    return coeff;
+    return MainFieldCoeffG[index];
 }
 
 double WorldMagModel::get_main_field_coeff_h(int index)
@@ -960,26 +941,7 @@ double WorldMagModel::get_main_field_coeff_h(int index)
         return 0;
     }
 
-    double coeff = CoeffFile[index][3];
-
-    int a = MagneticModel.nMaxSecVar;
-    int b = (a * (a + 1) / 2 + a);
-    for (int n = 1; n <= MagneticModel.nMax; n++) {
-        for (int m = 0; m <= n; m++) {
-            int sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
-
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel.epoch) * get_secular_var_coeff_h(sum_index);
-            }
-        }
-    }
-
-    return coeff;
+    return MainFieldCoeffH[index];
 }
 
 double WorldMagModel::get_secular_var_coeff_g(int index)
@@ -1029,6 +991,18 @@ int WorldMagModel::DateToYear(int month, int day, int year)
 
     decimal_date = year + (temp - 1) / (365.0 + ExtraDay);
 
+    // The summations use each coefficient several times, apply the secular
+    // variation once per date instead of on each use. All the terms of degree
+    // 1 and up (index 1 to WMM_NUMTERMS - 1) are within nMaxSecVar.
+    for (int index = 0; index < WMM_NUMTERMS; index++) {
+        MainFieldCoeffG[index] = CoeffFile[index][2];
+        MainFieldCoeffH[index] = CoeffFile[index][3];
+        if (index > 0) {
+            MainFieldCoeffG[index] += (decimal_date - MagneticModel.epoch) * get_secular_var_coeff_g(index);
+            MainFieldCoeffH[index] += (decimal_date - MagneticModel.epoch) * get_secular_var_coeff_h(index);
+        }
+    }
+
     return 0; // OK
 }
 
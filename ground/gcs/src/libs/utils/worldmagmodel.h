@@ -131,6 +131,9 @@ private:
     WMMtype_MagneticModel MagneticModel;
 
     double decimal_date;
+    // main field coefficients at decimal_date, see DateToYear()
+    double MainFieldCoeffG[WMM_NUMTERMS];
+    double MainFieldCoeffH[WMM_NUMTERMS];
 
     void Initialize();
     int Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements);
@@ -31,6 +31,7 @@
 
 
 #include <iostream>
+#include <cmath>
 #include <QtGui>
 #include <QDebug>
 
@@ -41,8 +42,17 @@ AntennaTrackWidget::AntennaTrackWidget(QWidget *parent) : QWidget(parent)
 {
     setupUi(this);
 
-    azimuth_old   = 0;
-    elevation_old = 0;
+    stepper_pos  = 0;
+    servo_old    = -1;
+    havePosition = false;
+    for (int i = 0; i < 3; i++) {
+        velocity[i]   = 0;
+        correction[i] = 0;
+    }
+
+    predictionTimer.setInterval(PREDICTION_PERIOD);
+    connect(&predictionTimer, SIGNAL(timeout()), this, SLOT(predictPosition()));
+    predictionTimer.start();
 }
 
 AntennaTrackWidget::~AntennaTrackWidget()
@@ -92,10 +102,29 @@ void AntennaTrackWidget::setPosition(double lat, double lon, double alt)
     QString str3;
     str3.sprintf("%.2f m", alt);
     coord_value_3->setText(str3);
+
+    // Whatever the prediction was off by at this moment is blended out over
+    // CORRECTION_TIME instead of jumping the antenna to the new position.
+    if (havePosition) {
+        double offset[3];
+        predictedOffset(positionAge.elapsed() / 1000.0, offset);
+        double cosLat = cos(lat * (M_PI / 180));
+        correction[0] = offset[0] + (TrackData.Latitude - lat) * (M_PI / 180) * EARTH_RADIUS;
+        correction[1] = offset[1] + (TrackData.Longitude - lon) * (M_PI / 180) * EARTH_RADIUS * cosLat;
+        correction[2] = offset[2] + (TrackData.Altitude - alt);
+        for (int i = 0; i < 3; i++) {
+            if (!std::isfinite(correction[i])) {
+                correction[i] = 0;
+            }
+        }
+    }
+    havePosition = true;
+    positionAge.start();
+
     TrackData.Latitude  = lat;
     TrackData.Longitude = lon;
     TrackData.Altitude  = alt;
-    calcAntennaPosition();
+    predictPosition();
 }
 
 void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
@@ -129,23 +158,67 @@ void AntennaTrackWidget::setHomePosition(double lat, double lon, double alt)
     TrackData.HomeLatitude  = lat;
     TrackData.HomeLongitude = lon;
     TrackData.HomeAltitude  = alt;
-    calcAntennaPosition();
+    predictPosition();
+}
+
+void AntennaTrackWidget::setVelocity(double north, double east, double down)
+{
+    velocity[0] = north;
+    velocity[1] = east;
+    velocity[2] = down;
+}
+
+/**
+ * Offset in metres (NED) of the predicted position from the last received
+ * position, dt seconds after it was received.
+ */
+void AntennaTrackWidget::predictedOffset(double dt, double offset[3])
+{
+    dt = qBound(0.0, dt, MAX_PREDICTION / 1000.0);
+    double decay = exp(-dt / (CORRECTION_TIME / 1000.0));
+    for (int i = 0; i < 3; i++) {
+        offset[i] = velocity[i] * dt + correction[i] * decay;
+    }
+}
+
+/**
+ * Extrapolate the aircraft position with constant velocity from the last
+ * telemetry update and point the antenna there. Runs every PREDICTION_PERIOD
+ * so the tracker moves smoothly between the much slower position updates.
+ */
+void AntennaTrackWidget::predictPosition()
+{
+    if (!havePosition) {
+        return;
+    }
+
+    double offset[3];
+    predictedOffset(positionAge.elapsed() / 1000.0, offset);
+
+    double lat = TrackData.Latitude + offset[0] / EARTH_RADIUS * (180 / M_PI);
+    double lon = TrackData.Longitude;
+    double cosLat = cos(TrackData.Latitude * (M_PI / 180));
+    if (cosLat > 1e-6) {
+        lon += offset[1] / (EARTH_RADIUS * cosLat) * (180 / M_PI);
+    }
+    double alt = TrackData.Altitude - offset[2];
+
+    calcAntennaPosition(lat, lon, alt);
 }
 
-void AntennaTrackWidget::calcAntennaPosition(void)
+void AntennaTrackWidget::calcAntennaPosition(double uavLat, double uavLon, double uavAlt)
 {
     /** http://www.movable-type.co.uk/scripts/latlong.html **/
     double lat1, lat2, lon1, lon2, a, c, d, x, y, brng;
     double azimuth, elevation;
     double gcsAlt = TrackData.HomeAltitude; // Home MSL altitude
-    double uavAlt = TrackData.Altitude; // UAV MSL altitude
     double dAlt   = uavAlt - gcsAlt; // Altitude difference
 
     // Convert to radians
     lat1 = TrackData.HomeLatitude * (M_PI / 180); // Home lat
     lon1 = TrackData.HomeLongitude * (M_PI / 180); // Home lon
-    lat2 = TrackData.Latitude * (M_PI / 180); // UAV lat
-    lon2 = TrackData.Longitude * (M_PI / 180); // UAV lon
+    lat2 = uavLat * (M_PI / 180); // UAV lat
+    lon2 = uavLon * (M_PI / 180); // UAV lon
 
     // Bearing
     /**
@@ -179,7 +252,7 @@ void AntennaTrackWidget::calcAntennaPosition(void)
         cos(lat1) * cos(lat2) *
         sin((lon2 - lon1) / 2) * sin((lon2 - lon1) / 2);
     c = 2 * atan2(sqrt(a), sqrt(1 - a));
-    d = 6371 * 1000 * c;
+    d = EARTH_RADIUS * c;
 
     // Elevation  v depends servo direction
     if (d != 0) {
@@ -198,15 +271,17 @@ void AntennaTrackWidget::calcAntennaPosition(void)
 
     // servo value 2000-4000
     int servo   = (int)(2000.0 / 180 * elevation + 2000);
-    int stepper = (int)(400.0 / 360 * (azimuth - azimuth_old));
+    // the stepper is tracked in absolute steps so the small moves of the
+    // predicted position add up instead of each being truncated to zero
+    int stepper = qRound(400.0 / 360 * azimuth) - stepper_pos;
 
     // send azimuth and elevation to tracker hardware
-    str3.sprintf("move %d 2000 2000 2000 %d\r", stepper, servo);
-    if (port->isOpen()) {
-        if (azimuth_old != azimuth || elevation != elevation_old) {
+    if (port && port->isOpen()) {
+        if (stepper != 0 || servo != servo_old) {
+            str3.sprintf("move %d 2000 2000 2000 %d\r", stepper, servo);
             port->write(str3.toLatin1());
+            stepper_pos += stepper;
+            servo_old    = servo;
         }
     }
-    azimuth_old   = azimuth;
-    elevation_old = elevation;
 }
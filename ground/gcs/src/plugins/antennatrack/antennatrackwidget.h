@@ -36,6 +36,8 @@
 #include <QtSvg/QGraphicsSvgItem>
 #include <QtSerialPort/QSerialPort>
 #include <QPointer>
+#include <QElapsedTimer>
+#include <QTimer>
 
 class Ui_AntennaTrackWidget;
 
@@ -60,13 +62,31 @@ public:
 private slots:
     void setPosition(double, double, double);
     void setHomePosition(double, double, double);
+    void setVelocity(double, double, double);
     void dumpPacket(const QString &packet);
+    void predictPosition();
 
 private:
-    void calcAntennaPosition(void);
+    // the aircraft position is extrapolated at this period between telemetry updates
+    static const int PREDICTION_PERIOD = 50;
+    // no extrapolation beyond this age of the last position, in ms
+    static const int MAX_PREDICTION    = 2000;
+    // the error of the prediction at a new position is blended out in this time, in ms
+    static const int CORRECTION_TIME   = 500;
+    static constexpr double EARTH_RADIUS = 6371000.0;
+
+    void calcAntennaPosition(double lat, double lon, double alt);
+    void predictedOffset(double dt, double offset[3]);
     QGraphicsSvgItem *marker;
     QPointer<QSerialPort> port;
-    double azimuth_old;
-    double elevation_old;
+    int stepper_pos;
+    int servo_old;
+
+    // constant velocity predictor
+    QTimer predictionTimer;
+    QElapsedTimer positionAge;
+    bool havePosition;
+    double velocity[3]; // NED, m/s
+    double correction[3]; // NED, m
 };
 #endif /* ANTENNATRACKWIDGET_H_ */
@@ -53,6 +53,13 @@ TelemetryParser::TelemetryParser(QObject *parent) : GPSParser(parent)
     } else {
         qDebug() << "Error: Object is unknown (HomeLocation).";
     }
+
+    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("VelocityState"));
+    if (gpsObj != NULL) {
+        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateVelocity(UAVObject *)));
+    } else {
+        qDebug() << "Error: Object is unknown (VelocityState).";
+    }
 }
 
 TelemetryParser::~TelemetryParser()
@@ -80,3 +87,12 @@ void TelemetryParser::updateGPS(UAVObject *object1)
     lon *= 1E-7;
     emit position(lat, lon, alt);
 }
+
+void TelemetryParser::updateVelocity(UAVObject *object1)
+{
+    double north = object1->getField(QString("North"))->getDouble();
+    double east  = object1->getField(QString("East"))->getDouble();
+    double down  = object1->getField(QString("Down"))->getDouble();
+
+    emit velocity(north, east, down);
+}
@@ -45,6 +45,7 @@ public:
 public slots:
     void updateGPS(UAVObject *object1);
     void updateHome(UAVObject *object1);
+    void updateVelocity(UAVObject *object1);
 };
 
 #endif // TELEMETRYPARSER_H
@@ -52,7 +52,14 @@ bool CalibrationUtils::EllipsoidCalibration(Eigen::VectorXf *samplesX, Eigen::Ve
     Eigen::MatrixXf evecs;
 
     EllipsoidFit(samplesX, samplesY, samplesZ, &center, &radii, &evecs, fitAlongXYZ);
+    EllipsoidToCalibration(center, radii, evecs, nominalRange, result);
+    return true;
+}
 
+void CalibrationUtils::EllipsoidToCalibration(const Eigen::Vector3f &center, const Eigen::VectorXf &radii, const Eigen::MatrixXf &evecs,
+                                              float nominalRange,
+                                              EllipsoidCalibrationResult *result)
+{
     result->Scale.setZero();
 
     result->Scale << nominalRange / radii.coeff(0),
@@ -67,7 +74,6 @@ bool CalibrationUtils::EllipsoidCalibration(Eigen::VectorXf *samplesX, Eigen::Ve
     result->CalibrationMatrix = evecs * tmp * evecs.transpose();
     result->Bias.setZero();
     result->Bias << center.coeff(0), center.coeff(1), center.coeff(2);
-    return true;
 }
 
 bool CalibrationUtils::PolynomialCalibration(VectorXf *samplesX, Eigen::VectorXf *samplesY, int degree, Eigen::Ref<Eigen::VectorXf> result, const double maxRelativeError)
@@ -320,6 +326,15 @@ void CalibrationUtils::EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *
     Eigen::MatrixXf dt2 = (D.transpose() * ones);
     Eigen::VectorXf v   = dt1.inverse() * dt2;
 
+    EllipsoidFromParameters(v, center, radii, evecs, fitAlongXYZ);
+}
+
+void CalibrationUtils::EllipsoidFromParameters(const Eigen::VectorXf &v,
+                                               Eigen::Vector3f *center,
+                                               Eigen::VectorXf *radii,
+                                               Eigen::MatrixXf *evecs,
+                                               bool fitAlongXYZ)
+{
     if (!fitAlongXYZ) {
         Eigen::Matrix4f A;
         A << v.coeff(0), v.coeff(3), v.coeff(4), v.coeff(6),
@@ -356,6 +371,65 @@ void CalibrationUtils::EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *
     }
 }
 
+EllipsoidFitAccumulator::EllipsoidFitAccumulator(bool fitAlongXYZ) :
+    m_fitAlongXYZ(fitAlongXYZ)
+{
+    clear();
+}
+
+void EllipsoidFitAccumulator::clear()
+{
+    int params = m_fitAlongXYZ ? 6 : 9;
+
+    m_count = 0;
+    m_dtd.setZero(params, params);
+    m_dto.setZero(params);
+}
+
+/**
+ * Adds the row of the design matrix D built by EllipsoidFit for this sample
+ * to D'D and D'1
+ */
+void EllipsoidFitAccumulator::add(float x, float y, float z)
+{
+    Eigen::VectorXd d(m_dto.rows());
+
+    if (m_fitAlongXYZ) {
+        d << (double)x * x, (double)y * y, (double)z * z, 2.0 * x, 2.0 * y, 2.0 * z;
+    } else {
+        d << (double)x * x, (double)y * y, (double)z * z,
+            2.0 * x * y, 2.0 * x * z, 2.0 * y * z,
+            2.0 * x, 2.0 * y, 2.0 * z;
+    }
+    m_dtd.selfadjointView<Eigen::Lower>().rankUpdate(d);
+    m_dto += d;
+    m_count++;
+}
+
+bool EllipsoidFitAccumulator::solve(float nominalRange, CalibrationUtils::EllipsoidCalibrationResult *result, double *residual) const
+{
+    if (m_count < m_dto.rows()) {
+        return false;
+    }
+
+    Eigen::MatrixXd dtd = m_dtd.selfadjointView<Eigen::Lower>();
+    Eigen::VectorXd v   = dtd.ldlt().solve(m_dto);
+
+    if (residual) {
+        // |Dv - 1|^2 expanded in terms of the accumulated normal equations
+        double sse = v.dot(dtd * v) - 2 * v.dot(m_dto) + m_count;
+        *residual = sqrt(qMax(sse, 0.0) / m_count);
+    }
+
+    Eigen::VectorXf radii;
+    Eigen::Vector3f center;
+    Eigen::MatrixXf evecs;
+
+    CalibrationUtils::EllipsoidFromParameters(v.cast<float>(), &center, &radii, &evecs, m_fitAlongXYZ);
+    CalibrationUtils::EllipsoidToCalibration(center, radii, evecs, nominalRange, result);
+    return true;
+}
+
 int CalibrationUtils::SixPointInConstFieldCal(double ConstMag, double x[6], double y[6], double z[6], double S[3], double b[3])
 {
     int i;
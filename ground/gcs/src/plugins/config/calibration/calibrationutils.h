@@ -54,12 +54,49 @@ public:
     static double listMean(QList<double> list);
     static double listVar(QList<double> list);
 private:
+    friend class EllipsoidFitAccumulator;
+
     static void EllipsoidFit(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *samplesZ,
                              Eigen::Vector3f *center,
                              Eigen::VectorXf *radii,
                              Eigen::MatrixXf *evecs, bool fitAlongXYZ);
+    static void EllipsoidFromParameters(const Eigen::VectorXf &v,
+                                        Eigen::Vector3f *center,
+                                        Eigen::VectorXf *radii,
+                                        Eigen::MatrixXf *evecs, bool fitAlongXYZ);
+    static void EllipsoidToCalibration(const Eigen::Vector3f &center, const Eigen::VectorXf &radii, const Eigen::MatrixXf &evecs,
+                                       float nominalRange,
+                                       EllipsoidCalibrationResult *result);
 
     static int LinearEquationsSolve(int nDim, double *pfMatr, double *pfVect, double *pfSolution);
 };
+
+/**
+ * Streaming version of CalibrationUtils::EllipsoidCalibration.
+ * Samples are folded into the normal equations of the least squares fit as they
+ * arrive, so memory does not grow with the sample count and solving is a
+ * constant time operation that can be repeated while sampling.
+ */
+class EllipsoidFitAccumulator {
+public:
+    explicit EllipsoidFitAccumulator(bool fitAlongXYZ = true);
+
+    void clear();
+    void add(float x, float y, float z);
+    int count() const
+    {
+        return m_count;
+    }
+
+    // Returns false if there are not enough samples yet. residual, if given, receives the
+    // RMS algebraic residual of the fit, 0 being a perfect ellipsoid
+    bool solve(float nominalRange, CalibrationUtils::EllipsoidCalibrationResult *result, double *residual = 0) const;
+
+private:
+    bool m_fitAlongXYZ;
+    int m_count;
+    Eigen::MatrixXd m_dtd;
+    Eigen::VectorXd m_dto;
+};
 }
 #endif // CALIBRATIONUTILS_H
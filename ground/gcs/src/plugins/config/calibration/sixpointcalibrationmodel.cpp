@@ -220,9 +220,8 @@ void SixPointCalibrationModel::start(bool calibrateAccel, bool calibrateMag)
     mag_accum_y.clear();
     mag_accum_z.clear();
 
-    mag_fit_x.clear();
-    mag_fit_y.clear();
-    mag_fit_z.clear();
+    mag_fit.clear();
+    aux_mag_fit.clear();
 
     // Need to get as many accel updates as possible
     memento.accelStateMetadata = accelState->getMetadata();
@@ -330,9 +329,7 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
             mag_accum_y.append(magData.y);
             mag_accum_z.append(magData.z);
 #ifndef FITTING_USING_CONTINOUS_ACQUISITION
-            mag_fit_x.append(magData.x);
-            mag_fit_y.append(magData.y);
-            mag_fit_z.append(magData.z);
+            mag_fit.add(magData.x, magData.y, magData.z);
 #endif // FITTING_USING_CONTINOUS_ACQUISITION
         } else if (obj->getObjID() == AuxMagSensor::OBJID) {
             AuxMagSensor::DataFields auxMagData = auxMagSensor->getData();
@@ -342,9 +339,7 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
                 aux_mag_accum_z.append(auxMagData.z);
                 calibratingAuxMag = true;
 #ifndef FITTING_USING_CONTINOUS_ACQUISITION
-                aux_mag_fit_x.append(auxMagData.x);
-                aux_mag_fit_y.append(auxMagData.y);
-                aux_mag_fit_z.append(auxMagData.z);
+                aux_mag_fit.add(auxMagData.x, auxMagData.y, auxMagData.z);
 #endif // FITTING_USING_CONTINOUS_ACQUISITION
             }
         } else {
@@ -382,6 +377,7 @@ void SixPointCalibrationModel::getSample(UAVObject *obj)
         if (calibratingMag) {
             disconnect(magSensor, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(getSample(UAVObject *)));
             disconnect(auxMagSensor, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(getSample(UAVObject *)));
+            logFitQuality();
         }
 
         position = (position + 1) % 6;
@@ -422,20 +418,34 @@ void SixPointCalibrationModel::continouslyGetMagSamples(UAVObject *obj)
 
     if (obj->getObjID() == MagSensor::OBJID) {
         MagSensor::DataFields magSensorData = magSensor->getData();
-        mag_fit_x.append(magSensorData.x);
-        mag_fit_y.append(magSensorData.y);
-        mag_fit_z.append(magSensorData.z);
+        mag_fit.add(magSensorData.x, magSensorData.y, magSensorData.z);
     } else if (obj->getObjID() == AuxMagSensor::OBJID) {
         AuxMagSensor::DataFields auxMagData = auxMagSensor->getData();
         if (auxMagData.Status == AuxMagSensor::STATUS_OK) {
-            aux_mag_fit_x.append(auxMagData.x);
-            aux_mag_fit_y.append(auxMagData.y);
-            aux_mag_fit_z.append(auxMagData.z);
+            aux_mag_fit.add(auxMagData.x, auxMagData.y, auxMagData.z);
             calibratingAuxMag = true;
         }
     }
 }
 
+/**
+ * The fit is updated with every sample, solving it costs the same whatever the
+ * number of samples so the quality of the calibration so far can be reported
+ * after each position.
+ */
+void SixPointCalibrationModel::logFitQuality()
+{
+    OpenPilot::CalibrationUtils::EllipsoidCalibrationResult fitResult;
+    double residual;
+
+    if (mag_fit.solve(1.0f, &fitResult, &residual)) {
+        qDebug() << "Mag fit after position" << position << ":" << mag_fit.count() << "samples, residual" << residual;
+    }
+    if (calibratingAuxMag && aux_mag_fit.solve(1.0f, &fitResult, &residual)) {
+        qDebug() << "Aux mag fit after position" << position << ":" << aux_mag_fit.count() << "samples, residual" << residual;
+    }
+}
+
 /**
  * Computes the scale and bias for the magnetomer or for the accel.
  * Called once all the data has been collected in 6 positions.
@@ -469,10 +479,10 @@ void SixPointCalibrationModel::compute()
 
         qDebug() << "-----------------------------------";
         qDebug() << "Onboard Mag";
-        calcCalibration(mag_fit_x, mag_fit_y, mag_fit_z, Be_length, revoCalibrationData.mag_transform, revoCalibrationData.mag_bias);
+        calcCalibration(mag_fit, Be_length, revoCalibrationData.mag_transform, revoCalibrationData.mag_bias);
         if (calibratingAuxMag) {
             qDebug() << "Aux Mag";
-            calcCalibration(aux_mag_fit_x, aux_mag_fit_y, aux_mag_fit_z, Be_length, auxCalibrationData.mag_transform, auxCalibrationData.mag_bias);
+            calcCalibration(aux_mag_fit, Be_length, auxCalibrationData.mag_transform, auxCalibrationData.mag_bias);
         }
     }
     // Restore the previous setting
@@ -543,20 +553,18 @@ void SixPointCalibrationModel::compute()
     position = -1;
 }
 
-void SixPointCalibrationModel::calcCalibration(QList<float> x, QList<float> y, QList<float> z, double Be_length, float calibrationMatrix[], float bias[])
+void SixPointCalibrationModel::calcCalibration(const EllipsoidFitAccumulator &fit, double Be_length, float calibrationMatrix[], float bias[])
 {
-    int vectSize = x.count();
-    Eigen::VectorXf samples_x(vectSize);
-    Eigen::VectorXf samples_y(vectSize);
-    Eigen::VectorXf samples_z(vectSize);
-
-    for (int i = 0; i < vectSize; i++) {
-        samples_x(i) = x[i];
-        samples_y(i) = y[i];
-        samples_z(i) = z[i];
-    }
     OpenPilot::CalibrationUtils::EllipsoidCalibrationResult result;
-    OpenPilot::CalibrationUtils::EllipsoidCalibration(&samples_x, &samples_y, &samples_z, Be_length, &result, true);
+    double residual = 0;
+
+    if (!fit.solve(Be_length, &result, &residual)) {
+        // not enough samples, leave NaNs for the calibration check in compute()
+        result.CalibrationMatrix.setConstant(NAN);
+        result.Scale.setConstant(NAN);
+        result.Bias.setConstant(NAN);
+    }
+    qDebug() << "Mag fitting from" << fit.count() << "samples, residual" << residual;
 
     qDebug() << "Mag fitting results: ";
     qDebug() << "scale(" << result.Scale.coeff(0) << ", " << result.Scale.coeff(1) << ", " << result.Scale.coeff(2) << ")";
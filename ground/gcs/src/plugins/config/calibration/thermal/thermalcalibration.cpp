@@ -29,6 +29,42 @@
 #include "thermalcalibration.h"
 using namespace OpenPilot;
 
+void ThermalSampleBins::add(float temperature, float x, float y, float z)
+{
+    Bin &bin = m_bins[qRound(temperature / BIN_WIDTH)];
+
+    bin.temperature += temperature;
+    bin.x     += x;
+    bin.y     += y;
+    bin.z     += z;
+    bin.count += 1;
+}
+
+void ThermalSampleBins::columns(Eigen::VectorXf *temperature, Eigen::VectorXf *x, Eigen::VectorXf *y, Eigen::VectorXf *z) const
+{
+    int i = 0;
+
+    temperature->resize(m_bins.count());
+    x->resize(m_bins.count());
+    if (y) {
+        y->resize(m_bins.count());
+    }
+    if (z) {
+        z->resize(m_bins.count());
+    }
+    foreach(const Bin &bin, m_bins) {
+        (*temperature)[i] = bin.temperature / bin.count;
+        (*x)[i] = bin.x / bin.count;
+        if (y) {
+            (*y)[i] = bin.y / bin.count;
+        }
+        if (z) {
+            (*z)[i] = bin.z / bin.count;
+        }
+        i++;
+    }
+}
+
 void ThermalCalibration::ComputeStats(Eigen::VectorXf *samplesX, Eigen::VectorXf *samplesY, Eigen::VectorXf *correctionPoly, float *initialSigma, float *rebiasedSigma)
 {
     *initialSigma = CalibrationUtils::ComputeSigma(samplesY);
@@ -28,8 +28,41 @@
 #ifndef THERMALCALIBRATION_H
 #define THERMALCALIBRATION_H
 #include "../calibrationutils.h"
+#include <QMap>
 
 namespace OpenPilot {
+/**
+ * Sensor samples averaged in fixed width temperature bins as they are acquired.
+ * Memory is bounded by the temperature span instead of the duration of the run,
+ * and the bins come out ordered by temperature, ready to fit.
+ */
+class ThermalSampleBins {
+public:
+    constexpr static const float BIN_WIDTH = 0.05f;
+
+    void clear()
+    {
+        m_bins.clear();
+    }
+    void add(float temperature, float x, float y = 0, float z = 0);
+    int count() const
+    {
+        return m_bins.count();
+    }
+    // bin means, y and z may be null
+    void columns(Eigen::VectorXf *temperature, Eigen::VectorXf *x, Eigen::VectorXf *y = 0, Eigen::VectorXf *z = 0) const;
+
+private:
+    struct Bin {
+        double temperature;
+        double x;
+        double y;
+        double z;
+        int    count;
+    };
+    QMap<int, Bin> m_bins;
+};
+
 class ThermalCalibration {
     static const int GYRO_X_POLY_DEGREE  = 2;
     static const int GYRO_Y_POLY_DEGREE  = 2;
@@ -183,7 +183,6 @@ void ThermalCalibrationHelper::initAcquisition()
     m_accelSamples.clear();
     m_gyroSamples.clear();
     m_baroSamples.clear();
-    m_magSamples.clear();
 
     m_results.accelCalibrated = false;
     m_results.gyroCalibrated  = false;
@@ -219,22 +218,28 @@ void ThermalCalibrationHelper::collectSample(UAVObject *sample)
 
     switch (sample->getObjID()) {
     case AccelSensor::OBJID:
-        m_accelSamples.append(accelSensor->getData());
-        m_debugStream << "ACCEL:: " << m_accelSamples.last().temperature
+    {
+        AccelSensor::DataFields data = accelSensor->getData();
+        m_accelSamples.add(data.temperature, data.x, data.y, data.z);
+        m_debugStream << "ACCEL:: " << data.temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_accelSamples.last().x
-                      << "\t" << m_accelSamples.last().y
-                      << "\t" << m_accelSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     case GyroSensor::OBJID:
-        m_gyroSamples.append(gyroSensor->getData());
-        m_debugStream << "GYRO:: " << m_gyroSamples.last().temperature
+    {
+        GyroSensor::DataFields data = gyroSensor->getData();
+        m_gyroSamples.add(data.temperature, data.x, data.y, data.z);
+        m_debugStream << "GYRO:: " << data.temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_gyroSamples.last().x
-                      << "\t" << m_gyroSamples.last().y
-                      << "\t" << m_gyroSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     case BaroSensor::OBJID:
     {
@@ -244,23 +249,25 @@ void ThermalCalibrationHelper::collectSample(UAVObject *sample)
         data.Temperature = temp;
         data.Pressure   += 10.0f * temp;
 #endif
-        m_baroSamples.append(data);
-        m_debugStream << "BARO:: " << m_baroSamples.last().Temperature
+        m_baroSamples.add(data.Temperature, data.Pressure);
+        m_debugStream << "BARO:: " << data.Temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_baroSamples.last().Pressure
-                      << "\t" << m_baroSamples.last().Altitude << endl;
+                      << "\t" << data.Pressure
+                      << "\t" << data.Altitude << endl;
         // must be done last as this call might end acquisition and close the debug log file
         updateTemperature(temp);
         break;
     }
 
     case MagSensor::OBJID:
-        m_magSamples.append(magSensor->getData());
+    {
+        MagSensor::DataFields data = magSensor->getData();
         m_debugStream << "MAG:: " << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_magSamples.last().x
-                      << "\t" << m_magSamples.last().y
-                      << "\t" << m_magSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     default:
         qDebug() << "Unexpected object" << sample->getObjID();
@@ -300,17 +307,14 @@ void ThermalCalibrationHelper::cleanup()
 
 void ThermalCalibrationHelper::calculate()
 {
+    // the fits run on the temperature bin means, a few hundred points whatever the run length
     // baro
-    int count = m_baroSamples.count();
-    Eigen::VectorXf datax(count);
-    Eigen::VectorXf datay(1);
-    Eigen::VectorXf dataz(1);
-    Eigen::VectorXf datat(count);
-
-    for (int x = 0; x < count; x++) {
-        datax[x] = m_baroSamples[x].Pressure;
-        datat[x] = m_baroSamples[x].Temperature;
-    }
+    Eigen::VectorXf datax;
+    Eigen::VectorXf datay;
+    Eigen::VectorXf dataz;
+    Eigen::VectorXf datat;
+
+    m_baroSamples.columns(&datat, &datax);
 
     m_results.baroCalibrated = ThermalCalibration::BarometerCalibration(datax, datat, m_results.baro,
                                                                         &m_results.baroInSigma, &m_results.baroOutSigma);
@@ -325,18 +329,7 @@ void ThermalCalibrationHelper::calculate()
     m_results.baroTempMax = datat.array().maxCoeff();
 
     // gyro
-    count = m_gyroSamples.count();
-    datax.resize(count);
-    datay.resize(count);
-    dataz.resize(count);
-    datat.resize(count);
-
-    for (int x = 0; x < count; x++) {
-        datax[x] = m_gyroSamples[x].x;
-        datay[x] = m_gyroSamples[x].y;
-        dataz[x] = m_gyroSamples[x].z;
-        datat[x] = m_gyroSamples[x].temperature;
-    }
+    m_gyroSamples.columns(&datat, &datax, &datay, &dataz);
 
     m_results.gyroCalibrated = ThermalCalibration::GyroscopeCalibration(datax, datay, dataz, datat,
                                                                         m_results.gyro, m_results.gyroBias,
@@ -353,18 +346,7 @@ void ThermalCalibrationHelper::calculate()
     m_results.accelGyroTempMax = datat.array().maxCoeff();
     // TODO: sanity checks needs to be enforced before accel calibration can be enabled and usable.
     /*
-       count = m_accelSamples.count();
-       datax.resize(count);
-       datay.resize(count);
-       dataz.resize(count);
-       datat.resize(count);
-
-       for(int x = 0; x < count; x++){
-       datax[x] = m_accelSamples[x].x;
-       datay[x] = m_accelSamples[x].y;
-       dataz[x] = m_accelSamples[x].z;
-       datat[x] = m_accelSamples[x].temperature;
-       }
+       m_accelSamples.columns(&datat, &datax, &datay, &dataz);
 
        m_results.accelCalibrated = ThermalCalibration::AccelerometerCalibration(datax, datay, dataz, datat, m_results.accel);
      */
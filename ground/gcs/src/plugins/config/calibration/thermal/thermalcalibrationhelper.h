@@ -53,6 +53,7 @@
 #include <revosettings.h>
 
 #include "../wizardmodel.h"
+#include "thermalcalibration.h"
 
 namespace OpenPilot {
 typedef struct {
@@ -224,10 +225,10 @@ private:
 
     QMutex sensorsUpdateLock;
 
-    QList<AccelSensor::DataFields> m_accelSamples;
-    QList<GyroSensor::DataFields> m_gyroSamples;
-    QList<BaroSensor::DataFields> m_baroSamples;
-    QList<MagSensor::DataFields> m_magSamples;
+    // mag samples are only written to the debug log
+    ThermalSampleBins m_accelSamples;
+    ThermalSampleBins m_gyroSamples;
+    ThermalSampleBins m_baroSamples;
 
     // temperature checkpoints, used to calculate temp gradient
     const static int TimeBetweenCheckpoints = 10;
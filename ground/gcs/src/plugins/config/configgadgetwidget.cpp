@@ -79,6 +79,10 @@ ConfigGadgetWidget::ConfigGadgetWidget(QWidget *parent) : QWidget(parent)
     QWidget *widget;
     QIcon *icon;
 
+    boardModel = 0;
+
+    // Most tabs are only created when first shown, see createTab().
+    // Until then they hold an empty placeholder.
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/hardware_normal.png", QSize(), QIcon::Normal, QIcon::Off);
     icon->addFile(":/configgadget/images/hardware_selected.png", QSize(), QIcon::Selected, QIcon::Off);
@@ -88,25 +92,20 @@ ConfigGadgetWidget::ConfigGadgetWidget(QWidget *parent) : QWidget(parent)
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/vehicle_normal.png", QSize(), QIcon::Normal, QIcon::Off);
     icon->addFile(":/configgadget/images/vehicle_selected.png", QSize(), QIcon::Selected, QIcon::Off);
-    widget = new ConfigVehicleTypeWidget(this);
-    static_cast<ConfigTaskWidget *>(widget)->bind();
-    stackWidget->insertTab(ConfigGadgetWidget::Aircraft, widget, *icon, QString("Vehicle"));
+    stackWidget->insertTab(ConfigGadgetWidget::Aircraft, new QWidget(this), *icon, QString("Vehicle"));
+    lazyTabs.insert(ConfigGadgetWidget::Aircraft);
 
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/input_normal.png", QSize(), QIcon::Normal, QIcon::Off);
     icon->addFile(":/configgadget/images/input_selected.png", QSize(), QIcon::Selected, QIcon::Off);
-    widget = new ConfigInputWidget(this);
-    static_cast<ConfigTaskWidget *>(widget)->bind();
-    stackWidget->insertTab(ConfigGadgetWidget::Input, widget, *icon, QString("Input"));
-    QWidget *inputWidget = widget;
+    stackWidget->insertTab(ConfigGadgetWidget::Input, new QWidget(this), *icon, QString("Input"));
+    lazyTabs.insert(ConfigGadgetWidget::Input);
 
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/output_normal.png", QSize(), QIcon::Normal, QIcon::Off);
     icon->addFile(":/configgadget/images/output_selected.png", QSize(), QIcon::Selected, QIcon::Off);
-    widget = new ConfigOutputWidget(this);
-    static_cast<ConfigTaskWidget *>(widget)->bind();
-    stackWidget->insertTab(ConfigGadgetWidget::Output, widget, *icon, QString("Output"));
-    QWidget *outputWidget = widget;
+    stackWidget->insertTab(ConfigGadgetWidget::Output, new QWidget(this), *icon, QString("Output"));
+    lazyTabs.insert(ConfigGadgetWidget::Output);
 
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/ins_normal.png", QSize(), QIcon::Normal, QIcon::Off);
@@ -117,23 +116,20 @@ ConfigGadgetWidget::ConfigGadgetWidget(QWidget *parent) : QWidget(parent)
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/stabilization_normal.png", QSize(), QIcon::Normal, QIcon::Off);
     icon->addFile(":/configgadget/images/stabilization_selected.png", QSize(), QIcon::Selected, QIcon::Off);
-    widget = new ConfigStabilizationWidget(this);
-    static_cast<ConfigTaskWidget *>(widget)->bind();
-    stackWidget->insertTab(ConfigGadgetWidget::Stabilization, widget, *icon, QString("Stabilization"));
+    stackWidget->insertTab(ConfigGadgetWidget::Stabilization, new QWidget(this), *icon, QString("Stabilization"));
+    lazyTabs.insert(ConfigGadgetWidget::Stabilization);
 
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/camstab_normal.png", QSize(), QIcon::Normal, QIcon::Off);
     icon->addFile(":/configgadget/images/camstab_selected.png", QSize(), QIcon::Selected, QIcon::Off);
-    widget = new ConfigCameraStabilizationWidget(this);
-    static_cast<ConfigTaskWidget *>(widget)->bind();
-    stackWidget->insertTab(ConfigGadgetWidget::CameraStabilization, widget, *icon, QString("Gimbal"));
+    stackWidget->insertTab(ConfigGadgetWidget::CameraStabilization, new QWidget(this), *icon, QString("Gimbal"));
+    lazyTabs.insert(ConfigGadgetWidget::CameraStabilization);
 
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/txpid_normal.png", QSize(), QIcon::Normal, QIcon::Off);
     icon->addFile(":/configgadget/images/txpid_selected.png", QSize(), QIcon::Selected, QIcon::Off);
-    widget = new ConfigTxPIDWidget(this);
-    static_cast<ConfigTaskWidget *>(widget)->bind();
-    stackWidget->insertTab(ConfigGadgetWidget::TxPid, widget, *icon, QString("TxPID"));
+    stackWidget->insertTab(ConfigGadgetWidget::TxPid, new QWidget(this), *icon, QString("TxPID"));
+    lazyTabs.insert(ConfigGadgetWidget::TxPid);
 
     icon   = new QIcon();
     icon->addFile(":/configgadget/images/autotune_normal.png", QSize(), QIcon::Normal, QIcon::Off);
@@ -167,12 +163,6 @@ ConfigGadgetWidget::ConfigGadgetWidget(QWidget *parent) : QWidget(parent)
         onOPLinkConnect();
     }
 
-    // Connect output tab and input tab
-    // Input tab do not start calibration if Output tab is not safe
-    // Output tab uses the signal from Input tab and freeze all output UI while calibrating inputs
-    connect(outputWidget, SIGNAL(outputConfigSafeChanged(bool)), inputWidget, SLOT(setOutputConfigSafe(bool)));
-    connect(inputWidget, SIGNAL(inputCalibrationStateChanged(bool)), outputWidget, SLOT(setInputCalibrationState(bool)));
-
     help = 0;
     connect(stackWidget, SIGNAL(currentAboutToShow(int, bool *)), this, SLOT(tabAboutToChange(int, bool *)));
 }
@@ -184,6 +174,7 @@ ConfigGadgetWidget::~ConfigGadgetWidget()
 
 void ConfigGadgetWidget::startInputWizard()
 {
+    createTab(ConfigGadgetWidget::Input);
     stackWidget->setCurrentIndex(ConfigGadgetWidget::Input);
     ConfigInputWidget *inputWidget = dynamic_cast<ConfigInputWidget *>(stackWidget->getWidget(ConfigGadgetWidget::Input));
     Q_ASSERT(inputWidget);
@@ -207,101 +198,147 @@ void ConfigGadgetWidget::resizeEvent(QResizeEvent *event)
     QWidget::resizeEvent(event);
 }
 
-void ConfigGadgetWidget::onAutopilotConnect()
+/**
+ * Create the widget of a tab that was left lazy, the board specific
+ * widgets depend on boardModel.
+ * @returns NULL if there is no widget for this tab and board
+ */
+ConfigTaskWidget *ConfigGadgetWidget::createWidget(int index)
 {
-    // qDebug() << "ConfigGadgetWidget::onAutopilotConnect";
+    int board = boardModel;
 
-    // Check what Board type we are talking to, and if necessary, remove/add tabs in the config gadget
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectUtilManager *utilMngr     = pm->getObject<UAVObjectUtilManager>();
+    switch (index) {
+    case ConfigGadgetWidget::Aircraft:
+        return new ConfigVehicleTypeWidget(this);
 
-    if (utilMngr) {
-        int board = utilMngr->getBoardModel();
-        if ((board & 0xff00) == 0x0400) {
-            // CopterControl family
+    case ConfigGadgetWidget::Input:
+        return new ConfigInputWidget(this);
+
+    case ConfigGadgetWidget::Output:
+        return new ConfigOutputWidget(this);
 
-            ConfigTaskWidget *widget;
+    case ConfigGadgetWidget::Stabilization:
+        return new ConfigStabilizationWidget(this);
 
+    case ConfigGadgetWidget::CameraStabilization:
+        return new ConfigCameraStabilizationWidget(this);
+
+    case ConfigGadgetWidget::TxPid:
+        return new ConfigTxPIDWidget(this);
+
+    case ConfigGadgetWidget::Sensors:
+        if ((board & 0xff00) == 0x0400) {
+            // CopterControl family
             if ((board & 0x00ff) == 0x03) {
-                widget = new ConfigRevoWidget(this);
-            } else {
-                widget = new ConfigCCAttitudeWidget(this);
+                return new ConfigRevoWidget(this);
             }
+            return new ConfigCCAttitudeWidget(this);
+        } else if ((board & 0xff00) == 0x0900 || (board & 0xff00) == 0x9200 || (board & 0xff00) == 0x1000) {
+            // Revolution family, Sparky2 and F3 boards
+            return new ConfigRevoWidget(this);
+        }
+        // Unknown board
+        qWarning() << "Unknown board " << board;
+        break;
 
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::Sensors, widget);
-
-            widget = new ConfigCCHWWidget(this);
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::Hardware, widget);
-        } else if ((board & 0xff00) == 0x0900) {
-            // Revolution family
-            ConfigTaskWidget *widget;
-            widget = new ConfigRevoWidget(this);
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::Sensors, widget);
-            widget = new ConfigAutoTuneWidget(this);
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::AutoTune, widget);
-            if (board == 0x0903 || board == 0x0904) {
-                widget = new ConfigRevoHWWidget(this);
-            } else if (board == 0x0905) {
-                widget = new ConfigRevoNanoHWWidget(this);
-            }
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::Hardware, widget);
+    case ConfigGadgetWidget::AutoTune:
+        if ((board & 0xff00) == 0x0900 || (board & 0xff00) == 0x9200) {
+            return new ConfigAutoTuneWidget(this);
+        }
+        break;
+
+    case ConfigGadgetWidget::Hardware:
+        if ((board & 0xff00) == 0x0400) {
+            return new ConfigCCHWWidget(this);
+        } else if (board == 0x0903 || board == 0x0904) {
+            return new ConfigRevoHWWidget(this);
+        } else if (board == 0x0905) {
+            return new ConfigRevoNanoHWWidget(this);
         } else if ((board & 0xff00) == 0x9200) {
-            // Sparky2
-            ConfigTaskWidget *widget;
-            widget = new ConfigRevoWidget(this);
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::Sensors, widget);
-            widget = new ConfigAutoTuneWidget(this);
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::AutoTune, widget);
-            widget = new ConfigSparky2HWWidget(this);
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::Hardware, widget);
-        } else if ((board & 0xff00) == 0x1000) { // F3 boards
-            ConfigTaskWidget *widget;
-            widget = new ConfigRevoWidget(this);
-            widget->bind();
-            stackWidget->replaceTab(ConfigGadgetWidget::Sensors, widget);
-
-            widget = 0;
-
-            switch (board) {
-            case 0x1001:
-                // widget = new ConfigSPRacingF3HWWidget(this);
-                break;
-            case 0x1002:
-            case 0x1003:
-                widget = new ConfigSPRacingF3EVOHWWidget(this);
-                break;
-            case 0x1005:
-                widget = new ConfigPikoBLXHWWidget(this);
-                break;
-            case 0x1006:
-                widget = new ConfigTinyFISHHWWidget(this);
-                break;
-            }
+            return new ConfigSparky2HWWidget(this);
+        }
+        switch (board) {
+        case 0x1001:
+            // return new ConfigSPRacingF3HWWidget(this);
+            break;
+        case 0x1002:
+        case 0x1003:
+            return new ConfigSPRacingF3EVOHWWidget(this);
+
+        case 0x1005:
+            return new ConfigPikoBLXHWWidget(this);
+
+        case 0x1006:
+            return new ConfigTinyFISHHWWidget(this);
+        }
+        break;
+    }
+    return NULL;
+}
 
-            if (widget) {
-                widget->bind();
-                stackWidget->replaceTab(ConfigGadgetWidget::Hardware, widget);
-            }
-        } else {
-            // Unknown board
-            qWarning() << "Unknown board " << board;
+/**
+ * Create a lazy tab, nothing to do if it was created already.
+ */
+void ConfigGadgetWidget::createTab(int index)
+{
+    if (!lazyTabs.remove(index)) {
+        return;
+    }
+
+    ConfigTaskWidget *widget = createWidget(index);
+    if (!widget) {
+        return;
+    }
+
+    // hidden tabs don't need to follow every object update, except the output
+    // tab which keeps the input tab informed about the output config safety
+    widget->setSuspendRefreshWhenHidden(index != ConfigGadgetWidget::Output);
+    widget->bind();
+    stackWidget->replaceTab(index, widget);
+
+    // Input and output tabs depend on each other, always create them together
+    // Input tab do not start calibration if Output tab is not safe
+    // Output tab uses the signal from Input tab and freeze all output UI while calibrating inputs
+    if (index == ConfigGadgetWidget::Input || index == ConfigGadgetWidget::Output) {
+        createTab(index == ConfigGadgetWidget::Input ? ConfigGadgetWidget::Output : ConfigGadgetWidget::Input);
+
+        QWidget *inputWidget  = stackWidget->getWidget(ConfigGadgetWidget::Input);
+        QWidget *outputWidget = stackWidget->getWidget(ConfigGadgetWidget::Output);
+        if (index == ConfigGadgetWidget::Input) {
+            connect(outputWidget, SIGNAL(outputConfigSafeChanged(bool)), inputWidget, SLOT(setOutputConfigSafe(bool)));
+            connect(inputWidget, SIGNAL(inputCalibrationStateChanged(bool)), outputWidget, SLOT(setInputCalibrationState(bool)));
         }
     }
 }
 
+void ConfigGadgetWidget::onAutopilotConnect()
+{
+    // qDebug() << "ConfigGadgetWidget::onAutopilotConnect";
+
+    // Check what Board type we are talking to, the board specific tabs are
+    // created for it when they are shown
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectUtilManager *utilMngr     = pm->getObject<UAVObjectUtilManager>();
+
+    if (utilMngr) {
+        boardModel = utilMngr->getBoardModel();
+
+        // tabs without a widget for this board keep their default widget
+        lazyTabs.insert(ConfigGadgetWidget::Sensors);
+        lazyTabs.insert(ConfigGadgetWidget::AutoTune);
+        lazyTabs.insert(ConfigGadgetWidget::Hardware);
+        createTab(stackWidget->currentIndex());
+    }
+}
 void ConfigGadgetWidget::onAutopilotDisconnect()
 {
     // qDebug() << "ConfigGadgetWidget::onAutopilotDiconnect";
     QWidget *widget;
 
+    lazyTabs.remove(ConfigGadgetWidget::Sensors);
+    lazyTabs.remove(ConfigGadgetWidget::Hardware);
+    lazyTabs.remove(ConfigGadgetWidget::AutoTune);
+
     widget = new DefaultConfigWidget(this, tr("Attitude"));
     stackWidget->replaceTab(ConfigGadgetWidget::Sensors, widget);
 
@@ -318,6 +355,7 @@ void ConfigGadgetWidget::onOPLinkConnect()
 
     ConfigTaskWidget *widget = new ConfigOPLinkWidget(this);
 
+    widget->setSuspendRefreshWhenHidden(true);
     widget->bind();
     stackWidget->replaceTab(ConfigGadgetWidget::OPLink, widget);
 }
@@ -333,10 +371,10 @@ void ConfigGadgetWidget::onOPLinkDisconnect()
 
 void ConfigGadgetWidget::tabAboutToChange(int index, bool *proceed)
 {
-    Q_UNUSED(index);
     *proceed = true;
     ConfigTaskWidget *wid = qobject_cast<ConfigTaskWidget *>(stackWidget->currentWidget());
     if (!wid) {
+        createTab(index);
         return;
     }
     if (wid->isDirty()) {
@@ -349,4 +387,7 @@ void ConfigGadgetWidget::tabAboutToChange(int index, bool *proceed)
             wid->clearDirty();
         }
     }
+    if (*proceed) {
+        createTab(index);
+    }
 }
@@ -29,10 +29,12 @@
 #define CONFIGGADGETWIDGET_H
 
 #include <QWidget>
+#include <QSet>
 
 class QTextBrowser;
 class QSettings;
 class MyTabbedStackWidget;
+class ConfigTaskWidget;
 
 class ConfigGadgetWidget : public QWidget {
     Q_OBJECT
@@ -61,6 +63,12 @@ private slots:
 private:
     MyTabbedStackWidget *stackWidget;
     QTextBrowser *help;
+    // tabs not created yet
+    QSet<int> lazyTabs;
+    int boardModel;
+
+    ConfigTaskWidget *createWidget(int index);
+    void createTab(int index);
 };
 
 #endif // CONFIGGADGETWIDGET_H
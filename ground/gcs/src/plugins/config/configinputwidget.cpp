@@ -1718,7 +1718,7 @@ void ConfigInputWidget::invertControls()
         QCheckBox *cb = qobject_cast<QCheckBox *>(wd);
 
         if (cb) {
-            int index = manualSettingsObj->getField("ChannelNumber")->getElementNames().indexOf(cb->text());
+            int index = manualSettingsObj->getField("ChannelNumber")->getElementIndex(cb->text());
             if ((cb->isChecked() && (manualSettingsData.ChannelMax[index] > manualSettingsData.ChannelMin[index])) ||
                 (!cb->isChecked() && (manualSettingsData.ChannelMax[index] < manualSettingsData.ChannelMin[index]))) {
                 qint16 aux;
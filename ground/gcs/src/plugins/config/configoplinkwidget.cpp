@@ -31,6 +31,9 @@
 #include "ui_oplink.h"
 
 #include <uavobjectutilmanager.h>
+#include <extensionsystem/pluginmanager.h>
+#include <uavtalk/oplinkmanager.h>
+#include <uavtalk/oplinkstatuscache.h>
 
 #include <oplinksettings.h>
 #include <oplinkstatus.h>
@@ -63,6 +66,14 @@ ConfigOPLinkWidget::ConfigOPLinkWidget(QWidget *parent) : ConfigTaskWidget(paren
     oplinkSettingsObj = dynamic_cast<OPLinkSettings *>(getObject("OPLinkSettings"));
     Q_ASSERT(oplinkSettingsObj);
 
+    // the link state and signal strength are only redrawn when they change noticeably
+    OPLinkManager *om = ExtensionSystem::PluginManager::instance()->getObject<OPLinkManager>();
+    Q_ASSERT(om);
+    oplinkStatusCache = om->statusCache();
+    connect(oplinkStatusCache, SIGNAL(linkStateChanged(int)), this, SLOT(updateLinkState()));
+    connect(oplinkStatusCache, SIGNAL(qualityChanged()), this, SLOT(updateLinkState()));
+    connect(oplinkStatusCache, SIGNAL(boardTypeChanged(int)), this, SLOT(boardTypeChanged(int)));
+
     addWidget(m_oplink->FirmwareVersion);
     addWidget(m_oplink->SerialNumber);
     addWidget(m_oplink->MinFreq);
@@ -162,6 +173,8 @@ void ConfigOPLinkWidget::connected()
     oplinkSettingsObj->requestUpdate();
 
     updateSettings();
+    updateLinkState();
+    boardTypeChanged(oplinkStatusCache->boardType());
 }
 
 void ConfigOPLinkWidget::refreshWidgetsValuesImpl(UAVObject *obj)
@@ -178,20 +191,33 @@ void ConfigOPLinkWidget::updateStatus()
 {
     // qDebug() << "ConfigOPLinkWidget::updateStatus";
 
+    int afc_valueKHz = m_oplink->AFCCorrection->text().toInt() / 1000;
+
+    m_oplink->AFCCorrectionBar->setValue(afc_valueKHz);
+
+    if (!statusUpdated) {
+        statusUpdated = true;
+        // update static info
+        updateInfo();
+    }
+}
+
+void ConfigOPLinkWidget::updateLinkState()
+{
     // Update the link state
     UAVObjectField *linkField = oplinkStatusObj->getField("LinkState");
 
-    m_oplink->LinkState->setText(linkField->getValue().toString());
-    bool linkConnected = (oplinkStatusObj->linkState() == OPLinkStatus_LinkState::Connected);
+    m_oplink->LinkState->setText(linkField->getOptions().value(oplinkStatusCache->linkState()));
 
-    m_oplink->SignalStrengthBar->setValue(linkConnected ? m_oplink->RSSI->text().toInt() : -127);
+    // smoothed signal strength
+    m_oplink->SignalStrengthBar->setValue(qRound(oplinkStatusCache->rssi()));
     m_oplink->SignalStrengthLabel->setText(QString("%1dBm").arg(m_oplink->SignalStrengthBar->value()));
+}
 
-    int afc_valueKHz = m_oplink->AFCCorrection->text().toInt() / 1000;
-    m_oplink->AFCCorrectionBar->setValue(afc_valueKHz);
-
+void ConfigOPLinkWidget::boardTypeChanged(int boardType)
+{
     // Enable components based on the board type connected.
-    switch (oplinkStatusObj->boardType()) {
+    switch (boardType) {
     case 0x09: // Revolution, DiscoveryF4Bare, RevoNano, RevoProto
     case 0x92: // Sparky2
         setOPLMOptionsVisible(false);
@@ -203,12 +229,6 @@ void ConfigOPLinkWidget::updateStatus()
         // This shouldn't happen.
         break;
     }
-
-    if (!statusUpdated) {
-        statusUpdated = true;
-        // update static info
-        updateInfo();
-    }
 }
 
 void ConfigOPLinkWidget::setOPLMOptionsVisible(bool visible)
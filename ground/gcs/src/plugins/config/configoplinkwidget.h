@@ -32,6 +32,7 @@
 
 class OPLinkStatus;
 class OPLinkSettings;
+class OPLinkStatusCache;
 
 class Ui_OPLinkWidget;
 
@@ -50,6 +51,7 @@ private:
 
     OPLinkStatus *oplinkStatusObj;
     OPLinkSettings *oplinkSettingsObj;
+    OPLinkStatusCache *oplinkStatusCache;
 
     // Frequency display settings
     float frequency_base;
@@ -68,6 +70,9 @@ private:
 private slots:
     void connected();
 
+    void updateLinkState();
+    void boardTypeChanged(int boardType);
+
     void protocolChanged();
     void linkTypeChanged();
     void customIDChanged();
@@ -150,7 +150,7 @@ ConfigOutputWidget::ConfigOutputWidget(QWidget *parent) : ConfigTaskWidget(paren
     channelTestsStarted     = false;
 
     // TODO why do we do that ?
-    disconnect(this, SLOT(refreshWidgetsValues(UAVObject *)));
+    disconnect(this, SLOT(objectChanged(UAVObject *)));
 }
 
 ConfigOutputWidget::~ConfigOutputWidget()
@@ -444,6 +444,7 @@ void ConfigStabilizationWidget::resetBank(int bank)
         quint8 data[stabBankObject->getNumBytes()];
         defaultStabBankObject->pack(data);
         stabBankObject->unpack(data);
+        delete defaultStabBankObject;
     }
 }
 
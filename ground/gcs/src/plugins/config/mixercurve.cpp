@@ -330,12 +330,21 @@ void MixerCurve::UpdateSettingsTable()
     QList<double> points = m_curve->getCurve();
     int ptCnt = points.count();
 
+    // Writing the cells must not feed back into SettingsTableChanged(),
+    // that would reposition every node again for each changed cell.
+    bool blocked = m_settings->blockSignals(true);
+
     for (int i = 0; i < ptCnt; i++) {
         QTableWidgetItem *item = m_settings->item(i, 0);
         if (item) {
-            item->setText(QString().sprintf("%.2f", points.at((ptCnt - 1) - i)));
+            QString text = QString().sprintf("%.2f", points.at((ptCnt - 1) - i));
+            if (item->text() != text) {
+                item->setText(text);
+            }
         }
     }
+
+    m_settings->blockSignals(blocked);
 }
 
 void MixerCurve::SettingsTableChanged()
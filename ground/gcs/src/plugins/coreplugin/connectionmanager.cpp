@@ -131,8 +131,15 @@ void ConnectionManager::addWidget(QWidget *widget)
  */
 bool ConnectionManager::connectDevice(DevListItem device)
 {
-    Q_UNUSED(device);
-    DevListItem connection_device = findDevice(m_availableDevList->currentIndex());
+    // the listed device knows its position in the dropdown
+    DevListItem connection_device;
+
+    foreach(DevListItem d, m_devList) {
+        if (d.connection == device.connection && d.device.name == device.device.name) {
+            connection_device = d;
+            break;
+        }
+    }
 
     if (!connection_device.connection) {
         return false;
@@ -161,6 +168,7 @@ bool ConnectionManager::connectDevice(DevListItem device)
     emit deviceConnected(io_dev);
 
     m_connectBtn->setText(tr("Disconnect"));
+    m_availableDevList->setCurrentIndex(m_connectionDevice.displayNumber);
     m_availableDevList->setEnabled(false);
 
     return true;
@@ -104,6 +104,7 @@ const char *const SAVEALL                 = "GCS.SaveAll";
 const char *const EXIT                    = "GCS.Exit";
 
 const char *const OPTIONS                 = "GCS.Options";
+const char *const DIAGNOSTICS             = "GCS.Diagnostics";
 const char *const TOGGLE_SIDEBAR          = "GCS.ToggleSidebar";
 const char *const TOGGLE_FULLSCREEN       = "GCS.ToggleFullScreen";
 
@@ -3,7 +3,7 @@ TARGET = Core
 
 DEFINES += CORE_LIBRARY
 
-QT += widgets qml quick xml network script svg sql
+QT += widgets qml quick quickwidgets xml network script svg sql concurrent
 
 include(../../plugin.pri)
 include(../../libs/utils/utils.pri)
@@ -43,6 +43,9 @@ SOURCES += \
     coreplugin.cpp \
     variablemanager.cpp \
     threadmanager.cpp \
+    framescheduler.cpp \
+    instrumentation.cpp \
+    diagnosticsdialog.cpp \
     modemanager.cpp \
     coreimpl.cpp \
     plugindialog.cpp \
@@ -99,6 +102,9 @@ HEADERS += \
     coreplugin.h \
     variablemanager.h \
     threadmanager.h \
+    framescheduler.h \
+    instrumentation.h \
+    diagnosticsdialog.h \
     modemanager.h \
     coreimpl.h \
     plugindialog.h \
@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ *
+ * @file       diagnosticsdialog.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief      The Core GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "diagnosticsdialog.h"
+#include "instrumentation.h"
+#include "threadmanager.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+using namespace Core;
+using namespace Core::Internal;
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent)
+    : QDialog(parent),
+    m_wasEnabled(Instrumentation::instance()->isEnabled())
+{
+    QVBoxLayout *vl = new QVBoxLayout(this);
+
+    m_memoryLabel = new QLabel(this);
+    vl->addWidget(m_memoryLabel);
+
+    m_threadsView = new QTreeWidget(this);
+    m_threadsView->setRootIsDecorated(false);
+    m_threadsView->setHeaderLabels(QStringList() << tr("Thread") << tr("Role") << tr("CPU %") << tr("CPU Time (s)"));
+    vl->addWidget(m_threadsView, 1);
+
+    m_ownersView = new QTreeWidget(this);
+    m_ownersView->setRootIsDecorated(false);
+    m_ownersView->setHeaderLabels(QStringList() << tr("Gadget / Owner") << tr("GUI Thread %") << tr("Events/s")
+                                                << tr("Queued Signals/s") << tr("Objects") << tr("Objects Growth"));
+    m_ownersView->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    vl->addWidget(m_ownersView, 3);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    vl->addWidget(buttons);
+
+    resize(700, 500);
+    setWindowTitle(tr("Diagnostics"));
+
+    Instrumentation::instance()->setEnabled(true);
+    // start the load windows now
+    ThreadManager::instance()->threadLoads();
+    Instrumentation::instance()->ownerStats();
+
+    connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+    m_refreshTimer.start(REFRESH_PERIOD_MS);
+    refresh();
+}
+
+DiagnosticsDialog::~DiagnosticsDialog()
+{
+    Instrumentation::instance()->setEnabled(m_wasEnabled);
+}
+
+void DiagnosticsDialog::refresh()
+{
+    qint64 memory = Instrumentation::residentMemory();
+    qint64 growth = Instrumentation::instance()->residentMemoryGrowth();
+
+    if (memory < 0) {
+        m_memoryLabel->setText(tr("Resident memory: unknown on this platform"));
+    } else {
+        m_memoryLabel->setText(tr("Resident memory: %0 MB (%1 MB since instrumented)")
+                               .arg(memory / (1024.0 * 1024.0), 0, 'f', 1)
+                               .arg(growth / (1024.0 * 1024.0), 0, 'f', 1));
+    }
+
+    m_threadsView->clear();
+    foreach(ThreadManager::ThreadLoad load, ThreadManager::instance()->threadLoads()) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(m_threadsView);
+        item->setText(0, load.name.isEmpty() ? load.role : load.name);
+        item->setText(1, load.role);
+        item->setText(2, QString::number(load.load * 100, 'f', 1));
+        item->setText(3, load.cpuTimeMs < 0 ? tr("unknown") : QString::number(load.cpuTimeMs / 1000.0, 'f', 1));
+    }
+
+    m_ownersView->clear();
+    foreach(Instrumentation::OwnerStats stats, Instrumentation::instance()->ownerStats()) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(m_ownersView);
+        item->setText(0, stats.owner);
+        item->setText(1, QString::number(stats.load * 100, 'f', 1));
+        item->setText(2, QString::number(stats.eventsPerSecond, 'f', 0));
+        item->setText(3, QString::number(stats.deliveriesPerSecond, 'f', 0));
+        if (stats.objects >= 0) {
+            item->setText(4, QString::number(stats.objects));
+            item->setText(5, QString::number(stats.objectsGrowth));
+        }
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ *
+ * @file       diagnosticsdialog.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief      The Core GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QTreeWidget;
+QT_END_NAMESPACE
+
+namespace Core {
+namespace Internal {
+/**
+ * Shows the CPU load of the GCS threads and what the gadgets cost on the GUI thread,
+ * see Instrumentation. The instrumentation is enabled while the dialog is open.
+ */
+class DiagnosticsDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsDialog(QWidget *parent);
+    ~DiagnosticsDialog();
+
+private slots:
+    void refresh();
+
+private:
+    static const int REFRESH_PERIOD_MS = 1000;
+
+    QLabel *m_memoryLabel;
+    QTreeWidget *m_threadsView;
+    QTreeWidget *m_ownersView;
+    QTimer m_refreshTimer;
+    bool m_wasEnabled;
+};
+} // namespace Internal
+} // namespace Core
+
+#endif // DIAGNOSTICSDIALOG_H
+
+/**
+ * @}
+ * @}
+ */
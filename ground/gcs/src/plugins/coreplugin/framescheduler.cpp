@@ -0,0 +1,149 @@
+/**
+ ******************************************************************************
+ *
+ * @file       framescheduler.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief      Delivers deferred QML notifications once per displayed frame
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "framescheduler.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtQuick/QQuickWindow>
+
+using namespace Core;
+
+FrameScheduler *FrameScheduler::m_instance = 0;
+
+FrameScheduler::FrameScheduler(QObject *parent) : QObject(parent), m_frameRequested(false)
+{
+    m_instance = this;
+    m_fallbackTimer.setSingleShot(true);
+    m_fallbackTimer.setTimerType(Qt::PreciseTimer);
+    m_fallbackTimer.setInterval(1000 / FALLBACK_RATE);
+    connect(&m_fallbackTimer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+FrameScheduler::~FrameScheduler()
+{
+    m_fallbackTimer.stop();
+    m_instance = 0;
+}
+
+/**
+ * Deliver the scheduled notifications in sync with the frames of a window.
+ * The window is automatically unregistered when destroyed.
+ */
+void FrameScheduler::addWindow(QQuickWindow *window)
+{
+    if (!window || m_windows.contains(window)) {
+        return;
+    }
+    m_windows.append(window);
+    // afterAnimating is emitted on the GUI thread right before the scene graph synchronization
+    // (beforeSynchronizing is emitted on the render thread and cannot be used to update QML items)
+    connect(window, SIGNAL(afterAnimating()), this, SLOT(flush()));
+    connect(window, SIGNAL(destroyed(QObject *)), this, SLOT(windowDestroyed(QObject *)));
+}
+
+void FrameScheduler::removeWindow(QQuickWindow *window)
+{
+    if (m_windows.removeOne(window)) {
+        disconnect(window, 0, this, 0);
+    }
+}
+
+void FrameScheduler::windowDestroyed(QObject *obj)
+{
+    // the window is already partially destroyed, only compare pointers
+    m_windows.removeOne(static_cast<QQuickWindow *>(obj));
+}
+
+/**
+ * Schedule the invocation of a slot of the receiver on the next frame.
+ * A receiver is invoked only once per frame however many times it is scheduled and must
+ * always be scheduled with the same slot. Can be called from any thread.
+ */
+void FrameScheduler::schedule(QObject *receiver, const char *member)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_scheduled.contains(receiver)) {
+        return;
+    }
+    m_scheduled.insert(receiver);
+    Notification notification;
+    notification.receiver = receiver;
+    notification.member   = member;
+    m_pending.append(notification);
+    if (!m_frameRequested) {
+        m_frameRequested = true;
+        QMetaObject::invokeMethod(this, "requestFrame", Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Schedule the notification if the frame scheduler is available, invoke it immediately otherwise.
+ */
+void FrameScheduler::post(QObject *receiver, const char *member)
+{
+    if (m_instance) {
+        m_instance->schedule(receiver, member);
+    } else {
+        QMetaObject::invokeMethod(receiver, member);
+    }
+}
+
+void FrameScheduler::requestFrame()
+{
+    // windows render only when something changed, make sure a frame is coming
+    foreach(QQuickWindow * window, m_windows) {
+        window->update();
+    }
+    // hidden windows do not render, the timer delivers the notifications if no frame comes in time
+    if (!m_fallbackTimer.isActive()) {
+        m_fallbackTimer.start();
+    }
+}
+
+/**
+ * Deliver all notifications scheduled since the last frame
+ */
+void FrameScheduler::flush()
+{
+    QVector<Notification> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pending.isEmpty()) {
+            return;
+        }
+        pending.swap(m_pending);
+        m_scheduled.clear();
+        m_frameRequested = false;
+    }
+    m_fallbackTimer.stop();
+    foreach(const Notification &notification, pending) {
+        if (notification.receiver) {
+            QMetaObject::invokeMethod(notification.receiver, notification.member);
+        }
+    }
+}
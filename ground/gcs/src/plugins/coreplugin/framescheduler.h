@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ *
+ * @file       framescheduler.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief      Delivers deferred QML notifications once per displayed frame
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include "core_global.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
+QT_BEGIN_NAMESPACE
+class QQuickWindow;
+QT_END_NAMESPACE
+
+namespace Core {
+/**
+ * Batches deferred notifications (typically UAVObject to QML property change signals)
+ * and delivers them once per frame of the registered QML windows.
+ *
+ * Notifications are delivered on the GUI thread when a registered window has finished its animations
+ * and is about to synchronize its scene graph, so that bindings are evaluated at most once per
+ * displayed frame. When no frame is rendered in time (no window registered or all hidden) a timer is used instead.
+ */
+class CORE_EXPORT FrameScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    static const int FALLBACK_RATE = 30;
+
+    FrameScheduler(QObject *parent);
+    ~FrameScheduler();
+
+    static FrameScheduler *instance()
+    {
+        return m_instance;
+    }
+
+    void addWindow(QQuickWindow *window);
+    void removeWindow(QQuickWindow *window);
+
+    void schedule(QObject *receiver, const char *member);
+
+    static void post(QObject *receiver, const char *member);
+
+private slots:
+    void requestFrame();
+    void flush();
+    void windowDestroyed(QObject *obj);
+
+private:
+    struct Notification {
+        QPointer<QObject> receiver;
+        const char *member;
+    };
+
+    QList<QQuickWindow *> m_windows;
+    QTimer m_fallbackTimer;
+
+    QMutex m_mutex;
+    QVector<Notification> m_pending;
+    QSet<QObject *> m_scheduled;
+    bool m_frameRequested;
+
+    static FrameScheduler *m_instance;
+};
+} // namespace Core
+
+#endif // FRAMESCHEDULER_H
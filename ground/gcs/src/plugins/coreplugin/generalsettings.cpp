@@ -33,6 +33,7 @@
 
 #include <utils/stylehelper.h>
 #include <utils/qtcolorbutton.h>
+#include <utils/quickwidgetproxy.h>
 #include <coreplugin/icore.h>
 
 #include <QMessageBox>
@@ -48,7 +49,16 @@ GeneralSettings::GeneralSettings() :
     m_autoConnect(true),
     m_autoSelect(true),
     m_useUDPMirror(false),
+    m_udpMirrorBatched(false),
+    m_udpMirrorCompressed(false),
+    m_udpMirrorHost(QLatin1String("127.0.0.1")),
+    m_udpMirrorPort(9000),
+    m_uavTalkV2(false),
+    m_uavTalkDelta(false),
+    m_telemetryServer(false),
+    m_telemetryServerPort(9001),
     m_useExpertMode(false),
+    m_useQmlWindows(false),
     m_collectUsageData(true),
     m_showUsageDataDisclaimer(true),
     m_dialog(0)
@@ -127,6 +137,7 @@ QWidget *GeneralSettings::createPage(QWidget *parent)
     m_page->checkAutoSelect->setChecked(m_autoSelect);
     m_page->cbUseUDPMirror->setChecked(m_useUDPMirror);
     m_page->cbExpertMode->setChecked(m_useExpertMode);
+    m_page->cbQmlWindows->setChecked(m_useQmlWindows);
     m_page->cbUsageData->setChecked(m_collectUsageData);
     m_page->colorButton->setColor(StyleHelper::baseColor());
 
@@ -146,8 +157,11 @@ void GeneralSettings::apply()
     m_saveSettingsOnExit = m_page->checkBoxSaveOnExit->isChecked();
     m_useUDPMirror  = m_page->cbUseUDPMirror->isChecked();
     m_useExpertMode = m_page->cbExpertMode->isChecked();
+    m_useQmlWindows = m_page->cbQmlWindows->isChecked();
     m_autoConnect   = m_page->checkAutoConnect->isChecked();
     m_autoSelect    = m_page->checkAutoSelect->isChecked();
+    // only affects the QML gadgets created from now on
+    QuickWidgetProxy::setUseWindowContainer(m_useQmlWindows);
     setCollectUsageData(m_page->cbUsageData->isChecked());
 }
 
@@ -164,11 +178,22 @@ void GeneralSettings::readSettings(QSettings &settings)
     m_autoConnect        = settings.value(QLatin1String("AutoConnect"), m_autoConnect).toBool();
     m_autoSelect         = settings.value(QLatin1String("AutoSelect"), m_autoSelect).toBool();
     m_useUDPMirror       = settings.value(QLatin1String("UDPMirror"), m_useUDPMirror).toBool();
+    m_udpMirrorBatched   = settings.value(QLatin1String("UDPMirrorBatched"), m_udpMirrorBatched).toBool();
+    m_udpMirrorCompressed = settings.value(QLatin1String("UDPMirrorCompressed"), m_udpMirrorCompressed).toBool();
+    m_udpMirrorHost      = settings.value(QLatin1String("UDPMirrorHost"), m_udpMirrorHost).toString();
+    m_udpMirrorPort      = settings.value(QLatin1String("UDPMirrorPort"), m_udpMirrorPort).toUInt();
+    m_uavTalkV2          = settings.value(QLatin1String("UAVTalkV2"), m_uavTalkV2).toBool();
+    m_uavTalkDelta       = settings.value(QLatin1String("UAVTalkDelta"), m_uavTalkDelta).toBool();
+    m_telemetryServer    = settings.value(QLatin1String("TelemetryServer"), m_telemetryServer).toBool();
+    m_telemetryServerPort = settings.value(QLatin1String("TelemetryServerPort"), m_telemetryServerPort).toUInt();
     m_useExpertMode      = settings.value(QLatin1String("ExpertMode"), m_useExpertMode).toBool();
+    m_useQmlWindows      = settings.value(QLatin1String("QmlWindows"), m_useQmlWindows).toBool();
     m_collectUsageData   = settings.value(QLatin1String("CollectUsageData"), m_collectUsageData).toBool();
     m_showUsageDataDisclaimer = settings.value(QLatin1String("ShowUsageDataDisclaimer"), m_showUsageDataDisclaimer).toBool();
     m_lastUsageHash      = settings.value(QLatin1String("LastUsageHash"), m_lastUsageHash).toString();
     settings.endGroup();
+
+    QuickWidgetProxy::setUseWindowContainer(m_useQmlWindows);
 }
 
 void GeneralSettings::saveSettings(QSettings &settings) const
@@ -185,7 +210,16 @@ void GeneralSettings::saveSettings(QSettings &settings) const
     settings.setValue(QLatin1String("AutoConnect"), m_autoConnect);
     settings.setValue(QLatin1String("AutoSelect"), m_autoSelect);
     settings.setValue(QLatin1String("UDPMirror"), m_useUDPMirror);
+    settings.setValue(QLatin1String("UDPMirrorBatched"), m_udpMirrorBatched);
+    settings.setValue(QLatin1String("UDPMirrorCompressed"), m_udpMirrorCompressed);
+    settings.setValue(QLatin1String("UDPMirrorHost"), m_udpMirrorHost);
+    settings.setValue(QLatin1String("UDPMirrorPort"), m_udpMirrorPort);
+    settings.setValue(QLatin1String("UAVTalkV2"), m_uavTalkV2);
+    settings.setValue(QLatin1String("UAVTalkDelta"), m_uavTalkDelta);
+    settings.setValue(QLatin1String("TelemetryServer"), m_telemetryServer);
+    settings.setValue(QLatin1String("TelemetryServerPort"), m_telemetryServerPort);
     settings.setValue(QLatin1String("ExpertMode"), m_useExpertMode);
+    settings.setValue(QLatin1String("QmlWindows"), m_useQmlWindows);
     settings.setValue(QLatin1String("CollectUsageData"), m_collectUsageData);
     settings.setValue(QLatin1String("ShowUsageDataDisclaimer"), m_showUsageDataDisclaimer);
     settings.setValue(QLatin1String("LastUsageHash"), m_lastUsageHash);
@@ -259,6 +293,46 @@ bool GeneralSettings::useUDPMirror() const
     return m_useUDPMirror;
 }
 
+bool GeneralSettings::udpMirrorBatched() const
+{
+    return m_udpMirrorBatched;
+}
+
+bool GeneralSettings::udpMirrorCompressed() const
+{
+    return m_udpMirrorCompressed;
+}
+
+QString GeneralSettings::udpMirrorHost() const
+{
+    return m_udpMirrorHost;
+}
+
+quint16 GeneralSettings::udpMirrorPort() const
+{
+    return m_udpMirrorPort;
+}
+
+bool GeneralSettings::uavTalkV2() const
+{
+    return m_uavTalkV2;
+}
+
+bool GeneralSettings::uavTalkDelta() const
+{
+    return m_uavTalkDelta;
+}
+
+bool GeneralSettings::useTelemetryServer() const
+{
+    return m_telemetryServer;
+}
+
+quint16 GeneralSettings::telemetryServerPort() const
+{
+    return m_telemetryServerPort;
+}
+
 bool GeneralSettings::collectUsageData() const
 {
     return m_collectUsageData;
@@ -279,6 +353,11 @@ bool GeneralSettings::useExpertMode() const
     return m_useExpertMode;
 }
 
+bool GeneralSettings::useQmlWindows() const
+{
+    return m_useQmlWindows;
+}
+
 void GeneralSettings::setCollectUsageData(bool collect)
 {
     if (collect && collect != m_collectUsageData) {
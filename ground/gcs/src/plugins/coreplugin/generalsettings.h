@@ -59,12 +59,21 @@ public:
     bool autoConnect() const;
     bool autoSelect() const;
     bool useUDPMirror() const;
+    bool udpMirrorBatched() const;
+    bool udpMirrorCompressed() const;
+    QString udpMirrorHost() const;
+    quint16 udpMirrorPort() const;
+    bool uavTalkV2() const;
+    bool uavTalkDelta() const;
+    bool useTelemetryServer() const;
+    quint16 telemetryServerPort() const;
     bool collectUsageData() const;
     bool showUsageDataDisclaimer() const;
     QString lastUsageHash() const;
     void readSettings(QSettings &settings);
     void saveSettings(QSettings &settings) const;
     bool useExpertMode() const;
+    bool useQmlWindows() const;
     void setCollectUsageData(bool collect);
     void setShowUsageDataDisclaimer(bool show);
     void setLastUsageHash(QString hash);
@@ -85,7 +94,16 @@ private:
     bool m_autoConnect;
     bool m_autoSelect;
     bool m_useUDPMirror;
+    bool m_udpMirrorBatched;
+    bool m_udpMirrorCompressed;
+    QString m_udpMirrorHost;
+    quint16 m_udpMirrorPort;
+    bool m_uavTalkV2;
+    bool m_uavTalkDelta;
+    bool m_telemetryServer;
+    quint16 m_telemetryServerPort;
     bool m_useExpertMode;
+    bool m_useQmlWindows;
     bool m_collectUsageData;
     bool m_showUsageDataDisclaimer;
     QString m_lastUsageHash;
@@ -0,0 +1,290 @@
+/**
+ ******************************************************************************
+ *
+ * @file       instrumentation.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief      The Core GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "instrumentation.h"
+#include "icore.h"
+#include "iuavgadget.h"
+#include "iuavgadgetconfiguration.h"
+#include "uavgadgetinstancemanager.h"
+
+#include <QtCore/QAbstractEventDispatcher>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QFile>
+#include <QtCore/QSettings>
+
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+using namespace Core;
+
+Instrumentation *Instrumentation::m_instance = 0;
+
+static bool loadGreater(const Instrumentation::OwnerStats &a, const Instrumentation::OwnerStats &b)
+{
+    return a.load > b.load;
+}
+
+Instrumentation::Instrumentation(QObject *parent) : QObject(parent),
+    m_enabled(false), m_sampleStartNs(0), m_sliceStartNs(0), m_sliceOwner(0), m_baseResidentMemory(-1)
+{
+    m_instance = this;
+    m_eventLoop.name = tr("Event loop");
+
+    m_gadgetsTimer.setInterval(GADGETS_UPDATE_PERIOD_MS);
+    connect(&m_gadgetsTimer, &QTimer::timeout, this, &Instrumentation::updateGadgets);
+
+    QSettings settings;
+    setEnabled(settings.value("Instrumentation/Enabled", false).toBool());
+}
+
+Instrumentation::~Instrumentation()
+{
+    setEnabled(false);
+    m_instance = 0;
+}
+
+void Instrumentation::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled) {
+        return;
+    }
+    m_enabled = enabled;
+
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance(thread());
+    if (enabled) {
+        m_clock.start();
+        m_sampleStartNs = 0;
+        m_sliceStartNs  = 0;
+        m_sliceOwner    = &m_eventLoop;
+        m_baseResidentMemory = residentMemory();
+        // the gadgets are looked up from the event loop, enabled from the start there are none yet
+        m_gadgetsTimer.start();
+        if (dispatcher) {
+            connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this, &Instrumentation::aboutToBlock);
+            connect(dispatcher, &QAbstractEventDispatcher::awake, this, &Instrumentation::awake);
+        }
+        QCoreApplication::instance()->installEventFilter(this);
+    } else {
+        QCoreApplication::instance()->removeEventFilter(this);
+        if (dispatcher) {
+            disconnect(dispatcher, 0, this, 0);
+        }
+        m_gadgetsTimer.stop();
+        m_sliceOwner = 0;
+        qDeleteAll(m_gadgets);
+        m_gadgets.clear();
+        qDeleteAll(m_classes);
+        m_classes.clear();
+        m_eventLoop.timeNs = 0;
+    }
+}
+
+/**
+ * Charge the time since the previous event to its receiver owner
+ */
+void Instrumentation::closeSlice()
+{
+    qint64 now = m_clock.nsecsElapsed();
+
+    if (m_sliceOwner) {
+        m_sliceOwner->timeNs += now - m_sliceStartNs;
+    }
+    m_sliceStartNs = now;
+}
+
+Instrumentation::Owner *Instrumentation::ownerOf(QObject *obj)
+{
+    QObject *top = obj;
+
+    for (QObject *o = obj; o; o = o->parent()) {
+        Owner *owner = m_gadgets.value(o);
+        if (owner) {
+            return owner;
+        }
+        top = o;
+    }
+
+    // the class names are static strings, no allocation per event
+    Owner * &owner = m_classes[top->metaObject()->className()];
+    if (!owner) {
+        owner = new Owner;
+        owner->name = QLatin1String(top->metaObject()->className());
+    }
+    return owner;
+}
+
+/**
+ * Called by the application for each event delivered on the GUI thread
+ */
+bool Instrumentation::eventFilter(QObject *obj, QEvent *event)
+{
+    closeSlice();
+
+    Owner *owner = ownerOf(obj);
+    ++owner->events;
+    if (event->type() == QEvent::MetaCall) {
+        ++owner->deliveries;
+    }
+    m_sliceOwner = owner;
+
+    return false;
+}
+
+void Instrumentation::aboutToBlock()
+{
+    // idle time is charged to nobody
+    closeSlice();
+    m_sliceOwner = 0;
+}
+
+void Instrumentation::awake()
+{
+    m_sliceStartNs = m_clock.nsecsElapsed();
+    m_sliceOwner   = &m_eventLoop;
+}
+
+/**
+ * Map the widgets of the current gadgets to their owners, keeping the counters of the remaining ones
+ */
+void Instrumentation::updateGadgets()
+{
+    UAVGadgetInstanceManager *instanceManager = ICore::instance() ? ICore::instance()->uavGadgetInstanceManager() : 0;
+
+    if (!instanceManager) {
+        return;
+    }
+
+    QHash<QObject *, Owner *> gadgets;
+    foreach(IUAVGadget * gadget, instanceManager->gadgets()) {
+        QWidget *widget = gadget->widget();
+        if (!widget) {
+            continue;
+        }
+        Owner *owner = m_gadgets.take(widget);
+        if (!owner || owner->widget != widget) {
+            delete owner;
+            owner = new Owner;
+            owner->widget = widget;
+        }
+        owner->name = instanceManager->gadgetName(gadget->classId());
+        if (gadget->activeConfiguration()) {
+            owner->name += QString(" (%1)").arg(gadget->activeConfiguration()->name());
+        }
+        gadgets.insert(widget, owner);
+    }
+
+    // the removed gadgets
+    foreach(Owner * owner, m_gadgets) {
+        if (m_sliceOwner == owner) {
+            closeSlice();
+            m_sliceOwner = &m_eventLoop;
+        }
+        delete owner;
+    }
+    m_gadgets = gadgets;
+}
+
+/**
+ * The owners statistics since the previous call, by decreasing load
+ */
+QList<Instrumentation::OwnerStats> Instrumentation::ownerStats()
+{
+    QList<OwnerStats> stats;
+
+    if (!m_enabled) {
+        return stats;
+    }
+
+    closeSlice();
+    updateGadgets();
+
+    qint64 now     = m_clock.nsecsElapsed();
+    double elapsed = qMax(now - m_sampleStartNs, (qint64)1);
+    m_sampleStartNs = now;
+
+    QList<Owner *> owners = m_gadgets.values() + m_classes.values();
+    owners << &m_eventLoop;
+    foreach(Owner * owner, owners) {
+        OwnerStats stat;
+        stat.owner  = owner->name;
+        stat.load   = owner->timeNs / elapsed;
+        stat.eventsPerSecond     = owner->events * 1e9 / elapsed;
+        stat.deliveriesPerSecond = owner->deliveries * 1e9 / elapsed;
+        stat.objects = -1;
+        stat.objectsGrowth = 0;
+        if (owner->widget) {
+            stat.objects = owner->widget->findChildren<QObject *>().size() + 1;
+            if (owner->baseObjects < 0) {
+                owner->baseObjects = stat.objects;
+            }
+            stat.objectsGrowth = stat.objects - owner->baseObjects;
+        }
+        owner->timeNs     = 0;
+        owner->events     = 0;
+        owner->deliveries = 0;
+        // the gadgets are always listed, the other owners when active
+        if (owner->widget || stat.load > 0 || stat.eventsPerSecond > 0) {
+            stats << stat;
+        }
+    }
+    std::sort(stats.begin(), stats.end(), loadGreater);
+    return stats;
+}
+
+qint64 Instrumentation::residentMemory()
+{
+#if defined(Q_OS_LINUX)
+    // size and resident pages
+    QFile statm(QLatin1String("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return -1;
+}
+
+qint64 Instrumentation::residentMemoryGrowth() const
+{
+    qint64 memory = residentMemory();
+
+    if (memory < 0 || m_baseResidentMemory < 0) {
+        return -1;
+    }
+    return memory - m_baseResidentMemory;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ *
+ * @file       instrumentation.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief      The Core GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "core_global.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QHash>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+#include <QWidget>
+
+namespace Core {
+/**
+ * Attributes the GUI thread cost to the gadgets, for the long sessions where memory
+ * and CPU use creep: the time spent delivering events, the number of events, of queued
+ * signal deliveries (the UAVObject updates from the telemetry threads) and of live objects.
+ *
+ * An application event filter sees every event delivered on the GUI thread, the time up to
+ * the next event, or to the event loop going idle, is charged to the receiver owner: the gadget
+ * whose widget is an ancestor of the receiver, else the class of the receiver top level ancestor.
+ * Nested events are charged to the innermost receiver.
+ *
+ * Disabled by default, it is enabled while the diagnostics are shown or from the start with
+ * the "Instrumentation/Enabled" setting.
+ */
+class CORE_EXPORT Instrumentation : public QObject {
+    Q_OBJECT
+
+public:
+    struct OwnerStats {
+        QString owner;
+        // share of the GUI thread time, since the previous call to ownerStats()
+        double  load;
+        double  eventsPerSecond;
+        double  deliveriesPerSecond;
+        // live objects of the gadget and their growth since enabled, -1 if not a gadget
+        int     objects;
+        int     objectsGrowth;
+    };
+
+    Instrumentation(QObject *parent);
+    ~Instrumentation();
+
+    static Instrumentation *instance()
+    {
+        return m_instance;
+    }
+
+    bool isEnabled() const
+    {
+        return m_enabled;
+    }
+    void setEnabled(bool enabled);
+
+    QList<OwnerStats> ownerStats();
+
+    // resident memory of the process in bytes, and its growth since enabled, -1 if unknown on this platform
+    static qint64 residentMemory();
+    qint64 residentMemoryGrowth() const;
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event);
+
+private slots:
+    void aboutToBlock();
+    void awake();
+
+private:
+    struct Owner {
+        Owner() : timeNs(0), events(0), deliveries(0), baseObjects(-1) {}
+        QString name;
+        qint64  timeNs;
+        quint32 events;
+        quint32 deliveries;
+        // the gadget widget, null for the other owners
+        QPointer<QWidget> widget;
+        int     baseObjects;
+    };
+
+    Owner *ownerOf(QObject *obj);
+    void closeSlice();
+    void updateGadgets();
+
+    // gadgets come and go, their widgets are looked up again periodically
+    static const int GADGETS_UPDATE_PERIOD_MS = 2000;
+
+    bool m_enabled;
+    QTimer m_gadgetsTimer;
+    QElapsedTimer m_clock;
+    qint64 m_sampleStartNs;
+    qint64 m_sliceStartNs;
+    Owner *m_sliceOwner;
+    Owner m_eventLoop;
+    // by gadget widget, and by top level class name (static strings)
+    QHash<QObject *, Owner *> m_gadgets;
+    QHash<const char *, Owner *> m_classes;
+    qint64 m_baseResidentMemory;
+    static Instrumentation *m_instance;
+};
+} // namespace Core
+
+#endif // INSTRUMENTATION_H
+
+/**
+ * @}
+ * @}
+ */
@@ -41,6 +41,7 @@
 #include "mimedatabase.h"
 #include "outputpane.h"
 #include "plugindialog.h"
+#include "diagnosticsdialog.h"
 #include "shortcutsettings.h"
 #include "uavgadgetmanager.h"
 #include "uavgadgetinstancemanager.h"
@@ -56,6 +57,8 @@
 
 #include "settingsdialog.h"
 #include "threadmanager.h"
+#include "framescheduler.h"
+#include "instrumentation.h"
 #include "uniqueidmanager.h"
 #include "variablemanager.h"
 
@@ -109,10 +112,13 @@ MainWindow::MainWindow() :
     m_actionManager(new ActionManagerPrivate(this)),
     m_variableManager(new VariableManager(this)),
     m_threadManager(new ThreadManager(this)),
+    m_frameScheduler(new FrameScheduler(this)),
+    m_instrumentation(new Instrumentation(this)),
     m_modeManager(0),
     m_connectionManager(0),
     m_mimeDatabase(new MimeDatabase),
     m_aboutDialog(0),
+    m_diagnosticsDialog(0),
     m_activeContext(0),
     m_generalSettings(new GeneralSettings),
     m_shortcutSettings(new ShortcutSettings),
@@ -227,6 +233,10 @@ bool MainWindow::init(QString *errorMessage)
     pm->addObject(m_shortcutSettings);
     pm->addObject(m_workspaceSettings);
 
+    // the modes of the dependent plugins create their QML views before extensionsInitialized()
+    QSettings settings;
+    m_generalSettings->readSettings(settings);
+
     return true;
 }
 
@@ -639,6 +649,12 @@ void MainWindow::registerDefaultActions()
     mtools->addAction(cmd, Constants::G_DEFAULT_THREE);
     connect(m_optionsAction, SIGNAL(triggered()), this, SLOT(showOptionsDialog()));
 
+    // Diagnostics Action
+    tmpaction = new QAction(tr("&Diagnostics..."), this);
+    cmd = am->registerAction(tmpaction, Constants::DIAGNOSTICS, m_globalContext);
+    mtools->addAction(cmd, Constants::G_DEFAULT_THREE);
+    connect(tmpaction, SIGNAL(triggered()), this, SLOT(showDiagnostics()));
+
 #ifdef Q_WS_MAC
     // Minimize Action
     m_minimizeAction = new QAction(tr("Minimize"), this);
@@ -1026,11 +1042,11 @@ void MainWindow::createWorkspaces(QSettings &settings, bool diffOnly)
 
     // If diffOnly is true, we only add/remove the number of workspaces
     // that has changed,
-    // otherwise a complete reload of workspaces is done
+    // otherwise the workspaces which are kept also reload their layout
     int toRemoveFirst   = m_uavGadgetManagers.count();
     int newWorkspacesNo = m_workspaceSettings->numberOfWorkspaces();
 
-    if (diffOnly && m_uavGadgetManagers.count() > newWorkspacesNo) {
+    if (m_uavGadgetManagers.count() > newWorkspacesNo) {
         toRemoveFirst = m_uavGadgetManagers.count() - newWorkspacesNo;
     } else {
         toRemoveFirst = 0;
@@ -1047,12 +1063,16 @@ void MainWindow::createWorkspaces(QSettings &settings, bool diffOnly)
         removed++;
     }
 
-    int start = 0;
-    if (diffOnly) {
-        start = m_uavGadgetManagers.count();
-    } else {
-        m_uavGadgetManagers.clear();
+    if (!diffOnly) {
+        // A workspace only rebuilds its gadgets if its layout changed
+        for (int i = 0; i < m_uavGadgetManagers.count(); ++i) {
+            uavGadgetManager = m_uavGadgetManagers.at(i);
+            m_modeManager->updateModeNameIcon(uavGadgetManager, QIcon(m_workspaceSettings->iconName(i)),
+                                              m_workspaceSettings->name(i));
+            uavGadgetManager->readSettings(settings);
+        }
     }
+    int start = m_uavGadgetManagers.count();
 
     QElapsedTimer totalTimer;
     totalTimer.start();
@@ -1327,6 +1347,24 @@ void MainWindow::destroyAboutDialog()
     }
 }
 
+void MainWindow::showDiagnostics()
+{
+    if (!m_diagnosticsDialog) {
+        m_diagnosticsDialog = new DiagnosticsDialog(this);
+        connect(m_diagnosticsDialog, SIGNAL(finished(int)),
+                this, SLOT(destroyDiagnosticsDialog()));
+    }
+    m_diagnosticsDialog->show();
+}
+
+void MainWindow::destroyDiagnosticsDialog()
+{
+    if (m_diagnosticsDialog) {
+        m_diagnosticsDialog->deleteLater();
+        m_diagnosticsDialog = 0;
+    }
+}
+
 void MainWindow::aboutPlugins()
 {
     PluginDialog dialog(this);
@@ -60,6 +60,8 @@ class SettingsDatabase;
 class UniqueIDManager;
 class VariableManager;
 class ThreadManager;
+class FrameScheduler;
+class Instrumentation;
 class ViewManagerInterface;
 class UAVGadgetManager;
 class UAVGadgetInstanceManager;
@@ -71,6 +73,7 @@ class CoreImpl;
 class GeneralSettings;
 class ShortcutSettings;
 class WorkspaceSettings;
+class DiagnosticsDialog;
 
 class CORE_EXPORT MainWindow : public EventFilteringMainWindow {
     Q_OBJECT
@@ -153,6 +156,8 @@ private slots:
     void showAboutDialog();
     void destroyAboutDialog();
     void aboutPlugins();
+    void showDiagnostics();
+    void destroyDiagnosticsDialog();
     void updateFocusWidget(QWidget *old, QWidget *now);
     void modeChanged(Core::IMode *mode);
     void showUavGadgetMenus(bool show, bool hasSplitter);
@@ -176,6 +181,8 @@ private:
     MessageManager *m_messageManager;
     VariableManager *m_variableManager;
     ThreadManager *m_threadManager;
+    FrameScheduler *m_frameScheduler;
+    Instrumentation *m_instrumentation;
     ModeManager *m_modeManager;
     QList<UAVGadgetManager *> m_uavGadgetManagers;
     UAVGadgetInstanceManager *m_uavGadgetInstanceManager;
@@ -184,6 +191,7 @@ private:
     MyTabWidget *m_modeStack;
     Core::BaseView *m_outputView;
     AboutDialog *m_aboutDialog;
+    DiagnosticsDialog *m_diagnosticsDialog;
 
     IContext *m_activeContext;
 
@@ -39,7 +39,7 @@ using namespace Core;
 MessageManager *MessageManager::m_instance = 0;
 
 MessageManager::MessageManager()
-    : m_messageOutputWindow(0)
+    : m_messageOutputWindow(0), m_flushPending(false)
 {
     m_instance = this;
 }
@@ -83,7 +83,21 @@ void MessageManager::printToOutputPane(const QString &text, bool bringToForegrou
     if (bringToForeground) {
         m_messageOutputWindow->popup(false);
     }
-    m_messageOutputWindow->append(text);
+    // the output pane is updated once per event loop cycle
+    m_pendingText << text;
+    if (!m_flushPending) {
+        m_flushPending = true;
+        QMetaObject::invokeMethod(this, "flushOutputPane", Qt::QueuedConnection);
+    }
+}
+
+void MessageManager::flushOutputPane()
+{
+    m_flushPending = false;
+    if (m_messageOutputWindow) {
+        m_messageOutputWindow->append(m_pendingText);
+    }
+    m_pendingText.clear();
 }
 
 void MessageManager::printToOutputPanePopup(const QString &text)
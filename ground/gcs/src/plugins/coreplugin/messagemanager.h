@@ -31,6 +31,7 @@
 
 #include "core_global.h"
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
 
 namespace Core {
 namespace Internal {
@@ -59,8 +60,14 @@ public slots:
     void printToOutputPanePopup(const QString &text); // pops up
     void printToOutputPane(const QString &text);
 
+private slots:
+    void flushOutputPane();
+
 private:
     Internal::MessageOutputWindow *m_messageOutputWindow;
+    // text printed during the current event loop cycle
+    QStringList m_pendingText;
+    bool m_flushPending;
 
     static MessageManager *m_instance;
 };
@@ -28,15 +28,21 @@
 
 #include "messageoutputwindow.h"
 
-#include <QTextEdit>
+#include <QPlainTextEdit>
+#include <QTextCursor>
+#include <QPair>
 
 using namespace Core::Internal;
 
-MessageOutputWindow::MessageOutputWindow()
+/*
+ * QPlainTextEdit lays out only the visible lines, so it stays fast with a very long output
+ */
+MessageOutputWindow::MessageOutputWindow() : m_lastCount(0)
 {
-    m_widget = new QTextEdit;
+    m_widget = new QPlainTextEdit;
     m_widget->setReadOnly(true);
     m_widget->setFrameStyle(QFrame::NoFrame);
+    m_widget->setMaximumBlockCount(MAX_LINES);
 }
 
 MessageOutputWindow::~MessageOutputWindow()
@@ -62,6 +68,7 @@ void MessageOutputWindow::setFocus()
 void MessageOutputWindow::clearContents()
 {
     m_widget->clear();
+    m_lastCount = 0;
 }
 
 QWidget *MessageOutputWindow::outputWidget(QWidget *parent)
@@ -80,7 +87,50 @@ void MessageOutputWindow::visibilityChanged(bool /*b*/)
 
 void MessageOutputWindow::append(const QString &text)
 {
-    m_widget->append(text);
+    append(QStringList(text));
+}
+
+void MessageOutputWindow::append(const QStringList &lines)
+{
+    // collapse the runs of identical lines, the lines with line breaks are never counted
+    QList<QPair<QString, int> > runs;
+
+    foreach(const QString &line, lines) {
+        if (!runs.isEmpty() && runs.last().first == line && !line.contains(QLatin1Char('\n'))) {
+            runs.last().second++;
+        } else {
+            runs << qMakePair(line, 1);
+        }
+    }
+    if (runs.isEmpty()) {
+        return;
+    }
+
+    if (m_lastCount > 0 && runs.first().first == m_lastLine) {
+        // the line shown last repeats, update its count
+        QTextCursor cursor(m_widget->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
+        m_lastCount += runs.takeFirst().second;
+        cursor.insertText(repeated(m_lastLine, m_lastCount));
+        if (runs.isEmpty()) {
+            return;
+        }
+    }
+
+    QStringList text;
+    for (int i = 0; i < runs.count(); i++) {
+        text << repeated(runs.at(i).first, runs.at(i).second);
+    }
+    m_widget->appendPlainText(text.join(QLatin1Char('\n')));
+
+    m_lastLine  = runs.last().first;
+    m_lastCount = m_lastLine.contains(QLatin1Char('\n')) ? 0 : runs.last().second;
+}
+
+QString MessageOutputWindow::repeated(const QString &line, int count)
+{
+    return (count > 1) ? line + QLatin1Char(' ') + QChar(0x00D7) + QString::number(count) : line;
 }
 
 int MessageOutputWindow::priorityInStatusBar() const
@@ -31,8 +31,10 @@
 
 #include <coreplugin/ioutputpane.h>
 
+#include <QStringList>
+
 QT_BEGIN_NAMESPACE
-class QTextEdit;
+class QPlainTextEdit;
 QT_END_NAMESPACE
 
 namespace Core {
@@ -56,6 +58,8 @@ public:
     void visibilityChanged(bool visible);
 
     void append(const QString &text);
+    // repeated lines are shown once, followed by their count
+    void append(const QStringList &lines);
     bool canFocus();
     bool hasFocus();
     void setFocus();
@@ -67,7 +71,14 @@ public:
     bool canNavigate();
 
 private:
-    QTextEdit *m_widget;
+    static const int MAX_LINES = 500000;
+
+    static QString repeated(const QString &line, int count);
+
+    QPlainTextEdit *m_widget;
+    // last line shown and how many times in a row, 0 when it can't be counted
+    QString m_lastLine;
+    int m_lastCount;
 };
 } // namespace Internal
 } // namespace Core
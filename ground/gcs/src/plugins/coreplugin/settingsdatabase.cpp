@@ -30,9 +30,12 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QMap>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QTimer>
 #include <QtCore/QVariant>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlError>
@@ -48,6 +51,10 @@
     is asked for. It also does incremental updates of the database rather than
     rewriting the whole file each time one of the settings change.
 
+    Changes are applied to an in-memory cache right away and written out
+    later, in a single transaction on a worker thread. Call sync() to force
+    pending changes to disk; the destructor does so as well.
+
     The SettingsDatabase API mimics that of QSettings.
  */
 
@@ -56,6 +63,9 @@ using namespace Core::Internal;
 
 enum { debug_settings = 0 };
 
+// Delay after the last change before dirty keys are written out
+static const int FLUSH_DELAY = 500;
+
 namespace Core {
 namespace Internal {
 typedef QMap<QString, QVariant> SettingsMap;
@@ -78,13 +88,73 @@ public:
         return g;
     }
 
+    static bool matchesKey(const QString &k, const QString &key)
+    {
+        // Either it's an exact match, or it matches up to a /
+        return k.startsWith(key)
+               && (k.length() == key.length() || k.at(key.length()) == QLatin1Char('/'));
+    }
+
+    static void writeChanges(const QString &fileName, const QStringList &removedKeys, const SettingsMap &changes);
+
     SettingsMap m_settings;
 
     QStringList m_groups;
-    QStringList m_dirtyKeys;
+    QSet<QString> m_dirtyKeys;
+    QStringList m_removedKeys;
 
+    QString m_fileName;
     QSqlDatabase m_db;
+    QTimer m_flushTimer;
+    QFuture<void> m_flush;
 };
+
+/**
+ * Runs on a worker thread, so it uses a connection of its own. Removals
+ * are applied first as a key may have been removed and then set again.
+ */
+void SettingsDatabasePrivate::writeChanges(const QString &fileName, const QStringList &removedKeys, const SettingsMap &changes)
+{
+    const QString connectionName = QLatin1String("settingsWriter");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(fileName);
+        db.setConnectOptions(QLatin1String("QSQLITE_BUSY_TIMEOUT=5000"));
+        if (!db.open()) {
+            qWarning().nospace() << "Warning: Failed to open settings database at " << fileName << " ("
+                                 << db.lastError().driverText() << ")";
+        } else {
+            db.transaction();
+
+            QSqlQuery query(db);
+            query.prepare(QLatin1String("DELETE FROM settings WHERE key = ? OR key LIKE ?"));
+            foreach(const QString &key, removedKeys) {
+                query.addBindValue(key);
+                query.addBindValue(QString(key + QLatin1String("/%")));
+                query.exec();
+            }
+
+            query.prepare(QLatin1String("INSERT INTO settings VALUES (?, ?)"));
+            QMapIterator<QString, QVariant> i(changes);
+            while (i.hasNext()) {
+                i.next();
+                query.addBindValue(i.key());
+                query.addBindValue(i.value());
+                query.exec();
+
+                if (debug_settings) {
+                    qDebug() << "Stored:" << i.key() << "=" << i.value();
+                }
+            }
+
+            if (!db.commit()) {
+                qWarning().nospace() << "Warning: Failed to write settings database! ("
+                                     << db.lastError().driverText() << ")";
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
 } // namespace Internal
 } // namespace Core
 
@@ -110,8 +180,14 @@ SettingsDatabase::SettingsDatabase(const QString &path,
     fileName += application;
     fileName += QLatin1String(".db");
 
-    d->m_db   = QSqlDatabase::addDatabase("QSQLITE", QLatin1String("settings"));
+    d->m_fileName = fileName;
+    d->m_flushTimer.setSingleShot(true);
+    d->m_flushTimer.setInterval(FLUSH_DELAY);
+    connect(&d->m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+
+    d->m_db = QSqlDatabase::addDatabase("QSQLITE", QLatin1String("settings"));
     d->m_db.setDatabaseName(fileName);
+    d->m_db.setConnectOptions(QLatin1String("QSQLITE_BUSY_TIMEOUT=5000"));
     if (!d->m_db.open()) {
         qWarning().nospace() << "Warning: Failed to open settings database at " << fileName << " ("
                              << d->m_db.lastError().driverText() << ")";
@@ -154,16 +230,9 @@ void SettingsDatabase::setValue(const QString &key, const QVariant &value)
         return;
     }
 
-    // Instant apply (TODO: Delay writing out settings)
-    QSqlQuery query(d->m_db);
-    query.prepare(QLatin1String("INSERT INTO settings VALUES (?, ?)"));
-    query.addBindValue(effectiveKey);
-    query.addBindValue(value);
-    query.exec();
-
-    if (debug_settings) {
-        qDebug() << "Stored:" << effectiveKey << "=" << value;
-    }
+    // Written out later by flush()
+    d->m_dirtyKeys.insert(effectiveKey);
+    d->m_flushTimer.start();
 }
 
 QVariant SettingsDatabase::value(const QString &key, const QVariant &defaultValue) const
@@ -173,7 +242,12 @@ QVariant SettingsDatabase::value(const QString &key, const QVariant &defaultValu
 
     SettingsMap::const_iterator i = d->m_settings.constFind(effectiveKey);
 
-    if (i != d->m_settings.constEnd() && i.value().isValid()) {
+    if (i == d->m_settings.constEnd()) {
+        // All keys are known from the start, so it is not in the database either
+        return value;
+    }
+
+    if (i.value().isValid()) {
         value = i.value();
     } else if (d->m_db.isOpen()) {
         // Try to read the value from the database
@@ -207,11 +281,9 @@ void SettingsDatabase::remove(const QString &key)
 
     // Remove keys from the cache
     foreach(const QString &k, d->m_settings.keys()) {
-        // Either it's an exact match, or it matches up to a /
-        if (k.startsWith(effectiveKey)
-            && (k.length() == effectiveKey.length()
-                || k.at(effectiveKey.length()) == QLatin1Char('/'))) {
+        if (SettingsDatabasePrivate::matchesKey(k, effectiveKey)) {
             d->m_settings.remove(k);
+            d->m_dirtyKeys.remove(k);
         }
     }
 
@@ -219,12 +291,9 @@ void SettingsDatabase::remove(const QString &key)
         return;
     }
 
-    // Delete keys from the database
-    QSqlQuery query(d->m_db);
-    query.prepare(QLatin1String("DELETE FROM settings WHERE key = ? OR key LIKE ?"));
-    query.addBindValue(effectiveKey);
-    query.addBindValue(QString(effectiveKey + QLatin1String("/%")));
-    query.exec();
+    // Deleted from the database by flush()
+    d->m_removedKeys.append(effectiveKey);
+    d->m_flushTimer.start();
 }
 
 void SettingsDatabase::beginGroup(const QString &prefix)
@@ -261,5 +330,31 @@ QStringList SettingsDatabase::childKeys() const
 
 void SettingsDatabase::sync()
 {
-    // TODO: Delay writing of dirty keys and save them here
+    flush();
+    d->m_flush.waitForFinished();
+}
+
+/**
+ * Hands the changes made since the last flush to a worker thread, which
+ * writes them in one transaction. Only one write runs at a time so that
+ * changes reach the database in the order they were made.
+ */
+void SettingsDatabase::flush()
+{
+    d->m_flushTimer.stop();
+
+    if (d->m_dirtyKeys.isEmpty() && d->m_removedKeys.isEmpty()) {
+        return;
+    }
+
+    SettingsMap changes;
+    foreach(const QString &key, d->m_dirtyKeys) {
+        changes.insert(key, d->m_settings.value(key));
+    }
+
+    d->m_flush.waitForFinished();
+    d->m_flush = QtConcurrent::run(&SettingsDatabasePrivate::writeChanges, d->m_fileName, d->m_removedKeys, changes);
+
+    d->m_dirtyKeys.clear();
+    d->m_removedKeys.clear();
 }
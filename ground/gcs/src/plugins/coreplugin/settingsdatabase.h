@@ -42,6 +42,8 @@ class SettingsDatabasePrivate;
 }
 
 class CORE_EXPORT SettingsDatabase : public QObject {
+    Q_OBJECT
+
 public:
     SettingsDatabase(const QString &path, const QString &application, QObject *parent = 0);
     ~SettingsDatabase();
@@ -58,6 +60,9 @@ public:
 
     void sync();
 
+private slots:
+    void flush();
+
 private:
     Internal::SettingsDatabasePrivate *d;
 };
@@ -27,27 +27,267 @@
  */
 
 #include "threadmanager.h"
+#include "icore.h"
 
+#include <QtCore/QSettings>
+#include <QtCore/QDebug>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
 
 using namespace Core;
 
+const QString ThreadManager::RealTimeRole  = QLatin1String("RealTime");
+const QString ThreadManager::TelemetryRole = QLatin1String("Telemetry");
+const QString ThreadManager::LoggingRole   = QLatin1String("Logging");
+const QString ThreadManager::DfuRole = QLatin1String("Dfu");
+const QString ThreadManager::GuiRole = QLatin1String("Gui");
+
+struct ThreadManager::ManagedThread {
+    QThread *thread;
+    QString role;
+    bool    running;
+#if defined(Q_OS_LINUX)
+    pthread_t handle;
+#elif defined(Q_OS_WIN)
+    HANDLE  handle;
+#endif
+    qint64  lastCpuTimeMs;
+};
+
 ThreadManager *ThreadManager::m_instance = 0;
 
 ThreadManager::ThreadManager(QObject *parent) : QObject(parent)
 {
-    m_instance     = this;
-    realTimeThread = new QThread(this);
-    realTimeThread->start(QThread::TimeCriticalPriority);
+    m_instance = this;
+    m_loadTimer.start();
+
+    // created on the GUI thread, which is already running and keeps its scheduling
+    ManagedThread *managed = new ManagedThread;
+    managed->thread  = QThread::currentThread();
+    managed->role    = GuiRole;
+    managed->running = true;
+#if defined(Q_OS_LINUX)
+    managed->handle  = pthread_self();
+#elif defined(Q_OS_WIN)
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &managed->handle, 0, FALSE, DUPLICATE_SAME_ACCESS);
+#endif
+    managed->lastCpuTimeMs = -1;
+    m_threads.insert(managed->thread, managed);
 }
 
 ThreadManager::~ThreadManager()
 {
-    realTimeThread->quit();
-    realTimeThread->wait();
+    foreach(QThread * thread, m_sharedThreads) {
+        thread->quit();
+        thread->wait();
+    }
+    qDeleteAll(m_threads);
     m_instance = 0;
 }
 
 QThread *ThreadManager::getRealTimeThread()
 {
-    return realTimeThread;
+    return sharedThread(RealTimeRole);
+}
+
+QThread *ThreadManager::sharedThread(const QString &role)
+{
+    QThread *thread = m_sharedThreads.value(role);
+
+    if (!thread) {
+        thread = new QThread(this);
+        thread->setObjectName(role);
+        manageThread(thread, role);
+        m_sharedThreads.insert(role, thread);
+        thread->start();
+    }
+    return thread;
+}
+
+void ThreadManager::manageThread(QThread *thread, const QString &role)
+{
+    // read the settings of the role now, the threads can't use QSettings when they start
+    roleSettings(role);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_threads.contains(thread)) {
+        m_threads.value(thread)->role = role;
+        return;
+    }
+    ManagedThread *managed = new ManagedThread;
+    managed->thread  = thread;
+    managed->role    = role;
+    managed->running = false;
+    managed->lastCpuTimeMs = -1;
+    m_threads.insert(thread, managed);
+
+    // started and finished are emitted by the thread itself
+    connect(thread, &QThread::started, this, [this, thread]() {
+        threadStarted(thread);
+    }, Qt::DirectConnection);
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        threadFinished(thread);
+    }, Qt::DirectConnection);
+    connect(thread, &QObject::destroyed, this, [this, thread]() {
+        QMutexLocker locker(&m_mutex);
+        delete m_threads.take(thread);
+    }, Qt::DirectConnection);
+}
+
+ThreadManager::RoleSettings ThreadManager::roleSettings(const QString &role)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_roleSettings.contains(role)) {
+        RoleSettings settings;
+        // telemetry must not stall behind the UI, logging and flashing come next
+        if (role == RealTimeRole || role == TelemetryRole) {
+            settings.priority = QThread::TimeCriticalPriority;
+        } else if (role == LoggingRole || role == DfuRole) {
+            settings.priority = QThread::HighPriority;
+        }
+        QSettings qs;
+        qs.beginGroup("ThreadManager");
+        qs.beginGroup(role);
+        settings.priority = (QThread::Priority)qs.value("Priority", (int)settings.priority).toInt();
+        settings.realTime = qs.value("RealTime", settings.realTime).toBool();
+        settings.cpuMask  = qs.value("CpuMask", settings.cpuMask).toULongLong();
+        qs.endGroup();
+        qs.endGroup();
+        m_roleSettings.insert(role, settings);
+    }
+    return m_roleSettings.value(role);
+}
+
+void ThreadManager::setRoleSettings(const QString &role, const RoleSettings &settings)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_roleSettings.insert(role, settings);
+    foreach(ManagedThread * managed, m_threads) {
+        if (managed->role == role && managed->running) {
+            applySettings(managed, settings);
+        }
+    }
+}
+
+QList<ThreadManager::ThreadLoad> ThreadManager::threadLoads()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QList<ThreadLoad> loads;
+    qint64 elapsed = m_loadTimer.restart();
+
+    foreach(ManagedThread * managed, m_threads) {
+        if (!managed->running) {
+            continue;
+        }
+        ThreadLoad load;
+        load.role      = managed->role;
+        load.name      = managed->thread->objectName();
+        load.cpuTimeMs = cpuTime(managed);
+        load.load = 0;
+        if (load.cpuTimeMs >= 0 && managed->lastCpuTimeMs >= 0 && elapsed > 0) {
+            load.load = (double)(load.cpuTimeMs - managed->lastCpuTimeMs) / elapsed;
+        }
+        managed->lastCpuTimeMs = load.cpuTimeMs;
+        loads.append(load);
+    }
+    return loads;
+}
+
+void ThreadManager::threadStarted(QThread *thread)
+{
+    QMutexLocker locker(&m_mutex);
+    ManagedThread *managed = m_threads.value(thread);
+
+    if (!managed) {
+        return;
+    }
+#if defined(Q_OS_LINUX)
+    managed->handle = pthread_self();
+#elif defined(Q_OS_WIN)
+    DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &managed->handle, 0, FALSE, DUPLICATE_SAME_ACCESS);
+#endif
+    managed->running = true;
+    managed->lastCpuTimeMs = -1;
+    applySettings(managed, m_roleSettings.value(managed->role));
+}
+
+void ThreadManager::threadFinished(QThread *thread)
+{
+    QMutexLocker locker(&m_mutex);
+    ManagedThread *managed = m_threads.value(thread);
+
+    if (!managed || !managed->running) {
+        return;
+    }
+    managed->running = false;
+#if defined(Q_OS_WIN)
+    CloseHandle(managed->handle);
+#endif
+}
+
+void ThreadManager::applySettings(ManagedThread *managed, const RoleSettings &settings)
+{
+    if (settings.priority != QThread::InheritPriority) {
+        managed->thread->setPriority(settings.priority);
+    }
+#if defined(Q_OS_LINUX)
+    if (settings.realTime) {
+        sched_param param;
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+        if (pthread_setschedparam(managed->handle, SCHED_FIFO, &param) != 0) {
+            qWarning() << "ThreadManager - no real time scheduling for" << managed->role << "threads, not permitted";
+        }
+    }
+    if (settings.cpuMask) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+            if (settings.cpuMask & ((quint64)1 << cpu)) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (pthread_setaffinity_np(managed->handle, sizeof(cpus), &cpus) != 0) {
+            qWarning() << "ThreadManager - failed to pin" << managed->role << "threads to CPUs" << hex << settings.cpuMask;
+        }
+    }
+#elif defined(Q_OS_WIN)
+    if (settings.realTime) {
+        SetThreadPriority(managed->handle, THREAD_PRIORITY_TIME_CRITICAL);
+    }
+    if (settings.cpuMask && !SetThreadAffinityMask(managed->handle, (DWORD_PTR)settings.cpuMask)) {
+        qWarning() << "ThreadManager - failed to pin" << managed->role << "threads to CPUs" << hex << settings.cpuMask;
+    }
+#endif
+}
+
+qint64 ThreadManager::cpuTime(ManagedThread *managed)
+{
+#if defined(Q_OS_LINUX)
+    clockid_t clock;
+    timespec time;
+    if (pthread_getcpuclockid(managed->handle, &clock) == 0 && clock_gettime(clock, &time) == 0) {
+        return (qint64)time.tv_sec * 1000 + time.tv_nsec / 1000000;
+    }
+#elif defined(Q_OS_WIN)
+    FILETIME creation, exit, kernel, user;
+    if (GetThreadTimes(managed->handle, &creation, &exit, &kernel, &user)) {
+        quint64 k = ((quint64)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+        quint64 u = ((quint64)user.dwHighDateTime << 32) | user.dwLowDateTime;
+        // 100 ns units
+        return (qint64)((k + u) / 10000);
+    }
+#else
+    Q_UNUSED(managed);
+#endif
+    return -1;
 }
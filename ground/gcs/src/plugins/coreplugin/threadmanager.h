@@ -33,15 +33,50 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QThread>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QElapsedTimer>
 
 QT_BEGIN_NAMESPACE
     QT_END_NAMESPACE
 
 namespace Core {
+/**
+ * Owns the scheduling of the GCS threads. Each thread has a role, the role
+ * settings (priority, real time scheduling, CPUs) are applied whenever one of
+ * its threads starts. They can be changed in the "ThreadManager/<role>"
+ * settings group (Priority, RealTime, CpuMask).
+ */
 class CORE_EXPORT ThreadManager : public QObject {
     Q_OBJECT
 
 public:
+    // thread roles of the GCS
+    static const QString RealTimeRole;
+    static const QString TelemetryRole;
+    static const QString LoggingRole;
+    static const QString DfuRole;
+    // the GUI thread, only accounted
+    static const QString GuiRole;
+
+    struct RoleSettings {
+        RoleSettings() : priority(QThread::InheritPriority), realTime(false), cpuMask(0) {}
+        QThread::Priority priority;
+        // SCHED_FIFO on Linux (needs the rights to), time critical on Windows
+        bool realTime;
+        // CPUs the threads may run on, bit n for CPU n, 0 for any
+        quint64 cpuMask;
+    };
+
+    struct ThreadLoad {
+        QString role;
+        QString name;
+        // CPU time used so far, -1 if unknown on this platform
+        qint64  cpuTimeMs;
+        // share of a CPU used since the previous call to threadLoads()
+        double  load;
+    };
+
     ThreadManager(QObject *parent);
     ~ThreadManager();
 
@@ -52,9 +87,30 @@ public:
 
     QThread *getRealTimeThread();
 
+    // The thread shared by the objects of a role, started on first use
+    QThread *sharedThread(const QString &role);
+    // Apply the settings of a role to a thread each time it starts, to be called before starting it
+    void manageThread(QThread *thread, const QString &role);
+
+    RoleSettings roleSettings(const QString &role);
+    void setRoleSettings(const QString &role, const RoleSettings &settings);
+
+    QList<ThreadLoad> threadLoads();
 
 private:
-    QThread *realTimeThread;
+    struct ManagedThread;
+
+    void threadStarted(QThread *thread);
+    void threadFinished(QThread *thread);
+    void applySettings(ManagedThread *managed, const RoleSettings &settings);
+    qint64 cpuTime(ManagedThread *managed);
+
+    QHash<QString, QThread *> m_sharedThreads;
+    QHash<QThread *, ManagedThread *> m_threads;
+    QHash<QString, RoleSettings> m_roleSettings;
+    QElapsedTimer m_loadTimer;
+    // threads start and finish in their own thread
+    QMutex m_mutex;
     static ThreadManager *m_instance;
 };
 } // namespace Core
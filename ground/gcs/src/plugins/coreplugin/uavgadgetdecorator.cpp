@@ -92,6 +92,11 @@ void UAVGadgetDecorator::configurationAdded(IUAVGadgetConfiguration *config)
     m_configurations->append(config);
     m_toolbar->addItem(config->name());
     updateToolbar();
+    // an imported configuration replacing the active one is loaded in its place
+    if (m_activeConfiguration && !m_configurations->contains(m_activeConfiguration)
+        && m_activeConfiguration->name() == config->name()) {
+        loadConfiguration(config);
+    }
 }
 
 void UAVGadgetDecorator::configurationToBeDeleted(IUAVGadgetConfiguration *config)
@@ -37,7 +37,9 @@
 #include "icore.h"
 
 #include <extensionsystem/pluginmanager.h>
+#include <QHash>
 #include <QStringList>
+#include <QTemporaryFile>
 #include <QSettings>
 #include <QDebug>
 #include <QMessageBox>
@@ -72,9 +74,16 @@ UAVGadgetInstanceManager::~UAVGadgetInstanceManager()
 
 void UAVGadgetInstanceManager::readSettings(QSettings &settings)
 {
-    while (!m_configurations.isEmpty()) {
-        emit configurationToBeDeleted(m_configurations.takeLast());
+    // Keep the current configurations aside: the ones read back unchanged are
+    // reused, so the gadgets showing them don't have to reload anything.
+    QList<IUAVGadgetConfiguration *> previous = m_configurations;
+    QTemporaryFile file;
+    QSettings *saved = 0;
+    if (!previous.isEmpty() && file.open()) {
+        saved = new QSettings(file.fileName(), QSettings::IniFormat);
+        saveSettings(*saved);
     }
+    m_configurations.clear();
 
     settings.beginGroup("UAVGadgetConfigurations");
 
@@ -98,14 +107,61 @@ void UAVGadgetInstanceManager::readSettings(QSettings &settings)
             tr("You might want to save your old config NOW since it might be replaced by broken one when you exit the GCS!")
             );
     } else {
-        readConfigs_1_2_0(settings);
+        readConfigs_1_2_0(settings, previous, saved);
     }
 
     settings.endGroup();
-    createOptionsPages();
+    delete saved;
+
+    // The dropped configurations are not deleted, gadgets might still use them.
+    foreach(IUAVGadgetConfiguration * config, previous) {
+        if (!m_configurations.contains(config)) {
+            emit configurationToBeDeleted(config);
+        }
+    }
+    createOptionsPages(previous);
+    foreach(IUAVGadgetConfiguration * config, m_configurations) {
+        if (!previous.contains(config)) {
+            emit configurationAdded(config);
+        }
+    }
+}
+
+// Returns the configuration of the list which was saved with exactly the values
+// of the current settings group, 0 if there is none.
+IUAVGadgetConfiguration *UAVGadgetInstanceManager::unchangedConfig(QSettings &settings,
+                                                                   const QList<IUAVGadgetConfiguration *> &configs, QSettings *saved,
+                                                                   QString classId, QString configName, bool locked)
+{
+    if (!saved) {
+        return 0;
+    }
+    int idx = indexForConfig(configs, classId, configName);
+    if (idx < 0 || configs.at(idx)->locked() != locked) {
+        return 0;
+    }
+
+    saved->beginGroup("UAVGadgetConfigurations/" + classId + "/" + configName + "/data");
+    QStringList keys      = settings.allKeys();
+    QStringList savedKeys = saved->allKeys();
+    keys.sort();
+    savedKeys.sort();
+    bool same = (keys == savedKeys);
+    for (int i = 0; same && i < keys.count(); ++i) {
+        QVariant value      = settings.value(keys.at(i));
+        QVariant savedValue = saved->value(keys.at(i));
+        // ini files give back most values as strings
+        same = (value == savedValue)
+               || ((value.type() == QVariant::String || savedValue.type() == QVariant::String)
+                   && value.toString() == savedValue.toString());
+    }
+    saved->endGroup();
+
+    return same ? configs.at(idx) : 0;
 }
 
-void UAVGadgetInstanceManager::readConfigs_1_2_0(QSettings &settings)
+void UAVGadgetInstanceManager::readConfigs_1_2_0(QSettings &settings,
+                                                 const QList<IUAVGadgetConfiguration *> &previous, QSettings *saved)
 {
     UAVConfigInfo configInfo;
 
@@ -123,11 +179,16 @@ void UAVGadgetInstanceManager::readConfigs_1_2_0(QSettings &settings)
             configInfo.read(settings);
             configInfo.setNameOfConfigurable(classId + "-" + configName);
             settings.beginGroup("data");
-            IUAVGadgetConfiguration *config = f->createConfiguration(settings, &configInfo);
+            IUAVGadgetConfiguration *config = unchangedConfig(settings, previous, saved, classId, configName, configInfo.locked());
+            if (!config) {
+                config = f->createConfiguration(settings, &configInfo);
+                if (config) {
+                    config->setName(configName);
+                    config->setProvisionalName(configName);
+                    config->setLocked(configInfo.locked());
+                }
+            }
             if (config) {
-                config->setName(configName);
-                config->setProvisionalName(configName);
-                config->setLocked(configInfo.locked());
                 int idx = indexForConfig(m_configurations, classId, configName);
                 if (idx >= 0) {
                     // We should replace the config, but it might be used, so just
@@ -227,18 +288,25 @@ void UAVGadgetInstanceManager::saveSettings(QSettings &settings) const
     settings.endGroup();
 }
 
-void UAVGadgetInstanceManager::createOptionsPages()
+void UAVGadgetInstanceManager::createOptionsPages(const QList<IUAVGadgetConfiguration *> &previous)
 {
-    // In case there are pages (import a configuration), remove them.
+    // In case there are pages (import a configuration), keep the ones of the
+    // configurations which were reused and remove the others.
     // Maybe they should be deleted as well (memory-leak),
     // but this might lead to NULL-pointers?
-    while (!m_optionsPages.isEmpty()) {
-        m_pm->removeObject(m_optionsPages.takeLast());
+    QHash<IUAVGadgetConfiguration *, IOptionsPage *> pages;
+    for (int i = 0; i < m_optionsPages.count() && i < previous.count(); ++i) {
+        pages.insert(previous.at(i), m_optionsPages.at(i));
     }
+    m_optionsPages.clear();
 
     QMutableListIterator<IUAVGadgetConfiguration *> ite(m_configurations);
     while (ite.hasNext()) {
         IUAVGadgetConfiguration *config = ite.next();
+        if (pages.contains(config)) {
+            m_optionsPages.append(pages.take(config));
+            continue;
+        }
         IUAVGadgetFactory *f = factory(config->classId());
         if (!f) {
             qWarning() << "No gadget factory for configuration " + config->classId();
@@ -259,6 +327,10 @@ void UAVGadgetInstanceManager::createOptionsPages()
             ite.remove();
         }
     }
+
+    foreach(IOptionsPage * page, pages) {
+        m_pm->removeObject(page);
+    }
 }
 
 
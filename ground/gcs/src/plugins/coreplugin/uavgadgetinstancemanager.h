@@ -66,6 +66,11 @@ public:
     void removeGadget(IUAVGadget *gadget);
     void removeAllGadgets();
 
+    QList<IUAVGadget *> gadgets() const
+    {
+        return m_gadgetInstances;
+    }
+
     bool isConfigurationActive(IUAVGadgetConfiguration *config);
     DeleteStatus canDeleteConfiguration(IUAVGadgetConfiguration *config);
     void deleteConfiguration(IUAVGadgetConfiguration *config);
@@ -108,7 +113,7 @@ private:
 
     IUAVGadgetFactory *factory(QString classId) const;
 
-    void createOptionsPages();
+    void createOptionsPages(const QList<IUAVGadgetConfiguration *> &previous);
 
     QList<IUAVGadgetConfiguration *> *configurations(QString classId) const;
     QList<IUAVGadgetConfiguration *> *provisionalConfigurations(QString classId) const;
@@ -118,7 +123,9 @@ private:
     int indexForConfig(QList<IUAVGadgetConfiguration *> configurations, QString classId, QString configName);
 
     void readConfigs_1_1_0(QSettings &settings);
-    void readConfigs_1_2_0(QSettings &settings);
+    void readConfigs_1_2_0(QSettings &settings, const QList<IUAVGadgetConfiguration *> &previous, QSettings *saved);
+    IUAVGadgetConfiguration *unchangedConfig(QSettings &settings, const QList<IUAVGadgetConfiguration *> &configs, QSettings *saved,
+                                             QString classId, QString configName, bool locked);
 };
 } // namespace Core
 
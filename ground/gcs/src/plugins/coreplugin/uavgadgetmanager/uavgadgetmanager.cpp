@@ -42,12 +42,14 @@
 #include <coreplugin/imode.h>
 
 #include <extensionsystem/pluginmanager.h>
+#include <extensionsystem/startuptrace.h>
 
 #include <utils/qtcassert.h>
 
 #include <QDebug>
 #include <QApplication>
 #include <QHBoxLayout>
+#include <QTemporaryFile>
 
 Q_DECLARE_METATYPE(Core::IUAVGadget *)
 
@@ -67,7 +69,8 @@ UAVGadgetManager::UAVGadgetManager(ICore *core, QString name, QIcon icon, int pr
     m_name(name),
     m_icon(icon),
     m_priority(priority),
-    m_widget(new QWidget(parent))
+    m_widget(new QWidget(parent)),
+    m_restorePending(false)
 {
     // checking that the mode name is unique gives harmless
     // warnings on the console output
@@ -102,6 +105,8 @@ UAVGadgetManager::UAVGadgetManager(ICore *core, QString name, QIcon icon, int pr
     layout->setSpacing(0);
     layout->addWidget(m_splitterOrView);
 
+    m_widget->installEventFilter(this);
+
     showToolbars(m_showToolbars);
 }
 
@@ -122,6 +127,8 @@ void UAVGadgetManager::modeChanged(Core::IMode *mode)
         return;
     }
 
+    restorePendingState();
+
     m_currentGadget->widget()->setFocus();
     showToolbars(toolbarsShown());
 }
@@ -304,6 +311,7 @@ bool UAVGadgetManager::restoreState(QSettings &settings)
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
+    ExtensionSystem::StartupTrace::Scope trace("workspace", m_name);
     settings.beginGroup("splitter");
     m_splitterOrView->restoreState(settings);
     settings.endGroup();
@@ -320,8 +328,17 @@ void UAVGadgetManager::saveSettings(QSettings &settings) const
     // Make sure the old tree is wiped.
     settings.remove("");
 
-    // Do actual saving
-    saveState(settings);
+    if (m_restorePending) {
+        // Workspace was never shown, write back the layout we were given
+        QMapIterator<QString, QVariant> i(m_pendingState);
+        while (i.hasNext()) {
+            i.next();
+            settings.setValue(i.key(), i.value());
+        }
+    } else {
+        // Do actual saving
+        saveState(settings);
+    }
 
     settings.endGroup();
     settings.endGroup();
@@ -342,12 +359,87 @@ void UAVGadgetManager::readSettings(QSettings &settings)
     }
     settings.beginGroup(uniqueModeName());
 
-    restoreState(settings);
+    QVariantMap state;
+    foreach(const QString &key, settings.allKeys()) {
+        state.insert(key, settings.value(key));
+    }
+    // Importing the layout the workspace already has must not rebuild its gadgets
+    if (state == (m_restorePending ? m_pendingState : currentState())) {
+        settings.endGroup();
+        settings.endGroup();
+        return;
+    }
+
+    // Creating the gadgets of every workspace up front is what makes startup
+    // slow, so only keep a copy of the layout and restore it the first time
+    // the workspace is shown.
+    m_pendingState   = state;
+    m_restorePending = true;
+    m_showToolbars   = m_pendingState.value("showToolbars", m_showToolbars).toBool();
 
     showToolbars(m_showToolbars);
 
     settings.endGroup();
     settings.endGroup();
+
+    if (m_widget->isVisible()) {
+        restorePendingState();
+    }
+}
+
+void UAVGadgetManager::restorePendingState()
+{
+    if (!m_restorePending) {
+        return;
+    }
+    m_restorePending = false;
+
+    // SplitterOrView and the gadgets restore themselves from a QSettings,
+    // so hand them the saved layout through a scratch ini file.
+    QTemporaryFile file;
+    if (!file.open()) {
+        qWarning() << "UAVGadgetManager::restorePendingState - failed to create temporary file for" << m_name;
+        return;
+    }
+    file.close();
+
+    QSettings settings(file.fileName(), QSettings::IniFormat);
+    QMapIterator<QString, QVariant> i(m_pendingState);
+    while (i.hasNext()) {
+        i.next();
+        settings.setValue(i.key(), i.value());
+    }
+    m_pendingState.clear();
+
+    restoreState(settings);
+
+    showToolbars(m_showToolbars);
+}
+
+QVariantMap UAVGadgetManager::currentState() const
+{
+    QVariantMap state;
+    QTemporaryFile file;
+
+    if (!file.open()) {
+        return state;
+    }
+    file.close();
+
+    QSettings settings(file.fileName(), QSettings::IniFormat);
+    saveState(settings);
+    foreach(const QString &key, settings.allKeys()) {
+        state.insert(key, settings.value(key));
+    }
+    return state;
+}
+
+bool UAVGadgetManager::eventFilter(QObject *obj, QEvent *event)
+{
+    if (obj == m_widget && event->type() == QEvent::Show) {
+        restorePendingState();
+    }
+    return IMode::eventFilter(obj, event);
 }
 
 void UAVGadgetManager::split(Qt::Orientation orientation)
@@ -37,6 +37,7 @@
 #include <QWidget>
 #include <QList>
 #include <QIcon>
+#include <QVariant>
 
 QT_BEGIN_NAMESPACE
 class QModelIndex;
@@ -115,6 +116,9 @@ private slots:
     void updateUavGadgetMenus();
     void modeChanged(Core::IMode *mode);
 
+protected:
+    bool eventFilter(QObject *obj, QEvent *event);
+
 
 public slots:
     void split(Qt::Orientation orientation);
@@ -132,6 +136,8 @@ private:
     void closeView(Core::Internal::UAVGadgetView *view);
     void emptyView(Core::Internal::UAVGadgetView *view);
     Core::Internal::SplitterOrView *currentSplitterOrView() const;
+    void restorePendingState();
+    QVariantMap currentState() const;
 
     bool m_showToolbars;
     Core::Internal::SplitterOrView *m_splitterOrView;
@@ -146,6 +152,11 @@ private:
     const char *m_uniqueModeName;
     QWidget *m_widget;
 
+    // Saved layout of a workspace that has not been shown yet; its gadgets
+    // are only created when the workspace is first shown.
+    bool m_restorePending;
+    QVariantMap m_pendingState;
+
     friend class Core::Internal::SplitterOrView;
     friend class Core::Internal::UAVGadgetView;
 };
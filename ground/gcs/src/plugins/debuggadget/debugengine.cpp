@@ -1,8 +1,15 @@
 #include "debugengine.h"
 
-debugengine::debugengine()
+#include <cstdlib>
+
+debugengine::debugengine() : m_enqueuePos(0), m_dequeuePos(0), m_dropped(0),
+    m_attached(0), m_previousHandler(0)
 {
-    mut_lock = new QMutex(QMutex::Recursive);
+    for (int i = 0; i < QUEUE_SIZE; i++) {
+        m_slots[i].sequence.store(i);
+    }
+    m_flushTimer.setInterval(FLUSH_INTERVAL);
+    connect(&m_flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
 }
 
 debugengine *debugengine::getInstance()
@@ -13,32 +20,110 @@ debugengine *debugengine::getInstance()
 }
 
 debugengine::~debugengine()
+{}
+
+void debugengine::attach()
+{
+    if (m_attached++ == 0) {
+        m_previousHandler = qInstallMessageHandler(messageHandler);
+        m_flushTimer.start();
+    }
+}
+
+void debugengine::detach()
 {
-    delete mut_lock;
-    mut_lock = NULL;
+    if (--m_attached == 0) {
+        qInstallMessageHandler(m_previousHandler);
+        m_previousHandler = 0;
+        m_flushTimer.stop();
+        flush();
+    }
 }
 
-void debugengine::setTextEdit(QTextBrowser *textEdit)
+void debugengine::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
-    QMutexLocker lock(mut_lock);
+    debugengine *engine = getInstance();
+    QString txt;
 
-    _textEdit = textEdit;
+    switch (type) {
+    case QtDebugMsg:
+        txt = QString("Debug: %1").arg(msg);
+        break;
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 5, 0))
+    case QtInfoMsg:
+        txt = QString("Info: %1").arg(msg);
+        break;
+#endif
+    case QtWarningMsg:
+        txt = QString("Warning: %1").arg(msg);
+        break;
+    case QtCriticalMsg:
+        txt = QString("Critical: %1").arg(msg);
+        break;
+    case QtFatalMsg:
+        txt = QString("Fatal: %1").arg(msg);
+        break;
+    }
+    engine->writeMessage(type, txt);
+
+    // keep the log file going
+    if (engine->m_previousHandler) {
+        engine->m_previousHandler(type, context, msg);
+    }
+    if (type == QtFatalMsg) {
+        abort();
+    }
 }
 
-void debugengine::writeMessage(const QString &message)
+/*
+ * Bounded multiple producers queue, each slot's sequence tells whether it is free for the
+ * position being written (sequence == position) or holds a message (sequence == position + 1).
+ */
+void debugengine::writeMessage(QtMsgType type, const QString &message)
 {
-    QMutexLocker lock(mut_lock);
+    int pos = m_enqueuePos.loadAcquire();
+    Slot *slot;
 
-    if (_textEdit) {
-        _textEdit->append(message);
+    for (;;) {
+        slot = &m_slots[pos & (QUEUE_SIZE - 1)];
+        int diff = int(uint(slot->sequence.loadAcquire()) - uint(pos));
+        if (diff == 0) {
+            if (m_enqueuePos.testAndSetOrdered(pos, pos + 1)) {
+                break;
+            }
+            pos = m_enqueuePos.loadAcquire();
+        } else if (diff < 0) {
+            // full, the GUI can't keep up
+            m_dropped.ref();
+            return;
+        } else {
+            pos = m_enqueuePos.loadAcquire();
+        }
     }
+
+    slot->type = type;
+    slot->text = message;
+    slot->sequence.storeRelease(pos + 1);
 }
 
-void debugengine::setColor(const QColor &c)
+void debugengine::flush()
 {
-    QMutexLocker lock(mut_lock);
+    QList<DebugMessage> messages;
+
+    for (;;) {
+        Slot &slot = m_slots[m_dequeuePos & (QUEUE_SIZE - 1)];
+        if (int(uint(slot.sequence.loadAcquire()) - uint(m_dequeuePos + 1)) < 0) {
+            break;
+        }
+        DebugMessage message = { slot.type, slot.text };
+        messages << message;
+        slot.text = QString();
+        slot.sequence.storeRelease(m_dequeuePos + QUEUE_SIZE);
+        m_dequeuePos++;
+    }
 
-    if (_textEdit) {
-        _textEdit->setTextColor(c);
+    int dropped = m_dropped.fetchAndStoreOrdered(0);
+    if (!messages.isEmpty() || dropped) {
+        emit messagesReady(messages, dropped);
     }
 }
@@ -1,21 +1,60 @@
 #ifndef DEBUGENGINE_H
 #define DEBUGENGINE_H
-#include <QTextBrowser>
-#include <QPointer>
-#include <QMutex>
+#include <QObject>
+#include <QAtomicInt>
+#include <QTimer>
+#include <QList>
+#include <QString>
 
-class debugengine {
+typedef struct {
+    QtMsgType type;
+    QString   text;
+} DebugMessage;
+
+/*
+ * Collects the qDebug() messages of all threads without locking: the message handler only
+ * puts them in a bounded ring buffer, a timer of the GUI thread hands them to the gadgets
+ * in batches. The messages that don't fit are dropped and counted.
+ */
+class debugengine : public QObject {
+    Q_OBJECT
 // Add all missing constructor etc... to have singleton
     debugengine();
     ~debugengine();
 public:
     static debugengine *getInstance();
-    void setTextEdit(QTextBrowser *textEdit);
-    void writeMessage(const QString &message);
-    void setColor(const QColor &c);
-    QMutex *mut_lock;
+    // install the message handler while at least one gadget is attached
+    void attach();
+    void detach();
+    // thread safe, never blocks
+    void writeMessage(QtMsgType type, const QString &message);
+
+signals:
+    void messagesReady(const QList<DebugMessage> &messages, int dropped);
+
+private slots:
+    void flush();
+
 private:
-    QPointer<QTextBrowser> _textEdit;
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+
+    static const int QUEUE_SIZE     = 4096; // power of two
+    static const int FLUSH_INTERVAL = 100; // ms
+
+    typedef struct {
+        QAtomicInt sequence;
+        QtMsgType  type;
+        QString    text;
+    } Slot;
+
+    Slot m_slots[QUEUE_SIZE];
+    QAtomicInt m_enqueuePos;
+    int m_dequeuePos;
+    QAtomicInt m_dropped;
+
+    int m_attached;
+    QtMessageHandler m_previousHandler;
+    QTimer m_flushTimer;
 };
 
 #endif // DEBUGENGINE_H
@@ -38,43 +38,8 @@
 #include <QMessageBox>
 #include <QScrollBar>
 #include <QTime>
-
-QPointer<QTextBrowser> m_textedit;
-
-void DebugGadgetWidget::customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
-{
-    Q_UNUSED(context);
-    QString txt;
-    QColor color = Qt::black;
-
-    switch (type) {
-    case QtDebugMsg:
-        txt   = QString("Debug: %1").arg(msg);
-        color = Qt::black;
-        break;
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 5, 0))
-    case QtInfoMsg:
-        txt   = QString("Info: %1").arg(msg);
-        color = Qt::blue;
-        break;
-#endif
-    case QtWarningMsg:
-        txt   = QString("Warning: %1").arg(msg);
-        color = Qt::red;
-        break;
-    case QtCriticalMsg:
-        txt   = QString("Critical: %1").arg(msg);
-        color = Qt::red;
-        break;
-    case QtFatalMsg:
-        txt   = QString("Fatal: %1").arg(msg);
-        abort();
-    }
-
-    debugengine::getInstance()->setTextEdit(m_textedit);
-    debugengine::getInstance()->setColor(color);
-    debugengine::getInstance()->writeMessage(txt);
-}
+#include <QTextCursor>
+#include <QTextCharFormat>
 
 DebugGadgetWidget::DebugGadgetWidget(QWidget *parent) : QLabel(parent)
 {
@@ -88,11 +53,63 @@ DebugGadgetWidget::DebugGadgetWidget(QWidget *parent) : QLabel(parent)
     // connect(de, SIGNAL(dbgMsg(QString, QList<QVariant>)), this, SLOT(dbgMsg(QString, QList<QVariant>)));
     // connect(de, SIGNAL(dbgMsgError(QString, QList<QVariant>)), this, SLOT(dbgMsgError(QString, QList<QVariant>)));
     connect(m_config->pushButton, SIGNAL(clicked()), this, SLOT(saveLog()));
+
+    // keep the view bounded, the oldest lines go first
+    m_config->plainTextEdit->document()->setMaximumBlockCount(MAX_LINES);
+    connect(debugengine::getInstance(), SIGNAL(messagesReady(QList<DebugMessage>, int)),
+            this, SLOT(appendMessages(QList<DebugMessage>, int)));
+    debugengine::getInstance()->attach();
 }
 
 DebugGadgetWidget::~DebugGadgetWidget()
 {
-    // Do nothing
+    debugengine::getInstance()->detach();
+}
+
+/*
+ * One edit block for the whole batch, the document is laid out once
+ */
+void DebugGadgetWidget::appendMessages(const QList<DebugMessage> &messages, int dropped)
+{
+    QTextBrowser *view = m_config->plainTextEdit;
+    QScrollBar *sb     = view->verticalScrollBar();
+    bool atBottom      = (sb->value() == sb->maximum());
+    QTextCursor cursor(view->document());
+    QTextCharFormat format;
+
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock();
+    if (dropped) {
+        format.setForeground(Qt::darkGray);
+        if (!cursor.atStart()) {
+            cursor.insertBlock();
+        }
+        cursor.insertText(tr("%1 messages dropped").arg(dropped), format);
+    }
+    foreach(const DebugMessage &message, messages) {
+        switch (message.type) {
+        case QtDebugMsg:
+            format.setForeground(Qt::black);
+            break;
+        case QtWarningMsg:
+        case QtCriticalMsg:
+        case QtFatalMsg:
+            format.setForeground(Qt::red);
+            break;
+        default:
+            format.setForeground(Qt::blue);
+            break;
+        }
+        if (!cursor.atStart()) {
+            cursor.insertBlock();
+        }
+        cursor.insertText(message.text, format);
+    }
+    cursor.endEditBlock();
+
+    if (atBottom) {
+        sb->setValue(sb->maximum());
+    }
 }
 
 void DebugGadgetWidget::dbgMsg(const QString &level, const QList<QVariant> &msgs)
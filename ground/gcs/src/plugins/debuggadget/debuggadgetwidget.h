@@ -37,10 +37,12 @@ class DebugGadgetWidget : public QLabel {
 public:
     DebugGadgetWidget(QWidget *parent = 0);
     ~DebugGadgetWidget();
-    static void customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
 private:
+    static const int MAX_LINES = 5000;
+
     Ui_Form *m_config;
 private slots:
+    void appendMessages(const QList<DebugMessage> &messages, int dropped);
     void saveLog();
     void dbgMsgError(const QString & level, const QList<QVariant> & msgs);
     void dbgMsg(const QString & level, const QList<QVariant> & msgs);
@@ -30,6 +30,7 @@
 #include <utils/stylehelper.h>
 #include <iostream>
 #include <math.h>
+#include <QtMath>
 #include <QOpenGLWidget>
 #include <QDebug>
 
@@ -57,10 +58,15 @@ DialGadgetWidget::DialGadgetWidget(QWidget *parent) : QGraphicsView(parent)
     needle2Target = 0;
     needle3Target = 0;
 
+    m_background = NULL;
+    dialError    = true;
+
 // beSmooth = true;
     beSmooth = false;
 
-    // This timer mechanism makes needles rotate smoothly
+    // This timer mechanism makes needles rotate smoothly,
+    // it runs at the display rate and stops once the needles reached their target
+    dialTimer.setInterval(1000 / DIAL_FRAME_RATE);
     connect(&dialTimer, SIGNAL(timeout()), this, SLOT(rotateNeedles()));
 }
 
@@ -173,7 +179,7 @@ void DialGadgetWidget::updateNeedle1(UAVObject *object1)
 
     if (field) {
         if (haveSubField1) {
-            int indexOfSubField = field->getElementNames().indexOf(QRegExp(subfield1, Qt::CaseSensitive, QRegExp::FixedString));
+            int indexOfSubField = field->getElementIndex(subfield1);
             value = field->getDouble(indexOfSubField);
         } else {
             value = field->getDouble();
@@ -198,7 +204,7 @@ void DialGadgetWidget::updateNeedle2(UAVObject *object2)
 
     if (field) {
         if (haveSubField2) {
-            int indexOfSubField = field->getElementNames().indexOf(QRegExp(subfield2, Qt::CaseSensitive, QRegExp::FixedString));
+            int indexOfSubField = field->getElementIndex(subfield2);
             value = field->getDouble(indexOfSubField);
         } else {
             value = field->getDouble();
@@ -223,7 +229,7 @@ void DialGadgetWidget::updateNeedle3(UAVObject *object3)
 
     if (field) {
         if (haveSubField3) {
-            int indexOfSubField = field->getElementNames().indexOf(QRegExp(subfield3, Qt::CaseSensitive, QRegExp::FixedString));
+            int indexOfSubField = field->getElementIndex(subfield3);
             value = field->getDouble(indexOfSubField);
         } else {
             value = field->getDouble();
@@ -425,6 +431,7 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
             dialTimer.start();
         }
         dialError = false;
+        updateItemCaches();
     } else {
         qDebug() << "no file: display default background.";
         m_renderer->load(QString(":/dial/images/empty.svg"));
@@ -464,6 +471,42 @@ void DialGadgetWidget::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
     fitInView(m_background, Qt::KeepAspectRatio);
+    updateItemCaches();
+}
+
+/*!
+   \brief Render the SVG layers once per size into pixmaps
+
+   The needles are cached in item coordinates at their displayed size (device pixel ratio included),
+   so moving or rotating them only transforms the cached pixmap instead of rendering the SVG again.
+   The static layers are cached in device coordinates. The caches are rebuilt when the view is resized.
+ */
+void DialGadgetWidget::updateItemCaches()
+{
+    if (dialError || !m_background) {
+        return;
+    }
+    qreal scale = transform().m11() * devicePixelRatioF();
+    if (scale <= 0) {
+        return;
+    }
+
+    m_background->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    if (fgenabled) {
+        m_foreground->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    }
+    QList<QGraphicsSvgItem *> needles;
+    needles << m_needle1;
+    if (n2enabled && m_needle2 != m_needle1) {
+        needles << m_needle2;
+    }
+    if (n3enabled) {
+        needles << m_needle3;
+    }
+    foreach(QGraphicsSvgItem * needle, needles) {
+        QSizeF size = needle->boundingRect().size() * scale;
+        needle->setCacheMode(QGraphicsItem::ItemCoordinateCache, QSize(qCeil(size.width()), qCeil(size.height())));
+    }
 }
 
 void DialGadgetWidget::setDialFont(QString fontProps)
@@ -115,6 +115,8 @@ private slots:
     void rotateNeedles();
 
 private:
+    static const int DIAL_FRAME_RATE = 50;
+
     QSvgRenderer *m_renderer;
     QGraphicsSvgItem *m_background;
     QGraphicsSvgItem *m_foreground;
@@ -178,5 +180,7 @@ private:
     QTimer dialTimer;
 
     bool beSmooth;
+
+    void updateItemCaches();
 };
 #endif /* DIALGADGETWIDGET_H_ */
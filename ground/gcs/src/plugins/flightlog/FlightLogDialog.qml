@@ -32,7 +32,7 @@ Rectangle {
                     Layout.fillWidth: true
                     Layout.fillHeight: true
                     Layout.preferredHeight: 1000;
-                    model: logManager.logEntries
+                    model: logManager.logEntriesOnDisk ? logManager.logEntriesModel : logManager.logEntries
                     enabled: !logManager.disableControls && logManager.boardConnected
 
                     rowDelegate: Rectangle {
@@ -105,6 +105,10 @@ Rectangle {
                             id: totalEntries
                             text: "<b>" + qsTr("Entries downloaded:") + "</b> " + logManager.logEntriesCount
                         }
+                        Text {
+                            id: downloadRate
+                            text: "<b>" + qsTr("Download rate:") + "</b> " + (logManager.downloadRate / 1024).toFixed(1) + " KiB/s"
+                        }
                         Rectangle {
                             Layout.fillHeight: true
                         }
@@ -141,6 +145,14 @@ Rectangle {
                             Rectangle {
                                 Layout.fillWidth: true
                             }
+                            CheckBox {
+                                id: streamToDiskCB
+                                enabled: !logManager.disableControls && logManager.boardConnected
+                                text: qsTr("Stream to disk")
+                                activeFocusOnPress: true
+                                checked: logManager.streamToDisk
+                                onCheckedChanged: logManager.setStreamToDisk(checked)
+                            }
                             Button {
                                 text: qsTr("Download logs")
                                 enabled: !logManager.disableControls && logManager.boardConnected
@@ -151,6 +163,11 @@ Rectangle {
                         Rectangle {
                             Layout.fillHeight: true
                         }
+                        ProgressBar {
+                            id: exportProgress
+                            Layout.fillWidth: true
+                            value: logManager.exportProgress
+                        }
                         RowLayout {
                             Rectangle {
                                 Layout.fillWidth: true
@@ -355,6 +372,29 @@ Rectangle {
                     Rectangle {
                         Layout.fillWidth: true
                     }
+                    Text {
+                        text: qsTr("Profile: ")
+                    }
+                    ComboBox {
+                        id: profileCombo
+                        editable: true
+                        model: logManager.metadataProfiles
+                        Layout.preferredWidth: 120
+                    }
+                    Button {
+                        enabled: !logManager.disableControls && logManager.boardConnected && profileCombo.currentIndex >= 0
+                        text: qsTr("Apply")
+                        tooltip: qsTr("Switches the board to the telemetry and logging update rates of the profile.")
+                        activeFocusOnPress: true
+                        onClicked: logManager.applyMetadataProfile(profileCombo.currentText)
+                    }
+                    Button {
+                        enabled: !logManager.disableControls && logManager.boardConnected && profileCombo.editText !== ""
+                        text: qsTr("Keep")
+                        tooltip: qsTr("Keeps the current telemetry and logging update rates of all objects as the profile.")
+                        activeFocusOnPress: true
+                        onClicked: logManager.saveMetadataProfile(profileCombo.editText)
+                    }
                     Button {
                         enabled: !logManager.disableControls && logManager.boardConnected
                         text: qsTr("Save to board")
@@ -1,7 +1,7 @@
 TEMPLATE = lib 
 TARGET = FlightLog
 
-QT += widgets qml quick
+QT += widgets qml quick concurrent
 
 include(../../plugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
@@ -11,11 +11,13 @@ include(../../plugins/uavtalk/uavtalk.pri)
 
 HEADERS += \
     flightlogplugin.h \
-    flightlogmanager.h
+    flightlogmanager.h \
+    logentrystore.h
 
 SOURCES += \
     flightlogplugin.cpp \
-    flightlogmanager.cpp
+    flightlogmanager.cpp \
+    logentrystore.cpp
 
 OTHER_FILES += \
     Flightlog.pluginspec \
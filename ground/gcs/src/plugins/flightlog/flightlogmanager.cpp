@@ -33,18 +33,32 @@
 #include <QXmlStreamReader>
 #include <QMessageBox>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QMutexLocker>
+#include <QTimer>
+#include <QBuffer>
+#include <QQueue>
+#include <QMap>
+#include <QtEndian>
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include "debuglogcontrol.h"
-#include "uavobjecthelper.h"
 #include "uavtalk/uavtalk.h"
 #include "utils/logfile.h"
+#include "utils/parquetwriter.h"
 #include "uavdataobject.h"
 #include <uavobjectutil/uavobjectutilmanager.h>
 
 FlightLogManager::FlightLogManager(QObject *parent) :
     QObject(parent), m_disableControls(false),
     m_disableExport(true), m_cancelDownload(false),
-    m_adjustExportedTimestamps(true)
+    m_adjustExportedTimestamps(true), m_pipelinedDownload(true), m_streamToDisk(false), m_logEntriesOnDisk(false),
+    m_downloadRate(0), m_exportProgress(0),
+    m_logEntryDecoder(ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>()),
+    m_logEntryModel(&m_logEntryStore, &m_logEntryDecoder)
 {
     ExtensionSystem::PluginManager *pluginManager = ExtensionSystem::PluginManager::instance();
 
@@ -158,13 +172,22 @@ void FlightLogManager::clearAllLogs()
     setDisableControls(true);
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    // Clear on flight side
-    UAVObjectUpdaterHelper updateHelper;
+    // Clear on flight side, the flash erase takes a while so don't block the GUI meanwhile
+    UAVObjectTransactionGroup *transaction = new UAVObjectTransactionGroup(UAVObjectTransactionGroup::SEQUENCE, this);
 
     m_flightLogControl->setFlight(0);
     m_flightLogControl->setEntry(0);
     m_flightLogControl->setOperation(DebugLogControl::OPERATION_FORMATFLASH);
-    if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
+    transaction->addUpdate(m_flightLogControl, false, UAVTALK_TIMEOUT);
+    connect(transaction, SIGNAL(finished(AbstractUAVObjectHelper::Result)), this, SLOT(clearAllLogsCompleted(AbstractUAVObjectHelper::Result)));
+    transaction->start();
+}
+
+void FlightLogManager::clearAllLogsCompleted(AbstractUAVObjectHelper::Result result)
+{
+    sender()->deleteLater();
+
+    if (result == AbstractUAVObjectHelper::SUCCESS) {
         // Then empty locally
         clearLogList();
     }
@@ -177,6 +200,9 @@ void FlightLogManager::clearLogList()
 {
     QList<ExtendedDebugLogEntry *> tmpList(m_logEntries);
     m_logEntries.clear();
+    m_logEntryStore.close();
+    m_logEntriesOnDisk = false;
+    m_logEntryModel.refresh();
 
     emit logEntriesChanged();
     setDisableExport(true);
@@ -184,6 +210,7 @@ void FlightLogManager::clearLogList()
     while (!tmpList.isEmpty()) {
         delete tmpList.takeFirst();
     }
+    m_logEntryDecoder.clear();
 }
 
 void FlightLogManager::retrieveLogs(int flightToRetrieve)
@@ -191,10 +218,12 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     setDisableControls(true);
     QApplication::setOverrideCursor(Qt::WaitCursor);
     m_cancelDownload = false;
-    UAVObjectUpdaterHelper updateHelper;
-    UAVObjectRequestHelper requestHelper;
 
     clearLogList();
+    if (m_streamToDisk) {
+        // falls back to memory if the temporary file can't be created
+        m_logEntriesOnDisk = m_logEntryStore.open();
+    }
 
     // Set up what to retrieve
     int startFlight = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
@@ -203,76 +232,252 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     // Prepare to send request for event retrieval
     m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
     for (int flight = startFlight; flight <= endFlight; flight++) {
-        m_flightLogControl->setFlight(flight);
-        bool gotLast = false;
-        int slot     = 0;
-        while (!gotLast) {
-            // Send request for loading flight entry on flight side and wait for ack/nack
-            m_flightLogControl->setEntry(slot);
-
-            if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
-                requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
-                if (m_flightLogEntry->getType() != DebugLogEntry::TYPE_EMPTY) {
-                    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
-                    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
-
-                    logEntry->setData(m_flightLogEntry->getData(), m_objectManager);
-                    m_logEntries << logEntry;
-                    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-                        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
-                        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
-                        const quint32 header_len = total_len - data_len;
-
-                        DebugLogEntry::DataFields fields;
-                        quint32 start = logEntry->getData().Size;
-
-                        // cycle until there is space for another object
-                        while (start + header_len + 1 < data_len) {
-                            memset(&fields, 0xFF, total_len);
-                            memcpy(&fields, &logEntry->getData().Data[start], header_len);
-                            // check wether a packed object is found
-                            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
-                            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
-                            quint32 toread = header_len + fields.Size;
-                            if (!(toread + start > data_len)) {
-                                memcpy(&fields, &logEntry->getData().Data[start], toread);
-                                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
-                                subEntry->setData(fields, m_objectManager);
-                                m_logEntries << subEntry;
-                            }
-                            start += toread;
-                        }
-                    }
+        bool success = m_pipelinedDownload ? retrieveFlightEntriesPipelined(flight) : retrieveFlightEntries(flight);
+        m_logEntryModel.refresh();
+        if (!success || m_cancelDownload) {
+            break;
+        }
+    }
+
+    if (m_cancelDownload) {
+        clearLogList();
+        m_cancelDownload = false;
+    }
+
+    emit logEntriesChanged();
+    setDisableExport(entryCount() == 0);
+
+    QApplication::restoreOverrideCursor();
+    setDisableControls(false);
+}
+
+/**
+ * Retrieve the entries of a flight one at a time, waiting for each round trip
+ * @returns false if the retrieval failed or was cancelled
+ */
+bool FlightLogManager::retrieveFlightEntries(int flight)
+{
+    UAVObjectUpdaterHelper updateHelper;
+    UAVObjectRequestHelper requestHelper;
+    QElapsedTimer timer;
+    qint64 bytes = 0;
+
+    timer.start();
+    m_flightLogControl->setFlight(flight);
+    int slot = 0;
+    while (!m_cancelDownload) {
+        // Send request for loading flight entry on flight side and wait for ack/nack
+        m_flightLogControl->setEntry(slot);
+
+        if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) != UAVObjectUpdaterHelper::SUCCESS ||
+            requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) != UAVObjectUpdaterHelper::SUCCESS) {
+            // We failed for some reason
+            return false;
+        }
+        if (m_flightLogEntry->getType() == DebugLogEntry::TYPE_EMPTY) {
+            // We are done, not more entries on this flight
+            return true;
+        }
+        // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
+        addLogEntry(m_flightLogEntry->getData());
+        bytes += m_flightLogEntry->getNumBytes();
+        updateDownloadRate(bytes, timer.elapsed());
+
+        // Increment to get next entry from flight side
+        slot++;
+    }
+    return false;
+}
+
+/**
+ * Retrieve the entries of a flight keeping several requests in flight.
+ * The flight side holds a single loaded entry, replies are matched to the requested slots
+ * through their flight and entry numbers, reordered, and the lost or stale ones are requested again.
+ * @returns false if the retrieval failed or was cancelled
+ */
+bool FlightLogManager::retrieveFlightEntriesPipelined(int flight)
+{
+    // slot -> time of the last request and number of requests
+    QMap<int, qint64> pendingTimes;
+    QMap<int, int> pendingRequests;
+    // replies waiting for the previous slots
+    QMap<int, DebugLogEntry::DataFields> received;
+    int nextSlot  = 0;
+    int nextEntry = 0;
+    // first empty slot, the end of the flight
+    int endSlot   = -1;
+    qint64 bytes  = 0;
+    bool success  = true;
+    QElapsedTimer timer;
+
+    {
+        QMutexLocker locker(&m_entryRepliesMutex);
+        m_entryReplies.clear();
+    }
+    // the replies are unpacked in the telemetry thread, collect them there before they get overwritten
+    connect(m_flightLogEntry, &UAVObject::objectUnpacked, this, &FlightLogManager::logEntryReceived, Qt::DirectConnection);
+
+    timer.start();
+    while (!m_cancelDownload) {
+        // keep the pipeline full
+        while (pendingTimes.size() < PIPELINE_DEPTH && (endSlot < 0 || nextSlot < endSlot)) {
+            requestFlightEntry(flight, nextSlot);
+            pendingTimes.insert(nextSlot, timer.elapsed());
+            pendingRequests.insert(nextSlot, 1);
+            nextSlot++;
+        }
 
-                    // Increment to get next entry from flight side
-                    slot++;
-                } else {
-                    // We are done, not more entries on this flight
-                    gotLast = true;
+        // wait a bit for the replies
+        QEventLoop loop;
+        QTimer::singleShot(PIPELINE_POLL_MS, &loop, SLOT(quit()));
+        loop.exec();
+
+        QList<DebugLogEntry::DataFields> replies;
+        {
+            QMutexLocker locker(&m_entryRepliesMutex);
+            replies.swap(m_entryReplies);
+        }
+        foreach(const DebugLogEntry::DataFields &data, replies) {
+            int slot = data.Entry;
+            if (data.Flight != flight || !pendingTimes.contains(slot)) {
+                // stale or duplicated reply
+                continue;
+            }
+            pendingTimes.remove(slot);
+            pendingRequests.remove(slot);
+            if (data.Type == DebugLogEntry::TYPE_EMPTY) {
+                if (endSlot < 0 || slot < endSlot) {
+                    endSlot = slot;
                 }
             } else {
-                // We failed for some reason
-                break;
+                received.insert(slot, data);
+                bytes += sizeof(DebugLogEntry::DataFields);
             }
-            if (m_cancelDownload) {
+        }
+
+        // entries past the end of the flight are not needed
+        if (endSlot >= 0) {
+            while (!pendingTimes.isEmpty() && pendingTimes.lastKey() >= endSlot) {
+                pendingRequests.remove(pendingTimes.lastKey());
+                pendingTimes.remove(pendingTimes.lastKey());
+            }
+        }
+
+        // add the entries in slot order
+        while (received.contains(nextEntry)) {
+            addLogEntry(received.take(nextEntry));
+            nextEntry++;
+        }
+        updateDownloadRate(bytes, timer.elapsed());
+
+        if (endSlot >= 0 && nextEntry >= endSlot) {
+            break;
+        }
+
+        // request again the entries whose reply was lost or overwritten
+        qint64 now = timer.elapsed();
+        QList<int> pendingSlots = pendingTimes.keys();
+        foreach(int slot, pendingSlots) {
+            if (now - pendingTimes.value(slot) < PIPELINE_TIMEOUT) {
+                continue;
+            }
+            if (pendingRequests.value(slot) >= PIPELINE_RETRIES) {
+                qWarning() << "FlightLogManager - failed to retrieve entry" << slot << "of flight" << flight;
+                success = false;
                 break;
             }
+            requestFlightEntry(flight, slot);
+            pendingTimes.insert(slot, now);
+            pendingRequests[slot]++;
         }
-        if (m_cancelDownload) {
+        if (!success) {
             break;
         }
     }
 
-    if (m_cancelDownload) {
-        clearLogList();
-        m_cancelDownload = false;
+    disconnect(m_flightLogEntry, &UAVObject::objectUnpacked, this, &FlightLogManager::logEntryReceived);
+
+    return success && !m_cancelDownload;
+}
+
+/**
+ * Ask the flight side to load an entry and request it, without waiting
+ */
+void FlightLogManager::requestFlightEntry(int flight, int slot)
+{
+    m_flightLogControl->setFlight(flight);
+    m_flightLogControl->setEntry(slot);
+    m_flightLogControl->updated();
+    m_flightLogEntry->requestUpdate();
+}
+
+/**
+ * Called from the telemetry thread each time a log entry is received during a pipelined download
+ */
+void FlightLogManager::logEntryReceived(UAVObject *object)
+{
+    DebugLogEntry::DataFields data = static_cast<DebugLogEntry *>(object)->getData();
+
+    QMutexLocker locker(&m_entryRepliesMutex);
+
+    m_entryReplies.append(data);
+}
+
+void FlightLogManager::addLogEntry(const DebugLogEntry::DataFields &data)
+{
+    appendLogEntry(data);
+    if (data.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
+        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
+        const quint32 header_len = total_len - data_len;
+
+        DebugLogEntry::DataFields fields;
+        quint32 start = data.Size;
+
+        // cycle until there is space for another object
+        while (start + header_len + 1 < data_len) {
+            memset(&fields, 0xFF, total_len);
+            memcpy(&fields, &data.Data[start], header_len);
+            // check wether a packed object is found
+            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
+            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
+            quint32 toread = header_len + fields.Size;
+            if (!(toread + start > data_len)) {
+                memcpy(&fields, &data.Data[start], toread);
+                appendLogEntry(fields);
+            }
+            start += toread;
+        }
     }
+}
 
-    emit logEntriesChanged();
-    setDisableExport(m_logEntries.count() == 0);
+void FlightLogManager::appendLogEntry(const DebugLogEntry::DataFields &data)
+{
+    if (m_logEntriesOnDisk) {
+        if (!m_logEntryStore.append(data)) {
+            qWarning() << "FlightLogManager - failed to write entry" << data.Entry << "of flight" << data.Flight;
+        }
+        return;
+    }
 
-    QApplication::restoreOverrideCursor();
-    setDisableControls(false);
+    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
+    logEntry->setData(data, &m_logEntryDecoder);
+    m_logEntries << logEntry;
+}
+
+DebugLogEntry::DataFields FlightLogManager::entryData(int index)
+{
+    return m_logEntriesOnDisk ? m_logEntryStore.at(index) : m_logEntries.at(index)->getData();
+}
+
+void FlightLogManager::updateDownloadRate(qint64 bytes, qint64 elapsedMs)
+{
+    double rate = (elapsedMs > 0) ? (bytes * 1000.0 / elapsedMs) : 0;
+
+    if (m_downloadRate != rate) {
+        m_downloadRate = rate;
+        emit downloadRateChanged(rate);
+    }
 }
 
 void FlightLogManager::exportToOPL(QString fileName)
@@ -285,13 +490,14 @@ void FlightLogManager::exportToOPL(QString fileName)
     int currentFlight = 0;
     quint32 adjustedBaseTime = 0;
     // Continue until all entries are exported
-    while (currentEntry < m_logEntries.count()) {
+    while (currentEntry < entryCount()) {
+        DebugLogEntry::DataFields entry = entryData(currentEntry);
         if (m_adjustExportedTimestamps) {
-            adjustedBaseTime = m_logEntries[currentEntry]->getFlightTime();
+            adjustedBaseTime = entry.FlightTime;
         }
 
         // Get current flight
-        currentFlight = m_logEntries[currentEntry]->getFlight();
+        currentFlight = entry.Flight;
 
         LogFile logFile;
         logFile.useProvidedTimeStamp(true);
@@ -302,17 +508,16 @@ void FlightLogManager::exportToOPL(QString fileName)
         UAVTalk uavTalk(&logFile, m_objectManager);
 
         // Export entries until no more available or flight changes
-        while (currentEntry < m_logEntries.count() && m_logEntries[currentEntry]->getFlight() == currentFlight) {
-            ExtendedDebugLogEntry *entry = m_logEntries[currentEntry];
-
+        while (currentEntry < entryCount() && (entry = entryData(currentEntry)).Flight == currentFlight) {
             // Only log uavobjects
-            if (entry->getType() == ExtendedDebugLogEntry::TYPE_UAVOBJECT || entry->getType() == ExtendedDebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+            bool isUAVObject = entry.Type == DebugLogEntry::TYPE_UAVOBJECT || entry.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS;
+            UAVDataObject *object = isUAVObject ? m_logEntryDecoder.decode(entry) : NULL;
+            if (object) {
                 // Set timestamp that should be logged for this entry
-                logFile.setNextTimeStamp(entry->getFlightTime() - adjustedBaseTime);
+                logFile.setNextTimeStamp(entry.FlightTime - adjustedBaseTime);
 
                 // Use UAVTalk to log complete message to file
-                uavTalk.sendObject(entry->uavObject(), false, false);
-                qDebug() << entry->getFlightTime() - adjustedBaseTime << "=" << entry->toStringBrief();
+                uavTalk.sendObject(object, false, false);
             }
             currentEntry++;
         }
@@ -321,25 +526,136 @@ void FlightLogManager::exportToOPL(QString fileName)
     }
 }
 
+void FlightLogManager::setExportProgress(double progress)
+{
+    if (m_exportProgress != progress) {
+        m_exportProgress = progress;
+        emit exportProgressChanged(progress);
+    }
+}
+
+QVector<quint32> FlightLogManager::exportBaseTimes()
+{
+    // Timestamps are relative to the first entry of each flight, resolve them up front
+    // so that every chunk can be formatted on its own
+    QVector<quint32> baseTimes(entryCount());
+    quint32 baseTime = 0;
+    quint32 currentFlight = 0;
+
+    for (int i = 0; i < baseTimes.count(); i++) {
+        DebugLogEntry::DataFields entry = entryData(i);
+        if (m_adjustExportedTimestamps && entry.Flight != currentFlight) {
+            currentFlight = entry.Flight;
+            baseTime = entry.FlightTime;
+        }
+        baseTimes[i] = baseTime;
+    }
+    return baseTimes;
+}
+
+bool FlightLogManager::exportEntries(QIODevice *device, ChunkFormatter formatter)
+{
+    QVector<quint32> baseTimes = exportBaseTimes();
+
+    // Format chunks on the thread pool and write them in order as they complete,
+    // keeping only a few chunks in flight so memory stays bounded
+    const int chunkCount = (entryCount() + EXPORT_CHUNK_SIZE - 1) / EXPORT_CHUNK_SIZE;
+    const int maxPending = qMax(2, QThreadPool::globalInstance()->maxThreadCount() * 2);
+    QQueue<QFuture<QByteArray> > pending;
+    // entries read back from the disk for the pending chunks, deleted once formatted
+    QQueue<QList<ExtendedDebugLogEntry *> > loaded;
+    int nextChunk = 0;
+    int written   = 0;
+
+    m_cancelDownload = false;
+    setExportProgress(0);
+    while (written < chunkCount && !m_cancelDownload) {
+        while (nextChunk < chunkCount && pending.count() < maxPending) {
+            int begin = nextChunk * EXPORT_CHUNK_SIZE;
+            int end   = qMin(begin + EXPORT_CHUNK_SIZE, entryCount());
+            if (m_logEntriesOnDisk) {
+                QList<ExtendedDebugLogEntry *> entries;
+                for (int i = begin; i < end; i++) {
+                    ExtendedDebugLogEntry *entry = new ExtendedDebugLogEntry();
+                    entry->setData(m_logEntryStore.at(i), NULL);
+                    entries << entry;
+                }
+                loaded.enqueue(entries);
+                pending.enqueue(QtConcurrent::run(formatter, m_objectManager, entries, baseTimes.mid(begin, end - begin), 0, end - begin));
+            } else {
+                pending.enqueue(QtConcurrent::run(formatter, m_objectManager, m_logEntries, baseTimes, begin, end));
+            }
+            nextChunk++;
+        }
+
+        // Keep the dialog responsive (and the cancel button working) while waiting
+        QFutureWatcher<QByteArray> watcher;
+        QEventLoop loop;
+        connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+        watcher.setFuture(pending.head());
+        loop.exec();
+
+        device->write(pending.dequeue().result());
+        if (!loaded.isEmpty()) {
+            qDeleteAll(loaded.dequeue());
+        }
+        written++;
+        setExportProgress((double)written / chunkCount);
+    }
+
+    foreach(QFuture<QByteArray> future, pending) {
+        future.waitForFinished();
+    }
+    while (!loaded.isEmpty()) {
+        qDeleteAll(loaded.dequeue());
+    }
+    return written == chunkCount;
+}
+
+QByteArray FlightLogManager::formatCSVChunk(UAVObjectManager *objectManager, const QList<ExtendedDebugLogEntry *> &entries,
+                                            const QVector<quint32> &baseTimes, int begin, int end)
+{
+    LogEntryDecoder decoder(objectManager);
+    QByteArray csv;
+
+    for (int i = begin; i < end; i++) {
+        entries.at(i)->toCSV(csv, baseTimes.at(i), &decoder);
+    }
+    return csv;
+}
+
+QByteArray FlightLogManager::formatXMLChunk(UAVObjectManager *objectManager, const QList<ExtendedDebugLogEntry *> &entries,
+                                            const QVector<quint32> &baseTimes, int begin, int end)
+{
+    LogEntryDecoder decoder(objectManager);
+    QByteArray xml;
+    QBuffer buffer(&xml);
+
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter xmlWriter(&buffer);
+    xmlWriter.setAutoFormatting(true);
+    xmlWriter.setAutoFormattingIndent(4);
+
+    // Open the same document element as the exported file so entries get its indentation,
+    // then return the entries only
+    xmlWriter.writeStartElement("logs");
+    for (int i = begin; i < end; i++) {
+        entries.at(i)->toXML(&xmlWriter, baseTimes.at(i), &decoder);
+    }
+    return xml.mid(xml.indexOf('>') + 1);
+}
+
 void FlightLogManager::exportToCSV(QString fileName)
 {
     QFile csvFile(fileName);
 
     if (csvFile.open(QFile::WriteOnly | QFile::Truncate)) {
-        QTextStream csvStream(&csvFile);
-        quint32 baseTime = 0;
-        quint32 currentFlight = 0;
-        csvStream << "Flight" << '\t' << "Flight Time" << '\t' << "Entry" << '\t' << "Data" << '\n';
-        foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
-            if (m_adjustExportedTimestamps && entry->getFlight() != currentFlight) {
-                currentFlight = entry->getFlight();
-                baseTime = entry->getFlightTime();
-            }
-            entry->toCSV(&csvStream, baseTime);
-        }
-        csvStream.flush();
-        csvFile.flush();
+        csvFile.write("Flight\tFlight Time\tEntry\tData\n");
+        bool completed = exportEntries(&csvFile, &FlightLogManager::formatCSVChunk);
         csvFile.close();
+        if (!completed) {
+            csvFile.remove();
+        }
     }
 }
 
@@ -356,25 +672,256 @@ void FlightLogManager::exportToXML(QString fileName)
         xmlWriter.writeStartElement("logs");
         xmlWriter.writeComment("This file was created by the flight log export in OpenPilot GCS.");
 
-        quint32 baseTime = 0;
-        quint32 currentFlight = 0;
-        foreach(ExtendedDebugLogEntry * entry, m_logEntries) {
-            if (m_adjustExportedTimestamps && entry->getFlight() != currentFlight) {
-                currentFlight = entry->getFlight();
-                baseTime = entry->getFlightTime();
-            }
-            entry->toXML(&xmlWriter, baseTime);
-        }
+        bool completed = exportEntries(&xmlFile, &FlightLogManager::formatXMLChunk);
         xmlWriter.writeEndElement();
         xmlWriter.writeEndDocument();
-        xmlFile.flush();
         xmlFile.close();
+        if (!completed) {
+            xmlFile.remove();
+        }
+    }
+}
+
+namespace {
+// Where the value of a Parquet column is in the data of a log entry
+struct ParquetColumnSource {
+    quint32 offset;
+    quint32 size;
+    UAVObjectField::FieldType type;
+    QList<QByteArray> options;
+};
+
+// The table of one object type: its columns and the log entries holding that object
+struct ParquetTable {
+    QList<Utils::ParquetWriter::Column> columns;
+    QList<ParquetColumnSource> sources;
+    QVector<int> entries;
+};
+
+void addParquetColumn(ParquetTable &table, const QString &name, Utils::ParquetWriter::Type type,
+                      Utils::ParquetWriter::ConvertedType convertedType)
+{
+    Utils::ParquetWriter::Column column = { name, type, convertedType };
+
+    table.columns.append(column);
+}
+
+/**
+ * Columns of the table of an object type: the flight, flight time and instance of the entries,
+ * then one typed column per field element. Enums are exported as their option names.
+ */
+ParquetTable parquetTable(UAVDataObject *object)
+{
+    ParquetTable table;
+
+    addParquetColumn(table, "Flight", Utils::ParquetWriter::INT32, Utils::ParquetWriter::UINT_16);
+    addParquetColumn(table, "FlightTime", Utils::ParquetWriter::INT32, Utils::ParquetWriter::UINT_32);
+    addParquetColumn(table, "Instance", Utils::ParquetWriter::INT32, Utils::ParquetWriter::UINT_16);
+    foreach(UAVObjectField * field, object->getFields()) {
+        ParquetColumnSource source;
+        source.type = field->getType();
+        source.size = field->getNumBytes() / field->getNumElements();
+        foreach(const QString &option, field->getOptions()) {
+            source.options.append(option.toUtf8());
+        }
+        if (source.type == UAVObjectField::STRING) {
+            // the elements are the characters of a single value
+            source.offset = field->getDataOffset();
+            source.size   = field->getNumBytes();
+            table.sources.append(source);
+            addParquetColumn(table, field->getName(), Utils::ParquetWriter::BYTE_ARRAY, Utils::ParquetWriter::UTF8);
+            continue;
+        }
+
+        QStringList elementNames = field->getElementNames();
+        for (quint32 i = 0; i < field->getNumElements(); i++) {
+            QString name = field->getNumElements() > 1 ? QString("%1.%2").arg(field->getName(), elementNames.value(i)) : field->getName();
+            source.offset = field->getDataOffset() + i * source.size;
+            table.sources.append(source);
+            switch (source.type) {
+            case UAVObjectField::INT8:
+                addParquetColumn(table, name, Utils::ParquetWriter::INT32, Utils::ParquetWriter::INT_8);
+                break;
+            case UAVObjectField::INT16:
+                addParquetColumn(table, name, Utils::ParquetWriter::INT32, Utils::ParquetWriter::INT_16);
+                break;
+            case UAVObjectField::INT32:
+                addParquetColumn(table, name, Utils::ParquetWriter::INT32, Utils::ParquetWriter::NONE);
+                break;
+            case UAVObjectField::UINT8:
+            case UAVObjectField::BITFIELD:
+                addParquetColumn(table, name, Utils::ParquetWriter::INT32, Utils::ParquetWriter::UINT_8);
+                break;
+            case UAVObjectField::UINT16:
+                addParquetColumn(table, name, Utils::ParquetWriter::INT32, Utils::ParquetWriter::UINT_16);
+                break;
+            case UAVObjectField::UINT32:
+                addParquetColumn(table, name, Utils::ParquetWriter::INT32, Utils::ParquetWriter::UINT_32);
+                break;
+            case UAVObjectField::FLOAT32:
+                addParquetColumn(table, name, Utils::ParquetWriter::FLOAT, Utils::ParquetWriter::NONE);
+                break;
+            default:
+                addParquetColumn(table, name, Utils::ParquetWriter::BYTE_ARRAY, Utils::ParquetWriter::UTF8);
+                break;
+            }
+        }
+    }
+    return table;
+}
+
+/**
+ * Encode the rows of a table, straight from the packed (little endian) data of their entries
+ */
+Utils::ParquetWriter::EncodedRowGroup formatParquetRowGroup(const ParquetTable &table, const QVector<DebugLogEntry::DataFields> &entries,
+                                                            const QVector<quint32> &baseTimes)
+{
+    Utils::ParquetWriter::RowGroup group(table.columns.count());
+
+    for (int row = 0; row < entries.count(); row++) {
+        const DebugLogEntry::DataFields &fields = entries.at(row);
+        group.appendInt32(0, fields.Flight + 1);
+        group.appendInt32(1, fields.FlightTime - baseTimes.at(row));
+        group.appendInt32(2, fields.InstanceID);
+        for (int i = 0; i < table.sources.count(); i++) {
+            const ParquetColumnSource &source = table.sources.at(i);
+            const quint8 *value = &fields.Data[source.offset];
+            switch (source.type) {
+            case UAVObjectField::INT8:
+                group.appendInt32(i + 3, (qint8)*value);
+                break;
+            case UAVObjectField::INT16:
+                group.appendInt32(i + 3, qFromLittleEndian<qint16>(value));
+                break;
+            case UAVObjectField::INT32:
+            case UAVObjectField::UINT32:
+                group.appendInt32(i + 3, qFromLittleEndian<qint32>(value));
+                break;
+            case UAVObjectField::UINT8:
+            case UAVObjectField::BITFIELD:
+                group.appendInt32(i + 3, *value);
+                break;
+            case UAVObjectField::UINT16:
+                group.appendInt32(i + 3, qFromLittleEndian<quint16>(value));
+                break;
+            case UAVObjectField::FLOAT32:
+            {
+                quint32 bits = qFromLittleEndian<quint32>(value);
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                group.appendFloat(i + 3, f);
+                break;
+            }
+            case UAVObjectField::ENUM:
+                group.appendString(i + 3, *value < source.options.count() ? source.options.at(*value) : QByteArray::number(*value));
+                break;
+            case UAVObjectField::STRING:
+                group.appendString(i + 3, QByteArray((const char *)value, qstrnlen((const char *)value, source.size)));
+                break;
+            }
+        }
+        group.endRow();
+    }
+    return Utils::ParquetWriter::encode(table.columns, group);
+}
+}
+
+void FlightLogManager::exportToParquet(QString fileName)
+{
+    // Parquet files hold a single table, write one file per object type
+    fileName.replace(QString(".parquet"), QString("%1.parquet"));
+
+    QMap<QString, ParquetTable> tables;
+    QHash<quint32, ParquetTable *> tablesById;
+    int rows = 0;
+    for (int i = 0; i < entryCount(); i++) {
+        DebugLogEntry::DataFields entry = entryData(i);
+        if (entry.Type != DebugLogEntry::TYPE_UAVOBJECT && entry.Type != DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+            continue;
+        }
+        quint32 objId = entry.ObjectID;
+        ParquetTable *table = tablesById.value(objId);
+        if (!table) {
+            UAVDataObject *object = qobject_cast<UAVDataObject *>(m_objectManager->getObject(objId));
+            if (!object || object->getNumBytes() > sizeof(((DebugLogEntry::DataFields *)0)->Data)) {
+                continue;
+            }
+            table = &(tables[object->getName()] = parquetTable(object));
+            tablesById.insert(objId, table);
+        }
+        table->entries.append(i);
+        rows++;
+    }
+
+    QVector<quint32> baseTimes = exportBaseTimes();
+    const int maxPending = qMax(2, QThreadPool::globalInstance()->maxThreadCount() * 2);
+    QStringList written;
+    int rowsWritten = 0;
+    bool completed  = true;
+
+    m_cancelDownload = false;
+    setExportProgress(0);
+    for (QMap<QString, ParquetTable>::const_iterator table = tables.constBegin(); completed && table != tables.constEnd(); ++table) {
+        QFile file(fileName.arg("_" + table.key()));
+        if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+            completed = false;
+            break;
+        }
+        written << file.fileName();
+
+        // Encode the row groups on the thread pool and write them in order, as for the CSV/XML export
+        Utils::ParquetWriter writer(&file, table->columns);
+        QQueue<QFuture<Utils::ParquetWriter::EncodedRowGroup> > pending;
+        const int groupCount = (table->entries.count() + EXPORT_ROW_GROUP_SIZE - 1) / EXPORT_ROW_GROUP_SIZE;
+        int nextGroup = 0;
+        int groups    = 0;
+        while (completed && groups < groupCount) {
+            while (nextGroup < groupCount && pending.count() < maxPending) {
+                int begin = nextGroup * EXPORT_ROW_GROUP_SIZE;
+                int end   = qMin(begin + EXPORT_ROW_GROUP_SIZE, table->entries.count());
+                // the entries of the group are copied out, they may have to be read back from the disk
+                QVector<DebugLogEntry::DataFields> entries;
+                QVector<quint32> entryBaseTimes;
+                entries.reserve(end - begin);
+                entryBaseTimes.reserve(end - begin);
+                for (int row = begin; row < end; row++) {
+                    int index = table->entries.at(row);
+                    entries.append(entryData(index));
+                    entryBaseTimes.append(baseTimes.at(index));
+                }
+                pending.enqueue(QtConcurrent::run(formatParquetRowGroup, *table, entries, entryBaseTimes));
+                nextGroup++;
+            }
+
+            QFutureWatcher<Utils::ParquetWriter::EncodedRowGroup> watcher;
+            QEventLoop loop;
+            connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+            watcher.setFuture(pending.head());
+            loop.exec();
+
+            Utils::ParquetWriter::EncodedRowGroup group = pending.dequeue().result();
+            completed    = !m_cancelDownload && writer.write(group);
+            rowsWritten += group.rows;
+            groups++;
+            setExportProgress((double)rowsWritten / rows);
+        }
+        foreach(QFuture<Utils::ParquetWriter::EncodedRowGroup> future, pending) {
+            future.waitForFinished();
+        }
+        completed = completed && writer.close();
+        file.close();
+    }
+
+    if (!completed) {
+        foreach(const QString &name, written) {
+            QFile::remove(name);
+        }
     }
 }
 
 void FlightLogManager::exportLogs()
 {
-    if (m_logEntries.isEmpty()) {
+    if (entryCount() == 0) {
         return;
     }
 
@@ -384,11 +931,12 @@ void FlightLogManager::exportLogs()
     QString oplFilter = tr("OpenPilot Log file %1").arg("(*.opl)");
     QString csvFilter = tr("Text file %1").arg("(*.csv)");
     QString xmlFilter = tr("XML file %1").arg("(*.xml)");
+    QString parquetFilter = tr("Parquet files, one per object %1").arg("(*.parquet)");
 
     QString selectedFilter = csvFilter;
 
     QString fileName = QFileDialog::getSaveFileName(NULL, tr("Save Log Entries"), QDir::homePath(),
-                                                    QString("%1;;%2;;%3").arg(oplFilter, csvFilter, xmlFilter), &selectedFilter);
+                                                    QString("%1;;%2;;%3;;%4").arg(oplFilter, csvFilter, xmlFilter, parquetFilter), &selectedFilter);
     if (!fileName.isEmpty()) {
         if (selectedFilter == oplFilter) {
             if (!fileName.endsWith(".opl")) {
@@ -405,6 +953,11 @@ void FlightLogManager::exportLogs()
                 fileName.append(".xml");
             }
             exportToXML(fileName);
+        } else if (selectedFilter == parquetFilter) {
+            if (!fileName.endsWith(".parquet")) {
+                fileName.append(".parquet");
+            }
+            exportToParquet(fileName);
         }
     }
 
@@ -526,23 +1079,54 @@ void FlightLogManager::saveSettingsToBoard()
     m_flightLogSettings->updated();
     saveUAVObjectToFlash(m_flightLogSettings);
 
+    QHash<UAVDataObject *, UAVObject::Metadata> metadata;
     foreach(UAVOLogSettingsWrapper * wrapper, m_uavoEntries) {
         if (wrapper->dirty()) {
             UAVObject::Metadata meta = wrapper->object()->getMetadata();
             wrapper->object()->SetLoggingUpdateMode(meta, wrapper->settingAsUpdateMode());
             meta.loggingUpdatePeriod = wrapper->period();
+            metadata.insert(wrapper->object(), meta);
+            wrapper->setDirty(false);
+        }
+    }
 
-            // As metadata are set up to update via telemetry on change
-            // this call will send the update to the board.
-            wrapper->object()->setMetadata(meta);
+    // the changed metadata are uploaded and saved as one pipelined batch
+    m_objectUtilManager->applyMetadata(metadata, true);
+}
 
-            if (saveUAVObjectToFlash(wrapper->object()->getMetaObject())) {
-                wrapper->setDirty(false);
-            }
-        }
+QStringList FlightLogManager::metadataProfiles() const
+{
+    return m_objectUtilManager->metadataProfiles();
+}
+
+void FlightLogManager::saveMetadataProfile(QString name)
+{
+    name = name.trimmed();
+    if (name.isEmpty()) {
+        return;
+    }
+    m_objectUtilManager->saveMetadataProfile(name);
+    emit metadataProfilesChanged();
+}
+
+/**
+ * Switch the board to the telemetry and logging update rates of a profile.
+ * The metadata are uploaded, not saved to flash.
+ */
+void FlightLogManager::applyMetadataProfile(QString name)
+{
+    m_objectUtilManager->applyMetadataProfile(name, false);
+    foreach(UAVOLogSettingsWrapper * wrapper, m_uavoEntries) {
+        wrapper->reset(false);
     }
 }
 
+void FlightLogManager::removeMetadataProfile(QString name)
+{
+    m_objectUtilManager->removeMetadataProfile(name);
+    emit metadataProfilesChanged();
+}
+
 bool FlightLogManager::saveUAVObjectToFlash(UAVObject *object)
 {
     m_objectUtilManager->saveObjectToSD(object);
@@ -625,30 +1209,68 @@ bool FlightLogManager::updateLogWrapper(QString name, int level, int period)
     return false;
 }
 
+LogEntryDecoder::LogEntryDecoder(UAVObjectManager *objectManager) :
+    m_objectManager(objectManager)
+{}
+
+LogEntryDecoder::~LogEntryDecoder()
+{
+    clear();
+}
+
+UAVDataObject *LogEntryDecoder::decode(const DebugLogEntry::DataFields &data)
+{
+    quint64 key = ((quint64)data.ObjectID << 16) | data.InstanceID;
+    UAVDataObject *object = m_scratchObjects.value(key);
+
+    if (!object) {
+        UAVDataObject *registered = qobject_cast<UAVDataObject *>(m_objectManager->getObject(data.ObjectID));
+        if (!registered) {
+            return NULL;
+        }
+        object = registered->clone(data.InstanceID);
+        m_scratchObjects.insert(key, object);
+    }
+    object->unpack(data.Data);
+    return object;
+}
+
+void LogEntryDecoder::clear()
+{
+    qDeleteAll(m_scratchObjects);
+    m_scratchObjects.clear();
+}
+
 ExtendedDebugLogEntry::ExtendedDebugLogEntry() : DebugLogEntry(),
-    m_object(0)
+    m_decoder(0)
 {}
 
 ExtendedDebugLogEntry::~ExtendedDebugLogEntry()
+{}
+
+UAVDataObject *ExtendedDebugLogEntry::uavObject(LogEntryDecoder *decoder)
 {
-    if (m_object) {
-        delete m_object;
-        m_object = 0;
-    }
+    return decoder ? decoder->decode(getData()) : NULL;
 }
 
 QString ExtendedDebugLogEntry::getLogString()
 {
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
-        return QString((const char *)getData().Data);
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        return m_object->toString().replace("\n", " ").replace("\t", " ");
+    return logString(getData(), m_decoder);
+}
+
+QString ExtendedDebugLogEntry::logString(const DataFields &data, LogEntryDecoder *decoder)
+{
+    if (data.Type == DebugLogEntry::TYPE_TEXT) {
+        return QString::fromUtf8((const char *)data.Data, qstrnlen((const char *)data.Data, sizeof(data.Data)));
+    } else if (data.Type == DebugLogEntry::TYPE_UAVOBJECT || data.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        UAVDataObject *object = decoder ? decoder->decode(data) : NULL;
+        return object ? object->toString().replace("\n", " ").replace("\t", " ") : QString();
     } else {
         return "";
     }
 }
 
-void ExtendedDebugLogEntry::toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime)
+void ExtendedDebugLogEntry::toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime, LogEntryDecoder *decoder)
 {
     xmlWriter->writeStartElement("entry");
     xmlWriter->writeAttribute("flight", QString::number(getFlight() + 1));
@@ -657,35 +1279,38 @@ void ExtendedDebugLogEntry::toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime)
     if (getType() == DebugLogEntry::TYPE_TEXT) {
         xmlWriter->writeAttribute("type", "text");
         xmlWriter->writeTextElement("message", QString((const char *)getData().Data));
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+    } else if (isUAVObject()) {
         xmlWriter->writeAttribute("type", "uavobject");
-        m_object->toXML(xmlWriter);
+        UAVDataObject *object = uavObject(decoder);
+        if (object) {
+            object->toXML(xmlWriter);
+        }
     }
     xmlWriter->writeEndElement(); // entry
 }
 
-void ExtendedDebugLogEntry::toCSV(QTextStream *csvStream, quint32 baseTime)
+void ExtendedDebugLogEntry::toCSV(QByteArray &csv, quint32 baseTime, LogEntryDecoder *decoder)
 {
-    QString data;
-
-    if (getType() == DebugLogEntry::TYPE_TEXT) {
-        data = QString((const char *)getData().Data);
-    } else if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        data = m_object->toString().replace("\n", "").replace("\t", "");
+    DataFields fields = getData();
+
+    csv.append(QByteArray::number(fields.Flight + 1)).append('\t');
+    csv.append(QByteArray::number(fields.FlightTime - baseTime)).append('\t');
+    csv.append(QByteArray::number(fields.Entry)).append('\t');
+    if (fields.Type == DebugLogEntry::TYPE_TEXT) {
+        csv.append(QByteArray((const char *)fields.Data, qstrnlen((const char *)fields.Data, sizeof(fields.Data))));
+    } else if (isUAVObject()) {
+        UAVDataObject *object = uavObject(decoder);
+        if (object) {
+            csv.append(object->toString().remove('\n').remove('\t').toUtf8());
+        }
     }
-    *csvStream << QString::number(getFlight() + 1) << '\t' << QString::number(getFlightTime() - baseTime) << '\t' << QString::number(getEntry()) << '\t' << data << '\n';
+    csv.append('\n');
 }
 
-void ExtendedDebugLogEntry::setData(const DebugLogEntry::DataFields &data, UAVObjectManager *objectManager)
+void ExtendedDebugLogEntry::setData(const DebugLogEntry::DataFields &data, LogEntryDecoder *decoder)
 {
     DebugLogEntry::setData(data);
-
-    if (getType() == DebugLogEntry::TYPE_UAVOBJECT || getType() == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-        UAVDataObject *object = (UAVDataObject *)objectManager->getObject(getObjectID(), getInstanceID());
-        Q_ASSERT(object);
-        m_object = object->clone(getInstanceID());
-        m_object->unpack(getData().Data);
-    }
+    m_decoder = decoder;
 }
 
 
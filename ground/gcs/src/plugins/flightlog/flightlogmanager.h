@@ -33,8 +33,9 @@
 #include <QHash>
 #include <QQmlListProperty>
 #include <QSemaphore>
+#include <QMutex>
 #include <QXmlStreamWriter>
-#include <QTextStream>
+#include <QVector>
 
 #include "uavobjectmanager.h"
 #include "uavobjectutilmanager.h"
@@ -43,7 +44,9 @@
 #include "debuglogsettings.h"
 #include "debuglogcontrol.h"
 #include "objectpersistence.h"
+#include "uavobjecthelper.h"
 #include "uavtalk/telemetrymanager.h"
+#include "logentrystore.h"
 
 class UAVOLogSettingsWrapper : public QObject {
     Q_OBJECT Q_PROPERTY(UAVDataObject *object READ object NOTIFY objectChanged)
@@ -137,6 +140,25 @@ private:
     bool m_dirty;
 };
 
+/**
+ * Decodes the object payload of log entries into scratch objects that are
+ * reused for every entry with the same object and instance id, so that
+ * displaying or exporting a log does not need a UAVObject per entry.
+ * The returned object is only valid until the next decode of the same type.
+ */
+class LogEntryDecoder {
+public:
+    explicit LogEntryDecoder(UAVObjectManager *objectManager);
+    ~LogEntryDecoder();
+
+    UAVDataObject *decode(const DebugLogEntry::DataFields &data);
+    void clear();
+
+private:
+    UAVObjectManager *m_objectManager;
+    QHash<quint64, UAVDataObject *> m_scratchObjects;
+};
+
 class ExtendedDebugLogEntry : public DebugLogEntry {
     Q_OBJECT Q_PROPERTY(QString LogString READ getLogString WRITE setLogString NOTIFY LogStringUpdated)
 
@@ -145,14 +167,20 @@ public:
     ~ExtendedDebugLogEntry();
 
     QString getLogString();
-    void toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime);
-    void toCSV(QTextStream *csvStream, quint32 baseTime);
+    static QString logString(const DataFields &data, LogEntryDecoder *decoder);
+    void toXML(QXmlStreamWriter *xmlWriter, quint32 baseTime, LogEntryDecoder *decoder);
+    void toCSV(QByteArray &csv, quint32 baseTime, LogEntryDecoder *decoder);
+    bool isUAVObject()
+    {
+        return getType() == TYPE_UAVOBJECT || getType() == TYPE_MULTIPLEUAVOBJECTS;
+    }
     UAVDataObject *uavObject()
     {
-        return m_object;
+        return uavObject(m_decoder);
     }
+    UAVDataObject *uavObject(LogEntryDecoder *decoder);
 
-    void setData(const DataFields & data, UAVObjectManager *objectManager);
+    void setData(const DataFields & data, LogEntryDecoder *decoder);
 
 public slots:
     void setLogString(QString arg)
@@ -164,7 +192,7 @@ signals:
     void LogStringUpdated(QString arg);
 
 private:
-    UAVDataObject *m_object;
+    LogEntryDecoder *m_decoder;
 };
 
 class FlightLogManager : public QObject {
@@ -183,6 +211,13 @@ class FlightLogManager : public QObject {
     Q_PROPERTY(QStringList logStatuses READ logStatuses NOTIFY logStatusesChanged)
     Q_PROPERTY(int loggingEnabled READ loggingEnabled WRITE setLoggingEnabled NOTIFY loggingEnabledChanged)
     Q_PROPERTY(int logEntriesCount READ logEntriesCount NOTIFY logEntriesChanged)
+    Q_PROPERTY(bool pipelinedDownload READ pipelinedDownload WRITE setPipelinedDownload NOTIFY pipelinedDownloadChanged)
+    Q_PROPERTY(bool streamToDisk READ streamToDisk WRITE setStreamToDisk NOTIFY streamToDiskChanged)
+    Q_PROPERTY(bool logEntriesOnDisk READ logEntriesOnDisk NOTIFY logEntriesChanged)
+    Q_PROPERTY(QAbstractItemModel * logEntriesModel READ logEntriesModel CONSTANT)
+    Q_PROPERTY(double downloadRate READ downloadRate NOTIFY downloadRateChanged)
+    Q_PROPERTY(double exportProgress READ exportProgress NOTIFY exportProgressChanged)
+    Q_PROPERTY(QStringList metadataProfiles READ metadataProfiles NOTIFY metadataProfilesChanged)
 
 public:
     explicit FlightLogManager(QObject *parent = 0);
@@ -246,8 +281,44 @@ public:
     }
     int logEntriesCount()
     {
-        return m_logEntries.count();
+        return entryCount();
+    }
+
+    bool pipelinedDownload() const
+    {
+        return m_pipelinedDownload;
+    }
+
+    // write the next downloads to a temporary file instead of keeping them in memory
+    bool streamToDisk() const
+    {
+        return m_streamToDisk;
+    }
+
+    // whether the downloaded entries are in m_logEntryStore, shown through logEntriesModel
+    bool logEntriesOnDisk() const
+    {
+        return m_logEntriesOnDisk;
     }
+
+    QAbstractItemModel *logEntriesModel()
+    {
+        return &m_logEntryModel;
+    }
+
+    // bytes per second of the current (or last) download
+    double downloadRate() const
+    {
+        return m_downloadRate;
+    }
+
+    // fraction of the entries written by the current (or last) CSV/XML export
+    double exportProgress() const
+    {
+        return m_exportProgress;
+    }
+
+    QStringList metadataProfiles() const;
 signals:
     void logEntriesChanged();
     void flightEntriesChanged();
@@ -260,6 +331,11 @@ signals:
 
     void logStatusesChanged(QStringList arg);
     void loggingEnabledChanged(int arg);
+    void pipelinedDownloadChanged(bool arg);
+    void streamToDiskChanged(bool arg);
+    void downloadRateChanged(double arg);
+    void exportProgressChanged(double arg);
+    void metadataProfilesChanged();
 
 public slots:
     void clearAllLogs();
@@ -270,6 +346,9 @@ public slots:
     void saveSettings();
     void resetSettings(bool clear);
     void saveSettingsToBoard();
+    void saveMetadataProfile(QString name);
+    void applyMetadataProfile(QString name);
+    void removeMetadataProfile(QString name);
     bool saveUAVObjectToFlash(UAVObject *object);
 
     void setDisableControls(bool arg)
@@ -312,6 +391,22 @@ public slots:
         }
     }
 
+    void setPipelinedDownload(bool arg)
+    {
+        if (m_pipelinedDownload != arg) {
+            m_pipelinedDownload = arg;
+            emit pipelinedDownloadChanged(arg);
+        }
+    }
+
+    void setStreamToDisk(bool arg)
+    {
+        if (m_streamToDisk != arg) {
+            m_streamToDisk = arg;
+            emit streamToDiskChanged(arg);
+        }
+    }
+
 private slots:
     void updateFlightEntries(quint16 currentFlight);
     void setupUAVOWrappers();
@@ -319,6 +414,8 @@ private slots:
     void setupLogStatuses();
     void connectionStatusChanged();
     bool updateLogWrapper(QString name, int level, int period);
+    void logEntryReceived(UAVObject *object);
+    void clearAllLogsCompleted(AbstractUAVObjectHelper::Result result);
 
 private:
     UAVObjectManager *m_objectManager;
@@ -331,6 +428,9 @@ private:
     ObjectPersistence *m_objectPersistence;
 
     QList<ExtendedDebugLogEntry *> m_logEntries;
+    LogEntryDecoder m_logEntryDecoder;
+    LogEntryStore m_logEntryStore;
+    LogEntryModel m_logEntryModel;
     QStringList m_flightEntries;
     QStringList m_logSettings;
     QStringList m_logStatuses;
@@ -338,11 +438,43 @@ private:
     QList<UAVOLogSettingsWrapper *> m_uavoEntries;
     QHash<QString, UAVOLogSettingsWrapper *> m_uavoEntriesHash;
 
+    bool retrieveFlightEntries(int flight);
+    bool retrieveFlightEntriesPipelined(int flight);
+    void requestFlightEntry(int flight, int slot);
+    void addLogEntry(const DebugLogEntry::DataFields &data);
+    void appendLogEntry(const DebugLogEntry::DataFields &data);
+    int entryCount() const
+    {
+        return m_logEntriesOnDisk ? m_logEntryStore.count() : m_logEntries.count();
+    }
+    DebugLogEntry::DataFields entryData(int index);
+    void updateDownloadRate(qint64 bytes, qint64 elapsedMs);
+
+    typedef QByteArray (*ChunkFormatter)(UAVObjectManager *objectManager, const QList<ExtendedDebugLogEntry *> &entries,
+                                         const QVector<quint32> &baseTimes, int begin, int end);
+
     void exportToOPL(QString fileName);
     void exportToCSV(QString fileName);
     void exportToXML(QString fileName);
+    void exportToParquet(QString fileName);
+    QVector<quint32> exportBaseTimes();
+    bool exportEntries(QIODevice *device, ChunkFormatter formatter);
+    void setExportProgress(double progress);
+    static QByteArray formatCSVChunk(UAVObjectManager *objectManager, const QList<ExtendedDebugLogEntry *> &entries,
+                                     const QVector<quint32> &baseTimes, int begin, int end);
+    static QByteArray formatXMLChunk(UAVObjectManager *objectManager, const QList<ExtendedDebugLogEntry *> &entries,
+                                     const QVector<quint32> &baseTimes, int begin, int end);
 
     static const int UAVTALK_TIMEOUT = 4000;
+    // pipelined download: entries requested ahead, poll period of the replies and retries per entry
+    static const int PIPELINE_DEPTH   = 4;
+    static const int PIPELINE_POLL_MS = 5;
+    static const int PIPELINE_TIMEOUT = 1000;
+    static const int PIPELINE_RETRIES = 3;
+    // CSV/XML export: entries formatted per pool task
+    static const int EXPORT_CHUNK_SIZE = 500;
+    // Parquet export: rows per row group, each encoded by a pool task
+    static const int EXPORT_ROW_GROUP_SIZE = 10000;
     static const int LOG_SETTINGS_FILE_VERSION = 1;
     bool m_disableControls;
     bool m_disableExport;
@@ -350,6 +482,15 @@ private:
     bool m_adjustExportedTimestamps;
     bool m_boardConnected;
     int m_loggingEnabled;
+    bool m_pipelinedDownload;
+    bool m_streamToDisk;
+    bool m_logEntriesOnDisk;
+    double m_downloadRate;
+    double m_exportProgress;
+
+    // entries received from the telemetry thread during a pipelined download
+    QMutex m_entryRepliesMutex;
+    QList<DebugLogEntry::DataFields> m_entryReplies;
 };
 
 #endif // FLIGHTLOGMANAGER_H
@@ -33,6 +33,7 @@
 #include <coreplugin/icore.h>
 #include <QKeySequence>
 #include <coreplugin/modemanager.h>
+#include <coreplugin/framescheduler.h>
 #include "flightlogmanager.h"
 #include "uavobject.h"
 
@@ -85,6 +86,7 @@ void FlightLogPlugin::ShowLogManagementDialog()
         m_logDialog->rootContext()->setContextProperty("logManager", flightLogManager);
         m_logDialog->rootContext()->setContextProperty("logDialog", m_logDialog);
         m_logDialog->setResizeMode(QQuickView::SizeRootObjectToView);
+        Core::FrameScheduler::instance()->addWindow(m_logDialog);
         m_logDialog->setSource(QUrl("qrc:/flightlog/FlightLogDialog.qml"));
         m_logDialog->setModality(Qt::ApplicationModal);
         connect(m_logDialog, SIGNAL(destroyed()), this, SLOT(LogManagementDialogClosed()));
@@ -0,0 +1,186 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logentrystore.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @brief      On disk storage of downloaded flight log entries and its list model
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logentrystore.h"
+#include "flightlogmanager.h"
+
+#include <QDir>
+#include <QDebug>
+
+LogEntryStore::LogEntryStore() : m_count(0), m_pages(PAGE_CACHE)
+{}
+
+LogEntryStore::~LogEntryStore()
+{
+    close();
+}
+
+/**
+ * Start a new, empty, store
+ * @returns false if the temporary file could not be created
+ */
+bool LogEntryStore::open()
+{
+    close();
+    m_file.reset(new QTemporaryFile(QDir::tempPath() + "/flightlog-XXXXXX.entries"));
+    if (!m_file->open()) {
+        qWarning() << "LogEntryStore - could not create" << m_file->fileTemplate() << m_file->errorString();
+        m_file.reset();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Discard the entries, the temporary file is removed
+ */
+void LogEntryStore::close()
+{
+    m_pages.clear();
+    m_file.reset();
+    m_count = 0;
+}
+
+bool LogEntryStore::append(const DebugLogEntry::DataFields &data)
+{
+    if (!isOpen()) {
+        return false;
+    }
+    m_file->seek((qint64)m_count * sizeof(DebugLogEntry::DataFields));
+    if (m_file->write((const char *)&data, sizeof(data)) != sizeof(data)) {
+        return false;
+    }
+    // the last page may be cached without this entry
+    m_pages.remove(m_count / PAGE_SIZE);
+    m_count++;
+    return true;
+}
+
+DebugLogEntry::DataFields LogEntryStore::at(int index)
+{
+    const Page *entries = page(index / PAGE_SIZE);
+
+    if (entries && index % PAGE_SIZE < entries->count()) {
+        return entries->at(index % PAGE_SIZE);
+    }
+
+    DebugLogEntry::DataFields empty;
+    memset(&empty, 0, sizeof(empty));
+    return empty;
+}
+
+const LogEntryStore::Page *LogEntryStore::page(int index)
+{
+    Page *entries = m_pages.object(index);
+
+    if (entries || !isOpen()) {
+        return entries;
+    }
+
+    int first = index * PAGE_SIZE;
+    int count = qMin(PAGE_SIZE, m_count - first);
+    if (count <= 0) {
+        return NULL;
+    }
+    entries = new Page(count);
+    m_file->flush();
+    m_file->seek((qint64)first * sizeof(DebugLogEntry::DataFields));
+    qint64 size = (qint64)count * sizeof(DebugLogEntry::DataFields);
+    if (m_file->read((char *)entries->data(), size) != size) {
+        qWarning() << "LogEntryStore - could not read entries" << first << "to" << first + count - 1;
+        delete entries;
+        return NULL;
+    }
+    m_pages.insert(index, entries);
+    return entries;
+}
+
+LogEntryModel::LogEntryModel(LogEntryStore *store, LogEntryDecoder *decoder, QObject *parent) :
+    QAbstractListModel(parent), m_store(store), m_decoder(decoder), m_rows(0)
+{}
+
+int LogEntryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+QVariant LogEntryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows) {
+        return QVariant();
+    }
+
+    DebugLogEntry::DataFields fields = m_store->at(index.row());
+    switch (role) {
+    case FlightRole:
+        return (int)fields.Flight;
+
+    case FlightTimeRole:
+        return (uint)fields.FlightTime;
+
+    case EntryRole:
+        return (int)fields.Entry;
+
+    case TypeRole:
+        return (int)fields.Type;
+
+    case Qt::DisplayRole:
+    case LogStringRole:
+        return ExtendedDebugLogEntry::logString(fields, m_decoder);
+
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> LogEntryModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+
+    roles[FlightRole]     = "Flight";
+    roles[FlightTimeRole] = "FlightTime";
+    roles[EntryRole]      = "Entry";
+    roles[TypeRole]       = "Type";
+    roles[LogStringRole]  = "LogString";
+    return roles;
+}
+
+/**
+ * Tell the views about the entries appended to (or removed from) the store since the last call
+ */
+void LogEntryModel::refresh()
+{
+    int count = m_store->count();
+
+    if (count > m_rows) {
+        beginInsertRows(QModelIndex(), m_rows, count - 1);
+        m_rows = count;
+        endInsertRows();
+    } else if (count < m_rows) {
+        beginResetModel();
+        m_rows = count;
+        endResetModel();
+    }
+}
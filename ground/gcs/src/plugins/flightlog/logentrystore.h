@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logentrystore.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @brief      On disk storage of downloaded flight log entries and its list model
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGENTRYSTORE_H
+#define LOGENTRYSTORE_H
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QScopedPointer>
+#include <QTemporaryFile>
+#include <QVector>
+
+#include "debuglogentry.h"
+
+class LogEntryDecoder;
+
+/**
+ * Log entries written to a temporary file as they are downloaded.
+ * The entries are stored as fixed size records, so the file is its own index:
+ * entry i is at i * sizeof(DataFields). Reads go through a small cache of pages.
+ */
+class LogEntryStore {
+public:
+    LogEntryStore();
+    ~LogEntryStore();
+
+    bool open();
+    void close();
+    bool isOpen() const
+    {
+        return !m_file.isNull();
+    }
+
+    bool append(const DebugLogEntry::DataFields &data);
+    int count() const
+    {
+        return m_count;
+    }
+    DebugLogEntry::DataFields at(int index);
+
+private:
+    typedef QVector<DebugLogEntry::DataFields> Page;
+
+    const Page *page(int index);
+
+    // entries per page and pages kept in memory
+    static const int PAGE_SIZE  = 256;
+    static const int PAGE_CACHE = 16;
+
+    QScopedPointer<QTemporaryFile> m_file;
+    int m_count;
+    QCache<int, Page> m_pages;
+};
+
+/**
+ * Table model of the entries of a LogEntryStore, the views only read the rows they show
+ */
+class LogEntryModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles { FlightRole = Qt::UserRole + 1, FlightTimeRole, EntryRole, TypeRole, LogStringRole };
+
+    LogEntryModel(LogEntryStore *store, LogEntryDecoder *decoder, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    void refresh();
+
+private:
+    LogEntryStore *m_store;
+    LogEntryDecoder *m_decoder;
+    // rows announced to the views
+    int m_rows;
+};
+
+#endif // LOGENTRYSTORE_H
@@ -6,6 +6,7 @@ QT += svg opengl network
 include(../../plugin.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
 include(../../plugins/uavobjects/uavobjects.pri)
+include(../../plugins/uavtalk/uavtalk.pri)
 include(../../libs/sdlgamepad/sdlgamepad.pri)
 
 HEADERS += \
@@ -30,6 +30,7 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
+#include "uavtalk/telemetrymanager.h"
 #include <QDebug>
 
 #define JOYSTICK_UPDATE_RATE 50
@@ -48,11 +49,19 @@ GCSControlGadget::GCSControlGadget(QString classId, GCSControlGadgetWidget *widg
 
     connect(control_sock, SIGNAL(readyRead()), this, SLOT(readUDPCommand()));
 
+    telemetryManager = ExtensionSystem::PluginManager::instance()->getObject<TelemetryManager>();
+
     joystickTime.start();
+    axisCount      = 0;
+    axesSampleTime = 0;
+    axesTimer.setSingleShot(true);
+    connect(&axesTimer, SIGNAL(timeout()), this, SLOT(processAxes()));
+
     GCSControlPlugin *pl = dynamic_cast<GCSControlPlugin *>(plugin);
-    connect(pl->sdlGamepad, SIGNAL(gamepads(quint8)), this, SLOT(gamepads(quint8)));
-    connect(pl->sdlGamepad, SIGNAL(buttonState(ButtonNumber, bool)), this, SLOT(buttonState(ButtonNumber, bool)));
-    connect(pl->sdlGamepad, SIGNAL(axesValues(QListInt16)), this, SLOT(axesValues(QListInt16)));
+    gamepad = pl->sdlGamepad;
+    connect(gamepad, SIGNAL(gamepads(quint8)), this, SLOT(gamepads(quint8)));
+    connect(gamepad, SIGNAL(buttonState(ButtonNumber, bool)), this, SLOT(buttonState(ButtonNumber, bool)));
+    connect(gamepad, SIGNAL(axesChanged()), this, SLOT(axesChanged()));
 }
 
 GCSControlGadget::~GCSControlGadget()
@@ -234,6 +243,12 @@ void GCSControlGadget::sticksChangedLocally(double leftX, double leftY, double r
             manualControlCommand->getField("Thrust")->setDouble(newThrottle);
         }
         manualControlCommand->getField("Connected")->setValue("True");
+        if (telemetryManager) {
+            // measure from the gamepad sample, or from now for the widget sticks
+            telemetryManager->markControlSample(ManualControlCommand::OBJID,
+                                                axesSampleTime ? axesSampleTime : LatencyHistogram::timestamp());
+            axesSampleTime = 0;
+        }
         manualControlCommand->updated();
     }
 }
@@ -420,9 +435,28 @@ void GCSControlGadget::buttonState(ButtonNumber number, bool pressed)
     // buttonSettings[number].Amount
 }
 
-void GCSControlGadget::axesValues(QListInt16 values)
+/**
+ * The gamepad axes moved: the latest values are processed now, or once JOYSTICK_UPDATE_RATE
+ * has elapsed since the last update so that the final stick position is never dropped
+ */
+void GCSControlGadget::axesChanged()
+{
+    axisCount = gamepad->readAxes(axisValues, MAX_AXES, &axesSampleTime);
+
+    if (!axesTimer.isActive()) {
+        int wait = JOYSTICK_UPDATE_RATE - joystickTime.elapsed();
+        if (wait > 0) {
+            axesTimer.start(wait);
+        } else {
+            processAxes();
+        }
+    }
+}
+
+void GCSControlGadget::processAxes()
 {
-    int chMax = values.length();
+    const qint16 *values = axisValues;
+    int chMax = axisCount;
 
     if (rollChannel >= chMax || pitchChannel >= chMax ||
         yawChannel >= chMax || throttleChannel >= chMax) {
@@ -457,28 +491,25 @@ void GCSControlGadget::axesValues(QListInt16 values)
         }
     }
 
-
-    if (joystickTime.elapsed() > JOYSTICK_UPDATE_RATE) {
-        joystickTime.restart();
-        // Remap RPYT to left X/Y and right X/Y depending on mode
-        // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
-        // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
-        // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
-        // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
-        switch (controlsMode) {
-        case 1:
-            sticksChangedLocally(yValue / max, -pValue / max, rValue / max, -tValue / max);
-            break;
-        case 2:
-            sticksChangedLocally(yValue / max, -tValue / max, rValue / max, -pValue / max);
-            break;
-        case 3:
-            sticksChangedLocally(rValue / max, -pValue / max, yValue / max, -tValue / max);
-            break;
-        case 4:
-            sticksChangedLocally(rValue / max, -tValue / max, yValue / max, -pValue / max);
-            break;
-        }
+    joystickTime.restart();
+    // Remap RPYT to left X/Y and right X/Y depending on mode
+    // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
+    // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
+    // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
+    // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
+    switch (controlsMode) {
+    case 1:
+        sticksChangedLocally(yValue / max, -pValue / max, rValue / max, -tValue / max);
+        break;
+    case 2:
+        sticksChangedLocally(yValue / max, -tValue / max, rValue / max, -pValue / max);
+        break;
+    case 3:
+        sticksChangedLocally(rValue / max, -pValue / max, yValue / max, -tValue / max);
+        break;
+    case 4:
+        sticksChangedLocally(rValue / max, -tValue / max, yValue / max, -pValue / max);
+        break;
     }
 }
 
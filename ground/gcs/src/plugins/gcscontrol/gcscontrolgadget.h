@@ -33,10 +33,13 @@
 #include "gcscontrolgadgetconfiguration.h"
 #include "sdlgamepad/sdlgamepad.h"
 #include <QTime>
+#include <QTimer>
 #include "gcscontrolplugin.h"
 #include <QUdpSocket>
 #include <QHostAddress>
 
+class TelemetryManager;
+
 
 namespace Core {
 class IUAVGadget;
@@ -72,6 +75,13 @@ private:
     ManualControlCommand *getManualControlCommand();
     double constrain(double value);
     QTime joystickTime;
+    // latest gamepad axes, processed at most every JOYSTICK_UPDATE_RATE
+    SDLGamepad *gamepad;
+    qint16 axisValues[MAX_AXES];
+    int axisCount;
+    qint64 axesSampleTime;
+    QTimer axesTimer;
+    TelemetryManager *telemetryManager;
     QWidget *m_widget;
     QList<int> m_context;
     UAVObject::Metadata mccInitialData;
@@ -98,7 +108,8 @@ protected slots:
     // signals from joystick
     void gamepads(quint8 count);
     void buttonState(ButtonNumber number, bool pressed);
-    void axesValues(QListInt16 values);
+    void axesChanged();
+    void processAxes();
 };
 
 
@@ -48,7 +48,8 @@ bool GCSControlPlugin::initialize(const QStringList & args, QString *errMsg)
     Q_UNUSED(errMsg);
     sdlGamepad = new SDLGamepad();
     if (sdlGamepad->init()) {
-        sdlGamepad->start();
+        // the input thread must not wait behind the busy threads
+        sdlGamepad->start(QThread::HighPriority);
         qRegisterMetaType<QListInt16>("QListInt16");
         qRegisterMetaType<ButtonNumber>("ButtonNumber");
     }
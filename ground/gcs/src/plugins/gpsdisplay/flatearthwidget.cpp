@@ -48,6 +48,8 @@ FlatEarthWidget::FlatEarthWidget(QWidget *parent) : QGraphicsView(parent)
     earthScene = new QGraphicsScene(this);
     QPixmap earthpix(":/gpsgadget/images/flatEarth.jpg");
     earthPixmapItem = earthScene->addPixmap(earthpix);
+    // keep the scaled map, moving the marker must not scale it again
+    earthPixmapItem->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
     this->setScene(earthScene);
 
     // Draw the marker
@@ -55,6 +57,7 @@ FlatEarthWidget::FlatEarthWidget(QWidget *parent) : QGraphicsView(parent)
     QSvgRenderer *renderer = new QSvgRenderer();
     renderer->load(QString(":/gpsgadget/images/marker.svg"));
     marker->setSharedRenderer(renderer);
+    marker->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
     earthScene->addItem(marker);
 }
 
@@ -56,6 +56,8 @@ GpsConstellationWidget::GpsConstellationWidget(QWidget *parent) : QGraphicsView(
     world = new QGraphicsSvgItem();
     world->setSharedRenderer(renderer);
     world->setElementId("map");
+    // the map is static, only rendered again when the view is resized
+    world->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 
     scene = new QGraphicsScene(this);
     scene->addItem(world);
@@ -74,6 +76,7 @@ GpsConstellationWidget::GpsConstellationWidget(QWidget *parent) : QGraphicsView(
         satIcons[i] = new QGraphicsSvgItem(world);
         satIcons[i]->setSharedRenderer(renderer);
         satIcons[i]->setElementId("sat-notSeen");
+        satIcons[i]->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
         satIcons[i]->hide();
 
         satTexts[i] = new QGraphicsSimpleTextItem("##", satIcons[i]);
@@ -110,18 +113,35 @@ void GpsConstellationWidget::resizeEvent(QResizeEvent *event)
     fitInView(world, Qt::KeepAspectRatio);
 }
 
-void GpsConstellationWidget::updateSat(int index, int prn, int elevation, int azimuth, int snr)
+/*
+ * Update all the satellites of an epoch, the unused slots are cleared
+ */
+void GpsConstellationWidget::updateSats(const QList<GPSSatellite> &sats)
 {
-    if (index >= MAX_SATELLITES) {
-        // A bit of error checking never hurts.
-        return;
+    for (int index = 0; index < MAX_SATELLITES; index++) {
+        GPSSatellite sat = { 0, 0, 0, 0 };
+        if (index < sats.size()) {
+            sat = sats.at(index);
+        }
+        // only the satellites which have changed are drawn again
+        if (satellites[index][0] == sat.prn && satellites[index][1] == sat.elevation
+            && satellites[index][2] == sat.azimuth && satellites[index][3] == sat.snr) {
+            continue;
+        }
+        satellites[index][0] = sat.prn; // UBX SVID
+        satellites[index][1] = sat.elevation;
+        satellites[index][2] = sat.azimuth;
+        satellites[index][3] = sat.snr;
+        drawSat(index);
     }
+}
 
-    // TODO: add range checking
-    satellites[index][0] = prn; // UBX SVID
-    satellites[index][1] = elevation;
-    satellites[index][2] = azimuth;
-    satellites[index][3] = snr;
+void GpsConstellationWidget::drawSat(int index)
+{
+    const int prn       = satellites[index][0];
+    const int elevation = satellites[index][1];
+    const int azimuth   = satellites[index][2];
+    const int snr       = satellites[index][3];
 
     if (prn && elevation >= 0) {
         QPointF opd = polarToCoord(elevation, azimuth);
@@ -31,6 +31,7 @@
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
+#include "gpsparser.h"
 
 
 class GpsConstellationWidget : public QGraphicsView {
@@ -41,7 +42,7 @@ public:
     ~GpsConstellationWidget();
 
 public slots:
-    void updateSat(int index, int prn, int elevation, int azimuth, int snr);
+    void updateSats(const QList<GPSSatellite> &sats);
 
 
 private slots:
@@ -55,6 +56,7 @@ private:
     QGraphicsSvgItem *satIcons[MAX_SATELLITES];
     QGraphicsSimpleTextItem *satTexts[MAX_SATELLITES];
 
+    void drawSat(int index);
     QPointF polarToCoord(int elevation, int azimuth);
 
 protected:
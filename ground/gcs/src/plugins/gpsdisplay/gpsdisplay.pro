@@ -15,7 +15,6 @@ HEADERS += \
     gpsparser.h \
     telemetryparser.h \
     gpssnrwidget.h \
-    buffer.h \
     nmeaparser.h \
     gpsdisplaygadget.h \
     gpsdisplaywidget.h \
@@ -30,7 +29,6 @@ SOURCES += \
     gpsparser.cpp \
     telemetryparser.cpp \
     gpssnrwidget.cpp \
-    buffer.cpp \
     nmeaparser.cpp \
     gpsdisplaygadget.cpp \
     gpsdisplaygadgetfactory.cpp \
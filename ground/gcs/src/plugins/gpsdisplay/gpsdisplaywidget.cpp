@@ -91,11 +91,13 @@ void GpsDisplayWidget::setFixType(const QString &fixtype)
 
 void GpsDisplayWidget::dumpPacket(const QString &packet)
 {
+    // the parsers pass all the packets of a read at once
     textBrowser->append(packet);
-    if (textBrowser->document()->lineCount() > 200) {
+    int excess = textBrowser->document()->lineCount() - 200;
+    if (excess > 0) {
         QTextCursor tc = textBrowser->textCursor();
         tc.movePosition(QTextCursor::Start);
-        tc.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
+        tc.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor, excess);
         tc.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
         tc.removeSelectedText();
     }
@@ -41,3 +41,10 @@ void GPSParser::processInputStream(char c)
         Q_UNUSED(c)
     }
 }
+
+void GPSParser::processInputStream(const QByteArray &data)
+{
+    for (int pos = 0; pos < data.size(); pos++) {
+        processInputStream(data[pos]);
+    }
+}
@@ -32,10 +32,21 @@
 #include <QtCore>
 #include <stdint.h>
 
+// satellite in view, a zero PRN is an empty slot
+typedef struct {
+    int prn;
+    int elevation;
+    int azimuth;
+    int snr;
+} GPSSatellite;
+
+Q_DECLARE_METATYPE(GPSSatellite)
+
 class GPSParser : public QObject {
     Q_OBJECT
 public: ~GPSParser();
     virtual void processInputStream(char c);
+    virtual void processInputStream(const QByteArray &data);
 
 protected:
     GPSParser(QObject *parent = 0);
@@ -46,7 +57,7 @@ signals:
     void datetime(double, double); // Date then time
     void speedheading(double, double);
     void packet(QString); // Raw NMEA Packet (or just info)
-    void satellite(int, int, int, int, int); // Index, PRN, Elevation, Azimuth, SNR
+    void satellites(QList<GPSSatellite>); // All the satellites in view of an epoch, by slot
     void fixmode(QString); // Mode of fix: "Auto", "Manual".
     void fixtype(QString); // Type of fix: "NoGPS", "NoFix", "Fix2D", "Fix3D".
     void dop(double, double, double); // HDOP, VDOP, PDOP
@@ -29,8 +29,12 @@
 #include <QGraphicsRectItem>
 #include <QFontMetrics>
 
+#define PRN_TEXTAREA_HEIGHT   20
+#define SIDE_MARGIN           15
+#define HIGH_SAT_AGING_CYCLES 10
+
 GpsSnrWidget::GpsSnrWidget(QWidget *parent) :
-    QGraphicsView(parent)
+    QGraphicsView(parent), satsToShow(MAX_SATELLITES), highSatelliteCountAge(0)
 {
     scene = new QGraphicsScene(this);
     setScene(scene);
@@ -76,50 +80,35 @@ void GpsSnrWidget::showEvent(QShowEvent *event)
 {
     Q_UNUSED(event)
     scene->setSceneRect(0, 0, this->viewport()->width(), this->viewport()->height());
-    for (int index = 0; index < MAX_SATELLITES; index++) {
-        drawSat(index);
-    }
+    drawSats();
 }
 
 void GpsSnrWidget::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
     scene->setSceneRect(0, 0, this->viewport()->width(), this->viewport()->height());
-    for (int index = 0; index < MAX_SATELLITES; index++) {
-        drawSat(index);
-    }
+    drawSats();
 }
 
-void GpsSnrWidget::updateSat(int index, int prn, int elevation, int azimuth, int snr)
+/*
+ * Update all the satellites of an epoch, the unused slots are cleared
+ */
+void GpsSnrWidget::updateSats(const QList<GPSSatellite> &sats)
 {
-    if (index >= MAX_SATELLITES) {
-        // A bit of error checking never hurts.
-        return;
-    }
-
-    // TODO: add range checking
-    satellites[index][0] = prn;
-    satellites[index][1] = elevation;
-    satellites[index][2] = azimuth;
-    satellites[index][3] = snr;
-
-    drawSat(index);
-}
+    int visibleSats = 0;
 
-#define PRN_TEXTAREA_HEIGHT   20
-#define SIDE_MARGIN           15
-#define HIGH_SAT_AGING_CYCLES 10
-
-void GpsSnrWidget::drawSat(int index)
-{
-    static int satsToShow = MAX_SATELLITES;
-    static int lastNrVisibleSats = 0;
-    static int highSatelliteCountAge = 0;
-    bool heightLimited    = false;
-
-    if (index >= MAX_SATELLITES) {
-        // A bit of error checking never hurts.
-        return;
+    for (int index = 0; index < MAX_SATELLITES; index++) {
+        GPSSatellite sat = { 0, 0, 0, 0 };
+        if (index < sats.size()) {
+            sat = sats.at(index);
+        }
+        satellites[index][0] = sat.prn;
+        satellites[index][1] = sat.elevation;
+        satellites[index][2] = sat.azimuth;
+        satellites[index][3] = sat.snr;
+        if (sat.prn && sat.snr) {
+            visibleSats++;
+        }
     }
 
     /*
@@ -133,24 +122,34 @@ void GpsSnrWidget::drawSat(int index)
         In this case, the scale will always be set to the scale necessary for the
         source with the highest number of satellites in view.
      */
-    if (index == 0) {
-        if (lastNrVisibleSats > 16) {
-            satsToShow = MAX_SATELLITES;
-            highSatelliteCountAge = HIGH_SAT_AGING_CYCLES;
-        } else if (highSatelliteCountAge > 0) {
-            satsToShow = MAX_SATELLITES;
-            --highSatelliteCountAge;
-        } else {
-            satsToShow = 16;
-        }
-        lastNrVisibleSats = 0;
+    if (visibleSats > 16) {
+        satsToShow = MAX_SATELLITES;
+        highSatelliteCountAge = HIGH_SAT_AGING_CYCLES;
+    } else if (highSatelliteCountAge > 0) {
+        satsToShow = MAX_SATELLITES;
+        --highSatelliteCountAge;
+    } else {
+        satsToShow = 16;
+    }
+
+    drawSats();
+}
+
+void GpsSnrWidget::drawSats()
+{
+    for (int index = 0; index < MAX_SATELLITES; index++) {
+        drawSat(index);
     }
+}
+
+void GpsSnrWidget::drawSat(int index)
+{
+    bool heightLimited = false;
 
     const int prn = satellites[index][0];
     const int snr = satellites[index][3];
-    if (prn && snr) {
-        lastNrVisibleSats++;
 
+    if (prn && snr) {
         // When using integer values, width and height are the
         // box width and height, but the left and bottom borders are drawn on the box,
         // and the top and right borders are drawn just next to the box.
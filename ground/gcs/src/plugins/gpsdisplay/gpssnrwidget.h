@@ -29,6 +29,7 @@
 #define GPSSNRWIDGET_H
 
 #include <QGraphicsView>
+#include "gpsparser.h"
 class QGraphicsRectItem;
 
 class GpsSnrWidget : public QGraphicsView {
@@ -40,7 +41,7 @@ public:
 signals:
 
 public slots:
-    void updateSat(int index, int prn, int elevation, int azimuth, int snr);
+    void updateSats(const QList<GPSSatellite> &sats);
 
 private:
     static const int MAX_SATELLITES = 24;
@@ -50,7 +51,10 @@ private:
     QGraphicsSimpleTextItem *satTexts[MAX_SATELLITES];
     QGraphicsSimpleTextItem *satSNRs[MAX_SATELLITES];
     QRectF prnReferenceTextRect;
+    int satsToShow;
+    int highSatelliteCountAge;
 
+    void drawSats();
     void drawSat(int index);
 
 protected:
@@ -27,26 +27,22 @@
 
 
 #include "nmeaparser.h"
-#include <iostream>
 #include <math.h>
+#include <string.h>
 #include <QDebug>
-#include <QStringList>
-#include <QWidget>
-#include <QVBoxLayout>
-#include <QPushButton>
-
-// Message Codes
-#define NMEA_NODATA    0       // No data. Packet not available, bad, or not decoded
-#define NMEA_GPGGA     1       // Global Positioning System Fix Data
-#define NMEA_GPVTG     2       // Course over ground and ground speed
-#define NMEA_GPGLL     3       // Geographic position - latitude/longitude
-#define NMEA_GPGSV     4       // GPS satellites in view
-#define NMEA_GPGSA     5       // GPS DOP and active satellites
-#define NMEA_GPRMC     6       // Recommended minimum specific GPS data
-#define NMEA_GPZDA     7       // Time and Date
-#define NMEA_UNKNOWN   0xFF // Packet received but not known
-
-#define GPS_TIMEOUT_MS 500
+#include <QtEndian>
+
+// UBX framing
+#define UBX_SYNC1           0xB5
+#define UBX_SYNC2           0x62
+#define UBX_HEADER_SIZE     6
+#define UBX_MAX_PAYLOAD     1024
+#define UBX_CLASS_NAV       0x01
+#define UBX_ID_NAV_PVT      0x07
+#define UBX_NAV_PVT_SIZE    92
+
+// unframeable input beyond this is dropped
+#define RX_BUFFER_MAX       4096
 
 // Debugging
 
@@ -55,433 +51,501 @@
 
 #ifdef GPSDEBUG
         #define NMEA_DEBUG_PKT ///< define to enable debug of all NMEA messages
-        #define NMEA_DEBUG_GGA ///< define to enable debug of GGA messages
-        #define NMEA_DEBUG_VTG ///< define to enable debug of VTG messages
-        #define NMEA_DEBUG_RMC ///< define to enable debug of RMC messages
-        #define NMEA_DEBUG_GSA ///< define to enable debug of GSA messages
-        #define NMEA_DEBUG_ZDA ///< define to enable debug of ZDA messages
 #endif
 
+/**
+ * Parse a decimal number, independently of the C locale that Qt sets from the environment
+ */
+static double parseDouble(const char *s)
+{
+    double value = 0;
+    double scale = 1;
+    bool negative = false;
+
+    if (*s == '-') {
+        negative = true;
+        s++;
+    } else if (*s == '+') {
+        s++;
+    }
+    for (; *s >= '0' && *s <= '9'; s++) {
+        value = value * 10 + (*s - '0');
+    }
+    if (*s == '.') {
+        for (s++; *s >= '0' && *s <= '9'; s++) {
+            value = value * 10 + (*s - '0');
+            scale *= 10;
+        }
+    }
+    value /= scale;
+    return negative ? -value : value;
+}
+
+static int parseInt(const char *s)
+{
+    return (int)parseDouble(s);
+}
+
+/**
+ * Convert NMEA ddmm.mmmm to decimal degrees
+ */
+static double parseCoordinate(const char *value, const char *hemisphere)
+{
+    double raw = parseDouble(value);
+    int deg    = (int)raw / 100;
+    double min = (raw - (deg * 100)) / 60.0;
+    double coordinate = deg + min;
+
+    if (*hemisphere == 'S' || *hemisphere == 'W') {
+        coordinate = -coordinate;
+    }
+    return coordinate;
+}
+
 /**
  * Initialize the parser
  */
-NMEAParser::NMEAParser(QObject *parent) : GPSParser(parent)
+NMEAParser::NMEAParser(QObject *parent) : GPSParser(parent),
+    numUpdates(0),
+    numErrors(0),
+    gpsRxOverflow(0),
+    updated(0)
 {
-    bufferInit(&gpsRxBuffer, (unsigned char *)gpsRxData, 512);
-    gpsRxOverflow = 0;
+    memset(&GpsData, 0, sizeof(GpsData));
 }
 
 NMEAParser::~NMEAParser()
 {}
 
+void NMEAParser::processInputStream(char c)
+{
+    processInputStream(QByteArray(1, c));
+}
+
 /**
- * Called each time there are data in the input buffer
+ * Called each time there are data in the input buffer.
+ * Complete NMEA sentences and UBX messages are processed, a trailing partial
+ * one is kept until more data arrives.
  */
-void NMEAParser::processInputStream(char c)
+void NMEAParser::processInputStream(const QByteArray &data)
 {
-    if (!bufferAddToEnd(&gpsRxBuffer, c)) {
-        // no space in buffer
-        // count overflow
+    rxBuffer.append(data);
+
+    const char *buf = rxBuffer.constData();
+    const int size  = rxBuffer.size();
+    int pos = 0;
+    while (pos < size) {
+        int consumed;
+        if (buf[pos] == '$') {
+            consumed = nmeaProcessSentence(buf + pos, size - pos);
+        } else if ((uchar)buf[pos] == UBX_SYNC1) {
+            consumed = ubxProcessMessage((const uchar *)buf + pos, size - pos);
+        } else {
+            // not the start of a message
+            consumed = 1;
+        }
+        if (!consumed) {
+            // incomplete
+            break;
+        }
+        pos += consumed;
+    }
+    rxBuffer.remove(0, pos);
+    if (rxBuffer.size() > RX_BUFFER_MAX) {
+        rxBuffer.clear();
         gpsRxOverflow++;
-        return;
     }
-    nmeaProcess(&gpsRxBuffer);
+
+    if (!rawPackets.isEmpty()) {
+        emit packet(rawPackets);
+        rawPackets.clear();
+    }
+    emitEpoch();
 }
 
+/**
+ * Processes one NMEA sentence starting at '$'
+ * \return number of bytes consumed, 0 if the sentence is not complete yet
+ */
+int NMEAParser::nmeaProcessSentence(const char *data, int length)
+{
+    const char *end = (const char *)memchr(data, '\n', qMin(length, NMEA_BUFFERSIZE + 2));
+
+    if (!end) {
+        // although NMEA strings should be 80 characters or less,
+        // receive buffer errors can generate erroneous packets.
+        return length > NMEA_BUFFERSIZE + 1 ? 1 : 0;
+    }
+    int consumed = end - data + 1;
+
+    // copy without the '$' and the line end
+    char packet[NMEA_BUFFERSIZE];
+    int packetLength = consumed - 2;
+    if (packetLength > 0 && data[packetLength] == '\r') {
+        packetLength--;
+    }
+    if (packetLength < 6 || packetLength >= NMEA_BUFFERSIZE) {
+        ++numErrors;
+        return consumed;
+    }
+    memcpy(packet, data + 1, packetLength);
+    packet[packetLength] = 0;
+
+#ifdef NMEA_DEBUG_PKT
+    qDebug() << packet;
+#endif
+    if (!rawPackets.isEmpty()) {
+        rawPackets.append('\n');
+    }
+    rawPackets.append(QLatin1String(packet));
+
+    if (!nmeaChecksum(packet)) {
+        return consumed;
+    }
+
+    char *fields[NMEA_MAXFIELDS];
+    int count = nmeaTokenize(packet, fields);
+
+    // attempt to reject empty packets right away
+    if (count < 3 || (!*fields[1] && !*fields[2])) {
+        return consumed;
+    }
+
+    // GN (combined) and the other constellation talkers are accepted for the solution,
+    // satellites in view are listed for GPS only as the sky view has a single set of slots
+    const char *talker = fields[0];
+    const char *type   = fields[0] + 2;
+    if (strlen(fields[0]) != 5) {
+        return consumed;
+    }
+    if (!strcmp(type, "GGA")) {
+        nmeaProcessGGA(fields, count);
+    } else if (!strcmp(type, "RMC")) {
+        nmeaProcessRMC(fields, count);
+    } else if (!strcmp(type, "VTG")) {
+        nmeaProcessVTG(fields, count);
+    } else if (!strcmp(type, "GSA")) {
+        nmeaProcessGSA(fields, count);
+    } else if (!strcmp(type, "GSV") && !strncmp(talker, "GP", 2)) {
+        nmeaProcessGSV(fields, count);
+    } else if (!strcmp(type, "ZDA")) {
+        nmeaProcessZDA(fields, count);
+    }
+    return consumed;
+}
 
 /**
- * Prosesses NMEA sentence checksum
+ * Processes NMEA sentence checksum and terminates the packet at the '*'
  * \param[in] Buffer for parsed nmea sentence
- * \return 0 checksum not valid
- * \return 1 checksum valid
+ * \return false checksum not valid
+ * \return true checksum valid
  */
-char NMEAParser::nmeaChecksum(char *gps_buffer)
+bool NMEAParser::nmeaChecksum(char *packet)
 {
     char checksum = 0;
-    char checksum_received = 0;
+    char *star    = packet;
 
-    for (int x = 0; x < NMEA_BUFFERSIZE; x++) {
-        if (gps_buffer[x] == '*') {
-            // Parsing received checksum...
-            checksum_received = strtol(&gps_buffer[x + 1], NULL, 16);
-
-            break;
-        } else {
-            // XOR the received data...
-            checksum ^= gps_buffer[x];
-        }
+    for (; *star && *star != '*'; star++) {
+        // XOR the received data...
+        checksum ^= *star;
     }
-    if (checksum == checksum_received) {
-        ++numUpdates;
-        return 1;
-    } else {
+    if (*star != '*' || checksum != (char)strtol(star + 1, NULL, 16)) {
         ++numErrors;
-        return 0;
+        return false;
     }
+    *star = 0;
+    ++numUpdates;
+    return true;
 }
 
-void NMEAParser::nmeaTerminateAtChecksum(char *gps_buffer)
+/**
+ * Splits the packet in place at the commas
+ * \return number of fields
+ */
+int NMEAParser::nmeaTokenize(char *packet, char *fields[])
 {
-    for (int x = 0; x < NMEA_BUFFERSIZE; x++) {
-        if (gps_buffer[x] == '*') {
-            gps_buffer[x] = 0;
-            break;
+    int count = 0;
+
+    fields[count++] = packet;
+    for (char *c = packet; *c && count < NMEA_MAXFIELDS; c++) {
+        if (*c == ',') {
+            *c = 0;
+            fields[count++] = c + 1;
         }
     }
+    return count;
 }
 
 /**
- * Prosesses NMEA sentences
- * \param[in] cBuffer for prosessed nmea sentences
- * \return Message code for found packet
- * \return 0xFF NO packet found
+ * Processes UBX messages starting at the first sync character
+ * \return number of bytes consumed, 0 if the message is not complete yet
  */
-uint8_t NMEAParser::nmeaProcess(cBuffer *rxBuffer)
+int NMEAParser::ubxProcessMessage(const uchar *data, int length)
 {
-    uint8_t foundpacket = NMEA_NODATA;
-    uint8_t startFlag   = false;
-    // u08 data;
-    uint16_t i, j;
-
-    // process the receive buffer
-    // go through buffer looking for packets
-    while (rxBuffer->datalength) {
-        // look for a start of NMEA packet
-        if (bufferGetAtIndex(rxBuffer, 0) == '$') {
-            // found start
-            startFlag = true;
-            // when start is found, we leave it intact in the receive buffer
-            // in case the full NMEA string is not completely received.  The
-            // start will be detected in the next nmeaProcess iteration.
-
-            // done looking for start
-            break;
-        } else {
-            bufferGetFromFront(rxBuffer);
-        }
+    if (length < UBX_HEADER_SIZE) {
+        return 0;
+    }
+    int payloadLength = data[4] | (data[5] << 8);
+    if (data[1] != UBX_SYNC2 || payloadLength > UBX_MAX_PAYLOAD) {
+        return 1;
+    }
+    int total = UBX_HEADER_SIZE + payloadLength + 2;
+    if (length < total) {
+        return 0;
     }
 
-    // if we detected a start, look for end of packet
-    if (startFlag) {
-        for (i = 1; i < (rxBuffer->datalength) - 1; i++) {
-            // check for end of NMEA packet <CR><LF>
-            if ((bufferGetAtIndex(rxBuffer, i) == '\r') && (bufferGetAtIndex(rxBuffer, i + 1) == '\n')) {
-                // have a packet end
-                // dump initial '$'
-                bufferGetFromFront(rxBuffer);
-                // copy packet to NmeaPacket
-                for (j = 0; j < (i - 1); j++) {
-                    // although NMEA strings should be 80 characters or less,
-                    // receive buffer errors can generate erroneous packets.
-                    // Protect against packet buffer overflow
-                    if (j < (NMEA_BUFFERSIZE - 1)) {
-                        NmeaPacket[j] = bufferGetFromFront(rxBuffer);
-                    } else {
-                        bufferGetFromFront(rxBuffer);
-                    }
-                }
-                // null terminate it
-                if (j < (NMEA_BUFFERSIZE - 1)) {
-                    NmeaPacket[j] = 0;
-                } else {
-                    NmeaPacket[NMEA_BUFFERSIZE - 1] = 0;
-                }
-                // dump <CR><LF> from rxBuffer
-                bufferGetFromFront(rxBuffer);
-                bufferGetFromFront(rxBuffer);
-                // DEBUG
-                                #ifdef NMEA_DEBUG_PKT
-                qDebug() << NmeaPacket;
-                                #endif
-                emit packet(QString(NmeaPacket));
-                // found a packet
-                // done with this processing session
-                foundpacket = NMEA_UNKNOWN;
-                break;
-            }
-        }
+    // 8 bit Fletcher checksum over class, id, length and payload
+    uchar ckA = 0, ckB = 0;
+    for (int i = 2; i < UBX_HEADER_SIZE + payloadLength; i++) {
+        ckA += data[i];
+        ckB += ckA;
     }
+    if (ckA != data[total - 2] || ckB != data[total - 1]) {
+        ++numErrors;
+        return 1;
+    }
+    ++numUpdates;
 
-    if (foundpacket) {
-        // check message type and process appropriately
-        if (!strncmp(NmeaPacket, "GPGGA", 5)) {
-            // process packet of this type
-            nmeaProcessGPGGA(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPGGA;
-        } else if (!strncmp(NmeaPacket, "GPVTG", 5)) {
-            // process packet of this type
-            nmeaProcessGPVTG(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPVTG;
-        } else if (!strncmp(NmeaPacket, "GPGSA", 5)) {
-            // process packet of this type
-            nmeaProcessGPGSA(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPGSA;
-        } else if (!strncmp(NmeaPacket, "GPRMC", 5)) {
-            // process packet of this type
-            nmeaProcessGPRMC(NmeaPacket);
-            // report packet type
-            foundpacket = NMEA_GPRMC;
-        } else if (!strncmp(NmeaPacket, "GPGSV", 5)) {
-            // Process packet of this type
-            nmeaProcessGPGSV(NmeaPacket);
-            // rerpot packet type
-            foundpacket = NMEA_GPGSV;
-        } else if (!strncmp(NmeaPacket, "GPZDA", 5)) {
-            // Process packet of this type
-            nmeaProcessGPZDA(NmeaPacket);
-            // rerpot packet type
-            foundpacket = NMEA_GPZDA;
-        }
-    } else if (rxBuffer->datalength >= rxBuffer->size) {
-        // if we found no packet, and the buffer is full
-        // we're logjammed, flush entire buffer
-        bufferFlush(rxBuffer);
+    if (!rawPackets.isEmpty()) {
+        rawPackets.append('\n');
     }
-    return foundpacket;
+    rawPackets.append(QStringLiteral("UBX class 0x%1 id 0x%2, %3 bytes")
+                      .arg(data[2], 2, 16, QChar('0')).arg(data[3], 2, 16, QChar('0')).arg(payloadLength));
+
+    if (data[2] == UBX_CLASS_NAV && data[3] == UBX_ID_NAV_PVT && payloadLength >= UBX_NAV_PVT_SIZE) {
+        ubxProcessNavPvt(data + UBX_HEADER_SIZE);
+    }
+    return total;
 }
 
 /**
- * Processes NMEA GSV sentences (satellites in view)
- * \param[in] Buffer for parsed nmea GSV sentence
+ * Processes UBX NAV-PVT, the complete solution of an epoch
  */
-void NMEAParser::nmeaProcessGPGSV(char *packet)
+void NMEAParser::ubxProcessNavPvt(const uchar *payload)
 {
-    // start parsing just after "GPGSV,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
+    int year  = qFromLittleEndian<quint16>(payload + 4);
+    int month = payload[6];
+    int day   = payload[7];
+
+    startEpoch(payload[8] * 10000 + payload[9] * 100 + payload[10]);
+    GpsData.GPSdate   = day * 10000 + month * 100 + (year - 2000);
+
+    qint32 height     = qFromLittleEndian<qint32>(payload + 32);
+    qint32 hMSL       = qFromLittleEndian<qint32>(payload + 36);
+    GpsData.Longitude = qFromLittleEndian<qint32>(payload + 24) * 1e-7;
+    GpsData.Latitude  = qFromLittleEndian<qint32>(payload + 28) * 1e-7;
+    GpsData.Altitude  = hMSL / 1000.0;
+    GpsData.GeoidSeparation = (height - hMSL) / 1000.0;
+    GpsData.Groundspeed     = qFromLittleEndian<qint32>(payload + 60) / 1000.0;
+    GpsData.Heading   = qFromLittleEndian<qint32>(payload + 64) * 1e-5;
+    GpsData.SV   = payload[23];
+    GpsData.PDOP = qFromLittleEndian<quint16>(payload + 76) * 0.01;
+
+    int fixType = payload[20];
+    bool fixOK  = payload[21] & 0x01;
+    if (!fixOK || fixType < 2 || fixType > 4) {
+        fixTypeValue = QStringLiteral("NoFix");
+    } else if (fixType == 2) {
+        fixTypeValue = QStringLiteral("Fix2D");
+    } else {
+        fixTypeValue = QStringLiteral("Fix3D");
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
+    updated |= UpdatedPosition | UpdatedDateTime | UpdatedSpeedHeading | UpdatedSV | UpdatedDOP | UpdatedFix;
+    // one NAV-PVT per epoch, no need to wait for the next one
+    emitEpoch();
+}
+
+/**
+ * Sentences carrying a time start a new epoch when the time changes,
+ * the values collected for the previous one are emitted first
+ */
+void NMEAParser::startEpoch(double time)
+{
+    if (updated && time != GpsData.GPStime) {
+        emitEpoch();
     }
-    nmeaTerminateAtChecksum(packet);
+    GpsData.GPStime = time;
+}
 
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
+void NMEAParser::emitEpoch()
+{
+    if (updated & UpdatedPosition) {
+        emit position(GpsData.Latitude, GpsData.Longitude, GpsData.Altitude);
+    }
+    if (updated & UpdatedSV) {
+        emit sv(GpsData.SV);
+    }
+    if (updated & UpdatedDateTime) {
+        emit datetime(GpsData.GPSdate, GpsData.GPStime);
+    }
+    if (updated & UpdatedSpeedHeading) {
+        emit speedheading(GpsData.Groundspeed, GpsData.Heading);
+    }
+    if (updated & UpdatedFix) {
+        if (!fixModeValue.isEmpty()) {
+            emit fixmode(fixModeValue);
+        }
+        if (!fixTypeValue.isEmpty()) {
+            emit fixtype(fixTypeValue);
+        }
+        if (!fixSVList.isEmpty()) {
+            emit fixSVs(fixSVList);
+        }
+        fixModeValue.clear();
+        fixTypeValue.clear();
+        fixSVList.clear();
+    }
+    if (updated & UpdatedDOP) {
+        emit dop(GpsData.HDOP, GpsData.VDOP, GpsData.PDOP);
+    }
+    updated = 0;
+}
 
+/**
+ * Processes NMEA GSV sentences (satellites in view)
+ */
+void NMEAParser::nmeaProcessGSV(char *fields[], int count)
+{
+    if (count < 4) {
+        return;
+    }
 
     // Officially there should be a max of three sentences (12 sats), some gps receivers do more..
 
-    const int sentence_total = tokenslist.at(1).toInt(); // Number of sentences for full data
-    const int sentence_index = tokenslist.at(2).toInt(); // sentence x of y
+    const int sentence_total = parseInt(fields[1]); // Number of sentences for full data
+    const int sentence_index = parseInt(fields[2]); // sentence x of y
 
-    int sats = (tokenslist.size() - 4) / 4;
+    if (sentence_index == 1) {
+        satellitesInView.clear();
+    } else if (satellitesInView.size() != (sentence_index - 1) * 4) {
+        // a previous sentence was lost, wait for the next set
+        satellitesInView.clear();
+        return;
+    }
+
+    int sats = (count - 4) / 4;
     for (int sat = 0; sat < sats; sat++) {
-        int base          = 4 + sat * 4;
-        const int id      = tokenslist.at(base + 0).toInt(); // Satellite PRN number
-        const int elv     = tokenslist.at(base + 1).toInt(); // Elevation, degrees
-        const int azimuth = tokenslist.at(base + 2).toInt(); // Azimuth, degrees
-        const int sig     = tokenslist.at(base + 3).toInt(); // SNR - higher is better
-        const int index   = (sentence_index - 1) * 4 + sat;
-        emit satellite(index, id, elv, azimuth, sig);
+        int base = 4 + sat * 4;
+        GPSSatellite satellite;
+        satellite.prn       = parseInt(fields[base + 0]); // Satellite PRN number
+        satellite.elevation = parseInt(fields[base + 1]); // Elevation, degrees
+        satellite.azimuth   = parseInt(fields[base + 2]); // Azimuth, degrees
+        satellite.snr       = parseInt(fields[base + 3]); // SNR - higher is better
+        satellitesInView.append(satellite);
     }
 
     if (sentence_index == sentence_total) {
-        // Last sentence
-        int total_sats = (sentence_index - 1) * 4 + sats;
-        for (int emptySatIndex = total_sats; emptySatIndex < 16; emptySatIndex++) {
-            // Wipe the rest.
-            emit satellite(emptySatIndex, 0, 0, 0, 0);
-        }
+        // Last sentence, the views redraw once for the whole set
+        emit satellites(satellitesInView);
+        satellitesInView.clear();
     }
 }
 
 /**
- * Prosesses NMEA GPGGA sentences
- * \param[in] Buffer for parsed nmea GPGGA sentence
+ * Processes NMEA GGA sentences
  */
-void NMEAParser::nmeaProcessGPGGA(char *packet)
+void NMEAParser::nmeaProcessGGA(char *fields[], int count)
 {
-    // start parsing just after "GPGGA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
+    if (count < 12) {
         return;
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-    GpsData.GPStime  = tokenslist.at(1).toDouble();
-    GpsData.Latitude = tokenslist.at(2).toDouble();
-    int deg    = (int)GpsData.Latitude / 100;
-    double min = ((GpsData.Latitude) - (deg * 100)) / 60.0;
-    GpsData.Latitude = deg + min;
-    // next field: N/S indicator
-    // correct latitute for N/S
-    if (tokenslist.at(3).contains("S")) {
-        GpsData.Latitude = -GpsData.Latitude;
-    }
-
-    GpsData.Longitude = tokenslist.at(4).toDouble();
-    deg = (int)GpsData.Longitude / 100;
-    min = ((GpsData.Longitude) - (deg * 100)) / 60.0;
-    GpsData.Longitude = deg + min;
-    // next field: E/W indicator
-    // correct latitute for E/W
-    if (tokenslist.at(5).contains("W")) {
-        GpsData.Longitude = -GpsData.Longitude;
-    }
-
-    GpsData.SV = tokenslist.at(7).toInt();
-
-    GpsData.Altitude = tokenslist.at(9).toDouble();
-    GpsData.GeoidSeparation = tokenslist.at(11).toDouble();
-    emit position(GpsData.Latitude, GpsData.Longitude, GpsData.Altitude);
-    emit sv(GpsData.SV);
-    emit datetime(GpsData.GPSdate, GpsData.GPStime);
+    startEpoch(parseDouble(fields[1]));
+    GpsData.Latitude  = parseCoordinate(fields[2], fields[3]);
+    GpsData.Longitude = parseCoordinate(fields[4], fields[5]);
+    GpsData.SV = parseInt(fields[7]);
+    GpsData.Altitude  = parseDouble(fields[9]);
+    GpsData.GeoidSeparation = parseDouble(fields[11]);
+    updated |= UpdatedPosition | UpdatedSV | UpdatedDateTime;
 }
 
 /**
- * Prosesses NMEA GPRMC sentences
- * \param[in] Buffer for parsed nmea GPRMC sentence
+ * Processes NMEA RMC sentences
  */
-void NMEAParser::nmeaProcessGPRMC(char *packet)
+void NMEAParser::nmeaProcessRMC(char *fields[], int count)
 {
-    // start parsing just after "GPRMC,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
+    if (count < 10) {
         return;
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-    GpsData.GPStime     = tokenslist.at(1).toDouble();
-    GpsData.Groundspeed = tokenslist.at(7).toDouble();
-    GpsData.Groundspeed = GpsData.Groundspeed * 0.51444;
-    GpsData.Heading     = tokenslist.at(8).toDouble();
-    GpsData.GPSdate     = tokenslist.at(9).toDouble();
-    emit datetime(GpsData.GPSdate, GpsData.GPStime);
-    emit speedheading(GpsData.Groundspeed, GpsData.Heading);
+    startEpoch(parseDouble(fields[1]));
+    GpsData.Groundspeed = parseDouble(fields[7]) * 0.51444;
+    GpsData.Heading     = parseDouble(fields[8]);
+    GpsData.GPSdate     = parseDouble(fields[9]);
+    updated |= UpdatedDateTime | UpdatedSpeedHeading;
 }
 
-
 /**
- * Prosesses NMEA GPVTG sentences
- * \param[in] Buffer for parsed nmea GPVTG sentence
+ * Processes NMEA VTG sentences
  */
-void NMEAParser::nmeaProcessGPVTG(char *packet)
+void NMEAParser::nmeaProcessVTG(char *fields[], int count)
 {
-    // start parsing just after "GPVTG,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
+    if (count < 8) {
         return;
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-
-    GpsData.Heading     = tokenslist.at(1).toDouble();
-    GpsData.Groundspeed = tokenslist.at(7).toDouble();
-    GpsData.Groundspeed = GpsData.Groundspeed / 3.6;
-    emit speedheading(GpsData.Groundspeed, GpsData.Heading);
+    GpsData.Heading     = parseDouble(fields[1]);
+    GpsData.Groundspeed = parseDouble(fields[7]) / 3.6;
+    updated |= UpdatedSpeedHeading;
 }
 
 /**
- * Prosesses NMEA GPGSA sentences
- * \param[in] Buffer for parsed nmea GPGSA sentence
+ * Processes NMEA GSA sentences, receivers using several constellations send one per constellation
  */
-void NMEAParser::nmeaProcessGPGSA(char *packet)
+void NMEAParser::nmeaProcessGSA(char *fields[], int count)
 {
-    // start parsing just after "GPGSA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
+    if (count < 18) {
         return;
     }
 
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
-        return;
-    }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
-
     // M=Manual, forced to operate in 2D or 3D
     // A=Automatic, 3D/2D
-    QString fixmodeValue = tokenslist.at(1);
-    if (fixmodeValue == "A") {
-        emit fixmode(QString("Auto"));
-    } else if (fixmodeValue == "B") {
-        emit fixmode(QString("Manual"));
+    if (*fields[1] == 'A') {
+        fixModeValue = QStringLiteral("Auto");
+    } else if (*fields[1] == 'M') {
+        fixModeValue = QStringLiteral("Manual");
     }
 
     // Mode: 1=Fix not available, 2=2D, 3=3D
-    int fixtypeValue = tokenslist.at(2).toInt();
+    int fixtypeValue = parseInt(fields[2]);
     if (fixtypeValue == 1) {
-        emit fixtype(QString("NoFix"));
+        fixTypeValue = QStringLiteral("NoFix");
     } else if (fixtypeValue == 2) {
-        emit fixtype(QString("Fix2D"));
+        fixTypeValue = QStringLiteral("Fix2D");
     } else if (fixtypeValue == 3) {
-        emit fixtype(QString("Fix3D"));
+        fixTypeValue = QStringLiteral("Fix3D");
     }
 
     // 3-14 = IDs of SVs used in position fix (null for unused fields)
-    QList<int> svList;
     for (int pos = 0; pos < 12; pos++) {
-        QString sv = tokenslist.at(3 + pos);
-        if (!sv.isEmpty()) {
-            svList.append(sv.toInt());
+        if (*fields[3 + pos]) {
+            fixSVList.append(parseInt(fields[3 + pos]));
         }
     }
-    emit fixSVs(svList);
 
     // 15   = PDOP
     // 16   = HDOP
     // 17   = VDOP
-    GpsData.PDOP = tokenslist.at(15).toDouble();
-    GpsData.HDOP = tokenslist.at(16).toDouble();
-    GpsData.VDOP = tokenslist.at(17).toDouble();
-    emit dop(GpsData.HDOP, GpsData.VDOP, GpsData.PDOP);
+    GpsData.PDOP = parseDouble(fields[15]);
+    GpsData.HDOP = parseDouble(fields[16]);
+    GpsData.VDOP = parseDouble(fields[17]);
+    updated |= UpdatedFix | UpdatedDOP;
 }
 
 /**
- * Prosesses NMEA GPZDA sentences
- * \param[in] Buffer for parsed nmea GPZDA sentence
+ * Processes NMEA ZDA sentences
  */
-void NMEAParser::nmeaProcessGPZDA(char *packet)
+void NMEAParser::nmeaProcessZDA(char *fields[], int count)
 {
-    // start parsing just after "GPZDA,"
-    // attempt to reject empty packets right away
-    if (packet[6] == ',' && packet[7] == ',') {
-        return;
-    }
-
-    if (!nmeaChecksum(packet)) {
-        // checksum not valid
+    if (count < 5) {
         return;
     }
-    nmeaTerminateAtChecksum(packet);
-
-    QString nmeaString(packet);
-    QStringList tokenslist = nmeaString.split(",");
 
-    GpsData.GPStime = tokenslist.at(1).toDouble();
-    int day   = tokenslist.at(2).toInt();
-    int month = tokenslist.at(3).toInt();
-    int year  = tokenslist.at(4).toInt();
+    startEpoch(parseDouble(fields[1]));
+    int day   = parseInt(fields[2]);
+    int month = parseInt(fields[3]);
+    int year  = parseInt(fields[4]);
     GpsData.GPSdate = day * 10000 + month * 100 + (year - 2000);
-    emit datetime(GpsData.GPSdate, GpsData.GPStime);
+    updated |= UpdatedDateTime;
 }
@@ -25,17 +25,18 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+
 #ifndef NMEAPARSER_H
 #define NMEAPARSER_H
 
 #include <QObject>
 #include <QtCore>
 #include <stdint.h>
-#include "buffer.h"
 #include "gpsparser.h"
 
 // constants/macros/typdefs
 #define NMEA_BUFFERSIZE 128
+#define NMEA_MAXFIELDS  24
 
 typedef struct struct_GpsData {
     double Latitude;
@@ -53,6 +54,12 @@ typedef struct struct_GpsData {
     double GPSdate;
 } GpsData_t;
 
+/**
+ * Parses NMEA sentences and u-blox UBX NAV-PVT messages from a serial stream.
+ * Input is consumed a chunk at a time and sentences are tokenized in place.
+ * The values of one navigation epoch are collected in GpsData and emitted once,
+ * when the next epoch starts or the chunk has been consumed.
+ */
 class NMEAParser : public GPSParser {
     Q_OBJECT
 
@@ -60,23 +67,44 @@ public:
     NMEAParser(QObject *parent = 0);
     ~NMEAParser();
     void processInputStream(char c);
-    char *nmeaGetPacketBuffer(void);
-    char nmeaChecksum(char *gps_buffer);
-    void nmeaTerminateAtChecksum(char *gps_buffer);
-    uint8_t nmeaProcess(cBuffer *rxBuffer);
-    void nmeaProcessGPGGA(char *packet);
-    void nmeaProcessGPRMC(char *packet);
-    void nmeaProcessGPVTG(char *packet);
-    void nmeaProcessGPGSA(char *packet);
-    void nmeaProcessGPGSV(char *packet);
-    void nmeaProcessGPZDA(char *packet);
+    void processInputStream(const QByteArray &data);
     GpsData_t GpsData;
-    cBuffer gpsRxBuffer;
-    char gpsRxData[512];
-    char NmeaPacket[NMEA_BUFFERSIZE];
     uint32_t numUpdates;
     uint32_t numErrors;
     int32_t gpsRxOverflow;
+
+private:
+    enum {
+        UpdatedPosition = 0x01,
+        UpdatedDateTime = 0x02,
+        UpdatedSpeedHeading = 0x04,
+        UpdatedSV  = 0x08,
+        UpdatedDOP = 0x10,
+        UpdatedFix = 0x20
+    };
+
+    QByteArray rxBuffer;
+    QString rawPackets;
+    int updated;
+    QString fixTypeValue;
+    QString fixModeValue;
+    QList<int> fixSVList;
+    // collected from the GSV sentences of an epoch
+    QList<GPSSatellite> satellitesInView;
+
+    int nmeaProcessSentence(const char *data, int length);
+    int ubxProcessMessage(const uchar *data, int length);
+    int nmeaTokenize(char *packet, char *fields[]);
+    bool nmeaChecksum(char *packet);
+    void nmeaProcessGGA(char *fields[], int count);
+    void nmeaProcessRMC(char *fields[], int count);
+    void nmeaProcessVTG(char *fields[], int count);
+    void nmeaProcessGSA(char *fields[], int count);
+    void nmeaProcessGSV(char *fields[], int count);
+    void nmeaProcessZDA(char *fields[], int count);
+    void ubxProcessNavPvt(const uchar *payload);
+    void startEpoch(double time);
+    void emitEpoch();
 };
 
 #endif // NMEAPARSER_H
@@ -27,6 +27,9 @@
 
 
 #include "telemetryparser.h"
+#include "gpspositionsensor.h"
+#include "gpstime.h"
+#include "gpssatellites.h"
 #include <math.h>
 #include <QDebug>
 #include <QStringList>
@@ -34,29 +37,33 @@
 
 /**
  * Initialize the parser
+ *
+ * The objects are read with a single copy of their typed data,
+ * there is no field lookup or QVariant conversion on updates.
  */
 TelemetryParser::TelemetryParser(QObject *parent) : GPSParser(parent)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    UAVDataObject *gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSPositionSensor"));
 
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateGPS(UAVObject *)));
+    gpsPosition = GPSPositionSensor::GetInstance(objManager);
+    if (gpsPosition != NULL) {
+        fixTypes = gpsPosition->getField(QString("Status"))->getOptions();
+        connect(gpsPosition, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateGPS(UAVObject *)));
     } else {
         qDebug() << "Error: Object is unknown (GPSPositionSensor).";
     }
 
-    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSTime"));
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateTime(UAVObject *)));
+    gpsTime = GPSTime::GetInstance(objManager);
+    if (gpsTime != NULL) {
+        connect(gpsTime, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateTime(UAVObject *)));
     } else {
         qDebug() << "Error: Object is unknown (GPSTime).";
     }
 
-    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSSatellites"));
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateSats(UAVObject *)));
+    gpsSatellites = GPSSatellites::GetInstance(objManager);
+    if (gpsSatellites != NULL) {
+        connect(gpsSatellites, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateSats(UAVObject *)));
     }
 }
 
@@ -66,59 +73,53 @@ TelemetryParser::~TelemetryParser()
 
 void TelemetryParser::updateGPS(UAVObject *object1)
 {
-    UAVObjectField *field = object1->getField(QString("Satellites"));
-    emit sv(field->getValue().toInt());
+    Q_UNUSED(object1);
+
+    GPSPositionSensor::DataFields gpsData = gpsPosition->getData();
 
-    double lat = object1->getField(QString("Latitude"))->getDouble();
-    double lon = object1->getField(QString("Longitude"))->getDouble();
-    double alt = object1->getField(QString("Altitude"))->getDouble();
+    emit sv(gpsData.Satellites);
 
-    lat *= 1E-7;
-    lon *= 1E-7;
-    emit position(lat, lon, alt);
+    double lat = gpsData.Latitude * 1E-7;
+    double lon = gpsData.Longitude * 1E-7;
+    emit position(lat, lon, gpsData.Altitude);
 
-    double hdg  = object1->getField(QString("Heading"))->getDouble();
-    double spd  = object1->getField(QString("Groundspeed"))->getDouble();
-    emit speedheading(spd, hdg);
+    emit speedheading(gpsData.Groundspeed, gpsData.Heading);
 
-    QString fix = object1->getField(QString("Status"))->getValue().toString();
-    emit fixtype(fix);
+    emit fixtype(fixTypes.value(gpsData.Status));
 
-    double hdop = object1->getField(QString("HDOP"))->getDouble();
-    double vdop = object1->getField(QString("VDOP"))->getDouble();
-    double pdop = object1->getField(QString("PDOP"))->getDouble();
-    emit dop(hdop, vdop, pdop);
+    emit dop(gpsData.HDOP, gpsData.VDOP, gpsData.PDOP);
 }
 
 void TelemetryParser::updateTime(UAVObject *object1)
 {
-    double hour   = object1->getField(QString("Hour"))->getDouble();
-    double minute = object1->getField(QString("Minute"))->getDouble();
-    double second = object1->getField(QString("Second"))->getDouble();
-    double time   = second + minute * 100 + hour * 10000;
-    double year   = object1->getField(QString("Year"))->getDouble();
-    double month  = object1->getField(QString("Month"))->getDouble();
-    double day    = object1->getField(QString("Day"))->getDouble();
-    double date   = day + month * 100 + year * 10000;
+    Q_UNUSED(object1);
+
+    GPSTime::DataFields timeData = gpsTime->getData();
+
+    double time = timeData.Second + timeData.Minute * 100 + timeData.Hour * 10000;
+    double date = timeData.Day + timeData.Month * 100 + timeData.Year * 10000;
     emit datetime(date, time);
 }
 
 /**
    Updates the satellite constellation.
 
-   Not really optimized for now, we should only send updates for the stas
-   which have changed instead of updating everything... That said, Qt is supposed
-   to be able to optimize redraws anyway.
+   All the satellites are sent at once, the views redraw once per update.
  */
 void TelemetryParser::updateSats(UAVObject *object1)
 {
-    UAVObjectField *prn       = object1->getField(QString("PRN"));
-    UAVObjectField *elevation = object1->getField(QString("Elevation"));
-    UAVObjectField *azimuth   = object1->getField(QString("Azimuth"));
-    UAVObjectField *snr       = object1->getField(QString("SNR"));
-
-    for (unsigned int i = 0; i < prn->getNumElements(); i++) {
-        emit satellite(i, prn->getValue(i).toInt(), elevation->getValue(i).toInt(),
-                       azimuth->getValue(i).toInt(), snr->getValue(i).toInt());
+    Q_UNUSED(object1);
+
+    GPSSatellites::DataFields satsData = gpsSatellites->getData();
+
+    QList<GPSSatellite> sats;
+    for (unsigned int i = 0; i < GPSSatellites::PRN_NUMELEM; i++) {
+        GPSSatellite satellite;
+        satellite.prn       = satsData.PRN[i];
+        satellite.elevation = satsData.Elevation[i];
+        satellite.azimuth   = satsData.Azimuth[i];
+        satellite.snr       = satsData.SNR[i];
+        sats.append(satellite);
     }
+    emit satellites(sats);
 }
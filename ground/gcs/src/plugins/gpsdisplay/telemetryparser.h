@@ -35,6 +35,10 @@
 #include "uavobject.h"
 #include "gpsparser.h"
 
+class GPSPositionSensor;
+class GPSTime;
+class GPSSatellites;
+
 
 class TelemetryParser : public GPSParser {
     Q_OBJECT
@@ -47,6 +51,13 @@ public slots:
     void updateGPS(UAVObject *object1);
     void updateTime(UAVObject *object1);
     void updateSats(UAVObject *object1);
+
+private:
+    GPSPositionSensor *gpsPosition;
+    GPSTime *gpsTime;
+    GPSSatellites *gpsSatellites;
+    // names of the fix status options, by value
+    QStringList fixTypes;
 };
 
 #endif // TELEMETRYPARSER_H
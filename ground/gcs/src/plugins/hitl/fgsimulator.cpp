@@ -289,13 +289,10 @@ void FGSimulator::processUpdate(const QByteArray & inp)
 
     HomeLocation::DataFields homeData = posHome->getData();
     double HomeLLA[3] = { (double)homeData.Latitude * 1e-7, (double)homeData.Longitude * 1e-7, homeData.Altitude };
-    double HomeECEF[3];
-    float HomeRNE[3][3];
     double LLA[3]     = { latitude, longitude, altitude_msl };
     float NED[3];
-    Utils::CoordinateConversions().RneFromLLA(HomeLLA, HomeRNE);
-    Utils::CoordinateConversions().LLA2ECEF(HomeLLA, HomeECEF);
-    Utils::CoordinateConversions().LLA2Base(LLA, HomeECEF, HomeRNE, NED);
+    homeFrame.setBase(HomeLLA);
+    homeFrame.toNED(LLA, NED);
 
     // Update GPS Position objects
     out.latitude    = latitude * 1e7;
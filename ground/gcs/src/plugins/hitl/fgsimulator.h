@@ -50,6 +50,8 @@ private:
     int udpCounterGCSsend; // keeps track of udp packets sent to FG
     int udpCounterFGrecv; // keeps track of udp packets received by FG
 
+    Utils::LocalFrame homeFrame; // NED frame at the home location, rebuilt when it moves
+
     void processUpdate(const QByteArray & data);
 };
 
@@ -34,6 +34,8 @@
 #define DFLT_START_SIM              false
 #define DFLT_addNoise               false
 #define DFLT_ADD_NOISE              false
+#define DFLT_NOISE_SEED             0
+#define DFLT_NOISE_SCALE            1.0
 #define DFLT_HOST_ADDRESS           "127.0.0.1"
 #define DFLT_REMOTE_ADDRESS         "127.0.0.1"
 #define DFLT_OUT_PORT               0
@@ -66,6 +68,8 @@
 #define DFLT_AIRSPEED_STATE_ENABLED false
 #define DFLT_AIRSPEED_STATE_RATE    100
 
+#define DFLT_LOCKSTEP               false
+
 HITLConfiguration::HITLConfiguration(QString classId, QSettings &settings, QObject *parent) :
     IUAVGadgetConfiguration(classId, parent)
 {
@@ -81,7 +85,9 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings &settings, QObje
     simSettings.latitude      = settings.value("latitude", DFLT_LATITUDE).toString();
     simSettings.longitude     = settings.value("longitude", DFLT_LONGITUDE).toString();
     simSettings.startSim      = settings.value("startSim", DFLT_START_SIM).toBool();
-    simSettings.addNoise      = settings.value("noiseCheckBox", DFLT_ADD_NOISE).toBool();
+    simSettings.addNoise      = settings.value("addNoise", DFLT_ADD_NOISE).toBool();
+    simSettings.noiseSeed     = settings.value("noiseSeed", DFLT_NOISE_SEED).toUInt();
+    simSettings.noiseScale    = settings.value("noiseScale", DFLT_NOISE_SCALE).toDouble();
 
     simSettings.gcsReceiverEnabled   = settings.value("gcsReceiverEnabled", DFLT_GCS_RECEIVER_ENABLED).toBool();
     simSettings.manualControlEnabled = settings.value("manualControlEnabled", DFLT_MANUAL_CONTROL_ENABLED).toBool();
@@ -108,6 +114,8 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings &settings, QObje
 
     simSettings.airspeedStateEnabled = settings.value("airspeedStateEnabled", DFLT_AIRSPEED_STATE_ENABLED).toBool();
     simSettings.airspeedStateRate    = settings.value("airspeedStateRate", DFLT_AIRSPEED_STATE_RATE).toInt();
+
+    simSettings.lockstep = settings.value("lockstep", DFLT_LOCKSTEP).toBool();
 }
 
 HITLConfiguration::HITLConfiguration(const HITLConfiguration &obj) :
@@ -139,6 +147,8 @@ void HITLConfiguration::saveConfig(QSettings &settings) const
     settings.setValue("latitude", simSettings.latitude);
     settings.setValue("longitude", simSettings.longitude);
     settings.setValue("addNoise", simSettings.addNoise);
+    settings.setValue("noiseSeed", simSettings.noiseSeed);
+    settings.setValue("noiseScale", simSettings.noiseScale);
     settings.setValue("startSim", simSettings.startSim);
 
     settings.setValue("gcsReceiverEnabled", simSettings.gcsReceiverEnabled);
@@ -161,4 +171,6 @@ void HITLConfiguration::saveConfig(QSettings &settings) const
 
     settings.setValue("airspeedStateEnabled", simSettings.airspeedStateEnabled);
     settings.setValue("airspeedStateRate", simSettings.airspeedStateRate);
+
+    settings.setValue("lockstep", simSettings.lockstep);
 }
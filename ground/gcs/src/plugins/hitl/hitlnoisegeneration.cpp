@@ -27,10 +27,41 @@
 
 #include "hitlnoisegeneration.h"
 
+#include <QDateTime>
+#include <QDebug>
 
-HitlNoiseGeneration::HitlNoiseGeneration()
+// standard deviation of each channel, in the unit of its field
+const float HitlNoiseGeneration::deviations[NOISE_CHANNELS] = {
+    0.05f, 0.05f, 0.05f, // accel, m/s^2
+    0.2f, 0.2f, 0.2f, // gyro, deg/s
+    0.1f, 0.1f, 0.1f, // attitude, deg
+    100.0f, 100.0f, 1.5f, 0.1f, 0.5f, // gps lat/lon (deg * 10^7, about 1 m), altitude m, groundspeed m/s, heading deg
+    0.1f, 0.1f, 0.1f, // gps velocity, m/s
+    0.2f, 0.05f, 0.002f, // baro altitude m, temperature C, pressure kPa
+    0.2f, 0.2f, // airspeed, m/s
+    0.05f, 0.05f, 0.05f, // velocity state, m/s
+    0.2f, 0.2f, 0.2f // position state, m
+};
+
+HitlNoiseGeneration::HitlNoiseGeneration(quint32 seed, double scale) :
+    seed(seed), scale(scale)
 {
     memset(&noise, 0, sizeof(Noise));
+
+    if (this->seed == 0) {
+        this->seed = (quint32)QDateTime::currentMSecsSinceEpoch() | 1;
+    }
+    qDebug() << "HITL noise seed:" << this->seed;
+
+    // splitmix64 spreads the seed over the xorshift128+ state, which must not be all zero
+    quint64 z = this->seed;
+    for (int i = 0; i < 2; i++) {
+        z += Q_UINT64_C(0x9E3779B97F4A7C15);
+        quint64 x = z;
+        x = (x ^ (x >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+        x = (x ^ (x >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+        state[i] = x ^ (x >> 31);
+    }
 }
 
 
@@ -42,37 +73,85 @@ Noise HitlNoiseGeneration::getNoise()
     return noise;
 }
 
+// xorshift128+
+quint64 HitlNoiseGeneration::nextRandom()
+{
+    quint64 s1 = state[0];
+    const quint64 s0 = state[1];
+
+    state[0] = s0;
+    s1 ^= s1 << 23;
+    state[1] = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+    return state[1] + s0;
+}
+
+/**
+ * Batched Box-Muller, the uniform draws and the transform are separate loops
+ * so the transform runs over plain arrays
+ */
+void HitlNoiseGeneration::fillGaussian(float *samples)
+{
+    double u1[NOISE_SAMPLES / 2];
+    double u2[NOISE_SAMPLES / 2];
+
+    for (int i = 0; i < NOISE_SAMPLES / 2; i++) {
+        // 53 bit mantissa in (0, 1), log() never sees zero
+        u1[i] = ((nextRandom() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        u2[i] = ((nextRandom() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+    for (int i = 0; i < NOISE_SAMPLES / 2; i++) {
+        double r     = sqrt(-2.0 * log(u1[i]));
+        double theta = 2.0 * M_PI * u2[i];
+        samples[2 * i]     = r * cos(theta);
+        samples[2 * i + 1] = r * sin(theta);
+    }
+}
+
 Noise HitlNoiseGeneration::generateNoise()
 {
-    noise.accelStateData.x       = 0;
-    noise.accelStateData.y       = 0;
-    noise.accelStateData.z       = 0;
+    float n[NOISE_SAMPLES];
+
+    fillGaussian(n);
+    for (int i = 0; i < NOISE_CHANNELS; i++) {
+        n[i] *= deviations[i] * scale;
+    }
+
+    noise.accelStateData.x       = n[ACCEL_X];
+    noise.accelStateData.y       = n[ACCEL_Y];
+    noise.accelStateData.z       = n[ACCEL_Z];
+
+    noise.gyroStateData.x        = n[GYRO_X];
+    noise.gyroStateData.y        = n[GYRO_Y];
+    noise.gyroStateData.z        = n[GYRO_Z];
 
-    noise.gpsPosData.Latitude    = 0;
-    noise.gpsPosData.Longitude   = 0;
-    noise.gpsPosData.Groundspeed = 0;
-    noise.gpsPosData.Heading     = 0;
-    noise.gpsPosData.Altitude    = 0;
+    noise.attStateData.Roll      = n[ATT_ROLL];
+    noise.attStateData.Pitch     = n[ATT_PITCH];
+    noise.attStateData.Yaw       = n[ATT_YAW];
 
-    noise.gpsVelData.North       = 0;
-    noise.gpsVelData.East = 0;
-    noise.gpsVelData.Down = 0;
+    noise.gpsPosData.Latitude    = qRound(n[GPS_LATITUDE]);
+    noise.gpsPosData.Longitude   = qRound(n[GPS_LONGITUDE]);
+    noise.gpsPosData.Altitude    = n[GPS_ALTITUDE];
+    noise.gpsPosData.Groundspeed = n[GPS_GROUNDSPEED];
+    noise.gpsPosData.Heading     = n[GPS_HEADING];
 
-    noise.baroAltData.Altitude = 0;
+    noise.gpsVelData.North       = n[GPS_VEL_NORTH];
+    noise.gpsVelData.East        = n[GPS_VEL_EAST];
+    noise.gpsVelData.Down        = n[GPS_VEL_DOWN];
 
-    noise.attStateData.Roll    = 0;
-    noise.attStateData.Pitch   = 0;
-    noise.attStateData.Yaw     = 0;
+    noise.baroAltData.Altitude    = n[BARO_ALTITUDE];
+    noise.baroAltData.Temperature = n[BARO_TEMPERATURE];
+    noise.baroAltData.Pressure    = n[BARO_PRESSURE];
 
-    noise.gyroStateData.x  = 0;
-    noise.gyroStateData.y  = 0;
-    noise.gyroStateData.z  = 0;
+    noise.airspeedState.CalibratedAirspeed = n[AIRSPEED_CALIBRATED];
+    noise.airspeedState.TrueAirspeed       = n[AIRSPEED_TRUE];
 
-    noise.accelStateData.x = 0;
-    noise.accelStateData.y = 0;
-    noise.accelStateData.z = 0;
+    noise.velocityStateData.North = n[VEL_NORTH];
+    noise.velocityStateData.East  = n[VEL_EAST];
+    noise.velocityStateData.Down  = n[VEL_DOWN];
 
-    noise.airspeedState.CalibratedAirspeed = 0;
+    noise.positionStateData.North = n[POS_NORTH];
+    noise.positionStateData.East  = n[POS_EAST];
+    noise.positionStateData.Down  = n[POS_DOWN];
 
     return noise;
 }
@@ -28,14 +28,7 @@
 #ifndef HITLNOISEGENERATION_H
 #define HITLNOISEGENERATION_H
 
-// #include <QObject>
-// #include <simulator.h>
-#include "xplanesimulator9.h"
-#include "xplanesimulator10.h"
-#include "hitlnoisegeneration.h"
-#include "extensionsystem/pluginmanager.h"
-#include <coreplugin/icore.h>
-#include <coreplugin/threadmanager.h>
+#include "simulator.h"
 
 struct Noise {
     AccelState::DataFields        accelStateData;
@@ -50,17 +43,46 @@ struct Noise {
     VelocityState::DataFields     velocityStateData;
 };
 
+/**
+ * Gaussian sensor noise, all the channels of a frame are drawn at once.
+ * The generator is seeded, the same seed gives the same noise sequence.
+ */
 class HitlNoiseGeneration {
-// Q_OBJECT
 public:
-    HitlNoiseGeneration();
+    // a zero seed is taken from the clock, scale multiplies the default deviations
+    HitlNoiseGeneration(quint32 seed = 0, double scale = 1.0);
     ~HitlNoiseGeneration();
 
+    quint32 getSeed() const
+    {
+        return seed;
+    }
     Noise getNoise();
     Noise generateNoise();
-private slots:
 
 private:
+    enum Channel {
+        ACCEL_X, ACCEL_Y, ACCEL_Z,
+        GYRO_X, GYRO_Y, GYRO_Z,
+        ATT_ROLL, ATT_PITCH, ATT_YAW,
+        GPS_LATITUDE, GPS_LONGITUDE, GPS_ALTITUDE, GPS_GROUNDSPEED, GPS_HEADING,
+        GPS_VEL_NORTH, GPS_VEL_EAST, GPS_VEL_DOWN,
+        BARO_ALTITUDE, BARO_TEMPERATURE, BARO_PRESSURE,
+        AIRSPEED_CALIBRATED, AIRSPEED_TRUE,
+        VEL_NORTH, VEL_EAST, VEL_DOWN,
+        POS_NORTH, POS_EAST, POS_DOWN,
+        NOISE_CHANNELS
+    };
+    // Box-Muller produces samples in pairs
+    static const int NOISE_SAMPLES = (NOISE_CHANNELS + 1) & ~1;
+    static const float deviations[NOISE_CHANNELS];
+
+    quint64 nextRandom();
+    void fillGaussian(float *samples);
+
+    quint32 seed;
+    float scale;
+    quint64 state[2];
     Noise noise;
 };
 #endif // HITLNOISEGENERATION_H
@@ -82,6 +82,9 @@ QWidget *HITLOptionsPage::createPage(QWidget *parent)
 
     m_optionsPage->startSim->setChecked(config->Settings().startSim);
     m_optionsPage->noiseCheckBox->setChecked(config->Settings().addNoise);
+    m_optionsPage->noiseSeedSpinBox->setValue(config->Settings().noiseSeed);
+    m_optionsPage->noiseScaleSpinBox->setValue(config->Settings().noiseScale);
+    m_optionsPage->lockstepCheckBox->setChecked(config->Settings().lockstep);
 
     m_optionsPage->hostAddress->setText(config->Settings().hostAddress);
     m_optionsPage->remoteAddress->setText(config->Settings().remoteAddress);
@@ -135,6 +138,9 @@ void HITLOptionsPage::apply()
     settings.latitude             = m_optionsPage->latitude->text();
 
     settings.addNoise             = m_optionsPage->noiseCheckBox->isChecked();
+    settings.noiseSeed            = m_optionsPage->noiseSeedSpinBox->value();
+    settings.noiseScale           = m_optionsPage->noiseScaleSpinBox->value();
+    settings.lockstep             = m_optionsPage->lockstepCheckBox->isChecked();
 
     settings.attRawEnabled        = m_optionsPage->attRawCheckbox->isChecked();
     settings.attRawRate           = m_optionsPage->attRawRateSpinbox->value();
@@ -51,12 +51,15 @@ Simulator::Simulator(const SimulatorSettings & params) :
     inSocket(NULL),
     outSocket(NULL),
     settings(params),
+    noiseSource(NULL),
     updatePeriod(50),
     simTimeout(8000),
     autopilotConnectionStatus(false),
     simConnectionStatus(false),
     txTimer(NULL),
     simTimer(NULL),
+    frameReceiveTime(0),
+    lastFrameTime(0),
     name("")
 {
     // move to thread
@@ -86,6 +89,9 @@ Simulator::Simulator(const SimulatorSettings & params) :
 
 Simulator::~Simulator()
 {
+    delete noiseSource;
+    noiseSource = NULL;
+
     if (inSocket) {
         delete inSocket;
         inSocket = NULL;
@@ -201,7 +207,11 @@ void Simulator::onStart()
     txTimer = new QTimer();
     connect(txTimer, SIGNAL(timeout()), this, SLOT(transmitUpdate()), Qt::DirectConnection);
     txTimer->setInterval(updatePeriod);
-    txTimer->start();
+    // in lockstep mode the simulator is answered as soon as each of its frames is processed
+    if (!settings.lockstep) {
+        txTimer->start();
+    }
+    frameStatsTime.start();
     // Setup simulator connection timer
     simTimer = new QTimer();
     connect(simTimer, SIGNAL(timeout()), this, SLOT(onSimulatorConnectionTimeout()), Qt::DirectConnection);
@@ -237,7 +247,56 @@ void Simulator::receiveUpdate()
                                &sender, &senderPort);
         // QString datastr(datagram);
         // Process incomming data
+        frameReceiveTime = LatencyHistogram::timestamp();
         processUpdate(datagram);
+        if (settings.lockstep) {
+            pushFrame();
+            transmitUpdate();
+        }
+    }
+}
+
+/**
+ * Lockstep mode: the output objects are in manual update mode and the ones
+ * written for a simulator frame are collected here, to be sent together
+ */
+void Simulator::frameUpdated(UAVObject *obj)
+{
+    if (settings.lockstep && outputObjects.contains(obj) && !frameObjects.contains(obj)) {
+        frameObjects.append(obj);
+    }
+}
+
+/**
+ * Send the objects of the frame, telemetry writes the packets queued from the same
+ * event in one batch, and keep statistics of the frame receive to send latency
+ */
+void Simulator::pushFrame()
+{
+    if (frameObjects.isEmpty()) {
+        return;
+    }
+    foreach(UAVObject * obj, frameObjects) {
+        obj->updated();
+    }
+    frameObjects.clear();
+
+    qint64 now = LatencyHistogram::timestamp();
+    frameLatency.add(now - frameReceiveTime);
+    if (lastFrameTime) {
+        frameInterval.add(frameReceiveTime - lastFrameTime);
+    }
+    lastFrameTime = frameReceiveTime;
+
+    if (frameStatsTime.elapsed() >= FRAME_STATS_PERIOD) {
+        emit processOutput(QString("Lockstep: %1 frames, latency p50 %2 us p95 %3 us max %4 us, "
+                                   "frame interval p50 %5 us p95 %6 us\n")
+                           .arg(frameLatency.count())
+                           .arg(frameLatency.percentile(50)).arg(frameLatency.percentile(95)).arg(frameLatency.max())
+                           .arg(frameInterval.percentile(50)).arg(frameInterval.percentile(95)));
+        frameLatency.reset();
+        frameInterval.reset();
+        frameStatsTime.restart();
     }
 }
 
@@ -337,13 +396,20 @@ void Simulator::setupOutputObject(UAVObject *obj, quint32 updatePeriod)
 
     UAVObject::SetGcsAccess(mdata, UAVObject::ACCESS_READWRITE);
     UAVObject::SetGcsTelemetryAcked(mdata, false);
-    UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_PERIODIC);
-    mdata.gcsTelemetryUpdatePeriod = updatePeriod;
+    if (settings.lockstep) {
+        // sent with the simulator frames, see pushFrame()
+        UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_MANUAL);
+        mdata.gcsTelemetryUpdatePeriod = 0;
+    } else {
+        UAVObject::SetGcsTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_PERIODIC);
+        mdata.gcsTelemetryUpdatePeriod = updatePeriod;
+    }
 
     UAVObject::SetFlightAccess(mdata, UAVObject::ACCESS_READONLY);
     UAVObject::SetFlightTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_MANUAL);
 
     obj->setMetadata(mdata);
+    outputObjects.insert(obj);
 }
 
 void Simulator::onAutopilotConnect()
@@ -392,10 +458,13 @@ void Simulator::updateUAVOs(Output2Hardware out)
     QTime currentTime = QTime::currentTime();
 
     Noise noise;
-    HitlNoiseGeneration noiseSource;
 
     if (settings.addNoise) {
-        noise = noiseSource.generateNoise();
+        // kept for the whole run, a seeded run gives the same noise sequence
+        if (!noiseSource) {
+            noiseSource = new HitlNoiseGeneration(settings.noiseSeed, settings.noiseScale);
+        }
+        noise = noiseSource->generateNoise();
     } else {
         memset(&noise, 0, sizeof(Noise));
     }
@@ -457,6 +526,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
 
     // Set UAVO
     groundTruth->setData(groundTruthData);
+    frameUpdated(groundTruth);
 
 /*******************************/
     // Update attState object
@@ -484,6 +554,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
 
         // Set UAVO
         attState->setData(attStateData);
+        frameUpdated(attState);
         /*****************************************/
     } else if (settings.attActCalc) {
         // calculate RPY with code from Attitude module
@@ -605,6 +676,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
 
         // Set UAVO
         attState->setData(attStateData);
+        frameUpdated(attState);
         /*****************************************/
     }
 
@@ -619,6 +691,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             }
 
             gcsReceiver->setData(gcsRcvrData);
+            frameUpdated(gcsReceiver);
 
             gcsRcvrTime = gcsRcvrTime.addMSecs(settings.minOutputPeriod);
         }
@@ -644,6 +717,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             gpsPosData.Status = GPSPositionSensor::STATUS_FIX3D;
 
             gpsPos->setData(gpsPosData);
+            frameUpdated(gpsPos);
 
             // Update GPS Velocity.{North,East,Down}
             GPSVelocitySensor::DataFields gpsVelData;
@@ -653,6 +727,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             gpsVelData.Down  = out.velDown + noise.gpsVelData.Down;
 
             gpsVel->setData(gpsVelData);
+            frameUpdated(gpsVel);
 
             gpsPosTime = gpsPosTime.addMSecs(settings.gpsPosRate);
         }
@@ -668,6 +743,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             velocityStateData.East  = out.velEast + noise.velocityStateData.East;
             velocityStateData.Down  = out.velDown + noise.velocityStateData.Down;
             velState->setData(velocityStateData);
+            frameUpdated(velState);
 
             // Update PositionState.{Nort,East,Down}
             PositionState::DataFields positionStateData;
@@ -676,6 +752,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             positionStateData.East  = (out.dstE - initE) + noise.positionStateData.East;
             positionStateData.Down  = (out.dstD /*-initD*/) + noise.positionStateData.Down;
             posState->setData(positionStateData);
+            frameUpdated(posState);
 
             groundTruthTime = groundTruthTime.addMSecs(settings.groundTruthRate);
         }
@@ -713,6 +790,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             baroAltData.Temperature = out.temperature + noise.baroAltData.Temperature;
             baroAltData.Pressure    = out.pressure + noise.baroAltData.Pressure;
             baroAlt->setData(baroAltData);
+            frameUpdated(baroAlt);
 
             baroAltTime = baroAltTime.addMSecs(settings.baroAltRate);
         }
@@ -728,6 +806,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             batteryData.Current = out.current;
             batteryData.ConsumedEnergy = out.consumption;
             flightBatt->setData(batteryData);
+            frameUpdated(flightBatt);
 
             battTime = battTime.addMSecs(settings.baroAltRate);
         }
@@ -744,6 +823,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             // airspeedStateData.alpha=out.angleOfAttack; // to be implemented
             // airspeedStateData.beta=out.angleOfSlip;
             airspeedState->setData(airspeedStateData);
+            frameUpdated(airspeedState);
 
             airspeedStateTime = airspeedStateTime.addMSecs(settings.airspeedStateRate);
         }
@@ -760,6 +840,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             gyroStateData.y = out.pitchRate + noise.gyroStateData.y;
             gyroStateData.z = out.yawRate + noise.gyroStateData.z;
             gyroState->setData(gyroStateData);
+            frameUpdated(gyroState);
 
             // Update accelerometer sensor data
             AccelState::DataFields accelStateData;
@@ -768,6 +849,7 @@ void Simulator::updateUAVOs(Output2Hardware out)
             accelStateData.y = out.accY + noise.accelStateData.y;
             accelStateData.z = out.accZ + noise.accelStateData.z;
             accelState->setData(accelStateData);
+            frameUpdated(accelState);
 
             attRawTime = attRawTime.addMSecs(settings.attRawRate);
         }
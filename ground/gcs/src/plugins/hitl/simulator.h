@@ -53,12 +53,14 @@
 #include "velocitystate.h"
 
 #include "utils/coordinateconversions.h"
+#include "uavtalk/latencyhistogram.h"
 
 #include <QObject>
 #include <QUdpSocket>
 #include <QTime>
 #include <QTimer>
 #include <QProcess>
+#include <QSet>
 #include <qmath.h>
 
 /**
@@ -122,6 +124,8 @@ typedef struct _CONNECTION {
     int     inPort;
     bool    startSim;
     bool    addNoise;
+    quint32 noiseSeed; // 0 seeds from the clock
+    double  noiseScale; // multiplies the default noise deviations
     QString latitude;
     QString longitude;
 
@@ -151,6 +155,8 @@ typedef struct _CONNECTION {
 
     bool    airspeedStateEnabled;
     quint16 airspeedStateRate;
+
+    bool    lockstep; // send the objects of each simulator frame at once and answer it right away
 } SimulatorSettings;
 
 
@@ -208,6 +214,8 @@ struct Output2Hardware {
 // float motor;
 // };
 
+class HitlNoiseGeneration;
+
 class Simulator : public QObject {
     Q_OBJECT
 
@@ -272,6 +280,7 @@ public:
 
     void resetInitialHomePosition();
     void updateUAVOs(Output2Hardware out);
+    void frameUpdated(UAVObject *obj);
 
     AirParameters getAirParameters();
     void setAirParameters(AirParameters airParameters);
@@ -337,6 +346,7 @@ protected:
     GroundTruth *groundTruth;
 
     SimulatorSettings settings;
+    HitlNoiseGeneration *noiseSource;
 
     FLIGHT_PARAM current;
     FLIGHT_PARAM old;
@@ -363,6 +373,17 @@ private:
     QTime gcsRcvrTime;
     QTime airspeedStateTime;
 
+    // lockstep mode
+    QSet<UAVObject *> outputObjects;
+    QList<UAVObject *> frameObjects;
+    qint64 frameReceiveTime;
+    qint64 lastFrameTime;
+    LatencyHistogram frameLatency;
+    LatencyHistogram frameInterval;
+    QTime frameStatsTime;
+    static const int FRAME_STATS_PERIOD = 5000;
+    void pushFrame();
+
     QString name;
     QString simulatorId;
     volatile static bool isStarted;
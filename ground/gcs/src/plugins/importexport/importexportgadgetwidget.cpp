@@ -172,9 +172,10 @@ void ImportExportGadgetWidget::on_importButton_clicked()
     }
     importConfiguration(file);
 
-    // The new configs are added to the old configs. Things are messy now.
+    // Unchanged configurations and layouts are kept, only what changed was reloaded.
+    // Some general settings (e.g. the language) still need a restart.
     msgBox.setText(tr("The settings have been imported from ") + QFileInfo(file).absoluteFilePath()
-                   + tr(". Restart the application."));
+                   + tr(". Some general settings only take effect after restarting the application."));
     msgBox.exec();
     emit done();
 }
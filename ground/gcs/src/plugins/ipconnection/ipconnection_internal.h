@@ -12,8 +12,11 @@ public:
     IPConnection(IPConnectionConnection *connection);
 
 public slots:
-    void onOpenDevice(QString HostName, int Port, bool UseTCP);
+    void onOpenDevice(QString HostName, int Port, bool UseTCP, bool LowDelay, int ReceiveBufferSize);
     void onCloseDevice(QAbstractSocket *ipSocket);
+
+private slots:
+    void onReadyRead();
 };
 
 #endif // IPCONNECTION_INTERNAL_H
@@ -36,6 +36,8 @@ IPConnectionConfiguration::IPConnectionConfiguration(QString classId, QSettings
     m_hostName = settings.value("HostName", "").toString();
     m_port     = settings.value("Port", 9000).toInt();
     m_useTCP   = settings.value("UseTCP", true).toInt();
+    m_lowDelay = settings.value("LowDelay", true).toBool();
+    m_receiveBufferSize = settings.value("ReceiveBufferSize", 0).toInt();
 }
 
 IPConnectionConfiguration::IPConnectionConfiguration(const IPConnectionConfiguration &obj) :
@@ -44,6 +46,8 @@ IPConnectionConfiguration::IPConnectionConfiguration(const IPConnectionConfigura
     m_hostName = obj.m_hostName;
     m_port     = obj.m_port;
     m_useTCP   = obj.m_useTCP;
+    m_lowDelay = obj.m_lowDelay;
+    m_receiveBufferSize = obj.m_receiveBufferSize;
 }
 
 IPConnectionConfiguration::~IPConnectionConfiguration()
@@ -63,4 +67,6 @@ void IPConnectionConfiguration::saveConfig(QSettings &settings) const
     settings.setValue("HostName", m_hostName);
     settings.setValue("Port", m_port);
     settings.setValue("UseTCP", m_useTCP);
+    settings.setValue("LowDelay", m_lowDelay);
+    settings.setValue("ReceiveBufferSize", m_receiveBufferSize);
 }
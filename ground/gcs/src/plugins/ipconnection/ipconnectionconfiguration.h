@@ -39,6 +39,8 @@ class IPConnectionConfiguration : public IUAVGadgetConfiguration {
     Q_OBJECT Q_PROPERTY(QString HostName READ hostName WRITE setHostName)
     Q_PROPERTY(int Port READ port WRITE setPort)
     Q_PROPERTY(int UseTCP READ useTCP WRITE setUseTCP)
+    Q_PROPERTY(bool LowDelay READ lowDelay WRITE setLowDelay)
+    Q_PROPERTY(int ReceiveBufferSize READ receiveBufferSize WRITE setReceiveBufferSize)
 
 public:
     explicit IPConnectionConfiguration(QString classId, QSettings &settings, QObject *parent = 0);
@@ -61,6 +63,16 @@ public:
     {
         return m_useTCP;
     }
+    // disable Nagle's algorithm on TCP connections
+    bool lowDelay() const
+    {
+        return m_lowDelay;
+    }
+    // socket receive buffer size in bytes, 0 for the system default
+    int receiveBufferSize() const
+    {
+        return m_receiveBufferSize;
+    }
 
 public slots:
     void setHostName(QString hostName)
@@ -75,11 +87,21 @@ public slots:
     {
         m_useTCP = useTCP;
     }
+    void setLowDelay(bool lowDelay)
+    {
+        m_lowDelay = lowDelay;
+    }
+    void setReceiveBufferSize(int receiveBufferSize)
+    {
+        m_receiveBufferSize = receiveBufferSize;
+    }
 
 private:
     QString m_hostName;
     int m_port;
     int m_useTCP;
+    bool m_lowDelay;
+    int m_receiveBufferSize;
 };
 
 #endif // IPCONFIGURATIONCONFIGURATION_H
@@ -49,6 +49,8 @@ QWidget *IPConnectionOptionsPage::createPage(QWidget *parent)
     m_page->HostName->setText(m_config->hostName());
     m_page->UseTCP->setChecked(m_config->useTCP() ? true : false);
     m_page->UseUDP->setChecked(m_config->useTCP() ? false : true);
+    m_page->LowDelay->setChecked(m_config->lowDelay());
+    m_page->ReceiveBufferSize->setValue(m_config->receiveBufferSize() / 1024);
 
     return w;
 }
@@ -58,6 +60,8 @@ void IPConnectionOptionsPage::apply()
     m_config->setPort(m_page->Port->value());
     m_config->setHostName(m_page->HostName->text());
     m_config->setUseTCP(m_page->UseTCP->isChecked() ? 1 : 0);
+    m_config->setLowDelay(m_page->LowDelay->isChecked());
+    m_config->setReceiveBufferSize(m_page->ReceiveBufferSize->value() * 1024);
 
     // FIXME this signal is too low level (and duplicated all over the place)
     // FIXME this signal will trigger (amongst other things) the saving of the configuration !
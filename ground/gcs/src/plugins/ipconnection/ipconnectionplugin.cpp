@@ -45,6 +45,8 @@
 #include <QMutex>
 #include <QDebug>
 
+#include <chrono>
+
 // Communication between IPConnectionConnection::OpenDevice() and IPConnection::onOpenDevice()
 QString errorMsg;
 QWaitCondition openDeviceWait;
@@ -57,8 +59,8 @@ IPConnection::IPConnection(IPConnectionConnection *connection) : QObject()
 {
     moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
 
-    QObject::connect(connection, SIGNAL(CreateSocket(QString, int, bool)),
-                     this, SLOT(onOpenDevice(QString, int, bool)));
+    QObject::connect(connection, SIGNAL(CreateSocket(QString, int, bool, bool, int)),
+                     this, SLOT(onOpenDevice(QString, int, bool, bool, int)));
     QObject::connect(connection, SIGNAL(CloseSocket(QAbstractSocket *)),
                      this, SLOT(onCloseDevice(QAbstractSocket *)));
 }
@@ -68,7 +70,7 @@ IPConnection::IPConnection(IPConnectionConnection *connection) : QObject()
 
    }*/
 
-void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
+void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP, bool LowDelay, int ReceiveBufferSize)
 {
     QAbstractSocket *ipSocket;
     const int Timeout = 5 * 1000;
@@ -89,6 +91,14 @@ void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
 
         // in blocking mode so we wait for the connection to succeed
         if (ipSocket->waitForConnected(Timeout)) {
+            if (UseTCP) {
+                ipSocket->setSocketOption(QAbstractSocket::LowDelayOption, LowDelay ? 1 : 0);
+            }
+            if (ReceiveBufferSize > 0) {
+                ipSocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, ReceiveBufferSize);
+            }
+            // tell UAVTalk when the data it reads was received, for the telemetry latency statistics
+            connect(ipSocket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
             ret = ipSocket;
             openDeviceWait.wakeAll();
             ipConMutex.unlock();
@@ -104,6 +114,13 @@ void IPConnection::onOpenDevice(QString HostName, int Port, bool UseTCP)
     ipConMutex.unlock();
 }
 
+void IPConnection::onReadyRead()
+{
+    // same clock as the UAVTalk latency statistics, see UAVTalk::processInputStream()
+    sender()->setProperty("readTimestamp", (qint64)std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
 void IPConnection::onCloseDevice(QAbstractSocket *ipSocket)
 {
     ipConMutex.lock();
@@ -189,7 +206,7 @@ QIODevice *IPConnectionConnection::openDevice(const QString &)
     }
 
     ipConMutex.lock();
-    emit CreateSocket(hostName, port, useTCP);
+    emit CreateSocket(hostName, port, useTCP, m_config->lowDelay(), m_config->receiveBufferSize());
     openDeviceWait.wait(&ipConMutex);
     ipConMutex.unlock();
     m_ipSocket = ret;
@@ -73,7 +73,7 @@ protected slots:
 signals:
     // For the benefit of IPConnection
     // FIXME change to camel case
-    void CreateSocket(QString HostName, int Port, bool UseTCP);
+    void CreateSocket(QString HostName, int Port, bool UseTCP, bool LowDelay, int ReceiveBufferSize);
     void CloseSocket(QAbstractSocket *socket);
 
 private:
@@ -50,9 +50,10 @@ LineardialGadgetWidget::LineardialGadgetWidget(QWidget *parent) : QGraphicsView(
     places = 0;
     factor = 1;
 
-    // This timer mechanism makes the index rotate smoothly
+    // This timer mechanism makes the index move smoothly,
+    // it only runs until the index reaches its target
+    dialTimer.setInterval(30);
     connect(&dialTimer, SIGNAL(timeout()), this, SLOT(moveIndex()));
-    dialTimer.start(30);
 }
 
 LineardialGadgetWidget::~LineardialGadgetWidget()
@@ -124,7 +125,7 @@ void LineardialGadgetWidget::updateIndex(UAVObject *object1)
         if (field->isNumeric()) {
             double v;
             if (haveSubField1) {
-                int indexOfSubField = field->getElementNames().indexOf(QRegExp(subfield1, Qt::CaseSensitive, QRegExp::FixedString));
+                int indexOfSubField = field->getElementIndex(subfield1);
                 v = field->getDouble(indexOfSubField) * factor;
             } else {
                 v = field->getDouble() * factor;
@@ -148,10 +149,6 @@ void LineardialGadgetWidget::updateIndex(UAVObject *object1)
         if (fieldValue) {
             fieldValue->setPlainText(s);
         }
-
-        if (index && !dialTimer.isActive()) {
-            dialTimer.start();
-        }
     } else {
         qDebug() << "Wrong field, maybe an issue with object disconnection ?";
     }
@@ -342,9 +339,18 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
 
         l_scene->setSceneRect(background->boundingRect());
 
+        // The SVG layers are rendered once per size: the bargraph, its zones and the index
+        // are cached at their displayed size and the index moves as a cached pixmap
+        background->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+        foreach(QGraphicsItem * item, background->childItems()) {
+            if (qgraphicsitem_cast<QGraphicsSvgItem *>(item)) {
+                item->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+            }
+        }
+
         // Reset the current index value:
         indexValue = 0;
-        if (!dialTimer.isActive() && index) {
+        if (!dialTimer.isActive() && index && indexValue != indexTarget) {
             dialTimer.start();
         }
     } else {
@@ -415,6 +421,9 @@ void LineardialGadgetWidget::setIndex(double value)
     } else {
         indexTarget = 100 * (value - minValue) / (maxValue - minValue);
     }
+    if (index && indexTarget != indexValue && !dialTimer.isActive()) {
+        dialTimer.start();
+    }
 }
 
 // Take an input value and move the index accordingly
@@ -440,7 +449,6 @@ void LineardialGadgetWidget::moveIndex()
     } else {
         matrix.translate(trans + startX, startY);
     }
+    // the scene repaints what the index covered, no need to repaint the whole view
     index->setTransform(matrix, false);
-
-    update();
 }
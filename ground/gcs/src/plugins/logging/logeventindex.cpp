@@ -0,0 +1,272 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logeventindex.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup LoggingGadgetPlugin Logging Gadget Plugin
+ * @{
+ * @brief      Index of the object updates and flight events of a replayed log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "logeventindex.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavdataobject.h"
+#include "flightstatus.h"
+#include "systemalarms.h"
+#include <uavtalk/uavtalk.h>
+#include <utils/logfile.h>
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+#include <algorithm>
+
+LogEventIndex::LogEventIndex(QObject *parent) : QObject(parent), m_ready(false)
+{
+    connect(&m_watcher, &QFutureWatcher<Index>::finished, this, &LogEventIndex::indexBuilt);
+}
+
+LogEventIndex::~LogEventIndex()
+{
+    m_watcher.waitForFinished();
+}
+
+/**
+ * Start building the index of a log in a background thread,
+ * indexReady() is emitted when done
+ */
+void LogEventIndex::build(const QString &logFileName)
+{
+    clear();
+    m_watcher.setFuture(QtConcurrent::run(&LogEventIndex::buildIndex, logFileName));
+}
+
+void LogEventIndex::clear()
+{
+    // a running build can't be interrupted, its result is dropped
+    m_watcher.waitForFinished();
+    m_watcher.setFuture(QFuture<Index>());
+    m_index = Index();
+    m_ready = false;
+}
+
+void LogEventIndex::indexBuilt()
+{
+    if (m_watcher.isCanceled()) {
+        return;
+    }
+    m_index = m_watcher.result();
+    m_ready = true;
+    emit indexReady();
+}
+
+quint32 LogEventIndex::firstUpdate(quint32 objId) const
+{
+    QHash<quint32, QVector<quint32> >::const_iterator i = m_index.updates.constFind(objId);
+
+    return (i == m_index.updates.constEnd() || i->isEmpty()) ? 0 : i->first();
+}
+
+quint32 LogEventIndex::lastUpdate(quint32 objId) const
+{
+    QHash<quint32, QVector<quint32> >::const_iterator i = m_index.updates.constFind(objId);
+
+    return (i == m_index.updates.constEnd() || i->isEmpty()) ? 0 : i->last();
+}
+
+quint32 LogEventIndex::nextUpdate(quint32 objId, quint32 timeStamp) const
+{
+    QHash<quint32, QVector<quint32> >::const_iterator i = m_index.updates.constFind(objId);
+
+    if (i == m_index.updates.constEnd()) {
+        return 0;
+    }
+    // the update times are sorted, as the log records
+    QVector<quint32>::const_iterator next = std::upper_bound(i->constBegin(), i->constEnd(), timeStamp);
+    return next == i->constEnd() ? 0 : *next;
+}
+
+quint32 LogEventIndex::applyKeyframe(quint32 timeStamp, UAVObjectManager *objMngr) const
+{
+    int k = m_index.keyframes.size() - 1;
+
+    while (k >= 0 && m_index.keyframes.at(k).timeStamp > timeStamp) {
+        k--;
+    }
+    if (k < 0) {
+        return 0;
+    }
+
+    const ObjectState &state = m_index.keyframes.at(k).state;
+    for (ObjectState::const_iterator i = state.constBegin(); i != state.constEnd(); ++i) {
+        quint32 objId  = i.key() >> 32;
+        quint32 instId = i.key() & 0xFFFFFFFF;
+        UAVObject *obj = objMngr->getObject(objId, instId);
+        if (!obj) {
+            // instance created by the log after the replay position, as UAVTalk would
+            UAVDataObject *dataObj = qobject_cast<UAVDataObject *>(objMngr->getObject(objId));
+            if (!dataObj) {
+                continue;
+            }
+            UAVDataObject *instObj = dataObj->clone(instId);
+            if (!objMngr->registerObject(instObj)) {
+                continue;
+            }
+            obj = instObj;
+        }
+        if ((int)obj->getNumBytes() == i->size()) {
+            obj->unpack((const quint8 *)i->constData());
+        }
+    }
+    return m_index.keyframes.at(k).timeStamp;
+}
+
+LogEventIndex::Index LogEventIndex::buildIndex(const QString &logFileName)
+{
+    Index index;
+
+    UAVObjectManager objMngr;
+
+    UAVObjectsInitialize(&objMngr);
+
+    LogFile logFile;
+    logFile.setFileName(logFileName);
+    if (!logFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "LogEventIndex - unable to open" << logFileName;
+        return index;
+    }
+
+    UAVTalk uavTalk(&logFile, &objMngr);
+    // everything runs in this thread, the records are decoded as soon as they are replayed
+    QObject::connect(&logFile, SIGNAL(readyRead()), &uavTalk, SLOT(processInputStream()), Qt::DirectConnection);
+
+    LogIndexBuilder builder(&logFile, &index);
+    foreach(QList<UAVDataObject *> instances, objMngr.getDataObjects()) {
+        foreach(UAVDataObject * obj, instances) {
+            QObject::connect(obj, &UAVObject::objectUpdated, &builder, &LogIndexBuilder::objectUpdated, Qt::DirectConnection);
+        }
+    }
+    QObject::connect(&objMngr, &UAVObjectManager::newInstance, &builder, &LogIndexBuilder::newInstance, Qt::DirectConnection);
+
+    if (!logFile.replayAll()) {
+        qWarning() << "LogEventIndex -" << logFileName << "is corrupted, indexed up to" << logFile.replayTimeStamp() << "ms";
+    }
+    logFile.close();
+
+    return index;
+}
+
+LogIndexBuilder::LogIndexBuilder(LogFile *logFile, LogEventIndex::Index *index) :
+    QObject(), m_logFile(logFile), m_index(index), m_nextKeyframe(0)
+{}
+
+void LogIndexBuilder::newInstance(UAVObject *obj)
+{
+    if (obj->isMetaDataObject()) {
+        return;
+    }
+    connect(obj, &UAVObject::objectUpdated, this, &LogIndexBuilder::objectUpdated, Qt::DirectConnection);
+    // the new instance was unpacked before being registered
+    objectUpdated(obj);
+}
+
+void LogIndexBuilder::objectUpdated(UAVObject *obj)
+{
+    quint32 objId     = obj->getObjID();
+    quint32 timeStamp = m_logFile->replayTimeStamp();
+    QVector<quint32> &updates = m_index->updates[objId];
+
+    if (updates.isEmpty()) {
+        m_index->objects.insert(obj->getName(), objId);
+    }
+    updates.append(timeStamp);
+
+    // the keyframe holds the state before the first record replayed from its time
+    if (timeStamp >= m_nextKeyframe) {
+        if (!m_state.isEmpty()) {
+            LogEventIndex::Keyframe keyframe;
+            keyframe.timeStamp = timeStamp;
+            keyframe.state     = m_state;
+            m_index->keyframes.append(keyframe);
+        }
+        m_nextKeyframe = timeStamp + LogEventIndex::KEYFRAME_PERIOD_MS;
+    }
+    m_state.insert(((quint64)objId << 32) | obj->getInstID(), obj->packedData());
+
+    if (objId == FlightStatus::OBJID) {
+        flightStatusUpdated(obj);
+    } else if (objId == SystemAlarms::OBJID) {
+        systemAlarmsUpdated(obj);
+    }
+}
+
+void LogIndexBuilder::flightStatusUpdated(UAVObject *obj)
+{
+    QString armed = obj->getField("Armed")->getValue().toString();
+    QString flightMode = obj->getField("FlightMode")->getValue().toString();
+    QStringList &last  = m_lastValues[obj->getObjID()];
+
+    if (last.isEmpty() || last.at(0) != armed) {
+        addEvent(LogEventIndex::ArmingEvent, armed);
+    }
+    if (last.isEmpty() || last.at(1) != flightMode) {
+        addEvent(LogEventIndex::FlightModeEvent, tr("Flight mode %1").arg(flightMode));
+    }
+    last = QStringList() << armed << flightMode;
+}
+
+void LogIndexBuilder::systemAlarmsUpdated(UAVObject *obj)
+{
+    UAVObjectField *field = obj->getField("Alarm");
+    QStringList elementNames = field->getElementNames();
+    QStringList &last = m_lastValues[obj->getObjID()];
+    QStringList values;
+
+    for (quint32 i = 0; i < field->getNumElements(); i++) {
+        QString severity = field->getValue(i).toString();
+        values << severity;
+        if (last.isEmpty()) {
+            // the alarms raised before the log started
+            if (severity == "OK" || severity == "Uninitialised") {
+                continue;
+            }
+        } else if (last.at(i) == severity) {
+            continue;
+        }
+        addEvent(LogEventIndex::AlarmEvent, tr("%1 alarm %2").arg(elementNames.value(i)).arg(severity));
+    }
+    last = values;
+}
+
+void LogIndexBuilder::addEvent(LogEventIndex::EventType type, const QString &description)
+{
+    LogEventIndex::Event event;
+
+    event.timeStamp   = m_logFile->replayTimeStamp();
+    event.type        = type;
+    event.description = description;
+    m_index->events.append(event);
+}
+
+/**
+ * @}
+ * @}
+ */
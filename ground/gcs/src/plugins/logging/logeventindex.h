@@ -0,0 +1,159 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logeventindex.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup LoggingGadgetPlugin Logging Gadget Plugin
+ * @{
+ * @brief      Index of the object updates and flight events of a replayed log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOGEVENTINDEX_H
+#define LOGEVENTINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <QStringList>
+#include <QFutureWatcher>
+
+class UAVObject;
+class UAVObjectManager;
+class LogFile;
+
+/**
+ * Index of a log built once in the background when the replay starts: the
+ * update times of every object and the flight events (arming, flight mode
+ * changes, alarm transitions), so the replay can jump straight to them.
+ * Keyframes, snapshots of all the objects seen so far taken every
+ * KEYFRAME_PERIOD_MS, restore the object state after a jump: settings and
+ * rarely sent objects are not stale until the next time they are logged.
+ * The log is decoded with its own object manager, as fast as it can be read.
+ */
+class LogEventIndex : public QObject {
+    Q_OBJECT
+
+public:
+    enum EventType { ArmingEvent, FlightModeEvent, AlarmEvent };
+
+    typedef struct {
+        quint32   timeStamp;
+        EventType type;
+        QString   description;
+    } Event;
+
+    static const quint32 KEYFRAME_PERIOD_MS = 5000;
+
+    explicit LogEventIndex(QObject *parent = 0);
+    ~LogEventIndex();
+
+    void build(const QString &logFileName);
+    void clear();
+
+    bool isReady() const
+    {
+        return m_ready;
+    }
+
+    QList<Event> events() const
+    {
+        return m_index.events;
+    }
+    // object name to object id, of the objects present in the log
+    QMap<QString, quint32> objects() const
+    {
+        return m_index.objects;
+    }
+    QVector<quint32> updates(quint32 objId) const
+    {
+        return m_index.updates.value(objId);
+    }
+    quint32 firstUpdate(quint32 objId) const;
+    quint32 lastUpdate(quint32 objId) const;
+    // first update of the object strictly after the given time, 0 when none
+    quint32 nextUpdate(quint32 objId, quint32 timeStamp) const;
+
+    // unpack the last keyframe before the given time into the objects,
+    // returns the keyframe time or 0 when there is none, the state being the one at the start of the log
+    quint32 applyKeyframe(quint32 timeStamp, UAVObjectManager *objMngr) const;
+
+signals:
+    void indexReady();
+
+private slots:
+    void indexBuilt();
+
+private:
+    // object data by object id (high 32 bits) and instance id
+    typedef QHash<quint64, QByteArray> ObjectState;
+
+    typedef struct {
+        quint32     timeStamp;
+        ObjectState state;
+    } Keyframe;
+
+    typedef struct {
+        QHash<quint32, QVector<quint32> > updates;
+        QMap<QString, quint32> objects;
+        QList<Event> events;
+        QVector<Keyframe> keyframes;
+    } Index;
+
+    QFutureWatcher<Index> m_watcher;
+    Index m_index;
+    bool m_ready;
+
+    static Index buildIndex(const QString &logFileName);
+
+    friend class LogIndexBuilder;
+};
+
+/**
+ * Collects the index while the log is decoded, used by LogEventIndex only
+ */
+class LogIndexBuilder : public QObject {
+    Q_OBJECT
+
+public:
+    LogIndexBuilder(LogFile *logFile, LogEventIndex::Index *index);
+
+private slots:
+    void objectUpdated(UAVObject *obj);
+    void newInstance(UAVObject *obj);
+
+private:
+    LogFile *m_logFile;
+    LogEventIndex::Index *m_index;
+    QHash<quint32, QStringList> m_lastValues;
+    // the unchanged objects share their data with the previous keyframes
+    LogEventIndex::ObjectState m_state;
+    quint32 m_nextKeyframe;
+
+    void flightStatusUpdated(UAVObject *obj);
+    void systemAlarmsUpdated(UAVObject *obj);
+    void addEvent(LogEventIndex::EventType type, const QString &description);
+};
+
+#endif // LOGEVENTINDEX_H
+
+/**
+ * @}
+ * @}
+ */
@@ -3,7 +3,7 @@ TARGET = LoggingGadget
 
 DEFINES += LOGGING_LIBRARY
 
-QT += svg
+QT += svg concurrent
 
 include(../../plugin.pri)
 include(logging_dependencies.pri)
@@ -12,13 +12,17 @@ HEADERS += \
     loggingplugin.h \
     logginggadgetwidget.h \
     logginggadget.h \
-    logginggadgetfactory.h
+    logginggadgetfactory.h \
+    logeventindex.h \
+    rewindbuffer.h
 
 SOURCES += \
     loggingplugin.cpp \
     logginggadgetwidget.cpp \
     logginggadget.cpp \
-    logginggadgetfactory.cpp
+    logginggadgetfactory.cpp \
+    logeventindex.cpp \
+    rewindbuffer.cpp
 
 OTHER_FILES += LoggingGadget.pluginspec
 
@@ -30,18 +30,23 @@
 #include "ui_logging.h"
 
 #include <loggingplugin.h>
+#include "uavobjectmanager.h"
 
 #include <QWidget>
 #include <QPushButton>
+#include <QComboBox>
 
-LoggingGadgetWidget::LoggingGadgetWidget(QWidget *parent) : QWidget(parent), loggingPlugin(NULL)
+LoggingGadgetWidget::LoggingGadgetWidget(QWidget *parent) : QWidget(parent), loggingPlugin(NULL),
+    scrubDirection(0), scrubPositionValid(false), scrubPosition(0)
 {
     m_logging = new Ui_Logging();
     m_logging->setupUi(this);
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    scpPlugin = pm->getObject<ScopeGadgetFactory>();
+    scpPlugin  = pm->getObject<ScopeGadgetFactory>();
+    objManager = pm->getObject<UAVObjectManager>();
 
+    clearEventLists();
     disableWidgets();
 
     // Configure timer to delay application of slider position action for 200ms
@@ -49,6 +54,9 @@ LoggingGadgetWidget::LoggingGadgetWidget(QWidget *parent) : QWidget(parent), log
     sliderActionDelay.setInterval(200);
 
     connect(&sliderActionDelay, SIGNAL(timeout()), this, SLOT(sliderAction()));
+
+    scrubTimer.setInterval(SCRUB_INTERVAL_MS);
+    connect(&scrubTimer, SIGNAL(timeout()), this, SLOT(scrubTick()));
 }
 
 LoggingGadgetWidget::~LoggingGadgetWidget()
@@ -65,7 +73,12 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin *p)
     connect(m_logging->playButton, &QPushButton::clicked, this, &LoggingGadgetWidget::playButtonAction);
     connect(m_logging->pauseButton, &QPushButton::clicked, this, &LoggingGadgetWidget::pauseButtonAction);
     connect(m_logging->stopButton, &QPushButton::clicked, this, &LoggingGadgetWidget::stopButtonAction);
+    connect(m_logging->stepBackButton, &QToolButton::clicked, this, &LoggingGadgetWidget::stepBackAction);
+    connect(m_logging->stepForwardButton, &QToolButton::clicked, this, &LoggingGadgetWidget::stepForwardAction);
+    connect(m_logging->reverseButton, &QPushButton::clicked, this, &LoggingGadgetWidget::reverseButtonAction);
     connect(m_logging->playbackPosition, &QSlider::valueChanged, this, &LoggingGadgetWidget::sliderMoved);
+    connect(m_logging->eventList, static_cast<void(QComboBox::*) (int)>(&QComboBox::activated), this, &LoggingGadgetWidget::eventSelected);
+    connect(m_logging->objectList, static_cast<void(QComboBox::*) (int)>(&QComboBox::activated), this, &LoggingGadgetWidget::objectSelected);
 
     connect(m_logging->playbackSpeed, static_cast<void(QDoubleSpinBox::*) (double)>(&QDoubleSpinBox::valueChanged), logFile, &LogFile::setReplaySpeed);
 
@@ -73,6 +86,8 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin *p)
     connect(this, &LoggingGadgetWidget::resumeReplay, logFile, &LogFile::resumeReplay);
     connect(this, &LoggingGadgetWidget::pauseReplay, logFile, &LogFile::pauseReplay);
     connect(this, &LoggingGadgetWidget::pauseReplayAndResetPosition, logFile, &LogFile::pauseReplayAndResetPosition);
+    connect(this, &LoggingGadgetWidget::seekReplay, logFile, &LogFile::seekReplay);
+    connect(this, &LoggingGadgetWidget::replayUntil, logFile, &LogFile::replayUntil);
 
     // gadgetwidget functions to scope actions
     connect(this, &LoggingGadgetWidget::resumeReplay, scpPlugin, &ScopeGadgetFactory::startPlotting);
@@ -86,19 +101,29 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin *p)
     connect(logFile, &LogFile::replayStarted, this, &LoggingGadgetWidget::enableWidgets);
     connect(logFile, &LogFile::replayFinished, this, &LoggingGadgetWidget::disableWidgets);
     connect(logFile, &LogFile::replayCompleted, this, &LoggingGadgetWidget::stopButtonAction);
+    connect(loggingPlugin->getEventIndex(), &LogEventIndex::indexReady, this, &LoggingGadgetWidget::eventIndexReady);
 
     // Feedback from logfile to scope
     connect(logFile, &LogFile::replayFinished, scpPlugin, &ScopeGadgetFactory::stopPlotting);
 
     // Perform actions as if the plugin state has been changed
     stateChanged(loggingPlugin->getState());
+    if (loggingPlugin->getEventIndex()->isReady()) {
+        eventIndexReady();
+    }
 }
 
 void LoggingGadgetWidget::playButtonAction()
 {
     ReplayState replayState = loggingPlugin->getLogfile()->getReplayState();
 
-    if (replayState != PLAYING) {
+    stopScrub();
+    if (m_logging->playbackSpeed->value() > MAX_PACED_SPEED) {
+        if (replayState == PLAYING) {
+            emit pauseReplay();
+        }
+        startScrub(1);
+    } else if (replayState != PLAYING) {
         emit resumeReplay(m_logging->playbackPosition->value());
     }
 
@@ -111,6 +136,7 @@ void LoggingGadgetWidget::pauseButtonAction()
 {
     ReplayState replayState = loggingPlugin->getLogfile()->getReplayState();
 
+    stopScrub();
     if (replayState == PLAYING) {
         emit pauseReplay();
     }
@@ -124,6 +150,8 @@ void LoggingGadgetWidget::pauseButtonAction()
 
 void LoggingGadgetWidget::stopButtonAction()
 {
+    stopScrub();
+    scrubPositionValid = false;
     emit pauseReplayAndResetPosition();
 
     m_logging->playButton->setVisible(true);
@@ -232,6 +260,13 @@ void LoggingGadgetWidget::enableWidgets()
         break;
     }
     m_logging->playbackPosition->setEnabled(true);
+    m_logging->stepBackButton->setEnabled(true);
+    m_logging->stepForwardButton->setEnabled(true);
+    m_logging->reverseButton->setEnabled(true);
+    // the lists are filled again when the index of a new log is ready
+    bool indexed = loggingPlugin->getEventIndex()->isReady();
+    m_logging->eventList->setEnabled(indexed && m_logging->eventList->count() > 1);
+    m_logging->objectList->setEnabled(indexed && m_logging->objectList->count() > 1);
 }
 
 void LoggingGadgetWidget::disableWidgets()
@@ -244,6 +279,12 @@ void LoggingGadgetWidget::disableWidgets()
     m_logging->stopButton->setEnabled(false);
 
     m_logging->playbackPosition->setEnabled(false);
+    stopScrub();
+    m_logging->stepBackButton->setEnabled(false);
+    m_logging->stepForwardButton->setEnabled(false);
+    m_logging->reverseButton->setEnabled(false);
+    m_logging->eventList->setEnabled(false);
+    m_logging->objectList->setEnabled(false);
 
     // reset start and end labels
     m_logging->startTimeLabel->setText("");
@@ -262,6 +303,8 @@ void LoggingGadgetWidget::updatePositionLabel(quint32 positionTimeStamp)
 void LoggingGadgetWidget::sliderMoved(int position)
 {
     // pause playback while the user is dragging the slider to change position
+    stopScrub();
+    scrubPositionValid = false;
     emit pauseReplay();
 
     updatePositionLabel(position);
@@ -272,9 +315,198 @@ void LoggingGadgetWidget::sliderMoved(int position)
 
 void LoggingGadgetWidget::sliderAction()
 {
+    restoreObjects(m_logging->playbackPosition->value());
     emit resumeReplay(m_logging->playbackPosition->value());
 }
 
+/**
+ * The log index is built, fill the event and object lists
+ */
+void LoggingGadgetWidget::eventIndexReady()
+{
+    LogEventIndex *index = loggingPlugin->getEventIndex();
+
+    clearEventLists();
+    foreach(const LogEventIndex::Event &event, index->events()) {
+        int sec = (event.timeStamp / 1000) % 60;
+        int min = event.timeStamp / (60 * 1000);
+        m_logging->eventList->addItem(QString("%1:%2 %3").arg(min, 2, 10, QChar('0')).arg(sec, 2, 10, QChar('0')).arg(event.description),
+                                      event.timeStamp);
+    }
+    QMap<QString, quint32> objects = index->objects();
+    for (QMap<QString, quint32>::const_iterator i = objects.constBegin(); i != objects.constEnd(); ++i) {
+        m_logging->objectList->addItem(i.key(), i.value());
+    }
+
+    bool enabled = m_logging->playbackPosition->isEnabled();
+    m_logging->eventList->setEnabled(enabled && m_logging->eventList->count() > 1);
+    m_logging->objectList->setEnabled(enabled && m_logging->objectList->count() > 1);
+}
+
+void LoggingGadgetWidget::eventSelected(int index)
+{
+    if (index > 0) {
+        jumpTo(m_logging->eventList->itemData(index).toUInt());
+    }
+    m_logging->eventList->setCurrentIndex(0);
+}
+
+void LoggingGadgetWidget::objectSelected(int index)
+{
+    if (index > 0) {
+        quint32 objId = m_logging->objectList->itemData(index).toUInt();
+        LogEventIndex *eventIndex = loggingPlugin->getEventIndex();
+        quint32 timeStamp = eventIndex->nextUpdate(objId, m_logging->playbackPosition->value());
+        // wrap around to the first update once past the last one
+        jumpTo(timeStamp ? timeStamp : eventIndex->firstUpdate(objId));
+    }
+    m_logging->objectList->setCurrentIndex(0);
+}
+
+void LoggingGadgetWidget::clearEventLists()
+{
+    // the first item is a placeholder, so that any event can be activated
+    m_logging->eventList->clear();
+    m_logging->eventList->addItem(tr("Event..."));
+    m_logging->eventList->setEnabled(false);
+    m_logging->objectList->clear();
+    m_logging->objectList->addItem(tr("Object..."));
+    m_logging->objectList->setEnabled(false);
+}
+
+/**
+ * Move the replay to a position, the replay resumes there if it was playing
+ */
+void LoggingGadgetWidget::jumpTo(quint32 timeStamp)
+{
+    m_logging->playbackPosition->blockSignals(true);
+    m_logging->playbackPosition->setValue(timeStamp);
+    m_logging->playbackPosition->blockSignals(false);
+    updatePositionLabel(timeStamp);
+    scrubPositionValid = false;
+
+    bool playing = loggingPlugin->getLogfile()->getReplayState() == PLAYING;
+    if (playing) {
+        emit pauseReplay();
+    }
+    restoreObjects(timeStamp);
+    if (playing) {
+        emit resumeReplay(timeStamp);
+    }
+}
+
+/**
+ * Bring all the objects to their state at a replay position at once,
+ * from the keyframes of the log index
+ */
+void LoggingGadgetWidget::restoreObjects(quint32 timeStamp)
+{
+    LogEventIndex *index = loggingPlugin->getEventIndex();
+
+    if (objManager && index->isReady()) {
+        index->applyKeyframe(timeStamp, objManager);
+    }
+}
+
+void LoggingGadgetWidget::stepBackAction()
+{
+    quint32 position = m_logging->playbackPosition->value();
+
+    pauseButtonAction();
+    scrubTo(position > (quint32)m_logging->playbackPosition->minimum() + STEP_MS ?
+            position - STEP_MS : m_logging->playbackPosition->minimum());
+}
+
+void LoggingGadgetWidget::stepForwardAction()
+{
+    quint32 position = m_logging->playbackPosition->value();
+
+    pauseButtonAction();
+    scrubTo(qMin(position + STEP_MS, (quint32)m_logging->playbackPosition->maximum()));
+}
+
+void LoggingGadgetWidget::reverseButtonAction(bool checked)
+{
+    if (!checked) {
+        pauseButtonAction();
+        return;
+    }
+    if (loggingPlugin->getLogfile()->getReplayState() == PLAYING) {
+        emit pauseReplay();
+    }
+    startScrub(-1);
+
+    m_logging->playButton->setVisible(false);
+    m_logging->pauseButton->setVisible(true);
+    m_logging->stopButton->setEnabled(true);
+
+    m_logging->statusLabel->setText(tr("Reversing"));
+}
+
+void LoggingGadgetWidget::startScrub(int direction)
+{
+    scrubDirection = direction;
+    m_logging->reverseButton->setChecked(direction < 0);
+    scrubTimer.start();
+}
+
+void LoggingGadgetWidget::stopScrub()
+{
+    scrubTimer.stop();
+    scrubDirection = 0;
+    m_logging->reverseButton->setChecked(false);
+}
+
+/**
+ * One scrubbing step, its length follows the replay speed
+ */
+void LoggingGadgetWidget::scrubTick()
+{
+    qint64 position = scrubPositionValid ? scrubPosition : m_logging->playbackPosition->value();
+    qint64 target   = position + (qint64)(scrubDirection * SCRUB_INTERVAL_MS * m_logging->playbackSpeed->value());
+    qint64 minimum  = m_logging->playbackPosition->minimum();
+    qint64 maximum  = m_logging->playbackPosition->maximum();
+    bool atEnd      = false;
+
+    if (target <= minimum || target >= maximum) {
+        target = qBound(minimum, target, maximum);
+        atEnd  = true;
+    }
+    scrubTo(target);
+    if (atEnd) {
+        pauseButtonAction();
+    }
+}
+
+/**
+ * Move the paused replay to a position with the objects in their state at that time:
+ * the records since the current position are replayed when it is close ahead,
+ * else those since the last keyframe, once the keyframe is restored.
+ */
+void LoggingGadgetWidget::scrubTo(quint32 timeStamp)
+{
+    LogEventIndex *index = loggingPlugin->getEventIndex();
+
+    if (scrubPositionValid && timeStamp >= scrubPosition && timeStamp - scrubPosition <= LogEventIndex::KEYFRAME_PERIOD_MS) {
+        emit replayUntil(timeStamp);
+    } else {
+        // without index nothing is replayed, the objects catch up as the replay goes on
+        quint32 from = timeStamp;
+        if (objManager && index->isReady()) {
+            from = index->applyKeyframe(timeStamp, objManager);
+        }
+        emit seekReplay(from);
+        emit replayUntil(timeStamp);
+    }
+    scrubPosition      = timeStamp;
+    scrubPositionValid = true;
+
+    m_logging->playbackPosition->blockSignals(true);
+    m_logging->playbackPosition->setValue(timeStamp);
+    m_logging->playbackPosition->blockSignals(false);
+    updatePositionLabel(timeStamp);
+}
+
 
 /**
  * @}
@@ -38,6 +38,7 @@
 #include <QWidget>
 
 class Ui_Logging;
+class UAVObjectManager;
 class QTimer;
 
 class LoggingGadgetWidget : public QWidget {
@@ -59,19 +60,45 @@ protected slots:
     void disableWidgets();
     void sliderMoved(int);
     void sliderAction();
+    void eventIndexReady();
+    void stepBackAction();
+    void stepForwardAction();
+    void reverseButtonAction(bool checked);
+    void scrubTick();
+    void eventSelected(int index);
+    void objectSelected(int index);
 
 signals:
     void resumeReplay(quint32 positionTimeStamp);
     void pauseReplay();
     void pauseReplayAndResetPosition();
+    void seekReplay(quint32 positionTimeStamp);
+    void replayUntil(quint32 positionTimeStamp);
 
 private:
+    // scrubbing moves the paused replay by steps, at most 10 times a second whatever the speed
+    static const int SCRUB_INTERVAL_MS = 100;
+    static const int STEP_MS = 100;
+    // above this speed the forward replay scrubs, the gadgets get the state of each step only
+    static const int MAX_PACED_SPEED = 10;
+
     Ui_Logging *m_logging;
     LoggingPlugin *loggingPlugin;
     ScopeGadgetFactory *scpPlugin;
+    UAVObjectManager *objManager;
     QTimer sliderActionDelay;
+    QTimer scrubTimer;
+    int scrubDirection;
+    bool scrubPositionValid;
+    quint32 scrubPosition;
 
     void updatePositionLabel(quint32 positionTimeStamp);
+    void clearEventLists();
+    void jumpTo(quint32 timeStamp);
+    void restoreObjects(quint32 timeStamp);
+    void startScrub(int direction);
+    void stopScrub();
+    void scrubTo(quint32 timeStamp);
 };
 
 #endif /* LoggingGADGETWIDGET_H_ */
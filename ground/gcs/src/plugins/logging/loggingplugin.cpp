@@ -31,12 +31,16 @@
 #include "loggingplugin.h"
 
 #include "gcstelemetrystats.h"
+#include "rewindbuffer.h"
 
 #include "logginggadgetfactory.h"
 #include "uavobjectmanager.h"
 #include <uavtalk/uavtalk.h>
+#include <uavtalk/telemetrymanager.h>
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/actionmanager/actionmanager.h>
+#include <coreplugin/connectionmanager.h>
+#include <coreplugin/threadmanager.h>
 
 #include <QApplication>
 #include <QDebug>
@@ -44,10 +48,13 @@
 #include <QThread>
 #include <QStringList>
 #include <QDir>
+#include <QFile>
+#include <QSettings>
 #include <QFileDialog>
 #include <QList>
 #include <QErrorMessage>
-#include <QWriteLocker>
+#include <QMutexLocker>
+#include <QTimer>
 #include <QKeySequence>
 
 LoggingConnection::LoggingConnection() :
@@ -75,7 +82,11 @@ QIODevice *LoggingConnection::openDevice(const QString &deviceName)
 {
     closeDevice(deviceName);
 
-    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("OpenPilot Log (*.opl)"));
+    QString fileName = m_replayFile;
+    m_replayFile.clear();
+    if (fileName.isEmpty()) {
+        fileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("OpenPilot Log (*.opl *.oplx)"));
+    }
     if (!fileName.isNull()) {
         logFile.setFileName(fileName);
         if (logFile.open(QIODevice::ReadOnly)) {
@@ -85,6 +96,8 @@ QIODevice *LoggingConnection::openDevice(const QString &deviceName)
             Qt::ConnectionType ct = (QApplication::instance()->thread() == logFile.thread()) ? Qt::DirectConnection : Qt::BlockingQueuedConnection;
             QMetaObject::invokeMethod(&logFile, "startReplay", ct);
             m_deviceOpened = true;
+            // indexed while replaying, for the jumps to the flight events
+            eventIndex.build(fileName);
         }
         return &logFile;
     }
@@ -104,6 +117,7 @@ void LoggingConnection::closeDevice(const QString &deviceName)
         Qt::ConnectionType ct = (QApplication::instance()->thread() == logFile.thread()) ? Qt::DirectConnection : Qt::BlockingQueuedConnection;
         QMetaObject::invokeMethod(&logFile, "stopReplay", ct);
         logFile.close();
+        eventIndex.clear();
     }
 }
 
@@ -117,14 +131,15 @@ QString LoggingConnection::shortName()
     return QString("Logfile");
 }
 
-LoggingThread::LoggingThread() : QThread(), uavTalk(0)
-{}
-
-LoggingThread::~LoggingThread()
+LoggingThread::LoggingThread() : QThread(), telemetryManager(0), startTime(0)
 {
-    delete uavTalk;
+    buffer.reserve(BUFFER_SIZE);
+    writeBuffer.reserve(BUFFER_SIZE);
 }
 
+LoggingThread::~LoggingThread()
+{}
+
 /**
  * Sets the file to use for logging and takes the parent plugin
  * to connect to stop logging signal
@@ -135,29 +150,65 @@ bool LoggingThread::openFile(QString file)
 {
     logFile.setFileName(file);
     logFile.open(QIODevice::WriteOnly);
+    // the packets are timestamped when received or sent, not when written
+    logFile.useProvidedTimeStamp(true);
+    startTime = LatencyHistogram::timestamp();
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-
-    uavTalk = new UAVTalk(&logFile, objManager);
+    telemetryManager = pm->getObject<TelemetryManager>();
 
-    return true;
+    return telemetryManager != NULL;
 };
 
 /**
- * Logs an object update to the file.  Data format is the
+ * Called by the telemetry UAVTalk for each object packet, from the telemetry thread.
+ * The packet is only appended to the buffer, it is written to the file by the logging thread.
+ */
+void LoggingThread::frame(qint64 timestamp, const quint8 *packet, int length)
+{
+    // the device arrival time can be slightly older than the start of the log
+    quint32 timeStamp = (quint32)(qMax(timestamp - startTime, (qint64)0) / 1000);
+    quint16 size = (quint16)length;
+
+    QMutexLocker locker(&bufferMutex);
+
+    buffer.append((const char *)&timeStamp, sizeof(timeStamp));
+    buffer.append((const char *)&size, sizeof(size));
+    buffer.append((const char *)packet, length);
+}
+
+/**
+ * Writes the buffered packets to the file. Data format is the
  * timestamp as a 32 bit uint counting ms from start of
  * file writing (flight time will be embedded in stream),
- * then object packet size, then the packed UAVObject.
+ * then object packet size, then the UAVTalk packet.
  */
-void LoggingThread::objectUpdated(UAVObject *obj)
+void LoggingThread::flushBuffer()
 {
-    QWriteLocker locker(&lock);
+    {
+        QMutexLocker locker(&bufferMutex);
+        if (buffer.isEmpty()) {
+            return;
+        }
+        // both buffers keep their capacity
+        buffer.swap(writeBuffer);
+    }
 
-    if (!uavTalk->sendObject(obj, false, false)) {
-        qDebug() << "LoggingThread - error logging" << obj->getName();
+    const char *record = writeBuffer.constData();
+    const char *end    = record + writeBuffer.size();
+    while (record < end) {
+        quint32 timeStamp;
+        quint16 size;
+        memcpy(&timeStamp, record, sizeof(timeStamp));
+        record += sizeof(timeStamp);
+        memcpy(&size, record, sizeof(size));
+        record += sizeof(size);
+        logFile.setNextTimeStamp(timeStamp);
+        logFile.write(record, size);
+        record += size;
     }
-};
+    writeBuffer.resize(0);
+}
 
 
 void LoggingThread::run()
@@ -166,7 +217,7 @@ void LoggingThread::run()
 }
 
 /**
- * Connect signals from all the objects updates to the write routine then
+ * Tap the telemetry packets, periodically write them to the file then
  * run event loop
  */
 void LoggingThread::startLogging()
@@ -176,18 +227,13 @@ void LoggingThread::startLogging()
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
-    QList< QList<UAVObject *> > list;
-    list = objManager->getObjects();
-    QList< QList<UAVObject *> >::const_iterator i;
-    QList<UAVObject *>::const_iterator j;
-    int objects = 0;
+    // the timer lives in the logging thread, the buffer is written from there
+    QTimer flushTimer;
+    flushTimer.setInterval(FLUSH_PERIOD_MS);
+    connect(&flushTimer, &QTimer::timeout, this, &LoggingThread::flushBuffer, Qt::DirectConnection);
+    flushTimer.start();
 
-    for (i = list.constBegin(); i != list.constEnd(); ++i) {
-        for (j = (*i).constBegin(); j != (*i).constEnd(); ++j) {
-            connect(*j, &UAVObject::objectUpdated, this, &LoggingThread::objectUpdated);
-            objects++;
-        }
-    }
+    telemetryManager->addFrameTap(this);
 
     GCSTelemetryStats *gcsStatsObj = GCSTelemetryStats::GetInstance(objManager);
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
@@ -202,36 +248,23 @@ void LoggingThread::startLogging()
 }
 
 /**
- * Disconnect signals from all the objects, close the log file and stop
- * the event loop
+ * Stop tapping the telemetry packets and the event loop,
+ * then write the remaining packets and close the log file
  */
 void LoggingThread::stopLogging()
 {
-    QWriteLocker locker(&lock);
-
     qDebug() << "LoggingThread - stop logging";
 
-    // Disconnect all objects we registered with:
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-
-    QList< QList<UAVObject *> > list;
-    list = objManager->getObjects();
-    QList< QList<UAVObject *> >::const_iterator i;
-    QList<UAVObject *>::const_iterator j;
-
-    for (i = list.constBegin(); i != list.constEnd(); ++i) {
-        for (j = (*i).constBegin(); j != (*i).constEnd(); ++j) {
-            disconnect(*j, &UAVObject::objectUpdated, this, &LoggingThread::objectUpdated);
-        }
-    }
-
-    logFile.close();
+    // no packet is tapped anymore once this returns
+    telemetryManager->removeFrameTap(this);
 
     quit();
 
     // wait for thread to finish
     wait();
+
+    flushBuffer();
+    logFile.close();
 }
 
 /**
@@ -299,9 +332,13 @@ void LoggingThread::transactionCompleted(UAVObject *obj, bool success)
 
 LoggingPlugin::LoggingPlugin() :
     loggingCommand(NULL),
+    saveRewindCommand(NULL),
+    replayRewindCommand(NULL),
     state(IDLE),
     loggingThread(NULL),
-    logConnection(new LoggingConnection())
+    logConnection(new LoggingConnection()),
+    rewindBuffer(NULL),
+    telemetryManager(NULL)
 {}
 
 LoggingPlugin::~LoggingPlugin()
@@ -335,6 +372,23 @@ bool LoggingPlugin::initialize(const QStringList & args, QString *errMsg)
 
     connect(loggingCommand->action(), &QAction::triggered, this, &LoggingPlugin::toggleLogging);
 
+    // Commands to save or replay the last minutes of the session
+    saveRewindCommand = am->registerAction(new QAction(this),
+                                           "LoggingPlugin.SaveRewind",
+                                           QList<int>() <<
+                                           Core::Constants::C_GLOBAL_ID);
+    ac->addAction(saveRewindCommand, "Logging");
+    connect(saveRewindCommand->action(), &QAction::triggered, this, &LoggingPlugin::saveRewind);
+
+    replayRewindCommand = am->registerAction(new QAction(this),
+                                             "LoggingPlugin.ReplayRewind",
+                                             QList<int>() <<
+                                             Core::Constants::C_GLOBAL_ID);
+    ac->addAction(replayRewindCommand, "Logging");
+    connect(replayRewindCommand->action(), &QAction::triggered, this, &LoggingPlugin::replayRewind);
+
+    connect(ac->menu(), &QMenu::aboutToShow, this, &LoggingPlugin::updateRewindCommands);
+
     LoggingGadgetFactory *mf = new LoggingGadgetFactory(this);
     addAutoReleasedObject(mf);
 
@@ -342,6 +396,9 @@ bool LoggingPlugin::initialize(const QStringList & args, QString *errMsg)
     connect(getLogfile(), &LogFile::replayFinished, this, &LoggingPlugin::replayStopped);
     connect(getLogfile(), &LogFile::replayStarted, this, &LoggingPlugin::replayStarted);
 
+    // The scopes follow the replay clock
+    addObject(getLogfile());
+
     // update state and command
     loggingStopped();
 
@@ -357,7 +414,7 @@ void LoggingPlugin::toggleLogging()
     if (state == IDLE) {
         QString fileName = QFileDialog::getSaveFileName(NULL, tr("Start Log"),
                                                         tr("OP-%0.opl").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss")),
-                                                        tr("OpenPilot Log (*.opl)"));
+                                                        tr("OpenPilot Log (*.opl);;Indexed OpenPilot Log (*.oplx)"));
         if (fileName.isEmpty()) {
             return;
         }
@@ -380,6 +437,7 @@ void LoggingPlugin::startLogging(QString file)
     loggingThread = new LoggingThread();
     if (loggingThread->openFile(file)) {
         connect(loggingThread, &LoggingThread::finished, this, &LoggingPlugin::loggingStopped);
+        Core::ThreadManager::instance()->manageThread(loggingThread, Core::ThreadManager::LoggingRole);
         loggingThread->start();
         loggingStarted();
     } else {
@@ -437,6 +495,9 @@ void LoggingPlugin::replayStarted()
         stopLogging();
     }
     loggingCommand->action()->setEnabled(false);
+    if (rewindBuffer) {
+        rewindBuffer->setPaused(true);
+    }
     state = REPLAY;
     emit stateChanged(state);
 }
@@ -447,20 +508,111 @@ void LoggingPlugin::replayStarted()
 void LoggingPlugin::replayStopped()
 {
     loggingCommand->action()->setEnabled(true);
+    if (rewindBuffer) {
+        rewindBuffer->setPaused(false);
+    }
     if (state == REPLAY) {
         state = IDLE;
         emit stateChanged(state);
     }
 }
 
+/**
+ * Save the last minutes of the session to a log file
+ */
+void LoggingPlugin::saveRewind()
+{
+    if (!rewindBuffer) {
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(NULL, tr("Save Rewind"),
+                                                    tr("OP-%0-rewind.opl").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss")),
+                                                    tr("OpenPilot Log (*.opl)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    if (!rewindBuffer->save(fileName)) {
+        QErrorMessage err;
+        err.showMessage(tr("Unable to save the rewind buffer"));
+        err.exec();
+    }
+}
+
+/**
+ * Replay the last minutes of the session through the log replay connection,
+ * the live connection is closed
+ */
+void LoggingPlugin::replayRewind()
+{
+    if (!rewindBuffer || state == REPLAY) {
+        return;
+    }
+
+    if (!rewindReplayFile.isEmpty()) {
+        QFile::remove(rewindReplayFile);
+    }
+    rewindReplayFile = QDir::temp().filePath(QString("OP-%0-rewind.opl").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss")));
+    if (!rewindBuffer->save(rewindReplayFile)) {
+        QErrorMessage err;
+        err.showMessage(tr("The rewind buffer is empty"));
+        err.exec();
+        return;
+    }
+
+    Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
+    cm->disconnectDevice();
+    logConnection->setReplayFile(rewindReplayFile);
+    foreach(Core::IConnection::device device, logConnection->availableDevices()) {
+        cm->connectDevice(Core::DevListItem(logConnection, device));
+    }
+    logConnection->setReplayFile(QString());
+}
+
+void LoggingPlugin::updateRewindCommands()
+{
+    int seconds = rewindBuffer ? rewindBuffer->seconds() : 0;
+
+    saveRewindCommand->action()->setText(tr("Save Last %0 min %1 s of Telemetry...").arg(seconds / 60).arg(seconds % 60));
+    saveRewindCommand->action()->setEnabled(seconds > 0);
+    replayRewindCommand->action()->setText(tr("Replay Last %0 min %1 s of Telemetry").arg(seconds / 60).arg(seconds % 60));
+    replayRewindCommand->action()->setEnabled(seconds > 0 && state != REPLAY);
+}
+
 void LoggingPlugin::extensionsInitialized()
 {
     addAutoReleasedObject(logConnection);
+
+    QSettings settings;
+    settings.beginGroup("RewindBuffer");
+    bool enabled = settings.value("Enabled", true).toBool();
+    int sizeMB   = settings.value("SizeMB", 16).toInt();
+    int minutes  = settings.value("Minutes", 10).toInt();
+    settings.endGroup();
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    telemetryManager = pm->getObject<TelemetryManager>();
+    if (enabled && telemetryManager) {
+        rewindBuffer = new RewindBuffer(sizeMB, minutes);
+        telemetryManager->addFrameTap(rewindBuffer);
+    }
+    updateRewindCommands();
 }
 
 void LoggingPlugin::shutdown()
 {
-    // Do nothing
+    removeObject(getLogfile());
+
+    if (rewindBuffer) {
+        // no packet is tapped anymore once this returns
+        telemetryManager->removeFrameTap(rewindBuffer);
+        delete rewindBuffer;
+        rewindBuffer = NULL;
+    }
+    if (!rewindReplayFile.isEmpty()) {
+        QFile::remove(rewindReplayFile);
+    }
 }
 
 /**
@@ -33,16 +33,20 @@
 #include <coreplugin/iconnection.h>
 #include <extensionsystem/iplugin.h>
 #include <utils/logfile.h>
+#include <uavtalk/uavtalk.h>
+
+#include "logeventindex.h"
 
 #include <QThread>
 #include <QQueue>
-#include <QReadWriteLock>
+#include <QMutex>
 
 class UAVObject;
 class UAVDataObject;
-class UAVTalk;
+class TelemetryManager;
 class LoggingPlugin;
 class LoggingGadgetFactory;
+class RewindBuffer;
 
 namespace Core {
 class Command;
@@ -75,13 +79,29 @@ public:
     {
         return &logFile;
     }
+    LogEventIndex *getEventIndex()
+    {
+        return &eventIndex;
+    }
+    // replayed by the next openDevice() instead of asking for a file
+    void setReplayFile(const QString &fileName)
+    {
+        m_replayFile = fileName;
+    }
 
 private:
     bool m_deviceOpened;
+    QString m_replayFile;
     LogFile logFile;
+    LogEventIndex eventIndex;
 };
 
-class LoggingThread : public QThread {
+/**
+ *   Logs the object packets as received from and sent to the flight side,
+ *   they are tapped from the telemetry UAVTalk instance, buffered and written
+ *   to the log file by the logging thread.
+ */
+class LoggingThread : public QThread, public UAVTalk::FrameTap {
     Q_OBJECT
 public:
     LoggingThread();
@@ -89,6 +109,8 @@ public:
 
     bool openFile(QString file);
 
+    void frame(qint64 timestamp, const quint8 *packet, int length);
+
 public slots:
     void startLogging();
     void stopLogging();
@@ -97,14 +119,21 @@ protected:
     void run();
 
 private slots:
-    void objectUpdated(UAVObject *obj);
     void transactionCompleted(UAVObject *obj, bool success);
+    void flushBuffer();
 
 private:
-    QReadWriteLock lock;
+    // records (timestamp, packet length, packet) waiting to be written, swapped with the write buffer
+    static const int BUFFER_SIZE     = 256 * 1024;
+    static const int FLUSH_PERIOD_MS = 100;
+
     QQueue<UAVDataObject *> queue;
     LogFile logFile;
-    UAVTalk *uavTalk;
+    TelemetryManager *telemetryManager;
+    qint64 startTime;
+    QMutex bufferMutex;
+    QByteArray buffer;
+    QByteArray writeBuffer;
 
     void retrieveSettings();
     void retrieveNextObject();
@@ -130,6 +159,10 @@ public:
     {
         return logConnection->getLogfile();
     }
+    LogEventIndex *getEventIndex()
+    {
+        return logConnection->getEventIndex();
+    }
 
     State getState()
     {
@@ -147,13 +180,22 @@ private slots:
     void loggingStopped();
     void replayStarted();
     void replayStopped();
+    void saveRewind();
+    void replayRewind();
+    void updateRewindCommands();
 
 private:
     Core::Command *loggingCommand;
+    Core::Command *saveRewindCommand;
+    Core::Command *replayRewindCommand;
     State state;
     // These are used for replay, logging in its own thread
     LoggingThread *loggingThread;
     LoggingConnection *logConnection;
+    // the last minutes of the session, always tapped
+    RewindBuffer *rewindBuffer;
+    TelemetryManager *telemetryManager;
+    QString rewindReplayFile;
 };
 #endif /* LoggingPLUGIN_H_ */
 /**
@@ -0,0 +1,203 @@
+/**
+ ******************************************************************************
+ *
+ * @file       rewindbuffer.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Logging
+ * @{
+ * @brief      Keeps the last minutes of telemetry in memory
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "rewindbuffer.h"
+
+#include <uavtalk/latencyhistogram.h>
+#include <utils/logfile.h>
+
+#include <QDebug>
+
+RewindBuffer::RewindBuffer(int capacityMB, int minutes) :
+    m_capacity(1024 * 1024), m_window(qMax(minutes, 1) * 60 * 1000),
+    m_startTime(LatencyHistogram::timestamp()), m_head(0), m_tail(0), m_lastTimeStamp(0), m_paused(0)
+{
+    quint32 requested = (quint32)qBound(1, capacityMB, 1024) * 1024 * 1024;
+
+    // rounded down to a power of 2, well within what the free running positions can address
+    while (m_capacity * 2 <= requested) {
+        m_capacity *= 2;
+    }
+    // allocated once, the pages are only touched as the ring fills
+    m_ring = new char[m_capacity];
+}
+
+RewindBuffer::~RewindBuffer()
+{
+    delete[] m_ring;
+}
+
+void RewindBuffer::setPaused(bool paused)
+{
+    m_paused.storeRelease(paused ? 1 : 0);
+}
+
+void RewindBuffer::read(quint32 position, void *data, quint32 size) const
+{
+    quint32 offset = position & (m_capacity - 1);
+    quint32 first  = qMin(size, m_capacity - offset);
+
+    memcpy(data, m_ring + offset, first);
+    memcpy((char *)data + first, m_ring, size - first);
+}
+
+void RewindBuffer::write(quint32 position, const void *data, quint32 size)
+{
+    quint32 offset = position & (m_capacity - 1);
+    quint32 first  = qMin(size, m_capacity - offset);
+
+    memcpy(m_ring + offset, data, first);
+    memcpy(m_ring, (const char *)data + first, size - first);
+}
+
+/**
+ * Called by the telemetry UAVTalk for each object packet, from the telemetry thread.
+ * Appends the packet to the ring, dropping the oldest records when full.
+ */
+void RewindBuffer::frame(qint64 timestamp, const quint8 *packet, int length)
+{
+    if (m_paused.loadAcquire()) {
+        return;
+    }
+
+    // only written here
+    quint32 head = m_head.load();
+    quint32 tail = m_tail.load();
+    quint32 size = RECORD_HEADER + length;
+
+    if (head - tail + size > m_capacity) {
+        while (head - tail + size > m_capacity) {
+            quint16 oldLength;
+            read(tail + sizeof(quint32), &oldLength, sizeof(oldLength));
+            tail += RECORD_HEADER + oldLength;
+        }
+        // ordered, the dropped records must be seen as gone before they are overwritten
+        m_tail.fetchAndStoreOrdered(tail);
+    }
+
+    quint32 timeStamp = (quint32)(qMax(timestamp - m_startTime, (qint64)0) / 1000);
+    quint16 packetLength = (quint16)length;
+    write(head, &timeStamp, sizeof(timeStamp));
+    write(head + sizeof(timeStamp), &packetLength, sizeof(packetLength));
+    write(head + RECORD_HEADER, packet, length);
+
+    m_lastTimeStamp.storeRelease(timeStamp);
+    m_head.storeRelease(head + size);
+}
+
+int RewindBuffer::bytesUsed() const
+{
+    return m_head.loadAcquire() - m_tail.loadAcquire();
+}
+
+int RewindBuffer::seconds() const
+{
+    quint32 head = m_head.loadAcquire();
+    quint32 tail = m_tail.loadAcquire();
+
+    if (head == tail) {
+        return 0;
+    }
+    // the oldest record can be overwritten while read, the result is only indicative
+    quint32 oldest;
+    read(tail, &oldest, sizeof(oldest));
+    return qMin(m_lastTimeStamp.loadAcquire() - oldest, m_window) / 1000;
+}
+
+/**
+ * Copies the valid records out of the ring, oldest first.
+ * Records overwritten during the copy are behind the tail read after it and are discarded.
+ */
+QByteArray RewindBuffer::snapshot() const
+{
+    for (int attempt = 0; attempt < 3; attempt++) {
+        quint32 head = m_head.loadAcquire();
+        quint32 tail = m_tail.loadAcquire();
+        QByteArray records(head - tail, Qt::Uninitialized);
+        read(tail, records.data(), records.size());
+
+        // ordered, the copy must be complete before the tail is read again
+        quint32 overwritten = m_tail.fetchAndAddOrdered(0) - tail;
+        if (overwritten <= (quint32)records.size()) {
+            return records.mid(overwritten);
+        }
+        // lapped by the telemetry thread
+    }
+    return QByteArray();
+}
+
+/**
+ * Writes the records of the last minutes to a log file, in the LoggingThread format
+ */
+bool RewindBuffer::save(const QString &fileName) const
+{
+    QByteArray records = snapshot();
+
+    if (records.isEmpty()) {
+        return false;
+    }
+
+    LogFile logFile;
+    logFile.setFileName(fileName);
+    if (!logFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "RewindBuffer - unable to open" << fileName;
+        return false;
+    }
+    logFile.useProvidedTimeStamp(true);
+
+    quint32 now    = (quint32)((LatencyHistogram::timestamp() - m_startTime) / 1000);
+    quint32 oldest = now > m_window ? now - m_window : 0;
+    bool first     = true;
+    quint32 firstTimeStamp = 0;
+
+    const char *record = records.constData();
+    const char *end    = record + records.size();
+    while (record < end) {
+        quint32 timeStamp;
+        quint16 size;
+        memcpy(&timeStamp, record, sizeof(timeStamp));
+        memcpy(&size, record + sizeof(timeStamp), sizeof(size));
+        record += RECORD_HEADER;
+        if (timeStamp >= oldest) {
+            if (first) {
+                firstTimeStamp = timeStamp;
+                first = false;
+            }
+            logFile.setNextTimeStamp(timeStamp - firstTimeStamp);
+            logFile.write(record, size);
+        }
+        record += size;
+    }
+    logFile.close();
+
+    return !first;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ *
+ * @file       rewindbuffer.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Logging
+ * @{
+ * @brief      Keeps the last minutes of telemetry in memory
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef REWINDBUFFER_H
+#define REWINDBUFFER_H
+
+#include <uavtalk/uavtalk.h>
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QString>
+
+/**
+ * Keeps the object packets of the last minutes of the session in a preallocated ring,
+ * they can be saved to a log file after the fact, for instance after a crash.
+ *
+ * The ring is written from the telemetry thread without a lock, packets are serialized there by
+ * the UAVTalk lock. The oldest records are dropped as the ring fills, the tail is moved before
+ * their bytes are overwritten so that a snapshot taken meanwhile on another thread can discard them.
+ */
+class RewindBuffer : public UAVTalk::FrameTap {
+public:
+    RewindBuffer(int capacityMB, int minutes);
+    ~RewindBuffer();
+
+    // suspended while replaying, the replayed packets are tapped too
+    void setPaused(bool paused);
+
+    // UAVTalk::FrameTap, called from the telemetry thread
+    void frame(qint64 timestamp, const quint8 *packet, int length);
+
+    // covered time and bytes used, for display
+    int seconds() const;
+    int bytesUsed() const;
+
+    // writes the last minutes to an .opl log file, the first record at time 0
+    bool save(const QString &fileName) const;
+
+private:
+    // timestamp (ms since the buffer creation) and packet length
+    static const int RECORD_HEADER = sizeof(quint32) + sizeof(quint16);
+
+    // power of 2, positions are free running and masked
+    quint32 m_capacity;
+    quint32 m_window;
+    qint64 m_startTime;
+    char *m_ring;
+    QAtomicInteger<quint32> m_head;
+    mutable QAtomicInteger<quint32> m_tail;
+    QAtomicInteger<quint32> m_lastTimeStamp;
+    QAtomicInt m_paused;
+
+    void read(quint32 position, void *data, quint32 size) const;
+    void write(quint32 position, const void *data, quint32 size);
+    QByteArray snapshot() const;
+};
+
+#endif // REWINDBUFFER_H
+
+/**
+ * @}
+ * @}
+ */
@@ -13,7 +13,8 @@ HEADERS += \
     notifyitemdelegate.h \
     notifytablemodel.h \
     notificationitem.h \
-    notifylogging.h
+    notifylogging.h \
+    soundengine.h
 
 SOURCES += \
     notifyplugin.cpp \
@@ -21,7 +22,8 @@ SOURCES += \
     notifyitemdelegate.cpp \
     notifytablemodel.cpp \
     notificationitem.cpp \
-    notifylogging.cpp
+    notifylogging.cpp \
+    soundengine.cpp
  
 OTHER_FILES += NotifyPlugin.pluginspec
 
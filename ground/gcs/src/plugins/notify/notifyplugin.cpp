@@ -29,6 +29,7 @@
 #include "notificationitem.h"
 #include "notifypluginoptionspage.h"
 #include "notifylogging.h"
+#include "soundengine.h"
 
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
@@ -47,16 +48,17 @@ static const QString VERSION = "1.0.0";
 
 SoundNotifyPlugin::SoundNotifyPlugin()
 {
-    phonon.mo = NULL;
+    soundEngine = NULL;
+    _nowPlayingNotification = NULL;
 }
 
 SoundNotifyPlugin::~SoundNotifyPlugin()
 {
     Core::ICore::instance()->saveSettings(this);
 
-    if (phonon.mo != NULL) {
-        delete phonon.mo;
-    }
+    clearRules();
+
+    delete soundEngine;
 }
 
 bool SoundNotifyPlugin::initialize(const QStringList & args, QString *errMsg)
@@ -181,15 +183,22 @@ void SoundNotifyPlugin::connectNotifications()
             disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(on_arrived_Notification(UAVObject *)));
         }
     }
-    if (phonon.mo != NULL) {
-        delete phonon.mo;
-        phonon.mo = NULL;
+    // the clips are decoded again below, sound files can have been changed
+    if (soundEngine != NULL) {
+        soundEngine->clear();
     }
+    _nowPlayingNotification = NULL;
+    clearRules();
 
     if (!enableSound) {
         return;
     }
 
+    if (soundEngine == NULL) {
+        soundEngine = new SoundEngine;
+        connect(soundEngine, SIGNAL(finished()), this, SLOT(soundFinished()));
+    }
+
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
@@ -208,12 +217,25 @@ void SoundNotifyPlugin::connectNotifications()
         }
         // check is all sounds presented for notification,
         // if not - we must not subscribe to it at all
-        if (notify->toSoundList().isEmpty()) {
+        QStringList sounds = notify->toSoundList();
+        if (sounds.isEmpty()) {
             continue;
         }
 
         UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject(notify->getDataObject()));
         if (obj != NULL) {
+            // resolve the rule once, updates are then checked without any name lookup
+            NotificationRule *rule = compileRule(notify, obj);
+            if (!rule) {
+                continue;
+            }
+            _objectRules[obj->getObjID()].append(rule);
+            _notificationRules.insert(notify, rule);
+
+            foreach(QString sound, sounds) {
+                soundEngine->preload(sound);
+            }
+
             if (!lstNotifiedUAVObjects.contains(obj)) {
                 lstNotifiedUAVObjects.append(obj);
 
@@ -225,23 +247,67 @@ void SoundNotifyPlugin::connectNotifications()
             qNotifyDebug() << "Error: Object is unknown (" << notify->getDataObject() << ").";
         }
     }
+}
 
-    if (_notificationList.isEmpty()) {
-        return;
+NotificationRule *SoundNotifyPlugin::compileRule(NotificationItem *notification, UAVDataObject *object)
+{
+    UAVObjectField *field = object->getField(notification->getObjectField());
+
+    if (!field || field->getName().isEmpty()) {
+        qNotifyDebug() << "Error: Field is unknown (" << notification->getDataObject() << notification->getObjectField() << ").";
+        return NULL;
+    }
+
+    NotificationRule *rule = new NotificationRule;
+    rule->notification = notification;
+    rule->field     = field;
+    rule->element   = 0;
+    rule->direction = notification->getCondition();
+    rule->isEnum    = (field->getType() == UAVObjectField::ENUM);
+    rule->enumIndex = -1;
+    rule->min = notification->singleValue().toDouble();
+    rule->max = notification->valueRange2();
+    rule->fieldMask = (quint64)1 << qMin(object->getFields().indexOf(field), 63);
+    rule->checkedFalse    = false;
+    rule->checkedSequence = 0;
+
+    if (rule->isEnum) {
+        QString value = notification->singleValue().toString();
+        QStringList options = field->getOptions();
+        for (int i = 0; i < options.size(); ++i) {
+            if (!QString::compare(options.at(i), value, Qt::CaseInsensitive)) {
+                rule->enumIndex = i;
+                break;
+            }
+        }
     }
-    // set notification message to current event
-    phonon.mo = new QMediaPlayer;
-    phonon.firstPlay = true;
-    connect(phonon.mo, SIGNAL(stateChanged(QMediaPlayer::State)),
-            this, SLOT(stateChanged(QMediaPlayer::State)));
+    return rule;
+}
+
+void SoundNotifyPlugin::removeRule(NotificationItem *notification)
+{
+    NotificationRule *rule = _notificationRules.take(notification);
+
+    if (rule) {
+        _objectRules[rule->field->getObject()->getObjID()].removeOne(rule);
+        delete rule;
+    }
+}
+
+void SoundNotifyPlugin::clearRules()
+{
+    qDeleteAll(_notificationRules);
+    _notificationRules.clear();
+    _objectRules.clear();
 }
 
 void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
 {
-    foreach(NotificationItem * ntf, _notificationList) {
-        if (object->getName() != ntf->getDataObject()) {
-            continue;
-        }
+    // a copy, played "once" notifications are removed while iterating
+    QList<NotificationRule *> rules = _objectRules.value(object->getObjID());
+
+    foreach(NotificationRule * rule, rules) {
+        NotificationItem *ntf = rule->notification;
 
 
         // skip duplicate notifications
@@ -249,6 +315,12 @@ void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
             continue;
         }
 
+        // skip rules found false whose field did not change since
+        if (rule->checkedFalse && !ntf->_isPlayed
+            && !(rule->field->getObject()->getChangedFields(rule->checkedSequence) & rule->fieldMask)) {
+            continue;
+        }
+
         // skip periodical notifications
         // this condition accepts:
         // 1. Periodical notifications played firstly;
@@ -268,7 +340,10 @@ void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
             .arg(ntf->singleValue().toString())
             .arg(ntf->valueRange2());
 
-        checkNotificationRule(ntf, object);
+        // the rule can have been removed while playing a previous one
+        if (_notificationRules.value(ntf) == rule) {
+            checkNotificationRule(rule);
+        }
     }
     connect(object, SIGNAL(objectUpdated(UAVObject *)),
             this, SLOT(on_arrived_Notification(UAVObject *)), Qt::UniqueConnection);
@@ -295,11 +370,9 @@ void SoundNotifyPlugin::on_timerRepeated_Notification()
         .arg(notification->getObjectField())
         .arg(notification->toString());
 
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    UAVObject *object = objManager->getObject(notification->getDataObject());
-    if (object) {
-        checkNotificationRule(notification, object);
+    NotificationRule *rule = _notificationRules.value(notification);
+    if (rule) {
+        checkNotificationRule(rule);
     }
 }
 
@@ -323,44 +396,37 @@ void SoundNotifyPlugin::on_expiredTimer_Notification()
     }
 }
 
-void SoundNotifyPlugin::stateChanged(QMediaPlayer::State newstate)
+void SoundNotifyPlugin::soundFinished()
 {
-    // qNotifyDebug() << "File length (ms): " << phonon.mo->totalTime();
-
-#ifndef Q_OS_WIN
-    // This is a hack to force Linux to wait until the end of the
-    // wav file before moving to the next in the queue.
-    // I wish I did not have to go through a #define, but I did not
-    // manage to make this work on both platforms any other way!
-// if (phonon.mo->totalTime() > 0) {
-// phonon.mo->setTransitionTime(phonon.mo->totalTime());
-// }
-#endif
-    if ((newstate == QMediaPlayer::PausedState) ||
-        (newstate == QMediaPlayer::StoppedState)) {
-        qNotifyDebug() << "New State: " << QVariant(newstate).toString();
-
-        // assignment to NULL needed to detect that palying is finished
-        // it's useful in repeat timer handler, where we can detect
-        // that notification has not overlap with itself
-        _nowPlayingNotification = NULL;
-
-        if (!_pendingNotifications.isEmpty()) {
-            NotificationItem *notification = _pendingNotifications.takeFirst();
-            qNotifyDebug_if(notification) << "play audioFree - " << notification->toString();
-            playNotification(notification);
-            qNotifyDebug() << "end playNotification";
+    qNotifyDebug() << "finished: " << (_nowPlayingNotification ? _nowPlayingNotification->toString() : QString());
+
+    // assignment to NULL needed to detect that palying is finished
+    // it's useful in repeat timer handler, where we can detect
+    // that notification has not overlap with itself
+    _nowPlayingNotification = NULL;
+
+    if (!_pendingNotifications.isEmpty()) {
+        // the most important pending notification goes first
+        NotificationItem *notification = _pendingNotifications.first();
+        foreach(NotificationItem * pending, _pendingNotifications) {
+            if (notificationPriority(pending) > notificationPriority(notification)) {
+                notification = pending;
+            }
         }
+        _pendingNotifications.removeOne(notification);
+        qNotifyDebug() << "play audioFree - " << notification->toString();
+        playNotification(notification);
+        qNotifyDebug() << "end playNotification";
     }
 }
 
-bool checkRange(QString fieldValue, QString enumValue, QStringList /* values */, int direction)
+bool checkRange(int fieldIndex, int enumIndex, int direction)
 {
     bool ret = false;
 
     switch (direction) {
     case NotifyPluginOptionsPage::equal:
-        ret = !QString::compare(enumValue, fieldValue, Qt::CaseInsensitive) ? true : false;
+        ret = (enumIndex >= 0) && (fieldIndex == enumIndex);
         break;
 
     default:
@@ -398,49 +464,29 @@ bool checkRange(double fieldValue, double min, double max, int direction)
     return ret;
 }
 
-void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UAVObject *object)
+void SoundNotifyPlugin::checkNotificationRule(NotificationRule *rule)
 {
-    if (notification->getDataObject() != object->getName() || object->getField(notification->getObjectField()) == NULL) {
-        return;
-    }
+    NotificationItem *notification = rule->notification;
     bool condition = false;
 
     if (notification->mute()) {
         return;
     }
 
-    int direction         = notification->getCondition();
-    QString fieldName     = notification->getObjectField();
-    UAVObjectField *field = object->getField(fieldName);
-
-    if (field->getName().isEmpty()) {
-        return;
-    }
-
-    QVariant value = field->getValue();
-    if (UAVObjectField::ENUM == field->getType()) {
-        qNotifyDebug() << "Check range ENUM" << value.toString() << "|" << notification->singleValue().toString() << "|" << field->getOptions() << "|" <<
-            direction << checkRange(value.toString(),
-                                    notification->singleValue().toString(),
-                                    field->getOptions(),
-                                    direction);;
-        condition = checkRange(value.toString(),
-                               notification->singleValue().toString(),
-                               field->getOptions(),
-                               direction);
+    quint32 sequence = rule->field->getObject()->getChangeSequence();
+    if (rule->isEnum) {
+        condition = checkRange(rule->field->get<quint8>(rule->element), rule->enumIndex, rule->direction);
+        qNotifyDebug() << "Check range ENUM" << rule->field->getValue(rule->element).toString() << "|" << notification->singleValue().toString() << "|"
+                       << rule->direction << condition;
     } else {
-        qNotifyDebug() << "Check range VAL" << value.toString() << "|" << notification->singleValue().toString() << "|" << field->getOptions() << "|" <<
-            direction << checkRange(value.toDouble(),
-                                    notification->singleValue().toDouble(),
-                                    notification->valueRange2(),
-                                    direction);
-        condition = checkRange(value.toDouble(),
-                               notification->singleValue().toDouble(),
-                               notification->valueRange2(),
-                               direction);
+        double value = rule->field->getDouble(rule->element);
+        condition = checkRange(value, rule->min, rule->max, rule->direction);
+        qNotifyDebug() << "Check range VAL" << value << "|" << rule->min << "|" << rule->max << "|" << rule->direction << condition;
     }
 
     notification->_isPlayed = condition;
+    rule->checkedFalse      = !condition;
+    rule->checkedSequence   = sequence;
     // if condition has been changed, and already in false state
     // we should reset _isPlayed flag and stop repeat timer
     if (!notification->_isPlayed) {
@@ -469,28 +515,38 @@ void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UA
     }
 }
 
+/*!
+    notifications higher in the list are more important,
+    they interrupt the less important ones being played
+ */
+int SoundNotifyPlugin::notificationPriority(NotificationItem *notification) const
+{
+    int index = _notificationList.indexOf(notification);
+
+    return (index < 0) ? 0 : _notificationList.size() - index;
+}
+
 bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
 {
-    playlist = new QMediaPlaylist;
     if (!notification) {
         return false;
     }
 
-    // Check: race condition, if phonon.mo got deleted don't go further
-    if (phonon.mo == NULL) {
+    // Check: race condition, if the engine got deleted don't go further
+    if (soundEngine == NULL) {
         return false;
     }
 
-    // qNotifyDebug() << "Phonon State: " << phonon.mo->state();
+    // taken before a "once" notification is removed from the list
+    int priority = notificationPriority(notification);
 
-    if ((phonon.mo->state() == QMediaPlayer::PausedState)
-        || (phonon.mo->state() == QMediaPlayer::StoppedState)
-        || phonon.firstPlay) {
+    if (!soundEngine->isPlaying() || (priority > soundEngine->priority())) {
         _nowPlayingNotification = notification;
         notification->stopExpireTimer();
 
         if (notification->retryValue() == NotificationItem::repeatOnce) {
             _toRemoveNotifications.append(_notificationList.takeAt(_notificationList.indexOf(notification)));
+            removeRule(notification);
         } else if (notification->retryValue() == NotificationItem::repeatOncePerUpdate) {
             notification->setCurrentUpdatePlayed(true);
         } else {
@@ -518,17 +574,10 @@ bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
                         this, SLOT(on_timerRepeated_Notification()), Qt::UniqueConnection);
             }
         }
-        phonon.mo->stop();
         qNotifyDebug() << "play: " << notification->toString();
-        foreach(QString item, notification->toSoundList()) {
-            playlist->addMedia(QUrl::fromLocalFile(item));
+        if (!soundEngine->play(notification->toSoundList(), priority)) {
+            _nowPlayingNotification = NULL;
         }
-        qNotifyDebug() << "begin play";
-        phonon.mo->setPlaylist(playlist);
-        phonon.mo->play();
-        qNotifyDebug() << "end play";
-        phonon.firstPlay = false; // On Linux, you sometimes have to nudge Phonon to play 1 time before
-                                  // the state is not "Loading" anymore.
         return true;
     }
 
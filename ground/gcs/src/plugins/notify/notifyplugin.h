@@ -34,16 +34,29 @@
 #include "notificationitem.h"
 
 #include <QSettings>
-#include <QMediaPlaylist>
-#include <QMediaPlayer>
+#include <QHash>
 
 class NotifyPluginOptionsPage;
+class SoundEngine;
 
+// notification rule resolved against its UAVObject, see connectNotifications()
 typedef struct {
-    QMediaPlayer *mo;
-    NotificationItem *notify;
-    bool firstPlay;
-} PhononObject, *pPhononObject;
+    NotificationItem *notification;
+    UAVObjectField *field;
+    quint32 element;
+    int direction;
+    bool isEnum;
+    // enum rules compare the option index, -1 if the value is not an option
+    int enumIndex;
+    // numeric rules compare the value with min (and max for ranges)
+    double min;
+    double max;
+    // bit of the field in UAVObject::getChangedFields()
+    quint64 fieldMask;
+    // a false condition holds until the field changes, see on_arrived_Notification()
+    bool checkedFalse;
+    quint32 checkedSequence;
+} NotificationRule;
 
 
 class SoundNotifyPlugin : public Core::IConfigurablePlugin {
@@ -83,7 +96,12 @@ private:
     Q_DISABLE_COPY(SoundNotifyPlugin)
 
     bool playNotification(NotificationItem *notification);
-    void checkNotificationRule(NotificationItem *notification, UAVObject *object);
+    int notificationPriority(NotificationItem *notification) const;
+    void checkNotificationRule(NotificationRule *rule);
+
+    NotificationRule *compileRule(NotificationItem *notification, UAVDataObject *object);
+    void removeRule(NotificationItem *notification);
+    void clearRules();
 
 private slots:
 
@@ -95,7 +113,7 @@ private slots:
     void on_arrived_Notification(UAVObject *object);
     void on_timerRepeated_Notification(void);
     void on_expiredTimer_Notification(void);
-    void stateChanged(QMediaPlayer::State newstate);
+    void soundFinished();
 
 private:
     bool enableSound;
@@ -105,12 +123,15 @@ private:
     QList<NotificationItem *> _pendingNotifications;
     QList<NotificationItem *> _toRemoveNotifications;
 
+    // rules of the subscribed notifications, by object id
+    QHash<quint32, QList<NotificationRule *> > _objectRules;
+    QHash<NotificationItem *, NotificationRule *> _notificationRules;
+
     NotificationItem currentNotification;
     NotificationItem *_nowPlayingNotification;
 
-    PhononObject phonon;
+    SoundEngine *soundEngine;
     NotifyPluginOptionsPage *mop;
-    QMediaPlaylist *playlist;
 };
 
 #endif // SOUNDNOTIFYPLUGIN_H
@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ *
+ * @file       soundengine.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup notifyplugin
+ * @{
+ * @brief      Plays preloaded PCM sound clips with priority preemption
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "soundengine.h"
+#include "notifylogging.h"
+
+#include <QFile>
+#include <QtEndian>
+#include <QAudioDeviceInfo>
+
+#include <cstring>
+
+// audio device buffer, small to start playing quickly
+static const qint64 OUTPUT_BUFFER_US = 100000;
+
+SoundEngine::SoundEngine(QObject *parent) : QObject(parent),
+    m_output(NULL), m_playing(false), m_priority(0)
+{}
+
+SoundEngine::~SoundEngine()
+{
+    stop();
+}
+
+/*!
+    decode a wav file into the clip cache,
+    returns false if the file can't be played
+ */
+bool SoundEngine::preload(const QString &fileName)
+{
+    if (m_clips.contains(fileName)) {
+        return true;
+    }
+
+    SoundClip clip;
+    if (!readWave(fileName, &clip)) {
+        qNotifyDebug() << "Error: can't decode sound file" << fileName;
+        return false;
+    }
+    m_clips.insert(fileName, clip);
+
+    // open the device now, the first notification must not wait for it
+    if (!m_output) {
+        setFormat(clip.format);
+    }
+    return true;
+}
+
+void SoundEngine::clear()
+{
+    stop();
+    m_clips.clear();
+}
+
+/*!
+    play the clips one after the other;
+    returns false if a phrase of the same or higher priority is playing
+ */
+bool SoundEngine::play(const QStringList &fileNames, int priority)
+{
+    if (m_playing && priority <= m_priority) {
+        return false;
+    }
+    stop();
+
+    QByteArray data;
+    QAudioFormat format;
+    foreach(QString fileName, fileNames) {
+        if (!preload(fileName)) {
+            continue;
+        }
+        const SoundClip &clip = m_clips[fileName];
+        if (!format.isValid()) {
+            format = clip.format;
+        } else if (clip.format != format) {
+            qNotifyDebug() << "Error: sound format differs from the phrase" << fileName;
+            continue;
+        }
+        data.append(clip.data);
+    }
+    if (data.isEmpty()) {
+        return false;
+    }
+
+    setFormat(format);
+    if (!m_output) {
+        return false;
+    }
+
+    m_buffer.setData(data);
+    m_buffer.open(QIODevice::ReadOnly);
+    m_priority = priority;
+    m_playing  = true;
+    m_output->start(&m_buffer);
+    return true;
+}
+
+void SoundEngine::stop()
+{
+    // cleared first, the stop must not be reported as finished
+    m_playing = false;
+    if (m_output) {
+        m_output->stop();
+    }
+    m_buffer.close();
+}
+
+void SoundEngine::stateChanged(QAudio::State state)
+{
+    if (!m_playing) {
+        return;
+    }
+    // idle once the whole phrase was played, stopped on device error
+    if (state == QAudio::IdleState || state == QAudio::StoppedState) {
+        if (m_output->error() != QAudio::NoError) {
+            qNotifyDebug() << "Error: audio output" << m_output->error();
+        }
+        stop();
+        emit finished();
+    }
+}
+
+/*!
+    (re)create the output if the format changed
+ */
+void SoundEngine::setFormat(const QAudioFormat &format)
+{
+    if (m_output && m_output->format() == format) {
+        return;
+    }
+    delete m_output;
+    m_output = NULL;
+
+    QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+    if (!device.isFormatSupported(format)) {
+        qNotifyDebug() << "Error: audio format not supported by" << device.deviceName();
+        return;
+    }
+    m_output = new QAudioOutput(device, format, this);
+    m_output->setBufferSize(format.bytesForDuration(OUTPUT_BUFFER_US));
+    connect(m_output, SIGNAL(stateChanged(QAudio::State)), this, SLOT(stateChanged(QAudio::State)));
+}
+
+/*!
+    minimal RIFF parser, only uncompressed pcm is supported
+ */
+bool SoundEngine::readWave(const QString &fileName, SoundClip *clip)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray wave = file.readAll();
+    const uchar *data = reinterpret_cast<const uchar *>(wave.constData());
+    int size = wave.size();
+
+    if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4)) {
+        return false;
+    }
+
+    bool hasFormat = false;
+    int pos = 12;
+    while (pos + 8 <= size) {
+        const uchar *chunk = data + pos;
+        int length = qFromLittleEndian<quint32>(chunk + 4);
+        pos += 8;
+        if (length < 0 || length > size - pos) {
+            // truncated file, keep what was written
+            length = size - pos;
+        }
+
+        if (!memcmp(chunk, "fmt ", 4) && length >= 16) {
+            const uchar *fmt = data + pos;
+            if (qFromLittleEndian<quint16>(fmt) != 1) {
+                return false;
+            }
+            int sampleSize = qFromLittleEndian<quint16>(fmt + 14);
+            clip->format.setCodec("audio/pcm");
+            clip->format.setChannelCount(qFromLittleEndian<quint16>(fmt + 2));
+            clip->format.setSampleRate(qFromLittleEndian<quint32>(fmt + 4));
+            clip->format.setSampleSize(sampleSize);
+            clip->format.setByteOrder(QAudioFormat::LittleEndian);
+            clip->format.setSampleType(sampleSize == 8 ? QAudioFormat::UnSignedInt : QAudioFormat::SignedInt);
+            hasFormat = true;
+        } else if (!memcmp(chunk, "data", 4)) {
+            if (!hasFormat) {
+                return false;
+            }
+            clip->data = wave.mid(pos, length);
+            return !clip->data.isEmpty();
+        }
+        // chunks are word aligned
+        pos += length + (length & 1);
+    }
+    return false;
+}
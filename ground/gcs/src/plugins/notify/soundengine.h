@@ -0,0 +1,88 @@
+/**
+ ******************************************************************************
+ *
+ * @file       soundengine.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup notifyplugin
+ * @{
+ * @brief      Plays preloaded PCM sound clips with priority preemption
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SOUNDENGINE_H
+#define SOUNDENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QBuffer>
+#include <QStringList>
+#include <QAudioFormat>
+#include <QAudioOutput>
+
+// decoded pcm samples of a wav file
+typedef struct {
+    QAudioFormat format;
+    QByteArray   data;
+} SoundClip;
+
+/*!
+    Sound clips are decoded once by preload() and a phrase is played
+    by feeding the concatenated samples to a single QAudioOutput,
+    so a notification starts without any file access or decoding.
+    A phrase of higher priority stops the one being played.
+ */
+class SoundEngine : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SoundEngine(QObject *parent = 0);
+    ~SoundEngine();
+
+    bool preload(const QString &fileName);
+    void clear();
+
+    bool play(const QStringList &fileNames, int priority);
+    void stop();
+
+    bool isPlaying() const
+    {
+        return m_playing;
+    }
+    int priority() const
+    {
+        return m_priority;
+    }
+
+signals:
+    void finished();
+
+private slots:
+    void stateChanged(QAudio::State state);
+
+private:
+    Q_DISABLE_COPY(SoundEngine)
+
+    static bool readWave(const QString &fileName, SoundClip *clip);
+    void setFormat(const QAudioFormat &format);
+
+    QHash<QString, SoundClip> m_clips;
+    QAudioOutput *m_output;
+    QBuffer m_buffer;
+    bool m_playing;
+    int m_priority;
+};
+
+#endif // SOUNDENGINE_H
@@ -34,11 +34,11 @@
 #include <QIODevice>
 #include <QMutex>
 #include <QByteArray>
+#include <QAtomicInteger>
 #include "ophid_hidapi.h"
 #include "ophid_usbmon.h"
 
-class RawHIDReadThread;
-class RawHIDWriteThread;
+class RawHIDIOThread;
 
 /**
  *   The actual IO device that will be used to communicate
@@ -46,9 +46,10 @@ class RawHIDWriteThread;
  */
 class OPHID_EXPORT RawHID : public QIODevice {
     Q_OBJECT
+    // when the oldest unread data arrived, steady clock in microseconds (0 if unknown)
+    Q_PROPERTY(qint64 readTimestamp READ readTimestamp)
 
-    friend class RawHIDReadThread;
-    friend class RawHIDWriteThread;
+    friend class RawHIDIOThread;
 
 public:
     RawHID();
@@ -59,6 +60,8 @@ public:
     virtual void close();
     virtual bool isSequential() const;
 
+    qint64 readTimestamp() const;
+
 signals:
     void closed();
 
@@ -83,11 +86,12 @@ protected:
     opHID_hidapi dev;
     bool device_open;
 
-    RawHIDReadThread *m_readThread;
-    RawHIDWriteThread *m_writeThread;
+    RawHIDIOThread *m_ioThread;
 
     QMutex *m_mutex;
     QMutex *m_startedMutex;
+
+    QAtomicInteger<qint64> m_readTimestamp;
 };
 
 #endif // OPHID_H
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <QString>
+#include <QStringList>
 #include <QMutex>
 #include "../hidapi/hidapi.h"
 #include "ophid_const.h"
@@ -48,6 +49,10 @@ public:
 
     int open(int max, int vid, int pid, int usage_page, int usage);
 
+    int openPath(const QString &path);
+
+    static QStringList devicePaths(int vid, int bcdDeviceLSB);
+
     int receive(int, void *buf, int len, int timeout);
 
     void close(int num);
@@ -155,6 +155,14 @@ signals:
     void deviceRemoved(const USBPortInfo & info);
     void deviceRemoved();
 
+    /*!
+       A serial port has been added to or removed from the system.
+
+       Lets serial connections follow hotplug events instead of polling
+       the list of ports.
+     */
+    void serialPortsChanged();
+
 private slots:
     /**
        Callback available for whenever the system that is put in place gets
@@ -180,6 +188,7 @@ private:
     static void detach_callback(void *context, IOReturn r, void *hid_mgr, IOHIDDeviceRef dev);
     void addDevice(USBPortInfo info);
     void removeDevice(IOHIDDeviceRef dev);
+    static void serial_callback(void *context, io_iterator_t iterator);
     IOHIDManagerRef hid_manager;
 #elif defined(Q_OS_UNIX)
     struct udev *context;
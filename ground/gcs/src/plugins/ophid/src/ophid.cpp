@@ -32,68 +32,121 @@
 #include <QtGlobal>
 #include <QList>
 #include <QMutexLocker>
-#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QVector>
+
+#include <chrono>
 
 class IConnection;
 
-// timeout value used when we want to return directly without waiting
-static const int READ_TIMEOUT  = 200;
+// the I/O thread never blocks longer than this in a read, which bounds the
+// delay of a write queued while the link is idle
+static const int READ_TIMEOUT  = 5;
 static const int READ_SIZE     = 64;
 
 static const int WRITE_TIMEOUT = 1000;
 static const int WRITE_SIZE    = 64;
 
+// at most that many reports are read or sent in a row before switching direction
+static const int MAX_BATCH     = 16;
+
+// buffer sizes, must be powers of 2
+static const int READ_BUFFER_SIZE  = 64 * 1024;
+static const int WRITE_BUFFER_SIZE = 64 * 1024;
+
 
 // *********************************************************************************
 
 /**
- *   Thread to desynchronize reading from the device
+ *   Preallocated single producer / single consumer circular buffer.
+ *   The producer only moves the head and the consumer only moves the tail,
+ *   so the two sides never need a lock.
  */
-class RawHIDReadThread : public QThread {
+class RawHIDRingBuffer {
 public:
-    RawHIDReadThread(RawHID *hid);
-    virtual ~RawHIDReadThread();
-
-    /** Return the data read so far without waiting */
-    int getReadData(char *data, int size);
-
-    /** return the bytes buffered */
-    qint64 getBytesAvailable();
+    RawHIDRingBuffer(int size) : m_buffer(size, 0), m_mask(size - 1), m_head(0), m_tail(0)
+    {
+        Q_ASSERT((size & m_mask) == 0);
+    }
 
-public slots:
-    void terminate()
+    /** Number of bytes buffered (either side) */
+    int size() const
     {
-        m_running = false;
+        return (quint32)m_head.loadAcquire() - (quint32)m_tail.loadAcquire();
     }
 
-protected:
-    void run();
+    /** Number of bytes that can be written (producer side) */
+    int free() const
+    {
+        return m_buffer.size() - size();
+    }
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_readBuffer;
+    /** Append up to size bytes, returns the number of bytes taken (producer side) */
+    int write(const char *data, int size)
+    {
+        quint32 head = m_head.loadAcquire();
+
+        size = qMin(size, free());
+        int offset = head & m_mask;
+        int first  = qMin(size, m_buffer.size() - offset);
+        memcpy(m_buffer.data() + offset, data, first);
+        memcpy(m_buffer.data(), data + first, size - first);
+        m_head.storeRelease(head + size);
+        return size;
+    }
 
-    /** A mutex to protect read buffer */
-    QMutex m_readBufMtx;
+    /** Copy up to size bytes without consuming them (consumer side) */
+    int peek(char *data, int size) const
+    {
+        quint32 tail = m_tail.loadAcquire();
+
+        size = qMin(size, this->size());
+        int offset = tail & m_mask;
+        int first  = qMin(size, m_buffer.size() - offset);
+        memcpy(data, m_buffer.constData() + offset, first);
+        memcpy(data + first, m_buffer.constData(), size - first);
+        return size;
+    }
 
-    RawHID *m_hid;
+    /** Drop size bytes (consumer side) */
+    void skip(int size)
+    {
+        m_tail.storeRelease((quint32)m_tail.loadAcquire() + qMin(size, this->size()));
+    }
 
-    opHID_hidapi *hiddev;
-    int hidno;
+    /** Copy and consume up to size bytes (consumer side) */
+    int read(char *data, int size)
+    {
+        size = peek(data, size);
+        skip(size);
+        return size;
+    }
 
-    bool m_running;
+private:
+    QVector<char> m_buffer;
+    const quint32 m_mask;
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
 };
 
 
 // *********************************************************************************
 
 /**
- *  This class is nearly the same than RawHIDReadThread but for writing
+ *   Thread doing all the USB I/O of a RawHID device.
+ *   It alternates between draining the write buffer and reading with a
+ *   short timeout, so a single thread serves both directions.
  */
-class RawHIDWriteThread : public QThread {
+class RawHIDIOThread : public QThread {
 public:
-    RawHIDWriteThread(RawHID *hid);
-    virtual ~RawHIDWriteThread();
+    RawHIDIOThread(RawHID *hid);
+    virtual ~RawHIDIOThread();
+
+    /** Return the data read so far without waiting */
+    int getReadData(char *data, int size);
+
+    /** return the bytes buffered */
+    qint64 getBytesAvailable();
 
     /** Add some data to be written without waiting */
     int pushDataToWrite(const char *data, int size);
@@ -110,28 +163,35 @@ public slots:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-       a circular buffer but it's good enough and very simple */
-    QByteArray m_writeBuffer;
+    /** Send the pending data, returns false on error */
+    bool writeReports();
 
-    /** A mutex to protect read buffer */
-    QMutex m_writeBufMtx;
+    /** Read the available reports, returns false on error */
+    bool readReports();
 
-    /** Synchronize task with data arival */
-    QWaitCondition m_newDataToWrite;
+    /** USB to UAVTalk, filled by this thread */
+    RawHIDRingBuffer m_readBuffer;
+
+    /** UAVTalk to USB, drained by this thread */
+    RawHIDRingBuffer m_writeBuffer;
+
+    /** Serializes the writers (UAVTalk may write from several threads) */
+    QMutex m_writeMtx;
 
     RawHID *m_hid;
 
     opHID_hidapi *hiddev;
     int hidno;
 
-    bool m_running;
+    volatile bool m_running;
 };
 
 // *********************************************************************************
 
-RawHIDReadThread::RawHIDReadThread(RawHID *hid)
-    : m_hid(hid),
+RawHIDIOThread::RawHIDIOThread(RawHID *hid)
+    : m_readBuffer(READ_BUFFER_SIZE),
+    m_writeBuffer(WRITE_BUFFER_SIZE),
+    m_hid(hid),
     hiddev(&hid->dev),
     hidno(hid->m_deviceNo),
     m_running(true)
@@ -141,43 +201,26 @@ RawHIDReadThread::RawHIDReadThread(RawHID *hid)
     OPHID_TRACE("OUT");
 }
 
-RawHIDReadThread::~RawHIDReadThread()
+RawHIDIOThread::~RawHIDIOThread()
 {
     m_running = false;
     // wait for the thread to terminate
     if (wait(10000) == false) {
-        qWarning() << "Cannot terminate RawHIDReadThread";
+        qWarning() << "Cannot terminate RawHIDIOThread";
     }
 }
 
-void RawHIDReadThread::run()
+void RawHIDIOThread::run()
 {
     OPHID_TRACE("IN");
 
     m_running = m_hid->openDevice();
+    // the device number is only known once opened
+    hidno     = m_hid->m_deviceNo;
 
     while (m_running) {
-        // here we use a temporary buffer so we don't need to lock
-        // the mutex while we are reading from the device
-
-        // Want to read in regular chunks that match the packet size the device
-        // is using.  In this case it is 64 bytes (the interrupt packet limit)
-        // although it would be nice if the device had a different report to
-        // configure this
-        char buffer[READ_SIZE] = { 0 };
-
-        int ret = hiddev->receive(hidno, buffer, READ_SIZE, READ_TIMEOUT);
-
-        if (ret > 0) { // read some data
-            QMutexLocker lock(&m_readBufMtx);
-            // Note: Preprocess the USB packets in this OS independent code
-            // First byte is report ID, second byte is the number of valid bytes
-            m_readBuffer.append(&buffer[2], buffer[1]);
-
-            emit m_hid->readyRead();
-        } else if (ret == 0) { // nothing read
-        } else { // < 0 => error
-                 // TODO! make proper error handling, this only quick hack for unplug freeze
+        if (!writeReports() || !readReports()) {
+            // TODO! make proper error handling, this only quick hack for unplug freeze
             m_running = false;
         }
     }
@@ -186,104 +229,101 @@ void RawHIDReadThread::run()
     OPHID_TRACE("OUT");
 }
 
-int RawHIDReadThread::getReadData(char *data, int size)
+bool RawHIDIOThread::writeReports()
 {
-    QMutexLocker lock(&m_readBufMtx);
-
-    size = qMin(size, m_readBuffer.size());
-
-    memcpy(data, m_readBuffer.constData(), size);
-    m_readBuffer.remove(0, size);
-
-    return size;
-}
-
-qint64 RawHIDReadThread::getBytesAvailable()
-{
-    QMutexLocker lock(&m_readBufMtx);
-
-    return m_readBuffer.size();
-}
+    int written = 0;
 
-// *********************************************************************************
-
-RawHIDWriteThread::RawHIDWriteThread(RawHID *hid)
-    : m_hid(hid),
-    hiddev(&hid->dev),
-    hidno(hid->m_deviceNo),
-    m_running(true)
-{}
-
-RawHIDWriteThread::~RawHIDWriteThread()
-{
-    m_running = false;
-    // wait for the thread to terminate
-    if (wait(10000) == false) {
-        qWarning() << "Cannot terminate RawHIDReadThread";
-    }
-}
-
-void RawHIDWriteThread::run()
-{
-    while (m_running) {
+    for (int i = 0; i < MAX_BATCH && m_writeBuffer.size() > 0; i++) {
         char buffer[WRITE_SIZE] = { 0 };
-        int size;
-
-        {
-            QMutexLocker lock(&m_writeBufMtx);
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            while (size <= 0) {
-                // wait on new data to write condition, the timeout
-                // enable the thread to shutdown properly
-                m_newDataToWrite.wait(&m_writeBufMtx, 200);
-                if (!m_running) {
-                    return;
-                }
-
-                size = m_writeBuffer.size();
-            }
 
-            // NOTE: data size is limited to 2 bytes less than the
-            // usb packet size (64 bytes for interrupt) to make room
-            // for the reportID and valid data length
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            memcpy(&buffer[2], m_writeBuffer.constData(), size);
-            buffer[1] = size; // valid data length
-            buffer[0] = 2; // reportID
-        }
+        // NOTE: data size is limited to 2 bytes less than the
+        // usb packet size (64 bytes for interrupt) to make room
+        // for the reportID and valid data length
+        int size = m_writeBuffer.peek(&buffer[2], WRITE_SIZE - 2);
+        buffer[1] = size; // valid data length
+        buffer[0] = 2; // reportID
 
-        // must hold lock through the send to know how much was sent
         int ret = hiddev->send(hidno, buffer, WRITE_SIZE, WRITE_TIMEOUT);
-
         if (ret > 0) {
             // only remove the size actually written to the device
-            QMutexLocker lock(&m_writeBufMtx);
-            m_writeBuffer.remove(0, size);
-
-            emit m_hid->bytesWritten(ret - 2);
+            m_writeBuffer.skip(size);
+            written += size;
         } else if (ret < 0) { // < 0 => error
-            // TODO! make proper error handling, this only quick hack for unplug freeze
-            m_running = false;
             qCritical() << "Error writing to device (" << ret << ")";
+            return false;
         } else {
             qCritical() << "No data written to device ??";
+            break;
+        }
+    }
+    if (written) {
+        emit m_hid->bytesWritten(written);
+    }
+    return true;
+}
+
+bool RawHIDIOThread::readReports()
+{
+    int received = 0;
+
+    // only wait when there is nothing to send
+    int timeout  = m_writeBuffer.size() > 0 ? 0 : READ_TIMEOUT;
+
+    for (int i = 0; i < MAX_BATCH; i++) {
+        // Want to read in regular chunks that match the packet size the device
+        // is using.  In this case it is 64 bytes (the interrupt packet limit)
+        // although it would be nice if the device had a different report to
+        // configure this
+        char buffer[READ_SIZE] = { 0 };
+
+        int ret = hiddev->receive(hidno, buffer, READ_SIZE, timeout);
+        if (ret > 0) { // read some data
+            // Note: Preprocess the USB packets in this OS independent code
+            // First byte is report ID, second byte is the number of valid bytes
+            int size = qBound(0, (int)(quint8)buffer[1], READ_SIZE - 2);
+            if (m_readBuffer.size() == 0) {
+                // same clock as the UAVTalk latency statistics
+                m_hid->m_readTimestamp.storeRelease(std::chrono::duration_cast<std::chrono::microseconds>(
+                                                        std::chrono::steady_clock::now().time_since_epoch()).count());
+            }
+            if (m_readBuffer.write(&buffer[2], size) < size) {
+                qWarning() << "RawHID read buffer overflow, data dropped";
+            }
+            received += size;
+            // pick up the reports already queued without waiting again
+            timeout   = 0;
+        } else if (ret == 0) { // nothing read
+            break;
+        } else { // < 0 => error
+            return false;
         }
     }
+    // one notification for the whole batch
+    if (received) {
+        emit m_hid->readyRead();
+    }
+    return true;
 }
 
-int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
+int RawHIDIOThread::getReadData(char *data, int size)
 {
-    QMutexLocker lock(&m_writeBufMtx);
+    return m_readBuffer.read(data, size);
+}
+
+qint64 RawHIDIOThread::getBytesAvailable()
+{
+    return m_readBuffer.size();
+}
 
-    m_writeBuffer.append(data, size);
-    m_newDataToWrite.wakeOne(); // signal that new data arrived
+int RawHIDIOThread::pushDataToWrite(const char *data, int size)
+{
+    QMutexLocker lock(&m_writeMtx);
 
-    return size;
+    return m_writeBuffer.write(data, size);
 }
 
-qint64 RawHIDWriteThread::getBytesToWrite()
+qint64 RawHIDIOThread::getBytesToWrite()
 {
-    // QMutexLocker lock(&m_writeBufMtx);
     return m_writeBuffer.size();
 }
 
@@ -293,9 +333,9 @@ RawHID::RawHID(const QString &deviceName)
     : QIODevice(),
     serialNumber(deviceName),
     m_deviceNo(-1),
-    m_readThread(NULL),
-    m_writeThread(NULL),
-    m_mutex(NULL)
+    m_ioThread(NULL),
+    m_mutex(NULL),
+    m_readTimestamp(0)
 {
     OPHID_TRACE("IN");
 
@@ -306,13 +346,11 @@ RawHID::RawHID(const QString &deviceName)
     // detect if the USB device is unplugged
     QObject::connect(&dev, SIGNAL(deviceUnplugged(int)), this, SLOT(onDeviceUnplugged(int)));
 
-    m_writeThread = new RawHIDWriteThread(this);
-
-    // Starting the read thread will lock the m_startexMutex until the
+    // Starting the I/O thread will lock the m_startexMutex until the
     // device is opened (which happens in that thread).
-    m_readThread = new RawHIDReadThread(this);
+    m_ioThread = new RawHIDIOThread(this);
 
-    m_readThread->start();
+    m_ioThread->start();
 
     m_startedMutex->lock();
 
@@ -321,7 +359,7 @@ RawHID::RawHID(const QString &deviceName)
 
 /**
  * @brief RawHID::openDevice This method opens the USB connection
- * It is uses as a callback from the read thread so that the USB
+ * It is uses as a callback from the I/O thread so that the USB
  * system code is registered in that thread instead of the calling
  * thread (usually UI)
  */
@@ -340,7 +378,7 @@ bool RawHID::openDevice()
         }
     }
 
-    // Now things are opened or not (from read thread) allow the constructor to complete
+    // Now things are opened or not (from I/O thread) allow the constructor to complete
     m_startedMutex->unlock();
 
     // Leave if we have not found one device
@@ -350,15 +388,13 @@ bool RawHID::openDevice()
         return false;
     }
 
-    m_writeThread->start();
-
     OPHID_TRACE("OUT");
     return true;
 }
 
 /**
  * @brief RawHID::closeDevice This method closes the USB connection
- * It is uses as a callback from the read thread so that the USB
+ * It is uses as a callback from the I/O thread so that the USB
  * system code is unregistered from that thread\
  */
 bool RawHID::closeDevice()
@@ -376,8 +412,8 @@ RawHID::~RawHID()
 {
 // OPHID_TRACE("IN");
 
-    // If the read thread exists then the device is open
-    if (m_readThread) {
+    // If the I/O thread exists then the device is open
+    if (m_ioThread) {
         close();
     }
 
@@ -404,13 +440,9 @@ bool RawHID::open(OpenMode mode)
 
     QIODevice::open(mode);
 
-    Q_ASSERT(m_readThread);
-    Q_ASSERT(m_writeThread);
-    if (m_readThread) {
-        m_readThread->start();
-    }
-    if (m_writeThread) {
-        m_writeThread->start();
+    Q_ASSERT(m_ioThread);
+    if (m_ioThread) {
+        m_ioThread->start();
     }
 
     return true;
@@ -422,21 +454,12 @@ void RawHID::close()
 
     emit aboutToClose();
 
-    if (m_writeThread) {
-        OPHID_DEBUG("Terminating write thread");
-        m_writeThread->terminate();
-        delete m_writeThread;
-        m_writeThread = NULL;
-        OPHID_DEBUG("Write thread terminated");
-    }
-
-
-    if (m_readThread) {
-        OPHID_DEBUG("Terminating read thread");
-        m_readThread->terminate();
-        delete m_readThread;
-        m_readThread = NULL;
-        OPHID_DEBUG("Read thread terminated");
+    if (m_ioThread) {
+        OPHID_DEBUG("Terminating I/O thread");
+        m_ioThread->terminate();
+        delete m_ioThread;
+        m_ioThread = NULL;
+        OPHID_DEBUG("I/O thread terminated");
     }
 
     emit closed();
@@ -451,46 +474,51 @@ bool RawHID::isSequential() const
     return true;
 }
 
+qint64 RawHID::readTimestamp() const
+{
+    return m_readTimestamp.loadAcquire();
+}
+
 qint64 RawHID::bytesAvailable() const
 {
     QMutexLocker locker(m_mutex);
 
-    if (!m_readThread) {
+    if (!m_ioThread) {
         return -1;
     }
 
-    return m_readThread->getBytesAvailable() + QIODevice::bytesAvailable();
+    return m_ioThread->getBytesAvailable() + QIODevice::bytesAvailable();
 }
 
 qint64 RawHID::bytesToWrite() const
 {
     QMutexLocker locker(m_mutex);
 
-    if (!m_writeThread) {
+    if (!m_ioThread) {
         return -1;
     }
 
-    return m_writeThread->getBytesToWrite() + QIODevice::bytesToWrite();
+    return m_ioThread->getBytesToWrite() + QIODevice::bytesToWrite();
 }
 
 qint64 RawHID::readData(char *data, qint64 maxSize)
 {
     QMutexLocker locker(m_mutex);
 
-    if (!m_readThread || !data) {
+    if (!m_ioThread || !data) {
         return -1;
     }
 
-    return m_readThread->getReadData(data, maxSize);
+    return m_ioThread->getReadData(data, maxSize);
 }
 
 qint64 RawHID::writeData(const char *data, qint64 maxSize)
 {
     QMutexLocker locker(m_mutex);
 
-    if (!m_writeThread || !data) {
+    if (!m_ioThread || !data) {
         return -1;
     }
 
-    return m_writeThread->pushDataToWrite(data, maxSize);
+    return m_ioThread->pushDataToWrite(data, maxSize);
 }
@@ -216,23 +216,72 @@ int opHID_hidapi::open(int max, int vid, int pid, int usage_page, int usage)
 }
 
 
+/**
+ * \brief Open the HID device at path
+ *
+ * \note Unlike open() this tells apart several boards of the same model.
+ *
+ * \param[in] path Platform path of the device, as returned by devicePaths().
+ * \return Number of opened device.
+ * \retval 0 or 1.
+ */
+int opHID_hidapi::openPath(const QString &path)
+{
+    OPHID_TRACE("IN");
+
+    if (handle) {
+        OPHID_WARNING("HID device seems already open.");
+    }
+
+    handle = hid_open_path(path.toLocal8Bit().constData());
+    if (!handle) {
+        OPHID_ERROR("Unable to open device %s.", qPrintable(path));
+    }
+
+    OPHID_TRACE("OUT");
+
+    return handle ? 1 : 0;
+}
+
+
+/**
+ * \brief List the paths of the HID devices in a given run state
+ *
+ * \param[in] vid USB vendor id of the devices.
+ * \param[in] bcdDeviceLSB run state (bootloader or running), -1 for any.
+ * \return The device paths.
+ */
+QStringList opHID_hidapi::devicePaths(int vid, int bcdDeviceLSB)
+{
+    QStringList paths;
+    struct hid_device_info *devices = hid_enumerate(vid, 0x0);
+
+    for (struct hid_device_info *dev = devices; dev; dev = dev->next) {
+        if (bcdDeviceLSB == -1 || (dev->release_number & 0x00ff) == bcdDeviceLSB) {
+            paths << QString::fromLocal8Bit(dev->path);
+        }
+    }
+    hid_free_enumeration(devices);
+
+    return paths;
+}
+
+
 /**
  * \brief Read an Input report from a HID device.
  *
- * \note This function does \b not block for now.
- *      Tests show that it does not need to.
+ * \note This function blocks until a report arrives or the timeout expires.
  *
  * \param[in] num Id of the device to receive packet (NOT supported).
  * \param[in] buf Pointer to the bufer to write the received packet to.
  * \param[in] len Size of the buffer.
- * \param[in] timeout Not supported.
+ * \param[in] timeout Timeout in ms, 0 to poll, -1 to wait forever.
  * \return Number of bytes received, or -1 on error.
- * \retval -1 for error or bytes received.
+ * \retval -1 for error, 0 on timeout or bytes received.
  */
 int opHID_hidapi::receive(int num, void *buf, int len, int timeout)
 {
     Q_UNUSED(num);
-    Q_UNUSED(timeout);
 
     int bytes_read = 0;
 
@@ -252,7 +301,7 @@ int opHID_hidapi::receive(int num, void *buf, int len, int timeout)
     }
 
     hid_read_Mtx.lock();
-    bytes_read = hid_read(handle, (unsigned char *)buf, len);
+    bytes_read = hid_read_timeout(handle, (unsigned char *)buf, len, timeout);
     hid_read_Mtx.unlock();
 
     // hidapi lib does not expose the libusb errors.
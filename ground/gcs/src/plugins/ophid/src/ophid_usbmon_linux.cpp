@@ -72,10 +72,15 @@ void USBMonitor::deviceEventReceived()
     dev = udev_monitor_receive_device(this->monitor);
     if (dev) {
         // this->monitorNotifier->setEnabled(0);
-        QString action  = QString(udev_device_get_action(dev));
-        QString devtype = QString(udev_device_get_devtype(dev));
+        QString action    = QString(udev_device_get_action(dev));
+        QString devtype   = QString(udev_device_get_devtype(dev));
+        QString subsystem = QString(udev_device_get_subsystem(dev));
         OPHID_DEBUG("Action: %s device: %s", qPrintable(action), qPrintable(devtype));
-        if (action == "add" && devtype == "usb_device") {
+        if (subsystem == "tty") {
+            if (action == "add" || action == "remove") {
+                emit serialPortsChanged();
+            }
+        } else if (action == "add" && devtype == "usb_device") {
             printPortInfo(dev);
             emit deviceDiscovered(makePortInfo(dev));
         } else if (action == "remove" && devtype == "usb_device") {
@@ -124,6 +129,8 @@ USBMonitor::USBMonitor(QObject *parent) : QThread(parent)
     this->monitor = udev_monitor_new_from_netlink(this->context, "udev");
     udev_monitor_filter_add_match_subsystem_devtype(
         this->monitor, "usb", NULL);
+    udev_monitor_filter_add_match_subsystem_devtype(
+        this->monitor, "tty", NULL);
     // udev_monitor_filter_add_match_tag(this->monitor, "openpilot");
     udev_monitor_enable_receiving(this->monitor);
     this->monitorNotifier = new QSocketNotifier(
@@ -29,6 +29,7 @@
 #include "ophid_usbmon.h"
 #include <IOKit/IOKitLib.h>
 #include <IOKit/hid/IOHIDLib.h>
+#include <IOKit/serial/IOSerialKeys.h>
 #include <CoreFoundation/CFString.h>
 #include <CoreFoundation/CFArray.h>
 #include <QMutexLocker>
@@ -138,6 +139,26 @@ void USBMonitor::addDevice(USBPortInfo info)
 }
 
 
+/**
+ * \brief Static callback for serial port matching and termination notifications
+ *
+ * \note The iterator must be drained to re-arm the notification
+ */
+void USBMonitor::serial_callback(void *context, io_iterator_t iterator)
+{
+    bool changed = false;
+    io_object_t service;
+
+    while ((service = IOIteratorNext(iterator))) {
+        IOObjectRelease(service);
+        changed = true;
+    }
+    if (changed && context) {
+        emit static_cast<USBMonitor *>(context)->serialPortsChanged();
+    }
+}
+
+
 /**
  * \brief Attach device
  *
@@ -246,9 +267,31 @@ void USBMonitor::run()
         return;
     }
 
+    // and for serial ports coming and going
+    io_iterator_t serialAdded   = 0;
+    io_iterator_t serialRemoved = 0;
+    IONotificationPortRef notifyPort = IONotificationPortCreate(kIOMasterPortDefault);
+    CFRunLoopAddSource(loop, IONotificationPortGetRunLoopSource(notifyPort), kCFRunLoopDefaultMode);
+    if (IOServiceAddMatchingNotification(notifyPort, kIOFirstMatchNotification, IOServiceMatching(kIOSerialBSDServiceValue),
+                                         serial_callback, this, &serialAdded) == KERN_SUCCESS) {
+        // ports already present are not a change, just arm the notification
+        serial_callback(NULL, serialAdded);
+    }
+    if (IOServiceAddMatchingNotification(notifyPort, kIOTerminatedNotification, IOServiceMatching(kIOSerialBSDServiceValue),
+                                         serial_callback, this, &serialRemoved) == KERN_SUCCESS) {
+        serial_callback(NULL, serialRemoved);
+    }
+
     while (m_terminate.available()) {
         CFRunLoopRunInMode(kCFRunLoopDefaultMode, 1, false);
     }
+    if (serialAdded) {
+        IOObjectRelease(serialAdded);
+    }
+    if (serialRemoved) {
+        IOObjectRelease(serialRemoved);
+    }
+    IONotificationPortDestroy(notifyPort);
     IOHIDManagerUnscheduleFromRunLoop(hid_manager, loop, kCFRunLoopDefaultMode);
     CFRelease(hid_manager);
 
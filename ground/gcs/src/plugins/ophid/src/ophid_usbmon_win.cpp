@@ -191,6 +191,9 @@ LRESULT USBMonitor::onDeviceChangeWin(WPARAM wParam, LPARAM lParam)
             // delimiters are different across APIs...change to backslash.  ugh.
             QString deviceID = TCHARToQString(pDevInf->dbcc_name).toUpper().replace("#", "\\");
             matchAndDispatchChangedDevice(deviceID, guid_hid, wParam);
+        } else if (pHdr->dbch_devicetype == DBT_DEVTYP_PORT) {
+            // COM port arrivals and removals are broadcast to all top level windows
+            emit serialPortsChanged();
         }
     }
     OPHID_TRACE("OUT");
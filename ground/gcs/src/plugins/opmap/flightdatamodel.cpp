@@ -29,7 +29,7 @@
 #include <QMessageBox>
 #include <QDomDocument>
 
-flightDataModel::flightDataModel(QObject *parent) : QAbstractTableModel(parent)
+flightDataModel::flightDataModel(QObject *parent) : QAbstractTableModel(parent), rowsRemoved(false)
 {}
 
 int flightDataModel::rowCount(const QModelIndex & /*parent*/) const
@@ -351,6 +351,9 @@ bool flightDataModel::setData(const QModelIndex &index, const QVariant &value, i
             return false;
         }
         pathPlanData *myRow = dataStorage.at(rowIndex);
+        if (getColumnByIndex(myRow, columnIndex) != value) {
+            myRow->dirty = true;
+        }
         setColumnByIndex(myRow, columnIndex, value);
         emit dataChanged(index, index);
     }
@@ -391,6 +394,7 @@ bool flightDataModel::insertRows(int row, int count, const QModelIndex & /*paren
         data->jumpdestination     = 0;
         data->errordestination    = 0;
         data->locked = false;
+        data->dirty  = true;
         if (rowCount() > 0) {
             data->altitude            = this->data(this->index(rowCount() - 1, ALTITUDE)).toDouble();
             data->altitudeRelative    = this->data(this->index(rowCount() - 1, ALTITUDERELATIVE)).toDouble();
@@ -411,6 +415,28 @@ bool flightDataModel::insertRows(int row, int count, const QModelIndex & /*paren
         }
         dataStorage.insert(row, data);
     }
+    // the following rows move to other waypoint instances
+    setRowsDirty(row + count);
+    endInsertRows();
+    return true;
+}
+
+/**
+ * Inserts rows already filled in, with a single notification for all the rows
+ */
+bool flightDataModel::insertWaypoints(int row, const QList<pathPlanData> &waypoints)
+{
+    if (row < 0 || row > rowCount() || waypoints.isEmpty()) {
+        return false;
+    }
+    beginInsertRows(QModelIndex(), row, row + waypoints.count() - 1);
+    for (int x = 0; x < waypoints.count(); ++x) {
+        pathPlanData *data = new pathPlanData(waypoints.at(x));
+        data->dirty = true;
+        dataStorage.insert(row + x, data);
+    }
+    // the following rows move to other waypoint instances
+    setRowsDirty(row + waypoints.count());
     endInsertRows();
     return true;
 }
@@ -425,10 +451,55 @@ bool flightDataModel::removeRows(int row, int count, const QModelIndex & /*paren
         delete dataStorage.at(row);
         dataStorage.removeAt(row);
     }
+    rowsRemoved = true;
+    // the following rows move to other waypoint instances
+    setRowsDirty(row);
     endRemoveRows();
     return true;
 }
 
+void flightDataModel::setRowsDirty(int row)
+{
+    for (int i = row; i < dataStorage.length(); ++i) {
+        dataStorage.at(i)->dirty = true;
+    }
+}
+
+/**
+ * Returns true if the row changed since the last setClean()
+ */
+bool flightDataModel::isRowDirty(int row) const
+{
+    return row >= 0 && row < dataStorage.length() && dataStorage.at(row)->dirty;
+}
+
+/**
+ * Returns true if rows were changed, inserted or removed since the last setClean()
+ */
+bool flightDataModel::isDirty() const
+{
+    if (rowsRemoved) {
+        return true;
+    }
+    foreach(const pathPlanData * row, dataStorage) {
+        if (row->dirty) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Mark the model as matching the path plan of the board, after an upload or a download
+ */
+void flightDataModel::setClean()
+{
+    rowsRemoved = false;
+    foreach(pathPlanData * row, dataStorage) {
+        row->dirty = false;
+    }
+}
+
 bool flightDataModel::writeToFile(QString fileName)
 {
     QFile file(fileName);
@@ -604,6 +675,7 @@ void flightDataModel::readFromFile(QString fileName)
         if (e.tagName() == "waypoint") {
             QDomNode fieldNode = e.firstChild();
             data = new pathPlanData;
+            data->dirty = true;
             while (!fieldNode.isNull()) {
                 QDomElement field = fieldNode.toElement();
                 if (field.tagName() == "field") {
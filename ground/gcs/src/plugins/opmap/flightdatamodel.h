@@ -47,6 +47,8 @@ struct pathPlanData {
     int     jumpdestination;
     int     errordestination;
     bool    locked;
+    // changed since the last synchronization with the board, see flightDataModel::setClean()
+    bool    dirty;
 };
 
 class flightDataModel : public QAbstractTableModel {
@@ -68,6 +70,7 @@ public:
     Qt::ItemFlags flags(const QModelIndex & index) const;
     bool insertRows(int row, int count, const QModelIndex & parent = QModelIndex());
     bool removeRows(int row, int count, const QModelIndex & parent = QModelIndex());
+    bool insertWaypoints(int row, const QList<pathPlanData> &waypoints);
     bool writeToFile(QString filename);
     void readFromFile(QString fileName);
     qreal defaultWaypointAltitude() const;
@@ -75,8 +78,15 @@ public:
 
     void setDefaultWaypointAltitude(qreal default_altitude);
     void setDefaultWaypointVelocity(qreal default_velocity);
+
+    bool isRowDirty(int row) const;
+    bool isDirty() const;
+    void setClean();
 private:
     QList<pathPlanData *> dataStorage;
+    // rows were removed since the last setClean()
+    bool rowsRemoved;
+    void setRowsDirty(int row);
     QVariant getColumnByIndex(const pathPlanData *row, const int index) const;
     bool setColumnByIndex(pathPlanData *row, const int index, const QVariant value);
     qreal m_defaultWaypointAltitude;
@@ -35,6 +35,9 @@ modelMapProxy::modelMapProxy(QObject *parent, OPMapWidget *map, flightDataModel
     connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), this, SLOT(dataChanged(QModelIndex, QModelIndex)));
     connect(myMap, SIGNAL(selectedWPChanged(QList<WayPointItem *>)), this, SLOT(selectedWPChanged(QList<WayPointItem *>)));
     connect(myMap, SIGNAL(WPValuesChanged(WayPointItem *)), this, SLOT(WPValuesChanged(WayPointItem *)));
+    overlayTimer.setSingleShot(true);
+    overlayTimer.setInterval(0);
+    connect(&overlayTimer, SIGNAL(timeout()), this, SLOT(refreshOverlays()));
 }
 
 void modelMapProxy::WPValuesChanged(WayPointItem *wp)
@@ -108,135 +111,204 @@ modelMapProxy::overlayType modelMapProxy::overlayTranslate(int type)
     }
 }
 
-void modelMapProxy::createOverlay(WayPointItem *from, WayPointItem *to, modelMapProxy::overlayType type, QColor color, bool dashed, int width)
+QObject *modelMapProxy::createOverlay(WayPointItem *from, WayPointItem *to, modelMapProxy::overlayType type, QColor color, bool dashed, int width)
 {
     if (from == NULL || to == NULL || from == to) {
-        return;
+        return NULL;
     }
     switch (type) {
     case OVERLAY_LINE:
-        myMap->WPLineCreate(from, to, color, dashed, width);
-        break;
+        return myMap->WPLineCreate(from, to, color, dashed, width);
+
     case OVERLAY_CIRCLE_RIGHT:
-        myMap->WPCircleCreate(to, from, true, color, dashed, width);
-        break;
+        return myMap->WPCircleCreate(to, from, true, color, dashed, width);
+
     case OVERLAY_CIRCLE_LEFT:
-        myMap->WPCircleCreate(to, from, false, color, dashed, width);
-        break;
+        return myMap->WPCircleCreate(to, from, false, color, dashed, width);
+
     default:
-        break;
+        return NULL;
     }
 }
-void modelMapProxy::createOverlay(WayPointItem *from, HomeItem *to, modelMapProxy::overlayType type, QColor color, bool dashed, int width)
+QObject *modelMapProxy::createOverlay(WayPointItem *from, HomeItem *to, modelMapProxy::overlayType type, QColor color, bool dashed, int width)
 {
     if (from == NULL || to == NULL) {
-        return;
+        return NULL;
     }
     switch (type) {
     case OVERLAY_LINE:
-        myMap->WPLineCreate(to, from, color, dashed, width);
-        break;
+        return myMap->WPLineCreate(to, from, color, dashed, width);
+
     case OVERLAY_CIRCLE_RIGHT:
-        myMap->WPCircleCreate(to, from, true, color, dashed, width);
-        break;
+        return myMap->WPCircleCreate(to, from, true, color, dashed, width);
+
     case OVERLAY_CIRCLE_LEFT:
-        myMap->WPCircleCreate(to, from, false, color, dashed, width);
-        break;
+        return myMap->WPCircleCreate(to, from, false, color, dashed, width);
+
     default:
+        return NULL;
+    }
+}
+
+void modelMapProxy::deleteOverlays(OverlayList &list)
+{
+    foreach(QPointer<QObject> overlay, list) {
+        // overlays attached to a deleted waypoint are already gone
+        if (overlay) {
+            overlay->deleteLater();
+        }
+    }
+    list.clear();
+}
+
+/**
+ * Creates the overlays leading from the waypoint of a row to the waypoints it can continue at
+ */
+void modelMapProxy::createOverlays(int x)
+{
+    OverlayList &list = overlays[x];
+    WayPointItem *wp_current = findWayPointNumber(x);
+    WayPointItem *wp_next    = NULL;
+    int wp_jump  = model->data(model->index(x, flightDataModel::JUMPDESTINATION)).toInt() - 1;
+    int wp_error = model->data(model->index(x, flightDataModel::ERRORDESTINATION)).toInt() - 1;
+    overlayType wp_next_overlay  = overlayTranslate(model->data(model->index(x + 1, flightDataModel::MODE)).toInt());
+    overlayType wp_jump_overlay  = overlayTranslate(model->data(model->index(wp_jump, flightDataModel::MODE)).toInt());
+    overlayType wp_error_overlay = overlayTranslate(model->data(model->index(wp_error, flightDataModel::MODE)).toInt());
+
+    list.append(createOverlay(wp_current, findWayPointNumber(wp_error), wp_error_overlay, Qt::red, true, 1));
+    switch (model->data(model->index(x, flightDataModel::COMMAND)).toInt()) {
+    case MapDataDelegate::COMMAND_ONCONDITIONNEXTWAYPOINT:
+        wp_next = findWayPointNumber(x + 1);
+        list.append(createOverlay(wp_current, wp_next, wp_next_overlay, Qt::green));
+        break;
+    case MapDataDelegate::COMMAND_ONCONDITIONJUMPWAYPOINT:
+        wp_next = findWayPointNumber(wp_jump);
+        list.append(createOverlay(wp_current, wp_next, wp_jump_overlay, Qt::green));
+        break;
+    case MapDataDelegate::COMMAND_ONNOTCONDITIONJUMPWAYPOINT:
+        wp_next = findWayPointNumber(wp_jump);
+        list.append(createOverlay(wp_current, wp_next, wp_jump_overlay, Qt::yellow));
+        break;
+    case MapDataDelegate::COMMAND_ONNOTCONDITIONNEXTWAYPOINT:
+        wp_next = findWayPointNumber(x + 1);
+        list.append(createOverlay(wp_current, wp_next, wp_next_overlay, Qt::yellow));
+        break;
+    case MapDataDelegate::COMMAND_IFCONDITIONJUMPWAYPOINTELSENEXTWAYPOINT:
+        wp_next = findWayPointNumber(wp_jump);
+        list.append(createOverlay(wp_current, wp_next, wp_jump_overlay, Qt::green));
+        wp_next = findWayPointNumber(x + 1);
+        list.append(createOverlay(wp_current, wp_next, wp_next_overlay, Qt::green));
         break;
     }
 }
-void modelMapProxy::refreshOverlays()
+
+/**
+ * Marks the overlays of a row to be rebuilt once the model changes are done
+ */
+void modelMapProxy::invalidateOverlays(int row)
 {
-    myMap->deleteAllOverlays();
-    if (model->rowCount() < 1) {
+    if (row < 0 || row >= overlays.count()) {
         return;
     }
-    WayPointItem *wp_current = NULL;
-    WayPointItem *wp_next    = NULL;
-    int wp_jump;
-    int wp_error;
-    overlayType wp_next_overlay;
-    overlayType wp_jump_overlay;
-    overlayType wp_error_overlay;
-    wp_current = findWayPointNumber(0);
-    overlayType wp_current_overlay = overlayTranslate(model->data(model->index(0, flightDataModel::MODE)).toInt());
-    createOverlay(wp_current, myMap->Home, wp_current_overlay, Qt::green);
+    dirtyOverlays.insert(row);
+    overlayTimer.start();
+}
+
+/**
+ * Marks the overlays of the rows jumping to a waypoint, or to any waypoint after it
+ * when the rows were renumbered
+ */
+void modelMapProxy::invalidateOverlaysTo(int row, bool following)
+{
     for (int x = 0; x < model->rowCount(); ++x) {
-        wp_current = findWayPointNumber(x);
-        wp_jump    = model->data(model->index(x, flightDataModel::JUMPDESTINATION)).toInt() - 1;
-        wp_error   = model->data(model->index(x, flightDataModel::ERRORDESTINATION)).toInt() - 1;
-        wp_next_overlay  = overlayTranslate(model->data(model->index(x + 1, flightDataModel::MODE)).toInt());
-        wp_jump_overlay  = overlayTranslate(model->data(model->index(wp_jump, flightDataModel::MODE)).toInt());
-        wp_error_overlay = overlayTranslate(model->data(model->index(wp_error, flightDataModel::MODE)).toInt());
-        createOverlay(wp_current, findWayPointNumber(wp_error), wp_error_overlay, Qt::red, true, 1);
-        switch (model->data(model->index(x, flightDataModel::COMMAND)).toInt()) {
-        case MapDataDelegate::COMMAND_ONCONDITIONNEXTWAYPOINT:
-            wp_next = findWayPointNumber(x + 1);
-            createOverlay(wp_current, wp_next, wp_next_overlay, Qt::green);
-            break;
-        case MapDataDelegate::COMMAND_ONCONDITIONJUMPWAYPOINT:
-            wp_next = findWayPointNumber(wp_jump);
-            createOverlay(wp_current, wp_next, wp_jump_overlay, Qt::green);
-            break;
-        case MapDataDelegate::COMMAND_ONNOTCONDITIONJUMPWAYPOINT:
-            wp_next = findWayPointNumber(wp_jump);
-            createOverlay(wp_current, wp_next, wp_jump_overlay, Qt::yellow);
-            break;
-        case MapDataDelegate::COMMAND_ONNOTCONDITIONNEXTWAYPOINT:
-            wp_next = findWayPointNumber(x + 1);
-            createOverlay(wp_current, wp_next, wp_next_overlay, Qt::yellow);
-            break;
-        case MapDataDelegate::COMMAND_IFCONDITIONJUMPWAYPOINTELSENEXTWAYPOINT:
-            wp_next = findWayPointNumber(wp_jump);
-            createOverlay(wp_current, wp_next, wp_jump_overlay, Qt::green);
-            wp_next = findWayPointNumber(x + 1);
-            createOverlay(wp_current, wp_next, wp_next_overlay, Qt::green);
-            break;
+        int wp_jump  = model->data(model->index(x, flightDataModel::JUMPDESTINATION)).toInt() - 1;
+        int wp_error = model->data(model->index(x, flightDataModel::ERRORDESTINATION)).toInt() - 1;
+        if (wp_jump == row || wp_error == row || (following && (wp_jump > row || wp_error > row))) {
+            invalidateOverlays(x);
         }
     }
 }
 
-WayPointItem *modelMapProxy::findWayPointNumber(int number)
+void modelMapProxy::refreshOverlays()
 {
-    if (number < 0) {
-        return NULL;
+    deleteOverlays(homeOverlays);
+    if (model->rowCount() > 0) {
+        overlayType wp_current_overlay = overlayTranslate(model->data(model->index(0, flightDataModel::MODE)).toInt());
+        homeOverlays.append(createOverlay(findWayPointNumber(0), myMap->Home, wp_current_overlay, Qt::green));
     }
-    return myMap->WPFind(number);
+    foreach(int x, dirtyOverlays) {
+        if (x < overlays.count()) {
+            deleteOverlays(overlays[x]);
+            createOverlays(x);
+        }
+    }
+    dirtyOverlays.clear();
+}
+
+WayPointItem *modelMapProxy::findWayPointNumber(int number)
+{
+    return wayPoints.value(number, NULL);
 }
 
 void modelMapProxy::rowsRemoved(const QModelIndex &parent, int first, int last)
 {
     Q_UNUSED(parent);
 
+    int count = last - first + 1;
+    QSet<int> dirty;
+    foreach(int x, dirtyOverlays) {
+        if (x < first) {
+            dirty.insert(x);
+        } else if (x > last) {
+            dirty.insert(x - count);
+        }
+    }
+    dirtyOverlays = dirty;
+
     for (int x = last; x > first - 1; x--) {
-        myMap->WPDelete(x);
+        deleteOverlays(overlays[x]);
+        overlays.removeAt(x);
+        myMap->WPDelete(wayPoints.takeAt(x));
     }
-    refreshOverlays();
+    invalidateOverlays(first - 1);
+    invalidateOverlaysTo(first, true);
+    overlayTimer.start();
 }
 
 void modelMapProxy::dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
 {
-    Q_UNUSED(bottomRight);
-
-    WayPointItem *item = findWayPointNumber(topLeft.row());
-    if (!item) {
-        return;
+    for (int x = topLeft.row(); x <= bottomRight.row(); ++x) {
+        WayPointItem *item = findWayPointNumber(x);
+        if (!item) {
+            continue;
+        }
+        for (int column = topLeft.column(); column <= bottomRight.column(); ++column) {
+            updateWayPoint(item, x, column);
+        }
     }
+}
+
+void modelMapProxy::updateWayPoint(WayPointItem *item, int x, int column)
+{
     internals::PointLatLng latlng;
-    int x = topLeft.row();
     distBearingAltitude distBearing;
     double altitude;
     bool relative;
     QModelIndex index;
     QString desc;
-    switch (topLeft.column()) {
+
+    switch (column) {
     case flightDataModel::COMMAND:
     case flightDataModel::CONDITION:
     case flightDataModel::JUMPDESTINATION:
     case flightDataModel::ERRORDESTINATION:
+        invalidateOverlays(x);
+        break;
     case flightDataModel::MODE:
-        refreshOverlays();
+        // the mode is drawn by the overlays leading to this waypoint
+        invalidateOverlays(x - 1);
+        invalidateOverlaysTo(x, false);
+        overlayTimer.start();
         break;
     case flightDataModel::WPDESCRIPTION:
         index = model->index(x, flightDataModel::WPDESCRIPTION);
@@ -298,6 +370,13 @@ void modelMapProxy::rowsInserted(const QModelIndex &parent, int first, int last)
 {
     Q_UNUSED(parent);
 
+    int count = last - first + 1;
+    QSet<int> dirty;
+    foreach(int x, dirtyOverlays) {
+        dirty.insert(x < first ? x : x + count);
+    }
+    dirtyOverlays = dirty;
+
     for (int x = first; x < last + 1; x++) {
         QModelIndex index;
         internals::PointLatLng latlng;
@@ -321,13 +400,17 @@ void modelMapProxy::rowsInserted(const QModelIndex &parent, int first, int last)
         index    = model->index(x, flightDataModel::ALTITUDE);
         altitude = index.data(Qt::DisplayRole).toDouble();
         if (relative) {
-            myMap->WPInsert(distBearing, desc, x);
+            wayPoints.insert(x, myMap->WPInsert(distBearing, desc, x));
         } else {
-            myMap->WPInsert(latlng, altitude, desc, x);
+            wayPoints.insert(x, myMap->WPInsert(latlng, altitude, desc, x));
         }
+        overlays.insert(x, OverlayList());
     }
 
-    refreshOverlays();
+    for (int x = first - 1; x < last + 1; x++) {
+        invalidateOverlays(x);
+    }
+    invalidateOverlaysTo(first, true);
 }
 void modelMapProxy::deleteWayPoint(int number)
 {
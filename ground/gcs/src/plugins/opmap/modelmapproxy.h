@@ -34,6 +34,8 @@
 #include "QPointer"
 #include "flightdatamodel.h"
 #include <QItemSelectionModel>
+#include <QTimer>
+#include <QSet>
 #include <widgetdelegates.h>
 
 
@@ -54,14 +56,29 @@ private slots:
     void WPValuesChanged(WayPointItem *wp);
     void currentRowChanged(QModelIndex, QModelIndex);
     void selectedWPChanged(QList<WayPointItem *>);
+    void refreshOverlays();
 private:
+    typedef QList<QPointer<QObject> > OverlayList;
+
     overlayType overlayTranslate(int type);
-    void createOverlay(WayPointItem *from, WayPointItem *to, overlayType type, QColor color, bool dashed = false, int width = -1);
-    void createOverlay(WayPointItem *from, HomeItem *to, modelMapProxy::overlayType type, QColor color, bool dashed = false, int width = -1);
+    QObject *createOverlay(WayPointItem *from, WayPointItem *to, overlayType type, QColor color, bool dashed = false, int width = -1);
+    QObject *createOverlay(WayPointItem *from, HomeItem *to, modelMapProxy::overlayType type, QColor color, bool dashed = false, int width = -1);
     OPMapWidget *myMap;
     flightDataModel *model;
-    void refreshOverlays();
+    void updateWayPoint(WayPointItem *item, int row, int column);
+    void invalidateOverlays(int row);
+    void invalidateOverlaysTo(int row, bool following);
+    void createOverlays(int row);
+    void deleteOverlays(OverlayList &list);
     QItemSelectionModel *selection;
+    // map item of each row of the model
+    QList<WayPointItem *> wayPoints;
+    // overlays drawn from each waypoint, rebuilt only for the rows that changed
+    QList<OverlayList> overlays;
+    OverlayList homeOverlays;
+    QSet<int> dirtyOverlays;
+    // the changes are applied to the overlays once the model is done changing
+    QTimer overlayTimer;
 };
 
 #endif // MODELMAPPROXY_H
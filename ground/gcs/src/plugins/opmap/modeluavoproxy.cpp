@@ -28,11 +28,12 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjecthelper.h"
 #include "uavobjectmanager.h"
+#include "uavtalk/telemetrymanager.h"
 
 #include <QProgressDialog>
 #include <math.h>
 
-ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObject(parent), myModel(model)
+ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObject(parent), myModel(model), m_synced(false)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
 
@@ -40,18 +41,79 @@ ModelUavoProxy::ModelUavoProxy(QObject *parent, flightDataModel *model) : QObjec
 
     objMngr = pm->getObject<UAVObjectManager>();
     Q_ASSERT(objMngr != NULL);
+
+    // another board may be connected next
+    TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
+    if (telMngr) {
+        connect(telMngr, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+    }
+    memset(&m_syncedPlan, 0, sizeof(m_syncedPlan));
+}
+
+void ModelUavoProxy::onDisconnected()
+{
+    m_synced = false;
+}
+
+/**
+ * Returns true if the board holds the path plan last sent or received, the PathPlan object is requested from the board
+ */
+bool ModelUavoProxy::isBoardSynced(PathPlan *pathPlan)
+{
+    if (!m_synced) {
+        return false;
+    }
+    UAVObjectRequestHelper requestHelper;
+    if (requestHelper.doObjectAndWait(pathPlan) != UAVObjectRequestHelper::SUCCESS) {
+        return false;
+    }
+    PathPlan::DataFields pathPlanData = pathPlan->getData();
+    return memcmp(&pathPlanData, &m_syncedPlan, sizeof(pathPlanData)) == 0;
+}
+
+/**
+ * Record whether the board and the objects hold the same path plan as the model
+ */
+void ModelUavoProxy::setBoardSynced(bool synced)
+{
+    m_synced = synced;
+    if (synced) {
+        m_syncedPlan = PathPlan::GetInstance(objMngr)->getData();
+        myModel->setClean();
+    }
 }
 
 void ModelUavoProxy::sendPathPlan()
 {
-    modelToObjects();
+    PathPlan *pathPlan = PathPlan::GetInstance(objMngr);
 
-    PathPlan *pathPlan      = PathPlan::GetInstance(objMngr);
+    // only the changed instances are sent if the board still holds the last synchronized path plan
+    bool incremental = isBoardSynced(pathPlan);
+
+    if (incremental && !myModel->isDirty()) {
+        qDebug() << "ModelUavoProxy::sendPathPlan - the board is up to date";
+        return;
+    }
+
+    QList<int> changedWaypoints;
+    QList<int> changedActions;
+    modelToObjects(changedWaypoints, changedActions);
 
     const int waypointCount = pathPlan->getWaypointCount();
     const int actionCount   = pathPlan->getPathActionCount();
 
-    QProgressDialog progress(tr("Sending the path plan to the board... "), "", 0, 1 + waypointCount + actionCount);
+    if (!incremental) {
+        changedWaypoints.clear();
+        changedActions.clear();
+        for (int i = 0; i < waypointCount; ++i) {
+            changedWaypoints << i;
+        }
+        for (int i = 0; i < actionCount; ++i) {
+            changedActions << i;
+        }
+    }
+
+    QProgressDialog progress(tr("Sending the path plan to the board... "), "", 0, 1 + changedWaypoints.size() + changedActions.size());
     progress.setWindowModality(Qt::WindowModal);
     progress.setCancelButton(NULL);
     progress.show();
@@ -64,31 +126,18 @@ void ModelUavoProxy::sendPathPlan()
 
     if (success) {
         // send Waypoint instances
-        qDebug() << "sending" << waypointCount << "waypoints";
-        for (int i = 0; i < waypointCount; ++i) {
-            Waypoint *waypoint = Waypoint::GetInstance(objMngr, i);
-            success = (updateHelper.doObjectAndWait(waypoint) == UAVObjectUpdaterHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
-        }
+        qDebug() << "sending" << changedWaypoints.size() << "of" << waypointCount << "waypoints";
+        success = sendInstances(Waypoint::OBJID, changedWaypoints, progress);
     }
 
     if (success) {
         // send PathAction instances
-        qDebug() << "sending" << actionCount << "path actions";
-        for (int i = 0; i < actionCount; ++i) {
-            PathAction *action = PathAction::GetInstance(objMngr, i);
-            success = (updateHelper.doObjectAndWait(action) == UAVObjectUpdaterHelper::SUCCESS);
-            if (!success) {
-                break;
-            }
-            progress.setValue(progress.value() + 1);
-        }
+        qDebug() << "sending" << changedActions.size() << "of" << actionCount << "path actions";
+        success = sendInstances(PathAction::OBJID, changedActions, progress);
     }
 
     qDebug() << "ModelUavoProxy::pathPlanSent - completed" << success;
+    setBoardSynced(success);
     if (!success) {
         QMessageBox::critical(NULL, tr("Sending Path Plan Failed!"), tr("Failed to send the path plan to the board."));
     }
@@ -96,6 +145,40 @@ void ModelUavoProxy::sendPathPlan()
     progress.close();
 }
 
+/**
+ * Send the given instances of an object, each in its own transaction or, when they are many,
+ * all the instances in one transaction (packed several instances per frame and acked once per frame on v2 links)
+ */
+bool ModelUavoProxy::sendInstances(quint32 objId, const QList<int> &instances, QProgressDialog &progress)
+{
+    int count = objMngr->getNumInstances(objId);
+
+    if (instances.isEmpty()) {
+        return true;
+    }
+    if (instances.size() * 2 > count) {
+        UAVObjectUpdaterHelper allInstancesHelper(NULL, true);
+        bool success = (allInstancesHelper.doObjectAndWait(objMngr->getObject(objId, 0),
+                                                           transferTimeout(count)) == UAVObjectUpdaterHelper::SUCCESS);
+        progress.setValue(progress.value() + instances.size());
+        return success;
+    }
+
+    UAVObjectUpdaterHelper updateHelper;
+    foreach(int i, instances) {
+        if (updateHelper.doObjectAndWait(objMngr->getObject(objId, i)) != UAVObjectUpdaterHelper::SUCCESS) {
+            return false;
+        }
+        progress.setValue(progress.value() + 1);
+    }
+    return true;
+}
+
+int ModelUavoProxy::transferTimeout(int instanceCount)
+{
+    return TRANSFER_TIMEOUT_MS + instanceCount * INSTANCE_TIMEOUT_MS;
+}
+
 void ModelUavoProxy::receivePathPlan()
 {
     QProgressDialog progress(tr("Receiving the path plan from the board... "), "", 0, 0);
@@ -112,16 +195,24 @@ void ModelUavoProxy::receivePathPlan()
     const int waypointCount = pathPlan->getWaypointCount();
     const int actionCount   = pathPlan->getPathActionCount();
 
-    progress.setMaximum(1 + waypointCount + actionCount);
+    // the objects already hold the path plan of the board if it did not change since the last synchronization
+    PathPlan::DataFields pathPlanData = pathPlan->getData();
+    bool upToDate = success && m_synced && memcmp(&pathPlanData, &m_syncedPlan, sizeof(pathPlanData)) == 0;
+
+    progress.setMaximum(1 + (upToDate ? 0 : waypointCount + actionCount));
     progress.setValue(1);
 
-    if (success && (waypointCount > objMngr->getNumInstances(Waypoint::OBJID))) {
+    if (upToDate) {
+        qDebug() << "ModelUavoProxy::receivePathPlan - the path plan did not change on the board";
+    }
+
+    if (success && !upToDate && (waypointCount > objMngr->getNumInstances(Waypoint::OBJID))) {
         // allocate needed Waypoint instances
         Waypoint *waypoint = new Waypoint;
         waypoint->initialize(waypointCount - 1, waypoint->getMetaObject());
         success = objMngr->registerObject(waypoint);
     }
-    if (success) {
+    if (success && !upToDate) {
         // request Waypoint instances
         qDebug() << "requesting" << waypointCount << "waypoints";
         for (int i = 0; i < waypointCount; ++i) {
@@ -134,13 +225,13 @@ void ModelUavoProxy::receivePathPlan()
         }
     }
 
-    if (success && (actionCount > objMngr->getNumInstances(PathAction::OBJID))) {
+    if (success && !upToDate && (actionCount > objMngr->getNumInstances(PathAction::OBJID))) {
         // allocate needed PathAction instances
         PathAction *action = new PathAction;
         action->initialize(actionCount - 1, action->getMetaObject());
         success = objMngr->registerObject(action);
     }
-    if (success) {
+    if (success && !upToDate) {
         // request PathAction isntances
         qDebug() << "requesting" << actionCount << "path actions";
         for (int i = 0; i < actionCount; ++i) {
@@ -155,8 +246,10 @@ void ModelUavoProxy::receivePathPlan()
 
     qDebug() << "ModelUavoProxy::pathPlanReceived - completed" << success;
     if (success) {
-        objectsToModel();
+        // objectsToModel() reports its own errors
+        setBoardSynced(objectsToModel());
     } else {
+        setBoardSynced(false);
         QMessageBox::critical(NULL, tr("Receiving Path Plan Failed!"), tr("Failed to receive the path plan from the board."));
     }
 
@@ -173,7 +266,9 @@ void ModelUavoProxy::receivePathPlan()
 // (compression consists in keeping only one instance of similar path actions)
 //
 // the UAV waypoint list and path action list are probably not empty, so we try to reuse existing instances
-bool ModelUavoProxy::modelToObjects()
+//
+// the instances that were created or whose data changed are listed in changedWaypoints and changedActions
+bool ModelUavoProxy::modelToObjects(QList<int> &changedWaypoints, QList<int> &changedActions)
 {
     qDebug() << "ModelUAVProxy::modelToObjects";
 
@@ -195,17 +290,18 @@ bool ModelUavoProxy::modelToObjects()
 
         // see if that path action has already been added in this run
         PathAction *foundAction = findPathAction(actionData, actionCount);
-        // TODO this test needs a consistency check as it is unsafe.
-        // if the find method is buggy and returns false positives then the flight plan sent to the uav is broken!
-        // the find method should do a "binary" compare instead of a field by field compare
-        // if a field is added everywhere and not in the compare method then you can start having false positives
         if (!foundAction) {
             // create or reuse an action instance
+            bool created = (actionCount >= (int)objMngr->getNumInstances(PathAction::OBJID));
             action = createPathAction(actionCount, action);
             actionCount++;
 
             // update UAVObject
-            action->setData(actionData);
+            PathAction::DataFields oldActionData = action->getData();
+            if (created || memcmp(&oldActionData, &actionData, sizeof(actionData)) != 0) {
+                action->setData(actionData);
+                changedActions << action->getInstID();
+            }
         } else {
             action->deleteLater();
             action = foundAction;
@@ -215,18 +311,23 @@ bool ModelUavoProxy::modelToObjects()
         // Waypoints
 
         // create or reuse a waypoint instance
+        bool created = (i >= (int)objMngr->getNumInstances(Waypoint::OBJID));
         Waypoint *waypoint = createWaypoint(i, NULL);
         Q_ASSERT(waypoint);
 
         // get model data
-        Waypoint::DataFields waypointData = waypoint->getData();
+        Waypoint::DataFields oldWaypointData = waypoint->getData();
+        Waypoint::DataFields waypointData    = oldWaypointData;
         modelToWaypoint(i, waypointData);
 
         // connect waypoint to path action
         waypointData.Action = action->getInstID();
 
-        // update UAVObject
-        waypoint->setData(waypointData);
+        // update UAVObject, a clean row can still change when the index of its path action moves
+        if (created || memcmp(&oldWaypointData, &waypointData, sizeof(waypointData)) != 0) {
+            waypoint->setData(waypointData);
+            changedWaypoints << i;
+        }
     }
 
     // Put "safe" values in unused waypoint and path action objects
@@ -317,17 +418,9 @@ PathAction *ModelUavoProxy::findPathAction(const PathAction::DataFields &actionD
         if (!action) {
             continue;
         }
+        // binary compare, so that no field can be forgotten (DataFields is packed)
         PathAction::DataFields fields = action->getData();
-        if (fields.Command == actionData.Command
-            && fields.ConditionParameters[0] == actionData.ConditionParameters[0]
-            && fields.ConditionParameters[1] == actionData.ConditionParameters[1]
-            && fields.ConditionParameters[2] == actionData.ConditionParameters[2]
-            && fields.EndCondition == actionData.EndCondition
-            && fields.ErrorDestination == actionData.ErrorDestination
-            && fields.JumpDestination == actionData.JumpDestination && fields.Mode == actionData.Mode
-            && fields.ModeParameters[0] == actionData.ModeParameters[0]
-            && fields.ModeParameters[1] == actionData.ModeParameters[1]
-            && fields.ModeParameters[2] == actionData.ModeParameters[2]) {
+        if (memcmp(&fields, &actionData, sizeof(fields)) == 0) {
             return action;
         }
     }
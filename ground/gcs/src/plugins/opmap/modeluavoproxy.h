@@ -34,6 +34,9 @@
 #include "waypoint.h"
 
 #include <QObject>
+#include <QList>
+
+class QProgressDialog;
 
 class ModelUavoProxy : public QObject {
     Q_OBJECT
@@ -45,11 +48,27 @@ public slots:
     void sendPathPlan();
     void receivePathPlan();
 
+private slots:
+    void onDisconnected();
+
 private:
+    // timeout of an all instances transfer: base plus the time allowed per instance
+    static const int TRANSFER_TIMEOUT_MS = 800;
+    static const int INSTANCE_TIMEOUT_MS = 50;
+
     UAVObjectManager *objMngr;
     flightDataModel *myModel;
 
-    bool modelToObjects();
+    // the board and the objects hold the path plan m_syncedPlan, as last sent or received
+    bool m_synced;
+    PathPlan::DataFields m_syncedPlan;
+
+    static int transferTimeout(int instanceCount);
+    bool sendInstances(quint32 objId, const QList<int> &instances, QProgressDialog &progress);
+    bool isBoardSynced(PathPlan *pathPlan);
+    void setBoardSynced(bool synced);
+
+    bool modelToObjects(QList<int> &changedWaypoints, QList<int> &changedActions);
     bool objectsToModel();
 
     Waypoint *createWaypoint(int index, Waypoint *newWaypoint);
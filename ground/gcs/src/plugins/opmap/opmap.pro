@@ -1,7 +1,7 @@
 TEMPLATE = lib
 TARGET = OPMapGadget
 
-QT += widgets xml
+QT += widgets xml concurrent
 
 PATHPLANNER {
     DEFINES += USE_PATHPLANNER
@@ -30,7 +30,9 @@ HEADERS += \
     widgetdelegates.h \
     pathplanner.h \
     modeluavoproxy.h \
-    homeeditor.h
+    homeeditor.h \
+    surveygenerator.h \
+    surveydialog.h
 
 SOURCES += \
     opmapplugin.cpp \
@@ -47,7 +49,9 @@ SOURCES += \
     widgetdelegates.cpp \
     pathplanner.cpp \
     modeluavoproxy.cpp \
-    homeeditor.cpp
+    homeeditor.cpp \
+    surveygenerator.cpp \
+    surveydialog.cpp
 
 OTHER_FILES += OPMapGadget.pluginspec
 
@@ -59,6 +63,7 @@ FORMS += \
     opmap_statusbar_widget.ui \
     opmap_overlay_widget.ui \
     pathplanner.ui \
-    homeeditor.ui
+    homeeditor.ui \
+    surveydialog.ui
 
 RESOURCES += opmap.qrc
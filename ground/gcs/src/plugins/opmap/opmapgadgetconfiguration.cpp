@@ -55,6 +55,8 @@ OPMapGadgetConfiguration::OPMapGadgetConfiguration(QString classId, QSettings &s
     m_useMemoryCache = settings.value("useMemoryCache").toBool();
     m_cacheLocation  = settings.value("cacheLocation", Utils::GetStoragePath() + "mapscache" + QDir::separator()).toString();
     m_cacheLocation  = Utils::InsertStoragePath(m_cacheLocation);
+    // no default here, an empty url keeps the map library default
+    m_vectorTileUrl  = settings.value("vectorTileUrl").toString();
 }
 
 OPMapGadgetConfiguration::OPMapGadgetConfiguration(const OPMapGadgetConfiguration &obj) :
@@ -69,6 +71,7 @@ OPMapGadgetConfiguration::OPMapGadgetConfiguration(const OPMapGadgetConfiguratio
     m_accessMode = obj.m_accessMode;
     m_useMemoryCache    = obj.m_useMemoryCache;
     m_cacheLocation     = obj.m_cacheLocation;
+    m_vectorTileUrl     = obj.m_vectorTileUrl;
     m_uavSymbol = obj.m_uavSymbol;
     m_maxUpdateRate     = obj.m_maxUpdateRate;
     m_safeAreaRadius    = obj.m_safeAreaRadius;
@@ -102,6 +105,7 @@ void OPMapGadgetConfiguration::saveConfig(QSettings &settings) const
     settings.setValue("useMemoryCache", m_useMemoryCache);
     settings.setValue("uavSymbol", m_uavSymbol);
     settings.setValue("cacheLocation", Utils::RemoveStoragePath(m_cacheLocation));
+    settings.setValue("vectorTileUrl", m_vectorTileUrl);
     settings.setValue("maxUpdateRate", m_maxUpdateRate);
     settings.setValue("safeAreaRadius", m_safeAreaRadius);
     settings.setValue("showSafeArea", m_showSafeArea);
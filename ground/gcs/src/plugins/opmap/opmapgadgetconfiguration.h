@@ -44,6 +44,7 @@ class OPMapGadgetConfiguration : public IUAVGadgetConfiguration {
     Q_PROPERTY(QString accessMode READ accessMode WRITE setAccessMode)
     Q_PROPERTY(bool useMemoryCache READ useMemoryCache WRITE setUseMemoryCache)
     Q_PROPERTY(QString cacheLocation READ cacheLocation WRITE setCacheLocation)
+    Q_PROPERTY(QString vectorTileUrl READ vectorTileUrl WRITE setVectorTileUrl)
     Q_PROPERTY(QString uavSymbol READ uavSymbol WRITE setUavSymbol)
     Q_PROPERTY(int maxUpdateRate READ maxUpdateRate WRITE setMaxUpdateRate)
     Q_PROPERTY(int safeAreaRadius READ safeAreaRadius WRITE setSafeAreaRadius)
@@ -97,6 +98,10 @@ public:
     {
         return m_cacheLocation;
     }
+    QString vectorTileUrl() const
+    {
+        return m_vectorTileUrl;
+    }
     QString uavSymbol() const
     {
         return m_uavSymbol;
@@ -166,6 +171,10 @@ public slots:
         m_useMemoryCache = useMemoryCache;
     }
     void setCacheLocation(QString cacheLocation);
+    void setVectorTileUrl(QString url)
+    {
+        m_vectorTileUrl = url;
+    }
     void setUavSymbol(QString symbol)
     {
         m_uavSymbol = symbol;
@@ -203,6 +212,7 @@ private:
     QString m_accessMode;
     bool m_useMemoryCache;
     QString m_cacheLocation;
+    QString m_vectorTileUrl;
     QString m_uavSymbol;
     int m_maxUpdateRate;
     int m_safeAreaRadius;
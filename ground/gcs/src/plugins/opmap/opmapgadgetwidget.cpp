@@ -79,6 +79,12 @@ const int uav_trail_distance_list[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500 }; //
 
 const int max_update_rate_list[] = { 100, 200, 500, 1000, 2000, 5000 }; // milliseconds
 
+// smallest changes of the vehicle state redrawn on the map
+const double position_deadband = 1e-6; // degrees, about 0.1 meter
+const double altitude_deadband = 0.1; // meters
+const double heading_deadband  = 0.5; // degrees
+const double speed_deadband    = 0.1; // meters per second
+
 // *************************************************************************************
 
 
@@ -103,11 +109,16 @@ OPMapGadgetWidget::OPMapGadgetWidget(QWidget *parent) : QWidget(parent)
     obum = NULL;
 
     m_prev_tile_number = 0;
+    m_nextVehicleId    = 1;
 
     m_min_zoom = m_max_zoom = 0;
 
     m_map_mode = Normal_MapMode;
 
+    m_updateTimer       = NULL;
+    m_statusUpdateTimer = NULL;
+    m_drawnState.valid  = false;
+
     m_maxUpdateRate = max_update_rate_list[4]; // 2 seconds //SHOULDN'T THIS BE LOADED FROM THE USER PREFERENCES?
 
     m_telemetry_connected  = false;
@@ -231,6 +242,7 @@ OPMapGadgetWidget::OPMapGadgetWidget(QWidget *parent) : QWidget(parent)
     selectionModel = new QItemSelectionModel(model);
     mapProxy = new modelMapProxy(this, m_map, model, selectionModel);
     table->setModel(model, selectionModel);
+    table->setHome(m_map->Home);
     waypoint_edit_dialog = new opmap_edit_waypoint_dialog(this, model, selectionModel);
     UAVProxy = new ModelUavoProxy(this, model);
     // sending and receiving is asynchronous
@@ -258,6 +270,18 @@ OPMapGadgetWidget::OPMapGadgetWidget(QWidget *parent) : QWidget(parent)
             if (obj) {
                 connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(homePositionUpdated(UAVObject *)));
             }
+
+            // Redraw the vehicle when its state changes instead of polling it
+            QStringList stateObjects;
+            stateObjects << "PositionState" << "AttitudeState" << "VelocityState" << "AirspeedState"
+                         << "GPSPositionSensor" << "PathDesired" << "HomeLocation";
+            foreach(QString name, stateObjects) {
+                UAVObject *stateObj = obm->getObject(name);
+
+                if (stateObj) {
+                    connect(stateObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(schedulePositionUpdate()));
+                }
+            }
         }
 
         // Listen to telemetry connection events
@@ -265,21 +289,34 @@ OPMapGadgetWidget::OPMapGadgetWidget(QWidget *parent) : QWidget(parent)
         if (telMngr) {
             connect(telMngr, SIGNAL(connected()), this, SLOT(onTelemetryConnect()));
             connect(telMngr, SIGNAL(disconnected()), this, SLOT(onTelemetryDisconnect()));
+            // the other vehicles go to the vehicles overlay
+            connect(telMngr, SIGNAL(connectionAdded(TelemetryConnection *)), this, SLOT(onTelemetryConnectionAdded(TelemetryConnection *)));
+            connect(telMngr, SIGNAL(connectionRemoved(TelemetryConnection *)), this, SLOT(onTelemetryConnectionRemoved(TelemetryConnection *)));
+            foreach(TelemetryConnection * connection, telMngr->connections()) {
+                if (connection != telMngr->primaryConnection()) {
+                    onTelemetryConnectionAdded(connection);
+                }
+            }
         }
     }
 
     // **************
     // create the desired timers
 
+    m_lastPositionUpdate.start();
     m_updateTimer = new QTimer();
-    m_updateTimer->setInterval(m_maxUpdateRate);
+    m_updateTimer->setSingleShot(true);
     connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(updatePosition()));
-    m_updateTimer->start();
+    schedulePositionUpdate();
 
+    // the mouse position is refreshed when the mouse or the map moves
     m_statusUpdateTimer = new QTimer();
     m_statusUpdateTimer->setInterval(200);
+    m_statusUpdateTimer->setSingleShot(true);
     connect(m_statusUpdateTimer, SIGNAL(timeout()), this, SLOT(updateMousePos()));
-    m_statusUpdateTimer->start();
+    connect(m_map, SIGNAL(OnCurrentPositionChanged(internals::PointLatLng)), m_statusUpdateTimer, SLOT(start()));
+    connect(m_map, SIGNAL(zoomChanged(double, double, double)), m_statusUpdateTimer, SLOT(start()));
+    m_map->viewport()->installEventFilter(this);
     // **************
 
     m_map->setFocus();
@@ -334,6 +371,14 @@ void OPMapGadgetWidget::mouseMoveEvent(QMouseEvent *event)
     if (event->buttons() & Qt::LeftButton) {}
     QWidget::mouseMoveEvent(event);
 }
+bool OPMapGadgetWidget::eventFilter(QObject *obj, QEvent *event)
+{
+    if (event->type() == QEvent::MouseMove && m_statusUpdateTimer && !m_statusUpdateTimer->isActive()) {
+        m_statusUpdateTimer->start();
+    }
+    return QWidget::eventFilter(obj, event);
+}
+
 void OPMapGadgetWidget::wpDoubleClickEvent(WayPointItem *wp)
 {
     m_mouse_waypoint = wp;
@@ -570,13 +615,26 @@ void OPMapGadgetWidget::closeEvent(QCloseEvent *event)
 // timer signals
 
 /**
-   Updates the UAV position on the map. It is called at a user-defined frequency,
-   as set inside the map widget.
+   Schedules an update of the UAV position on the map. The object updates are
+   coalesced so that the map is redrawn at most at the user-defined frequency.
+ */
+void OPMapGadgetWidget::schedulePositionUpdate()
+{
+    if (!m_updateTimer || m_updateTimer->isActive()) {
+        return;
+    }
+    m_updateTimer->start(qMax(0, m_maxUpdateRate - (int)m_lastPositionUpdate.elapsed()));
+}
+
+/**
+   Updates the UAV position on the map. Changes below the dead-bands are not
+   redrawn, so that a stationary vehicle costs nothing.
  */
 void OPMapGadgetWidget::updatePosition()
 {
     double uav_latitude, uav_longitude, uav_altitude, uav_yaw;
     double gps_latitude, gps_longitude, gps_altitude, gps_heading;
+    double nav_latitude = 0, nav_longitude = 0, nav_altitude = 0;
 
     internals::PointLatLng uav_pos;
     internals::PointLatLng gps_pos;
@@ -587,6 +645,8 @@ void OPMapGadgetWidget::updatePosition()
 
     QMutexLocker locker(&m_map_mutex);
 
+    m_lastPositionUpdate.restart();
+
     // *************
     // get the current UAV details
 
@@ -639,6 +699,46 @@ void OPMapGadgetWidget::updatePosition()
     double NED[3]  = { positionStateData.North, positionStateData.East, positionStateData.Down };
     double vNED[3] = { velocityStateData.North, velocityStateData.East, velocityStateData.Down };
 
+    if (m_map->Nav) {
+        getNavPosition(nav_latitude, nav_longitude, nav_altitude);
+    }
+
+    // *************
+    // skip the redraw if nothing visibly changed
+
+    if (m_drawnState.valid &&
+        fabs(uav_latitude - m_drawnState.latitude) < position_deadband &&
+        fabs(uav_longitude - m_drawnState.longitude) < position_deadband &&
+        fabs(uav_altitude - m_drawnState.altitude) < altitude_deadband &&
+        fabs(uav_yaw - m_drawnState.yaw) < heading_deadband &&
+        fabs(vNED[0] - m_drawnState.vNED[0]) < speed_deadband &&
+        fabs(vNED[1] - m_drawnState.vNED[1]) < speed_deadband &&
+        fabs(vNED[2] - m_drawnState.vNED[2]) < speed_deadband &&
+        fabs(airspeedStateData.CalibratedAirspeed - m_drawnState.airspeed) < speed_deadband &&
+        gpsPositionData.Latitude == m_drawnState.gpsLatitude &&
+        gpsPositionData.Longitude == m_drawnState.gpsLongitude &&
+        fabs(gpsPositionData.Heading - m_drawnState.gpsHeading) < heading_deadband &&
+        nav_latitude == m_drawnState.navLatitude &&
+        nav_longitude == m_drawnState.navLongitude &&
+        nav_altitude == m_drawnState.navAltitude) {
+        return;
+    }
+    m_drawnState.valid        = true;
+    m_drawnState.latitude     = uav_latitude;
+    m_drawnState.longitude    = uav_longitude;
+    m_drawnState.altitude     = uav_altitude;
+    m_drawnState.yaw          = uav_yaw;
+    m_drawnState.vNED[0]      = vNED[0];
+    m_drawnState.vNED[1]      = vNED[1];
+    m_drawnState.vNED[2]      = vNED[2];
+    m_drawnState.airspeed     = airspeedStateData.CalibratedAirspeed;
+    m_drawnState.gpsLatitude  = gpsPositionData.Latitude;
+    m_drawnState.gpsLongitude = gpsPositionData.Longitude;
+    m_drawnState.gpsHeading   = gpsPositionData.Heading;
+    m_drawnState.navLatitude  = nav_latitude;
+    m_drawnState.navLongitude = nav_longitude;
+    m_drawnState.navAltitude  = nav_altitude;
+
     // Set the position and heading estimates in the painter module
     m_map->UAV->SetNED(NED);
     m_map->UAV->SetCAS(airspeedStateData.CalibratedAirspeed);
@@ -675,17 +775,12 @@ void OPMapGadgetWidget::updatePosition()
         m_map->GPS->SetUAVHeading(gps_heading); // set the maps GPS heading
         m_map->GPS->update();
     }
-    m_map->UAV->updateTextOverlay();
-    m_map->UAV->update();
-    // *************
 
     // *************
     // update active waypoint position at same update rate
     if (m_map->Nav) {
-        double latitude, longitude, altitude;
-        getNavPosition(latitude, longitude, altitude);
-        m_map->Nav->SetCoord(internals::PointLatLng(latitude, longitude)); // set the maps Nav position
-        m_map->Nav->SetAltitude(altitude);
+        m_map->Nav->SetCoord(internals::PointLatLng(nav_latitude, nav_longitude)); // set the maps Nav position
+        m_map->Nav->SetAltitude(nav_altitude);
         m_map->Nav->RefreshPos();
         m_map->Nav->update();
     }
@@ -694,8 +789,8 @@ void OPMapGadgetWidget::updatePosition()
 }
 
 /**
-   Update plugin behaviour based on mouse position; Called every few ms by a
-   timer.
+   Update plugin behaviour based on mouse position; Called a few ms after the
+   mouse or the map moved.
  */
 void OPMapGadgetWidget::updateMousePos()
 {
@@ -984,6 +1079,50 @@ void OPMapGadgetWidget::onTelemetryDisconnect()
     m_telemetry_connected = false;
 }
 
+void OPMapGadgetWidget::onTelemetryConnectionAdded(TelemetryConnection *connection)
+{
+    PositionState *positionState = PositionState::GetInstance(connection->objectManager());
+
+    if (!positionState || m_vehicleIds.contains(positionState)) {
+        return;
+    }
+    m_vehicleIds.insert(positionState, m_nextVehicleId++);
+    m_vehicleManagers.insert(positionState, connection->objectManager());
+    connect(positionState, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(onVehicleUpdated(UAVObject *)));
+}
+
+void OPMapGadgetWidget::onTelemetryConnectionRemoved(TelemetryConnection *connection)
+{
+    PositionState *positionState = PositionState::GetInstance(connection->objectManager());
+
+    if (!positionState || !m_vehicleIds.contains(positionState)) {
+        return;
+    }
+    positionState->disconnect(this);
+    if (m_map) {
+        m_map->Vehicles->RemoveVehicle(m_vehicleIds.value(positionState));
+    }
+    m_vehicleIds.remove(positionState);
+    m_vehicleManagers.remove(positionState);
+}
+
+void OPMapGadgetWidget::onVehicleUpdated(UAVObject *obj)
+{
+    // updates are queued from the connection thread, drop the ones of a removed connection
+    QHash<UAVObject *, int>::const_iterator i = m_vehicleIds.constFind(obj);
+
+    if (i == m_vehicleIds.constEnd() || !m_map) {
+        return;
+    }
+    double latitude;
+    double longitude;
+    double altitude;
+    UAVObjectManager *objManager = m_vehicleManagers.value(obj);
+    if (getUAVPosition(objManager, latitude, longitude, altitude)) {
+        m_map->Vehicles->SetVehicle(i.value(), internals::PointLatLng(latitude, longitude), altitude, getUAV_Yaw(objManager));
+    }
+}
+
 // Updates the Home position icon whenever the HomePosition object is updated
 void OPMapGadgetWidget::homePositionUpdated(UAVObject *hp)
 {
@@ -1158,10 +1297,6 @@ void OPMapGadgetWidget::setMaxUpdateRate(int update_rate)
 
     m_maxUpdateRate = update_rate;
 
-    if (m_updateTimer) {
-        m_updateTimer->setInterval(m_maxUpdateRate);
-    }
-
     // Update context menu selection
     int max_rate_list_size = sizeof(max_update_rate_list) / sizeof(max_update_rate_list[0]);
     for (int i = 0; i < max_rate_list_size; i++) {
@@ -1362,6 +1497,19 @@ void OPMapGadgetWidget::setCacheLocation(QString cacheLocation)
     m_map->configuration->SetCacheLocation(cacheLocation);
 }
 
+void OPMapGadgetWidget::setVectorTileUrl(QString url)
+{
+    if (!m_widget || !m_map) {
+        return;
+    }
+
+    url = url.trimmed();
+    if (url.isEmpty()) {
+        return;
+    }
+    m_map->configuration->SetVectorTileUrl(url);
+}
+
 void OPMapGadgetWidget::setMapMode(opMapModeType mode)
 {
     if (!m_widget || !m_map) {
@@ -2315,18 +2463,23 @@ internals::PointLatLng OPMapGadgetWidget::destPoint(internals::PointLatLng sourc
 // *************************************************************************************
 
 bool OPMapGadgetWidget::getUAVPosition(double &latitude, double &longitude, double &altitude)
+{
+    return getUAVPosition(obm, latitude, longitude, altitude);
+}
+
+bool OPMapGadgetWidget::getUAVPosition(UAVObjectManager *objManager, double &latitude, double &longitude, double &altitude)
 {
     double NED[3];
     double LLA[3];
     double homeLLA[3];
 
-    Q_ASSERT(obm != NULL);
+    Q_ASSERT(objManager != NULL);
 
-    PositionState *positionState = PositionState::GetInstance(obm);
+    PositionState *positionState = PositionState::GetInstance(objManager);
     Q_ASSERT(positionState != NULL);
     PositionState::DataFields positionStateData = positionState->getData();
     if (positionStateData.North == 0 && positionStateData.East == 0 && positionStateData.Down == 0) {
-        GPSPositionSensor *gpsPositionObj = GPSPositionSensor::GetInstance(obm);
+        GPSPositionSensor *gpsPositionObj = GPSPositionSensor::GetInstance(objManager);
         Q_ASSERT(gpsPositionObj);
 
         GPSPositionSensor::DataFields gpsPositionData = gpsPositionObj->getData();
@@ -2335,7 +2488,7 @@ bool OPMapGadgetWidget::getUAVPosition(double &latitude, double &longitude, doub
         altitude  = gpsPositionData.Altitude;
         return true;
     }
-    HomeLocation *homeLocation = HomeLocation::GetInstance(obm);
+    HomeLocation *homeLocation = HomeLocation::GetInstance(objManager);
     Q_ASSERT(homeLocation != NULL);
     HomeLocation::DataFields homeLocationData = homeLocation->getData();
 
@@ -2428,11 +2581,16 @@ bool OPMapGadgetWidget::getNavPosition(double &latitude, double &longitude, doub
 
 double OPMapGadgetWidget::getUAV_Yaw()
 {
-    if (!obm) {
+    return getUAV_Yaw(obm);
+}
+
+double OPMapGadgetWidget::getUAV_Yaw(UAVObjectManager *objManager)
+{
+    if (!objManager) {
         return 0;
     }
 
-    UAVObject *obj = dynamic_cast<UAVDataObject *>(obm->getObject(QString("AttitudeState")));
+    UAVObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject(QString("AttitudeState")));
     double yaw     = obj->getField(QString("Yaw"))->getDouble();
 
     if (yaw != yaw) {
@@ -45,6 +45,8 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QPointF>
+#include <QElapsedTimer>
+#include <QHash>
 
 #include "opmapcontrol/opmapcontrol.h"
 
@@ -69,6 +71,8 @@ namespace Ui {
 class OPMap_Widget;
 }
 
+class TelemetryConnection;
+
 using namespace mapcontrol;
 
 // ******************************************************
@@ -79,6 +83,23 @@ typedef struct t_home {
     bool locked;
 } t_home;
 
+// vehicle state as last drawn on the map
+typedef struct t_vehicle_state {
+    bool   valid;
+    double latitude;
+    double longitude;
+    double altitude;
+    double yaw;
+    double vNED[3];
+    float  airspeed;
+    qint32 gpsLatitude;
+    qint32 gpsLongitude;
+    float  gpsHeading;
+    double navLatitude;
+    double navLongitude;
+    double navAltitude;
+} t_vehicle_state;
+
 // ******************************************************
 
 enum opMapModeType { Normal_MapMode = 0,
@@ -109,6 +130,7 @@ public:
     void setAccessMode(QString accessMode);
     void setUseMemoryCache(bool useMemoryCache);
     void setCacheLocation(QString cacheLocation);
+    void setVectorTileUrl(QString url);
     void setMapMode(opMapModeType mode);
     void SetUavPic(QString UAVPic);
     void SetHomePic(QString HomePic);
@@ -134,10 +156,15 @@ public slots:
 protected:
     void resizeEvent(QResizeEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
+    bool eventFilter(QObject *obj, QEvent *event);
     void contextMenuEvent(QContextMenuEvent *event);
     void closeEvent(QCloseEvent *);
 private slots:
     void wpDoubleClickEvent(WayPointItem *wp);
+    void onTelemetryConnectionAdded(TelemetryConnection *connection);
+    void onTelemetryConnectionRemoved(TelemetryConnection *connection);
+    void onVehicleUpdated(UAVObject *obj);
+    void schedulePositionUpdate();
     void updatePosition();
 
     void updateMousePos();
@@ -240,11 +267,17 @@ private:
     QStringList findPlaceWordList;
     QCompleter *findPlaceCompleter;
     QTimer *m_updateTimer;
+    QElapsedTimer m_lastPositionUpdate;
+    t_vehicle_state m_drawnState;
     QTimer *m_statusUpdateTimer;
     Ui::OPMap_Widget *m_widget;
     mapcontrol::OPMapWidget *m_map;
     ExtensionSystem::PluginManager *pm;
     UAVObjectManager *obm;
+    // vehicle overlay id and object manager of the PositionState of each extra telemetry connection
+    QHash<UAVObject *, int> m_vehicleIds;
+    QHash<UAVObject *, UAVObjectManager *> m_vehicleManagers;
+    int m_nextVehicleId;
     UAVObjectUtilManager *obum;
     QPointer<opmap_edit_waypoint_dialog> waypoint_edit_dialog;
     QStandardItemModel wayPoint_treeView_model;
@@ -320,8 +353,10 @@ private:
     internals::PointLatLng destPoint(internals::PointLatLng source, double bear, double dist);
 
     bool getUAVPosition(double &latitude, double &longitude, double &altitude);
+    bool getUAVPosition(UAVObjectManager *objManager, double &latitude, double &longitude, double &altitude);
     bool getNavPosition(double &latitude, double &longitude, double &altitude);
     double getUAV_Yaw();
+    double getUAV_Yaw(UAVObjectManager *objManager);
 
     void setMapFollowingMode();
 
@@ -28,12 +28,13 @@
 #include "pathplanner.h"
 #include "ui_pathplanner.h"
 #include "widgetdelegates.h"
+#include "surveydialog.h"
 #include <QAbstractItemModel>
 #include <QFileDialog>
 
 pathPlanner::pathPlanner(QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::pathPlannerUI), wid(NULL), myModel(NULL)
+    ui(new Ui::pathPlannerUI), wid(NULL), myModel(NULL), myHome(NULL)
 {
     ui->setupUi(this);
 }
@@ -80,6 +81,11 @@ void pathPlanner::setModel(flightDataModel *model, QItemSelectionModel *selectio
     ui->tableView->setColumnWidth(flightDataModel::LOCKED, 60);
 }
 
+void pathPlanner::setHome(mapcontrol::HomeItem *home)
+{
+    myHome = home;
+}
+
 void pathPlanner::rowsInserted(const QModelIndex & parent, int start, int end)
 {
     Q_UNUSED(parent);
@@ -143,3 +149,12 @@ void pathPlanner::on_tbFetchFromUAV_clicked()
 {
     emit receivePathPlanFromUAV();
 }
+
+void pathPlanner::on_tbSurvey_clicked()
+{
+    if (!myModel || !myHome) {
+        return;
+    }
+    surveyDialog *dialog = new surveyDialog(myModel, myHome, this);
+    dialog->show();
+}
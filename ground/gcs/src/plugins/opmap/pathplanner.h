@@ -31,6 +31,7 @@
 #include <QWidget>
 #include "flightdatamodel.h"
 #include "opmap_edit_waypoint_dialog.h"
+#include "opmapcontrol/opmapcontrol.h"
 namespace Ui {
 class pathPlannerUI;
 }
@@ -43,6 +44,7 @@ public:
     ~pathPlanner();
 
     void setModel(flightDataModel *model, QItemSelectionModel *selection);
+    void setHome(mapcontrol::HomeItem *home);
 private slots:
     void rowsInserted(const QModelIndex & parent, int start, int end);
 
@@ -62,10 +64,13 @@ private slots:
 
     void on_tbFetchFromUAV_clicked();
 
+    void on_tbSurvey_clicked();
+
 private:
     Ui::pathPlannerUI *ui;
     opmap_edit_waypoint_dialog *wid;
     flightDataModel *myModel;
+    mapcontrol::HomeItem *myHome;
 signals:
     void sendPathPlanToUAV();
     void receivePathPlanFromUAV();
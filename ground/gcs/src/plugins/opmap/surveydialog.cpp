@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ *
+ * @file       surveydialog.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OPMapPlugin OpenPilot Map Plugin
+ * @{
+ * @brief      Dialog generating an area survey path plan
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "surveydialog.h"
+#include "ui_surveydialog.h"
+#include <QPushButton>
+
+surveyDialog::surveyDialog(flightDataModel *model, HomeItem *home, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::surveyDialog),
+    myModel(model),
+    myHome(home)
+{
+    ui->setupUi(this);
+    this->setAttribute(Qt::WA_DeleteOnClose, true);
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setText(tr("Generate"));
+    ui->altitude->setValue(model->defaultWaypointAltitude());
+    ui->velocity->setValue(model->defaultWaypointVelocity());
+    connect(&generator, SIGNAL(finished()), this, SLOT(surveyGenerated()));
+}
+
+surveyDialog::~surveyDialog()
+{
+    delete ui;
+}
+
+void surveyDialog::on_buttonBox_accepted()
+{
+    SurveyGenerator::Settings settings;
+
+    for (int x = 0; x < myModel->rowCount(); ++x) {
+        settings.area.append(internals::PointLatLng(myModel->data(myModel->index(x, flightDataModel::LATPOSITION)).toDouble(),
+                                                    myModel->data(myModel->index(x, flightDataModel::LNGPOSITION)).toDouble()));
+    }
+    settings.homeLLA[0]       = myHome->Coord().Lat();
+    settings.homeLLA[1]       = myHome->Coord().Lng();
+    settings.homeLLA[2]       = myHome->Altitude();
+    settings.altitude         = ui->altitude->value();
+    settings.velocity         = ui->velocity->value();
+    settings.angle            = ui->angle->value();
+    settings.sensorWidth      = ui->sensorWidth->value();
+    settings.sensorHeight     = ui->sensorHeight->value();
+    settings.focalLength      = ui->focalLength->value();
+    settings.frontOverlap     = ui->frontOverlap->value();
+    settings.sideOverlap      = ui->sideOverlap->value();
+    settings.pictureWaypoints = ui->pictureWaypoints->isChecked();
+
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
+    ui->status->setText(tr("Generating..."));
+    generator.generate(settings);
+}
+
+void surveyDialog::on_buttonBox_rejected()
+{
+    this->close();
+}
+
+void surveyDialog::surveyGenerated()
+{
+    SurveyGenerator::Result result = generator.result();
+
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(true);
+    if (!result.error.isEmpty()) {
+        ui->status->setText(result.error);
+        return;
+    }
+    if (myModel->rowCount() > 0) {
+        myModel->removeRows(0, myModel->rowCount());
+    }
+    myModel->insertWaypoints(0, result.waypoints);
+    this->close();
+}
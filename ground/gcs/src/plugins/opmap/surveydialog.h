@@ -0,0 +1,64 @@
+/**
+ ******************************************************************************
+ *
+ * @file       surveydialog.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OPMapPlugin OpenPilot Map Plugin
+ * @{
+ * @brief      Dialog generating an area survey path plan
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SURVEYDIALOG_H
+#define SURVEYDIALOG_H
+
+#include <QDialog>
+#include "opmapcontrol/opmapcontrol.h"
+#include "flightdatamodel.h"
+#include "surveygenerator.h"
+
+using namespace mapcontrol;
+
+namespace Ui {
+class surveyDialog;
+}
+
+/**
+ * Replaces the waypoints of the path plan, used as the corners of the area,
+ * with the waypoints of a survey of that area.
+ */
+class surveyDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit surveyDialog(flightDataModel *model, HomeItem *home, QWidget *parent = 0);
+    ~surveyDialog();
+
+private slots:
+    void on_buttonBox_accepted();
+    void on_buttonBox_rejected();
+    void surveyGenerated();
+
+private:
+    Ui::surveyDialog *ui;
+    flightDataModel *myModel;
+    HomeItem *myHome;
+    SurveyGenerator generator;
+};
+
+#endif // SURVEYDIALOG_H
@@ -0,0 +1,203 @@
+/**
+ ******************************************************************************
+ *
+ * @file       surveygenerator.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OPMapPlugin OpenPilot Map Plugin
+ * @{
+ * @brief      Generates area survey waypoints
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "surveygenerator.h"
+#include "widgetdelegates.h"
+#include "utils/coordinateconversions.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QVector>
+#include <algorithm>
+#include <math.h>
+
+SurveyGenerator::SurveyGenerator(QObject *parent) : QObject(parent)
+{
+    connect(&watcher, SIGNAL(finished()), this, SIGNAL(finished()));
+}
+
+SurveyGenerator::~SurveyGenerator()
+{
+    watcher.waitForFinished();
+}
+
+void SurveyGenerator::generate(const Settings &settings)
+{
+    if (watcher.isRunning()) {
+        return;
+    }
+    watcher.setFuture(QtConcurrent::run(&SurveyGenerator::buildSurvey, settings));
+}
+
+bool SurveyGenerator::isRunning() const
+{
+    return watcher.isRunning();
+}
+
+SurveyGenerator::Result SurveyGenerator::result() const
+{
+    if (watcher.isRunning() || watcher.future().resultCount() < 1) {
+        return Result();
+    }
+    return watcher.result();
+}
+
+/**
+ * Runs on a worker thread.
+ * The lines are computed in the NED frame of home, rotated so they run along
+ * the u axis, and all the waypoints are converted back to LLA in one batch.
+ */
+SurveyGenerator::Result SurveyGenerator::buildSurvey(Settings settings)
+{
+    Result result;
+    int corners = settings.area.count();
+
+    if (corners < 3) {
+        result.error = tr("The area needs at least three corners.");
+        return result;
+    }
+    if (settings.altitude <= 0 || settings.focalLength <= 0) {
+        result.error = tr("The altitude and the focal length must be positive.");
+        return result;
+    }
+
+    // distance between the lines and between the pictures taken along a line
+    double lineSpacing    = settings.altitude * settings.sensorWidth / settings.focalLength * (1.0 - settings.sideOverlap / 100.0);
+    double pictureSpacing = settings.altitude * settings.sensorHeight / settings.focalLength * (1.0 - settings.frontOverlap / 100.0);
+    if (lineSpacing <= 0 || pictureSpacing <= 0) {
+        result.error = tr("The sensor size must be positive and the overlaps below 100%.");
+        return result;
+    }
+
+    Utils::LocalFrame frame(settings.homeLLA);
+    QVector<double> lat(corners);
+    QVector<double> lng(corners);
+    QVector<double> alt(corners, settings.homeLLA[2]);
+    QVector<float> north(corners);
+    QVector<float> east(corners);
+    QVector<float> down(corners);
+    for (int i = 0; i < corners; ++i) {
+        lat[i] = settings.area.at(i).Lat();
+        lng[i] = settings.area.at(i).Lng();
+    }
+    frame.toNED(lat.constData(), lng.constData(), alt.constData(), north.data(), east.data(), down.data(), corners);
+
+    double cosAngle = cos(settings.angle * M_PI / 180.0);
+    double sinAngle = sin(settings.angle * M_PI / 180.0);
+    QVector<double> u(corners);
+    QVector<double> v(corners);
+    double vMin     = 0;
+    double vMax     = 0;
+    for (int i = 0; i < corners; ++i) {
+        u[i] = north[i] * cosAngle + east[i] * sinAngle;
+        v[i] = -north[i] * sinAngle + east[i] * cosAngle;
+        if (i == 0 || v[i] < vMin) {
+            vMin = v[i];
+        }
+        if (i == 0 || v[i] > vMax) {
+            vMax = v[i];
+        }
+    }
+
+    // lines centred on the area, at least one
+    int lines = qMax(1, (int)ceil((vMax - vMin) / lineSpacing));
+    double firstLine = (vMin + vMax) / 2 - (lines - 1) * lineSpacing / 2;
+    QVector<double> wpU;
+    QVector<double> wpV;
+    for (int line = 0; line < lines; ++line) {
+        double position = firstLine + line * lineSpacing;
+        QVector<double> crossings;
+        for (int i = 0; i < corners; ++i) {
+            int j = (i + 1) % corners;
+            if ((v[i] <= position) != (v[j] <= position)) {
+                crossings.append(u[i] + (position - v[i]) * (u[j] - u[i]) / (v[j] - v[i]));
+            }
+        }
+        qSort(crossings);
+        // back and forth
+        if (line % 2) {
+            std::reverse(crossings.begin(), crossings.end());
+        }
+        for (int k = 0; k + 1 < crossings.count(); k += 2) {
+            double start = crossings.at(k);
+            double end   = crossings.at(k + 1);
+            int steps    = 1;
+            if (settings.pictureWaypoints) {
+                steps = qMax(1, (int)ceil(fabs(end - start) / pictureSpacing));
+            }
+            for (int step = 0; step <= steps; ++step) {
+                wpU.append(start + (end - start) * step / steps);
+                wpV.append(position);
+            }
+        }
+        if (wpU.count() > MAX_WAYPOINTS) {
+            result.error = tr("The survey needs more than %1 waypoints.").arg(MAX_WAYPOINTS);
+            return result;
+        }
+    }
+    if (wpU.isEmpty()) {
+        result.error = tr("The area is empty.");
+        return result;
+    }
+
+    int count = wpU.count();
+    north.resize(count);
+    east.resize(count);
+    down.fill(-settings.altitude, count);
+    lat.resize(count);
+    lng.resize(count);
+    alt.resize(count);
+    for (int i = 0; i < count; ++i) {
+        north[i] = wpU[i] * cosAngle - wpV[i] * sinAngle;
+        east[i]  = wpU[i] * sinAngle + wpV[i] * cosAngle;
+    }
+    frame.toLLA(north.constData(), east.constData(), down.constData(), lat.data(), lng.data(), alt.data(), count);
+
+    pathPlanData data;
+    data.isRelative       = true;
+    data.altitudeRelative = settings.altitude;
+    data.velocity         = settings.velocity;
+    data.mode = MapDataDelegate::MODE_FOLLOWVECTOR;
+    data.condition        = MapDataDelegate::ENDCONDITION_LEGREMAINING;
+    data.command = MapDataDelegate::COMMAND_ONCONDITIONNEXTWAYPOINT;
+    data.jumpdestination  = 1;
+    data.errordestination = 1;
+    data.locked = false;
+    data.dirty  = true;
+    for (int i = 0; i < 4; ++i) {
+        data.mode_params[i]      = 0;
+        data.condition_params[i] = 0;
+    }
+    for (int i = 0; i < count; ++i) {
+        data.wpDescription = tr("Survey %1").arg(i + 1);
+        data.latPosition   = lat[i];
+        data.lngPosition   = lng[i];
+        data.altitude      = alt[i];
+        data.disRelative   = sqrt(north[i] * north[i] + east[i] * east[i]);
+        data.beaRelative   = atan2(east[i], north[i]) * 180 / M_PI;
+        result.waypoints.append(data);
+    }
+    return result;
+}
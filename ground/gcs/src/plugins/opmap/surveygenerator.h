@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ *
+ * @file       surveygenerator.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup OPMapPlugin OpenPilot Map Plugin
+ * @{
+ * @brief      Generates area survey waypoints
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SURVEYGENERATOR_H
+#define SURVEYGENERATOR_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include "opmapcontrol/opmapcontrol.h"
+#include "flightdatamodel.h"
+
+/**
+ * Generates the waypoints covering a polygon area with parallel back and forth
+ * lines (lawnmower pattern), spaced from the camera footprint and overlaps.
+ * The waypoints are computed on a worker thread.
+ */
+class SurveyGenerator : public QObject {
+    Q_OBJECT
+public:
+    typedef struct {
+        // corners of the area
+        QList<mapcontrol::internals::PointLatLng> area;
+        // home location the waypoints are relative to
+        double homeLLA[3];
+        // above home, in m
+        double altitude;
+        double velocity;
+        // direction of the lines, in degrees from north
+        double angle;
+        // sensor size and focal length of the camera, in mm
+        double sensorWidth;
+        double sensorHeight;
+        double focalLength;
+        // overlap of consecutive pictures along and across the lines, in %
+        double frontOverlap;
+        double sideOverlap;
+        // a waypoint at each picture instead of at the ends of the lines only
+        bool   pictureWaypoints;
+    } Settings;
+
+    typedef struct {
+        QList<pathPlanData> waypoints;
+        QString error;
+    } Result;
+
+    static const int MAX_WAYPOINTS = 10000;
+
+    explicit SurveyGenerator(QObject *parent = 0);
+    ~SurveyGenerator();
+
+    void generate(const Settings &settings);
+    bool isRunning() const;
+    Result result() const;
+
+signals:
+    void finished();
+
+private:
+    QFutureWatcher<Result> watcher;
+
+    static Result buildSurvey(Settings settings);
+};
+
+#endif // SURVEYGENERATOR_H
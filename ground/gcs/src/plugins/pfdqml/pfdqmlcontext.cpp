@@ -35,6 +35,8 @@
 
 #include "flightbatterysettings.h"
 
+#include <osgearth/osgearth.h>
+
 #include <QQmlContext>
 #include <QDebug>
 #include <QDirIterator>
@@ -48,6 +50,8 @@ PfdQmlContext::PfdQmlContext(QObject *parent) : QObject(parent),
     m_altitudeFactor(1.0),
     m_terrainEnabled(false),
     m_terrainFile(""),
+    m_terrainLodScale(1.0),
+    m_terrainCacheSize(0),
     m_latitude(39.657380),
     m_longitude(19.805158),
     m_altitude(100),
@@ -144,6 +148,32 @@ void PfdQmlContext::setTerrainFile(const QString &arg)
     }
 }
 
+double PfdQmlContext::terrainLodScale() const
+{
+    return m_terrainLodScale;
+}
+
+void PfdQmlContext::setTerrainLodScale(double arg)
+{
+    if (m_terrainLodScale != arg) {
+        m_terrainLodScale = arg;
+        emit terrainLodScaleChanged(terrainLodScale());
+    }
+}
+
+int PfdQmlContext::terrainCacheSize() const
+{
+    return m_terrainCacheSize;
+}
+
+void PfdQmlContext::setTerrainCacheSize(int arg)
+{
+    if (m_terrainCacheSize != arg) {
+        m_terrainCacheSize = arg;
+        emit terrainCacheSizeChanged(terrainCacheSize());
+    }
+}
+
 double PfdQmlContext::latitude() const
 {
     return m_latitude;
@@ -305,6 +335,14 @@ void PfdQmlContext::loadConfiguration(PfdQmlGadgetConfiguration *config)
     // terrain
     setTerrainEnabled(config->terrainEnabled());
     setTerrainFile(config->terrainFile());
+    setTerrainLodScale(config->terrainLodScale());
+    setTerrainCacheSize(config->terrainCacheSize());
+
+#ifdef USE_OSG
+    // the disk cache is shared by all the gadgets, the last configuration applied wins
+    OsgEarth::setCacheOnly(config->cacheOnly());
+    OsgEarth::setCacheSize(config->diskCacheSize());
+#endif
 
     setLatitude(config->latitude());
     setLongitude(config->longitude());
@@ -43,6 +43,8 @@ class PfdQmlContext : public QObject {
     // terrain
     Q_PROPERTY(bool terrainEnabled READ terrainEnabled WRITE setTerrainEnabled NOTIFY terrainEnabledChanged)
     Q_PROPERTY(QString terrainFile READ terrainFile WRITE setTerrainFile NOTIFY terrainFileChanged)
+    Q_PROPERTY(double terrainLodScale READ terrainLodScale WRITE setTerrainLodScale NOTIFY terrainLodScaleChanged)
+    Q_PROPERTY(int terrainCacheSize READ terrainCacheSize WRITE setTerrainCacheSize NOTIFY terrainCacheSizeChanged)
 
     Q_PROPERTY(double latitude READ latitude WRITE setLatitude NOTIFY latitudeChanged)
     Q_PROPERTY(double longitude READ longitude WRITE setLongitude NOTIFY longitudeChanged)
@@ -79,6 +81,10 @@ public:
     void setTerrainEnabled(bool arg);
     QString terrainFile() const;
     void setTerrainFile(const QString &arg);
+    double terrainLodScale() const;
+    void setTerrainLodScale(double arg);
+    int terrainCacheSize() const;
+    void setTerrainCacheSize(int arg);
 
     double latitude() const;
     void setLatitude(double arg);
@@ -125,6 +131,8 @@ signals:
 
     void terrainEnabledChanged(bool arg);
     void terrainFileChanged(QString arg);
+    void terrainLodScaleChanged(double arg);
+    void terrainCacheSizeChanged(int arg);
 
     void latitudeChanged(double arg);
     void longitudeChanged(double arg);
@@ -150,6 +158,8 @@ private:
 
     bool m_terrainEnabled;
     QString m_terrainFile;
+    double m_terrainLodScale;
+    int m_terrainCacheSize;
 
     double m_latitude;
     double m_longitude;
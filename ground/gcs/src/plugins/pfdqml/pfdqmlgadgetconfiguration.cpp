@@ -54,7 +54,10 @@ PfdQmlGadgetConfiguration::PfdQmlGadgetConfiguration(QString classId, QSettings
     m_terrainEnabled      = settings.value("terrainEnabled", false).toBool();
     m_terrainFile         = settings.value("earthFile", "Unknown").toString();
     m_terrainFile         = Utils::InsertDataPath(m_terrainFile);
+    m_terrainLodScale     = settings.value("terrainLodScale", 1.0).toDouble();
+    m_terrainCacheSize    = settings.value("terrainCacheSize", 0).toInt();
     m_cacheOnly           = settings.value("cacheOnly", false).toBool();
+    m_diskCacheSize       = settings.value("diskCacheSize", 1024).toInt();
 
     m_latitude            = settings.value("latitude").toDouble();
     m_longitude           = settings.value("longitude").toDouble();
@@ -91,7 +94,10 @@ PfdQmlGadgetConfiguration::PfdQmlGadgetConfiguration(const PfdQmlGadgetConfigura
     // terrain
     m_terrainEnabled      = obj.m_terrainEnabled;
     m_terrainFile         = obj.m_terrainFile;
+    m_terrainLodScale     = obj.m_terrainLodScale;
+    m_terrainCacheSize    = obj.m_terrainCacheSize;
     m_cacheOnly           = obj.m_cacheOnly;
+    m_diskCacheSize       = obj.m_diskCacheSize;
 
     m_latitude            = obj.m_latitude;
     m_longitude           = obj.m_longitude;
@@ -140,7 +146,10 @@ void PfdQmlGadgetConfiguration::saveConfig(QSettings &settings) const
     settings.setValue("terrainEnabled", m_terrainEnabled);
     QString terrainFile = Utils::RemoveDataPath(m_terrainFile);
     settings.setValue("earthFile", terrainFile);
+    settings.setValue("terrainLodScale", m_terrainLodScale);
+    settings.setValue("terrainCacheSize", m_terrainCacheSize);
     settings.setValue("cacheOnly", m_cacheOnly);
+    settings.setValue("diskCacheSize", m_diskCacheSize);
 
     settings.setValue("latitude", m_latitude);
     settings.setValue("longitude", m_longitude);
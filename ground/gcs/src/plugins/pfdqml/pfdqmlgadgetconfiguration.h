@@ -100,6 +100,23 @@ public:
         m_terrainFile = fileName;
     }
 
+    double terrainLodScale() const
+    {
+        return m_terrainLodScale;
+    }
+    void setTerrainLodScale(double scale)
+    {
+        m_terrainLodScale = scale;
+    }
+
+    int terrainCacheSize() const
+    {
+        return m_terrainCacheSize;
+    }
+    void setTerrainCacheSize(int size)
+    {
+        m_terrainCacheSize = size;
+    }
 
     double latitude() const
     {
@@ -137,6 +154,15 @@ public:
         return m_cacheOnly;
     }
 
+    int diskCacheSize() const
+    {
+        return m_diskCacheSize;
+    }
+    void setDiskCacheSize(int size)
+    {
+        m_diskCacheSize = size;
+    }
+
     TimeMode::Enum timeMode() const
     {
         return m_timeMode;
@@ -227,7 +253,10 @@ private:
 
     bool m_terrainEnabled;
     QString m_terrainFile; // The name of osgearth terrain file
+    double m_terrainLodScale; // Greater than 1 lowers the terrain level of detail
+    int m_terrainCacheSize; // Number of paged tiles kept in memory, 0 for the default
     bool m_cacheOnly;
+    int m_diskCacheSize; // Terrain and imagery disk cache size in MB, 0 for no limit
 
     double m_latitude;
     double m_longitude;
@@ -31,6 +31,11 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavdataobject.h"
+#include "homelocation.h"
+#include "waypoint.h"
+#include "utils/coordinateconversions.h"
+
+#include <osgearth/osgearth.h>
 
 #include <QFileDialog>
 #include <QtAlgorithms>
@@ -85,7 +90,13 @@ QWidget *PfdQmlGadgetOptionsPage::createPage(QWidget *parent)
     options_page->longitude->setText(QString::number(m_config->longitude()));
     options_page->altitude->setText(QString::number(m_config->altitude()));
 
+    // Terrain disk cache
     options_page->useOnlyCache->setChecked(m_config->cacheOnly());
+    options_page->diskCacheSizeSpinBox->setValue(m_config->diskCacheSize());
+
+    // Terrain level of detail and paging
+    options_page->terrainLodScaleSpinBox->setValue(m_config->terrainLodScale());
+    options_page->terrainCacheSizeSpinBox->setValue(m_config->terrainCacheSize());
 
     // Sky options
     options_page->useLocalTime->setChecked(m_config->timeMode() == TimeMode::Local);
@@ -121,6 +132,8 @@ QWidget *PfdQmlGadgetOptionsPage::createPage(QWidget *parent)
 
     QObject::connect(options_page->actualizeDateTimeButton, SIGNAL(clicked()),
                      this, SLOT(actualizeDateTime()));
+    QObject::connect(options_page->preSeedTerrain, SIGNAL(clicked()),
+                     this, SLOT(preSeedTerrainCache()));
 
     return optionsPageWidget;
 }
@@ -146,6 +159,9 @@ void PfdQmlGadgetOptionsPage::apply()
     m_config->setLongitude(options_page->longitude->text().toDouble());
     m_config->setAltitude(options_page->altitude->text().toDouble());
     m_config->setCacheOnly(options_page->useOnlyCache->isChecked());
+    m_config->setDiskCacheSize(options_page->diskCacheSizeSpinBox->value());
+    m_config->setTerrainLodScale(options_page->terrainLodScaleSpinBox->value());
+    m_config->setTerrainCacheSize(options_page->terrainCacheSizeSpinBox->value());
 
     if (options_page->useLocalTime->isChecked()) {
         m_config->setTimeMode(TimeMode::Local);
@@ -187,3 +203,44 @@ void PfdQmlGadgetOptionsPage::actualizeDateTime()
     options_page->dateEdit->setDate(dateTime.date());
     options_page->timeEdit->setTime(dateTime.time());
 }
+
+// seeds the terrain cache with the area covered by the flight plan
+void PfdQmlGadgetOptionsPage::preSeedTerrainCache()
+{
+    // margin around the waypoints, in degrees (about 1km)
+    const double margin = 0.01;
+    // deepest level seeded, deeper tiles are downloaded when flying
+    const int maxLevel  = 15;
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager       = pm->getObject<UAVObjectManager>();
+
+    HomeLocation *homeLocation    = HomeLocation::GetInstance(objManager);
+    HomeLocation::DataFields home = homeLocation->getData();
+
+    double homeLLA[3] = { home.Latitude / 1e7, home.Longitude / 1e7, home.Altitude };
+    Utils::LocalFrame frame(homeLLA);
+
+    double minLat = homeLLA[0], maxLat = homeLLA[0];
+    double minLon = homeLLA[1], maxLon = homeLLA[1];
+
+    int count = objManager->getNumInstances(Waypoint::OBJID);
+    for (int i = 0; i < count; ++i) {
+        Waypoint::DataFields waypoint = Waypoint::GetInstance(objManager, i)->getData();
+        double NED[3] = { waypoint.Position[Waypoint::POSITION_NORTH],
+                          waypoint.Position[Waypoint::POSITION_EAST],
+                          waypoint.Position[Waypoint::POSITION_DOWN] };
+        double LLA[3];
+        frame.toLLA(NED, LLA);
+        minLat = qMin(minLat, LLA[0]);
+        maxLat = qMax(maxLat, LLA[0]);
+        minLon = qMin(minLon, LLA[1]);
+        maxLon = qMax(maxLon, LLA[1]);
+    }
+
+    if (OsgEarth::seedCache(options_page->earthFile->path(), minLat - margin, minLon - margin,
+                            maxLat + margin, maxLon + margin, maxLevel)) {
+        options_page->preSeedTerrain->setToolTip(tr("Seeding %1 waypoints around %2, %3 in the background")
+                                                 .arg(count).arg(homeLLA[0]).arg(homeLLA[1]));
+    }
+}
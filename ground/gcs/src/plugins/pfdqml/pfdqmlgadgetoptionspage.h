@@ -56,6 +56,7 @@ public:
 
 private slots:
     void actualizeDateTime();
+    void preSeedTerrainCache();
 
 private:
     Ui::PfdQmlGadgetOptionsPage *options_page;
@@ -31,6 +31,9 @@
 #include "utils/quickwidgetproxy.h"
 #include "utils/svgimageprovider.h"
 
+#include <coreplugin/framescheduler.h>
+#include <extensionsystem/startuptrace.h>
+
 #include <QLayout>
 #include <QStackedLayout>
 #include <QQmlEngine>
@@ -38,7 +41,7 @@
 #include <QDebug>
 
 PfdQmlGadgetWidget::PfdQmlGadgetWidget(QWidget *parent) :
-    QWidget(parent), m_quickWidgetProxy(NULL), m_pfdQmlContext(NULL), m_qmlFileName()
+    QWidget(parent), m_quickWidgetProxy(NULL), m_pfdQmlContext(NULL), m_svgRenderer(NULL), m_qmlFileName()
 {
     setLayout(new QStackedLayout());
 }
@@ -48,6 +51,7 @@ PfdQmlGadgetWidget::~PfdQmlGadgetWidget()
     if (m_pfdQmlContext) {
         delete m_pfdQmlContext;
     }
+    delete m_svgRenderer;
 }
 
 void PfdQmlGadgetWidget::setSource(const QUrl &url)
@@ -60,6 +64,11 @@ QQmlEngine *PfdQmlGadgetWidget::engine() const
     return m_quickWidgetProxy->engine();
 }
 
+QQmlContext *PfdQmlGadgetWidget::rootContext() const
+{
+    return m_quickWidgetProxy->rootContext();
+}
+
 QList<QQmlError> PfdQmlGadgetWidget::errors() const
 {
     return m_quickWidgetProxy->errors();
@@ -72,6 +81,9 @@ void PfdQmlGadgetWidget::loadConfiguration(PfdQmlGadgetConfiguration *config)
     if (!m_quickWidgetProxy) {
         m_quickWidgetProxy = new QuickWidgetProxy(this);
 
+        // deliver UAVObject notifications in sync with the frames
+        Core::FrameScheduler::instance()->addWindow(m_quickWidgetProxy->quickWindow());
+
 #if 0
         qDebug() << "PfdQmlGadgetWidget::PfdQmlGadgetWidget - persistent OpenGL context" << isPersistentOpenGLContext();
         qDebug() << "PfdQmlGadgetWidget::PfdQmlGadgetWidget - persistent scene graph" << isPersistentSceneGraph();
@@ -79,7 +91,7 @@ void PfdQmlGadgetWidget::loadConfiguration(PfdQmlGadgetConfiguration *config)
 
         // expose context
         m_pfdQmlContext = new PfdQmlContext(this);
-        m_pfdQmlContext->apply(engine()->rootContext());
+        m_pfdQmlContext->apply(rootContext());
 
         // add widget
         layout()->addWidget(m_quickWidgetProxy->widget());
@@ -113,15 +125,15 @@ void PfdQmlGadgetWidget::setQmlFile(QString fn)
         clear();
         return;
     }
-    SvgImageProvider *svgProvider = new SvgImageProvider(fn);
-    engine()->addImageProvider("svg", svgProvider);
+    // the engine's "svg" image provider is shared, this one resolves the files of this gadget
+    m_svgRenderer = new SvgImageProvider(fn);
 
     // it's necessary to allow qml side to query svg element position
-    engine()->rootContext()->setContextProperty("svgRenderer", svgProvider);
+    rootContext()->setContextProperty("svgRenderer", m_svgRenderer);
 
     QUrl url = QUrl::fromLocalFile(fn);
-    engine()->setBaseUrl(url);
 
+    ExtensionSystem::StartupTrace::Scope trace("qml", fn);
     setSource(url);
 
     foreach(const QQmlError &error, errors()) {
@@ -135,10 +147,12 @@ void PfdQmlGadgetWidget::clear()
 
     setSource(QUrl());
 
-    engine()->removeImageProvider("svg");
-    engine()->rootContext()->setContextProperty("svgRenderer", NULL);
+    rootContext()->setContextProperty("svgRenderer", NULL);
+    delete m_svgRenderer;
+    m_svgRenderer = NULL;
 
     // calling clearComponentCache() causes crashes (see https://bugreports.qt-project.org/browse/QTBUG-41465)
     // but not doing it causes almost systematic crashes when switching PFD gadget to "Model View (Without Terrain)" configuration
-    engine()->clearComponentCache();
+    // the engine is shared, only drop the components no other gadget uses
+    engine()->trimComponentCache();
 }
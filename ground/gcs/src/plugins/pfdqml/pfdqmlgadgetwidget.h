@@ -34,8 +34,10 @@
 #include <QWidget>
 
 class QQmlEngine;
+class QQmlContext;
 class QSettings;
 class QuickWidgetProxy;
+class SvgImageProvider;
 class PfdQmlContext;
 
 class PfdQmlGadgetWidget : public QWidget {
@@ -53,6 +55,7 @@ private:
     QuickWidgetProxy *m_quickWidgetProxy;
 
     PfdQmlContext *m_pfdQmlContext;
+    SvgImageProvider *m_svgRenderer;
     QString m_qmlFileName;
 
     void setQmlFile(QString);
@@ -60,6 +63,7 @@ private:
 
     void setSource(const QUrl &url);
     QQmlEngine *engine() const;
+    QQmlContext *rootContext() const;
     QList<QQmlError> errors() const;
 };
 
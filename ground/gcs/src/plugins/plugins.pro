@@ -37,6 +37,7 @@ plugin_opHID.depends = plugin_coreplugin
 SUBDIRS += plugin_serial
 plugin_serial.subdir = serialconnection
 plugin_serial.depends = plugin_coreplugin
+plugin_serial.depends += plugin_opHID
 
 # UAVObjects plugin
 SUBDIRS += plugin_uavobjects
@@ -180,6 +181,7 @@ SUBDIRS += plugin_logging
 plugin_gcscontrol.subdir = gcscontrol
 plugin_gcscontrol.depends = plugin_coreplugin
 plugin_gcscontrol.depends += plugin_uavobjects
+plugin_gcscontrol.depends += plugin_uavtalk
 SUBDIRS += plugin_gcscontrol
 
 # Antenna tracker
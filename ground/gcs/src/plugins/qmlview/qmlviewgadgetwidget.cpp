@@ -32,6 +32,9 @@
 #include "uavobject.h"
 #include "utils/svgimageprovider.h"
 
+#include <coreplugin/framescheduler.h>
+#include <extensionsystem/startuptrace.h>
+
 #include <QDebug>
 #include <QSvgRenderer>
 #include <QtCore/qfileinfo.h>
@@ -45,6 +48,9 @@ QmlViewGadgetWidget::QmlViewGadgetWidget(QWindow *parent) :
 {
     setResizeMode(SizeRootObjectToView);
 
+    // deliver UAVObject notifications in sync with the frames
+    Core::FrameScheduler::instance()->addWindow(this);
+
     QStringList objectsToExport;
     objectsToExport << "VelocityState" <<
         "PositionState" <<
@@ -85,6 +91,7 @@ void QmlViewGadgetWidget::setQmlFile(QString fn)
     engine()->setBaseUrl(QUrl::fromLocalFile(fn));
 
     qDebug() << Q_FUNC_INFO << fn;
+    ExtensionSystem::StartupTrace::Scope trace("qml", fn);
     setSource(QUrl::fromLocalFile(fn));
 
     foreach(const QQmlError &error, errors()) {
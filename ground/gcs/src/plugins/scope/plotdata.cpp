@@ -27,18 +27,44 @@
 
 
 #include "plotdata.h"
+#include "scopeclock.h"
 #include <math.h>
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <complex>
+
+#include <unsupported/Eigen/FFT>
 
 PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
                    int scaleOrderFactor, int meanSamples, QString mathFunction,
                    double plotDataSize, QPen pen, bool antialiased) :
-    m_scalePower(scaleOrderFactor), m_meanSamples(meanSamples),
+    m_scalePower(scaleOrderFactor), m_meanSamples(qMax(meanSamples, 1)),
     m_meanSum(0.0f), m_mathFunction(mathFunction), m_correctionSum(0.0f),
     m_correctionCount(0), m_plotDataSize(plotDataSize),
+    m_signal(NULL), m_keepCount(0), m_keepAge(0), m_nextSequence(0), m_clearSequence(0),
+    m_seriesData(NULL), m_mathFunctionType(MathNone),
     m_object(object), m_field(field), m_element(element),
-    m_plotCurve(NULL), m_isVisible(true), m_pen(pen), m_isEnumPlot(false)
+    m_plotCurve(NULL), m_paintedSerial(0), m_paintedCount(-1), m_paintedMarkers(0),
+    m_isVisible(true), m_pen(pen), m_isEnumPlot(false)
 {
+    if (m_mathFunction == "Boxcar average") {
+        m_mathFunctionType = MathBoxcarAverage;
+    } else if (m_mathFunction == "Standard deviation") {
+        m_mathFunctionType = MathStandardDeviation;
+    } else if (m_mathFunction == "Exponential average") {
+        m_mathFunctionType = MathExponentialAverage;
+    } else if (m_mathFunction == "Median") {
+        m_mathFunctionType = MathMedian;
+    } else if (m_mathFunction == "Minimum") {
+        m_mathFunctionType = MathMinimum;
+    } else if (m_mathFunction == "Maximum") {
+        m_mathFunctionType = MathMaximum;
+    } else if (m_mathFunction == "Derivative") {
+        m_mathFunctionType = MathDerivative;
+    }
+    clearMathFunction();
+
     if (m_field->getNumElements() > 1) {
         m_elementName = m_field->getElementNames().at(m_element);
     }
@@ -62,10 +88,38 @@ PlotData::PlotData(UAVObject *object, UAVObjectField *field, int element,
     }
 
     m_plotCurve->setPen(m_pen);
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
     m_isEnumPlot = m_field->getType() == UAVObjectField::ENUM;
 }
 
+void PlotData::acquireSignal(int keepCount, double keepAge)
+{
+    m_keepCount    = keepCount;
+    m_keepAge      = keepAge;
+    m_signal       = ScopeSampleStore::instance()->acquire(m_object, m_field, m_element, keepCount, keepAge);
+    m_nextSequence = m_clearSequence = m_signal->sequence();
+
+    if (isShared()) {
+        m_seriesData = new PlotSeriesData(&m_signal->samples());
+        m_seriesData->setScale(pow(10, m_scalePower));
+    } else {
+        m_seriesData = new PlotSeriesData(&m_samples);
+    }
+    m_plotCurve->setData(m_seriesData);
+}
+
+void PlotData::pullSamples()
+{
+    if (!isShared()) {
+        double scale = pow(10, m_scalePower);
+        for (quint64 sequence = qMax(m_nextSequence, m_signal->firstSequence());
+             sequence < m_signal->sequence(); sequence++) {
+            const QPointF &sample = m_signal->sample(sequence);
+            appendSample(sample.x(), sample.y() * scale);
+        }
+    }
+    m_nextSequence = m_signal->sequence();
+}
+
 PlotData::~PlotData()
 {
     while (!m_enumMarkerList.isEmpty()) {
@@ -75,6 +129,9 @@ PlotData::~PlotData()
     }
     m_plotCurve->detach();
     delete m_plotCurve;
+    if (m_signal) {
+        ScopeSampleStore::instance()->release(m_signal, m_keepCount, m_keepAge);
+    }
 }
 
 bool PlotData::isVisible() const
@@ -90,16 +147,29 @@ void PlotData::setVisible(bool visible)
 
 void PlotData::updatePlotData()
 {
-    m_plotCurve->setSamples(m_xDataEntries, m_yDataEntries);
+    QwtPlot *plot = m_plotCurve->plot();
+
+    if (isShared()) {
+        // plot the part of the shared samples in the window of this curve
+        const PlotSampleBuffer &samples = m_signal->samples();
+        int first = (int)(qMax(m_clearSequence, m_signal->firstSequence()) - m_signal->firstSequence());
+        if (plotType() == SequentialPlot) {
+            first = qMax(first, samples.size() - (int)m_plotDataSize);
+        } else if (!samples.isEmpty()) {
+            first = qMax(first, m_signal->indexOf(samples.last().x() - m_plotDataSize));
+        }
+        m_seriesData->setRange(first, samples.size() - first);
+    }
+    m_seriesData->update(plot ? plot->canvas()->width() : 0);
+    m_plotCurve->itemChanged();
 }
 
 void PlotData::clear()
 {
-    m_meanSum = 0.0f;
-    m_correctionSum   = 0.0f;
-    m_correctionCount = 0;
-    m_xDataEntries.clear();
-    m_yDataEntries.clear();
+    clearMathFunction();
+    m_samples.clear();
+    m_nextSequence = m_clearSequence = m_signal->sequence();
+    m_seriesData->invalidate();
     while (!m_enumMarkerList.isEmpty()) {
         QwtPlotMarker *marker = m_enumMarkerList.takeFirst();
         marker->detach();
@@ -113,7 +183,10 @@ void PlotData::clear()
 bool PlotData::hasData() const
 {
     if (!m_isEnumPlot) {
-        return !m_xDataEntries.isEmpty();
+        if (isShared()) {
+            return m_signal->sequence() > m_clearSequence && !m_signal->samples().isEmpty();
+        }
+        return !m_samples.isEmpty();
     } else {
         return !m_enumMarkerList.isEmpty();
     }
@@ -122,17 +195,49 @@ bool PlotData::hasData() const
 QString PlotData::lastDataAsString()
 {
     if (!m_isEnumPlot) {
-        return QString().sprintf("%3.10g", m_yDataEntries.last());
+        return QString().sprintf("%3.10g", lastData());
     } else {
         return m_enumMarkerList.last()->title().text();
     }
 }
 
+double PlotData::lastData()
+{
+    if (!m_isEnumPlot) {
+        if (isShared()) {
+            return m_signal->samples().last().y() * pow(10, m_scalePower);
+        }
+        return m_samples.last().y();
+    } else {
+        return m_field->getOptionIndex(m_enumMarkerList.last()->title().text());
+    }
+}
+
 void PlotData::attach(QwtPlot *plot)
 {
     m_plotCurve->attach(plot);
 }
 
+bool PlotData::appendedSamples(int *from, int *to) const
+{
+    // the decimated samples change with each new sample
+    if (m_paintedCount < 0 || m_seriesData->isDecimated() || m_seriesData->firstSerial() != m_paintedSerial ||
+        (int)m_seriesData->size() < m_paintedCount || m_enumMarkerList.size() != m_paintedMarkers) {
+        return false;
+    }
+    *from = qMax(m_paintedCount - 1, 0);
+    *to   = (int)m_seriesData->size() - 1;
+    return true;
+}
+
+void PlotData::markPainted()
+{
+    // a decimated curve is never extended, see appendedSamples()
+    m_paintedSerial  = m_seriesData->firstSerial();
+    m_paintedCount   = m_seriesData->isDecimated() ? -1 : (int)m_seriesData->size();
+    m_paintedMarkers = m_enumMarkerList.size();
+}
+
 void PlotData::visibilityChanged(QwtPlotItem *item)
 {
     if (m_plotCurve == item) {
@@ -142,37 +247,136 @@ void PlotData::visibilityChanged(QwtPlotItem *item)
     }
 }
 
-void PlotData::calcMathFunction(double currentValue)
+/**
+ * Apply the math function to a new value, in O(1) for all but the median
+ * (which moves part of the sorted window).
+ * The time is used for the derivative, in seconds (chrono plots) or in samples (sequential plots).
+ */
+double PlotData::calcMathFunction(double currentValue, double time)
 {
-    // Put the new value at the back
-    m_yDataHistory.append(currentValue);
+    switch (m_mathFunctionType) {
+    case MathExponentialAverage:
+        if (m_mathSampleNumber++ == 0) {
+            m_mathResult = currentValue;
+        } else {
+            m_mathResult += (currentValue - m_mathResult) * 2.0 / (m_meanSamples + 1);
+        }
+        return m_mathResult;
+
+    case MathDerivative:
+        if (m_mathSampleNumber++ > 0 && time > m_mathLastTime) {
+            m_mathResult = (currentValue - m_mathLastValue) / (time - m_mathLastTime);
+        }
+        m_mathLastValue = currentValue;
+        m_mathLastTime  = time;
+        return m_mathResult;
 
-    // calculate average value
-    m_meanSum += currentValue;
-    if (m_yDataHistory.size() > m_meanSamples) {
-        m_meanSum -= m_yDataHistory.first();
-        m_yDataHistory.pop_front();
+    default:
+        break;
     }
-    // make sure to correct the sum every meanSamples steps to prevent it
-    // from running away due to floating point rounding errors
-    m_correctionSum += currentValue;
-    if (++m_correctionCount >= m_meanSamples) {
-        m_meanSum = m_correctionSum;
-        m_correctionSum = 0.0f;
-        m_correctionCount = 0;
+
+    // Put the new value at the back of the window
+    quint64 sampleNumber = m_mathSampleNumber++;
+    m_mathWindow.append(QPointF(sampleNumber, currentValue));
+    bool hasRemoved = m_mathWindow.size() > m_meanSamples;
+    double removed  = 0;
+    if (hasRemoved) {
+        removed = m_mathWindow.first().y();
+        m_mathWindow.removeFirst();
+    }
+    int count = m_mathWindow.size();
+
+    switch (m_mathFunctionType) {
+    case MathBoxcarAverage:
+        // calculate average value
+        m_meanSum += currentValue;
+        if (hasRemoved) {
+            m_meanSum -= removed;
+        }
+        // make sure to correct the sum every meanSamples steps to prevent it
+        // from running away due to floating point rounding errors
+        m_correctionSum += currentValue;
+        if (++m_correctionCount >= m_meanSamples) {
+            m_meanSum = m_correctionSum;
+            m_correctionSum   = 0.0f;
+            m_correctionCount = 0;
+        }
+        return m_meanSum / count;
+
+    case MathStandardDeviation:
+    {
+        // Welford's running mean and sum of squared differences, over the window
+        double delta = currentValue - m_mathMean;
+        m_mathMean += delta / (hasRemoved ? count + 1 : count);
+        m_mathM2   += delta * (currentValue - m_mathMean);
+        if (hasRemoved) {
+            delta       = removed - m_mathMean;
+            m_mathMean -= delta / count;
+            m_mathM2   -= delta * (removed - m_mathMean);
+        }
+        // recompute them every meanSamples steps to prevent them
+        // from running away due to floating point rounding errors
+        if (++m_correctionCount >= m_meanSamples) {
+            m_correctionCount = 0;
+            m_mathMean = 0;
+            for (int i = 0; i < count; i++) {
+                m_mathMean += m_mathWindow.at(i).y();
+            }
+            m_mathMean /= count;
+            m_mathM2    = 0;
+            for (int i = 0; i < count; i++) {
+                m_mathM2 += pow(m_mathWindow.at(i).y() - m_mathMean, 2);
+            }
+        }
+        // Sample standard deviation, with Bessel's correction
+        return (count > 1 && m_mathM2 > 0) ? sqrt(m_mathM2 / (count - 1)) : 0.0;
     }
 
-    double boxcarAvg = m_meanSum / m_yDataHistory.size();
-    if (m_mathFunction == "Standard deviation") {
-        // Calculate square of sample standard deviation, with Bessel's correction
-        double stdSum = 0;
-        for (int i = 0; i < m_yDataHistory.size(); i++) {
-            stdSum += pow(m_yDataHistory.at(i) - boxcarAvg, 2) / (m_meanSamples - 1);
+    case MathMedian:
+    {
+        m_mathSorted.insert(std::lower_bound(m_mathSorted.begin(), m_mathSorted.end(), currentValue), currentValue);
+        if (hasRemoved) {
+            m_mathSorted.erase(std::lower_bound(m_mathSorted.begin(), m_mathSorted.end(), removed));
         }
-        m_yDataEntries.append(sqrt(stdSum));
-    } else {
-        m_yDataEntries.append(boxcarAvg);
+        int middle = count / 2;
+        return (count % 2) ? m_mathSorted.at(middle) : (m_mathSorted.at(middle - 1) + m_mathSorted.at(middle)) / 2.0;
     }
+
+    case MathMinimum:
+    case MathMaximum:
+    {
+        bool isMaximum = (m_mathFunctionType == MathMaximum);
+        while (!m_mathExtrema.isEmpty() &&
+               (isMaximum ? m_mathExtrema.last().y() <= currentValue : m_mathExtrema.last().y() >= currentValue)) {
+            m_mathExtrema.removeLast();
+        }
+        m_mathExtrema.append(QPointF(sampleNumber, currentValue));
+        if (m_mathExtrema.first().x() < m_mathWindow.first().x()) {
+            m_mathExtrema.removeFirst();
+        }
+        return m_mathExtrema.first().y();
+    }
+
+    default:
+        break;
+    }
+    return currentValue;
+}
+
+void PlotData::clearMathFunction()
+{
+    m_meanSum = 0.0f;
+    m_correctionSum    = 0.0f;
+    m_correctionCount  = 0;
+    m_mathWindow.clear();
+    m_mathExtrema.clear();
+    m_mathSorted.clear();
+    m_mathSampleNumber = 0;
+    m_mathMean   = 0;
+    m_mathM2     = 0;
+    m_mathResult = 0;
+    m_mathLastValue    = 0;
+    m_mathLastTime     = 0;
 }
 
 QwtPlotMarker *PlotData::createMarker(QString value)
@@ -199,6 +403,52 @@ QwtPlotMarker *PlotData::createMarker(QString value)
     return marker;
 }
 
+void PlotSeriesData::update(int columns)
+{
+    invalidate();
+
+    int count = rangeSize();
+    if (columns <= 0 || count <= 2 * columns) {
+        return;
+    }
+    double first = bufferSample(0).x();
+    double span  = bufferSample(count - 1).x() - first;
+    if (span <= 0.0) {
+        return;
+    }
+    double scale = columns / span;
+
+    // keep the minimum and the maximum of each column, in time order
+    m_decimated.resize(0);
+    m_decimated.reserve(2 * columns);
+    int column = -1;
+    QPointF min, max;
+    for (int i = 0; i < count; i++) {
+        QPointF p = bufferSample(i);
+        int c     = qMin((int)((p.x() - first) * scale), columns - 1);
+        if (c != column) {
+            if (column >= 0) {
+                m_decimated.append(min.x() <= max.x() ? min : max);
+                if (min != max) {
+                    m_decimated.append(min.x() <= max.x() ? max : min);
+                }
+            }
+            column = c;
+            min    = max = p;
+        } else if (p.y() < min.y()) {
+            min = p;
+        } else if (p.y() > max.y()) {
+            max = p;
+        }
+    }
+    m_decimated.append(min.x() <= max.x() ? min : max);
+    if (min != max) {
+        m_decimated.append(min.x() <= max.x() ? max : min);
+    }
+    m_isDecimated  = true;
+    m_copiedBytes += m_decimated.size() * sizeof(QPointF);
+}
+
 bool SequentialPlotData::append(UAVObject *obj)
 {
     if (obj == NULL) {
@@ -207,22 +457,7 @@ bool SequentialPlotData::append(UAVObject *obj)
 
     if (m_object == obj && m_field) {
         if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
-
-            // Perform scope math, if necessary
-            if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
-                calcMathFunction(currentValue);
-            } else {
-                m_yDataEntries.append(currentValue);
-            }
-
-            if (m_yDataEntries.size() > m_plotDataSize) {
-                // If new data overflows the window, remove old data...
-                m_yDataEntries.pop_front();
-            } else {
-                // ...otherwise, add a new y point at position xData
-                m_xDataEntries.insert(m_xDataEntries.size(), m_xDataEntries.size());
-            }
+            pullSamples();
             return true;
         } else {
             // Enum markers
@@ -243,6 +478,21 @@ bool SequentialPlotData::append(UAVObject *obj)
     return false;
 }
 
+void SequentialPlotData::appendSample(double time, double value)
+{
+    Q_UNUSED(time);
+
+    // Perform scope math, the time is the sample number
+    value = calcMathFunction(value, m_sampleCount++);
+
+    // If new data overflows the window, remove old data
+    // (the x value is the sample index, see PlotSeriesData)
+    if (m_samples.size() >= m_plotDataSize) {
+        m_samples.removeFirst();
+    }
+    m_samples.append(QPointF(0, value));
+}
+
 bool ChronoPlotData::append(UAVObject *obj)
 {
     if (obj == NULL) {
@@ -250,22 +500,11 @@ bool ChronoPlotData::append(UAVObject *obj)
     }
 
     if (m_object == obj && m_field) {
-        // Get the field of interest
-        // THINK ABOUT REIMPLEMENTING THIS TO SHOW UAVO TIME, NOT SYSTEM TIME
-        QDateTime NOW = QDateTime::currentDateTime();
+        // The enum markers go at the time of the last sample, see ScopeObjectSource
+        double xValue = m_signal->samples().isEmpty() ? ScopeClock::instance()->now() : m_signal->samples().last().x();
 
-        double xValue = NOW.toTime_t() + NOW.time().msec() / 1000.0;
         if (!m_isEnumPlot) {
-            double currentValue = m_field->getValue(m_element).toDouble() * pow(10, m_scalePower);
-
-            // Perform scope math, if necessary
-            if (m_mathFunction == "Boxcar average" || m_mathFunction == "Standard deviation") {
-                calcMathFunction(currentValue);
-            } else {
-                m_yDataEntries.append(currentValue);
-            }
-
-            m_xDataEntries.append(xValue);
+            pullSamples();
         } else {
             // Enum markers
             QString value = m_field->getValue(m_element).toString();
@@ -289,10 +528,9 @@ bool ChronoPlotData::append(UAVObject *obj)
 
 void ChronoPlotData::removeStaleData()
 {
-    while (!m_xDataEntries.isEmpty() &&
-           (m_xDataEntries.last() - m_xDataEntries.first()) > m_plotDataSize) {
-        m_yDataEntries.pop_front();
-        m_xDataEntries.pop_front();
+    while (!m_samples.isEmpty() &&
+           (m_samples.last().x() - m_samples.first().x()) > m_plotDataSize) {
+        m_samples.removeFirst();
     }
     while (!m_enumMarkerList.isEmpty() &&
            (m_enumMarkerList.last()->xValue() - m_enumMarkerList.first()->xValue()) > m_plotDataSize) {
@@ -301,3 +539,199 @@ void ChronoPlotData::removeStaleData()
         delete marker;
     }
 }
+
+void ChronoPlotData::appendSample(double time, double value)
+{
+    // Perform scope math
+    m_samples.append(QPointF(time, calcMathFunction(value, time)));
+}
+
+SpectrumPlotData::SpectrumPlotData(UAVObject *object, UAVObjectField *field, int element,
+                                   int scaleFactor, int meanSamples, QString mathFunction,
+                                   double plotDataSize, QPen pen, bool antialiased)
+    : PlotData(object, field, element, scaleFactor, meanSamples,
+               mathFunction, plotDataSize, pen, antialiased), m_sampleRate(0), m_pendingRate(0), m_discardPending(false)
+{
+    // the new samples are read at each update, keep a few segments in case the scope is late
+    acquireSignal(4 * SEGMENT_SIZE, 0);
+
+    // the curve shows the spectrum, not the samples
+    m_seriesData = new PlotSeriesData(&m_spectrum);
+    m_plotCurve->setData(m_seriesData);
+
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(segmentsTransformed()));
+}
+
+bool SpectrumPlotData::append(UAVObject *obj)
+{
+    if (obj == NULL) {
+        obj = m_object;
+    }
+
+    if (m_object != obj || !m_field) {
+        return false;
+    }
+
+    // the enum option indexes are transformed too
+    double scale = pow(10, m_scalePower);
+    for (quint64 sequence = qMax(m_nextSequence, m_signal->firstSequence());
+         sequence < m_signal->sequence(); sequence++) {
+        const QPointF &sample = m_signal->sample(sequence);
+        appendSample(sample.x(), sample.y() * scale);
+    }
+    m_nextSequence = m_signal->sequence();
+    return true;
+}
+
+void SpectrumPlotData::appendSample(double time, double value)
+{
+    if (!isShared()) {
+        value = calcMathFunction(value, time);
+    }
+    m_values.append(value);
+    m_times.append(time);
+}
+
+/**
+ * Start the transform of the complete segments, unless the previous ones are not done yet.
+ */
+void SpectrumPlotData::updatePlotData()
+{
+    const int hop = SEGMENT_SIZE / 2;
+
+    if (!m_watcher.isRunning() && m_values.size() >= SEGMENT_SIZE) {
+        int count = (m_values.size() - SEGMENT_SIZE) / hop + 1;
+        int used  = (count - 1) * hop + SEGMENT_SIZE;
+
+        // sample rate of the segments, from the sample times
+        double span = m_times.at(used - 1) - m_times.first();
+        m_pendingRate = (span > 0) ? (used - 1) / span : 0;
+        m_pendingTimes.resize(count);
+        for (int i = 0; i < count; i++) {
+            m_pendingTimes[i] = m_times.at(i * hop + SEGMENT_SIZE - 1);
+        }
+        m_watcher.setFuture(QtConcurrent::run(&SpectrumPlotData::transform, m_values.mid(0, used), count));
+
+        // the next segment starts half a segment before the end of the last one
+        m_values.remove(0, count * hop);
+        m_times.remove(0, count * hop);
+    }
+
+    QwtPlot *plot = m_plotCurve->plot();
+    m_seriesData->update(plot ? plot->canvas()->width() : 0);
+    m_plotCurve->itemChanged();
+}
+
+void SpectrumPlotData::clear()
+{
+    PlotData::clear();
+
+    m_values.clear();
+    m_times.clear();
+    m_periodograms.clear();
+    m_periodogramTimes.clear();
+    m_sampleRate     = 0;
+    m_discardPending = m_watcher.isRunning();
+    m_spectrum.clear();
+    m_seriesData->invalidate();
+}
+
+/**
+ * Periodograms of the Hann windowed segments, without the division by the sample rate.
+ * Runs on a worker thread.
+ */
+SpectrumPlotData::Periodograms SpectrumPlotData::transform(QVector<double> values, int segmentCount)
+{
+    const int hop = SEGMENT_SIZE / 2;
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    std::vector<double> window(SEGMENT_SIZE);
+    double windowPower = 0;
+    for (int i = 0; i < SEGMENT_SIZE; i++) {
+        window[i]    = 0.5 - 0.5 * cos(2 * M_PI * i / (SEGMENT_SIZE - 1));
+        windowPower += window[i] * window[i];
+    }
+
+    std::vector<double> segment(SEGMENT_SIZE);
+    std::vector<std::complex<double> > bins;
+    Periodograms periodograms(segmentCount);
+    for (int s = 0; s < segmentCount; s++) {
+        const double *samples = values.constData() + s * hop;
+
+        // remove the mean, an offset (gravity on the accels) would leak into the low frequencies
+        double mean = 0;
+        for (int i = 0; i < SEGMENT_SIZE; i++) {
+            mean += samples[i];
+        }
+        mean /= SEGMENT_SIZE;
+        for (int i = 0; i < SEGMENT_SIZE; i++) {
+            segment[i] = (samples[i] - mean) * window[i];
+        }
+
+        fft.fwd(bins, segment);
+
+        // one-sided, the power of the negative frequencies goes to the positive ones
+        QVector<double> &power = periodograms[s];
+        power.resize((int)bins.size());
+        for (int k = 0; k < power.size(); k++) {
+            power[k] = std::norm(bins[k]) / windowPower * ((k == 0 || k == SEGMENT_SIZE / 2) ? 1 : 2);
+        }
+    }
+    return periodograms;
+}
+
+void SpectrumPlotData::segmentsTransformed()
+{
+    if (m_discardPending) {
+        m_discardPending = false;
+        return;
+    }
+    if (m_pendingRate <= 0) {
+        return;
+    }
+
+    // only the periodograms of the same sample rate can be averaged
+    if (m_sampleRate > 0 && fabs(m_pendingRate - m_sampleRate) < 0.1 * m_sampleRate) {
+        m_sampleRate += (m_pendingRate - m_sampleRate) * 0.1;
+    } else {
+        m_periodograms.clear();
+        m_periodogramTimes.clear();
+        m_sampleRate = m_pendingRate;
+    }
+
+    Periodograms periodograms = m_watcher.result();
+    for (int i = 0; i < periodograms.size(); i++) {
+        m_periodograms.append(periodograms.at(i));
+        m_periodogramTimes.append(m_pendingTimes.at(i));
+    }
+
+    // average over the data size, the last periodogram at least
+    while (m_periodograms.size() > 1 && m_periodogramTimes.last() - m_periodogramTimes.first() > m_plotDataSize) {
+        m_periodograms.removeFirst();
+        m_periodogramTimes.removeFirst();
+    }
+    updateSpectrum();
+}
+
+void SpectrumPlotData::updateSpectrum()
+{
+    m_spectrum.clear();
+    m_seriesData->invalidate();
+    if (m_periodograms.isEmpty()) {
+        return;
+    }
+
+    int binCount = m_periodograms.first().size();
+    double scale = 1.0 / (m_periodograms.size() * m_sampleRate);
+    m_spectrum.reserve(binCount);
+    for (int k = 0; k < binCount; k++) {
+        double sum = 0;
+        foreach(const QVector<double> &power, m_periodograms) {
+            sum += power.at(k);
+        }
+        // in dB, the bins without power at the bottom of the plot instead of -inf
+        m_spectrum.append(QPointF(k * m_sampleRate / SEGMENT_SIZE, 10 * log10(qMax(sum * scale, 1e-20))));
+    }
+}
@@ -29,14 +29,17 @@
 #define PLOTDATA_H
 
 #include "uavobject.h"
+#include "scopesamplestore.h"
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_plot.h"
 #include "qwt/src/qwt_plot_curve.h"
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
+#include "qwt/src/qwt_series_data.h"
 #include <qwt/src/qwt_plot_marker.h>
 
+#include <QFutureWatcher>
 #include <QTimer>
 #include <QTime>
 #include <QVector>
@@ -45,7 +48,99 @@
 /*!
    \brief Defines the different type of plots.
  */
-enum PlotType { SequentialPlot, ChronoPlot };
+enum PlotType { SequentialPlot, ChronoPlot, SpectrumPlot };
+
+/*!
+   \brief Gives Qwt access to the samples of a curve without copying them.
+   The curve owns it, see QwtPlotSeriesItem::setData().
+   When there are many more samples than pixels, only the minimum and maximum
+   of each pixel column are drawn: the curve looks the same but is much faster to draw.
+ */
+class PlotSeriesData : public QwtSeriesData<QPointF> {
+public:
+    PlotSeriesData(const PlotSampleBuffer *buffer) : m_buffer(buffer), m_first(0), m_count(-1), m_scale(1.0),
+        m_indexAsX(false), m_isDecimated(false), m_copiedBytes(0) {}
+
+    // Use the sample index as x value (sequential plots)
+    void setIndexAsX(bool indexAsX)
+    {
+        m_indexAsX = indexAsX;
+    }
+    // Only give the samples from first on, all of them when count is negative
+    void setRange(int first, int count)
+    {
+        m_first = first;
+        m_count = count;
+    }
+    // Factor applied to the y values
+    void setScale(double scale)
+    {
+        m_scale = scale;
+    }
+
+    size_t size() const
+    {
+        return m_isDecimated ? m_decimated.size() : rangeSize();
+    }
+    QPointF sample(size_t i) const
+    {
+        return m_isDecimated ? m_decimated.at(i) : bufferSample(i);
+    }
+    QRectF boundingRect() const
+    {
+        if (d_boundingRect.width() < 0.0) {
+            d_boundingRect = qwtBoundingRect(*this);
+        }
+        return d_boundingRect;
+    }
+    // Must be called when the samples have changed
+    void invalidate()
+    {
+        d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0);
+        m_isDecimated  = false;
+    }
+    // Same as invalidate(), then decimate the samples for the given number of pixel columns
+    void update(int columns);
+
+    // Serial number of the first sample given, the samples given keep their index while it is the same
+    quint64 firstSerial() const
+    {
+        return m_buffer->firstSerial() + m_first;
+    }
+    bool isDecimated() const
+    {
+        return m_isDecimated;
+    }
+    // Bytes copied out of the sample buffer so far, only the decimated samples are copied
+    quint64 copiedBytes() const
+    {
+        return m_copiedBytes;
+    }
+
+private:
+    const PlotSampleBuffer *m_buffer;
+    int m_first;
+    int m_count;
+    double m_scale;
+    bool m_indexAsX;
+    bool m_isDecimated;
+    QVector<QPointF> m_decimated;
+    quint64 m_copiedBytes;
+
+    int rangeSize() const
+    {
+        // the buffer may have been trimmed since the range was set
+        int size = qMax(m_buffer->size() - m_first, 0);
+
+        return m_count < 0 ? size : qMin(m_count, size);
+    }
+    QPointF bufferSample(int i) const
+    {
+        const QPointF &s = m_buffer->at(m_first + i);
+
+        return QPointF(m_indexAsX ? i : s.x(), s.y() * m_scale);
+    }
+};
 
 /*!
    \brief Base class that keeps the data for each curve in the plot.
@@ -92,13 +187,29 @@ public:
     virtual PlotType plotType() const   = 0;
     virtual void removeStaleData() = 0;
 
-    void updatePlotData();
-    void clear();
+    virtual void updatePlotData();
+    virtual void clear();
 
     bool hasData() const;
     QString lastDataAsString();
+    // last value, the option index for enum plots
+    double lastData();
 
     void attach(QwtPlot *plot);
+    QwtPlotCurve *curve() const
+    {
+        return m_plotCurve;
+    }
+    // Bytes of samples copied to draw the curve so far
+    quint64 copiedBytes() const
+    {
+        return m_seriesData ? m_seriesData->copiedBytes() : 0;
+    }
+
+    // Give the range of the samples added since markPainted(), including the last one painted
+    // to join them. Returns false when the curve must be drawn again.
+    bool appendedSamples(int *from, int *to) const;
+    void markPainted();
 
 public slots:
     void visibilityChanged(QwtPlotItem *item);
@@ -113,9 +224,34 @@ protected:
     int m_correctionCount;
     double m_plotDataSize;
 
-    QVector<double> m_xDataEntries;
-    QVector<double> m_yDataEntries;
-    QVector<double> m_yDataHistory;
+    // Samples shared with the other curves plotting the same element,
+    // the curves without math plot them directly
+    ScopeSignal *m_signal;
+    int m_keepCount;
+    double m_keepAge;
+    // next sample of the signal to read, first one to plot after a clear
+    quint64 m_nextSequence;
+    quint64 m_clearSequence;
+    // samples of the curves with math
+    PlotSampleBuffer m_samples;
+    PlotSeriesData *m_seriesData;
+
+    // Scope math, selected by the m_mathFunction string
+    enum MathFunction { MathNone, MathBoxcarAverage, MathStandardDeviation, MathExponentialAverage,
+                        MathMedian, MathMinimum, MathMaximum, MathDerivative };
+    MathFunction m_mathFunctionType;
+    // values of the math window, x is the sample number
+    PlotSampleBuffer m_mathWindow;
+    // monotonic deque of the window minimum or maximum candidates
+    PlotSampleBuffer m_mathExtrema;
+    // sorted values of the math window (median)
+    QVector<double> m_mathSorted;
+    quint64 m_mathSampleNumber;
+    double m_mathMean;
+    double m_mathM2;
+    double m_mathResult;
+    double m_mathLastValue;
+    double m_mathLastTime;
 
     UAVObject *m_object;
     UAVObjectField *m_field;
@@ -124,10 +260,24 @@ protected:
     QwtPlotCurve *m_plotCurve;
     QString m_plotName;
     QList<QwtPlotMarker *> m_enumMarkerList;
+    // curve as last painted, see markPainted()
+    quint64 m_paintedSerial;
+    int m_paintedCount;
+    int m_paintedMarkers;
     bool m_isVisible;
     QPen m_pen;
     bool m_isEnumPlot;
-    virtual void calcMathFunction(double currentValue);
+    virtual double calcMathFunction(double currentValue, double time);
+    void clearMathFunction();
+    bool isShared() const
+    {
+        return m_mathFunctionType == MathNone;
+    }
+    // Get the signal, keeping the given number of samples and seconds of samples for this curve
+    void acquireSignal(int keepCount, double keepAge);
+    // Read the new samples of the signal, appendSample() is called for each of them with math
+    void pullSamples();
+    virtual void appendSample(double time, double value) = 0;
     QwtPlotMarker *createMarker(QString value);
 };
 
@@ -142,7 +292,16 @@ public:
                        int scaleFactor, int meanSamples, QString mathFunction,
                        double plotDataSize, QPen pen, bool antialiased)
         : PlotData(object, field, element, scaleFactor, meanSamples,
-                   mathFunction, plotDataSize, pen, antialiased) {}
+                   mathFunction, plotDataSize, pen, antialiased), m_sampleCount(0)
+    {
+        m_seriesData->setIndexAsX(true);
+        if (isShared()) {
+            acquireSignal((int)plotDataSize, 0);
+        } else {
+            acquireSignal(1, 0);
+            m_samples.reserve((int)plotDataSize);
+        }
+    }
     ~SequentialPlotData() {}
 
     bool append(UAVObject *obj);
@@ -151,6 +310,13 @@ public:
         return SequentialPlot;
     }
     void removeStaleData() {}
+
+protected:
+    void appendSample(double time, double value);
+
+private:
+    // time of the samples for the scope math
+    quint64 m_sampleCount;
 };
 
 /*!
@@ -164,7 +330,13 @@ public:
                    double plotDataSize, QPen pen, bool antialiased)
         : PlotData(object, field, element, scaleFactor, meanSamples,
                    mathFunction, plotDataSize, pen, antialiased)
-    {}
+    {
+        if (isShared()) {
+            acquireSignal(1, plotDataSize);
+        } else {
+            acquireSignal(1, 0);
+        }
+    }
     ~ChronoPlotData() {}
 
     bool append(UAVObject *obj);
@@ -173,6 +345,63 @@ public:
         return ChronoPlot;
     }
     void removeStaleData();
+
+protected:
+    void appendSample(double time, double value);
+};
+
+/*!
+   \brief The spectrum plot shows the power spectral density of the signal in dB against the frequency in Hz.
+   It averages the periodograms of the Hann windowed segments of the signal over the data size, in seconds
+   (Welch's method). The new segments are transformed on a worker thread at each refresh.
+ */
+class SpectrumPlotData : public PlotData {
+    Q_OBJECT
+public:
+    SpectrumPlotData(UAVObject *object, UAVObjectField *field, int element,
+                     int scaleFactor, int meanSamples, QString mathFunction,
+                     double plotDataSize, QPen pen, bool antialiased);
+    ~SpectrumPlotData() {}
+
+    bool append(UAVObject *obj);
+    PlotType plotType() const
+    {
+        return SpectrumPlot;
+    }
+    void removeStaleData() {}
+    void updatePlotData();
+    void clear();
+
+    // samples per segment, the frequency resolution is the sample rate divided by it
+    static const int SEGMENT_SIZE = 256;
+
+protected:
+    void appendSample(double time, double value);
+
+private slots:
+    void segmentsTransformed();
+
+private:
+    // periodograms of consecutive segments, overlapping by half a segment
+    typedef QVector<QVector<double> > Periodograms;
+
+    // samples not transformed yet, from the first one of the next segment
+    QVector<double> m_values;
+    QVector<double> m_times;
+    // periodograms averaged and the time of the end of their segment
+    QList<QVector<double> > m_periodograms;
+    QList<double> m_periodogramTimes;
+    double m_sampleRate;
+    // segments being transformed
+    QFutureWatcher<Periodograms> m_watcher;
+    QVector<double> m_pendingTimes;
+    double m_pendingRate;
+    bool m_discardPending;
+    // frequency, power spectral density
+    PlotSampleBuffer m_spectrum;
+
+    static Periodograms transform(QVector<double> values, int segmentCount);
+    void updateSpectrum();
 };
 
 #endif // PLOTDATA_H
@@ -1,31 +1,40 @@
 TEMPLATE = lib
 TARGET = ScopeGadget
 
-QT += widgets
+QT += widgets opengl concurrent
 
 DEFINES += SCOPE_LIBRARY
 
 include(../../plugin.pri)
 include (scope_dependencies.pri)
 
+# Eigen FFT (kissfft backend) for the spectrum plots
+INCLUDEPATH += ../../libs/eigen
+
 HEADERS += \
     scopeplugin.h \
     plotdata.h \
+    scopesamplestore.h \
+    scopeclock.h \
     scope_global.h \
     scopegadgetoptionspage.h \
     scopegadgetconfiguration.h \
     scopegadget.h \
     scopegadgetwidget.h \
+    scopecsvlogger.h \
     scopegadgetfactory.h
 
 SOURCES += \
     scopeplugin.cpp \
     plotdata.cpp \
+    scopesamplestore.cpp \
+    scopeclock.cpp \
     scopegadgetoptionspage.cpp \
     scopegadgetconfiguration.cpp \
     scopegadget.cpp \
     scopegadgetfactory.cpp \
-    scopegadgetwidget.cpp
+    scopegadgetwidget.cpp \
+    scopecsvlogger.cpp
 
 OTHER_FILES += ScopeGadget.pluginspec
 
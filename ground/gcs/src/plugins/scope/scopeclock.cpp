@@ -0,0 +1,208 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopeclock.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief      The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "scopeclock.h"
+#include "scopesamplestore.h"
+
+#include <extensionsystem/pluginmanager.h>
+#include <uavtalk/uavtalk.h>
+#include <uavtalk/latencyhistogram.h>
+#include <utils/logfile.h>
+
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QThread>
+
+double WallClockTimeBase::now()
+{
+    QDateTime NOW = QDateTime::currentDateTime();
+
+    return NOW.toTime_t() + NOW.time().msec() / 1000.0;
+}
+
+/**
+ * The updates unpacked by UAVTalk are timed with the arrival of their packet on the link.
+ */
+double WallClockTimeBase::captureTime()
+{
+    double time    = now();
+    qint64 arrival = UAVTalk::unpackTimestamp();
+
+    if (arrival) {
+        time -= (LatencyHistogram::timestamp() - arrival) / 1000000.0;
+    }
+    return time;
+}
+
+ReplayTimeBase::ReplayTimeBase(LogFile *logFile) : m_logFile(logFile),
+    m_position(logFile->replayTimeStamp() / 1000.0), m_speed(1.0), m_playing(logFile->isPlaying()), m_lastNow(0)
+{
+    m_elapsed.start();
+
+    // the log file lives in the telemetry thread, these are queued
+    connect(logFile, SIGNAL(replayStarted()), this, SLOT(replayStarted()));
+    connect(logFile, SIGNAL(replayPaused()), this, SLOT(replayPaused()));
+    connect(logFile, SIGNAL(replayFinished()), this, SLOT(replayPaused()));
+    connect(logFile, SIGNAL(replayCompleted()), this, SLOT(replayPaused()));
+    connect(logFile, SIGNAL(replaySpeedChanged(double)), this, SLOT(replaySpeedChanged(double)));
+    connect(logFile, SIGNAL(playbackPositionChanged(quint32)), this, SLOT(playbackPositionChanged(quint32)));
+}
+
+/**
+ * Last position told by the log file, advanced at the replay speed since while playing.
+ */
+double ReplayTimeBase::now()
+{
+    QMutexLocker locker(&m_mutex);
+
+    double time = m_position;
+
+    if (m_playing) {
+        time += m_elapsed.elapsed() / 1000.0 * m_speed;
+    }
+    if (m_playing && time < m_lastNow) {
+        time = m_lastNow;
+    }
+    m_lastNow = time;
+    return time;
+}
+
+/**
+ * The log file replays its records from its own thread, the updates they carry are
+ * unpacked right away and timed with the record. Local updates are timed with now().
+ */
+double ReplayTimeBase::captureTime()
+{
+    if (QThread::currentThread() == m_logFile->thread()) {
+        return m_logFile->replayTimeStamp() / 1000.0;
+    }
+    return now();
+}
+
+void ReplayTimeBase::replayStarted()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_playing = true;
+    m_elapsed.restart();
+}
+
+void ReplayTimeBase::replayPaused()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_playing) {
+        m_position += m_elapsed.elapsed() / 1000.0 * m_speed;
+    }
+    m_playing = false;
+}
+
+void ReplayTimeBase::replaySpeedChanged(double speed)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_playing) {
+        m_position += m_elapsed.elapsed() / 1000.0 * m_speed;
+        m_elapsed.restart();
+    }
+    m_speed = speed;
+}
+
+void ReplayTimeBase::playbackPositionChanged(quint32 position)
+{
+    bool back;
+    {
+        QMutexLocker locker(&m_mutex);
+
+        back       = (position / 1000.0 < m_position);
+        m_position = position / 1000.0;
+        m_elapsed.restart();
+        if (back) {
+            m_lastNow = m_position;
+        }
+    }
+    if (back) {
+        emit rewound();
+    }
+}
+
+ScopeClock *ScopeClock::m_instance = NULL;
+
+ScopeClock *ScopeClock::instance()
+{
+    if (!m_instance) {
+        m_instance = new ScopeClock();
+    }
+    return m_instance;
+}
+
+ScopeClock::ScopeClock() : m_replay(NULL), m_timeBase(&m_wallClock)
+{
+    // the logging plugin puts its log file in the object pool
+    LogFile *logFile = ExtensionSystem::PluginManager::instance()->getObject<LogFile>();
+
+    if (logFile) {
+        m_replay = new ReplayTimeBase(logFile);
+        m_replay->setParent(this);
+        connect(logFile, SIGNAL(replayStarted()), this, SLOT(replayStarted()));
+        connect(logFile, SIGNAL(replayFinished()), this, SLOT(replayFinished()));
+        connect(m_replay, SIGNAL(rewound()), this, SLOT(replayRewound()));
+        if (logFile->getReplayState() != STOPPED) {
+            m_timeBase.storeRelease(m_replay);
+        }
+    }
+}
+
+void ScopeClock::replayStarted()
+{
+    setTimeBase(m_replay);
+}
+
+void ScopeClock::replayFinished()
+{
+    setTimeBase(&m_wallClock);
+}
+
+void ScopeClock::replayRewound()
+{
+    if (isReplay()) {
+        ScopeSampleStore::clearSamples();
+        emit reset();
+    }
+}
+
+void ScopeClock::setTimeBase(ScopeTimeBase *timeBase)
+{
+    if (m_timeBase.load() == timeBase) {
+        return;
+    }
+    m_timeBase.storeRelease(timeBase);
+
+    // the samples taken with the other time base don't line up with the new ones
+    ScopeSampleStore::clearSamples();
+    emit reset();
+}
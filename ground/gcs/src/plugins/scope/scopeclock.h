@@ -0,0 +1,139 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopeclock.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief      The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCOPECLOCK_H
+#define SCOPECLOCK_H
+
+#include <QObject>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QMutex>
+
+class LogFile;
+
+/*!
+   \brief Time base of the scopes, in seconds.
+ */
+class ScopeTimeBase {
+public:
+    virtual ~ScopeTimeBase() {}
+
+    // Time of the right end of the chrono plots
+    virtual double now() = 0;
+    // Time of the object update being captured, called from the thread updating the object
+    virtual double captureTime() = 0;
+};
+
+/*!
+   \brief Host wall clock, the received updates are timed with their arrival on the link.
+ */
+class WallClockTimeBase : public ScopeTimeBase {
+public:
+    double now();
+    double captureTime();
+};
+
+/*!
+   \brief Log time of a replay, follows the replay speed, the pauses and the seeks.
+   The updates replayed are timed with their log record.
+ */
+class ReplayTimeBase : public QObject, public ScopeTimeBase {
+    Q_OBJECT
+
+public:
+    ReplayTimeBase(LogFile *logFile);
+
+    double now();
+    double captureTime();
+
+signals:
+    // the replay went back in time
+    void rewound();
+
+private slots:
+    void replayStarted();
+    void replayPaused();
+    void replaySpeedChanged(double speed);
+    void playbackPositionChanged(quint32 position);
+
+private:
+    LogFile *m_logFile;
+
+    // last position told by the log file and the time since, guarded by the mutex
+    QMutex m_mutex;
+    double m_position;
+    double m_speed;
+    bool m_playing;
+    QElapsedTimer m_elapsed;
+    // now() never goes back while playing
+    double m_lastNow;
+};
+
+/*!
+   \brief Time base of all the scopes, the replay clock while a log is replayed, else the wall clock.
+ */
+class ScopeClock : public QObject {
+    Q_OBJECT
+
+public:
+    static ScopeClock *instance();
+
+    double now()
+    {
+        return m_timeBase.loadAcquire()->now();
+    }
+    double captureTime()
+    {
+        return m_timeBase.loadAcquire()->captureTime();
+    }
+    bool isReplay() const
+    {
+        return m_timeBase.loadAcquire() != &m_wallClock;
+    }
+
+signals:
+    // The time base changed or went back in time, the samples taken so far have been cleared
+    void reset();
+
+private slots:
+    void replayStarted();
+    void replayFinished();
+    void replayRewound();
+
+private:
+    ScopeClock();
+
+    static ScopeClock *m_instance;
+
+    WallClockTimeBase m_wallClock;
+    ReplayTimeBase *m_replay;
+    QAtomicPointer<ScopeTimeBase> m_timeBase;
+
+    void setTimeBase(ScopeTimeBase *timeBase);
+};
+
+#endif // SCOPECLOCK_H
@@ -0,0 +1,232 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopecsvlogger.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief      The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "scopecsvlogger.h"
+
+#include <QDateTime>
+#include <QDataStream>
+#include <QTextStream>
+#include <QDebug>
+#include <qnumeric.h>
+
+#define BINARY_MAGIC     "OPSC"
+#define BINARY_VERSION   1
+#define FLAG_CONNECTED   0x01
+#define FLAG_UPDATED     0x02
+
+ScopeCsvLogger::ScopeCsvLogger(QObject *parent) : QThread(parent),
+    m_binary(false), m_startTime(0), m_droppedSamples(0)
+{}
+
+ScopeCsvLogger::~ScopeCsvLogger()
+{
+    stopLogging();
+}
+
+bool ScopeCsvLogger::startLogging(const QString &fileName, const QStringList &columns,
+                                  const QList<QStringList> &enumOptions, bool binary)
+{
+    stopLogging();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "Unable to open " << m_file.fileName() << " for csv logging";
+        return false;
+    }
+    m_binary      = binary;
+    m_columns     = columns;
+    m_enumOptions = enumOptions;
+    m_startTime   = QDateTime::currentMSecsSinceEpoch();
+
+    m_times.resize(QUEUE_SIZE);
+    m_flags.resize(QUEUE_SIZE);
+    m_values.resize(QUEUE_SIZE * m_columns.size());
+    m_head = 0;
+    m_tail = 0;
+    m_stop = 0;
+    m_droppedSamples = 0;
+
+    writeHeader();
+    start(QThread::LowPriority);
+    return true;
+}
+
+void ScopeCsvLogger::stopLogging()
+{
+    if (!isRunning()) {
+        return;
+    }
+    m_stop = 1;
+    wait();
+    m_file.close();
+    if (m_droppedSamples) {
+        qDebug() << "ScopeCsvLogger -" << m_droppedSamples << "samples dropped in" << m_file.fileName();
+    }
+}
+
+bool ScopeCsvLogger::addSample(qint64 time, bool connected, bool updated, const QVector<double> &values)
+{
+    if (!isRunning()) {
+        return false;
+    }
+    int head = m_head.loadAcquire();
+    int next = (head + 1) % QUEUE_SIZE;
+    if (next == m_tail.loadAcquire()) {
+        m_droppedSamples++;
+        return false;
+    }
+
+    int columns = m_columns.size();
+    double *row = m_values.data() + head * columns;
+    for (int i = 0; i < columns; i++) {
+        row[i] = (i < values.size()) ? values.at(i) : qQNaN();
+    }
+    m_times[head] = time;
+    m_flags[head] = (connected ? FLAG_CONNECTED : 0) | (updated ? FLAG_UPDATED : 0);
+
+    m_head.storeRelease(next);
+    return true;
+}
+
+void ScopeCsvLogger::run()
+{
+    bool stop = false;
+
+    while (!stop) {
+        // read the stop flag first so that the samples queued before stopping are written
+        stop = m_stop.loadAcquire();
+
+        int tail = m_tail.loadAcquire();
+        int head = m_head.loadAcquire();
+        if (tail != head) {
+            tail = formatRows(tail, head);
+            m_tail.storeRelease(tail);
+        }
+        if (m_buffer.size() >= WRITE_SIZE || (stop && !m_buffer.isEmpty()) || (tail == head && !m_buffer.isEmpty())) {
+            m_file.write(m_buffer);
+            m_buffer.clear();
+        }
+        if (!stop && tail == head) {
+            // let the samples accumulate, they are formatted in batches
+            msleep(100);
+        }
+    }
+    m_file.flush();
+}
+
+/**
+ * Format the queued rows from tail up to head, returns the new tail
+ */
+int ScopeCsvLogger::formatRows(int tail, int head)
+{
+    if (!m_binary) {
+        while (tail != head) {
+            formatCsv(tail);
+            tail = (tail + 1) % QUEUE_SIZE;
+        }
+        return tail;
+    }
+
+    // one block per contiguous run of the queue
+    int end     = (head > tail) ? head : QUEUE_SIZE;
+    int rows    = end - tail;
+    int columns = m_columns.size();
+    QDataStream stream(&m_buffer, QIODevice::WriteOnly | QIODevice::Append);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream << (quint32)rows;
+    for (int i = tail; i < end; i++) {
+        stream << m_times.at(i);
+    }
+    for (int i = tail; i < end; i++) {
+        stream << (quint8)((m_flags.at(i) & FLAG_CONNECTED) ? 1 : 0);
+    }
+    for (int i = tail; i < end; i++) {
+        stream << (quint8)((m_flags.at(i) & FLAG_UPDATED) ? 1 : 0);
+    }
+    for (int column = 0; column < columns; column++) {
+        for (int i = tail; i < end; i++) {
+            stream << m_values.at(i * columns + column);
+        }
+    }
+    return end % QUEUE_SIZE;
+}
+
+void ScopeCsvLogger::formatCsv(int row)
+{
+    QDateTime time  = QDateTime::fromMSecsSinceEpoch(m_times.at(row));
+    QString line;
+
+    line.reserve(64 + 16 * m_columns.size());
+    line += time.toString("yyyy-MM-dd");
+    line += ", ";
+    line += time.toString("hh:mm:ss.z");
+    line += ", ";
+    line += QString::number((m_times.at(row) - m_startTime) / 1000.00);
+    line += (m_flags.at(row) & FLAG_CONNECTED) ? ", 1" : ", 0";
+    line += (m_flags.at(row) & FLAG_UPDATED) ? ", 1" : ", 0";
+
+    int columns = m_columns.size();
+    const double *values = m_values.constData() + row * columns;
+    for (int i = 0; i < columns; i++) {
+        line += ", ";
+        if (qIsNaN(values[i])) {
+            continue;
+        }
+        const QStringList &options = m_enumOptions.at(i);
+        if (!options.isEmpty()) {
+            line += options.value((int)values[i]);
+        } else {
+            line += QString().sprintf("%3.10g", values[i]);
+        }
+    }
+    line += '\n';
+    m_buffer += line.toUtf8();
+}
+
+void ScopeCsvLogger::writeHeader()
+{
+    if (m_binary) {
+        QDataStream stream(&m_file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.writeRawData(BINARY_MAGIC, 4);
+        stream << (quint32)BINARY_VERSION << (quint32)m_columns.size();
+        foreach(QString column, m_columns) {
+            QByteArray name = column.toUtf8();
+            stream << (quint16)name.size();
+            stream.writeRawData(name.constData(), name.size());
+        }
+    } else {
+        QTextStream ts(&m_file);
+        ts << "date" << ", " << "Time" << ", " << "Sec since start" << ", " << "Connected" << ", " << "Data changed";
+        foreach(QString column, m_columns) {
+            ts << ", " << column;
+        }
+        ts << endl;
+    }
+}
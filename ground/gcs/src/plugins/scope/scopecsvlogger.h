@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopecsvlogger.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief      The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCOPECSVLOGGER_H
+#define SCOPECSVLOGGER_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+
+/*!
+   \brief Writes the scope samples to a file from its own thread.
+
+   The GUI thread queues binary samples (one value per column) in a lock free
+   single producer / single consumer queue and the writer thread formats them
+   in batches and writes them with large writes.
+   The output is a csv file, or a binary column file:
+   "OPSC", version, column count, names (UTF-8, quint16 length), then blocks of
+   rows: row count, the time column (ms since epoch), the connected and updated
+   columns and a column of doubles per curve (NaN when there is no data),
+   all little endian.
+ */
+class ScopeCsvLogger : public QThread {
+    Q_OBJECT
+
+public:
+    ScopeCsvLogger(QObject *parent = 0);
+    ~ScopeCsvLogger();
+
+    // Enum columns get their option names, the value being the option index (csv only)
+    bool startLogging(const QString &fileName, const QStringList &columns,
+                      const QList<QStringList> &enumOptions, bool binary);
+    void stopLogging();
+    bool isLogging() const
+    {
+        return isRunning();
+    }
+
+    // Producer side, returns false when the queue is full and the sample is dropped
+    bool addSample(qint64 time, bool connected, bool updated, const QVector<double> &values);
+
+    quint32 droppedSamples() const
+    {
+        return m_droppedSamples;
+    }
+
+protected:
+    void run();
+
+private:
+    static const int QUEUE_SIZE = 4096;
+    static const int WRITE_SIZE = 64 * 1024;
+
+    QFile m_file;
+    bool m_binary;
+    QStringList m_columns;
+    QList<QStringList> m_enumOptions;
+    qint64 m_startTime;
+    QAtomicInt m_stop;
+
+    // queue, written at m_head by the producer and read at m_tail by the writer thread
+    QVector<qint64> m_times;
+    QVector<quint8> m_flags;
+    QVector<double> m_values;
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+    quint32 m_droppedSamples;
+
+    QByteArray m_buffer;
+
+    int formatRows(int tail, int head);
+    void formatCsv(int row);
+    void writeHeader();
+};
+
+#endif // SCOPECSVLOGGER_H
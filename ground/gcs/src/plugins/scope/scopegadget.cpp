@@ -51,11 +51,14 @@ void ScopeGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     widget->setObjectName(config->name());
     widget->setPlotDataSize(sgConfig->dataSize());
     widget->setRefreshInterval(sgConfig->refreshInterval());
+    widget->setOpenGLCanvas(sgConfig->openGLCanvas());
 
     if (sgConfig->plotType() == SequentialPlot) {
         widget->setupSequentialPlot();
     } else if (sgConfig->plotType() == ChronoPlot) {
         widget->setupChronoPlot();
+    } else if (sgConfig->plotType() == SpectrumPlot) {
+        widget->setupSpectrumPlot();
     }
 
     foreach(PlotCurveConfiguration * plotCurveConfig, sgConfig->plotCurveConfigs()) {
@@ -85,6 +88,7 @@ void ScopeGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     widget->setLoggingEnabled(sgConfig->getLoggingEnabled());
     widget->setLoggingNewFileOnConnect(sgConfig->getLoggingNewFileOnConnect());
     widget->setLoggingPath(sgConfig->getLoggingPath());
+    widget->setLoggingBinary(sgConfig->getLoggingBinary());
 
     widget->csvLoggingStop();
     widget->csvLoggingSetName(sgConfig->name());
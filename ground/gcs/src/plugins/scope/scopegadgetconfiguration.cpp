@@ -29,7 +29,7 @@
 #include "scopegadgetconfiguration.h"
 
 ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings &settings, QObject *parent) :
-    IUAVGadgetConfiguration(classId, parent)
+    IUAVGadgetConfiguration(classId, parent), m_openGLCanvas(false), m_loggingBinary(false)
 {
     uint currentStreamVersion = settings.value("configurationStreamVersion").toUInt();
 
@@ -40,6 +40,7 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings &s
     m_plotType = settings.value("plotType", ChronoPlot).toInt();
     m_dataSize = settings.value("dataSize", 60).toInt();
     m_refreshInterval  = settings.value("refreshInterval", 1000).toInt();
+    m_openGLCanvas     = settings.value("openGLCanvas", false).toBool();
     m_mathFunctionType = 0;
 
     int plotCurveCount = settings.value("plotCurveCount").toInt();
@@ -65,6 +66,7 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings &s
     m_loggingEnabled = settings.value("LoggingEnabled").toBool();
     m_loggingNewFileOnConnect = settings.value("LoggingNewFileOnConnect").toBool();
     m_loggingPath    = settings.value("LoggingPath").toString();
+    m_loggingBinary  = settings.value("LoggingBinary", false).toBool();
 }
 
 ScopeGadgetConfiguration::ScopeGadgetConfiguration(const ScopeGadgetConfiguration & obj) :
@@ -74,6 +76,7 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(const ScopeGadgetConfiguratio
     m_dataSize = obj.m_dataSize;
     m_mathFunctionType = obj.m_mathFunctionType;
     m_refreshInterval  = obj.m_refreshInterval;
+    m_openGLCanvas     = obj.m_openGLCanvas;
 
     int plotCurveCount = obj.m_plotCurveConfigs.size();
     for (int i = 0; i < plotCurveCount; i++) {
@@ -96,6 +99,7 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(const ScopeGadgetConfiguratio
     m_loggingEnabled = obj.m_loggingEnabled;
     m_loggingNewFileOnConnect = obj.m_loggingNewFileOnConnect;
     m_loggingPath    = obj.m_loggingPath;
+    m_loggingBinary  = obj.m_loggingBinary;
 }
 
 ScopeGadgetConfiguration::~ScopeGadgetConfiguration()
@@ -136,6 +140,7 @@ void ScopeGadgetConfiguration::saveConfig(QSettings &settings) const
     settings.setValue("plotType", m_plotType);
     settings.setValue("dataSize", m_dataSize);
     settings.setValue("refreshInterval", m_refreshInterval);
+    settings.setValue("openGLCanvas", m_openGLCanvas);
     settings.setValue("plotCurveCount", plotCurveCount);
 
     for (int i = 0; i < plotCurveCount; i++) {
@@ -158,6 +163,7 @@ void ScopeGadgetConfiguration::saveConfig(QSettings &settings) const
     settings.setValue("LoggingEnabled", m_loggingEnabled);
     settings.setValue("LoggingNewFileOnConnect", m_loggingNewFileOnConnect);
     settings.setValue("LoggingPath", m_loggingPath);
+    settings.setValue("LoggingBinary", m_loggingBinary);
 }
 
 void ScopeGadgetConfiguration::replacePlotCurveConfig(QList<PlotCurveConfiguration *> newPlotCurveConfigs)
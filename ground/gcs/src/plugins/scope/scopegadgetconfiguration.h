@@ -73,6 +73,10 @@ public:
     {
         m_refreshInterval = value;
     }
+    void setOpenGLCanvas(bool value)
+    {
+        m_openGLCanvas = value;
+    }
     void addPlotCurveConfig(PlotCurveConfiguration *value)
     {
         m_plotCurveConfigs.append(value);
@@ -96,6 +100,10 @@ public:
     {
         return m_refreshInterval;
     }
+    bool openGLCanvas()
+    {
+        return m_openGLCanvas;
+    }
     QList<PlotCurveConfiguration *> plotCurveConfigs()
     {
         return m_plotCurveConfigs;
@@ -113,6 +121,10 @@ public:
     {
         return m_loggingPath;
     }
+    bool getLoggingBinary()
+    {
+        return m_loggingBinary;
+    }
     void setLoggingEnabled(bool value)
     {
         m_loggingEnabled = value;
@@ -125,6 +137,10 @@ public:
     {
         m_loggingPath = value;
     }
+    void setLoggingBinary(bool value)
+    {
+        m_loggingBinary = value;
+    }
 
 private:
     // Increment this if the stream format is not compatible with previous versions. This would cause existing configs to be discarded.
@@ -135,6 +151,8 @@ private:
     int m_dataSize;
     // The interval to replot the curve widget. The data buffer is refresh as the data comes in.
     int m_refreshInterval;
+    // Draw the plot on an OpenGL canvas
+    bool m_openGLCanvas;
     // The type of math function to be used in the scope analysis
     int m_mathFunctionType;
     QList<PlotCurveConfiguration *> m_plotCurveConfigs;
@@ -143,6 +161,7 @@ private:
     bool m_loggingEnabled;
     bool m_loggingNewFileOnConnect;
     QString m_loggingPath;
+    bool m_loggingBinary;
 };
 
 #endif // SCOPEGADGETCONFIGURATION_H
@@ -55,6 +55,7 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
 
     options_page->cmbPlotType->addItem("Sequential Plot", "");
     options_page->cmbPlotType->addItem("Chronological Plot", "");
+    options_page->cmbPlotType->addItem("Spectrum Plot", "");
 
     // Fills the combo boxes for the UAVObjects
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -72,6 +73,11 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     options_page->mathFunctionComboBox->addItem("None");
     options_page->mathFunctionComboBox->addItem("Boxcar average");
     options_page->mathFunctionComboBox->addItem("Standard deviation");
+    options_page->mathFunctionComboBox->addItem("Exponential average");
+    options_page->mathFunctionComboBox->addItem("Median");
+    options_page->mathFunctionComboBox->addItem("Minimum");
+    options_page->mathFunctionComboBox->addItem("Maximum");
+    options_page->mathFunctionComboBox->addItem("Derivative");
 
     if (options_page->cmbUAVObjects->currentIndex() >= 0) {
         on_cmbUAVObjects_currentIndexChanged(options_page->cmbUAVObjects->currentText());
@@ -100,6 +106,7 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     options_page->mathFunctionComboBox->setCurrentIndex(m_config->mathFunctionType());
     options_page->spnDataSize->setValue(m_config->dataSize());
     options_page->spnRefreshInterval->setValue(m_config->refreshInterval());
+    options_page->OpenGLCanvas->setChecked(m_config->openGLCanvas());
 
     // add the configured curves
     foreach(PlotCurveConfiguration * plotData, m_config->plotCurveConfigs()) {
@@ -132,6 +139,7 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
     options_page->LoggingPath->setPromptDialogTitle(tr("Choose Logging Directory"));
     options_page->LoggingPath->setPath(m_config->getLoggingPath());
     options_page->LoggingConnect->setChecked(m_config->getLoggingNewFileOnConnect());
+    options_page->LoggingBinary->setChecked(m_config->getLoggingBinary());
     options_page->LoggingEnable->setChecked(m_config->getLoggingEnabled());
     connect(options_page->LoggingEnable, SIGNAL(clicked()), this, SLOT(on_loggingEnable_clicked()));
     on_loggingEnable_clicked();
@@ -168,7 +176,8 @@ bool ScopeGadgetOptionsPage::eventFilter(QObject *obj, QEvent *evt)
 
 void ScopeGadgetOptionsPage::on_mathFunctionComboBox_currentIndexChanged(int currentIndex)
 {
-    if (currentIndex > 0) {
+    // the derivative doesn't use the math window
+    if (currentIndex > 0 && options_page->mathFunctionComboBox->itemText(currentIndex) != "Derivative") {
         options_page->spnMeanSamples->setEnabled(true);
     } else {
         options_page->spnMeanSamples->setEnabled(false);
@@ -275,6 +284,7 @@ void ScopeGadgetOptionsPage::apply()
     m_config->setMathFunctionType(options_page->mathFunctionComboBox->currentIndex());
     m_config->setDataSize(options_page->spnDataSize->value());
     m_config->setRefreashInterval(options_page->spnRefreshInterval->value());
+    m_config->setOpenGLCanvas(options_page->OpenGLCanvas->isChecked());
 
     QList<PlotCurveConfiguration *> plotCurveConfigs;
     for (int iIndex = 0; iIndex < options_page->lstCurves->count(); iIndex++) {
@@ -312,6 +322,7 @@ void ScopeGadgetOptionsPage::apply()
     // save the logging config
     m_config->setLoggingPath(options_page->LoggingPath->path());
     m_config->setLoggingNewFileOnConnect(options_page->LoggingConnect->isChecked());
+    m_config->setLoggingBinary(options_page->LoggingBinary->isChecked());
     m_config->setLoggingEnabled(options_page->LoggingEnable->isChecked());
 }
 
@@ -407,6 +418,7 @@ void ScopeGadgetOptionsPage::on_loggingEnable_clicked()
 
     options_page->LoggingPath->setEnabled(en);
     options_page->LoggingConnect->setEnabled(en);
+    options_page->LoggingBinary->setEnabled(en);
     options_page->LoggingLabel->setEnabled(en);
 }
 
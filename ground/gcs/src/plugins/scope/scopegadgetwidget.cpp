@@ -26,6 +26,7 @@
  */
 
 #include "scopegadgetwidget.h"
+#include "scopeclock.h"
 #include "utils/stylehelper.h"
 
 #include "extensionsystem/pluginmanager.h"
@@ -54,10 +55,12 @@
 #include <QClipboard>
 #include <QSettings>
 #include <QApplication>
+#include <qnumeric.h>
 
 #include <qwt/src/qwt_legend_label.h>
 #include <qwt/src/qwt_picker_machine.h>
 #include <qwt/src/qwt_plot_canvas.h>
+#include <qwt/src/qwt_plot_glcanvas.h>
 #include <qwt/src/qwt_plot_layout.h>
 
 ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
@@ -65,10 +68,10 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
     m_csvLoggingHeaderSaved(false), m_csvLoggingDataSaved(false),
     m_csvLoggingNameSet(false), m_csvLoggingDataValid(false),
     m_csvLoggingDataUpdated(false), m_csvLoggingConnected(false),
-    m_csvLoggingNewFileOnConnect(false),
+    m_csvLoggingNewFileOnConnect(false), m_csvLoggingBinary(false),
     m_csvLoggingStartTime(QDateTime::currentDateTime()),
     m_csvLoggingPath("./csvlogging/"),
-    m_plotLegend(NULL), m_picker(NULL)
+    m_plotLegend(NULL), m_picker(NULL), m_copyStatsLabel(NULL)
 {
     setMouseTracking(true);
 
@@ -81,19 +84,16 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
     axisWidget(QwtPlot::yLeft)->setMargin(2);
     axisWidget(QwtPlot::xBottom)->setMargin(2);
 
-    m_picker = new QwtPlotPicker(QwtPlot::xBottom,
-                                 QwtPlot::yLeft,
-                                 QwtPlotPicker::HLineRubberBand,
-                                 QwtPicker::ActiveOnly,
-                                 canvas());
-    m_picker->setStateMachine(new QwtPickerDragPointMachine());
-    m_picker->setRubberBandPen(QColor(Qt::darkMagenta));
-    m_picker->setTrackerPen(QColor(Qt::green));
+    setupPicker();
 
     // Setup the timer that replots data
     replotTimer = new QTimer(this);
     connect(replotTimer, SIGNAL(timeout()), this, SLOT(replotNewData()));
 
+    // the new samples are drawn in the canvas backing store, then the store is copied to the screen
+    m_directPainter = new QwtPlotDirectPainter(this);
+    m_directPainter->setAttribute(QwtPlotDirectPainter::FullRepaint, true);
+
     // Listen to telemetry connection/disconnection events, no point in
     // running the scopes if we are not connected and not replaying logs.
     // Also listen to disconnect actions from the user
@@ -105,6 +105,9 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent) : QwtPlot(parent),
     connect(cm, SIGNAL(deviceAboutToDisconnect()), this, SLOT(csvLoggingDisconnect()));
     connect(cm, SIGNAL(deviceConnected(QIODevice *)), this, SLOT(csvLoggingConnect()));
 
+    // The samples are cleared when the time base changes or a replay goes back
+    connect(ScopeClock::instance(), SIGNAL(reset()), this, SLOT(clearPlot()));
+
     setContextMenuPolicy(Qt::CustomContextMenu);
     connect(this, SIGNAL(customContextMenuRequested(const QPoint &)), this, SLOT(popUpMenu(const QPoint &)));
 }
@@ -122,16 +125,48 @@ ScopeGadgetWidget::~ScopeGadgetWidget()
         replotTimer = NULL;
     }
 
-    // Get the object to de-monitor
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    foreach(QString uavObjName, m_connectedUAVObjects) {
-        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objManager->getObject(uavObjName));
+    clearCurvePlots();
+}
+
+void ScopeGadgetWidget::setupPicker()
+{
+    m_picker = new QwtPlotPicker(QwtPlot::xBottom,
+                                 QwtPlot::yLeft,
+                                 QwtPlotPicker::HLineRubberBand,
+                                 QwtPicker::ActiveOnly,
+                                 canvas());
+    m_picker->setStateMachine(new QwtPickerDragPointMachine());
+    m_picker->setRubberBandPen(QColor(Qt::darkMagenta));
+    m_picker->setTrackerPen(QColor(Qt::green));
+}
+
+/**
+ * Draw the plot on an OpenGL canvas or on the default raster canvas.
+ * The OpenGL canvas takes the curve drawing off the CPU, which matters
+ * with many curves or short update intervals.
+ */
+void ScopeGadgetWidget::setOpenGLCanvas(bool openGL)
+{
+    if (openGL == (qobject_cast<QwtPlotGLCanvas *>(canvas()) != NULL)) {
+        return;
+    }
+
+    // the picker belongs to the canvas, which is deleted when replaced
+    delete m_picker;
+    m_picker = NULL;
 
-        disconnect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)));
+    if (openGL) {
+        QwtPlotGLCanvas *plotCanvas = new QwtPlotGLCanvas();
+        plotCanvas->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+        setCanvas(plotCanvas);
+    } else {
+        QwtPlotCanvas *plotCanvas = new QwtPlotCanvas();
+        plotCanvas->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+        plotCanvas->setBorderRadius(8);
+        setCanvas(plotCanvas);
     }
 
-    clearCurvePlots();
+    setupPicker();
 }
 
 void ScopeGadgetWidget::mousePressEvent(QMouseEvent *e)
@@ -347,6 +382,23 @@ void ScopeGadgetWidget::setupChronoPlot()
     setAxisFont(QwtPlot::yLeft, fnt); // y-axis
 }
 
+void ScopeGadgetWidget::setupSpectrumPlot()
+{
+    preparePlot(SpectrumPlot);
+
+    // frequency in Hz, up to half the sample rate
+    setAxisScaleDraw(QwtPlot::xBottom, new QwtScaleDraw());
+    setAxisAutoScale(QwtPlot::xBottom);
+    setAxisLabelRotation(QwtPlot::xBottom, 0.0);
+    setAxisLabelAlignment(QwtPlot::xBottom, Qt::AlignLeft | Qt::AlignBottom);
+
+    // reduce the axis font size
+    QFont fnt(axisFont(QwtPlot::xBottom));
+    fnt.setPointSize(7);
+    setAxisFont(QwtPlot::xBottom, fnt); // x-axis
+    setAxisFont(QwtPlot::yLeft, fnt); // y-axis
+}
+
 void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubField, int scaleFactor,
                                      int meanSamples, QString mathFunction, QPen pen, bool antialiased)
 {
@@ -377,7 +429,7 @@ void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubFie
     }
 
     if (!elementName.isEmpty()) {
-        element = field->getElementNames().indexOf(QRegExp(elementName, Qt::CaseSensitive, QRegExp::FixedString));
+        element = field->getElementIndex(elementName);
         if (element < 0) {
             qDebug() << "In scope gadget, in fields loaded from GCS config file, field" <<
                 fieldName << "of object" << objectName << "element name" << elementName << "is missing";
@@ -391,6 +443,10 @@ void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubFie
         plotData = new SequentialPlotData(object, field, element, scaleFactor,
                                           meanSamples, mathFunction, m_plotDataSize,
                                           pen, antialiased);
+    } else if (m_plotType == SpectrumPlot) {
+        plotData = new SpectrumPlotData(object, field, element, scaleFactor,
+                                        meanSamples, mathFunction, m_plotDataSize,
+                                        pen, antialiased);
     } else {
         Q_ASSERT(m_plotType == ChronoPlot);
         plotData = new ChronoPlotData(object, field, element, scaleFactor,
@@ -403,11 +459,9 @@ void ScopeGadgetWidget::addCurvePlot(QString objectName, QString fieldPlusSubFie
     // Keep the curve details for later
     m_curvesData.insert(plotData->plotName(), plotData);
 
-    // Link to the new signal data only if this UAVObject has not been connected yet
-    if (!m_connectedUAVObjects.contains(object->getName())) {
-        m_connectedUAVObjects.append(object->getName());
-        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(uavObjectReceived(UAVObject *)));
-    }
+    // Link to the new signal data, once the shared store has sampled it
+    connect(ScopeSampleStore::instance()->source(object), SIGNAL(objectSampled(UAVObject *)),
+            this, SLOT(uavObjectReceived(UAVObject *)), Qt::UniqueConnection);
 
     m_mutex.lock();
     replot();
@@ -436,16 +490,64 @@ void ScopeGadgetWidget::replotNewData()
         plotData->updatePlotData();
     }
 
-    QDateTime NOW = QDateTime::currentDateTime();
-    double toTime = NOW.toTime_t();
-    toTime += NOW.time().msec() / 1000.0;
+    // wall clock or replay clock
+    double toTime = ScopeClock::instance()->now();
     if (m_plotType == ChronoPlot) {
         setAxisScale(QwtPlot::xBottom, toTime - m_plotDataSize, toTime);
     }
 
-    csvLoggingInsertData();
+    updateAxes();
+    // the overlay is not drawn by extendCurves()
+    bool statsUpdated = m_copyStatsLabel && updateCopyStatistics();
+    if (statsUpdated || !extendCurves()) {
+        replot();
+        markPainted();
+    }
+}
 
-    replot();
+/**
+ * Draw only the samples appended since the last replot when the scales and the canvas did not change.
+ * The grid, the markers and the curves as painted so far are kept in the canvas backing store
+ * (at the device pixel ratio of the screen), the axes and the legend are not repainted.
+ * Returns false when the plot must be replotted.
+ */
+bool ScopeGadgetWidget::extendCurves()
+{
+    // the OpenGL canvas has no backing store
+    QwtPlotCanvas *plotCanvas = qobject_cast<QwtPlotCanvas *>(canvas());
+
+    if (!plotCanvas || !plotCanvas->testPaintAttribute(QwtPlotCanvas::BackingStore) ||
+        !plotCanvas->backingStore() || plotCanvas->backingStore()->isNull() ||
+        plotCanvas->size() != m_paintedCanvasSize ||
+        axisScaleDiv(QwtPlot::xBottom) != m_paintedXScale || axisScaleDiv(QwtPlot::yLeft) != m_paintedYScale) {
+        return false;
+    }
+
+    QList<PlotData *> curves = m_curvesData.values();
+    QVector<int> from(curves.size());
+    QVector<int> to(curves.size());
+    for (int i = 0; i < curves.size(); i++) {
+        if (!curves.at(i)->appendedSamples(&from[i], &to[i])) {
+            return false;
+        }
+    }
+    for (int i = 0; i < curves.size(); i++) {
+        if (to.at(i) > from.at(i) && curves.at(i)->isVisible()) {
+            m_directPainter->drawSeries(curves.at(i)->curve(), from.at(i), to.at(i));
+        }
+        curves.at(i)->markPainted();
+    }
+    return true;
+}
+
+void ScopeGadgetWidget::markPainted()
+{
+    foreach(PlotData * plotData, m_curvesData.values()) {
+        plotData->markPainted();
+    }
+    m_paintedXScale     = axisScaleDiv(QwtPlot::xBottom);
+    m_paintedYScale     = axisScaleDiv(QwtPlot::yLeft);
+    m_paintedCanvasSize = canvas()->size();
 }
 
 void ScopeGadgetWidget::clearCurvePlots()
@@ -508,20 +610,20 @@ int ScopeGadgetWidget::csvLoggingStart()
                 m_csvLoggingStartTime   = NOW;
                 m_csvLoggingHeaderSaved = 0;
                 m_csvLoggingDataSaved   = 0;
-                m_csvLoggingBuffer.clear();
                 QDir PathCheck(m_csvLoggingPath);
                 if (!PathCheck.exists()) {
                     PathCheck.mkpath("./");
                 }
 
+                QString suffix = m_csvLoggingBinary ? "bin" : "csv";
                 if (m_csvLoggingNameSet) {
-                    m_csvLoggingFile.setFileName(QString("%1/%2_%3_%4.csv").arg(m_csvLoggingPath).arg(m_csvLoggingName).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")));
+                    m_csvLoggingFileName = QString("%1/%2_%3_%4.%5").arg(m_csvLoggingPath).arg(m_csvLoggingName).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")).arg(suffix);
                 } else {
-                    m_csvLoggingFile.setFileName(QString("%1/Log_%2_%3.csv").arg(m_csvLoggingPath).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")));
+                    m_csvLoggingFileName = QString("%1/Log_%2_%3.%4").arg(m_csvLoggingPath).arg(NOW.toString("yyyy-MM-dd")).arg(NOW.toString("hh-mm-ss")).arg(suffix);
                 }
-                QDir FileCheck(m_csvLoggingFile.fileName());
+                QDir FileCheck(m_csvLoggingFileName);
                 if (FileCheck.exists()) {
-                    m_csvLoggingFile.setFileName("");
+                    m_csvLoggingFileName = "";
                 } else {
                     m_csvLoggingStarted = 1;
                     csvLoggingInsertHeader();
@@ -536,10 +638,14 @@ int ScopeGadgetWidget::csvLoggingStart()
 int ScopeGadgetWidget::csvLoggingStop()
 {
     m_csvLoggingStarted = 0;
+    m_csvLogger.stopLogging();
 
     return 0;
 }
 
+/**
+ * Start the logger thread, the header is written with the current curves
+ */
 int ScopeGadgetWidget::csvLoggingInsertHeader()
 {
     if (!m_csvLoggingStarted) {
@@ -553,77 +659,48 @@ int ScopeGadgetWidget::csvLoggingInsertHeader()
     }
 
     m_csvLoggingHeaderSaved = 1;
-    if (m_csvLoggingFile.open(QIODevice::WriteOnly | QIODevice::Append) == false) {
-        qDebug() << "Unable to open " << m_csvLoggingFile.fileName() << " for csv logging Header";
-    } else {
-        QTextStream ts(&m_csvLoggingFile);
-        ts << "date" << ", " << "Time" << ", " << "Sec since start" << ", " << "Connected" << ", " << "Data changed";
-
-        foreach(PlotData * plotData2, m_curvesData.values()) {
-            ts << ", ";
-            ts << plotData2->objectName();
-            ts << "." << plotData2->field()->getName();
-            if (!plotData2->elementName().isEmpty()) {
-                ts << "." << plotData2->elementName();
-            }
+
+    QStringList columns;
+    QList<QStringList> enumOptions;
+    foreach(PlotData * plotData2, m_curvesData.values()) {
+        QString column = plotData2->objectName() + "." + plotData2->field()->getName();
+        if (!plotData2->elementName().isEmpty()) {
+            column += "." + plotData2->elementName();
         }
-        ts << endl;
-        m_csvLoggingFile.close();
+        columns << column;
+        enumOptions << (plotData2->wantsInitialData() ? plotData2->field()->getOptions() : QStringList());
     }
+    m_csvLoggingValues.resize(columns.size());
+    m_csvLogger.startLogging(m_csvLoggingFileName, columns, enumOptions, m_csvLoggingBinary);
     return 0;
 }
 
+/**
+ * Queue the last values of the curves to the logger thread
+ */
 int ScopeGadgetWidget::csvLoggingAddData()
 {
     if (!m_csvLoggingStarted) {
         return -1;
     }
     m_csvLoggingDataValid = false;
-    QDateTime NOW = QDateTime::currentDateTime();
-    QString tempString;
-
-    QTextStream ss(&tempString);
-    ss << NOW.toString("yyyy-MM-dd") << ", " << NOW.toString("hh:mm:ss.z") << ", ";
-
-#if QT_VERSION >= 0x040700
-    ss << (NOW.toMSecsSinceEpoch() - m_csvLoggingStartTime.toMSecsSinceEpoch()) / 1000.00;
-#else
-    ss << (NOW.toTime_t() - m_csvLoggingStartTime.toTime_t());
-#endif
-    ss << ", " << m_csvLoggingConnected << ", " << m_csvLoggingDataUpdated;
-    m_csvLoggingDataUpdated = false;
 
+    int i = 0;
+    m_csvLoggingValues.resize(m_curvesData.size());
     foreach(PlotData * plotData2, m_curvesData.values()) {
-        ss << ", ";
         if (plotData2->hasData()) {
-            ss << plotData2->lastDataAsString();
+            m_csvLoggingValues[i] = plotData2->lastData();
             m_csvLoggingDataValid = true;
+        } else {
+            m_csvLoggingValues[i] = qQNaN();
         }
+        i++;
     }
-    ss << endl;
     if (m_csvLoggingDataValid) {
-        QTextStream ts(&m_csvLoggingBuffer);
-        ts << tempString;
-    }
-
-    return 0;
-}
-
-int ScopeGadgetWidget::csvLoggingInsertData()
-{
-    if (!m_csvLoggingStarted) {
-        return -1;
-    }
-    m_csvLoggingDataSaved = 1;
-
-    if (m_csvLoggingFile.open(QIODevice::WriteOnly | QIODevice::Append) == false) {
-        qDebug() << "Unable to open " << m_csvLoggingFile.fileName() << " for csv logging Data";
-    } else {
-        QTextStream ts(&m_csvLoggingFile);
-        ts << m_csvLoggingBuffer;
-        m_csvLoggingFile.close();
+        m_csvLoggingDataSaved = 1;
+        m_csvLogger.addSample(QDateTime::currentMSecsSinceEpoch(), m_csvLoggingConnected, m_csvLoggingDataUpdated, m_csvLoggingValues);
     }
-    m_csvLoggingBuffer.clear();
+    m_csvLoggingDataUpdated = false;
 
     return 0;
 }
@@ -660,12 +737,67 @@ void ScopeGadgetWidget::popUpMenu(const QPoint &mousePosition)
     connect(action, &QAction::triggered, this, &ScopeGadgetWidget::clearPlot);
     action = menu.addAction(tr("Copy to Clipboard"));
     connect(action, &QAction::triggered, this, &ScopeGadgetWidget::copyToClipboardAsImage);
+    action = menu.addAction(tr("Show Copy Statistics"));
+    action->setCheckable(true);
+    action->setChecked(m_copyStatsLabel != NULL);
+    connect(action, &QAction::toggled, this, &ScopeGadgetWidget::showCopyStatistics);
     menu.addSeparator();
     action = menu.addAction(tr("Options..."));
     connect(action, &QAction::triggered, this, &ScopeGadgetWidget::showOptionDialog);
     menu.exec(QCursor::pos());
 }
 
+void ScopeGadgetWidget::showCopyStatistics(bool show)
+{
+    if (show == (m_copyStatsLabel != NULL)) {
+        return;
+    }
+    if (show) {
+        m_copyStatsLabel = new QwtPlotTextLabel();
+        m_copyStatsLabel->setZ(1000);
+        m_copyStatsLabel->attach(this);
+        m_copiedBytes.clear();
+        m_copyStatsTimer.start();
+    } else {
+        delete m_copyStatsLabel;
+        m_copyStatsLabel = NULL;
+    }
+    replot();
+}
+
+/**
+ * Refresh the copy statistics overlay about once per second.
+ * Returns true when the text has changed and the plot must be replotted.
+ */
+bool ScopeGadgetWidget::updateCopyStatistics()
+{
+    qint64 elapsed = m_copyStatsTimer.elapsed();
+
+    if (elapsed < 1000 && !m_copiedBytes.isEmpty()) {
+        return false;
+    }
+    m_copyStatsTimer.restart();
+
+    QStringList lines;
+    QHash<PlotData *, quint64> copiedBytes;
+    foreach(PlotData * plotData, m_curvesData.values()) {
+        quint64 bytes = plotData->copiedBytes();
+        double rate   = (elapsed > 0 && m_copiedBytes.contains(plotData)) ?
+                        (bytes - m_copiedBytes.value(plotData)) * 1000.0 / elapsed : 0;
+
+        copiedBytes.insert(plotData, bytes);
+        lines << tr("%1: %2 kB/s copied").arg(plotData->plotName()).arg(rate / 1024, 0, 'f', 1);
+    }
+    m_copiedBytes = copiedBytes;
+
+    QwtText text(lines.join("\n"));
+    text.setRenderFlags(Qt::AlignLeft | Qt::AlignTop);
+    text.setColor(Qt::white);
+    text.setBackgroundBrush(QColor(0, 0, 0, 160));
+    m_copyStatsLabel->setText(text);
+    return true;
+}
+
 void ScopeGadgetWidget::clearPlot()
 {
     m_mutex.lock();
@@ -29,6 +29,7 @@
 #define SCOPEGADGETWIDGET_H_
 
 #include "plotdata.h"
+#include "scopecsvlogger.h"
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_legend.h"
@@ -37,9 +38,14 @@
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
 #include "qwt/src/qwt_plot_picker.h"
+#include "qwt/src/qwt_plot_directpainter.h"
+#include "qwt/src/qwt_scale_div.h"
+#include "qwt/src/qwt_plot_textlabel.h"
 
 #include <QTimer>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QVector>
 #include <QMutex>
 
@@ -72,6 +78,7 @@ public:
 
     void setupSequentialPlot();
     void setupChronoPlot();
+    void setupSpectrumPlot();
     void setupUAVObjectPlot();
     PlotType plotType()
     {
@@ -94,6 +101,7 @@ public:
     {
         return m_refreshInterval;
     }
+    void setOpenGLCanvas(bool openGL);
 
 
     void addCurvePlot(QString uavObject, QString uavFieldSubField, int scaleOrderFactor = 0, int meanSamples = 1,
@@ -119,6 +127,10 @@ public:
     {
         m_csvLoggingPath = value;
     }
+    void setLoggingBinary(bool value)
+    {
+        m_csvLoggingBinary = value;
+    }
 signals:
     void visibilityChanged(QwtPlotItem *item);
 
@@ -142,20 +154,30 @@ private slots:
     void clearPlot();
     void copyToClipboardAsImage();
     void showOptionDialog();
+    void showCopyStatistics(bool show);
 
 private:
     void preparePlot(PlotType plotType);
     void setupExamplePlot();
+    void setupPicker();
+    bool extendCurves();
+    void markPainted();
+    bool updateCopyStatistics();
 
     PlotType m_plotType;
 
     double m_plotDataSize;
     int m_refreshInterval;
-    QList<QString> m_connectedUAVObjects;
     QMap<QString, PlotData *> m_curvesData;
 
     QTimer *replotTimer;
 
+    // draws the samples appended within the scales of the last replot, see extendCurves()
+    QwtPlotDirectPainter *m_directPainter;
+    QwtScaleDiv m_paintedXScale;
+    QwtScaleDiv m_paintedYScale;
+    QSize m_paintedCanvasSize;
+
     bool m_csvLoggingStarted;
     bool m_csvLoggingEnabled;
     bool m_csvLoggingHeaderSaved;
@@ -165,21 +187,27 @@ private:
     bool m_csvLoggingDataUpdated;
     bool m_csvLoggingConnected;
     bool m_csvLoggingNewFileOnConnect;
+    bool m_csvLoggingBinary;
 
     QDateTime m_csvLoggingStartTime;
 
     QString m_csvLoggingName;
     QString m_csvLoggingPath;
-    QString m_csvLoggingBuffer;
-    QFile m_csvLoggingFile;
+    QString m_csvLoggingFileName;
+    ScopeCsvLogger m_csvLogger;
+    QVector<double> m_csvLoggingValues;
 
     QMutex m_mutex;
     QwtLegend *m_plotLegend;
     QwtPlotPicker *m_picker;
 
+    // debug overlay of the bytes copied per second for each curve, NULL when hidden
+    QwtPlotTextLabel *m_copyStatsLabel;
+    QHash<PlotData *, quint64> m_copiedBytes;
+    QElapsedTimer m_copyStatsTimer;
+
     int csvLoggingInsertHeader();
     int csvLoggingAddData();
-    int csvLoggingInsertData();
 
     void deleteLegend();
     void addLegend();
@@ -0,0 +1,353 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopesamplestore.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief      The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "scopesamplestore.h"
+
+#include "scopeclock.h"
+#include "uavobject.h"
+#include "uavobjectfield.h"
+
+#include <QVarLengthArray>
+
+#include <algorithm>
+
+// drift of the onboard clock against the scope clock allowed, see ScopeObjectSource::updateTime()
+#define CLOCK_DRIFT 0.0001
+
+void PlotSampleBuffer::reserve(int capacity)
+{
+    if (capacity <= m_samples.size()) {
+        return;
+    }
+    QVector<QPointF> samples(capacity);
+    for (int i = 0; i < m_size; i++) {
+        samples[i] = at(i);
+    }
+    m_samples = samples;
+    m_first   = 0;
+}
+
+void PlotSampleBuffer::append(const QPointF &sample)
+{
+    if (m_size == m_samples.size()) {
+        reserve(qMax(2 * m_size, 64));
+    }
+    int index = m_first + m_size;
+    if (index >= m_samples.size()) {
+        index -= m_samples.size();
+    }
+    m_samples[index] = sample;
+    m_size++;
+}
+
+ScopeSignal::ScopeSignal(UAVObject *object, UAVObjectField *field, int element) :
+    m_object(object), m_field(field), m_element(element), m_refCount(0),
+    m_sequence(0), m_keepCount(0), m_keepAge(0)
+{}
+
+int ScopeSignal::indexOf(double time) const
+{
+    // the samples are in time order
+    int low  = 0;
+    int high = m_samples.size();
+
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (m_samples.at(middle).x() < time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * Read the value of the element in the object data of an update (the enum option index for enums).
+ * Without data the value is taken from the object snapshot so that the telemetry receiver is never blocked.
+ */
+void ScopeSignal::sample(double time, const quint8 *data)
+{
+    double value;
+
+    if (data && (m_field->isNumeric() || m_field->getType() == UAVObjectField::ENUM)) {
+        value = m_field->getDouble(m_element, data);
+    } else if (m_field->getType() == UAVObjectField::ENUM) {
+        value = m_field->getOptionIndex(m_field->getValue(m_element).toString());
+    } else {
+        QVarLengthArray<quint8, 256> snapshot(m_object->getNumBytes());
+        if (m_field->isNumeric() && m_object->readSnapshot(snapshot.data())) {
+            value = m_field->getDouble(m_element, snapshot.constData());
+        } else {
+            value = m_field->getDouble(m_element);
+        }
+    }
+    // keep the samples in time order, a late local update goes with the last received one
+    if (!m_samples.isEmpty() && time < m_samples.last().x()) {
+        time = m_samples.last().x();
+    }
+    m_samples.append(QPointF(time, value));
+    m_sequence++;
+
+    // drop the samples none of the curves need anymore
+    while (m_samples.size() > m_keepCount &&
+           (m_samples.last().x() - m_samples.first().x()) > m_keepAge) {
+        m_samples.removeFirst();
+    }
+}
+
+void ScopeSignal::updateWindow()
+{
+    m_keepCount = 1;
+    m_keepAge   = 0;
+    for (int i = 0; i < m_windows.size(); i++) {
+        m_keepCount = qMax(m_keepCount, m_windows.at(i).first);
+        m_keepAge   = qMax(m_keepAge, m_windows.at(i).second);
+    }
+}
+
+static bool updateBefore(const ScopeObjectSource::PendingUpdate &update1, const ScopeObjectSource::PendingUpdate &update2)
+{
+    return update1.time < update2.time;
+}
+
+ScopeObjectSource::ScopeObjectSource(UAVObject *object) : m_object(object), m_timeField(NULL), m_timeScale(0),
+    m_timeOffset(0), m_lastOnboardTime(0), m_timeSynced(false), m_mergeQueued(false)
+{
+    // the objects carrying their onboard time in ms or us are timed with it
+    foreach(UAVObjectField * field, object->getFields()) {
+        QString name = field->getName();
+
+        if (!field->isNumeric() || field->getNumElements() != 1 ||
+            (name != "FlightTime" && !name.endsWith("Timestamp"))) {
+            continue;
+        }
+        if (field->getUnits() == "ms") {
+            m_timeScale = 0.001;
+        } else if (field->getUnits() == "us") {
+            m_timeScale = 0.000001;
+        } else {
+            continue;
+        }
+        m_timeField = field;
+        break;
+    }
+
+    // received updates are captured by the thread unpacking them, local updates when made
+    connect(object, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(objectUnpacked(UAVObject *)), Qt::DirectConnection);
+    connect(object, SIGNAL(objectUpdatedManual(UAVObject *, bool)), this, SLOT(objectUpdatedManual(UAVObject *, bool)));
+}
+
+ScopeObjectSource::~ScopeObjectSource()
+{
+    disconnect(m_object, 0, this, 0);
+
+    // wait for a capture in progress on the telemetry thread
+    QMutexLocker locker(&m_mutex);
+}
+
+void ScopeObjectSource::objectUnpacked(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+
+    capture(ScopeClock::instance()->captureTime());
+}
+
+void ScopeObjectSource::objectUpdatedManual(UAVObject *obj, bool all)
+{
+    Q_UNUSED(obj);
+
+    if (!all) {
+        capture(ScopeClock::instance()->captureTime());
+    }
+}
+
+void ScopeObjectSource::merge()
+{
+    ScopeSampleStore::instance()->merge();
+}
+
+/**
+ * Keep a copy of the object data as updated, to be sampled by ScopeSampleStore::merge().
+ * Called from the thread updating the object.
+ */
+void ScopeObjectSource::capture(double clockTime)
+{
+    PendingUpdate update;
+
+    update.source = this;
+    update.data.resize(m_object->getNumBytes());
+    if (update.data.isEmpty() || !m_object->readSnapshot((quint8 *)update.data.data())) {
+        update.data.clear();
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    update.time = update.data.isEmpty() ? clockTime : updateTime((const quint8 *)update.data.constData(), clockTime);
+    m_pending.append(update);
+    if (!m_mergeQueued) {
+        m_mergeQueued = true;
+        QMetaObject::invokeMethod(this, "merge", Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Time of an update: the scope clock time, or the onboard time of the object mapped to the scope clock.
+ * The offset between both clocks follows the update that came the fastest, the link latency
+ * and the batching of the updates don't show in the plots.
+ */
+double ScopeObjectSource::updateTime(const quint8 *data, double clockTime)
+{
+    if (!m_timeField) {
+        return clockTime;
+    }
+
+    double onboardTime = m_timeField->getDouble(0, data) * m_timeScale;
+
+    if (!m_timeSynced || onboardTime < m_lastOnboardTime) {
+        // first update, or the board restarted
+        m_timeOffset = clockTime - onboardTime;
+        m_timeSynced = true;
+    } else {
+        m_timeOffset = qMin(m_timeOffset + (onboardTime - m_lastOnboardTime) * CLOCK_DRIFT, clockTime - onboardTime);
+    }
+    m_lastOnboardTime = onboardTime;
+    return onboardTime + m_timeOffset;
+}
+
+ScopeSampleStore *ScopeSampleStore::m_instance = NULL;
+
+ScopeSampleStore *ScopeSampleStore::instance()
+{
+    if (!m_instance) {
+        m_instance = new ScopeSampleStore();
+    }
+    return m_instance;
+}
+
+ScopeSignal *ScopeSampleStore::acquire(UAVObject *object, UAVObjectField *field, int element, int keepCount, double keepAge)
+{
+    // the sources time the updates with the clock, from the telemetry thread
+    ScopeClock::instance();
+
+    ScopeObjectSource *source = m_sources.value(object);
+
+    if (!source) {
+        source = new ScopeObjectSource(object);
+        m_sources.insert(object, source);
+    }
+
+    ScopeSignal *signal = NULL;
+    foreach(ScopeSignal * s, source->m_signals) {
+        if (s->m_field == field && s->m_element == element) {
+            signal = s;
+            break;
+        }
+    }
+    if (!signal) {
+        signal = new ScopeSignal(object, field, element);
+        source->m_signals.append(signal);
+    }
+    signal->m_refCount++;
+    signal->m_windows.append(qMakePair(keepCount, keepAge));
+    signal->updateWindow();
+    return signal;
+}
+
+/**
+ * Sample the updates captured by all the sources, in time order so that the samples
+ * of the objects updated together line up, then tell the scopes once per object.
+ */
+void ScopeSampleStore::merge()
+{
+    QVector<ScopeObjectSource::PendingUpdate> updates;
+
+    foreach(ScopeObjectSource * source, m_sources) {
+        QMutexLocker locker(&source->m_mutex);
+
+        updates += source->m_pending;
+        source->m_pending.resize(0);
+        source->m_mergeQueued = false;
+    }
+    if (updates.isEmpty()) {
+        return;
+    }
+
+    // the updates of each source are already in time order
+    std::stable_sort(updates.begin(), updates.end(), updateBefore);
+
+    QList<ScopeObjectSource *> sampled;
+    foreach(const ScopeObjectSource::PendingUpdate &update, updates) {
+        const quint8 *data = update.data.isEmpty() ? NULL : (const quint8 *)update.data.constData();
+        foreach(ScopeSignal * signal, update.source->m_signals) {
+            signal->sample(update.time, data);
+        }
+        if (!sampled.contains(update.source)) {
+            sampled.append(update.source);
+        }
+    }
+    foreach(ScopeObjectSource * source, sampled) {
+        emit source->objectSampled(source->m_object);
+    }
+}
+
+void ScopeSampleStore::clearSamples()
+{
+    if (!m_instance) {
+        return;
+    }
+    foreach(ScopeObjectSource * source, m_instance->m_sources) {
+        QMutexLocker locker(&source->m_mutex);
+
+        source->m_pending.resize(0);
+        source->m_timeSynced = false;
+        foreach(ScopeSignal * signal, source->m_signals) {
+            signal->m_samples.clear();
+        }
+    }
+}
+
+void ScopeSampleStore::release(ScopeSignal *signal, int keepCount, double keepAge)
+{
+    signal->m_windows.removeOne(qMakePair(keepCount, keepAge));
+    signal->updateWindow();
+    if (--signal->m_refCount > 0) {
+        return;
+    }
+
+    ScopeObjectSource *source = m_sources.value(signal->m_object);
+    source->m_signals.removeOne(signal);
+    delete signal;
+    if (source->m_signals.isEmpty()) {
+        m_sources.remove(source->m_object);
+        delete source;
+    }
+    if (m_sources.isEmpty()) {
+        m_instance = NULL;
+        delete this;
+    }
+}
@@ -0,0 +1,255 @@
+/**
+ ******************************************************************************
+ *
+ * @file       scopesamplestore.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief      The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef SCOPESAMPLESTORE_H
+#define SCOPESAMPLESTORE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPointF>
+#include <QVector>
+
+class UAVObject;
+class UAVObjectField;
+
+/*!
+   \brief Circular buffer of curve samples, the oldest samples are removed
+   from the front without moving the others. Grows when full.
+ */
+class PlotSampleBuffer {
+public:
+    PlotSampleBuffer() : m_first(0), m_size(0), m_firstSerial(0) {}
+
+    int size() const
+    {
+        return m_size;
+    }
+    bool isEmpty() const
+    {
+        return m_size == 0;
+    }
+    const QPointF &at(int i) const
+    {
+        int index = m_first + i;
+
+        if (index >= m_samples.size()) {
+            index -= m_samples.size();
+        }
+        return m_samples.at(index);
+    }
+    const QPointF &first() const
+    {
+        return at(0);
+    }
+    const QPointF &last() const
+    {
+        return at(m_size - 1);
+    }
+    // Number of samples removed from the front since the buffer was created,
+    // a sample keeps firstSerial() + its index while it is in the buffer
+    quint64 firstSerial() const
+    {
+        return m_firstSerial;
+    }
+
+    void reserve(int capacity);
+    void append(const QPointF &sample);
+    void removeLast()
+    {
+        m_size--;
+    }
+    void removeFirst()
+    {
+        if (++m_first == m_samples.size()) {
+            m_first = 0;
+        }
+        m_size--;
+        m_firstSerial++;
+    }
+    void clear()
+    {
+        m_firstSerial += m_size;
+        m_first = 0;
+        m_size  = 0;
+    }
+
+private:
+    QVector<QPointF> m_samples;
+    int m_first;
+    int m_size;
+    quint64 m_firstSerial;
+};
+
+/*!
+   \brief The samples of one object field element, shared by all the curves
+   plotting it. x is the time in seconds, y the value before scaling.
+   The samples are kept as long as a curve needs them, see ScopeSampleStore::acquire().
+ */
+class ScopeSignal {
+public:
+    UAVObject *object() const
+    {
+        return m_object;
+    }
+    UAVObjectField *field() const
+    {
+        return m_field;
+    }
+    int element() const
+    {
+        return m_element;
+    }
+
+    const PlotSampleBuffer &samples() const
+    {
+        return m_samples;
+    }
+    // Number of samples taken since the signal was created
+    quint64 sequence() const
+    {
+        return m_sequence;
+    }
+    // Sequence number of the oldest sample kept
+    quint64 firstSequence() const
+    {
+        return m_sequence - m_samples.size();
+    }
+    const QPointF &sample(quint64 sequence) const
+    {
+        return m_samples.at(sequence - firstSequence());
+    }
+    // Index of the first sample at or after the given time
+    int indexOf(double time) const;
+
+private:
+    friend class ScopeSampleStore;
+    friend class ScopeObjectSource;
+
+    ScopeSignal(UAVObject *object, UAVObjectField *field, int element);
+
+    UAVObject *m_object;
+    UAVObjectField *m_field;
+    int m_element;
+    int m_refCount;
+    PlotSampleBuffer m_samples;
+    quint64 m_sequence;
+    // how many samples and how many seconds of samples the curves need
+    QList<QPair<int, double> > m_windows;
+    int m_keepCount;
+    double m_keepAge;
+
+    // data is the object data of the update, NULL to read the current value
+    void sample(double time, const quint8 *data);
+    void updateWindow();
+};
+
+/*!
+   \brief Samples the signals of an object once per update, then tells the scopes.
+   The received updates are captured as unpacked, on the telemetry thread, and timed with
+   the onboard time of the object if it carries one, else with their arrival on the link.
+   They are sampled later in time order with those of the other objects, see ScopeSampleStore::merge().
+ */
+class ScopeObjectSource : public QObject {
+    Q_OBJECT
+
+public:
+    // an update waiting to be sampled
+    typedef struct {
+        double time;
+        ScopeObjectSource *source;
+        QByteArray data;
+    } PendingUpdate;
+
+signals:
+    void objectSampled(UAVObject *obj);
+
+private slots:
+    void objectUnpacked(UAVObject *obj);
+    void objectUpdatedManual(UAVObject *obj, bool all);
+    void merge();
+
+private:
+    friend class ScopeSampleStore;
+
+    ScopeObjectSource(UAVObject *object);
+    ~ScopeObjectSource();
+
+    void capture(double clockTime);
+    double updateTime(const quint8 *data, double clockTime);
+
+    UAVObject *m_object;
+    QList<ScopeSignal *> m_signals;
+
+    // onboard time field, its unit in seconds and the offset to the scope clock
+    UAVObjectField *m_timeField;
+    double m_timeScale;
+    double m_timeOffset;
+    double m_lastOnboardTime;
+    bool m_timeSynced;
+
+    // updates captured and not merged yet, guarded by the mutex
+    QMutex m_mutex;
+    QVector<PendingUpdate> m_pending;
+    bool m_mergeQueued;
+};
+
+/*!
+   \brief Store of the scope signals, shared by all the scope gadgets so that each
+   object field element is sampled and stored once whatever the number of curves plotting it.
+   It exists as long as a signal is used.
+ */
+class ScopeSampleStore {
+public:
+    static ScopeSampleStore *instance();
+
+    // Get the signal of an object field element, the signal keeps at least the given
+    // number of samples and seconds of samples until released with the same values.
+    ScopeSignal *acquire(UAVObject *object, UAVObjectField *field, int element, int keepCount, double keepAge);
+    void release(ScopeSignal *signal, int keepCount, double keepAge);
+
+    // Sample the updates captured by all the sources in time order, then tell the scopes once per object
+    void merge();
+    // Drop the samples of all the signals, see ScopeClock::reset()
+    static void clearSamples();
+
+    // The source to connect to, to be told when the signals of an object have been sampled
+    ScopeObjectSource *source(UAVObject *object) const
+    {
+        return m_sources.value(object);
+    }
+
+private:
+    ScopeSampleStore() {}
+
+    static ScopeSampleStore *m_instance;
+    QHash<UAVObject *, ScopeObjectSource *> m_sources;
+};
+
+#endif // SCOPESAMPLESTORE_H
@@ -1 +1,2 @@
-include(../../plugins/coreplugin/coreplugin.pri)
\ No newline at end of file
+include(../../plugins/coreplugin/coreplugin.pri)
+include(../../plugins/ophid/ophid.pri)
\ No newline at end of file
@@ -30,75 +30,72 @@
 
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
+#include <ophid/inc/ophid_usbmon.h>
 
 #include <QDebug>
 
-SerialEnumerationThread::SerialEnumerationThread(SerialConnection *serial)
-    : m_serial(serial), m_running(false)
-{}
+#if defined(Q_OS_LINUX)
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#elif defined(Q_OS_MAC)
+#include <sys/ioctl.h>
+#include <IOKit/serial/ioss.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
 
-void SerialEnumerationThread::run()
+/**
+   Asks the driver to hand over received bytes right away instead of
+   holding them back to fill larger USB transfers.
+   On Linux (ftdi_sio included, which then drops its latency timer to 1ms)
+   this is ASYNC_LOW_LATENCY, on OS X the receive latency of the port.
+ */
+static bool setLowLatency(QSerialPort *port)
 {
-    m_running = true;
-    QList <Core::IConnection::device> devices = m_serial->availableDevices();
-    while (m_running) {
-        if (!m_serial->deviceOpened()) {
-            QList <Core::IConnection::device> newDev = m_serial->availableDevices();
-            if (devices != newDev) {
-                devices = newDev;
-                emit enumerationChanged();
-            }
+#if defined(Q_OS_LINUX)
+    struct serial_struct serial;
+    if (ioctl(port->handle(), TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        if (ioctl(port->handle(), TIOCSSERIAL, &serial) == 0) {
+            return true;
         }
-        // update available devices every two seconds (doesn't need more)
-        msleep(2000);
-    }
-}
-
-void SerialEnumerationThread::stop()
-{
-    if (!m_running) {
-        return;
     }
-    m_running = false;
-    // wait for the thread to terminate
-    if (wait(2100) == false) {
-        qDebug() << "Cannot terminate SerialEnumerationThread";
+#elif defined(Q_OS_MAC)
+    // delivery latency in microseconds
+    unsigned long latency = 1;
+    if (ioctl(port->handle(), IOSSDATALAT, &latency) == 0) {
+        return true;
     }
+#else
+    // On Windows the FTDI latency timer can only be lowered in the port's advanced driver settings
+    Q_UNUSED(port);
+#endif
+    return false;
 }
 
 SerialConnection::SerialConnection(SerialPluginConfiguration *config) :
     serialHandle(NULL),
     enablePolling(true),
-    m_enumerateThread(this),
     m_deviceOpened(false),
     m_config(config)
 {
     m_optionsPage = new SerialPluginOptionsPage(m_config, this);
 
+    m_devices     = availableDevices();
 
-    // Experimental: enable polling on all OS'es since there
-    // were reports that autodetect does not work on XP amongst
-    // others.
-
-    // #ifdef Q_OS_WIN
-////I'm cheating a little bit here:
-////Knowing if the device enumeration really changed is a bit complicated
-////so I just signal it whenever we have a device event...
-// QMainWindow *mw = Core::ICore::instance()->mainWindow();
-// QObject::connect(mw, SIGNAL(deviceChange()),
-// this, SLOT(onEnumerationChanged()));
-// #else
-    // Other OSes do not send such signals:
-    QObject::connect(&m_enumerateThread, SIGNAL(enumerationChanged()), this, SLOT(onEnumerationChanged()));
+    // The USB monitor tells us when serial ports are added or removed,
+    // so there is no need to poll the list of ports
+    USBMonitor *monitor = USBMonitor::instance();
+    if (monitor) {
+        QObject::connect(monitor, SIGNAL(serialPortsChanged()), this, SLOT(onSerialPortsChanged()));
+    } else {
+        qWarning() << "SerialConnection - no USB monitor, serial ports will not be detected automatically";
+    }
     QObject::connect(m_optionsPage, SIGNAL(availableDevChanged()), this, SLOT(onEnumerationChanged()));
-    m_enumerateThread.start();
-// #endif
 }
 
 SerialConnection::~SerialConnection()
-{
-    m_enumerateThread.stop();
-}
+{}
 
 void SerialConnection::onEnumerationChanged()
 {
@@ -107,6 +104,23 @@ void SerialConnection::onEnumerationChanged()
     }
 }
 
+/**
+   Hotplug events also fire for ports we don't list and for
+   devices without ports, only report actual changes
+ */
+void SerialConnection::onSerialPortsChanged()
+{
+    if (!enablePolling) {
+        return;
+    }
+
+    QList <Core::IConnection::device> devices = availableDevices();
+    if (devices != m_devices) {
+        m_devices = devices;
+        onEnumerationChanged();
+    }
+}
+
 bool sortPorts(const QSerialPortInfo &s1, const QSerialPortInfo &s2)
 {
     return s1.portName() < s2.portName();
@@ -164,6 +178,7 @@ QIODevice *SerialConnection::openDevice(const QString &deviceName)
             // don't specify a parent when constructing the QSerialPort as this object will be moved
             // to a different thread later on (see telemetrymanager.cpp)
             serialHandle = new QSerialPort(port);
+            serialHandle->setReadBufferSize(m_config->readBufferSize());
             connect(serialHandle, static_cast<void(QSerialPort::*) (QSerialPort::SerialPortError)>(&QSerialPort::error),
                     [ = ](QSerialPort::SerialPortError error) { qWarning() << "serial port error:" << error; }
                     );
@@ -177,6 +192,15 @@ QIODevice *SerialConnection::openDevice(const QString &deviceName)
                     qDebug() << "Serial telemetry running at " << m_config->speed();
                     m_deviceOpened = true;
                 }
+#ifdef Q_OS_WIN
+                if (m_config->readBufferSize() > 0) {
+                    // let the driver queue as much as we are willing to buffer
+                    SetupComm(serialHandle->handle(), m_config->readBufferSize(), m_config->readBufferSize());
+                }
+#endif
+                if (m_config->lowLatency() && !setLowLatency(serialHandle)) {
+                    qDebug() << "Serial low latency mode not supported by" << deviceName;
+                }
                 // see https://librepilot.atlassian.net/browse/LP-341
                 serialHandle->setDataTerminalReady(true);
             }
@@ -221,6 +245,9 @@ void SerialConnection::suspendPolling()
 void SerialConnection::resumePolling()
 {
     enablePolling = true;
+
+    // catch up with ports that came or went while suspended
+    onSerialPortsChanged();
 }
 
 SerialPlugin::SerialPlugin() : m_connection(0), m_config(0)
@@ -40,35 +40,10 @@
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 
-#include <QThread>
-
 class IConnection;
 class QSerialPortInfo;
 class SerialConnection;
 
-/**
- *   Helper thread to check on new serial port connection/disconnection
- *   Some operating systems do not send device insertion events so
- *   for those we have to poll
- */
-// class SERIAL_EXPORT SerialEnumerationThread : public QThread
-class SerialEnumerationThread : public QThread {
-    Q_OBJECT
-public:
-    SerialEnumerationThread(SerialConnection *serial);
-
-    virtual void run();
-
-    void stop();
-
-signals:
-    void enumerationChanged();
-
-protected:
-    SerialConnection *m_serial;
-    bool m_running;
-};
-
 
 /**
  *   Define a connection via the IConnection interface
@@ -102,13 +77,14 @@ public:
 
 protected slots:
     void onEnumerationChanged();
-
+    void onSerialPortsChanged();
 
 private:
     QSerialPort *serialHandle;
     bool enablePolling;
 
-    SerialEnumerationThread m_enumerateThread;
+    // Last list of ports reported, hotplug events are compared against it
+    QList <Core::IConnection::device> m_devices;
     bool m_deviceOpened;
 
     // FIXME m_config and m_optionsPage belong in IPConnectionPlugin
@@ -40,18 +40,24 @@
  */
 SerialPluginConfiguration::SerialPluginConfiguration(QString classId, QSettings &settings, QObject *parent) :
     IUAVGadgetConfiguration(classId, parent),
-    m_speed("57600")
+    m_speed("57600"),
+    m_readBufferSize(0),
+    m_lowLatency(false)
 {
     m_speed = settings.value("speed", "57600").toString();
     if (m_speed.isEmpty()) {
         m_speed = "57600";
     }
+    m_readBufferSize = qMax(0, settings.value("readBufferSize", 0).toInt());
+    m_lowLatency     = settings.value("lowLatency", false).toBool();
 }
 
 SerialPluginConfiguration::SerialPluginConfiguration(const SerialPluginConfiguration &obj) :
     IUAVGadgetConfiguration(obj.classId(), obj.parent())
 {
     m_speed = obj.m_speed;
+    m_readBufferSize = obj.m_readBufferSize;
+    m_lowLatency     = obj.m_lowLatency;
 }
 
 SerialPluginConfiguration::~SerialPluginConfiguration()
@@ -73,4 +79,6 @@ IUAVGadgetConfiguration *SerialPluginConfiguration::clone() const
 void SerialPluginConfiguration::saveConfig(QSettings &settings) const
 {
     settings.setValue("speed", m_speed);
+    settings.setValue("readBufferSize", m_readBufferSize);
+    settings.setValue("lowLatency", m_lowLatency);
 }
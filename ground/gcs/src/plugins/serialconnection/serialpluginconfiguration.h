@@ -53,14 +53,38 @@ public:
         return m_speed;
     }
 
+    // Size of the serial port read buffer in bytes, 0 is unlimited
+    int readBufferSize()
+    {
+        return m_readBufferSize;
+    }
+
+    // Ask the driver to deliver received data as soon as possible
+    bool lowLatency()
+    {
+        return m_lowLatency;
+    }
+
 public slots:
     void setSpeed(QString speed)
     {
         m_speed = speed;
     }
 
+    void setReadBufferSize(int size)
+    {
+        m_readBufferSize = size;
+    }
+
+    void setLowLatency(bool lowLatency)
+    {
+        m_lowLatency = lowLatency;
+    }
+
 private:
     QString m_speed;
+    int m_readBufferSize;
+    bool m_lowLatency;
 };
 
 #endif // SERIALPLUGINCONFIGURATION_H
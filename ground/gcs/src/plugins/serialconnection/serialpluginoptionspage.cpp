@@ -68,15 +68,19 @@ QWidget *SerialPluginOptionsPage::createPage(QWidget *parent)
                   << "115200"
         #ifdef Q_OS_WIN
                   << "128000"            // WINDOWS ONLY
-                  << "230400"            // WINDOWS ONLY
+        #endif
+                  << "230400"
+        #ifdef Q_OS_WIN
                   << "256000"            // WINDOWS ONLY
-                  << "460800"            // WINDOWS ONLY
-                  << "921600"            // WINDOWS ONLY
         #endif
+                  << "460800"
+                  << "921600"
     ;
 
     m_page->cb_speed->addItems(allowedSpeeds);
     m_page->cb_speed->setCurrentIndex(m_page->cb_speed->findText(m_config->speed()));
+    m_page->sb_readBufferSize->setValue(m_config->readBufferSize() / 1024);
+    m_page->cb_lowLatency->setChecked(m_config->lowLatency());
     return w;
 }
 
@@ -89,6 +93,8 @@ QWidget *SerialPluginOptionsPage::createPage(QWidget *parent)
 void SerialPluginOptionsPage::apply()
 {
     m_config->setSpeed(m_page->cb_speed->currentText());
+    m_config->setReadBufferSize(m_page->sb_readBufferSize->value() * 1024);
+    m_config->setLowLatency(m_page->cb_lowLatency->isChecked());
 
     // FIXME this signal is too low level (and duplicated all over the place)
     // FIXME this signal will trigger (amongst other things) the saving of the configuration !
@@ -35,6 +35,64 @@
 #include "revocalibration.h"
 #include "accelgyrosettings.h"
 
+#include <QMutexLocker>
+#include <cmath>
+
+// samples before the outlier rejection starts
+#define OUTLIER_MIN_SAMPLES  10
+// rejected samples further than this many standard deviations from the mean
+#define OUTLIER_SIGMAS       4.0
+// this many rejections in a row means the board has moved, restart
+#define OUTLIER_MAX_REJECTED 20
+
+// a sample is done early, with at least a quarter of the measurements, when the
+// standard error of the mean is below these (m/s^2 and deg/s)
+#define ACCEL_TOLERANCE      0.005
+#define GYRO_TOLERANCE       0.005
+
+void BiasAccumulator::reset()
+{
+    m_count    = 0;
+    m_rejected = 0;
+    for (int i = 0; i < 3; i++) {
+        m_mean[i] = 0;
+        m_m2[i]   = 0;
+    }
+}
+
+bool BiasAccumulator::add(float x, float y, float z)
+{
+    const double sample[3] = { x, y, z };
+
+    if (m_count >= OUTLIER_MIN_SAMPLES) {
+        for (int i = 0; i < 3; i++) {
+            double sigma = sqrt(m_m2[i] / (m_count - 1));
+            if (fabs(sample[i] - m_mean[i]) > OUTLIER_SIGMAS * sigma) {
+                if (++m_rejected > OUTLIER_MAX_REJECTED) {
+                    reset();
+                }
+                return false;
+            }
+        }
+    }
+    m_rejected = 0;
+    m_count++;
+    for (int i = 0; i < 3; i++) {
+        double delta = sample[i] - m_mean[i];
+        m_mean[i] += delta / m_count;
+        m_m2[i]   += delta * (sample[i] - m_mean[i]);
+    }
+    return true;
+}
+
+double BiasAccumulator::standardError() const
+{
+    if (m_count < 2) {
+        return HUGE_VAL;
+    }
+    double m2 = qMax(qMax(m_m2[0], m_m2[1]), m_m2[2]);
+    return sqrt(m2 / (m_count - 1) / m_count);
+}
 
 BiasCalibrationUtil::BiasCalibrationUtil(long measurementCount, long measurementRate) : QObject(),
     m_isMeasuring(false), m_accelMeasurementCount(measurementCount), m_gyroMeasurementCount(measurementCount),
@@ -66,74 +124,81 @@ void BiasCalibrationUtil::abort()
     }
 }
 
-void BiasCalibrationUtil::gyroMeasurementsUpdated(UAVObject *obj)
+bool BiasCalibrationUtil::sampleDone(const BiasAccumulator &accumulator, long measurementCount, double tolerance) const
 {
-    Q_UNUSED(obj);
-
-    if (m_receivedGyroUpdates < m_gyroMeasurementCount) {
-        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-        UAVObjectManager *uavObjectManager = pm->getObject<UAVObjectManager>();
-        Q_ASSERT(uavObjectManager);
+    if (accumulator.count() >= measurementCount) {
+        return true;
+    }
+    return accumulator.count() >= measurementCount / 4 && accumulator.standardError() < tolerance;
+}
 
-        GyroState *gyroState = GyroState::GetInstance(uavObjectManager);
-        GyroState::DataFields gyroStateData = gyroState->getData();
+void BiasCalibrationUtil::updateProgress()
+{
+    long current = qMin(m_accel.count(), m_accelMeasurementCount) + qMin(m_gyro.count(), m_gyroMeasurementCount);
 
-        m_gyroX += gyroStateData.x;
-        m_gyroY += gyroStateData.y;
-        m_gyroZ += gyroStateData.z;
+    if (m_accelDone) {
+        current += m_accelMeasurementCount - qMin(m_accel.count(), m_accelMeasurementCount);
+    }
+    if (m_gyroDone) {
+        current += m_gyroMeasurementCount - qMin(m_gyro.count(), m_gyroMeasurementCount);
+    }
+    // queued to the GUI thread
+    emit progress(current, m_gyroMeasurementCount + m_accelMeasurementCount);
 
-        m_receivedGyroUpdates++;
-        emit progress(m_receivedGyroUpdates + m_receivedAccelUpdates, m_gyroMeasurementCount + m_accelMeasurementCount);
-    } else if (m_receivedAccelUpdates >= m_accelMeasurementCount &&
-               m_receivedGyroUpdates >= m_gyroMeasurementCount && m_isMeasuring) {
-        stopMeasurement();
+    if (m_accelDone && m_gyroDone) {
+        QMetaObject::invokeMethod(this, "stopMeasurement", Qt::QueuedConnection);
     }
 }
 
-void BiasCalibrationUtil::accelMeasurementsUpdated(UAVObject *obj)
+void BiasCalibrationUtil::gyroMeasurementsUpdated(UAVObject *obj)
 {
-    Q_UNUSED(obj);
+    GyroState::DataFields gyroStateData = static_cast<GyroState *>(obj)->getData();
+
+    QMutexLocker locker(&m_mutex);
 
-    if (m_receivedAccelUpdates < m_accelMeasurementCount) {
-        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-        UAVObjectManager *uavObjectManager = pm->getObject<UAVObjectManager>();
-        Q_ASSERT(uavObjectManager);
+    if (!m_isMeasuring || m_gyroDone) {
+        return;
+    }
+    if (m_gyro.add(gyroStateData.x, gyroStateData.y, gyroStateData.z)) {
+        m_gyroDone = sampleDone(m_gyro, m_gyroMeasurementCount, GYRO_TOLERANCE);
+        updateProgress();
+    }
+}
 
-        AccelState *accelState = AccelState::GetInstance(uavObjectManager);
-        AccelState::DataFields AccelStateData = accelState->getData();
+void BiasCalibrationUtil::accelMeasurementsUpdated(UAVObject *obj)
+{
+    AccelState::DataFields accelStateData = static_cast<AccelState *>(obj)->getData();
 
-        m_accelerometerX += AccelStateData.x;
-        m_accelerometerY += AccelStateData.y;
-        m_accelerometerZ += AccelStateData.z;
+    QMutexLocker locker(&m_mutex);
 
-        m_receivedAccelUpdates++;
-        emit progress(m_receivedGyroUpdates + m_receivedAccelUpdates, m_gyroMeasurementCount + m_accelMeasurementCount);
-    } else if (m_receivedAccelUpdates >= m_accelMeasurementCount &&
-               m_receivedGyroUpdates >= m_gyroMeasurementCount && m_isMeasuring) {
-        stopMeasurement();
+    if (!m_isMeasuring || m_accelDone) {
+        return;
+    }
+    if (m_accel.add(accelStateData.x, accelStateData.y, accelStateData.z)) {
+        m_accelDone = sampleDone(m_accel, m_accelMeasurementCount, ACCEL_TOLERANCE);
+        updateProgress();
     }
 }
 
 void BiasCalibrationUtil::timeout()
 {
+    if (!m_isMeasuring) {
+        return;
+    }
     stopMeasurement();
     emit timeout(tr("Calibration timed out before receiving required updates."));
 }
 
 void BiasCalibrationUtil::startMeasurement()
 {
-    m_isMeasuring = true;
-
     // Reset variables
-    m_receivedAccelUpdates = 0;
-    m_accelerometerX = 0;
-    m_accelerometerY = 0;
-    m_accelerometerZ = 0;
-
-    m_receivedGyroUpdates = 0;
-    m_gyroX = 0;
-    m_gyroY = 0;
-    m_gyroZ = 0;
+    m_mutex.lock();
+    m_isMeasuring = true;
+    m_accelDone   = false;
+    m_gyroDone    = false;
+    m_accel.reset();
+    m_gyro.reset();
+    m_mutex.unlock();
 
     ExtensionSystem::PluginManager *pm     = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *uavObjectManager     = pm->getObject<UAVObjectManager>();
@@ -164,9 +229,9 @@ void BiasCalibrationUtil::startMeasurement()
         AccelGyroSettings::GetInstance(uavObjectManager)->setData(accelGyroSettingsData);
         AttitudeSettings::GetInstance(uavObjectManager)->setData(attitudeSettingsData);
     }
-    // Set up to receive updates for accels
+    // Set up to receive updates for accels, directly on the telemetry thread
     UAVDataObject *uavObject = AccelState::GetInstance(uavObjectManager);
-    connect(uavObject, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(accelMeasurementsUpdated(UAVObject *)));
+    connect(uavObject, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(accelMeasurementsUpdated(UAVObject *)), Qt::DirectConnection);
 
     // Set update period for accels
     m_previousAccelMetaData = uavObject->getMetadata();
@@ -179,7 +244,7 @@ void BiasCalibrationUtil::startMeasurement()
     }
     // Set up to receive updates from gyros
     uavObject = GyroState::GetInstance(uavObjectManager);
-    connect(uavObject, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(gyroMeasurementsUpdated(UAVObject *)));
+    connect(uavObject, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(gyroMeasurementsUpdated(UAVObject *)), Qt::DirectConnection);
 
     // Set update period for gyros
     m_previousGyroMetaData = uavObject->getMetadata();
@@ -193,9 +258,17 @@ void BiasCalibrationUtil::startMeasurement()
 
 void BiasCalibrationUtil::stopMeasurement()
 {
-    qDebug() << "Sampling done, G =" << m_receivedGyroUpdates << "A =" << m_receivedAccelUpdates;
-
+    m_mutex.lock();
+    if (!m_isMeasuring) {
+        // already stopped by a timeout or an abort
+        m_mutex.unlock();
+        return;
+    }
+    // the accumulators are not updated anymore once this is cleared
     m_isMeasuring = false;
+    m_mutex.unlock();
+
+    qDebug() << "Sampling done, G =" << m_gyro.count() << "A =" << m_accel.count();
 
     // Stop timeout timer
     m_timeoutTimer.stop();
@@ -207,12 +280,12 @@ void BiasCalibrationUtil::stopMeasurement()
 
     // Stop listening for updates from accels
     UAVDataObject *uavObject = AccelState::GetInstance(uavObjectManager);
-    disconnect(uavObject, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(accelMeasurementsUpdated(UAVObject *)));
+    disconnect(uavObject, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(accelMeasurementsUpdated(UAVObject *)));
     uavObject->setMetadata(m_previousAccelMetaData);
 
     // Stop listening for updates from gyros
     uavObject = GyroState::GetInstance(uavObjectManager);
-    disconnect(uavObject, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(gyroMeasurementsUpdated(UAVObject *)));
+    disconnect(uavObject, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(gyroMeasurementsUpdated(UAVObject *)));
     uavObject->setMetadata(m_previousGyroMetaData);
 
     // Enable gyro bias correction again
@@ -221,13 +294,13 @@ void BiasCalibrationUtil::stopMeasurement()
     AttitudeSettings::GetInstance(uavObjectManager)->setData(attitudeSettingsData);
 
     accelGyroBias bias;
-    bias.m_accelerometerXBias = m_accelerometerX / (double)m_receivedAccelUpdates;
-    bias.m_accelerometerYBias = m_accelerometerY / (double)m_receivedAccelUpdates;
-    bias.m_accelerometerZBias = m_accelerometerZ / (double)m_receivedAccelUpdates;
+    bias.m_accelerometerXBias = m_accel.mean(0);
+    bias.m_accelerometerYBias = m_accel.mean(1);
+    bias.m_accelerometerZBias = m_accel.mean(2);
 
-    bias.m_gyroXBias = m_gyroX / (double)m_receivedGyroUpdates;
-    bias.m_gyroYBias = m_gyroY / (double)m_receivedGyroUpdates;
-    bias.m_gyroZBias = m_gyroZ / (double)m_receivedGyroUpdates;
+    bias.m_gyroXBias = m_gyro.mean(0);
+    bias.m_gyroYBias = m_gyro.mean(1);
+    bias.m_gyroZBias = m_gyro.mean(2);
 
     qDebug() << "Bias calculations finished";
     emit done(bias);
@@ -30,10 +30,41 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QMutex>
 
 #include "uavobject.h"
 #include "vehicleconfigurationsource.h"
 
+// running mean and variance of a 3 axis sensor (Welford), with outlier rejection
+class BiasAccumulator {
+public:
+    BiasAccumulator()
+    {
+        reset();
+    }
+
+    void reset();
+    // returns false if the sample was rejected
+    bool add(float x, float y, float z);
+
+    long count() const
+    {
+        return m_count;
+    }
+    double mean(int axis) const
+    {
+        return m_mean[axis];
+    }
+    // largest standard error of the mean over the three axes
+    double standardError() const;
+
+private:
+    long m_count;
+    long m_rejected;
+    double m_mean[3];
+    double m_m2[3];
+};
+
 class BiasCalibrationUtil : public QObject {
     Q_OBJECT
 public:
@@ -51,16 +82,20 @@ public slots:
     void abort();
 
 private slots:
+    // called on the telemetry thread
     void gyroMeasurementsUpdated(UAVObject *obj);
     void accelMeasurementsUpdated(UAVObject *obj);
     void timeout();
+    void stopMeasurement();
 
 private:
     QTimer m_timeoutTimer;
 
     bool m_isMeasuring;
-    long m_receivedAccelUpdates;
-    long m_receivedGyroUpdates;
+    // protects the accumulators and the done flags, updated on the telemetry thread
+    QMutex m_mutex;
+    bool m_accelDone;
+    bool m_gyroDone;
 
     long m_accelMeasurementCount;
     long m_gyroMeasurementCount;
@@ -70,16 +105,12 @@ private:
     UAVObject::Metadata m_previousGyroMetaData;
     UAVObject::Metadata m_previousAccelMetaData;
 
-    double m_accelerometerX;
-    double m_accelerometerY;
-    double m_accelerometerZ;
-    double m_gyroX;
-    double m_gyroY;
-    double m_gyroZ;
+    BiasAccumulator m_accel;
+    BiasAccumulator m_gyro;
 
-    void stop();
     void startMeasurement();
-    void stopMeasurement();
+    bool sampleDone(const BiasAccumulator &accumulator, long measurementCount, double tolerance) const;
+    void updateProgress();
 };
 
 #endif // BIASCALIBRATIONUTIL_H
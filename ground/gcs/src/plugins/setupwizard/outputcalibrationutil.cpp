@@ -42,7 +42,10 @@ ActuatorCommand::Metadata OutputCalibrationUtil::c_savedActuatorCommandMetaData;
 
 OutputCalibrationUtil::OutputCalibrationUtil(QObject *parent) :
     QObject(parent), m_safeValue(1000)
-{}
+{
+    m_sendTimer.setInterval(SEND_INTERVAL);
+    connect(&m_sendTimer, SIGNAL(timeout()), this, SLOT(sendPendingValues()));
+}
 
 OutputCalibrationUtil::~OutputCalibrationUtil()
 {
@@ -119,6 +122,8 @@ void OutputCalibrationUtil::stopChannelOutput()
 {
     if (c_prepared) {
         setChannelOutputValue(m_safeValue);
+        // the safe value must not wait for the next send
+        flush();
         m_outputChannels.clear();
         qDebug() << "OutputCalibrationUtil output stopped.";
     } else {
@@ -130,6 +135,7 @@ void OutputCalibrationUtil::stopChannelDualOutput(quint16 safeValue1, quint16 sa
 {
     if (c_prepared) {
         setChannelDualOutputValue(safeValue1, safeValue2);
+        flush();
         m_outputChannels.clear();
         qDebug() << "OutputCalibrationUtil Dual output stopped.";
     } else {
@@ -137,22 +143,59 @@ void OutputCalibrationUtil::stopChannelDualOutput(quint16 safeValue1, quint16 sa
     }
 }
 
+void OutputCalibrationUtil::setPendingValue(quint32 channel, quint16 value)
+{
+    if (channel < ActuatorCommand::CHANNEL_NUMELEM) {
+        m_pendingValues.insert(channel, value);
+    } else {
+        qDebug() << "OutputCalibrationUtil could not set output value for channel " << channel
+                 << " to " << value << "." << "Channel out of bounds" << channel << ".";
+    }
+}
+
+/**
+ * Slider moves are coalesced: the first value is sent at once, then the latest
+ * values are sent at most every SEND_INTERVAL so the telemetry queue is not flooded.
+ */
+void OutputCalibrationUtil::scheduleSend()
+{
+    if (!m_sendTimer.isActive()) {
+        sendPendingValues();
+        m_sendTimer.start();
+    }
+}
+
+void OutputCalibrationUtil::sendPendingValues()
+{
+    if (m_pendingValues.isEmpty()) {
+        // nothing changed during the last interval
+        m_sendTimer.stop();
+        return;
+    }
+    ActuatorCommand *actuatorCommand = getActuatorCommandObject();
+    ActuatorCommand::DataFields data = actuatorCommand->getData();
+
+    QMap<quint32, quint16>::const_iterator i = m_pendingValues.constBegin();
+    for (; i != m_pendingValues.constEnd(); ++i) {
+        data.Channel[i.key()] = i.value();
+    }
+    m_pendingValues.clear();
+    actuatorCommand->setData(data);
+}
+
+void OutputCalibrationUtil::flush()
+{
+    m_sendTimer.stop();
+    sendPendingValues();
+}
+
 void OutputCalibrationUtil::setChannelOutputValue(quint16 value)
 {
     if (c_prepared) {
-        ActuatorCommand *actuatorCommand = getActuatorCommandObject();
-        ActuatorCommand::DataFields data = actuatorCommand->getData();
         foreach(quint32 channel, m_outputChannels) {
-            // Set output value
-            if (channel <= ActuatorCommand::CHANNEL_NUMELEM) {
-                qDebug() << "OutputCalibrationUtil setting output value for channel " << channel << " to " << value << ".";
-                data.Channel[channel] = value;
-            } else {
-                qDebug() << "OutputCalibrationUtil could not set output value for channel " << channel
-                         << " to " << value << "." << "Channel out of bounds" << channel << ".";
-            }
+            setPendingValue(channel, value);
         }
-        actuatorCommand->setData(data);
+        scheduleSend();
     } else {
         qDebug() << "OutputCalibrationUtil not started.";
     }
@@ -161,28 +204,10 @@ void OutputCalibrationUtil::setChannelOutputValue(quint16 value)
 void OutputCalibrationUtil::setChannelDualOutputValue(quint16 value1, quint16 value2)
 {
     if (c_prepared && (m_outputChannels.size() == 2)) {
-        ActuatorCommand *actuatorCommand = getActuatorCommandObject();
-        ActuatorCommand::DataFields data = actuatorCommand->getData();
-        quint32 channel1 = m_outputChannels[0];
-        quint32 channel2 = m_outputChannels[1];
-        // Set output value
-        if (channel1 <= ActuatorCommand::CHANNEL_NUMELEM) {
-            qDebug() << "OutputCalibrationUtil (Dual) setting output value for channel1 " << channel1 << " to " << value1 << ".";
-            data.Channel[channel1] = value1;
-            actuatorCommand->setData(data);
-        } else {
-            qDebug() << "OutputCalibrationUtil could not set output value for channel1 " << channel1
-                     << " to " << value1 << "." << "Channel out of bounds" << channel1 << ".";
-        }
-
-        if (channel2 <= ActuatorCommand::CHANNEL_NUMELEM) {
-            qDebug() << "OutputCalibrationUtil (Dual) setting output value for channel2 " << channel2 << " to " << value2 << ".";
-            data.Channel[channel2] = value2;
-            actuatorCommand->setData(data);
-        } else {
-            qDebug() << "OutputCalibrationUtil could not set output value for channel2 " << channel2
-                     << " to " << value2 << "." << "Channel out of bounds" << channel2 << ".";
-        }
+        // both channels go in the same update
+        setPendingValue(m_outputChannels[0], value1);
+        setPendingValue(m_outputChannels[1], value2);
+        scheduleSend();
     } else {
         qDebug() << "OutputCalibrationUtil not started.";
     }
@@ -30,6 +30,8 @@
 #define OUTPUTCALIBRATIONUTIL_H
 
 #include <QObject>
+#include <QTimer>
+#include <QMap>
 
 #include "actuatorcommand.h"
 
@@ -51,11 +53,25 @@ public slots:
     void stopChannelDualOutput(quint16 safeValue1, quint16 safeValue2);
     void setChannelDualOutputValue(quint16 value1, quint16 value2);
 
+private slots:
+    void sendPendingValues();
+
 private:
+    // minimum time between two ActuatorCommand updates (ms)
+    static const int SEND_INTERVAL = 50;
+
     static bool c_prepared;
     static ActuatorCommand::Metadata c_savedActuatorCommandMetaData;
     QList<quint16> m_outputChannels;
     quint16 m_safeValue;
+
+    // latest value of each channel not sent yet
+    QMap<quint32, quint16> m_pendingValues;
+    QTimer m_sendTimer;
+
+    void setPendingValue(quint32 channel, quint16 value);
+    void scheduleSend();
+    void flush();
 };
 
 #endif // OUTPUTCALIBRATIONUTIL_H
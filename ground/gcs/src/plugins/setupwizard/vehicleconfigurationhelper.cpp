@@ -29,7 +29,6 @@
 #include "vehicleconfigurationhelper.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectutilmanager.h"
-#include <uavobjecthelper.h>
 
 #include "hwsettings.h"
 #include "actuatorsettings.h"
@@ -54,8 +53,7 @@
 
 VehicleConfigurationHelper::VehicleConfigurationHelper(VehicleConfigurationSource *configSource)
     : m_configSource(configSource), m_uavoManager(0),
-    m_transactionOK(false), m_transactionTimeout(false), m_currentTransactionObjectID(-1),
-    m_progress(0)
+    m_batchCompleted(false), m_batchSuccess(false), m_progressTotal(0)
 {
     Q_ASSERT(m_configSource);
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -65,7 +63,6 @@ VehicleConfigurationHelper::VehicleConfigurationHelper(VehicleConfigurationSourc
 
 bool VehicleConfigurationHelper::setupVehicle(bool save)
 {
-    m_progress = 0;
     clearModifiedObjects();
     resetVehicleConfig();
     resetGUIData();
@@ -73,7 +70,7 @@ bool VehicleConfigurationHelper::setupVehicle(bool save)
         return false;
     }
 
-    m_progress = 0;
+    // compute everything first, the objects are then sent and saved as one batch
     applyHardwareConfiguration();
     applyVehicleConfiguration();
     applyActuatorConfiguration();
@@ -89,19 +86,18 @@ bool VehicleConfigurationHelper::setupVehicle(bool save)
     applyTemplateSettings();
 
     bool result = saveChangesToController(save);
-    emit saveProgress(m_modifiedObjects.count() + 1, ++m_progress, result ? tr("Done!") : tr("Failed!"));
+    emit saveProgress(m_progressTotal + 1, m_progressTotal + 1, result ? tr("Done!") : tr("Failed!"));
     return result;
 }
 
 bool VehicleConfigurationHelper::setupHardwareSettings(bool save)
 {
-    m_progress = 0;
     clearModifiedObjects();
     applyHardwareConfiguration();
     applyManualControlDefaults();
 
     bool result = saveChangesToController(save);
-    emit saveProgress(m_modifiedObjects.count() + 1, ++m_progress, result ? tr("Done!") : tr("Failed!"));
+    emit saveProgress(m_progressTotal + 1, m_progressTotal + 1, result ? tr("Done!") : tr("Failed!"));
     return result;
 }
 
@@ -421,9 +417,7 @@ void VehicleConfigurationHelper::applyHardwareConfiguration()
     default:
         break;
     }
-    UAVObjectUpdaterHelper updateHelper;
     hwSettings->setData(data, false);
-    updateHelper.doObjectAndWait(hwSettings);
 
     addModifiedObject(hwSettings, tr("Writing hardware settings"));
 }
@@ -806,14 +800,10 @@ void VehicleConfigurationHelper::applyFlightModeConfiguration()
     data.FlightModePosition[4]     = FlightModeSettings::FLIGHTMODEPOSITION_STABILIZED5;
     data.FlightModePosition[5]     = FlightModeSettings::FLIGHTMODEPOSITION_STABILIZED6;
 
-    UAVObjectUpdaterHelper updateHelper;
-
     modeSettings->setData(data, false);
-    updateHelper.doObjectAndWait(modeSettings);
     addModifiedObject(modeSettings, tr("Writing flight mode settings 1/2"));
 
     controlSettings->setData(data2, false);
-    updateHelper.doObjectAndWait(controlSettings);
     addModifiedObject(controlSettings, tr("Writing flight mode settings 2/2"));
 }
 
@@ -878,10 +868,8 @@ void VehicleConfigurationHelper::applyStabilizationConfiguration()
 
     Q_ASSERT(stabSettings);
 
-    UAVObjectUpdaterHelper updateHelper;
     StabilizationSettings defaultSettings;
     stabSettings->setData(defaultSettings.getData(), false);
-    updateHelper.doObjectAndWait(stabSettings);
     addModifiedObject(stabSettings, tr("Writing stabilization settings"));
 }
 
@@ -1033,9 +1021,7 @@ void VehicleConfigurationHelper::applyMixerConfiguration(mixerChannelSettings ch
     }
 
     // Apply updates
-    UAVObjectUpdaterHelper updateHelper;
     mSettings->setData(mSettings->getData(), false);
-    updateHelper.doObjectAndWait(mSettings);
     addModifiedObject(mSettings, tr("Writing mixer settings"));
 }
 
@@ -1051,9 +1037,7 @@ void VehicleConfigurationHelper::applyMultiGUISettings(SystemSettings::AirframeT
         data.GUIConfigData[i] = guiConfig.UAVObject[i];
     }
 
-    UAVObjectUpdaterHelper updateHelper;
     sSettings->setData(data, false);
-    updateHelper.doObjectAndWait(sSettings);
     addModifiedObject(sSettings, tr("Writing vehicle settings"));
 }
 
@@ -1123,112 +1107,72 @@ void VehicleConfigurationHelper::applyTemplateSettings()
 bool VehicleConfigurationHelper::saveChangesToController(bool save)
 {
     qDebug() << "Saving modified objects to controller. " << m_modifiedObjects.count() << " objects in found.";
-    const int OUTER_TIMEOUT = 3000 * 20; // 10 seconds timeout for saving all objects
-    const int INNER_TIMEOUT = 2000; // 1 second timeout on every save attempt
+    const int OUTER_TIMEOUT = 3000 * 20; // 60 seconds timeout for saving all objects
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     Q_ASSERT(pm);
     UAVObjectUtilManager *utilMngr     = pm->getObject<UAVObjectUtilManager>();
     Q_ASSERT(utilMngr);
 
-    QTimer outerTimeoutTimer;
-    outerTimeoutTimer.setSingleShot(true);
-
-    QTimer innerTimeoutTimer;
-    innerTimeoutTimer.setSingleShot(true);
-
-    connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(uAVOTransactionCompleted(int, bool)));
-    connect(&innerTimeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
-    connect(&outerTimeoutTimer, SIGNAL(timeout()), this, SLOT(saveChangesTimeout()));
-
-    outerTimeoutTimer.start(OUTER_TIMEOUT);
+    QList<UAVObject *> objects;
     for (int i = 0; i < m_modifiedObjects.count(); i++) {
-        QPair<UAVDataObject *, QString> *objPair = m_modifiedObjects.at(i);
-        m_transactionOK = false;
-        UAVDataObject *obj     = objPair->first;
-        QString objDescription = objPair->second;
+        UAVDataObject *obj = m_modifiedObjects.at(i)->first;
         if (UAVObject::GetGcsAccess(obj->getMetadata()) != UAVObject::ACCESS_READONLY && obj->isSettingsObject()) {
-            emit saveProgress(m_modifiedObjects.count() + 1, ++m_progress, objDescription);
-
-            m_currentTransactionObjectID = obj->getObjID();
-
-            connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
-            while (!m_transactionOK && !m_transactionTimeout) {
-                // Allow the transaction to take some time
-                innerTimeoutTimer.start(INNER_TIMEOUT);
-
-                // Set object updated
-                obj->updated();
-                if (!m_transactionOK) {
-                    m_eventLoop.exec();
-                }
-                innerTimeoutTimer.stop();
-            }
-            disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(uAVOTransactionCompleted(UAVObject *, bool)));
-            if (m_transactionOK) {
-                qDebug() << "Object " << obj->getName() << " was successfully updated.";
-                if (save) {
-                    m_transactionOK = false;
-                    m_currentTransactionObjectID = obj->getObjID();
-                    // Try to save until success or timeout
-                    while (!m_transactionOK && !m_transactionTimeout) {
-                        // Allow the transaction to take some time
-                        innerTimeoutTimer.start(INNER_TIMEOUT);
-
-                        // Persist object in controller
-                        utilMngr->saveObjectToSD(obj);
-                        if (!m_transactionOK) {
-                            m_eventLoop.exec();
-                        }
-                        innerTimeoutTimer.stop();
-                    }
-                    m_currentTransactionObjectID = -1;
-                }
-            }
-
-            if (!m_transactionOK) {
-                qDebug() << "Transaction timed out when trying to save: " << obj->getName();
-            } else {
-                qDebug() << "Object " << obj->getName() << " was successfully saved.";
-            }
+            objects << obj;
         } else {
             qDebug() << "Trying to save a UAVDataObject that is read only or is not a settings object.";
         }
-        if (m_transactionTimeout) {
-            qDebug() << "Transaction timed out when trying to save " << m_modifiedObjects.count() << " objects.";
-            break;
-        }
     }
 
-    outerTimeoutTimer.stop();
-    disconnect(&outerTimeoutTimer, SIGNAL(timeout()), this, SLOT(saveChangesTimeout()));
-    disconnect(&innerTimeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
-    disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(uAVOTransactionCompleted(int, bool)));
+    m_batchCompleted = false;
+    m_batchSuccess   = false;
+    m_progressTotal  = objects.count();
+    emit saveProgress(m_progressTotal + 1, 0, tr("Writing settings"));
 
-    qDebug() << "Finished saving modified objects to controller. Success = " << m_transactionOK;
+    QTimer outerTimeoutTimer;
+    outerTimeoutTimer.setSingleShot(true);
 
-    return m_transactionOK;
-}
+    connect(utilMngr, SIGNAL(batchProgress(int, int)), this, SLOT(batchProgress(int, int)));
+    connect(utilMngr, SIGNAL(batchCompleted(bool)), this, SLOT(batchCompleted(bool)));
+    connect(&outerTimeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
 
-void VehicleConfigurationHelper::uAVOTransactionCompleted(int oid, bool success)
-{
-    if (oid == m_currentTransactionObjectID) {
-        m_transactionOK = success;
-        m_eventLoop.quit();
+    // uploads are pipelined and the saves follow them, one wait for the whole batch
+    outerTimeoutTimer.start(OUTER_TIMEOUT);
+    if (save) {
+        utilMngr->saveObjectsToSD(objects);
+    } else {
+        utilMngr->uploadObjects(objects);
+    }
+    if (!m_batchCompleted) {
+        m_eventLoop.exec();
+    }
+    outerTimeoutTimer.stop();
+
+    disconnect(&outerTimeoutTimer, SIGNAL(timeout()), &m_eventLoop, SLOT(quit()));
+    disconnect(utilMngr, SIGNAL(batchCompleted(bool)), this, SLOT(batchCompleted(bool)));
+    disconnect(utilMngr, SIGNAL(batchProgress(int, int)), this, SLOT(batchProgress(int, int)));
+
+    if (!m_batchCompleted) {
+        qDebug() << "Transaction timed out when trying to save " << objects.count() << " objects.";
     }
+    qDebug() << "Finished saving modified objects to controller. Success = " << m_batchSuccess;
+
+    return m_batchCompleted && m_batchSuccess;
 }
 
-void VehicleConfigurationHelper::uAVOTransactionCompleted(UAVObject *object, bool success)
+void VehicleConfigurationHelper::batchProgress(int done, int total)
 {
-    if (object) {
-        uAVOTransactionCompleted(object->getObjID(), success);
+    // a batch counts the uploads and the saves, scale it to the objects
+    if (total > 0) {
+        emit saveProgress(m_progressTotal + 1, (done * m_progressTotal) / total,
+                          tr("Writing settings %1/%2").arg(done).arg(total));
     }
 }
 
-void VehicleConfigurationHelper::saveChangesTimeout()
+void VehicleConfigurationHelper::batchCompleted(bool success)
 {
-    m_transactionOK = false;
-    m_transactionTimeout = true;
+    m_batchCompleted = true;
+    m_batchSuccess   = success;
     m_eventLoop.quit();
 }
 
@@ -106,10 +106,10 @@ private:
 
     bool saveChangesToController(bool save);
     QEventLoop m_eventLoop;
-    bool m_transactionOK;
-    bool m_transactionTimeout;
-    int m_currentTransactionObjectID;
-    int m_progress;
+    bool m_batchCompleted;
+    bool m_batchSuccess;
+    // objects of the last batch
+    int m_progressTotal;
 
     void resetVehicleConfig();
     void resetGUIData();
@@ -130,9 +130,8 @@ private:
     void setupBoatDiff();
 
 private slots:
-    void uAVOTransactionCompleted(UAVObject *object, bool success);
-    void uAVOTransactionCompleted(int oid, bool success);
-    void saveChangesTimeout();
+    void batchProgress(int done, int total);
+    void batchCompleted(bool success);
 };
 
 #endif // VEHICLECONFIGURATIONHELPER_H
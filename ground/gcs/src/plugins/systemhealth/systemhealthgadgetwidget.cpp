@@ -31,10 +31,12 @@
 #include "utils/stylehelper.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
+#include "uavobjectupdatecoalescer.h"
 #include <uavtalk/telemetrymanager.h>
 
 #include <QDebug>
 #include <QWhatsThis>
+#include <QMultiMap>
 
 /*
  * Initialize the widget
@@ -53,24 +55,79 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
     logreplay  = new QGraphicsSvgItem();
     logreplay2 = new QGraphicsSvgItem();
     missingElements = new QStringList();
+    // render the layers once per view size
+    background->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    foreground->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    nolink->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    logreplay->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    logreplay2->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
     paint();
 
     // Now connect the widget to the SystemAlarms UAVObject
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
+    UAVObjectUpdateCoalescer *coalescer = pm->getObject<UAVObjectUpdateCoalescer>();
+
     SystemAlarms *obj = dynamic_cast<SystemAlarms *>(objManager->getObject(QString("SystemAlarms")));
-    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateAlarms(UAVObject *)));
+    connect(coalescer->updates(obj), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateAlarms(UAVObject *)));
 
     // Listen to autopilot connection events
     TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
     connect(telMngr, SIGNAL(connected()), this, SLOT(onAutopilotConnect()));
     connect(telMngr, SIGNAL(disconnected()), this, SLOT(onAutopilotDisconnect()));
     connect(telMngr, SIGNAL(telemetryUpdated(double, double)), this, SLOT(onTelemetryUpdated(double, double)));
+    connect(telMngr, SIGNAL(latencyUpdated()), this, SLOT(onLatencyUpdated()));
 
     setToolTip(tr("Displays flight system errors. Click on an alarm for more information."));
 }
 
+/**
+ * Show the telemetry receive latencies in the tooltip, with the slowest objects
+ */
+void SystemHealthGadgetWidget::onLatencyUpdated()
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    TelemetryManager *telMngr    = pm->getObject<TelemetryManager>();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    UAVTalk::LatencyStats stats  = telMngr->latencyStats();
+
+    QString tip = tr("Displays flight system errors. Click on an alarm for more information.");
+
+    if (stats.total.count() == 0) {
+        setToolTip(tip);
+        return;
+    }
+    tip += "\n\n" + tr("Telemetry receive latency (%1 objects):").arg(stats.total.count());
+    if (stats.device.count() > 0) {
+        tip += "\n" + tr("device to reader: %1").arg(stats.device.toString());
+    }
+    tip += "\n" + tr("reader to object: %1").arg(stats.decode.toString());
+    tip += "\n" + tr("total: %1").arg(stats.total.toString());
+    if (stats.control.count() > 0) {
+        tip += "\n" + tr("Control input to wire (%1 updates): %2").arg(stats.control.count()).arg(stats.control.toString());
+    }
+
+    // the 5 objects with the worst p99
+    QMultiMap<qint64, quint32> slowest;
+    QHash<quint32, LatencyHistogram>::const_iterator i;
+    for (i = stats.objects.constBegin(); i != stats.objects.constEnd(); ++i) {
+        slowest.insert(i.value().percentile(99), i.key());
+        if (slowest.size() > 5) {
+            slowest.erase(slowest.begin());
+        }
+    }
+    QMapIterator<qint64, quint32> j(slowest);
+    j.toBack();
+    while (j.hasPrevious()) {
+        j.previous();
+        UAVObject *obj = objManager->getObject(j.value());
+        QString name   = obj ? obj->getName() : QString::number(j.value(), 16);
+        tip += "\n  " + name + ": " + stats.objects.value(j.value()).toString();
+    }
+    setToolTip(tip);
+}
+
 /**
  * Hide/Show the "Log Replay" overlay
  */
@@ -122,20 +179,9 @@ void SystemHealthGadgetWidget::onAutopilotDisconnect()
 
 void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
 {
-    // This code does not know anything about alarms beforehand, and
-    // I found no efficient way to locate items inside the scene by
-    // name, so it's just as simple to reset the scene:
-    // And add the one with the right name.
-    QGraphicsScene *m_scene = scene();
-
-    foreach(QGraphicsItem * item, background->childItems()) {
-        m_scene->removeItem(item);
-        delete item; // removeItem does _not_ delete the item.
-    }
-
-    QMatrix backgroundMatrix = (m_renderer->matrixForElement(background->elementId())).inverted();
-
-    QString alarm = systemAlarm->getName();
+    // The state items are created the first time they are needed and then
+    // only shown or hidden. They are rendered once into their pixmap cache
+    // and the svg is only rasterized again when the view is resized.
     foreach(UAVObjectField * field, systemAlarm->getFields()) {
         for (uint i = 0; i < field->getNumElements(); ++i) {
             QString element = field->getElementNames()[i];
@@ -143,26 +189,24 @@ void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
             if (!missingElements->contains(element)) {
                 if (m_renderer->elementExists(element)) {
                     QString element2 = element + "-" + value;
+                    QGraphicsSvgItem *shown = m_shownIndicators.value(element);
+                    QGraphicsSvgItem *ind   = NULL;
                     if (!missingElements->contains(element2)) {
-                        if (m_renderer->elementExists(element2)) {
-                            // element2 is in global coordinates
-                            // transform its matrix into the coordinates of background
-                            QMatrix blockMatrix   = backgroundMatrix * m_renderer->matrixForElement(element2);
-                            // use this composed projection to get the position in background coordinates
-                            QRectF rectProjected  = blockMatrix.mapRect(m_renderer->boundsOnElement(element2));
-
-                            QGraphicsSvgItem *ind = new QGraphicsSvgItem();
-                            ind->setSharedRenderer(m_renderer);
-                            ind->setElementId(element2);
-                            ind->setParentItem(background);
-                            QTransform matrix;
-                            matrix.translate(rectProjected.x(), rectProjected.y());
-                            ind->setTransform(matrix, false);
+                        ind = indicatorItem(element2);
+                        if (!ind && (value.compare("Uninitialised") != 0)) {
+                            missingElements->append(element2);
+                            qDebug() << "Warning: element " << element2 << " not found in SVG.";
+                        }
+                    }
+                    if (ind != shown) {
+                        if (shown) {
+                            shown->setVisible(false);
+                        }
+                        if (ind) {
+                            ind->setVisible(true);
+                            m_shownIndicators.insert(element, ind);
                         } else {
-                            if (value.compare("Uninitialised") != 0) {
-                                missingElements->append(element2);
-                                qDebug() << "Warning: element " << element2 << " not found in SVG.";
-                            }
+                            m_shownIndicators.remove(element);
                         }
                     }
                 } else {
@@ -174,6 +218,61 @@ void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
     }
 }
 
+/*
+ * Returns the item of an alarm state, creating it on first use.
+ * Returns NULL if the state is not in the svg.
+ */
+QGraphicsSvgItem *SystemHealthGadgetWidget::indicatorItem(const QString &elementId)
+{
+    QGraphicsSvgItem *ind = m_indicators.value(elementId);
+
+    if (ind || !m_renderer->elementExists(elementId)) {
+        return ind;
+    }
+
+    // elementId is in global coordinates
+    // transform its matrix into the coordinates of background
+    QMatrix backgroundMatrix = (m_renderer->matrixForElement(background->elementId())).inverted();
+    QMatrix blockMatrix     = backgroundMatrix * m_renderer->matrixForElement(elementId);
+    // use this composed projection to get the position in background coordinates
+    QRectF rectProjected    = blockMatrix.mapRect(m_renderer->boundsOnElement(elementId));
+
+    ind = new QGraphicsSvgItem();
+    ind->setSharedRenderer(m_renderer);
+    ind->setElementId(elementId);
+    ind->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    ind->setVisible(false);
+    ind->setParentItem(background);
+    QTransform matrix;
+    matrix.translate(rectProjected.x(), rectProjected.y());
+    ind->setTransform(matrix, false);
+
+    m_indicators.insert(elementId, ind);
+    return ind;
+}
+
+void SystemHealthGadgetWidget::clearIndicators()
+{
+    m_shownIndicators.clear();
+    qDeleteAll(m_indicators);
+    m_indicators.clear();
+}
+
+/*
+ * Keep the large layers cached at any view size, the default
+ * maximum cache size of svg items disables caching on big views.
+ */
+void SystemHealthGadgetWidget::updateCacheSize()
+{
+    QSize size = viewport()->size() * devicePixelRatio();
+
+    background->setMaximumCacheSize(size);
+    foreground->setMaximumCacheSize(size);
+    nolink->setMaximumCacheSize(size);
+    logreplay->setMaximumCacheSize(size);
+    logreplay2->setMaximumCacheSize(size);
+}
+
 SystemHealthGadgetWidget::~SystemHealthGadgetWidget()
 {
     // Do nothing
@@ -184,6 +283,8 @@ void SystemHealthGadgetWidget::setSystemFile(QString dfn)
 {
     // Clear the list of elements not found on svg
     missingElements->clear();
+    // and the alarm items of the previous svg
+    clearIndicators();
     setBackgroundBrush(QBrush(Utils::StyleHelper::baseColor()));
     if (QFile::exists(dfn)) {
         m_renderer->load(dfn);
@@ -261,6 +362,8 @@ void SystemHealthGadgetWidget::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
     fitInView(background, Qt::KeepAspectRatio);
+    // item caches are regenerated at the new size on next paint
+    updateCacheSize();
 }
 
 void SystemHealthGadgetWidget::mousePressEvent(QMouseEvent *event)
@@ -273,7 +376,7 @@ void SystemHealthGadgetWidget::mousePressEvent(QMouseEvent *event)
         foreach(QGraphicsItem * sceneItem, items(point)) {
             QGraphicsSvgItem *clickedItem = dynamic_cast<QGraphicsSvgItem *>(sceneItem);
 
-            if (clickedItem) {
+            if (clickedItem && clickedItem->isVisible()) {
                 if ((clickedItem != foreground) && (clickedItem != background)) {
                     // Clicked an actual alarm. We need to set haveAlarmItem to true
                     // as two of the items in this loop will always be foreground and
@@ -319,7 +422,7 @@ void SystemHealthGadgetWidget::showAllAlarmDescriptions(const QPoint & location)
         foreach(QGraphicsItem * curItem, graphicsScene->items()) {
             QGraphicsSvgItem *curSvgItem = dynamic_cast<QGraphicsSvgItem *>(curItem);
 
-            if (curSvgItem && (curSvgItem != foreground) && (curSvgItem != background)) {
+            if (curSvgItem && curSvgItem->isVisible() && (curSvgItem != foreground) && (curSvgItem != background)) {
                 QString elementId = curSvgItem->elementId();
                 if (!elementId.contains("OK")) {
                     // Found an alarm, get its corresponding alarm html file contents
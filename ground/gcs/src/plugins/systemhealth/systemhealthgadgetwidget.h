@@ -38,6 +38,7 @@
 
 #include <QFile>
 #include <QTimer>
+#include <QHash>
 
 class SystemHealthGadgetWidget : public QGraphicsView {
     Q_OBJECT
@@ -59,6 +60,7 @@ private slots:
     void onAutopilotConnect();
     void onAutopilotDisconnect();
     void onTelemetryUpdated(double txRate, double rxRate);
+    void onLatencyUpdated();
 
 private:
     QSvgRenderer *m_renderer;
@@ -68,11 +70,20 @@ private:
     QGraphicsSvgItem *logreplay;
     QGraphicsSvgItem *logreplay2;
     QStringList *missingElements;
+    // Alarm state items (by element-value id), created once and shown as needed.
+    // The items are cached as pixmaps at the current view size.
+    QHash<QString, QGraphicsSvgItem *> m_indicators;
+    // The state item currently shown for each alarm
+    QHash<QString, QGraphicsSvgItem *> m_shownIndicators;
     // Simple flag to skip rendering if the
     bool fgenabled; // layer does not exist.
     bool boardConnected;
     int logreplayDelay;
 
+    QGraphicsSvgItem *indicatorItem(const QString &elementId);
+    void clearIndicators();
+    void updateCacheSize();
+
     void showAlarmDescriptionForItemId(const QString itemId, const QPoint & location);
     void showAllAlarmDescriptions(const QPoint &location);
 };
@@ -28,14 +28,24 @@
 #include "monitorgadget.h"
 #include "monitorgadgetconfiguration.h"
 #include "monitorwidget.h"
+#include "objectbandwidthwidget.h"
 
-MonitorGadget::MonitorGadget(QString classId, MonitorWidget *widget, QWidget *parent) :
-    IUAVGadget(classId, parent), m_widget(widget)
-{}
+#include <QVBoxLayout>
+
+MonitorGadget::MonitorGadget(QString classId, MonitorWidget *widget, ObjectBandwidthWidget *bandwidthWidget, QWidget *parent) :
+    IUAVGadget(classId, parent), m_widget(widget), m_bandwidthWidget(bandwidthWidget)
+{
+    m_container = new QWidget(parent);
+    QVBoxLayout *layout = new QVBoxLayout(m_container);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_widget);
+    layout->addWidget(m_bandwidthWidget, 1);
+}
 
 MonitorGadget::~MonitorGadget()
 {
-    delete m_widget;
+    // deletes the widgets too
+    delete m_container;
 }
 
 /*
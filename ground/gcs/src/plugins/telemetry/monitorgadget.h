@@ -31,6 +31,8 @@
 #include <coreplugin/iuavgadget.h>
 #include "monitorwidget.h"
 
+class ObjectBandwidthWidget;
+
 // class IUAVGadget;
 // class QWidget;
 // class QString;
@@ -41,18 +43,21 @@ using namespace Core;
 class MonitorGadget : public IUAVGadget {
     Q_OBJECT
 public:
-    MonitorGadget(QString classId, MonitorWidget *widget, QWidget *parent = 0);
+    MonitorGadget(QString classId, MonitorWidget *widget, ObjectBandwidthWidget *bandwidthWidget, QWidget *parent = 0);
     ~MonitorGadget();
 
     QWidget *widget()
     {
-        return m_widget;
+        return m_container;
     }
 
     void loadConfiguration(IUAVGadgetConfiguration *config);
 
 private:
+    // the rates on top of the table of the objects using them
+    QWidget *m_container;
     MonitorWidget *m_widget;
+    ObjectBandwidthWidget *m_bandwidthWidget;
 };
 
 #endif // MONITORGADGET_H
@@ -30,6 +30,7 @@
 #include "monitorgadgetconfiguration.h"
 #include "monitorgadget.h"
 #include "monitorgadgetoptionspage.h"
+#include "objectbandwidthwidget.h"
 
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/connectionmanager.h>
@@ -47,7 +48,13 @@ Core::IUAVGadget *MonitorGadgetFactory::createGadget(QWidget *parent)
 {
     MonitorWidget *widget = createMonitorWidget(parent);
 
-    return new MonitorGadget(QString("TelemetryMonitorGadget"), widget, parent);
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    TelemetryManager *tm = pm->getObject<TelemetryManager>();
+    ObjectBandwidthWidget *bandwidthWidget = new ObjectBandwidthWidget(tm, parent);
+    connect(tm, SIGNAL(latencyUpdated()), bandwidthWidget, SLOT(bandwidthUpdated()));
+    connect(Core::ICore::instance()->connectionManager(), SIGNAL(deviceDisconnected()), bandwidthWidget, SLOT(telemetryDisconnected()));
+
+    return new MonitorGadget(QString("TelemetryMonitorGadget"), widget, bandwidthWidget, parent);
 }
 
 MonitorWidget *MonitorGadgetFactory::createMonitorWidget(QWidget *parent)
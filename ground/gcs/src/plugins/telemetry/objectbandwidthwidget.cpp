@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectbandwidthwidget.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup MonitorPlugin Telemetry Plugin
+ * @{
+ * @brief      Live packets and bytes by object of the telemetry link
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "objectbandwidthwidget.h"
+
+#include <extensionsystem/pluginmanager.h>
+#include <uavtalk/telemetrymanager.h>
+#include <uavobjectmanager.h>
+
+#include <QHeaderView>
+
+ObjectBandwidthWidget::ObjectBandwidthWidget(TelemetryManager *telemetryManager, QWidget *parent) :
+    QTreeWidget(parent), m_telemetryManager(telemetryManager)
+{
+    m_objectManager = ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>();
+
+    QStringList labels;
+    labels << tr("Object") << tr("Rx B/s") << tr("Rx %") << tr("Rx pkt/s")
+           << tr("Tx B/s") << tr("Tx %") << tr("Tx pkt/s");
+    setColumnCount(COLUMN_COUNT);
+    setHeaderLabels(labels);
+    setRootIsDecorated(false);
+    setUniformRowHeights(true);
+    setAlternatingRowColors(true);
+    setSortingEnabled(true);
+    sortByColumn(COLUMN_RX_SHARE, Qt::DescendingOrder);
+    header()->setSectionResizeMode(COLUMN_NAME, QHeaderView::Stretch);
+    for (int column = COLUMN_RX_RATE; column < COLUMN_COUNT; ++column) {
+        header()->setSectionResizeMode(column, QHeaderView::ResizeToContents);
+    }
+}
+
+ObjectBandwidthWidget::~ObjectBandwidthWidget()
+{}
+
+/**
+ * Show the rates of the last statistics period. The objects seen earlier stay listed, at 0.
+ */
+void ObjectBandwidthWidget::bandwidthUpdated()
+{
+    UAVTalk::BandwidthStats bandwidth = m_telemetryManager->bandwidthStats();
+
+    if (bandwidth.periodMs <= 0) {
+        return;
+    }
+    double seconds = bandwidth.periodMs / 1000.0;
+
+    // sorting while the rows change would move them under the updates
+    setSortingEnabled(false);
+    foreach(QTreeWidgetItem * item, m_items) {
+        for (int column = COLUMN_RX_RATE; column < COLUMN_COUNT; ++column) {
+            item->setData(column, Qt::DisplayRole, 0.0);
+        }
+    }
+    foreach(const UAVTalk::ObjectCounters &counters, bandwidth.objects) {
+        QTreeWidgetItem *item = itemOf(counters.objId);
+        item->setData(COLUMN_RX_RATE, Qt::DisplayRole, qRound(counters.rxBytes / seconds));
+        item->setData(COLUMN_RX_PACKETS, Qt::DisplayRole, qRound(counters.rxPackets * 10 / seconds) / 10.0);
+        item->setData(COLUMN_TX_RATE, Qt::DisplayRole, qRound(counters.txBytes / seconds));
+        item->setData(COLUMN_TX_PACKETS, Qt::DisplayRole, qRound(counters.txPackets * 10 / seconds) / 10.0);
+        // the counters tell the v1 packet size, the share is capped for the v2 links
+        if (bandwidth.rxBytes > 0) {
+            item->setData(COLUMN_RX_SHARE, Qt::DisplayRole,
+                          qMin(100.0, qRound(counters.rxBytes * 1000.0 / bandwidth.rxBytes) / 10.0));
+        }
+        if (bandwidth.txBytes > 0) {
+            item->setData(COLUMN_TX_SHARE, Qt::DisplayRole,
+                          qMin(100.0, qRound(counters.txBytes * 1000.0 / bandwidth.txBytes) / 10.0));
+        }
+    }
+    setSortingEnabled(true);
+}
+
+void ObjectBandwidthWidget::telemetryDisconnected()
+{
+    clear();
+    m_items.clear();
+}
+
+QTreeWidgetItem *ObjectBandwidthWidget::itemOf(quint32 objId)
+{
+    QTreeWidgetItem *item = m_items.value(objId);
+
+    if (!item) {
+        UAVObject *obj = (objId != 0 && m_objectManager) ? m_objectManager->getObject(objId) : NULL;
+        QString name;
+        if (obj) {
+            name = obj->getName();
+        } else if (objId != 0) {
+            name = QString("0x") + QString::number(objId, 16).toUpper();
+        } else {
+            name = tr("(other)");
+        }
+        item = new QTreeWidgetItem(this);
+        item->setText(COLUMN_NAME, name);
+        for (int column = COLUMN_RX_RATE; column < COLUMN_COUNT; ++column) {
+            item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        }
+        m_items.insert(objId, item);
+    }
+    return item;
+}
@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectbandwidthwidget.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup MonitorPlugin Telemetry Plugin
+ * @{
+ * @brief      Live packets and bytes by object of the telemetry link
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef OBJECTBANDWIDTHWIDGET_H
+#define OBJECTBANDWIDTHWIDGET_H
+
+#include <QTreeWidget>
+#include <QHash>
+
+class TelemetryManager;
+class UAVObjectManager;
+
+/**
+ * Sortable table of the rates of each object on the telemetry link and their share of the link,
+ * to find the objects to slow down (metadata update periods) when the link is saturated.
+ * Refreshed each telemetry statistics period.
+ */
+class ObjectBandwidthWidget : public QTreeWidget {
+    Q_OBJECT
+public:
+    explicit ObjectBandwidthWidget(TelemetryManager *telemetryManager, QWidget *parent = 0);
+    ~ObjectBandwidthWidget();
+
+public slots:
+    void bandwidthUpdated();
+    void telemetryDisconnected();
+
+private:
+    enum Column {
+        COLUMN_NAME = 0,
+        COLUMN_RX_RATE,
+        COLUMN_RX_SHARE,
+        COLUMN_RX_PACKETS,
+        COLUMN_TX_RATE,
+        COLUMN_TX_SHARE,
+        COLUMN_TX_PACKETS,
+        COLUMN_COUNT
+    };
+
+    TelemetryManager *m_telemetryManager;
+    UAVObjectManager *m_objectManager;
+    QHash<quint32, QTreeWidgetItem *> m_items;
+
+    QTreeWidgetItem *itemOf(quint32 objId);
+};
+
+#endif // OBJECTBANDWIDTHWIDGET_H
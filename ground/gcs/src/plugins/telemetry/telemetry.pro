@@ -11,6 +11,7 @@ HEADERS += \
     telemetry_global.h \
     telemetryplugin.h \
     monitorwidget.h \
+    objectbandwidthwidget.h \
     monitorgadgetconfiguration.h \
     monitorgadget.h \
     monitorgadgetfactory.h \
@@ -19,6 +20,7 @@ HEADERS += \
 SOURCES += \
     telemetryplugin.cpp \
     monitorwidget.cpp \
+    objectbandwidthwidget.cpp \
     monitorgadgetconfiguration.cpp \
     monitorgadget.cpp \
     monitorgadgetfactory.cpp \
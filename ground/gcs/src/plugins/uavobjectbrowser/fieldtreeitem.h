@@ -90,7 +90,7 @@ public:
             }
         }
         if (changed() || updated) {
-            setHighlighted(true, ts);
+            setHighlighted(true);
         }
     }
 
@@ -128,11 +128,9 @@ public:
 
     QVariant fieldToData() const
     {
-        QStringList options = m_field->getOptions();
         QVariant value = m_field->getValue(m_index);
-        int valIndex   = options.indexOf(value.toString());
 
-        return valIndex;
+        return m_field->getOptionIndex(value.toString());
     }
 
     QVariant dataToField() const
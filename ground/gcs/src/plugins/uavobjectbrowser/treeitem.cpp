@@ -29,44 +29,54 @@
 
 #include <QDebug>
 
+// wheel period (~25 fps)
+static const int TICK_PERIOD_MS = 40;
+
 /* Constructor */
-HighlightManager::HighlightManager()
+HighlightManager::HighlightManager() : m_currentBucket(0), m_count(0)
 {
     // Initialize the timer and connect it to the callback
-    m_expirationTimer.setTimerType(Qt::PreciseTimer);
-    m_expirationTimer.setSingleShot(true);
-    connect(&m_expirationTimer, &QTimer::timeout, this, &HighlightManager::checkItemsExpired);
+    m_tickTimer.setTimerType(Qt::PreciseTimer);
+    m_tickTimer.setInterval(TICK_PERIOD_MS);
+    connect(&m_tickTimer, &QTimer::timeout, this, &HighlightManager::tick);
 }
 
 /*
- * Called to add item to list. Item is only added if absent.
+ * Called to add item to the wheel. Item is only added if absent.
  * Returns true if item was added, otherwise false.
  */
 bool HighlightManager::add(TreeItem *item)
 {
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
+    if (item->m_highlightBucket >= 0) {
+        return false;
+    }
 
-    // Check so that the item isn't already in the list
-    if (!m_items.contains(item)) {
-        m_items.insert(item);
-        emit updateHighlight(item);
-        return true;
+    // number of ticks before expiration, the current bucket expires on next tick
+    int ticks = qMax(0, (TreeItem::highlightTime() - 1) / TICK_PERIOD_MS);
+    if (ticks >= m_buckets.size()) {
+        resizeWheel(ticks + 1);
     }
-    return false;
+
+    int bucket = (m_currentBucket + ticks) % m_buckets.size();
+    m_buckets[bucket].insert(item);
+    item->m_highlightBucket = bucket;
+    m_count++;
+
+    if (!m_tickTimer.isActive()) {
+        m_tickTimer.start();
+    }
+
+    emit updateHighlight(item);
+    return true;
 }
 
 /*
- * Called to remove item from list.
+ * Called to remove item from the wheel.
  * Returns true if item was removed, otherwise false.
  */
 bool HighlightManager::remove(TreeItem *item)
 {
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
-
-    // Remove item and return result
-    const bool removed = m_items.remove(item);
+    const bool removed = reset(item);
 
     if (removed) {
         emit updateHighlight(item);
@@ -75,85 +85,84 @@ bool HighlightManager::remove(TreeItem *item)
 }
 
 /*
- * Called to remove item from list.
+ * Called to remove item from the wheel.
  * Will not emit a signal. Called when destroying an item
  * Returns true if item was removed, otherwise false.
  */
 bool HighlightManager::reset(TreeItem *item)
 {
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
-
-    // Remove item and return result
-    return m_items.remove(item);
-}
-
-bool HighlightManager::startTimer(QTime expirationTime)
-{
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
-
-    if (!m_expirationTimer.isActive()) {
-        int msec = QTime::currentTime().msecsTo(expirationTime);
-        // qDebug() << "start" << msec;
-        m_expirationTimer.start((msec < 10) ? 10 : msec);
-        return true;
+    if (item->m_highlightBucket < 0) {
+        return false;
     }
-    return false;
+    m_buckets[item->m_highlightBucket].remove(item);
+    item->m_highlightBucket = -1;
+    m_count--;
+    return true;
 }
 
-
 void HighlightManager::reset()
 {
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
-
-    m_expirationTimer.stop();
+    m_tickTimer.stop();
 
-    m_items.clear();
+    for (int i = 0; i < m_buckets.size(); ++i) {
+        foreach(TreeItem * item, m_buckets[i]) {
+            item->m_highlightBucket = -1;
+        }
+        m_buckets[i].clear();
+    }
+    m_count = 0;
 }
 
 /*
  * Callback called periodically by the timer.
- * This method checks for expired highlights and
- * removes them if they are expired.
- * Expired highlights are restored.
+ * Restores all items of the expired bucket and
+ * advances the wheel.
  */
-void HighlightManager::checkItemsExpired()
+void HighlightManager::tick()
 {
-    // Lock to ensure thread safety
-    QMutexLocker locker(&m_mutex);
+    if (m_buckets.isEmpty()) {
+        m_tickTimer.stop();
+        return;
+    }
+
+    QList<TreeItem *> expired = m_buckets[m_currentBucket].toList();
+    m_buckets[m_currentBucket].clear();
+    m_currentBucket = (m_currentBucket + 1) % m_buckets.size();
 
-    // Get a mutable iterator for the list
-    QMutableSetIterator<TreeItem *> iter(m_items);
+    foreach(TreeItem * item, expired) {
+        item->resetHighlight();
+        item->m_highlightBucket = -1;
+    }
+    m_count -= expired.size();
 
-    // This is the timestamp to compare with
-    QTime now = QTime::currentTime();
-    QTime next;
+    if (!expired.isEmpty()) {
+        emit highlightsExpired(expired);
+    }
 
-    // Loop over all items, check if they expired.
-    while (iter.hasNext()) {
-        TreeItem *item = iter.next();
-        if (item->getHighlightExpires() <= now) {
-            // expired, call removeHighlight
-            item->resetHighlight();
+    // stop ticking when there is nothing left to expire
+    if (m_count == 0) {
+        m_tickTimer.stop();
+    }
+}
 
-            // Remove from list since it is restored.
-            iter.remove();
+/*
+ * Grows the wheel when the highlight time is increased.
+ * Items keep their remaining number of ticks.
+ */
+void HighlightManager::resizeWheel(int size)
+{
+    QVector<QSet<TreeItem *> > buckets(size);
+    int oldSize = m_buckets.size();
 
-            emit updateHighlight(item);
-        } else {
-            // not expired, check if next to expire
-            if (!next.isValid() || (next > item->getHighlightExpires())) {
-                next = item->getHighlightExpires();
-            }
+    for (int i = 0; i < oldSize; ++i) {
+        int ticks = (i - m_currentBucket + oldSize) % oldSize;
+        foreach(TreeItem * item, m_buckets[i]) {
+            item->m_highlightBucket = ticks;
         }
+        buckets[ticks] = m_buckets[i];
     }
-    if (next.isValid()) {
-        int msec = QTime::currentTime().msecsTo(next);
-        // qDebug() << "restart" << msec;
-        m_expirationTimer.start((msec < 10) ? 10 : msec);
-    }
+    m_buckets = buckets;
+    m_currentBucket = 0;
 }
 
 int TreeItem::m_highlightTimeMs = 300;
@@ -162,14 +171,22 @@ TreeItem::TreeItem(const QList<QVariant> &data) :
     m_itemData(data),
     m_parentItem(0),
     m_changed(false),
+    m_expanded(false),
+    m_filterMatch(0),
+    m_filterGeneration(-1),
     m_highlighted(false),
+    m_highlightBucket(-1),
     m_highlightManager(0)
 {}
 
 TreeItem::TreeItem(const QVariant &data) :
     m_parentItem(0),
     m_changed(false),
+    m_expanded(false),
+    m_filterMatch(0),
+    m_filterGeneration(-1),
     m_highlighted(false),
+    m_highlightBucket(-1),
     m_highlightManager(0)
 {
     m_itemData << data << "" << "";
@@ -253,6 +270,17 @@ QVariant TreeItem::data(int column) const
 void TreeItem::setData(QVariant value, int column)
 {
     m_itemData.replace(column, value);
+    if (column == TITLE_COLUMN) {
+        m_searchName.clear();
+    }
+}
+
+const QString &TreeItem::searchName() const
+{
+    if (m_searchName.isNull()) {
+        m_searchName = data(TITLE_COLUMN).toString().toLower();
+    }
+    return m_searchName;
 }
 
 void TreeItem::update(const QTime &ts)
@@ -272,18 +300,14 @@ void TreeItem::apply()
 /*
  * Called after a value has changed to trigger highlighting of tree item.
  */
-void TreeItem::setHighlighted(bool highlighted, const QTime &ts)
+void TreeItem::setHighlighted(bool highlighted)
 {
     m_changed = false;
     if (m_highlighted != highlighted) {
         m_highlighted = highlighted;
         if (highlighted) {
-            // Add to highlight manager
+            // Add to highlight manager, it takes care of the expiration
             m_highlightManager->add(this);
-            // Update expiration timeout
-            m_highlightExpires = ts.addMSecs(m_highlightTimeMs);
-            // start expiration timer if necessary
-            m_highlightManager->startTimer(m_highlightExpires);
         } else {
             m_highlightManager->remove(this);
         }
@@ -293,7 +317,7 @@ void TreeItem::setHighlighted(bool highlighted, const QTime &ts)
     // This will ensure that the root of a leaf that is changed is also highlighted.
     // Only updates that really changes values will trigger highlight of parents.
     if (m_parentItem) {
-        m_parentItem->setHighlighted(highlighted, ts);
+        m_parentItem->setHighlighted(highlighted);
     }
 }
 
@@ -307,11 +331,6 @@ void TreeItem::setHighlightManager(HighlightManager *mgr)
     m_highlightManager = mgr;
 }
 
-QTime TreeItem::getHighlightExpires() const
-{
-    return m_highlightExpires;
-}
-
 int TreeItem::childIndex(QString name) const
 {
     for (int i = 0; i < childCount(); ++i) {
@@ -35,6 +35,7 @@
 
 #include <QList>
 #include <QSet>
+#include <QVector>
 #include <QVariant>
 #include <QTime>
 #include <QTimer>
@@ -45,16 +46,14 @@ class TreeItem;
 /*
  * Small utility class that handles the higlighting of
  * tree grid items.
- * Basicly it maintains all items due to be restored to
- * non highlighted state in a linked list.
- * A timer traverses this list periodically to find out
- * if any of the items should be restored. All items are
- * updated with an expiration timestamp when they expires.
- * An item that is beeing restored is removed from the
- * list and its removeHighlight() method is called. Items
- * that are not expired are left in the list til next time.
+ * Highlighted items are kept in an expiration wheel made of
+ * one bucket per tick. An item is put in the bucket that
+ * expires when the highlight time has elapsed.
+ * A single periodic timer advances the wheel and restores
+ * all the items of the expired bucket in one go, the cost
+ * does not depend on how often items are updated.
  * Items that are updated during the expiration time are
- * left untouched in the list. This reduces unwanted emits
+ * left untouched in their bucket. This reduces unwanted emits
  * of signals to the repaint/update function.
  */
 class HighlightManager : public QObject {
@@ -71,33 +70,42 @@ public:
     // This is called when an item is destroyed
     bool reset(TreeItem *item);
 
-    bool startTimer(QTime time);
-
     void reset();
 
 signals:
     void updateHighlight(TreeItem *item);
+    void highlightsExpired(const QList<TreeItem *> &items);
 
 private slots:
     // Timer callback method.
-    void checkItemsExpired();
+    void tick();
 
 private:
-    // The timer checking highlight expiration.
-    QTimer m_expirationTimer;
+    void resizeWheel(int size);
+
+    // The timer advancing the wheel.
+    QTimer m_tickTimer;
+
+    // The expiration wheel, a bucket expires on each tick.
+    QVector<QSet<TreeItem *> > m_buckets;
 
-    // The collection holding all items due to be updated.
-    QSet<TreeItem *> m_items;
+    // The bucket expiring on next tick.
+    int m_currentBucket;
 
-    // Mutex to lock when accessing collection.
-    QMutex m_mutex;
+    // Number of items in the wheel.
+    int m_count;
 };
 
 class TreeItem {
+    friend class HighlightManager;
+
 public:
     static const int TITLE_COLUMN = 0;
     static const int DATA_COLUMN  = 1;
 
+    // filter match bits, see TreeSortFilterProxyModel
+    enum FilterMatch { SelfMatch = 0x1, AncestorMatch = 0x2, DescendantMatch = 0x4 };
+
     TreeItem(const QList<QVariant> &data);
     TreeItem(const QVariant &data);
     virtual ~TreeItem();
@@ -159,19 +167,53 @@ public:
         return m_highlighted;
     }
 
-    void setHighlighted(bool highlighted, const QTime &ts);
+    void setHighlighted(bool highlighted);
 
     static void setHighlightTime(int time)
     {
         m_highlightTimeMs = time;
     }
 
-    QTime getHighlightExpires() const;
+    static int highlightTime()
+    {
+        return m_highlightTimeMs;
+    }
 
     void resetHighlight();
 
     void setHighlightManager(HighlightManager *mgr);
 
+    // expanded state of the item row in the view
+    bool isExpanded() const
+    {
+        return m_expanded;
+    }
+
+    void setExpanded(bool expanded)
+    {
+        m_expanded = expanded;
+    }
+
+    // lowercase title, built once and used for filtering
+    const QString &searchName() const;
+
+    int filterMatch() const
+    {
+        return m_filterMatch;
+    }
+
+    // generation of the filter the match bits were computed for
+    int filterGeneration() const
+    {
+        return m_filterGeneration;
+    }
+
+    void setFilterMatch(int match, int generation)
+    {
+        m_filterMatch      = match;
+        m_filterGeneration = generation;
+    }
+
     virtual bool isKnown() const
     {
         if (m_parentItem) {
@@ -200,8 +242,15 @@ private:
 
     bool m_changed;
 
+    bool m_expanded;
+
+    mutable QString m_searchName;
+    int m_filterMatch;
+    int m_filterGeneration;
+
     bool m_highlighted;
-    QTime m_highlightExpires;
+    // expiration wheel bucket, -1 if none
+    int m_highlightBucket;
     HighlightManager *m_highlightManager;
 };
 
@@ -255,10 +304,10 @@ public:
 class DataObjectTreeItem : public ObjectTreeItem {
 public:
     DataObjectTreeItem(UAVDataObject *object, const QList<QVariant> &data) :
-        ObjectTreeItem(object, data)
+        ObjectTreeItem(object, data), m_changeSequence(0)
     {}
     DataObjectTreeItem(UAVDataObject *object, const QVariant &data) :
-        ObjectTreeItem(object, data)
+        ObjectTreeItem(object, data), m_changeSequence(0)
     {}
 
     UAVDataObject *dataObject() const
@@ -279,6 +328,10 @@ public:
 
     virtual void update(const QTime &ts)
     {
+        if (dataObject()->isSingleInstance()) {
+            updateChangedFields(ts);
+            return;
+        }
         foreach(TreeItem * child, children()) {
             MetaObjectTreeItem *metaChild = dynamic_cast<MetaObjectTreeItem *>(child);
 
@@ -292,6 +345,30 @@ public:
     {
         return !object()->isSettingsObject() || object()->isKnown();
     }
+
+protected:
+    // only update the items of the fields changed since the last update,
+    // the children other than the meta data item are the fields in order
+    void updateChangedFields(const QTime &ts)
+    {
+        quint32 sequence = object()->getChangeSequence();
+        quint64 changed  = object()->getChangedFields(m_changeSequence);
+
+        m_changeSequence = sequence;
+        int n = 0;
+        foreach(TreeItem * child, children()) {
+            if (dynamic_cast<MetaObjectTreeItem *>(child)) {
+                continue;
+            }
+            if (changed & ((quint64)1 << qMin(n, 63))) {
+                child->update(ts);
+            }
+            ++n;
+        }
+    }
+
+private:
+    quint32 m_changeSequence;
 };
 
 class InstanceTreeItem : public DataObjectTreeItem {
@@ -305,7 +382,7 @@ public:
 
     virtual void update(const QTime &ts)
     {
-        TreeItem::update(ts);
+        updateChangedFields(ts);
     }
 
     virtual void apply()
@@ -1,4 +1,5 @@
 include(../../plugins/uavobjects/uavobjects.pri)
+include(../../plugins/uavobjectutil/uavobjectutil.pri)
 include(../../plugins/coreplugin/coreplugin.pri)
 include(../../libs/utils/utils.pri)
 include(../../libs/qscispinbox/qscispinbox.pri)
@@ -35,6 +35,7 @@
 #include "browseritemdelegate.h"
 #include "treeitem.h"
 #include "uavobjectmanager.h"
+#include "uavobjectutilmanager.h"
 #include "extensionsystem/pluginmanager.h"
 #include "utils/mustache.h"
 
@@ -52,7 +53,8 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
 
     m_modelProxy = new TreeSortFilterProxyModel(this);
     m_modelProxy->setSourceModel(m_model);
-    m_modelProxy->setDynamicSortFilter(true);
+    // the filter only looks at the item titles, value updates must not trigger a re-filter
+    m_modelProxy->setDynamicSortFilter(false);
 
     m_browser = new Ui_UAVObjectBrowser();
     m_browser->setupUi(this);
@@ -69,11 +71,14 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
 
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)),
             this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
+    connect(m_browser->treeView, SIGNAL(expanded(QModelIndex)), this, SLOT(itemExpanded(QModelIndex)));
+    connect(m_browser->treeView, SIGNAL(collapsed(QModelIndex)), this, SLOT(itemCollapsed(QModelIndex)));
     connect(m_browser->saveSDButton, SIGNAL(clicked()), this, SLOT(saveObject()));
     connect(m_browser->readSDButton, SIGNAL(clicked()), this, SLOT(loadObject()));
     connect(m_browser->sendButton, SIGNAL(clicked()), this, SLOT(sendUpdate()));
     connect(m_browser->requestButton, SIGNAL(clicked()), this, SLOT(requestUpdate()));
     connect(m_browser->eraseSDButton, SIGNAL(clicked()), this, SLOT(eraseObject()));
+    connect(m_browser->stageButton, SIGNAL(toggled(bool)), this, SLOT(stageToggled()));
     connect(m_browser->tbView, SIGNAL(clicked()), this, SLOT(viewSlot()));
     connect(m_browser->splitter, SIGNAL(splitterMoved(int, int)), this, SLOT(splitterMoved()));
 
@@ -122,9 +127,16 @@ void UAVObjectBrowserWidget::sendUpdate()
     // TODO why steal focus ?
     this->setFocus();
 
+    if (m_browser->stageButton->isChecked()) {
+        sendStagedEdits(false);
+        return;
+    }
+
     ObjectTreeItem *objItem = findCurrentObjectTreeItem();
 
     if (objItem != NULL) {
+        // collapsed objects are not kept up to date, don't send old values
+        m_model->refreshObject(objItem);
         objItem->apply();
         UAVObject *obj = objItem->object();
         Q_ASSERT(obj);
@@ -175,6 +187,11 @@ void UAVObjectBrowserWidget::saveObject()
     // TODO why steal focus ?
     this->setFocus();
 
+    if (m_browser->stageButton->isChecked()) {
+        sendStagedEdits(true);
+        return;
+    }
+
     // Send update so that the latest value is saved
     sendUpdate();
 
@@ -215,6 +232,52 @@ void UAVObjectBrowserWidget::eraseObject()
     }
 }
 
+/**
+ * Writes the edited values of all the objects into the objects, without sending them.
+ */
+QList<UAVObject *> UAVObjectBrowserWidget::applyChangedObjects()
+{
+    QList<UAVObject *> objects;
+
+    foreach(ObjectTreeItem * objItem, m_model->changedObjectItems()) {
+        // collapsed objects are not kept up to date, don't send old values
+        m_model->refreshObject(objItem);
+        objItem->apply();
+        objects << objItem->object();
+    }
+    return objects;
+}
+
+/**
+ * Sends the edits of all the objects as one pipelined batch and, if asked, saves
+ * them along with the objects sent before and not saved yet.
+ */
+void UAVObjectBrowserWidget::sendStagedEdits(bool save)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectUtilManager *utilManager  = pm->getObject<UAVObjectUtilManager>();
+
+    Q_ASSERT(utilManager);
+
+    QList<UAVObject *> objects = applyChangedObjects();
+    foreach(UAVObject * obj, objects) {
+        if (!m_stagedObjects.contains(obj)) {
+            m_stagedObjects << obj;
+        }
+    }
+    if (save) {
+        utilManager->saveObjectsToSD(m_stagedObjects);
+        m_stagedObjects.clear();
+    } else if (!objects.isEmpty()) {
+        utilManager->uploadObjects(objects);
+    }
+}
+
+void UAVObjectBrowserWidget::stageToggled()
+{
+    currentChanged(m_browser->treeView->currentIndex(), QModelIndex());
+}
+
 void UAVObjectBrowserWidget::updateObjectPersistence(ObjectPersistence::OperationOptions op, UAVObject *obj)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -294,6 +357,7 @@ void UAVObjectBrowserWidget::updateViewOptions()
     if (!m_browser->searchLine->text().isEmpty()) {
         searchLineChanged(m_browser->searchLine->text());
     }
+    updateExpandedItems();
 
     // persist options
     emit viewOptionsChanged(showCategories, useScientificNotation, showMetadata, showDesc);
@@ -306,7 +370,11 @@ void UAVObjectBrowserWidget::splitterMoved()
 
 QString UAVObjectBrowserWidget::createObjectDescription(UAVObject *object)
 {
-    QString mustache(m_mustacheTemplate);
+    QHash<quint32, QString>::const_iterator cached = m_descriptions.constFind(object->getObjID());
+
+    if (cached != m_descriptions.constEnd()) {
+        return cached.value();
+    }
 
     QVariantHash uavoHash;
 
@@ -381,15 +449,19 @@ QString UAVObjectBrowserWidget::createObjectDescription(UAVObject *object)
     }
     uavoHash["FIELDS"] = fields;
     Mustache::QtVariantContext context(uavoHash);
-    Mustache::Renderer renderer;
-    return renderer.render(mustache, &context);
+    QString description = m_descriptionRenderer.render(m_mustacheTemplate, &context);
+    m_descriptions.insert(object->getObjID(), description);
+    return description;
 }
 
 void UAVObjectBrowserWidget::enableSendRequest(bool enable)
 {
-    m_browser->sendButton->setEnabled(enable);
+    // staged edits are not tied to the current object
+    bool staged = m_browser->stageButton->isChecked();
+
+    m_browser->sendButton->setEnabled(enable || staged);
     m_browser->requestButton->setEnabled(enable);
-    m_browser->saveSDButton->setEnabled(enable);
+    m_browser->saveSDButton->setEnabled(enable || staged);
     m_browser->readSDButton->setEnabled(enable);
     m_browser->eraseSDButton->setEnabled(enable);
 }
@@ -413,13 +485,36 @@ void UAVObjectBrowserWidget::updateDescription()
  */
 void UAVObjectBrowserWidget::searchLineChanged(QString searchText)
 {
-    m_modelProxy->setFilterRegExp(QRegExp(searchText, Qt::CaseInsensitive, QRegExp::FixedString));
+    m_modelProxy->setFilterText(searchText);
     if (!searchText.isEmpty()) {
         int depth = m_viewoptions->cbCategorized->isChecked() ? 2 : 1;
         m_browser->treeView->expandToDepth(depth);
     } else {
         m_browser->treeView->collapseAll();
     }
+    // expandToDepth() and collapseAll() don't emit expanded() and collapsed()
+    updateExpandedItems();
+}
+
+void UAVObjectBrowserWidget::itemExpanded(const QModelIndex &index)
+{
+    m_model->setExpanded(m_modelProxy->mapToSource(index), true);
+}
+
+void UAVObjectBrowserWidget::itemCollapsed(const QModelIndex &index)
+{
+    m_model->setExpanded(m_modelProxy->mapToSource(index), false);
+}
+
+void UAVObjectBrowserWidget::updateExpandedItems(const QModelIndex &parent)
+{
+    for (int row = 0; row < m_modelProxy->rowCount(parent); ++row) {
+        QModelIndex index = m_modelProxy->index(row, 0, parent);
+        if (m_modelProxy->hasChildren(index)) {
+            m_model->setExpanded(m_modelProxy->mapToSource(index), m_browser->treeView->isExpanded(index));
+            updateExpandedItems(index);
+        }
+    }
 }
 
 QString UAVObjectBrowserWidget::indexToPath(const QModelIndex &index) const
@@ -490,11 +585,48 @@ void UAVObjectBrowserWidget::searchTextCleared()
 }
 
 TreeSortFilterProxyModel::TreeSortFilterProxyModel(QObject *p) :
-    QSortFilterProxyModel(p)
+    QSortFilterProxyModel(p), m_filterGeneration(0)
 {
     Q_ASSERT(p);
 }
 
+void TreeSortFilterProxyModel::setFilterText(const QString &text)
+{
+    QString filterText = text.toLower();
+
+    if (filterText == m_filterText) {
+        return;
+    }
+    m_filterText = filterText;
+    m_filterGeneration++;
+
+    // one pass over the whole tree computes the match bits of all items
+    QAbstractItemModel *model = sourceModel();
+    for (int row = 0; row < model->rowCount(); ++row) {
+        TreeItem *item = static_cast<TreeItem *>(model->index(row, 0).internalPointer());
+        updateFilterMatch(item, false);
+    }
+    invalidateFilter();
+}
+
+/**
+ * Computes the match bits of an item and its children.
+ * Returns true if the item or one of its descendants matches.
+ */
+bool TreeSortFilterProxyModel::updateFilterMatch(TreeItem *item, bool ancestorMatch) const
+{
+    bool selfMatch = item->searchName().contains(m_filterText);
+    int match      = (selfMatch ? TreeItem::SelfMatch : 0) | (ancestorMatch ? TreeItem::AncestorMatch : 0);
+
+    foreach(TreeItem * child, item->children()) {
+        if (updateFilterMatch(child, ancestorMatch || selfMatch)) {
+            match |= TreeItem::DescendantMatch;
+        }
+    }
+    item->setFilterMatch(match, m_filterGeneration);
+    return selfMatch || (match & TreeItem::DescendantMatch);
+}
+
 /**
  * @brief TreeSortFilterProxyModel::filterAcceptsRow  Taken from
  * http://qt-project.org/forums/viewthread/7782. This proxy model
@@ -508,55 +640,28 @@ TreeSortFilterProxyModel::TreeSortFilterProxyModel(QObject *p) :
  */
 bool TreeSortFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-    if (filterAcceptsRowItself(source_row, source_parent)) {
-        return true;
-    }
-
-    // accept if any of the parents is accepted on it's own merits
-    QModelIndex parent = source_parent;
-    while (parent.isValid()) {
-        if (filterAcceptsRowItself(parent.row(), parent.parent())) {
-            return true;
-        }
-        parent = parent.parent();
-    }
-
-    // accept if any of the children is accepted on it's own merits
-    if (hasAcceptedChildren(source_row, source_parent)) {
+    if (m_filterText.isEmpty()) {
         return true;
     }
 
-    return false;
-}
-
-bool TreeSortFilterProxyModel::filterAcceptsRowItself(int source_row, const QModelIndex &source_parent) const
-{
-    return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
-}
-
-bool TreeSortFilterProxyModel::hasAcceptedChildren(int source_row, const QModelIndex &source_parent) const
-{
-    QModelIndex item = sourceModel()->index(source_row, 0, source_parent);
-
-    if (!item.isValid()) {
-        return false;
-    }
-
-    // check if there are children
-    int childCount = item.model()->rowCount(item);
-    if (childCount == 0) {
+    QModelIndex index = sourceModel()->index(source_row, 0, source_parent);
+    if (!index.isValid()) {
         return false;
     }
-
-    for (int i = 0; i < childCount; ++i) {
-        if (filterAcceptsRowItself(i, item)) {
-            return true;
-        }
-
-        if (hasAcceptedChildren(i, item)) {
-            return true;
+    TreeItem *item = static_cast<TreeItem *>(index.internalPointer());
+
+    if (item->filterGeneration() != m_filterGeneration) {
+        // item added since the last filter change, its parents bits are up to date (if any)
+        TreeItem *parent   = item->parentItem();
+        bool current       = parent && parent->filterGeneration() == m_filterGeneration;
+        bool ancestorMatch = current && (parent->filterMatch() & (TreeItem::SelfMatch | TreeItem::AncestorMatch));
+        if (updateFilterMatch(item, ancestorMatch)) {
+            for (; parent && parent->filterGeneration() == m_filterGeneration; parent = parent->parentItem()) {
+                parent->setFilterMatch(parent->filterMatch() | TreeItem::DescendantMatch, m_filterGeneration);
+            }
         }
     }
 
-    return false;
+    // accept rows that match, that have a matching parent or a matching child
+    return item->filterMatch() != 0;
 }
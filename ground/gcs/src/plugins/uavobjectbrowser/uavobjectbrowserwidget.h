@@ -33,6 +33,7 @@
 #include "uavobjecttreemodel.h"
 
 #include "objectpersistence.h"
+#include "utils/mustache.h"
 
 #include <QWidget>
 #include <QSortFilterProxyModel>
@@ -41,6 +42,7 @@ class QPushButton;
 class ObjectTreeItem;
 class Ui_UAVObjectBrowser;
 class Ui_viewoptions;
+class TreeItem;
 
 class TreeSortFilterProxyModel : public QSortFilterProxyModel {
 public:
@@ -52,10 +54,18 @@ public:
         return persistentIndexList();
     }
 
+    // case insensitive fixed string filter on the item titles
+    void setFilterText(const QString &text);
+
 protected:
     bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
-    bool filterAcceptsRowItself(int source_row, const QModelIndex &source_parent) const;
-    bool hasAcceptedChildren(int source_row, const QModelIndex &source_parent) const;
+
+private:
+    QString m_filterText;
+    // incremented on each filter change, items with an older generation have stale match bits
+    int m_filterGeneration;
+
+    bool updateFilterMatch(TreeItem *item, bool ancestorMatch) const;
 };
 
 class UAVObjectBrowserWidget : public QWidget {
@@ -108,12 +118,15 @@ private slots:
     void saveObject();
     void loadObject();
     void eraseObject();
+    void stageToggled();
     void currentChanged(const QModelIndex &current, const QModelIndex &previous);
     void viewSlot();
     void updateViewOptions();
     void searchLineChanged(QString searchText);
     void searchTextCleared();
     void splitterMoved();
+    void itemExpanded(const QModelIndex &index);
+    void itemCollapsed(const QModelIndex &index);
     QString createObjectDescription(UAVObject *object);
 
 signals:
@@ -133,12 +146,22 @@ private:
     QColor m_manuallyChangedColor;
     bool m_onlyHighlightChangedValues;
     QString m_mustacheTemplate;
+    // renders m_mustacheTemplate, keeps it parsed
+    Mustache::Renderer m_descriptionRenderer;
+    // the description only depends on the object type, rendered once per object id
+    QHash<quint32, QString> m_descriptions;
 
     UAVObjectTreeModel *createTreeModel();
 
+    // objects sent with staged edits and not saved yet
+    QList<UAVObject *> m_stagedObjects;
+
     void updateObjectPersistence(ObjectPersistence::OperationOptions op, UAVObject *obj);
+    QList<UAVObject *> applyChangedObjects();
+    void sendStagedEdits(bool save);
     void enableSendRequest(bool enable);
     void updateDescription();
+    void updateExpandedItems(const QModelIndex &parent = QModelIndex());
     ObjectTreeItem *findCurrentObjectTreeItem();
     QString loadFileIntoString(QString fileName);
 };
@@ -35,11 +35,21 @@
 #include "extensionsystem/pluginmanager.h"
 
 #include <QColor>
+#include <QTimer>
+
+// period of the batched updates (~25 fps)
+static const int UPDATE_PERIOD_MS = 40;
 
 UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent) : QAbstractItemModel(parent)
 {
     m_highlightManager = new HighlightManager();
     connect(m_highlightManager, &HighlightManager::updateHighlight, this, &UAVObjectTreeModel::refreshHighlight);
+    connect(m_highlightManager, &HighlightManager::highlightsExpired, this, &UAVObjectTreeModel::refreshHighlights);
+
+    m_updateTimer = new QTimer(this);
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(UPDATE_PERIOD_MS);
+    connect(m_updateTimer, &QTimer::timeout, this, &UAVObjectTreeModel::flushUpdates);
 
     TreeItem::setHighlightTime(recentlyUpdatedTimeout());
 
@@ -186,6 +196,7 @@ void UAVObjectTreeModel::setupModelData()
 void UAVObjectTreeModel::resetModelData()
 {
     m_highlightManager->reset();
+    clearPendingUpdates();
 
     emit beginResetModel();
 
@@ -348,9 +359,8 @@ void UAVObjectTreeModel::addSingleField(int i, UAVObjectField *field, TreeItem *
     case UAVObjectField::BITFIELD:
     case UAVObjectField::ENUM:
     {
-        QStringList options = field->getOptions();
         QVariant value = field->getValue(i);
-        data.append(options.indexOf(value.toString()));
+        data.append(field->getOptionIndex(value.toString()));
         data.append(field->getUnits());
         item = new EnumFieldTreeItem(field, i, data);
         break;
@@ -447,11 +457,13 @@ void UAVObjectTreeModel::toggleCategoryItems()
                     TreeItem *tmp = item;
                     item = item->parentItem();
                     removeItem(tmp->parentItem(), tmp);
+                    m_highlightItems.remove(tmp);
                     delete tmp;
                 }
             }
         }
     }
+    refreshStaleItems();
 }
 
 void UAVObjectTreeModel::toggleMetaItems()
@@ -468,6 +480,7 @@ void UAVObjectTreeModel::toggleMetaItems()
             }
         }
     }
+    refreshStaleItems();
 }
 
 QModelIndex UAVObjectTreeModel::index(int row, int column, const QModelIndex &parent) const
@@ -646,17 +659,151 @@ QVariant UAVObjectTreeModel::headerData(int section, Qt::Orientation orientation
     return QVariant();
 }
 
+void UAVObjectTreeModel::setExpanded(const QModelIndex &index, bool expanded)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    TreeItem *item = static_cast<TreeItem *>(index.internalPointer());
+    if (item->isExpanded() == expanded) {
+        return;
+    }
+    item->setExpanded(expanded);
+    if (expanded) {
+        refreshStaleItems();
+    }
+}
+
+void UAVObjectTreeModel::refreshObject(ObjectTreeItem *item)
+{
+    // the stale item can be the object item itself or its parent (for instances)
+    for (TreeItem *i = item; i; i = i->parentItem()) {
+        ObjectTreeItem *objItem = dynamic_cast<ObjectTreeItem *>(i);
+        if (objItem && m_staleItems.remove(objItem)) {
+            objItem->update(QTime::currentTime());
+            break;
+        }
+    }
+}
+
+// true if a field of the object item was edited, nested object items are not looked at
+static bool hasChangedFields(TreeItem *item)
+{
+    foreach(TreeItem * child, item->children()) {
+        if (dynamic_cast<ObjectTreeItem *>(child)) {
+            continue;
+        }
+        if (child->changed() || hasChangedFields(child)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UAVObjectTreeModel::collectChangedObjectItems(TreeItem *item, QList<ObjectTreeItem *> &items) const
+{
+    foreach(TreeItem * child, item->children()) {
+        ObjectTreeItem *objItem = dynamic_cast<ObjectTreeItem *>(child);
+        if (objItem && objItem->object() && hasChangedFields(objItem)) {
+            items << objItem;
+        }
+        collectChangedObjectItems(child, items);
+    }
+}
+
+QList<ObjectTreeItem *> UAVObjectTreeModel::changedObjectItems() const
+{
+    QList<ObjectTreeItem *> items;
+
+    collectChangedObjectItems(m_rootItem, items);
+    return items;
+}
+
 void UAVObjectTreeModel::updateObject(UAVObject *obj)
 {
     Q_ASSERT(obj);
     ObjectTreeItem *item = findObjectTreeItem(obj->getObjID());
     Q_ASSERT(item);
-    // TODO don't update meta object if they are not shown
+
+    // object updates can come at telemetry rate, they are applied on the next flush
+    m_dirtyItems.insert(item);
+    scheduleUpdate();
+}
+
+void UAVObjectTreeModel::flushUpdates()
+{
     QTime ts = QTime::currentTime();
-    item->update(ts);
-    if (!onlyHighlightChangedValues()) {
-        item->setHighlighted(true, ts);
+    bool highlight = !onlyHighlightChangedValues();
+
+    foreach(ObjectTreeItem * item, m_dirtyItems) {
+        // don't update the fields of collapsed or hidden objects (includes hidden meta objects)
+        if (childrenShown(item)) {
+            m_staleItems.remove(item);
+            item->update(ts);
+        } else {
+            m_staleItems.insert(item);
+        }
+        if (highlight) {
+            item->setHighlighted(true);
+        }
     }
+    m_dirtyItems.clear();
+
+    // highlight refreshes requested while updating are also emitted here
+    emitHighlightChanged(m_highlightItems.toList());
+    m_highlightItems.clear();
+
+    m_updateTimer->stop();
+}
+
+void UAVObjectTreeModel::scheduleUpdate()
+{
+    if (!m_updateTimer->isActive()) {
+        m_updateTimer->start();
+    }
+}
+
+void UAVObjectTreeModel::refreshStaleItems()
+{
+    // called when rows are shown, the view will query them right away
+    QTime ts = QTime::currentTime();
+
+    QMutableSetIterator<ObjectTreeItem *> iter(m_staleItems);
+    while (iter.hasNext()) {
+        ObjectTreeItem *item = iter.next();
+        if (childrenShown(item)) {
+            iter.remove();
+            item->update(ts);
+        }
+    }
+}
+
+void UAVObjectTreeModel::clearPendingUpdates()
+{
+    m_updateTimer->stop();
+    m_dirtyItems.clear();
+    m_staleItems.clear();
+    m_highlightItems.clear();
+}
+
+// tells if the row of an item is shown, i.e. all its parents are expanded
+bool UAVObjectTreeModel::isShown(TreeItem *item) const
+{
+    TreeItem *parentItem = item->parentItem();
+
+    while (parentItem && parentItem != m_rootItem) {
+        if (!parentItem->isExpanded()) {
+            return false;
+        }
+        parentItem = parentItem->parentItem();
+    }
+    // items removed from the tree (meta data) are not shown
+    return parentItem == m_rootItem;
+}
+
+bool UAVObjectTreeModel::childrenShown(TreeItem *item) const
+{
+    return item->isExpanded() && isShown(item);
 }
 
 void UAVObjectTreeModel::updateIsKnown(UAVObject *object)
@@ -670,19 +817,52 @@ void UAVObjectTreeModel::updateIsKnown(UAVObject *object)
 
 void UAVObjectTreeModel::refreshHighlight(TreeItem *item)
 {
-    // performance note: here we emit data changes column by column
-    // emitting a dataChanged that spans multiple columns kills performance (CPU shoots up)
-    // this is probably caused by the sort/filter proxy...
+    // batched with the object updates
+    m_highlightItems.insert(item);
+    scheduleUpdate();
+}
 
-    QModelIndex itemIndex;
+void UAVObjectTreeModel::refreshHighlights(const QList<TreeItem *> &items)
+{
+    emitHighlightChanged(items);
+}
 
-    itemIndex = index(item, TreeItem::TITLE_COLUMN);
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex);
+void UAVObjectTreeModel::emitHighlightChanged(const QList<TreeItem *> &items)
+{
+    // group the shown items by parent so sibling rows are covered by a single range
+    QHash<TreeItem *, QList<int> > rows;
+    foreach(TreeItem * item, items) {
+        if (isShown(item)) {
+            rows[item->parentItem()].append(item->row());
+        }
+    }
 
-    itemIndex = index(item, TreeItem::DATA_COLUMN);
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex);
+    QHashIterator<TreeItem *, QList<int> > iter(rows);
+    while (iter.hasNext()) {
+        iter.next();
+        TreeItem *parentItem = iter.key();
+        QList<int> parentRows = iter.value();
+        qSort(parentRows);
+
+        int first = 0;
+        while (first < parentRows.size()) {
+            // find the end of the contiguous run of rows
+            int last = first;
+            while ((last + 1 < parentRows.size()) && (parentRows[last + 1] <= parentRows[last] + 1)) {
+                last++;
+            }
+            TreeItem *firstItem = parentItem->child(parentRows[first]);
+            TreeItem *lastItem  = parentItem->child(parentRows[last]);
+
+            // performance note: here we emit data changes column by column
+            // emitting a dataChanged that spans multiple columns kills performance (CPU shoots up)
+            // this is probably caused by the sort/filter proxy...
+            emit dataChanged(index(firstItem, TreeItem::TITLE_COLUMN), index(lastItem, TreeItem::TITLE_COLUMN));
+            emit dataChanged(index(firstItem, TreeItem::DATA_COLUMN), index(lastItem, TreeItem::DATA_COLUMN));
+
+            first = last + 1;
+        }
+    }
 }
 
 void UAVObjectTreeModel::refreshIsKnown(TreeItem *item)
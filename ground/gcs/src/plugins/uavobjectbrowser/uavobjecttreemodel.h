@@ -33,6 +33,7 @@
 #include <QAbstractItemModel>
 #include <QMap>
 #include <QList>
+#include <QSet>
 #include <QColor>
 #include <QSettings>
 
@@ -91,12 +92,23 @@ public:
     bool highlightTopTreeItems() const;
     void setHighlightTopTreeItems(bool highlight);
 
+    // keeps track of the rows expanded in the view, only shown items are updated
+    void setExpanded(const QModelIndex &index, bool expanded);
+
+    // brings the values of an object item up to date
+    void refreshObject(ObjectTreeItem *item);
+
+    // object items with edited values not sent yet
+    QList<ObjectTreeItem *> changedObjectItems() const;
+
 private slots:
     void newObject(UAVObject *obj);
     void updateObject(UAVObject *obj);
     void updateIsKnown(UAVObject *obj);
     void refreshHighlight(TreeItem *item);
+    void refreshHighlights(const QList<TreeItem *> &items);
     void refreshIsKnown(TreeItem *item);
+    void flushUpdates();
 
 private:
     QSettings m_settings;
@@ -109,7 +121,17 @@ private:
 
     QHash<quint32, ObjectTreeItem *> m_objectTreeItems;
 
+    // updates are batched and flushed once per frame
+    QTimer *m_updateTimer;
+    // updated objects waiting for the next flush
+    QSet<ObjectTreeItem *> m_dirtyItems;
+    // updated objects not shown in the view, brought up to date when shown
+    QSet<ObjectTreeItem *> m_staleItems;
+    // items with a pending highlight refresh
+    QSet<TreeItem *> m_highlightItems;
+
     QModelIndex index(TreeItem *item, int column = 0) const;
+    void collectChangedObjectItems(TreeItem *item, QList<ObjectTreeItem *> &items) const;
 
     void setupModelData();
     void resetModelData();
@@ -131,6 +153,13 @@ private:
     void toggleCategoryItems();
     void toggleMetaItems();
 
+    bool isShown(TreeItem *item) const;
+    bool childrenShown(TreeItem *item) const;
+    void scheduleUpdate();
+    void emitHighlightChanged(const QList<TreeItem *> &items);
+    void refreshStaleItems();
+    void clearPendingUpdates();
+
     void addObjectTreeItem(quint32 objectId, ObjectTreeItem *oti);
     ObjectTreeItem *findObjectTreeItem(quint32 objectId);
 
@@ -0,0 +1,260 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_uavobjectsbenchmark.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Benchmarks of the UAVObject and UAVTalk hot paths
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavdataobject.h"
+#include "uavobjectfield.h"
+#include "uavtalk/uavtalk.h"
+
+#include <QBuffer>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QtTest/QtTest>
+
+class tst_UAVObjectsBenchmark : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void packUnpack_data();
+    void packUnpack();
+    void fieldGetValue();
+    void fieldGetDouble();
+    void fieldSetValue();
+    void getObjectById();
+    void getObjectByName();
+    void json_data();
+    void json();
+    void jsonAllDocument();
+    void jsonAllStream();
+    void uavTalkEncode_data();
+    void uavTalkEncode();
+    void uavTalkDecode_data();
+    void uavTalkDecode();
+
+private:
+    UAVObjectManager *objMngr;
+
+    void addObjectRows();
+    UAVDataObject *rowObject();
+};
+
+void tst_UAVObjectsBenchmark::initTestCase()
+{
+    objMngr = new UAVObjectManager();
+    UAVObjectsInitialize(objMngr);
+}
+
+void tst_UAVObjectsBenchmark::cleanupTestCase()
+{
+    delete objMngr;
+    objMngr = 0;
+}
+
+/**
+ * A small object updated at high rate and a large settings object
+ */
+void tst_UAVObjectsBenchmark::addObjectRows()
+{
+    QTest::addColumn<QString>("object");
+    QTest::newRow("AttitudeState") << QString("AttitudeState");
+    QTest::newRow("StabilizationSettings") << QString("StabilizationSettings");
+}
+
+UAVDataObject *tst_UAVObjectsBenchmark::rowObject()
+{
+    QFETCH(QString, object);
+    UAVDataObject *obj = qobject_cast<UAVDataObject *>(objMngr->getObject(object));
+
+    Q_ASSERT(obj);
+    return obj;
+}
+
+void tst_UAVObjectsBenchmark::packUnpack_data()
+{
+    addObjectRows();
+}
+
+void tst_UAVObjectsBenchmark::packUnpack()
+{
+    UAVDataObject *obj = rowObject();
+    QByteArray data(obj->getNumBytes(), 0);
+
+    QBENCHMARK {
+        obj->pack((quint8 *)data.data());
+        obj->unpack((const quint8 *)data.constData());
+    }
+}
+
+void tst_UAVObjectsBenchmark::fieldGetValue()
+{
+    UAVObjectField *field = objMngr->getObject("AttitudeState")->getField("Roll");
+
+    QVERIFY(field);
+    QBENCHMARK {
+        field->getValue();
+    }
+}
+
+void tst_UAVObjectsBenchmark::fieldGetDouble()
+{
+    UAVObjectField *field = objMngr->getObject("AttitudeState")->getField("Roll");
+
+    QVERIFY(field);
+    QBENCHMARK {
+        field->getDouble();
+    }
+}
+
+void tst_UAVObjectsBenchmark::fieldSetValue()
+{
+    UAVObjectField *field = objMngr->getObject("AttitudeState")->getField("Roll");
+    QVariant value(12.5);
+
+    QVERIFY(field);
+    QBENCHMARK {
+        field->setValue(value);
+    }
+}
+
+void tst_UAVObjectsBenchmark::getObjectById()
+{
+    quint32 objId = objMngr->getObject("AttitudeState")->getObjID();
+
+    QBENCHMARK {
+        objMngr->getObject(objId);
+    }
+}
+
+void tst_UAVObjectsBenchmark::getObjectByName()
+{
+    QString name("AttitudeState");
+
+    QBENCHMARK {
+        objMngr->getObject(name);
+    }
+}
+
+void tst_UAVObjectsBenchmark::json_data()
+{
+    addObjectRows();
+}
+
+void tst_UAVObjectsBenchmark::json()
+{
+    UAVDataObject *obj = rowObject();
+
+    QBENCHMARK {
+        QJsonObject json;
+        obj->toJson(json);
+        obj->fromJson(json);
+    }
+}
+
+void tst_UAVObjectsBenchmark::jsonAllDocument()
+{
+    QBENCHMARK {
+        QJsonObject json;
+        objMngr->toJson(json);
+        QByteArray text = QJsonDocument(json).toJson(QJsonDocument::Compact);
+        objMngr->fromJson(QJsonDocument::fromJson(text).object());
+    }
+}
+
+void tst_UAVObjectsBenchmark::jsonAllStream()
+{
+    QBuffer buffer;
+
+    QBENCHMARK {
+        buffer.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        QVERIFY(objMngr->toJson(&buffer));
+        buffer.close();
+        buffer.open(QIODevice::ReadOnly);
+        QVERIFY(objMngr->fromJson(&buffer));
+        buffer.close();
+    }
+}
+
+void tst_UAVObjectsBenchmark::uavTalkEncode_data()
+{
+    addObjectRows();
+}
+
+void tst_UAVObjectsBenchmark::uavTalkEncode()
+{
+    UAVDataObject *obj = rowObject();
+    QBuffer buffer;
+
+    buffer.open(QIODevice::WriteOnly);
+    UAVTalk uavTalk(&buffer, objMngr);
+
+    QBENCHMARK {
+        buffer.seek(0);
+        uavTalk.sendObject(obj, false, false);
+        uavTalk.flush();
+    }
+}
+
+void tst_UAVObjectsBenchmark::uavTalkDecode_data()
+{
+    addObjectRows();
+}
+
+/**
+ * Decode a stream of 100 packets of the object
+ */
+void tst_UAVObjectsBenchmark::uavTalkDecode()
+{
+    UAVDataObject *obj = rowObject();
+    QBuffer encoded;
+
+    encoded.open(QIODevice::WriteOnly);
+    {
+        UAVTalk uavTalk(&encoded, objMngr);
+        for (int i = 0; i < 100; i++) {
+            uavTalk.sendObject(obj, false, false);
+            uavTalk.flush();
+        }
+    }
+    encoded.close();
+
+    QBuffer buffer(&encoded.buffer());
+    buffer.open(QIODevice::ReadOnly);
+    UAVTalk uavTalk(&buffer, objMngr);
+
+    QBENCHMARK {
+        buffer.seek(0);
+        QMetaObject::invokeMethod(&uavTalk, "processInputStream", Qt::DirectConnection);
+    }
+    QVERIFY(uavTalk.getStats().rxObjects > 0);
+}
+
+QTEST_GUILESS_MAIN(tst_UAVObjectsBenchmark)
+
+#include "tst_uavobjectsbenchmark.moc"
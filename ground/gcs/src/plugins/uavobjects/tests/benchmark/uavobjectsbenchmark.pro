@@ -0,0 +1,22 @@
+# Benchmarks of the UAVObject and UAVTalk hot paths, built against the GCS plugins.
+# Build after the GCS, then run for example
+#   ./uavobjectsbenchmark
+#   ./uavobjectsbenchmark -tickcounter packUnpack
+TEMPLATE = app
+TARGET = uavobjectsbenchmark
+
+QT += testlib
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../../../../gcs.pri)
+
+INCLUDEPATH += $$GCS_SOURCE_TREE/src/plugins
+LIBS += -L$$GCS_PLUGIN_PATH/$$ORG_BIG_NAME
+include(../../../uavtalk/uavtalk.pri)
+
+linux-* {
+    QMAKE_RPATHDIR += $$GCS_PLUGIN_PATH/$$ORG_BIG_NAME $$GCS_LIBRARY_PATH
+}
+
+SOURCES += tst_uavobjectsbenchmark.cpp
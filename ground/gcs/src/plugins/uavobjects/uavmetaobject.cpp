@@ -89,13 +89,16 @@ UAVObject::Metadata UAVMetaObject::getDefaultMetadata()
 /**
  * Set the metadata held by the metaobject
  */
-void UAVMetaObject::setData(const Metadata & mdata)
+void UAVMetaObject::setData(const Metadata & mdata, bool emitUpdateEvents)
 {
     QMutexLocker locker(mutex);
 
     parentMetadata = mdata;
-    emit objectUpdatedAuto(this); // trigger object updated event
-    emit objectUpdated(this);
+    publishSnapshot();
+    if (emitUpdateEvents) {
+        emit objectUpdatedAuto(this); // trigger object updated event
+        emit objectUpdated(this);
+    }
 }
 
 /**
@@ -40,7 +40,8 @@ public:
     void setMetadata(const Metadata & mdata);
     Metadata getMetadata();
     Metadata getDefaultMetadata();
-    void setData(const Metadata & mdata);
+    // without update events the metadata are only sent when updated() is called
+    void setData(const Metadata & mdata, bool emitUpdateEvents = true);
     Metadata getData();
 
     bool isMetaDataObject();
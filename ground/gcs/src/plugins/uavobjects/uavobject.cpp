@@ -67,6 +67,11 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
     this->numBytes     = 0;
     this->mutex        = new QMutex(QMutex::Recursive);
     m_isKnown = false;
+    m_wireLayout = false;
+    m_changeSequence = 0;
+    m_journalHead    = 0;
+    m_journalSize    = 0;
+    m_journalReplay  = false;
 }
 
 /**
@@ -97,18 +102,17 @@ void UAVObject::initializeFields(QList<UAVObjectField *> & fields, quint8 *data,
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->initialize(data, offset, this);
         offset += fields[n]->getNumBytes();
-        connect(fields[n], SIGNAL(fieldUpdated(UAVObjectField *)), this, SLOT(fieldUpdated(UAVObjectField *)));
     }
-}
-
-/**
- * Called from the fields each time they are updated
- */
-void UAVObject::fieldUpdated(UAVObjectField *field)
-{
-    Q_UNUSED(field);
-// emit objectUpdatedAuto(this); // trigger object updated event
-// emit objectUpdated(this);
+    // The generated data structures are packed and hold the fields in wire order,
+    // on little endian hosts they can be copied to and from the wire in one go
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    m_wireLayout = (offset == numBytes);
+#else
+    m_wireLayout = false;
+#endif
+    m_snapshot.fill(0, numBytes);
+    m_fieldChanges.fill(0, fields.length());
+    setJournalDepth(m_journal.size());
 }
 
 /**
@@ -207,6 +211,7 @@ void UAVObject::requestUpdateAll()
  */
 void UAVObject::updated()
 {
+    publishSnapshot();
     emit objectUpdatedManual(this);
     emit objectUpdated(this);
 }
@@ -303,8 +308,13 @@ UAVObjectField *UAVObject::getField(const QString & name)
 qint32 UAVObject::pack(quint8 *dataOut)
 {
     QMutexLocker locker(mutex);
-    qint32 offset = 0;
 
+    if (m_wireLayout) {
+        memcpy(dataOut, data, numBytes);
+        return numBytes;
+    }
+
+    qint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->pack(&dataOut[offset]);
         offset += fields[n]->getNumBytes();
@@ -312,6 +322,18 @@ qint32 UAVObject::pack(quint8 *dataOut)
     return numBytes;
 }
 
+/**
+ * Pack the object data into a new QByteArray, handy to compare the object data
+ * before and after a change
+ */
+QByteArray UAVObject::packedData()
+{
+    QByteArray packed(getNumBytes(), 0);
+
+    pack((quint8 *)packed.data());
+    return packed;
+}
+
 /**
  * Unpack the object data from a byte array
  * @returns The number of bytes copied
@@ -319,18 +341,217 @@ qint32 UAVObject::pack(quint8 *dataOut)
 qint32 UAVObject::unpack(const quint8 *dataIn)
 {
     QMutexLocker locker(mutex);
-    qint32 offset = 0;
 
-    for (int n = 0; n < fields.length(); ++n) {
-        fields[n]->unpack(&dataIn[offset]);
-        offset += fields[n]->getNumBytes();
+    if (m_wireLayout) {
+        memcpy(data, dataIn, numBytes);
+    } else {
+        qint32 offset = 0;
+        for (int n = 0; n < fields.length(); ++n) {
+            fields[n]->unpack(&dataIn[offset]);
+            offset += fields[n]->getNumBytes();
+        }
     }
+    publishSnapshot();
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
 
     return numBytes;
 }
 
+/**
+ * Publish the current object data to the snapshot buffer read by readSnapshot()
+ * Must be called after the data was changed and before emitting the update event.
+ */
+void UAVObject::publishSnapshot()
+{
+    QMutexLocker locker(mutex);
+
+    // the snapshot holds the data of the previous update event, compare the fields to it
+    bool changed = false;
+    bool first   = (m_snapshotSequence.load() == 0);
+    quint64 changedFields = 0;
+    for (int n = 0; n < fields.length(); ++n) {
+        quint32 offset = fields[n]->getDataOffset();
+        if (first || memcmp(&data[offset], &m_snapshot.constData()[offset], fields[n]->getNumBytes()) != 0) {
+            if (!changed) {
+                changed = true;
+                ++m_changeSequence;
+            }
+            m_fieldChanges[n] = m_changeSequence;
+            changedFields    |= (quint64)1 << qMin(n, 63);
+        }
+    }
+
+    // journal the replaced data, the buffers are reused
+    if (changed && !first && !m_journalReplay && !m_journal.isEmpty()) {
+        m_journalHead = (m_journalHead + 1) % m_journal.size();
+        m_journalSize = qMin(m_journalSize + 1, m_journal.size());
+        JournalEntry &entry = m_journal[m_journalHead];
+        entry.changeSequence = m_changeSequence;
+        entry.changedFields  = changedFields;
+        memcpy(entry.data.data(), m_snapshot.constData(), numBytes);
+    }
+
+    // odd sequence numbers flag an update in progress
+    m_snapshotSequence.fetchAndAddOrdered(1);
+    memcpy(m_snapshot.data(), data, numBytes);
+    m_snapshotSequence.fetchAndAddOrdered(1);
+}
+
+/**
+ * Copy the object data as of the last update event without locking the object.
+ * This allows readers in other threads to get a consistent copy of the data without
+ * blocking the telemetry receiver.
+ * @param dataOut Buffer of at least getNumBytes() bytes
+ * @returns True on success, false if the object has no data
+ */
+bool UAVObject::readSnapshot(quint8 *dataOut)
+{
+    if (numBytes == 0) {
+        return false;
+    }
+    // retry a few times if the snapshot is being updated, then fall back to locking
+    for (int retry = 0; retry < 8; ++retry) {
+        int sequence = m_snapshotSequence.loadAcquire();
+        if (sequence == 0) {
+            // never published
+            break;
+        }
+        if (sequence & 1) {
+            continue;
+        }
+        memcpy(dataOut, m_snapshot.constData(), numBytes);
+        if (m_snapshotSequence.loadAcquire() == sequence) {
+            return true;
+        }
+    }
+
+    QMutexLocker locker(mutex);
+    if (m_snapshotSequence.load() == 0) {
+        memcpy(dataOut, data, numBytes);
+    } else {
+        memcpy(dataOut, m_snapshot.constData(), numBytes);
+    }
+    return true;
+}
+
+/**
+ * Get the change sequence, to be given back to getChangedFields()
+ */
+quint32 UAVObject::getChangeSequence()
+{
+    QMutexLocker locker(mutex);
+
+    return m_changeSequence;
+}
+
+/**
+ * Get the fields changed by the update events that came after a change sequence
+ * @param sinceSequence Value of getChangeSequence() when the fields were last read
+ * @returns Mask of the changed fields, bit n for field n, the fields from 63 on share bit 63
+ */
+quint64 UAVObject::getChangedFields(quint32 sinceSequence)
+{
+    QMutexLocker locker(mutex);
+
+    quint64 mask = 0;
+
+    for (int n = 0; n < m_fieldChanges.size(); ++n) {
+        // wrap safe
+        if ((qint32)(m_fieldChanges[n] - sinceSequence) > 0) {
+            mask |= (quint64)1 << qMin(n, 63);
+        }
+    }
+    return mask;
+}
+
+/**
+ * Set the number of changes kept in the journal, 0 disables it.
+ * Each change of the data by an update event journals the data it replaced,
+ * which gives cheap diffs (readJournal()) and undo (undoChange()).
+ * Changing the depth clears the journal.
+ */
+void UAVObject::setJournalDepth(int depth)
+{
+    QMutexLocker locker(mutex);
+
+    m_journal.resize(qMax(depth, 0));
+    for (int i = 0; i < m_journal.size(); ++i) {
+        m_journal[i].data.fill(0, numBytes);
+    }
+    m_journalHead = 0;
+    m_journalSize = 0;
+}
+
+int UAVObject::getJournalDepth()
+{
+    QMutexLocker locker(mutex);
+
+    return m_journal.size();
+}
+
+/**
+ * Get the number of changes held by the journal
+ */
+int UAVObject::getJournalSize()
+{
+    QMutexLocker locker(mutex);
+
+    return m_journalSize;
+}
+
+/**
+ * Read the data as it was before one of the journaled changes
+ * @param age 0 for the last change, 1 for the one before...
+ * @param dataOut Buffer of at least getNumBytes() bytes, in the layout of the object data
+ * @param changedFields Mask of the fields changed by that change, see getChangedFields()
+ * @param changeSequence Change sequence of that change, see getChangeSequence()
+ * @returns False if the journal doesn't go back that far
+ */
+bool UAVObject::readJournal(int age, quint8 *dataOut, quint64 *changedFields, quint32 *changeSequence)
+{
+    QMutexLocker locker(mutex);
+
+    if (age < 0 || age >= m_journalSize) {
+        return false;
+    }
+    const JournalEntry &entry = m_journal.at((m_journalHead - age + m_journal.size()) % m_journal.size());
+    memcpy(dataOut, entry.data.constData(), numBytes);
+    if (changedFields) {
+        *changedFields = entry.changedFields;
+    }
+    if (changeSequence) {
+        *changeSequence = entry.changeSequence;
+    }
+    return true;
+}
+
+/**
+ * Revert the last journaled change and remove it from the journal.
+ * The revert is itself a change (getChangedFields() reports it) but is not journaled.
+ * @returns False if the journal is empty or the GCS access mode is read only
+ */
+bool UAVObject::undoChange(bool emitUpdateEvents)
+{
+    QMutexLocker locker(mutex);
+
+    if (m_journalSize == 0 || GetGcsAccess(getMetadata()) != ACCESS_READWRITE) {
+        return false;
+    }
+    memcpy(data, m_journal.at(m_journalHead).data.constData(), numBytes);
+    m_journalHead = (m_journalHead - 1 + m_journal.size()) % m_journal.size();
+    --m_journalSize;
+
+    m_journalReplay = true;
+    publishSnapshot();
+    m_journalReplay = false;
+    if (emitUpdateEvents) {
+        emit objectUpdatedAuto(this); // trigger object updated event
+        emit objectUpdated(this);
+    }
+    return true;
+}
+
 /**
  * Update a CRC with the object data
  * @returns The updated CRC
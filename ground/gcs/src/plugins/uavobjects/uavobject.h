@@ -33,8 +33,11 @@
 #include <QObject>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QAtomicInt>
+#include <QByteArray>
 #include <QString>
 #include <QList>
+#include <QVector>
 #include <QFile>
 #include <stdint.h>
 
@@ -113,7 +116,19 @@ public:
     QString getDescription();
     quint32 getNumBytes();
     qint32 pack(quint8 *dataOut);
+    QByteArray packedData();
     qint32 unpack(const quint8 *dataIn);
+    bool readSnapshot(quint8 *dataOut);
+    // Incremented by each update event that changed the data
+    quint32 getChangeSequence();
+    // Fields changed since a change sequence, bit n for field n, the fields from 63 on share bit 63
+    quint64 getChangedFields(quint32 sinceSequence);
+    // Optional journal of the data replaced by the last changes, disabled (0) by default
+    void setJournalDepth(int depth);
+    int getJournalDepth();
+    int getJournalSize();
+    bool readJournal(int age, quint8 *dataOut, quint64 *changedFields = 0, quint32 *changeSequence = 0);
+    bool undoChange(bool emitUpdateEvents = true);
     quint8 updateCRC(quint8 crc = 0);
     bool save();
     bool save(QFile & file);
@@ -198,12 +213,28 @@ protected:
     void initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes);
     void setDescription(const QString & description);
     void setCategory(const QString & category);
+    void publishSnapshot();
 
 private:
     bool m_isKnown;
-
-private slots:
-    void fieldUpdated(UAVObjectField *field);
+    // true if the object data is laid out exactly as on the wire
+    bool m_wireLayout;
+    // copy of the data as of the last update event, guarded by a sequence counter (seqlock)
+    QByteArray m_snapshot;
+    QAtomicInt m_snapshotSequence;
+    // change sequence of the last change of each field, see getChangedFields()
+    quint32 m_changeSequence;
+    QVector<quint32> m_fieldChanges;
+    // ring buffer of the data replaced by the last changes, see setJournalDepth()
+    struct JournalEntry {
+        quint32 changeSequence;
+        quint64 changedFields;
+        QByteArray data;
+    };
+    QVector<JournalEntry> m_journal;
+    int m_journalHead;
+    int m_journalSize;
+    bool m_journalReplay;
 };
 
 #endif // UAVOBJECT_H
@@ -29,11 +29,17 @@
 
 #include <QtEndian>
 #include <QDebug>
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
 #include <QJsonObject>
 #include <QJsonArray>
 
+#include <type_traits>
+
 UAVObjectField::UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString &limits)
 {
     QStringList elementNames;
@@ -44,11 +50,74 @@ UAVObjectField::UAVObjectField(const QString & name, const QString & description
     }
     // Initialize
     constructorInitialize(name, description, units, type, elementNames, options, limits);
+    indexesInitialize();
 }
 
 UAVObjectField::UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
 {
     constructorInitialize(name, description, units, type, elementNames, options, limits);
+    indexesInitialize();
+}
+
+namespace {
+// Metadata converted once per field definition, instances share it through implicit sharing
+struct SharedFieldMetadata {
+    QString     name;
+    QString     description;
+    QString     units;
+    QStringList elementNames;
+    QStringList options;
+    QHash<QString, int> elementIndexes;
+    QHash<QString, int> optionIndexes;
+    QMap<quint32, QList<UAVObjectField::LimitStruct> > elementLimits;
+    QVector<QVector<UAVObjectField::CompiledLimit> > compiledLimits;
+};
+}
+
+UAVObjectField::UAVObjectField(const Definition & definition)
+{
+    static QMutex mutex;
+    static QHash<const Definition *, SharedFieldMetadata> sharedMetadata;
+
+    QMutexLocker locker(&mutex);
+
+    QHash<const Definition *, SharedFieldMetadata>::const_iterator it = sharedMetadata.constFind(&definition);
+    if (it != sharedMetadata.constEnd()) {
+        // no string conversion nor limits parsing, only reference counts are incremented
+        constructorInitialize(it->name, it->description, it->units, definition.type, it->elementNames, it->options, QString());
+        this->options  = it->options;
+        elementIndexes = it->elementIndexes;
+        optionIndexes  = it->optionIndexes;
+        elementLimits  = it->elementLimits;
+        compiledLimits = it->compiledLimits;
+        return;
+    }
+
+    QStringList elementNames;
+    for (quint32 n = 0; n < definition.numElements; ++n) {
+        elementNames.append(definition.elementNames ? QString::fromUtf8(definition.elementNames[n]) : QString::number(n));
+    }
+    QStringList options;
+    for (quint32 n = 0; n < definition.numOptions; ++n) {
+        options.append(QString::fromUtf8(definition.options[n]));
+    }
+    constructorInitialize(QString::fromUtf8(definition.name),
+                          QCoreApplication::translate(definition.context, definition.description),
+                          QString::fromUtf8(definition.units), definition.type, elementNames, options,
+                          QString::fromUtf8(definition.limits));
+    indexesInitialize();
+
+    SharedFieldMetadata metadata;
+    metadata.name           = name;
+    metadata.description    = description;
+    metadata.units          = units;
+    metadata.elementNames   = this->elementNames;
+    metadata.options        = this->options;
+    metadata.elementIndexes = elementIndexes;
+    metadata.optionIndexes  = optionIndexes;
+    metadata.elementLimits  = elementLimits;
+    metadata.compiledLimits = compiledLimits;
+    sharedMetadata.insert(&definition, metadata);
 }
 
 void UAVObjectField::constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
@@ -103,6 +172,21 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     limitsInitialize(limits);
 }
 
+void UAVObjectField::indexesInitialize()
+{
+    elementIndexes.clear();
+    optionIndexes.clear();
+    elementIndexes.reserve(elementNames.size());
+    optionIndexes.reserve(options.size());
+    // the first one wins on duplicates, as with indexOf()
+    for (int n = elementNames.size() - 1; n >= 0; --n) {
+        elementIndexes.insert(elementNames.at(n), n);
+    }
+    for (int n = options.size() - 1; n >= 0; --n) {
+        optionIndexes.insert(options.at(n), n);
+    }
+}
+
 void UAVObjectField::limitsInitialize(const QString &limits)
 {
     // Limit string format:
@@ -160,6 +244,7 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                 } else if (valuesPerElement.at(0).right(2) == "SM") {
                     lstruc.type = SMALLER;
                 } else {
+                    lstruc.type = UNDEFINED;
                     qDebug() << "limits parsing failed (invalid property) on UAVObjectField" << name;
                 }
                 valuesPerElement.removeAt(0);
@@ -213,256 +298,156 @@ void UAVObjectField::limitsInitialize(const QString &limits)
     // }
     // }
     // }
+    limitsCompile();
 }
-bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
+
+/**
+ * Converts the parsed limits once, so that isWithinLimits() only compares numbers
+ */
+void UAVObjectField::limitsCompile()
 {
-    if (!elementLimits.keys().contains(index)) {
-        return true;
+    compiledLimits.clear();
+    if (type == STRING) {
+        return;
     }
-
-    foreach(LimitStruct struc, elementLimits.value(index)) {
-        if ((struc.board != board) && board != 0 && struc.board != 0) {
-            continue;
+    QMap<quint32, QList<LimitStruct> >::const_iterator it;
+    for (it = elementLimits.constBegin(); it != elementLimits.constEnd(); ++it) {
+        if (compiledLimits.size() <= (int)it.key()) {
+            compiledLimits.resize(it.key() + 1);
         }
-        switch (struc.type) {
-        case EQUAL:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toInt() == vars.toInt()) {
-                        return true;
+        QVector<CompiledLimit> &rules = compiledLimits[it.key()];
+        foreach(const LimitStruct &struc, it.value()) {
+            CompiledLimit rule;
+            rule.type  = struc.type;
+            rule.board = struc.board;
+            foreach(const QVariant &var, struc.values) {
+                switch (type) {
+                case UINT8:
+                case UINT16:
+                case UINT32:
+                case BITFIELD:
+                    rule.values.append(var.toUInt());
+                    break;
+                case FLOAT32:
+                    rule.values.append(var.toFloat());
+                    break;
+                case ENUM:
+                {
+                    int option = options.indexOf(var.toString());
+                    // an unknown option can not be equal to a value
+                    if (option >= 0 || (rule.type != EQUAL && rule.type != NOT_EQUAL)) {
+                        rule.values.append(option);
                     }
+                    break;
                 }
-                return false;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toUInt() == vars.toUInt()) {
-                        return true;
-                    }
+                default:
+                    rule.values.append(var.toInt());
                 }
-                return false;
-
-                break;
-            case ENUM:
-            case STRING:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toString() == vars.toString()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            case FLOAT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toFloat() == vars.toFloat()) {
-                        return true;
-                    }
-                }
-                return false;
-
-                break;
-            default:
-                return true;
             }
-            break;
-        case NOT_EQUAL:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toInt() == vars.toInt()) {
-                        return false;
-                    }
+            switch (rule.type) {
+            case BETWEEN:
+                if (rule.values.size() < 2) {
+                    qDebug() << __FUNCTION__ << "between limit with less than 1 pair, ignored; field:" << name;
+                    rule.type = UNDEFINED;
+                } else if (rule.values.size() > 2) {
+                    qDebug() << __FUNCTION__ << "between limit with more than 1 pair, using first; field" << name;
                 }
-                return true;
-
                 break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toUInt() == vars.toUInt()) {
-                        return false;
-                    }
+            case BIGGER:
+            case SMALLER:
+                if (rule.values.size() < 1) {
+                    qDebug() << __FUNCTION__ << "limit with less than 1 value, ignored; field:" << name;
+                    rule.type = UNDEFINED;
+                } else if (rule.values.size() > 1) {
+                    qDebug() << __FUNCTION__ << "limit with more than 1 value, using first; field" << name;
                 }
-                return true;
-
-                break;
-            case ENUM:
-            case STRING:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toString() == vars.toString()) {
-                        return false;
-                    }
-                }
-                return true;
-
-                break;
-            case FLOAT32:
-                foreach(QVariant vars, struc.values) {
-                    if (var.toFloat() == vars.toFloat()) {
-                        return false;
-                    }
-                }
-                return true;
-
                 break;
             default:
-                return true;
-            }
-            break;
-        case BETWEEN:
-            if (struc.values.length() < 2) {
-                qDebug() << __FUNCTION__ << "between limit with less than 1 pair, aborting; field:" << name;
-                return true;
-            }
-            if (struc.values.length() > 2) {
-                qDebug() << __FUNCTION__ << "between limit with more than 1 pair, using first; field" << name;
-            }
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() >= struc.values.at(0).toInt() && var.toInt() <= struc.values.at(1).toInt())) {
-                    return false;
-                }
-                return true;
-
                 break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() >= struc.values.at(0).toUInt() && var.toUInt() <= struc.values.at(1).toUInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()) && options.indexOf(var.toString()) <= options.indexOf(struc.values.at(1).toString()))) {
-                    return false;
-                }
-                return true;
+            }
+            rules.append(rule);
+        }
+    }
+}
+bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
+{
+    double value;
 
-                break;
-            case STRING:
-                return true;
+    switch (type) {
+    case INT8:
+    case INT16:
+    case INT32:
+        value = var.toInt();
+        break;
+    case UINT8:
+    case UINT16:
+    case UINT32:
+    case BITFIELD:
+        value = var.toUInt();
+        break;
+    case FLOAT32:
+        value = var.toFloat();
+        break;
+    case ENUM:
+        value = optionIndexes.value(var.toString(), -1);
+        break;
+    case STRING:
+        // only equality rules apply to strings, they are not compiled
+        foreach(LimitStruct struc, elementLimits.value(index)) {
+            if ((struc.board != board) && board != 0 && struc.board != 0) {
+                continue;
+            }
+            switch (struc.type) {
+            case EQUAL:
+                return struc.values.contains(var.toString());
 
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() >= struc.values.at(0).toFloat() && var.toFloat() <= struc.values.at(1).toFloat())) {
-                    return false;
-                }
-                return true;
+            case NOT_EQUAL:
+                return !struc.values.contains(var.toString());
 
-                break;
             default:
                 return true;
             }
-            break;
-        case BIGGER:
-            if (struc.values.length() < 1) {
-                qDebug() << __FUNCTION__ << "BIGGER limit with less than 1 value, aborting; field:" << name;
-                return true;
-            }
-            if (struc.values.length() > 1) {
-                qDebug() << __FUNCTION__ << "BIGGER limit with more than 1 value, using first; field" << name;
-            }
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() >= struc.values.at(0).toInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() >= struc.values.at(0).toUInt())) {
-                    return false;
-                }
-                return true;
-
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()))) {
-                    return false;
-                }
-                return true;
+        }
+        return true;
 
-                break;
-            case STRING:
-                return true;
+    default:
+        return true;
+    }
+    return isWithinLimits(value, index, board);
+}
 
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() >= struc.values.at(0).toFloat())) {
-                    return false;
-                }
-                return true;
+bool UAVObjectField::isWithinLimits(double value, quint32 index, int board)
+{
+    if (index >= (quint32)compiledLimits.size()) {
+        return true;
+    }
+    if (type == FLOAT32) {
+        value = (float)value;
+    }
 
-                break;
-            default:
-                return true;
-            }
-            break;
-        case SMALLER:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() <= struc.values.at(0).toInt())) {
-                    return false;
-                }
-                return true;
+    const QVector<CompiledLimit> &rules = compiledLimits.at(index);
+    for (int i = 0; i < rules.size(); ++i) {
+        const CompiledLimit &rule = rules.at(i);
+        if ((rule.board != board) && board != 0 && rule.board != 0) {
+            continue;
+        }
+        // the first rule of the board decides
+        switch (rule.type) {
+        case EQUAL:
+            return rule.values.contains(value);
 
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() <= struc.values.at(0).toUInt())) {
-                    return false;
-                }
-                return true;
+        case NOT_EQUAL:
+            return !rule.values.contains(value);
 
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString()) <= options.indexOf(struc.values.at(0).toString()))) {
-                    return false;
-                }
-                return true;
+        case BETWEEN:
+            return value >= rule.values.at(0) && value <= rule.values.at(1);
 
-                break;
-            case STRING:
-                return true;
+        case BIGGER:
+            return value >= rule.values.at(0);
 
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() <= struc.values.at(0).toFloat())) {
-                    return false;
-                }
-                return true;
+        case SMALLER:
+            return value <= rule.values.at(0);
 
-                break;
-            default:
-                return true;
-            }
         default:
             return true;
         }
@@ -474,7 +459,7 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 {
     QString limitString;
 
-    if (elementLimits.keys().contains(index)) {
+    if (elementLimits.contains(index)) {
         foreach(LimitStruct struc, elementLimits.value(index)) {
             if ((struc.board != board) && board != 0 && struc.board != 0) {
                 continue;
@@ -524,7 +509,7 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 
 QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!elementLimits.contains(index)) {
         return QVariant();
     }
     foreach(LimitStruct struc, elementLimits.value(index)) {
@@ -551,7 +536,7 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 }
 QVariant UAVObjectField::getMinLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!elementLimits.contains(index)) {
         return QVariant();
     }
     foreach(LimitStruct struc, elementLimits.value(index)) {
@@ -581,6 +566,8 @@ void UAVObjectField::initialize(quint8 *data, quint32 dataOffset, UAVObject *obj
     this->data   = data;
     this->offset = dataOffset;
     this->obj    = obj;
+    // the field is a view on the object data, it lives and dies with the object
+    setParent(obj);
     clear();
 }
 
@@ -671,6 +658,16 @@ QStringList UAVObjectField::getOptions()
     return options;
 }
 
+int UAVObjectField::getElementIndex(const QString & elementName)
+{
+    return elementIndexes.value(elementName, -1);
+}
+
+int UAVObjectField::getOptionIndex(const QString & option)
+{
+    return optionIndexes.value(option, -1);
+}
+
 quint32 UAVObjectField::getNumElements()
 {
     return numElements;
@@ -734,7 +731,7 @@ void UAVObjectField::fromXML(QXmlStreamReader *xmlReader)
     // Read values, skip overflowing ones if any
     while (xmlReader->readNextStartElement()) {
         if (xmlReader->name() == "value") {
-            int index = getElementNames().indexOf(xmlReader->attributes().value("name").toString());
+            int index = getElementIndex(xmlReader->attributes().value("name").toString());
             if (index >= 0) {
                 setValue(xmlReader->readElementText(), index);
             }
@@ -763,7 +760,7 @@ void UAVObjectField::fromJson(const QJsonObject &jsonObject)
     QJsonArray jsonValues = jsonObject["values"].toArray();
     for (int i = 0; i < jsonValues.size(); i++) {
         QJsonObject jsonValue = jsonValues.at(i).toObject();
-        int index = getElementNames().indexOf(jsonValue["name"].toString());
+        int index = getElementIndex(jsonValue["name"].toString());
         if (index >= 0) {
             setValue(((QJsonValue)jsonValue["value"]).toVariant(), index);
         }
@@ -1080,8 +1077,7 @@ bool UAVObjectField::checkValue(const QVariant & value, quint32 index)
             break;
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
-            return (tmpenum < 0) ? false : true;
+            return optionIndexes.contains(value.toString());
 
             break;
         }
@@ -1151,7 +1147,7 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
         }
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = optionIndexes.value(value.toString(), -1);
             // try case insensitive
             if (tmpenum < 0) {
                 QRegExp regexp(value.toString(), Qt::CaseInsensitive);
@@ -1193,10 +1189,196 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
 
 double UAVObjectField::getDouble(quint32 index)
 {
+    if (isNumeric()) {
+        return get<double>(index);
+    }
     return getValue(index).toDouble();
 }
 
 void UAVObjectField::setDouble(double value, quint32 index)
 {
+    if (isNumeric()) {
+        set<double>(index, value);
+        return;
+    }
     setValue(QVariant(value), index);
 }
+
+namespace {
+template<typename T>
+inline T readElement(const quint8 *element)
+{
+    T value;
+
+    memcpy(&value, element, sizeof(T));
+    return value;
+}
+
+template<typename T>
+inline void writeElement(quint8 *element, T value)
+{
+    memcpy(element, &value, sizeof(T));
+}
+
+// Convert a value for storage, floating point values are rounded when stored
+// in integer fields (same as QVariant does)
+template<typename D, typename S>
+inline D convertElement(S value)
+{
+    if (std::is_floating_point<S>::value && !std::is_floating_point<D>::value) {
+        return static_cast<D>(qRound64(value));
+    }
+    return static_cast<D>(value);
+}
+}
+
+template<typename T>
+T UAVObjectField::get(quint32 index)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    return getElement<T>(data, index);
+}
+
+/**
+ * Get an element from a copy of the object data (see UAVObject::readSnapshot()), no locking involved.
+ * Non numeric fields return 0.
+ */
+double UAVObjectField::getDouble(quint32 index, const quint8 *snapshot)
+{
+    return getElement<double>(snapshot, index);
+}
+
+template<typename T>
+T UAVObjectField::getElement(const quint8 *objectData, quint32 index)
+{
+    // Check that index is not out of bounds
+    if (index >= numElements) {
+        return T();
+    }
+    const quint8 *element = &objectData[offset + numBytesPerElement * index];
+    switch (type) {
+    case INT8:
+        return static_cast<T>(readElement<qint8>(element));
+
+    case INT16:
+        return static_cast<T>(readElement<qint16>(element));
+
+    case INT32:
+        return static_cast<T>(readElement<qint32>(element));
+
+    case UINT8:
+    case ENUM:
+        return static_cast<T>(readElement<quint8>(element));
+
+    case UINT16:
+        return static_cast<T>(readElement<quint16>(element));
+
+    case UINT32:
+        return static_cast<T>(readElement<quint32>(element));
+
+    case FLOAT32:
+        return static_cast<T>(readElement<float>(element));
+
+    case BITFIELD:
+        return static_cast<T>((objectData[offset + numBytesPerElement * ((quint32)(index / 8))] >> (index % 8)) & 1);
+
+    case STRING:
+        break;
+    }
+    return T();
+}
+
+template<typename T>
+void UAVObjectField::set(quint32 index, T value)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    // Check that index is not out of bounds
+    if (index >= numElements) {
+        return;
+    }
+    // Update value if the access mode permits
+    if (UAVObject::GetGcsAccess(obj->getMetadata()) != UAVObject::ACCESS_READWRITE) {
+        return;
+    }
+    quint8 *element = &data[offset + numBytesPerElement * index];
+    switch (type) {
+    case INT8:
+        writeElement<qint8>(element, convertElement<qint8>(value));
+        break;
+    case INT16:
+        writeElement<qint16>(element, convertElement<qint16>(value));
+        break;
+    case INT32:
+        writeElement<qint32>(element, convertElement<qint32>(value));
+        break;
+    case UINT8:
+        writeElement<quint8>(element, convertElement<quint8>(value));
+        break;
+    case UINT16:
+        writeElement<quint16>(element, convertElement<quint16>(value));
+        break;
+    case UINT32:
+        writeElement<quint32>(element, convertElement<quint32>(value));
+        break;
+    case FLOAT32:
+        writeElement<float>(element, convertElement<float>(value));
+        break;
+    case ENUM:
+    {
+        qint64 tmpenum = convertElement<qint64>(value);
+        // Default to 0 on invalid values.
+        if (tmpenum < 0 || tmpenum >= options.length()) {
+            qWarning() << "Enum value" << tmpenum << "out of range";
+            tmpenum = 0;
+        }
+        writeElement<quint8>(element, (quint8)tmpenum);
+        break;
+    }
+    case BITFIELD:
+    {
+        quint8 *byte = &data[offset + numBytesPerElement * ((quint32)(index / 8))];
+        *byte = (*byte & ~(1 << (index % 8))) | ((value != 0 ? 1 : 0) << (index % 8));
+        break;
+    }
+    case STRING:
+        break;
+    }
+}
+
+template qint8 UAVObjectField::get<qint8>(quint32);
+template qint16 UAVObjectField::get<qint16>(quint32);
+template qint32 UAVObjectField::get<qint32>(quint32);
+template quint8 UAVObjectField::get<quint8>(quint32);
+template quint16 UAVObjectField::get<quint16>(quint32);
+template quint32 UAVObjectField::get<quint32>(quint32);
+template float UAVObjectField::get<float>(quint32);
+template double UAVObjectField::get<double>(quint32);
+
+template void UAVObjectField::set<qint8>(quint32, qint8);
+template void UAVObjectField::set<qint16>(quint32, qint16);
+template void UAVObjectField::set<qint32>(quint32, qint32);
+template void UAVObjectField::set<quint8>(quint32, quint8);
+template void UAVObjectField::set<quint16>(quint32, quint16);
+template void UAVObjectField::set<quint32>(quint32, quint32);
+template void UAVObjectField::set<float>(quint32, float);
+template void UAVObjectField::set<double>(quint32, double);
+
+/**
+ * Copy all the elements of a numeric field as doubles
+ * @param dataOut Buffer of at least getNumElements() values
+ * @returns The number of copied elements (0 if the field is not numeric)
+ */
+quint32 UAVObjectField::copyElements(double *dataOut)
+{
+    QMutexLocker locker(obj->getMutex());
+
+    if (!isNumeric()) {
+        return 0;
+    }
+    for (quint32 index = 0; index < numElements; ++index) {
+        dataOut[index] = get<double>(index);
+    }
+    return numElements;
+}
@@ -35,6 +35,8 @@
 #include <QVariant>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 
 class UAVObject;
 
@@ -53,9 +55,30 @@ public:
         QList<QVariant> values;
         int board;
     } LimitStruct;
+    // Limit rule compiled for the checks, with the values converted to the field type
+    // (the option indexes for enums) and stored as doubles, which hold all of them exactly
+    typedef struct {
+        LimitType type;
+        int board;
+        QVector<double> values;
+    } CompiledLimit;
+    // Static field metadata as emitted by the generator, shared by all the instances of an object
+    struct Definition {
+        const char *context; // translation context of the description
+        const char *name;
+        const char *description;
+        const char *units;
+        FieldType  type;
+        quint32    numElements;
+        const char *const *elementNames;
+        quint32    numOptions;
+        const char *const *options;
+        const char *limits;
+    };
 
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString & limits = QString());
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
+    explicit UAVObjectField(const Definition & definition);
     void initialize(quint8 *data, quint32 dataOffset, UAVObject *obj);
     UAVObject *getObject();
     FieldType getType();
@@ -66,13 +89,23 @@ public:
     quint32 getNumElements();
     QStringList getElementNames();
     QStringList getOptions();
+    // O(1) lookups, -1 if unknown
+    int getElementIndex(const QString & elementName);
+    int getOptionIndex(const QString & option);
     qint32 pack(quint8 *dataOut);
     qint32 unpack(const quint8 *dataIn);
     QVariant getValue(quint32 index = 0);
     bool checkValue(const QVariant & data, quint32 index = 0);
     void setValue(const QVariant & data, quint32 index = 0);
     double getDouble(quint32 index = 0);
+    double getDouble(quint32 index, const quint8 *snapshot);
     void setDouble(double value, quint32 index = 0);
+    // Typed accessors, no QVariant involved
+    // Supported types are qint8, qint16, qint32, quint8, quint16, quint32, float and double.
+    // Enum fields read and write the option index, string fields are not supported.
+    template<typename T> T get(quint32 index = 0);
+    template<typename T> void set(quint32 index, T value);
+    quint32 copyElements(double *dataOut);
     quint32 getDataOffset();
     quint32 getNumBytes();
     bool isNumeric();
@@ -89,6 +122,8 @@ public:
     void fromJson(const QJsonObject &jsonObject);
 
     bool isWithinLimits(QVariant var, quint32 index, int board = 0);
+    // value of the element in the field type, the option index for enums, not for string fields
+    bool isWithinLimits(double value, quint32 index, int board = 0);
     QString getLimitsAsString(quint32 index, int board = 0);
     QVariant getMaxLimit(quint32 index, int board = 0);
     QVariant getMinLimit(quint32 index, int board = 0);
@@ -102,14 +137,22 @@ protected:
     FieldType type;
     QStringList elementNames;
     QStringList options;
+    // position of each element name and option, shared by all the instances of an object
+    QHash<QString, int> elementIndexes;
+    QHash<QString, int> optionIndexes;
     quint32 numElements;
     quint32 numBytesPerElement;
     quint32 offset;
     quint8 *data;
     UAVObject *obj;
     QMap<quint32, QList<LimitStruct> > elementLimits;
+    // compiled elementLimits, indexed by element
+    QVector<QVector<CompiledLimit> > compiledLimits;
+    template<typename T> T getElement(const quint8 *objectData, quint32 index);
     void constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
     void limitsInitialize(const QString &limits);
+    void limitsCompile();
+    void indexesInitialize();
 };
 
 #endif // UAVOBJECTFIELD_H
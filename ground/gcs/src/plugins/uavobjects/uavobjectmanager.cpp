@@ -29,6 +29,7 @@
 
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QJsonDocument>
 
 /**
  * Constructor
@@ -54,54 +55,52 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
     QMutexLocker locker(mutex);
 
     // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0 && objects[objidx][0]->getObjID() == obj->getObjID()) {
-            // Check if this is a single instance object, if yes we can not add a new instance
-            if (obj->isSingleInstance()) {
-                return false;
-            }
-            // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
-            // There is a single metaobject for all object instances of this type, so no need to create a new one
-            // Get object type metaobject from existing instance
-            UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
-            if (refObj == NULL) {
-                return false;
-            }
-            UAVMetaObject *mobj = refObj->getMetaObject();
-            // If the instance ID is specified and not at the default value (0) then we need to make sure
-            // that there are no gaps in the instance list. If gaps are found then then additional instances
-            // will be created.
-            if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
-                        // Instance conflict, do not add
-                        return false;
-                    }
-                }
-                // Check if there are any gaps between the requested instance ID and the ones in the list,
-                // if any then create the missing instances.
-                for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
-                    UAVDataObject *cobj = obj->clone(instidx);
-                    cobj->initialize(mobj);
-                    objects[objidx].append(cobj);
-                    getObject(cobj->getObjID())->emitNewInstance(cobj);
-                    emit newInstance(cobj);
+    int objidx = indexOf(NULL, obj->getObjID());
+    if (objidx >= 0) {
+        // Check if this is a single instance object, if yes we can not add a new instance
+        if (obj->isSingleInstance()) {
+            return false;
+        }
+        // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
+        // There is a single metaobject for all object instances of this type, so no need to create a new one
+        // Get object type metaobject from existing instance
+        UAVDataObject *refObj = dynamic_cast<UAVDataObject *>(objects[objidx][0]);
+        if (refObj == NULL) {
+            return false;
+        }
+        UAVMetaObject *mobj = refObj->getMetaObject();
+        // If the instance ID is specified and not at the default value (0) then we need to make sure
+        // that there are no gaps in the instance list. If gaps are found then then additional instances
+        // will be created.
+        if ((obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES)) {
+            for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
+                if (objects[objidx][instidx]->getInstID() == obj->getInstID()) {
+                    // Instance conflict, do not add
+                    return false;
                 }
-                // Finally, initialize the actual object instance
-                obj->initialize(mobj);
-            } else if (obj->getInstID() == 0) {
-                // Assign the next available ID and initialize the object instance
-                obj->initialize(objects[objidx].length(), mobj);
-            } else {
-                return false;
             }
-            // Add the actual object instance in the list
-            objects[objidx].append(obj);
-            getObject(obj->getObjID())->emitNewInstance(obj);
-            emit newInstance(obj);
-            return true;
+            // Check if there are any gaps between the requested instance ID and the ones in the list,
+            // if any then create the missing instances.
+            for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx) {
+                UAVDataObject *cobj = obj->clone(instidx);
+                cobj->initialize(mobj);
+                objects[objidx].append(cobj);
+                getObject(cobj->getObjID())->emitNewInstance(cobj);
+                emit newInstance(cobj);
+            }
+            // Finally, initialize the actual object instance
+            obj->initialize(mobj);
+        } else if (obj->getInstID() == 0) {
+            // Assign the next available ID and initialize the object instance
+            obj->initialize(objects[objidx].length(), mobj);
+        } else {
+            return false;
         }
+        // Add the actual object instance in the list
+        objects[objidx].append(obj);
+        getObject(obj->getObjID())->emitNewInstance(obj);
+        emit newInstance(obj);
+        return true;
     }
     // If this point is reached then this is the first time this object type (ID) is added in the list
     // create a new list of the instances, add in the object collection and create the object's metaobject
@@ -117,15 +116,91 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
     return true;
 }
 
+/**
+ * Register an object type without constructing it. The first instance is constructed
+ * on first access, by name or ID, or when all the objects are listed.
+ * Used at startup to avoid constructing the objects that are never used.
+ */
+bool UAVObjectManager::registerObjectType(quint32 objId, const QString & name, ObjectFactory factory)
+{
+    QMutexLocker locker(mutex);
+
+    if (objectIndexById.contains(objId) || objectTypes.contains(objId)) {
+        return false;
+    }
+    objectTypes.insert(objId, factory);
+    objectTypeIdByName.insert(name, objId);
+    objectTypeIdByName.insert(name + "Meta", objId);
+    objectTypeOrder.append(objId);
+    return true;
+}
+
+/**
+ * Construct and register the first instance of a registered object type given its name (if not NULL) or ID.
+ * The ID and name of the metaobject are also accepted.
+ * @returns True if an object type was constructed
+ */
+bool UAVObjectManager::constructObjectType(const QString *name, quint32 objId)
+{
+    if (name != NULL) {
+        objId = objectTypeIdByName.value(*name, 0);
+    } else if (!objectTypes.contains(objId)) {
+        // metaobject ID
+        objId = objId - 1;
+    }
+    ObjectFactory factory = objectTypes.take(objId);
+    if (factory == NULL) {
+        return false;
+    }
+    UAVDataObject *obj = factory();
+    objectTypeIdByName.remove(obj->getName());
+    objectTypeIdByName.remove(obj->getName() + "Meta");
+
+    registerObject(obj);
+
+    // objects can be first accessed from the telemetry thread, they belong to the GUI thread
+    if (obj->thread() != thread()) {
+        obj->getMetaObject()->moveToThread(thread());
+        obj->moveToThread(thread());
+    }
+    return true;
+}
+
+void UAVObjectManager::constructAllObjectTypes()
+{
+    foreach(quint32 objId, objectTypeOrder) {
+        if (objectTypes.contains(objId)) {
+            constructObjectType(NULL, objId);
+        }
+    }
+    objectTypeOrder.clear();
+}
+
 void UAVObjectManager::addObject(UAVObject *obj)
 {
     // Add to list
     QList<UAVObject *> list;
     list.append(obj);
+    objectIndexById.insert(obj->getObjID(), objects.length());
+    objectIndexByName.insert(obj->getName(), objects.length());
     objects.append(list);
     emit newObject(obj);
 }
 
+/**
+ * Get the index of an object type in the objects list given its name (if not NULL) or ID
+ * @returns The index or -1 if the object type is not registered
+ */
+int UAVObjectManager::indexOf(const QString *name, quint32 objId)
+{
+    int objidx = (name != NULL) ? objectIndexByName.value(*name, -1) : objectIndexById.value(objId, -1);
+
+    if (objidx < 0 && !objectTypes.isEmpty() && constructObjectType(name, objId)) {
+        objidx = (name != NULL) ? objectIndexByName.value(*name, -1) : objectIndexById.value(objId, -1);
+    }
+    return objidx;
+}
+
 /**
  * Get all objects. A two dimentional QList is returned. Objects are grouped by
  * instances of the same object type.
@@ -134,6 +209,7 @@ QList< QList<UAVObject *> > UAVObjectManager::getObjects()
 {
     QMutexLocker locker(mutex);
 
+    constructAllObjectTypes();
     return objects;
 }
 
@@ -144,6 +220,7 @@ QList< QList<UAVDataObject *> > UAVObjectManager::getDataObjects()
 {
     QMutexLocker locker(mutex);
 
+    constructAllObjectTypes();
     QList< QList<UAVDataObject *> > dObjects;
 
     // Go through objects and copy to new list when types match
@@ -177,6 +254,7 @@ QList <QList<UAVMetaObject *> > UAVObjectManager::getMetaObjects()
 {
     QMutexLocker locker(mutex);
 
+    constructAllObjectTypes();
     QList< QList<UAVMetaObject *> > mObjects;
 
     // Go through objects and copy to new list when types match
@@ -228,17 +306,18 @@ UAVObject *UAVObjectManager::getObject(const QString *name, quint32 objId, quint
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                // Look for the requested instance ID
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx) {
-                    if (objects[objidx][instidx]->getInstID() == instId) {
-                        return objects[objidx][instidx];
-                    }
-                }
+    int objidx = indexOf(name, objId);
+
+    if (objidx >= 0) {
+        const QList<UAVObject *> & instances = objects.at(objidx);
+        // Instances are kept in instance ID order without gaps
+        if (instId < (quint32)instances.length() && instances.at(instId)->getInstID() == instId) {
+            return instances.at(instId);
+        }
+        // Look for the requested instance ID
+        for (int instidx = 0; instidx < instances.length(); ++instidx) {
+            if (instances.at(instidx)->getInstID() == instId) {
+                return instances.at(instidx);
             }
         }
     }
@@ -270,14 +349,10 @@ QList<UAVObject *> UAVObjectManager::getObjectInstances(const QString *name, qui
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx];
-            }
-        }
+    int objidx = indexOf(name, objId);
+
+    if (objidx >= 0) {
+        return objects.at(objidx);
     }
     // If this point is reached then the requested object could not be found
     return QList<UAVObject *>();
@@ -300,6 +375,11 @@ qint32 UAVObjectManager::getNumInstances(quint32 objId)
 }
 
 void UAVObjectManager::toJson(QJsonObject &jsonObject, UAVObjectManager::JSON_EXPORT_OPTION what)
+{
+    toJson(jsonObject, jsonExportObjects(what));
+}
+
+QList<UAVObject *> UAVObjectManager::jsonExportObjects(UAVObjectManager::JSON_EXPORT_OPTION what)
 {
     QList<UAVObject *> objects;
     QList< QList<UAVObject *> > allObjects = getObjects();
@@ -313,7 +393,7 @@ void UAVObjectManager::toJson(QJsonObject &jsonObject, UAVObjectManager::JSON_EX
             }
         }
     }
-    toJson(jsonObject, objects);
+    return objects;
 }
 
 void UAVObjectManager::toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport)
@@ -341,20 +421,142 @@ void UAVObjectManager::toJson(QJsonObject &jsonObject, const QList<UAVObject *>
     jsonObject["objects"] = jObjects;
 }
 
+/**
+ * Set the objects found in jsonObject
+ * @param updatedObjects if not NULL receives the objects whose data actually
+ * changed, objects that already held the imported values are left out
+ */
 void UAVObjectManager::fromJson(const QJsonObject &jsonObject, QList<UAVObject *> *updatedObjects)
 {
     QJsonArray jObjects = jsonObject["objects"].toArray();
 
     for (int i = 0; i < jObjects.size(); i++) {
-        QJsonObject jObject = jObjects.at(i).toObject();
-        UAVObject *object   = getObject(jObject["name"].toString(), jObject["instance"].toInt());
-        if (object != NULL) {
-            object->fromJson(jObject);
-            if (updatedObjects != NULL) {
-                updatedObjects->append(object);
+        fromJsonObject(jObjects.at(i).toObject(), updatedObjects);
+    }
+}
+
+void UAVObjectManager::fromJsonObject(const QJsonObject &jObject, QList<UAVObject *> *updatedObjects)
+{
+    UAVObject *object = getObject(jObject["name"].toString(), jObject["instance"].toInt());
+
+    if (object != NULL) {
+        QByteArray before = object->packedData();
+        object->fromJson(jObject);
+        if (updatedObjects != NULL && object->packedData() != before) {
+            updatedObjects->append(object);
+        }
+    }
+}
+
+/**
+ * Write the same document as toJson(QJsonObject &, JSON_EXPORT_OPTION) straight
+ * to a device, one object at a time
+ * @returns false if writing to the device failed
+ */
+bool UAVObjectManager::toJson(QIODevice *device, UAVObjectManager::JSON_EXPORT_OPTION what)
+{
+    return toJson(device, jsonExportObjects(what));
+}
+
+bool UAVObjectManager::toJson(QIODevice *device, const QList<UAVObject *> &objectsToExport)
+{
+    bool ok = device->write("{\"objects\":[") >= 0;
+
+    for (int i = 0; ok && i < objectsToExport.size(); i++) {
+        QJsonObject jObject;
+        objectsToExport.at(i)->toJson(jObject);
+        if (i > 0) {
+            ok = device->write(",", 1) == 1;
+        }
+        ok = ok && device->write(QJsonDocument(jObject).toJson(QJsonDocument::Compact)) >= 0;
+    }
+    return ok && device->write("]}") == 2;
+}
+
+/**
+ * Read a document written by toJson() from a device and apply each object as soon
+ * as it has been read, without building the document for all objects.
+ * The device is read until it returns no more data.
+ * @returns false if the document is not valid JSON or has no "objects" array,
+ * the objects read up to the error are applied anyway
+ */
+bool UAVObjectManager::fromJson(QIODevice *device, QList<UAVObject *> *updatedObjects)
+{
+    QByteArray element; // the object of the "objects" array being read
+    QByteArray key; // the last key read in the root object
+    int depth      = 0; // nesting depth, 1 in the root object
+    int arrayDepth = 0; // depth inside the "objects" array once found
+    bool arrayDone = false;
+    bool inString  = false;
+    bool escape    = false;
+
+    for (QByteArray chunk = device->read(JSON_READ_CHUNK); !chunk.isEmpty(); chunk = device->read(JSON_READ_CHUNK)) {
+        for (int i = 0; i < chunk.size(); i++) {
+            char c = chunk.at(i);
+            bool inElement = arrayDepth > 0 && depth > arrayDepth;
+
+            if (inString) {
+                if (escape) {
+                    escape = false;
+                } else if (c == '\\') {
+                    escape = true;
+                } else if (c == '"') {
+                    inString = false;
+                } else if (depth == 1) {
+                    key.append(c);
+                }
+                if (inElement) {
+                    element.append(c);
+                }
+                continue;
+            }
+
+            switch (c) {
+            case '"':
+                inString = true;
+                if (depth == 1) {
+                    key.clear();
+                }
+                break;
+            case '{':
+            case '[':
+                depth++;
+                if (c == '[' && depth == 2 && arrayDepth == 0 && !arrayDone && key == "objects") {
+                    arrayDepth = depth;
+                }
+                inElement = arrayDepth > 0 && depth > arrayDepth;
+                break;
+            case '}':
+            case ']':
+                if (depth == 0) {
+                    return false;
+                }
+                if (inElement) {
+                    element.append(c);
+                }
+                depth--;
+                if (arrayDepth > 0 && depth == arrayDepth) {
+                    QJsonParseError error;
+                    QJsonDocument doc = QJsonDocument::fromJson(element, &error);
+                    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+                        return false;
+                    }
+                    fromJsonObject(doc.object(), updatedObjects);
+                    element.clear();
+                } else if (arrayDepth > 0 && depth < arrayDepth) {
+                    arrayDepth = 0;
+                    arrayDone  = true;
+                }
+                continue;
+            default:
+                break;
+            }
+            if (inElement) {
+                element.append(c);
             }
         }
     }
+    return arrayDone && depth == 0 && !inString;
 }
 
 /**
@@ -364,14 +566,10 @@ qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
 {
     QMutexLocker locker(mutex);
 
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx) {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0) {
-            if ((name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId)) {
-                return objects[objidx].length();
-            }
-        }
+    int objidx = indexOf(name, objId);
+
+    if (objidx >= 0) {
+        return objects.at(objidx).length();
     }
     // If this point is reached then the requested object could not be found
     return -1;
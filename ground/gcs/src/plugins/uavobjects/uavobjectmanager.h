@@ -33,19 +33,23 @@
 #include "uavdataobject.h"
 #include "uavmetaobject.h"
 #include <QList>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QJsonObject>
+#include <QIODevice>
 
 class UAVOBJECTS_EXPORT UAVObjectManager : public QObject {
     Q_OBJECT
 
 public:
     enum JSON_EXPORT_OPTION { JSON_EXPORT_ALL, JSON_EXPORT_METADATA, JSON_EXPORT_SETTINGS, JSON_EXPORT_DATA };
+    typedef UAVDataObject *(*ObjectFactory)();
     UAVObjectManager();
     ~UAVObjectManager();
 
     bool registerObject(UAVDataObject *obj);
+    bool registerObjectType(quint32 objId, const QString & name, ObjectFactory factory);
     QList< QList<UAVObject *> > getObjects();
     QList< QList<UAVDataObject *> > getDataObjects();
     QList< QList<UAVMetaObject *> > getMetaObjects();
@@ -61,20 +65,38 @@ public:
     void toJson(QJsonObject &jsonObject, const QList<UAVObject *> &objectsToExport);
     void fromJson(const QJsonObject &jsonObject, QList<UAVObject *> *updatedObjects = NULL);
 
+    // streaming variants, only one object is held as a JSON document at a time
+    bool toJson(QIODevice *device, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
+    bool toJson(QIODevice *device, const QList<UAVObject *> &objectsToExport);
+    bool fromJson(QIODevice *device, QList<UAVObject *> *updatedObjects = NULL);
+
 signals:
     void newObject(UAVObject *obj);
     void newInstance(UAVObject *obj);
 
 private:
-    static const quint32 MAX_INSTANCES = 1000;
+    static const quint32 MAX_INSTANCES   = 1000;
+    static const int JSON_READ_CHUNK     = 4096;
 
     QList< QList<UAVObject *> > objects;
+    // index of each object type in the objects list, by object ID and by name
+    QHash<quint32, int> objectIndexById;
+    QHash<QString, int> objectIndexByName;
+    // object types registered but not constructed yet, by object ID and by object or metaobject name
+    QHash<quint32, ObjectFactory> objectTypes;
+    QHash<QString, quint32> objectTypeIdByName;
+    QList<quint32> objectTypeOrder;
     QMutex *mutex;
 
     void addObject(UAVObject *obj);
+    bool constructObjectType(const QString *name, quint32 objId);
+    void constructAllObjectTypes();
+    int indexOf(const QString *name, quint32 objId);
     UAVObject *getObject(const QString *name, quint32 objId, quint32 instId);
     QList<UAVObject *> getObjectInstances(const QString *name, quint32 objId);
     qint32 getNumInstances(const QString *name, quint32 objId);
+    QList<UAVObject *> jsonExportObjects(JSON_EXPORT_OPTION what);
+    void fromJsonObject(const QJsonObject &jObject, QList<UAVObject *> *updatedObjects);
 };
 
 
@@ -15,6 +15,7 @@ HEADERS += \
     uavobjectmanager.h \
     uavdataobject.h \
     uavobjectfield.h \
+    uavobjectupdatecoalescer.h \
     uavobjectsinit.h \
     uavobjectsplugin.h
 
@@ -24,6 +25,7 @@ SOURCES += \
     uavobjectmanager.cpp \
     uavdataobject.cpp \
     uavobjectfield.cpp \
+    uavobjectupdatecoalescer.cpp \
     uavobjectsplugin.cpp
 
 OTHER_FILES += UAVObjects.pluginspec
@@ -28,6 +28,9 @@
 #include "uavobjectsplugin.h"
 #include "uavobjectsinit.h"
 #include "uavobjectmanager.h"
+#include "uavobjectupdatecoalescer.h"
+
+#include <extensionsystem/startuptrace.h>
 
 UAVObjectsPlugin::UAVObjectsPlugin()
 {}
@@ -45,7 +48,12 @@ bool UAVObjectsPlugin::initialize(const QStringList & arguments, QString *errorS
 
     addAutoReleasedObject(objMngr);
     // Initialize UAVObjects
-    UAVObjectsInitialize(objMngr);
+    {
+        ExtensionSystem::StartupTrace::Scope trace("startup", QLatin1String("UAVObjectsInitialize"));
+        UAVObjectsInitialize(objMngr);
+    }
+    // Expose the shared update coalescer for GUI subscribers
+    addAutoReleasedObject(new UAVObjectUpdateCoalescer());
     // Done
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
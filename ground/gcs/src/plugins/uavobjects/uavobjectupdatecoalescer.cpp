@@ -0,0 +1,136 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectupdatecoalescer.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectupdatecoalescer.h"
+
+#include "uavobject.h"
+
+#include <QMutexLocker>
+
+CoalescedObjectUpdates::CoalescedObjectUpdates(UAVObject *obj, UAVObjectUpdateCoalescer *coalescer) :
+    QObject(coalescer), m_object(obj), m_coalescer(coalescer), m_pending(0)
+{
+    // direct connection: only a flag is set in the thread that updated the object
+    connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(markUpdated()), Qt::DirectConnection);
+}
+
+UAVObject *CoalescedObjectUpdates::object() const
+{
+    return m_object;
+}
+
+/**
+ * Called each time the object is updated, possibly from a non GUI thread
+ */
+void CoalescedObjectUpdates::markUpdated()
+{
+    // schedule only once until the update is delivered
+    if (m_pending.testAndSetOrdered(0, 1)) {
+        m_coalescer->schedule(this);
+    }
+}
+
+void CoalescedObjectUpdates::deliver()
+{
+    // clear the flag first so that updates received while delivering are not lost
+    m_pending.storeRelease(0);
+    emit objectUpdated(m_object);
+}
+
+/**
+ * Constructor
+ */
+UAVObjectUpdateCoalescer::UAVObjectUpdateCoalescer(QObject *parent) : QObject(parent), m_rate(DEFAULT_RATE)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(1000 / m_rate);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+UAVObjectUpdateCoalescer::~UAVObjectUpdateCoalescer()
+{
+    m_timer.stop();
+}
+
+/**
+ * Get the maximum delivery rate (updates per second and per object)
+ */
+int UAVObjectUpdateCoalescer::rate() const
+{
+    return m_rate;
+}
+
+/**
+ * Set the maximum delivery rate (updates per second and per object)
+ */
+void UAVObjectUpdateCoalescer::setRate(int rate)
+{
+    m_rate = qBound(1, rate, 1000);
+    m_timer.setInterval(1000 / m_rate);
+}
+
+/**
+ * Get the coalesced updates of an object.
+ * The returned object is owned by the coalescer and must only be used from the GUI thread.
+ */
+CoalescedObjectUpdates *UAVObjectUpdateCoalescer::updates(UAVObject *obj)
+{
+    Q_ASSERT(obj);
+    CoalescedObjectUpdates *updates = m_updates.value(obj, NULL);
+    if (updates == NULL) {
+        updates = new CoalescedObjectUpdates(obj, this);
+        m_updates.insert(obj, updates);
+        if (!m_timer.isActive()) {
+            m_timer.start();
+        }
+    }
+    return updates;
+}
+
+void UAVObjectUpdateCoalescer::schedule(CoalescedObjectUpdates *updates)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_pending.append(updates);
+}
+
+/**
+ * Deliver all updates received since the last tick
+ */
+void UAVObjectUpdateCoalescer::flush()
+{
+    QVector<CoalescedObjectUpdates *> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pending.isEmpty()) {
+            return;
+        }
+        pending.swap(m_pending);
+    }
+    foreach(CoalescedObjectUpdates * updates, pending) {
+        updates->deliver();
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectupdatecoalescer.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2017.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTUPDATECOALESCER_H
+#define UAVOBJECTUPDATECOALESCER_H
+
+#include "uavobjects_global.h"
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include <QVector>
+
+class UAVObject;
+class UAVObjectUpdateCoalescer;
+
+/**
+ * Coalesced update notifications of a single object.
+ * The objectUpdated() signal is emitted from the GUI thread at most once per coalescer tick,
+ * no matter how many times the object was updated in between.
+ */
+class UAVOBJECTS_EXPORT CoalescedObjectUpdates : public QObject {
+    Q_OBJECT
+
+    friend class UAVObjectUpdateCoalescer;
+
+public:
+    UAVObject *object() const;
+
+signals:
+    void objectUpdated(UAVObject *obj);
+
+private slots:
+    void markUpdated();
+
+private:
+    CoalescedObjectUpdates(UAVObject *obj, UAVObjectUpdateCoalescer *coalescer);
+
+    void deliver();
+
+    UAVObject *m_object;
+    UAVObjectUpdateCoalescer *m_coalescer;
+    QAtomicInt m_pending;
+};
+
+/**
+ * Opt-in dispatcher for GUI subscribers that only need the latest state of an object
+ * (displays, indicators...). Instead of connecting to UAVObject::objectUpdated directly, connect to
+ * the signal of updates(obj). Subscribers that need every sample (loggers, calibration) must keep
+ * connecting to the object itself.
+ */
+class UAVOBJECTS_EXPORT UAVObjectUpdateCoalescer : public QObject {
+    Q_OBJECT
+
+    friend class CoalescedObjectUpdates;
+
+public:
+    static const int DEFAULT_RATE = 60;
+
+    UAVObjectUpdateCoalescer(QObject *parent = 0);
+    ~UAVObjectUpdateCoalescer();
+
+    int rate() const;
+    void setRate(int rate);
+
+    CoalescedObjectUpdates *updates(UAVObject *obj);
+
+private slots:
+    void flush();
+
+private:
+    QTimer m_timer;
+    QMutex m_mutex;
+    QHash<UAVObject *, CoalescedObjectUpdates *> m_updates;
+    QVector<CoalescedObjectUpdates *> m_pending;
+    int m_rate;
+
+    void schedule(CoalescedObjectUpdates *updates);
+};
+
+#endif // UAVOBJECTUPDATECOALESCER_H
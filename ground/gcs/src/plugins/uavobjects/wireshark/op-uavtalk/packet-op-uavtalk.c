@@ -49,6 +49,7 @@ static int hf_op_uavtalk_version = -1;
 static int hf_op_uavtalk_type    = -1;
 static int hf_op_uavtalk_len     = -1;
 static int hf_op_uavtalk_objid   = -1;
+static int hf_op_uavtalk_instid  = -1;
 static int hf_op_uavtalk_crc8    = -1;
 
 #define UAVTALK_SYNC_VAL 0x3C
@@ -64,7 +65,7 @@ static const value_string uavtalk_packet_types[] = {
 
 void proto_reg_handoff_op_uavtalk(void);
 
-#define UAVTALK_HEADER_SIZE  8
+#define UAVTALK_HEADER_SIZE  10
 #define UAVTALK_TRAILER_SIZE 1
 static int dissect_op_uavtalk(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data _U_)
 {
@@ -105,6 +106,7 @@ static int dissect_op_uavtalk(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tre
         ptvcursor_add(cursor, hf_op_uavtalk_type, 1, ENC_LITTLE_ENDIAN);
         ptvcursor_add(cursor, hf_op_uavtalk_len, 2, ENC_LITTLE_ENDIAN);
         ptvcursor_add(cursor, hf_op_uavtalk_objid, 4, ENC_LITTLE_ENDIAN);
+        ptvcursor_add(cursor, hf_op_uavtalk_instid, 2, ENC_LITTLE_ENDIAN);
 
         offset = ptvcursor_current_offset(cursor);
 
@@ -161,6 +163,10 @@ void proto_register_op_uavtalk(void)
             { "ObjID",               "uavtalk.objid",  FT_UINT32,
             BASE_HEX, NULL, 0x0, NULL, HFILL }
         },
+        { &hf_op_uavtalk_instid,
+            { "InstID",              "uavtalk.instid", FT_UINT16,
+            BASE_DEC, NULL, 0x0, NULL, HFILL }
+        },
         { &hf_op_uavtalk_crc8,
             { "Crc8",                "uavtalk.crc8",   FT_UINT8,
             BASE_HEX, NULL, 0x0, NULL, HFILL }
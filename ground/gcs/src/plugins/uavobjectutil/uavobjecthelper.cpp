@@ -86,7 +86,8 @@ void AbstractUAVObjectHelper::transactionCompleted(UAVObject *object, bool succe
     m_eventLoop.quit();
 }
 
-UAVObjectUpdaterHelper::UAVObjectUpdaterHelper(QObject *parent) : AbstractUAVObjectHelper(parent)
+UAVObjectUpdaterHelper::UAVObjectUpdaterHelper(QObject *parent, bool allInstances) : AbstractUAVObjectHelper(parent),
+    m_allInstances(allInstances)
 {}
 
 UAVObjectUpdaterHelper::~UAVObjectUpdaterHelper()
@@ -94,7 +95,11 @@ UAVObjectUpdaterHelper::~UAVObjectUpdaterHelper()
 
 void UAVObjectUpdaterHelper::doObjectAndWaitImpl()
 {
-    m_object->updated();
+    if (m_allInstances) {
+        m_object->updatedAll();
+    } else {
+        m_object->updated();
+    }
 }
 
 UAVObjectRequestHelper::UAVObjectRequestHelper(QObject *parent) : AbstractUAVObjectHelper(parent)
@@ -107,3 +112,173 @@ void UAVObjectRequestHelper::doObjectAndWaitImpl()
 {
     m_object->requestUpdate();
 }
+
+UAVObjectTransactionGroup::UAVObjectTransactionGroup(Mode mode, QObject *parent) : QObject(parent),
+    m_mode(mode), m_next(0), m_done(0), m_running(false), m_result(AbstractUAVObjectHelper::SUCCESS)
+{}
+
+UAVObjectTransactionGroup::~UAVObjectTransactionGroup()
+{}
+
+void UAVObjectTransactionGroup::addUpdate(UAVObject *object, bool allInstances, int timeout)
+{
+    Transaction transaction = { allInstances ? UPDATE_ALL : UPDATE, object, NULL, timeout, NULL, false };
+
+    m_transactions << transaction;
+}
+
+void UAVObjectTransactionGroup::addRequest(UAVObject *object, int timeout)
+{
+    Transaction transaction = { REQUEST, object, NULL, timeout, NULL, false };
+
+    m_transactions << transaction;
+}
+
+void UAVObjectTransactionGroup::addGroup(UAVObjectTransactionGroup *group)
+{
+    Transaction transaction = { GROUP, NULL, group, 0, NULL, false };
+
+    group->setParent(this);
+    connect(group, SIGNAL(finished(AbstractUAVObjectHelper::Result)), this, SLOT(groupFinished(AbstractUAVObjectHelper::Result)));
+    m_transactions << transaction;
+}
+
+void UAVObjectTransactionGroup::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_done    = 0;
+    m_result  = AbstractUAVObjectHelper::SUCCESS;
+
+    if (m_transactions.isEmpty()) {
+        m_running = false;
+        emit finished(m_result);
+    } else if (m_mode == PARALLEL) {
+        m_next = m_transactions.count();
+        for (int i = 0; i < m_transactions.count(); i++) {
+            startTransaction(i);
+        }
+    } else {
+        m_next = 1;
+        startTransaction(0);
+    }
+}
+
+bool UAVObjectTransactionGroup::isRunning() const
+{
+    return m_running;
+}
+
+AbstractUAVObjectHelper::Result UAVObjectTransactionGroup::result() const
+{
+    return m_result;
+}
+
+AbstractUAVObjectHelper::Result UAVObjectTransactionGroup::exec()
+{
+    QEventLoop eventLoop;
+
+    connect(this, SIGNAL(finished(AbstractUAVObjectHelper::Result)), &eventLoop, SLOT(quit()));
+    start();
+    if (m_running) {
+        eventLoop.exec();
+    }
+    return m_result;
+}
+
+void UAVObjectTransactionGroup::startTransaction(int index)
+{
+    Transaction &transaction = m_transactions[index];
+
+    transaction.running = true;
+
+    if (transaction.op == GROUP) {
+        transaction.group->start();
+        return;
+    }
+
+    if (!transaction.timer) {
+        transaction.timer = new QTimer(this);
+        transaction.timer->setSingleShot(true);
+        connect(transaction.timer, SIGNAL(timeout()), this, SLOT(transactionTimeout()));
+    }
+    connect(transaction.object, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    transaction.timer->start(transaction.timeout);
+
+    // the transaction can complete right away, nothing of it is used past this point
+    switch (transaction.op) {
+    case UPDATE_ALL:
+        transaction.object->updatedAll();
+        break;
+    case REQUEST:
+        transaction.object->requestUpdate();
+        break;
+    default:
+        transaction.object->updated();
+        break;
+    }
+}
+
+void UAVObjectTransactionGroup::finishTransaction(int index, AbstractUAVObjectHelper::Result result)
+{
+    Transaction &transaction = m_transactions[index];
+
+    transaction.running = false;
+    if (transaction.timer) {
+        transaction.timer->stop();
+        disconnect(transaction.object, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    }
+
+    m_done++;
+    if (result != AbstractUAVObjectHelper::SUCCESS && m_result == AbstractUAVObjectHelper::SUCCESS) {
+        m_result = result;
+    }
+    emit progress(m_done, m_transactions.count());
+
+    if (m_mode == SEQUENCE && m_result == AbstractUAVObjectHelper::SUCCESS && m_next < m_transactions.count()) {
+        startTransaction(m_next++);
+        return;
+    }
+    if (m_mode == PARALLEL && m_done < m_transactions.count()) {
+        return;
+    }
+
+    m_running = false;
+    emit finished(m_result);
+}
+
+void UAVObjectTransactionGroup::transactionCompleted(UAVObject *object, bool success)
+{
+    for (int i = 0; i < m_transactions.count(); i++) {
+        const Transaction &transaction = m_transactions.at(i);
+        if (transaction.running && transaction.op != GROUP && transaction.object == object) {
+            finishTransaction(i, success ? AbstractUAVObjectHelper::SUCCESS : AbstractUAVObjectHelper::FAIL);
+            return;
+        }
+    }
+}
+
+void UAVObjectTransactionGroup::transactionTimeout()
+{
+    for (int i = 0; i < m_transactions.count(); i++) {
+        const Transaction &transaction = m_transactions.at(i);
+        if (transaction.running && transaction.timer == sender()) {
+            finishTransaction(i, AbstractUAVObjectHelper::TIMEOUT);
+            return;
+        }
+    }
+}
+
+void UAVObjectTransactionGroup::groupFinished(AbstractUAVObjectHelper::Result result)
+{
+    for (int i = 0; i < m_transactions.count(); i++) {
+        const Transaction &transaction = m_transactions.at(i);
+        if (transaction.running && transaction.group == sender()) {
+            finishTransaction(i, result);
+            return;
+        }
+    }
+}
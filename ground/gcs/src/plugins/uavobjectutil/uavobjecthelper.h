@@ -32,6 +32,9 @@
 #include <QEventLoop>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QList>
+
+class QTimer;
 
 #include "uavobjectutil_global.h"
 #include "uavobject.h"
@@ -65,11 +68,15 @@ private:
 class UAVOBJECTUTIL_EXPORT UAVObjectUpdaterHelper : public AbstractUAVObjectHelper {
     Q_OBJECT
 public:
-    explicit UAVObjectUpdaterHelper(QObject *parent = 0);
+    // allInstances : send all the instances in one transaction, the object must be instance zero
+    explicit UAVObjectUpdaterHelper(QObject *parent = 0, bool allInstances = false);
     virtual ~UAVObjectUpdaterHelper();
 
 protected:
     virtual void doObjectAndWaitImpl();
+
+private:
+    bool m_allInstances;
 };
 
 class UAVOBJECTUTIL_EXPORT UAVObjectRequestHelper : public AbstractUAVObjectHelper {
@@ -82,4 +89,64 @@ protected:
     virtual void doObjectAndWaitImpl();
 };
 
+/*
+ * Non blocking transactions, without nested event loops.
+ * A group runs its transactions and sub groups one after the other (SEQUENCE, stops at the
+ * first failure) or all at once (PARALLEL, the objects must differ) and emits finished().
+ * The result is the one of the first transaction that did not succeed.
+ */
+class UAVOBJECTUTIL_EXPORT UAVObjectTransactionGroup : public QObject {
+    Q_OBJECT
+public:
+    enum Mode { SEQUENCE, PARALLEL };
+
+    explicit UAVObjectTransactionGroup(Mode mode = SEQUENCE, QObject *parent = 0);
+    virtual ~UAVObjectTransactionGroup();
+
+    // allInstances : send all the instances in one transaction, the object must be instance zero
+    void addUpdate(UAVObject *object, bool allInstances = false, int timeout = 800);
+    void addRequest(UAVObject *object, int timeout = 800);
+    // takes ownership of the group
+    void addGroup(UAVObjectTransactionGroup *group);
+
+    void start();
+    bool isRunning() const;
+    AbstractUAVObjectHelper::Result result() const;
+
+    // starts the group and blocks until it is finished, for callers that are not asynchronous yet
+    // it spins a single event loop for the whole group
+    AbstractUAVObjectHelper::Result exec();
+
+signals:
+    void progress(int done, int total);
+    void finished(AbstractUAVObjectHelper::Result result);
+
+private slots:
+    void transactionCompleted(UAVObject *object, bool success);
+    void transactionTimeout();
+    void groupFinished(AbstractUAVObjectHelper::Result result);
+
+private:
+    enum Operation { UPDATE, UPDATE_ALL, REQUEST, GROUP };
+
+    typedef struct {
+        Operation op;
+        UAVObject *object;
+        UAVObjectTransactionGroup *group;
+        int timeout;
+        QTimer    *timer;
+        bool running;
+    } Transaction;
+
+    void startTransaction(int index);
+    void finishTransaction(int index, AbstractUAVObjectHelper::Result result);
+
+    Mode m_mode;
+    QList<Transaction> m_transactions;
+    int m_next;
+    int m_done;
+    bool m_running;
+    AbstractUAVObjectHelper::Result m_result;
+};
+
 #endif // UAVOBJECTHELPER_H
@@ -34,11 +34,19 @@
 #include "firmwareiapobj.h"
 #include "homelocation.h"
 #include "gpspositionsensor.h"
+#include "uavmetaobject.h"
+
+#include <coreplugin/icore.h>
 
 #include <QMutexLocker>
 #include <QDebug>
 #include <QEventLoop>
 #include <QTimer>
+#include <QSettings>
+#include <string.h>
+
+// settings group of the metadata profiles, see saveMetadataProfile()
+#define METADATA_PROFILES_GROUP "MetadataProfiles"
 
 // ******************************
 // constructor/destructor
@@ -46,7 +54,11 @@
 UAVObjectUtilManager::UAVObjectUtilManager()
 {
     mutex     = new QMutex(QMutex::Recursive);
-    saveState = IDLE;
+    saveState    = IDLE;
+    batchActive  = false;
+    batchSuccess = true;
+    batchDone    = 0;
+    batchTotal   = 0;
     failureTimer.stop();
     failureTimer.setSingleShot(true);
     failureTimer.setInterval(1000);
@@ -162,11 +174,10 @@ void UAVObjectUtilManager::objectPersistenceTransactionCompleted(UAVObject *obj,
     } else {
         // Can be caused by timeout errors on sending.  Forget it and send next.
         qDebug() << "objectPersistenceTranscationCompleted (error)";
-        UAVObject *obj = getObjectManager()->getObject(ObjectPersistence::NAME);
         obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it failed anyway.
+        UAVObject *savingObj = queue.dequeue(); // We can now remove the object, it failed anyway.
         saveState = IDLE;
-        emit saveCompleted(obj->getField("ObjectID")->getValue().toInt(), false);
+        completeSave(savingObj, false);
         saveNextObject();
     }
 }
@@ -191,7 +202,7 @@ void UAVObjectUtilManager::objectPersistenceOperationFailed()
         objectPersistence->disconnect(this);
 
         saveState = IDLE;
-        emit saveCompleted(obj->getObjID(), false);
+        completeSave(obj, false);
 
         saveNextObject();
     }
@@ -226,11 +237,258 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
         queue.dequeue(); // We can now remove the object, it's done.
         saveState = IDLE;
 
-        emit saveCompleted(objectPersistence.ObjectID, true);
+        completeSave(savingObj, true);
         saveNextObject();
     }
 }
 
+void UAVObjectUtilManager::completeSave(UAVObject *obj, bool success)
+{
+    emit saveCompleted(obj->getObjID(), success);
+
+    if (batchSaving.remove(obj)) {
+        batchSuccess &= success;
+        emit batchProgress(++batchDone, batchTotal);
+        checkBatchCompleted();
+    }
+}
+
+/**
+ * @brief Upload a list of objects to the board and save the settings objects among them.
+ *
+ * Unlike uploading and saving one object after the other, the uploads are pipelined
+ * with up to MAX_UPLOADS_IN_FLIGHT outstanding transactions and every settings object
+ * is queued for saving as soon as its upload is acknowledged, so the saves of the first
+ * objects overlap with the uploads of the remaining ones.
+ * The ObjectPersistence requests themselves stay one at a time, the board only has a
+ * single ObjectPersistence object to take them.
+ *
+ * The objects still holding the data last acknowledged by the board are not uploaded again.
+ *
+ * saveCompleted() is still emitted for each saved object, batchCompleted() is emitted
+ * once after every object of the batch has been uploaded and saved, or has failed.
+ */
+void UAVObjectUtilManager::saveObjectsToSD(const QList<UAVObject *> &objects)
+{
+    enqueueBatch(objects, true);
+}
+
+/**
+ * @brief Upload a list of objects to the board without saving them, as one pipelined batch.
+ * @see saveObjectsToSD()
+ */
+void UAVObjectUtilManager::uploadObjects(const QList<UAVObject *> &objects)
+{
+    enqueueBatch(objects, false);
+}
+
+/**
+ * @brief Set the metadata of many objects and send them to the board as one pipelined batch.
+ *
+ * Only the metadata that differ from the current ones are set, they are not sent one by one
+ * as they are set but uploaded (and saved when save is true) by the batch, see saveObjectsToSD().
+ * Returns the number of metaobjects sent.
+ */
+int UAVObjectUtilManager::applyMetadata(const QHash<UAVDataObject *, UAVObject::Metadata> &metadata, bool save)
+{
+    QList<UAVObject *> changed;
+
+    for (QHash<UAVDataObject *, UAVObject::Metadata>::const_iterator i = metadata.constBegin(); i != metadata.constEnd(); ++i) {
+        UAVMetaObject *mobj = i.key() ? i.key()->getMetaObject() : NULL;
+        if (!mobj) {
+            continue;
+        }
+        UAVObject::Metadata current = mobj->getData();
+        if (memcmp(&current, &i.value(), sizeof(current)) == 0) {
+            continue;
+        }
+        mobj->setData(i.value(), false);
+        changed.append(mobj);
+    }
+    if (!changed.isEmpty()) {
+        enqueueBatch(changed, save);
+    }
+    return changed.size();
+}
+
+QStringList UAVObjectUtilManager::metadataProfiles() const
+{
+    QSettings settings;
+
+    settings.beginGroup(METADATA_PROFILES_GROUP);
+    QStringList profiles = settings.childGroups();
+    settings.endGroup();
+    return profiles;
+}
+
+/**
+ * @brief Keep the current metadata of all the objects as a named profile, replacing
+ * the profile of the same name.
+ */
+void UAVObjectUtilManager::saveMetadataProfile(const QString &name)
+{
+    QSettings settings;
+
+    settings.beginGroup(METADATA_PROFILES_GROUP);
+    settings.remove(name);
+    settings.beginGroup(name);
+    foreach(QList<UAVDataObject *> list, obm->getDataObjects()) {
+        // the instances share the metadata
+        UAVDataObject *obj = list.first();
+        UAVObject::Metadata mdata = obj->getMetadata();
+
+        settings.setValue(obj->getName(), QString("%1 %2 %3 %4").arg(mdata.flags).arg(mdata.flightTelemetryUpdatePeriod)
+                          .arg(mdata.gcsTelemetryUpdatePeriod).arg(mdata.loggingUpdatePeriod));
+    }
+    settings.endGroup();
+    settings.endGroup();
+}
+
+/**
+ * @brief Apply a profile saved with saveMetadataProfile(), see applyMetadata().
+ * Returns the number of metaobjects sent.
+ */
+int UAVObjectUtilManager::applyMetadataProfile(const QString &name, bool save)
+{
+    QSettings settings;
+    QHash<UAVDataObject *, UAVObject::Metadata> metadata;
+
+    settings.beginGroup(METADATA_PROFILES_GROUP);
+    settings.beginGroup(name);
+    foreach(QString objName, settings.childKeys()) {
+        UAVDataObject *obj  = dynamic_cast<UAVDataObject *>(obm->getObject(objName));
+        QStringList values = settings.value(objName).toString().split(' ');
+
+        if (!obj || values.size() != 4) {
+            continue;
+        }
+        UAVObject::Metadata mdata;
+        mdata.flags = values.at(0).toUShort();
+        mdata.flightTelemetryUpdatePeriod = values.at(1).toUShort();
+        mdata.gcsTelemetryUpdatePeriod    = values.at(2).toUShort();
+        mdata.loggingUpdatePeriod = values.at(3).toUShort();
+        metadata.insert(obj, mdata);
+    }
+    settings.endGroup();
+    settings.endGroup();
+    return applyMetadata(metadata, save);
+}
+
+void UAVObjectUtilManager::removeMetadataProfile(const QString &name)
+{
+    QSettings settings;
+
+    settings.beginGroup(METADATA_PROFILES_GROUP);
+    settings.remove(name);
+    settings.endGroup();
+}
+
+void UAVObjectUtilManager::enqueueBatch(const QList<UAVObject *> &objects, bool save)
+{
+    if (!batchActive) {
+        batchActive  = true;
+        batchSuccess = true;
+        batchDone    = 0;
+        batchTotal   = 0;
+    }
+    foreach(UAVObject * obj, objects) {
+        if (!obj || batchUploadQueue.contains(obj) || batchUploading.contains(obj)) {
+            continue;
+        }
+        bool persist = save && (obj->isSettingsObject() || obj->isMetaDataObject());
+        if (persist) {
+            batchPersist.insert(obj);
+        }
+        QHash<UAVObject *, QByteArray>::const_iterator known = boardData.constFind(obj);
+        if (known != boardData.constEnd() && known.value() == obj->packedData()) {
+            // the board has it already
+            if (persist) {
+                saveBatchObject(obj);
+            }
+            continue;
+        }
+        batchUploadQueue.enqueue(obj);
+        ++batchTotal;
+    }
+    emit batchProgress(batchDone, batchTotal);
+    uploadNextBatchObjects();
+    checkBatchCompleted();
+}
+
+void UAVObjectUtilManager::saveBatchObject(UAVObject *obj)
+{
+    batchPersist.remove(obj);
+    if (!batchSaving.contains(obj)) {
+        batchSaving.insert(obj);
+        ++batchTotal;
+        saveObjectToSD(obj);
+    }
+}
+
+void UAVObjectUtilManager::uploadNextBatchObjects()
+{
+    while (!batchUploadQueue.isEmpty() && batchUploading.size() < MAX_UPLOADS_IN_FLIGHT) {
+        UAVObject *obj = batchUploadQueue.dequeue();
+        batchUploading.insert(obj, 1);
+        batchSentData.insert(obj, obj->packedData());
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(batchUploadCompleted(UAVObject *, bool)), Qt::UniqueConnection);
+        obj->updated();
+    }
+}
+
+/**
+ * The board sent the object, what it holds is no longer known
+ */
+void UAVObjectUtilManager::boardDataReceived(UAVObject *obj)
+{
+    boardData.remove(obj);
+}
+
+void UAVObjectUtilManager::batchUploadCompleted(UAVObject *obj, bool success)
+{
+    if (!batchUploading.contains(obj)) {
+        return;
+    }
+
+    if (!success) {
+        int attempts = batchUploading.value(obj);
+        if (attempts < MAX_UPLOAD_RETRIES) {
+            qDebug() << "Upload of" << obj->getName() << "failed, retrying.";
+            batchUploading.insert(obj, attempts + 1);
+            obj->updated();
+            return;
+        }
+        qDebug() << "Upload of" << obj->getName() << "failed after" << attempts << "tries.";
+        batchSuccess = false;
+    }
+
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(batchUploadCompleted(UAVObject *, bool)));
+    batchUploading.remove(obj);
+    QByteArray sent = batchSentData.take(obj);
+    emit batchProgress(++batchDone, batchTotal);
+
+    if (success) {
+        boardData.insert(obj, sent);
+        connect(obj, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(boardDataReceived(UAVObject *)), Qt::UniqueConnection);
+        if (batchPersist.contains(obj)) {
+            saveBatchObject(obj);
+        }
+    } else {
+        batchPersist.remove(obj);
+    }
+
+    uploadNextBatchObjects();
+    checkBatchCompleted();
+}
+
+void UAVObjectUtilManager::checkBatchCompleted()
+{
+    if (batchActive && batchUploadQueue.isEmpty() && batchUploading.isEmpty() && batchSaving.isEmpty()) {
+        batchActive = false;
+        emit batchCompleted(batchSuccess);
+    }
+}
+
 /**
  * Helper function that makes sure FirmwareIAP is updated and then returns the data
  */
@@ -44,6 +44,8 @@
 #include <QTimer>
 #include <QMutex>
 #include <QQueue>
+#include <QHash>
+#include <QSet>
 #include <QDateTime>
 
 class UAVOBJECTUTIL_EXPORT UAVObjectUtilManager : public QObject {
@@ -68,19 +70,51 @@ public:
     static bool descriptionToStructure(QByteArray desc, deviceDescriptorStruct & struc);
     UAVObjectManager *getObjectManager();
     void saveObjectToSD(UAVObject *obj);
+    void saveObjectsToSD(const QList<UAVObject *> &objects);
+    void uploadObjects(const QList<UAVObject *> &objects);
+
+    int applyMetadata(const QHash<UAVDataObject *, UAVObject::Metadata> &metadata, bool save);
+    // named sets of the metadata of all objects (update rates and modes), kept in the GCS settings
+    QStringList metadataProfiles() const;
+    void saveMetadataProfile(const QString &name);
+    int applyMetadataProfile(const QString &name, bool save);
+    void removeMetadataProfile(const QString &name);
 protected:
     FirmwareIAPObj::DataFields getFirmwareIap();
 
 signals:
     void saveCompleted(int objectID, bool status);
+    void batchCompleted(bool status);
+    // uploads and saves of the current batch done (failed included) and to do
+    void batchProgress(int done, int total);
 
 private:
     QMutex *mutex;
     QQueue<UAVObject *> queue;
     enum { IDLE, AWAITING_ACK, AWAITING_COMPLETED } saveState;
     void saveNextObject();
+    void completeSave(UAVObject *obj, bool success);
     QTimer failureTimer;
 
+    // batch upload and save, see saveObjectsToSD()
+    static const int MAX_UPLOADS_IN_FLIGHT = 4;
+    static const int MAX_UPLOAD_RETRIES    = 3;
+    QQueue<UAVObject *> batchUploadQueue;
+    QHash<UAVObject *, int> batchUploading; // object, attempts
+    QHash<UAVObject *, QByteArray> batchSentData;
+    QSet<UAVObject *> batchPersist; // to save once uploaded
+    QSet<UAVObject *> batchSaving;
+    bool batchActive;
+    bool batchSuccess;
+    int batchDone;
+    int batchTotal;
+    // data the board acknowledged, until the board sends the object, see enqueueBatch()
+    QHash<UAVObject *, QByteArray> boardData;
+    void enqueueBatch(const QList<UAVObject *> &objects, bool save);
+    void saveBatchObject(UAVObject *obj);
+    void uploadNextBatchObjects();
+    void checkBatchCompleted();
+
     ExtensionSystem::PluginManager *pm;
     UAVObjectManager *obm;
     UAVObjectUtilManager *obum;
@@ -90,6 +124,8 @@ private slots:
     void objectPersistenceTransactionCompleted(UAVObject *obj, bool success);
     void objectPersistenceUpdated(UAVObject *obj);
     void objectPersistenceOperationFailed();
+    void batchUploadCompleted(UAVObject *obj, bool success);
+    void boardDataReceived(UAVObject *obj);
 };
 
 
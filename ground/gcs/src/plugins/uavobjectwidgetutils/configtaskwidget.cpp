@@ -28,6 +28,7 @@
 #include "configtaskwidget.h"
 
 #include <coreplugin/generalsettings.h>
+#include <coreplugin/framescheduler.h>
 #include "uavobjectmanager.h"
 #include "uavobject.h"
 #include "uavobjectutilmanager.h"
@@ -51,6 +52,7 @@
 
 ConfigTaskWidget::ConfigTaskWidget(QWidget *parent, ConfigTaskType configType) : QWidget(parent),
     m_currentBoardId(-1), m_isConnected(false), m_isWidgetUpdatesAllowed(true), m_isDirty(false), m_refreshing(false),
+    m_suspendRefreshWhenHidden(false), m_pendingRefreshAll(false),
     m_wikiURL("Welcome"), m_saveButton(NULL), m_outOfLimitsStyle("background-color: rgb(255, 0, 0);"), m_realtimeUpdateTimer(NULL)
 {
     m_configType        = configType;
@@ -147,7 +149,7 @@ int ConfigTaskWidget::fieldIndexFromElementName(QString objectName, QString fiel
     UAVObjectField *field = object->getField(fieldName);
     Q_ASSERT(field);
 
-    return field->getElementNames().indexOf(elementName);
+    return field->getElementIndex(elementName);
 }
 
 void ConfigTaskWidget::addWidgetBinding(QString objectName, QString fieldName, QWidget *widget, QString elementName)
@@ -210,7 +212,7 @@ void ConfigTaskWidget::doAddWidgetBinding(QString objectName, QString fieldName,
         Q_ASSERT(object);
         m_updatedObjects.insert(object, true);
         connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectUpdated(UAVObject *)));
-        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)), Qt::UniqueConnection);
+        connect(object, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectChanged(UAVObject *)), Qt::UniqueConnection);
     }
 
     if (!fieldName.isEmpty() && object) {
@@ -225,6 +227,9 @@ void ConfigTaskWidget::doAddWidgetBinding(QString objectName, QString fieldName,
 
     if (object) {
         m_widgetBindingsPerObject.insert(object, binding);
+        if (field) {
+            m_widgetBindingsPerField.insert(field, binding);
+        }
         if (m_saveButton) {
             m_saveButton->addObject((UAVDataObject *)object);
         }
@@ -386,24 +391,66 @@ void ConfigTaskWidget::onDisconnect()
     m_currentBoardId = -1;
 }
 
+void ConfigTaskWidget::setSuspendRefreshWhenHidden(bool suspend)
+{
+    m_suspendRefreshWhenHidden = suspend;
+    if (!suspend) {
+        refreshPending();
+    }
+}
+
+void ConfigTaskWidget::refreshPending()
+{
+    bool suspend = m_suspendRefreshWhenHidden;
+
+    m_suspendRefreshWhenHidden = false;
+    if (m_pendingRefreshAll) {
+        m_pendingRefreshAll = false;
+        m_pendingRefreshObjects.clear();
+        refreshWidgetsValues(NULL);
+    } else if (!m_pendingRefreshObjects.isEmpty()) {
+        QSet<UAVObject *> objects = m_pendingRefreshObjects;
+        m_pendingRefreshObjects.clear();
+        foreach(UAVObject * object, objects) {
+            refreshWidgetsValues(object);
+        }
+    }
+    m_suspendRefreshWhenHidden = suspend;
+}
+
 void ConfigTaskWidget::refreshWidgetsValues(UAVObject *obj)
 {
     if (!m_isWidgetUpdatesAllowed) {
         return;
     }
 
+    // A hidden widget only remembers what to refresh, it catches up when shown
+    if (m_suspendRefreshWhenHidden && !isVisible()) {
+        if (obj == NULL) {
+            m_pendingRefreshAll = true;
+        } else {
+            m_pendingRefreshObjects.insert(obj);
+        }
+        return;
+    }
+
     bool isRefreshing = m_refreshing;
     m_refreshing = true;
 
+    // the widgets are set from the live data, a change coming meanwhile is refreshed again
+    if (obj == NULL) {
+        m_changedObjects.clear();
+        foreach(UAVObject * object, m_widgetBindingsPerObject.uniqueKeys()) {
+            m_refreshSequences.insert(object, object->getChangeSequence());
+        }
+    } else {
+        m_changedObjects.remove(obj);
+        m_refreshSequences.insert(obj, obj->getChangeSequence());
+    }
+
     QList<WidgetBinding *> bindings = obj == NULL ? m_widgetBindingsPerObject.values() : m_widgetBindingsPerObject.values(obj);
     foreach(WidgetBinding * binding, bindings) {
-        if (binding->field() && binding->widget()) {
-            if (binding->isEnabled()) {
-                setWidgetFromField(binding->widget(), binding->field(), binding);
-            } else {
-                binding->updateValueFromObjectField();
-            }
-        }
+        refreshBinding(binding);
     }
 
     // call specific implementation
@@ -412,8 +459,82 @@ void ConfigTaskWidget::refreshWidgetsValues(UAVObject *obj)
     m_refreshing = isRefreshing;
 }
 
+void ConfigTaskWidget::refreshBinding(WidgetBinding *binding)
+{
+    if (binding->field() && binding->widget()) {
+        if (binding->isEnabled()) {
+            setWidgetFromField(binding->widget(), binding->field(), binding);
+        } else {
+            binding->updateValueFromObjectField();
+        }
+    }
+}
+
+/**
+ * Called on each update of a bound object, the refresh waits for the next displayed frame
+ */
+void ConfigTaskWidget::objectChanged(UAVObject *object)
+{
+    if (!m_isWidgetUpdatesAllowed) {
+        return;
+    }
+    if (m_changedObjects.isEmpty()) {
+        Core::FrameScheduler::post(this, "refreshChangedObjects");
+    }
+    m_changedObjects.insert(object);
+}
+
+void ConfigTaskWidget::refreshChangedObjects()
+{
+    QSet<UAVObject *> objects;
+
+    objects.swap(m_changedObjects);
+    foreach(UAVObject * object, objects) {
+        refreshChangedFields(object);
+    }
+}
+
+/**
+ * Refresh the widgets of the fields changed since the last refresh of an object
+ */
+void ConfigTaskWidget::refreshChangedFields(UAVObject *object)
+{
+    // unsaved edits are reverted by any update of their object, as a full refresh does
+    if (!m_isWidgetUpdatesAllowed || m_isDirty || (m_suspendRefreshWhenHidden && !isVisible())) {
+        refreshWidgetsValues(object);
+        return;
+    }
+
+    bool isRefreshing = m_refreshing;
+    m_refreshing = true;
+
+    quint32 sequence = object->getChangeSequence();
+    quint64 changed  = object->getChangedFields(m_refreshSequences.value(object));
+    m_refreshSequences.insert(object, sequence);
+
+    if (changed) {
+        QList<UAVObjectField *> fields = object->getFields();
+        for (int n = 0; n < fields.length(); ++n) {
+            if (changed & ((quint64)1 << qMin(n, 63))) {
+                foreach(WidgetBinding * binding, m_widgetBindingsPerField.values(fields[n])) {
+                    refreshBinding(binding);
+                }
+            }
+        }
+    }
+
+    // call specific implementation, it may use more than the bound fields
+    refreshWidgetsValuesImpl(object);
+
+    m_refreshing = isRefreshing;
+}
+
 void ConfigTaskWidget::updateObjectsFromWidgets()
 {
+    // don't write back widget values that missed an object update
+    refreshChangedObjects();
+    refreshPending();
+
     foreach(WidgetBinding * binding, m_widgetBindingsPerObject) {
         if (binding->object() && binding->field()) {
             binding->updateObjectFieldFromValue();
@@ -557,7 +678,7 @@ void ConfigTaskWidget::disableObjectUpdates()
     m_isWidgetUpdatesAllowed = false;
     foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
         if (binding->object()) {
-            disconnect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)));
+            disconnect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectChanged(UAVObject *)));
         }
     }
 }
@@ -567,7 +688,7 @@ void ConfigTaskWidget::enableObjectUpdates()
     m_isWidgetUpdatesAllowed = true;
     foreach(WidgetBinding * binding, m_widgetBindingsPerWidget) {
         if (binding->object()) {
-            connect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(refreshWidgetsValues(UAVObject *)), Qt::UniqueConnection);
+            connect(binding->object(), SIGNAL(objectUpdated(UAVObject *)), this, SLOT(objectChanged(UAVObject *)), Qt::UniqueConnection);
         }
     }
 }
@@ -828,6 +949,8 @@ void ConfigTaskWidget::defaultButtonClicked()
         }
         UAVDataObject *temp = ((UAVDataObject *)binding->object())->dirtyClone();
         setWidgetFromField(binding->widget(), temp->getField(binding->field()->getName()), binding);
+        // the clone owns its fields
+        delete temp;
     }
 }
 
@@ -1182,7 +1305,7 @@ void ConfigTaskWidget::buildOptionComboBox(QComboBox *combo, UAVObjectField *fie
     for (int optionIndex = 0; optionIndex < options.count(); optionIndex++) {
         if (applyLimits) {
             // qDebug() << "     " << options.at(optionIndex) << field->isWithinLimits(options.at(optionIndex), index, m_currentBoardId);
-            if (m_currentBoardId > -1 && field->isWithinLimits(options.at(optionIndex), index, m_currentBoardId)) {
+            if (m_currentBoardId > -1 && field->isWithinLimits(optionIndex, index, m_currentBoardId)) {
                 combo->addItem(options.at(optionIndex), QVariant(optionIndex));
             }
         } else {
@@ -1221,6 +1344,14 @@ bool ConfigTaskWidget::eventFilter(QObject *obj, QEvent *evt)
     return QWidget::eventFilter(obj, evt);
 }
 
+bool ConfigTaskWidget::event(QEvent *evt)
+{
+    if (evt->type() == QEvent::Show) {
+        refreshPending();
+    }
+    return QWidget::event(evt);
+}
+
 WidgetBinding::WidgetBinding(QWidget *widget, UAVObject *object, UAVObjectField *field, int index, double scale, bool isLimited) :
     ShadowWidgetBinding(widget, scale, isLimited), m_isEnabled(true)
 {
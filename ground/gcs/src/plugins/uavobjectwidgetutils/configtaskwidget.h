@@ -31,6 +31,7 @@
 
 #include <QWidget>
 #include <QList>
+#include <QSet>
 #include <QVariant>
 
 namespace ExtensionSystem {
@@ -107,6 +108,9 @@ public:
 
     void bind();
 
+    // defer the refresh of the widgets from object updates while hidden
+    void setSuspendRefreshWhenHidden(bool suspend);
+
     bool isDirty();
     void setDirty(bool value);
     void clearDirty();
@@ -123,6 +127,7 @@ protected:
 
     void disableMouseWheelEvents();
     bool eventFilter(QObject *obj, QEvent *evt);
+    bool event(QEvent *evt);
 
     UAVObjectManager *getObjectManager();
 
@@ -204,6 +209,8 @@ private slots:
     void disableObjectUpdates();
     void enableObjectUpdates();
     void objectUpdated(UAVObject *object);
+    void objectChanged(UAVObject *object);
+    void refreshChangedObjects();
     void invalidateObjects();
 
     void saveSuccessful();
@@ -247,6 +254,19 @@ private:
     bool m_isDirty;
     bool m_refreshing;
 
+    // refreshes deferred while hidden
+    bool m_suspendRefreshWhenHidden;
+    bool m_pendingRefreshAll;
+    QSet<UAVObject *> m_pendingRefreshObjects;
+    void refreshPending();
+
+    // object updates are coalesced to the display rate, and only the widgets of the changed fields are refreshed
+    QSet<UAVObject *> m_changedObjects;
+    // change sequence of each object as of its last refresh, see UAVObject::getChangedFields()
+    QHash<UAVObject *, quint32> m_refreshSequences;
+    void refreshChangedFields(UAVObject *object);
+    void refreshBinding(WidgetBinding *binding);
+
     QStringList m_objects;
 
     // Wiki address for help button (will be concatenated with WIKI_URL_ROOT)
@@ -255,6 +275,7 @@ private:
     QMultiHash<int, WidgetBinding *> m_reloadGroups;
     QMultiHash<QWidget *, WidgetBinding *> m_widgetBindingsPerWidget;
     QMultiHash<UAVObject *, WidgetBinding *> m_widgetBindingsPerObject;
+    QMultiHash<UAVObjectField *, WidgetBinding *> m_widgetBindingsPerField;
 
     ExtensionSystem::PluginManager *m_pluginManager;
     UAVObjectUtilManager *m_objectUtilManager;
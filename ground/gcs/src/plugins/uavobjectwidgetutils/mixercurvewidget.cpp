@@ -223,9 +223,11 @@ void MixerCurveWidget::setCurve(const QList<double> *points)
 {
     m_curveUpdating = true;
 
-    int ptCnt = points->count();
+    bool changed = false;
+    int ptCnt    = points->count();
     if (m_nodeList.count() != ptCnt) {
         initNodes(ptCnt);
+        changed = true;
     }
 
     double range = m_curveMax - m_curveMin;
@@ -239,17 +241,23 @@ void MixerCurveWidget::setCurve(const QList<double> *points)
         val -= (m_curveMin + range);
         val /= range;
 
+        // Only touch the nodes that actually moved, setPos() repaints the node
+        // and adjusts its two edges so there is no need to redraw the whole scene.
         MixerNode *node = m_nodeList.at(i);
-        node->setPos(w * i, h - (val * h));
+        QPointF pos(w * i, h - (val * h));
+        if (node->pos() != pos) {
+            node->setPos(pos);
+            changed = true;
+        }
         node->verticalMove(true);
-
-        node->update();
     }
     m_curveUpdating = false;
 
-    update();
-
-    emit curveUpdated();
+    // Refreshes from object updates usually carry the same values, don't
+    // ripple those through the settings table and dirty tracking.
+    if (changed) {
+        emit curveUpdated();
+    }
 }
 
 void MixerCurveWidget::showEvent(QShowEvent *event)
@@ -27,7 +27,7 @@
 #include "smartsavebutton.h"
 #include "configtaskwidget.h"
 
-SmartSaveButton::SmartSaveButton(ConfigTaskWidget *configTaskWidget) : configWidget(configTaskWidget)
+SmartSaveButton::SmartSaveButton(ConfigTaskWidget *configTaskWidget) : progressButton(NULL), configWidget(configTaskWidget)
 {}
 
 void SmartSaveButton::addApplyButton(QPushButton *apply)
@@ -70,6 +70,7 @@ void SmartSaveButton::processOperation(QPushButton *button, bool save)
     bool error = false;
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectUtilManager *utilMngr     = pm->getObject<UAVObjectUtilManager>();
+    QList<UAVObject *> batchList;
     foreach(UAVDataObject * obj, objects) {
         if (!obj) {
             continue;
@@ -82,61 +83,44 @@ void SmartSaveButton::processOperation(QPushButton *button, bool save)
             continue;
         }
 
-        up_result = false;
-        current_object = obj;
-        for (int i = 0; i < 3; ++i) {
-            qDebug() << "Uploading" << obj->getName() << "to board.";
-            connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transaction_finished(UAVObject *, bool)));
-            connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-            obj->updated();
+        batchList.append(obj);
+    }
+    if (!batchList.isEmpty()) {
+        // all the objects go in one pipelined burst, the unchanged ones are skipped
+        qDebug() << (save ? "Uploading and saving" : "Uploading") << batchList.size() << "objects to board.";
+        sv_result = false;
+        batchDone = false;
+        progressButton = button;
+        progressText   = button ? button->text() : QString();
+        connect(utilMngr, SIGNAL(batchCompleted(bool)), this, SLOT(batch_saving_finished(bool)));
+        connect(utilMngr, SIGNAL(batchProgress(int, int)), this, SLOT(batch_progress(int, int)));
+        connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+        if (save) {
+            utilMngr->saveObjectsToSD(batchList);
+        } else {
+            utilMngr->uploadObjects(batchList);
+        }
 
-            timer.start(3000);
+        // same worst case budget as uploading and saving the objects one by one
+        timer.start(3000 * batchList.size());
+        if (!batchDone) {
             loop.exec();
-            if (!timer.isActive()) {
-                qDebug() << "Upload of" << obj->getName() << "timed out.";
-            }
-            timer.stop();
-
-            disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transaction_finished(UAVObject *, bool)));
-            disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-            if (up_result) {
-                qDebug() << "Upload of" << obj->getName() << "successful.";
-                break;
-            }
         }
-        if (up_result == false) {
-            qDebug() << "Upload of" << obj->getName() << "failed after 3 tries.";
-            error = true;
-            continue;
+        if (!timer.isActive()) {
+            qDebug() << "Upload timed out.";
         }
+        timer.stop();
 
-        sv_result = false;
-        current_objectID = obj->getObjID();
-        if (save && (obj->isSettingsObject())) {
-            for (int i = 0; i < 3; ++i) {
-                qDebug() << "Saving" << obj->getName() << "to board.";
-                connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
-                connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-                utilMngr->saveObjectToSD(obj);
-
-                timer.start(3000);
-                loop.exec();
-                if (!timer.isActive()) {
-                    qDebug() << "Saving of" << obj->getName() << "timed out.";
-                }
-                timer.stop();
-
-                disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
-                disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-                if (sv_result) {
-                    qDebug() << "Saving of" << obj->getName() << "successful.";
-                    break;
-                }
-            }
-            if (sv_result == false) {
-                qDebug() << "Saving of" << obj->getName() << "failed after 3 tries.";
-                error = true;
-            }
+        disconnect(utilMngr, SIGNAL(batchCompleted(bool)), this, SLOT(batch_saving_finished(bool)));
+        disconnect(utilMngr, SIGNAL(batchProgress(int, int)), this, SLOT(batch_progress(int, int)));
+        disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+        if (button) {
+            button->setText(progressText);
+        }
+        progressButton = NULL;
+        if (!sv_result) {
+            qDebug() << (save ? "Saving to board failed." : "Upload to board failed.");
+            error = true;
         }
     }
     emit endOp();
@@ -184,19 +168,18 @@ void SmartSaveButton::clearObjects()
     objects.clear();
 }
 
-void SmartSaveButton::transaction_finished(UAVObject *obj, bool result)
+void SmartSaveButton::batch_saving_finished(bool result)
 {
-    if (current_object == obj) {
-        up_result = result;
-        loop.quit();
-    }
+    sv_result = result;
+    batchDone = true;
+    loop.quit();
 }
 
-void SmartSaveButton::saving_finished(int id, bool result)
+void SmartSaveButton::batch_progress(int done, int total)
 {
-    if (id == (int)current_objectID) {
-        sv_result = result;
-        loop.quit();
+    emit progress(done, total);
+    if (progressButton && total > 0) {
+        progressButton->setText(QString("%1 %2/%3").arg(progressText).arg(done).arg(total));
     }
 }
 
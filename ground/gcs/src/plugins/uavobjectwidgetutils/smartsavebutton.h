@@ -60,6 +60,8 @@ signals:
     void saveSuccessful();
     void beginOp();
     void endOp();
+    // uploads and saves done of the current operation
+    void progress(int done, int total);
 
 public slots:
     void apply();
@@ -68,14 +70,15 @@ public slots:
 private slots:
     void processClick();
     void processOperation(QPushButton *button, bool save);
-    void transaction_finished(UAVObject *obj, bool result);
-    void saving_finished(int, bool);
+    void batch_saving_finished(bool);
+    void batch_progress(int done, int total);
 
 private:
-    quint32 current_objectID;
-    UAVDataObject *current_object;
-    bool up_result;
     bool sv_result;
+    bool batchDone;
+    // button of the operation in progress, its text shows the progress
+    QPushButton *progressButton;
+    QString progressText;
     QEventLoop loop;
     QList<UAVDataObject *> objects;
     QMap<QPushButton *, buttonTypeEnum> buttonList;
@@ -70,9 +70,10 @@ void ImportSummaryDialog::openHelp()
 
 /*
    Adds a new line about a UAVObject along with its status
-   (whether it got saved OK or not)
+   (whether it got saved OK or not). Objects that can be saved are
+   only ticked for saving when selected is set.
  */
-void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool status)
+void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool status, bool selected)
 {
     ui->importSummaryList->setRowCount(ui->importSummaryList->rowCount() + 1);
     int row = ui->importSummaryList->rowCount() - 1;
@@ -87,7 +88,7 @@ void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool stat
     ui->importSummaryList->item(row, 2)->setFlags(ui->importSummaryList->item(row, 2)->flags() &= ~Qt::ItemIsEditable);
 
     if (status) {
-        box->setChecked(true);
+        box->setChecked(selected);
     } else {
         box->setChecked(false);
         box->setEnabled(false);
@@ -45,7 +45,7 @@ class ImportSummaryDialog : public QDialog {
 public:
     ImportSummaryDialog(QWidget *parent = 0);
     ~ImportSummaryDialog();
-    void addLine(QString objectName, QString text, bool status);
+    void addLine(QString objectName, QString text, bool status, bool selected = true);
 
 protected:
     void showEvent(QShowEvent *event);
@@ -160,6 +160,7 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                 // - Issue and "updated" command
                 bool error     = false;
                 bool setError  = false;
+                QByteArray before = obj->packedData();
                 QDomNode field = node.firstChild();
                 while (!field.isNull()) {
                     QDomElement f = field.toElement();
@@ -194,7 +195,12 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                     }
                     field = field.nextSibling();
                 }
-                obj->updated();
+                // Only send and offer to save the objects the import actually changed,
+                // re-sending a full settings file takes ages otherwise
+                bool changed = (obj->packedData() != before);
+                if (changed) {
+                    obj->updated();
+                }
 
                 if (error) {
                     swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
@@ -203,6 +209,8 @@ void UAVSettingsImportExportFactory::importUAVSettings()
                     swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true);
                 } else if (setError) {
                     swui.addLine(uavObjectName, "Warning (Objects field value(s) invalid)", false);
+                } else if (!changed) {
+                    swui.addLine(uavObjectName, "OK (unchanged)", true, false);
                 } else {
                     swui.addLine(uavObjectName, "OK", true);
                 }
@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ *
+ * @file       latencyhistogram.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Latency histogram of the telemetry receive path
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "latencyhistogram.h"
+
+#include <chrono>
+#include <string.h>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::add(qint64 us)
+{
+    us = qMax(us, (qint64)0);
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && us >= ((qint64)1 << bucket)) {
+        bucket++;
+    }
+    buckets[bucket]++;
+    total++;
+    maxUs  = qMax(maxUs, us);
+    sumUs += us;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (int i = 0; i < BUCKETS; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    total += other.total;
+    maxUs  = qMax(maxUs, other.maxUs);
+    sumUs += other.sumUs;
+}
+
+void LatencyHistogram::reset()
+{
+    memset(buckets, 0, sizeof(buckets));
+    total = 0;
+    maxUs = 0;
+    sumUs = 0;
+}
+
+/**
+ * Latency under which percent % of the samples are, in microseconds
+ */
+qint64 LatencyHistogram::percentile(int percent) const
+{
+    if (total == 0) {
+        return 0;
+    }
+    quint64 rank  = ((quint64)total * percent + 99) / 100;
+    quint64 count = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        count += buckets[i];
+        if (count >= rank) {
+            // never above the largest sample seen
+            return qMin((qint64)1 << i, maxUs);
+        }
+    }
+    return maxUs;
+}
+
+QString LatencyHistogram::toString() const
+{
+    return QString("p50 %1 / p99 %2 / max %3 ms")
+           .arg(percentile(50) / 1000.0, 0, 'f', 1)
+           .arg(percentile(99) / 1000.0, 0, 'f', 1)
+           .arg(maxUs / 1000.0, 0, 'f', 1);
+}
+
+qint64 LatencyHistogram::timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ *
+ * @file       latencyhistogram.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Latency histogram of the telemetry receive path
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include "uavtalk_global.h"
+
+#include <QtGlobal>
+#include <QString>
+
+/**
+ * Histogram of latencies with power of 2 buckets, bucket n holds the
+ * latencies below 2^n microseconds. Cheap enough to be fed for each
+ * received object, percentiles are given as the bucket upper bound.
+ */
+class UAVTALK_EXPORT LatencyHistogram {
+public:
+    static const int BUCKETS = 24;
+
+    LatencyHistogram();
+
+    void add(qint64 us);
+    void merge(const LatencyHistogram &other);
+    void reset();
+
+    quint32 count() const
+    {
+        return total;
+    }
+    qint64 max() const
+    {
+        return maxUs;
+    }
+    qint64 sum() const
+    {
+        return sumUs;
+    }
+    // samples of a bucket, the last one has no upper bound
+    quint32 bucketCount(int bucket) const
+    {
+        return buckets[bucket];
+    }
+    qint64 percentile(int percent) const;
+
+    // "p50 / p99 / max" in ms
+    QString toString() const;
+
+    // Monotonic time in microseconds (steady clock), shared with the transports
+    static qint64 timestamp();
+
+private:
+    quint32 buckets[BUCKETS];
+    quint32 total;
+    qint64 maxUs;
+    qint64 sumUs;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,239 @@
+/**
+ ******************************************************************************
+ *
+ * @file       metricsserver.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Exports the link health as Prometheus metrics over HTTP
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "metricsserver.h"
+#include "telemetrymanager.h"
+#include "uavobjectmanager.h"
+#include "gcstelemetrystats.h"
+#include "flighttelemetrystats.h"
+
+#include <extensionsystem/pluginmanager.h>
+#include <QDebug>
+#include <QtEndian>
+
+MetricsServer::MetricsServer(TelemetryManager *telemetryManager, QObject *parent) :
+    QTcpServer(parent), m_telemetryManager(telemetryManager)
+{
+    m_objectManager = ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>();
+    connect(this, SIGNAL(newConnection()), this, SLOT(clientConnected()));
+    connect(m_telemetryManager, SIGNAL(latencyUpdated()), this, SLOT(latencyUpdated()));
+}
+
+MetricsServer::~MetricsServer()
+{
+    m_telemetryManager->removeFrameTap(this);
+}
+
+bool MetricsServer::start(quint16 port)
+{
+    if (!listen(QHostAddress::Any, port)) {
+        qWarning() << "MetricsServer - failed to listen on port" << port << ":" << errorString();
+        return false;
+    }
+    qDebug() << "MetricsServer - serving /metrics on port" << serverPort();
+    m_telemetryManager->addFrameTap(this);
+    return true;
+}
+
+void MetricsServer::frame(qint64 timestamp, const quint8 *packet, int length)
+{
+    Q_UNUSED(timestamp);
+
+    if (length < 8) {
+        return;
+    }
+    // taps get v1 packets, the object id follows sync, type and length
+    quint32 objId = qFromLittleEndian<quint32>(&packet[4]);
+    if (objId != 0) {
+        quint32 index = (objId * 2654435761u) & (OBJECT_SLOTS - 1);
+        for (int probe = 0; probe < OBJECT_SLOTS / 4; ++probe) {
+            ObjectCounter &counter = m_objects[(index + probe) & (OBJECT_SLOTS - 1)];
+            quint32 id = counter.objId.loadAcquire();
+            if (id == 0 && counter.objId.testAndSetOrdered(0, objId, id)) {
+                id = objId;
+            }
+            if (id == objId) {
+                counter.packets.fetchAndAddRelaxed(1);
+                counter.bytes.fetchAndAddRelaxed(length);
+                return;
+            }
+        }
+    }
+    m_otherPackets.fetchAndAddRelaxed(1);
+    m_otherBytes.fetchAndAddRelaxed(length);
+}
+
+void MetricsServer::latencyUpdated()
+{
+    UAVTalk::LatencyStats latency = m_telemetryManager->latencyStats();
+
+    m_latency.device.merge(latency.device);
+    m_latency.decode.merge(latency.decode);
+    m_latency.total.merge(latency.total);
+    m_latency.control.merge(latency.control);
+}
+
+void MetricsServer::clientConnected()
+{
+    while (hasPendingConnections()) {
+        QTcpSocket *socket = nextPendingConnection();
+        connect(socket, SIGNAL(readyRead()), this, SLOT(clientReadyRead()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+        m_requests.insert(socket, QByteArray());
+    }
+}
+
+void MetricsServer::clientDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    m_requests.remove(socket);
+    socket->deleteLater();
+}
+
+void MetricsServer::clientReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    QHash<QTcpSocket *, QByteArray>::iterator it = m_requests.find(socket);
+
+    if (it == m_requests.end()) {
+        // answered already
+        socket->readAll();
+        return;
+    }
+    it->append(socket->readAll());
+    if (it->indexOf("\r\n\r\n") < 0) {
+        if (it->size() > MAX_REQUEST_LENGTH) {
+            m_requests.erase(it);
+            socket->abort();
+        }
+        return;
+    }
+
+    // HTTP/1.0 style: one request per connection, closed once answered
+    QList<QByteArray> requestLine = it->left(it->indexOf("\r\n")).split(' ');
+    m_requests.erase(it);
+    QByteArray status;
+    QByteArray body;
+    if (requestLine.size() >= 2 && requestLine.at(0) == "GET" &&
+        (requestLine.at(1) == "/metrics" || requestLine.at(1).startsWith("/metrics?"))) {
+        status = "200 OK";
+        body   = metrics();
+    } else {
+        status = "404 Not Found";
+        body   = "Not found, see /metrics\n";
+    }
+    QByteArray response;
+    response += "HTTP/1.0 " + status + "\r\n";
+    response += "Content-Type: text/plain; version=0.0.4\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+void MetricsServer::appendCounter(QByteArray &out, const char *name, const char *help, const char *type, double value)
+{
+    out += QByteArray("# HELP ") + name + " " + help + "\n";
+    out += QByteArray("# TYPE ") + name + " " + type + "\n";
+    out += QByteArray(name) + " " + QByteArray::number(value, 'g', 15) + "\n";
+}
+
+void MetricsServer::appendHistogram(QByteArray &out, const char *stage, const LatencyHistogram &histogram)
+{
+    // bucket n holds the latencies below 2^n us, the last one is +Inf
+    QByteArray labels = QByteArray("stage=\"") + stage + "\"";
+    quint64 count     = 0;
+
+    for (int i = 0; i < LatencyHistogram::BUCKETS - 1; ++i) {
+        count += histogram.bucketCount(i);
+        out   += "librepilot_telemetry_rx_latency_seconds_bucket{" + labels + ",le=\""
+                 + QByteArray::number(((qint64)1 << i) / 1.0e6, 'g', 6) + "\"} " + QByteArray::number(count) + "\n";
+    }
+    out += "librepilot_telemetry_rx_latency_seconds_bucket{" + labels + ",le=\"+Inf\"} " + QByteArray::number(histogram.count()) + "\n";
+    out += "librepilot_telemetry_rx_latency_seconds_sum{" + labels + "} " + QByteArray::number(histogram.sum() / 1.0e6, 'g', 15) + "\n";
+    out += "librepilot_telemetry_rx_latency_seconds_count{" + labels + "} " + QByteArray::number(histogram.count()) + "\n";
+}
+
+QByteArray MetricsServer::metrics() const
+{
+    QByteArray out;
+
+    GCSTelemetryStats::DataFields gcsStats = GCSTelemetryStats::GetInstance(m_objectManager)->getData();
+    FlightTelemetryStats::DataFields flightStats = FlightTelemetryStats::GetInstance(m_objectManager)->getData();
+
+    appendCounter(out, "librepilot_telemetry_connected", "1 when the telemetry link is connected", "gauge",
+                  m_telemetryManager->isConnected() ? 1 : 0);
+    appendCounter(out, "librepilot_telemetry_tx_bytes_total", "Bytes sent by the GCS", "counter", gcsStats.TxBytes);
+    appendCounter(out, "librepilot_telemetry_rx_bytes_total", "Bytes received by the GCS", "counter", gcsStats.RxBytes);
+    appendCounter(out, "librepilot_telemetry_tx_rate_bytes", "GCS send rate over the last statistics period, bytes/s", "gauge", gcsStats.TxDataRate);
+    appendCounter(out, "librepilot_telemetry_rx_rate_bytes", "GCS receive rate over the last statistics period, bytes/s", "gauge", gcsStats.RxDataRate);
+    appendCounter(out, "librepilot_telemetry_tx_failures_total", "Transactions the GCS gave up on", "counter", gcsStats.TxFailures);
+    appendCounter(out, "librepilot_telemetry_tx_retries_total", "Transactions the GCS retried", "counter", gcsStats.TxRetries);
+    appendCounter(out, "librepilot_telemetry_rx_failures_total", "Packets the GCS could not decode", "counter", gcsStats.RxFailures);
+    appendCounter(out, "librepilot_telemetry_rx_sync_errors_total", "Sync errors seen by the GCS", "counter", gcsStats.RxSyncErrors);
+    appendCounter(out, "librepilot_telemetry_rx_crc_errors_total", "CRC errors seen by the GCS", "counter", gcsStats.RxCrcErrors);
+    appendCounter(out, "librepilot_flight_telemetry_tx_failures_total", "Transactions the flight side gave up on", "counter", flightStats.TxFailures);
+    appendCounter(out, "librepilot_flight_telemetry_tx_retries_total", "Transactions the flight side retried", "counter", flightStats.TxRetries);
+    appendCounter(out, "librepilot_flight_telemetry_rx_failures_total", "Packets the flight side could not decode", "counter", flightStats.RxFailures);
+    appendCounter(out, "librepilot_flight_telemetry_rx_sync_errors_total", "Sync errors seen by the flight side", "counter", flightStats.RxSyncErrors);
+    appendCounter(out, "librepilot_flight_telemetry_rx_crc_errors_total", "CRC errors seen by the flight side", "counter", flightStats.RxCrcErrors);
+
+    Telemetry::PoolStats pools = m_telemetryManager->poolStats();
+    appendCounter(out, "librepilot_telemetry_queued_updates", "Object updates waiting to be sent", "gauge", pools.queueEntries.inUse);
+    appendCounter(out, "librepilot_telemetry_pending_transactions", "Transactions waiting for a response", "gauge", pools.transactions.inUse);
+
+    // per object, named by the global object manager
+    QByteArray packets;
+    QByteArray bytes;
+    for (int i = 0; i < OBJECT_SLOTS; ++i) {
+        quint32 objId = m_objects[i].objId.loadAcquire();
+        if (objId == 0) {
+            continue;
+        }
+        UAVObject *obj = m_objectManager->getObject(objId);
+        QByteArray label = obj ? obj->getName().toLatin1() : "0x" + QByteArray::number(objId, 16).toUpper();
+        packets += "librepilot_telemetry_rx_objects_total{object=\"" + label + "\"} " + QByteArray::number(m_objects[i].packets.loadAcquire()) + "\n";
+        bytes   += "librepilot_telemetry_rx_object_bytes_total{object=\"" + label + "\"} " + QByteArray::number(m_objects[i].bytes.loadAcquire()) + "\n";
+    }
+    packets += "librepilot_telemetry_rx_objects_total{object=\"other\"} " + QByteArray::number(m_otherPackets.loadAcquire()) + "\n";
+    bytes   += "librepilot_telemetry_rx_object_bytes_total{object=\"other\"} " + QByteArray::number(m_otherBytes.loadAcquire()) + "\n";
+    out     += "# HELP librepilot_telemetry_rx_objects_total Object packets received, by object\n";
+    out     += "# TYPE librepilot_telemetry_rx_objects_total counter\n";
+    out     += packets;
+    out     += "# HELP librepilot_telemetry_rx_object_bytes_total Bytes of the object packets received, by object\n";
+    out     += "# TYPE librepilot_telemetry_rx_object_bytes_total counter\n";
+    out     += bytes;
+
+    out     += "# HELP librepilot_telemetry_rx_latency_seconds Receive latency, by stage of the receive path\n";
+    out     += "# TYPE librepilot_telemetry_rx_latency_seconds histogram\n";
+    appendHistogram(out, "device", m_latency.device);
+    appendHistogram(out, "decode", m_latency.decode);
+    appendHistogram(out, "total", m_latency.total);
+    appendHistogram(out, "control", m_latency.control);
+    return out;
+}
@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ *
+ * @file       metricsserver.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Exports the link health as Prometheus metrics over HTTP
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include "uavtalk_global.h"
+#include "uavtalk.h"
+#include "latencyhistogram.h"
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QHash>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+class TelemetryManager;
+class UAVObjectManager;
+
+/**
+ * Answers GET /metrics with the link health in the Prometheus text format, for central scraping:
+ * the GCS and flight telemetry statistics, the received objects and bytes per object,
+ * the telemetry queue depths and the receive latency histograms.
+ *
+ * Received objects are counted from a frame tap on the telemetry thread with atomic counters
+ * in a fixed open addressing table, no lock and no allocation on the hot path.
+ * Everything else is read when scraped, on the GUI thread.
+ */
+class UAVTALK_EXPORT MetricsServer : public QTcpServer, public UAVTalk::FrameTap {
+    Q_OBJECT
+
+public:
+    MetricsServer(TelemetryManager *telemetryManager, QObject *parent = 0);
+    ~MetricsServer();
+
+    bool start(quint16 port);
+
+    // UAVTalk::FrameTap, called from the telemetry thread
+    void frame(qint64 timestamp, const quint8 *packet, int length);
+
+private slots:
+    void clientConnected();
+    void clientReadyRead();
+    void clientDisconnected();
+    void latencyUpdated();
+
+private:
+    typedef struct {
+        // 0 while the slot is free, set once
+        QAtomicInteger<quint32> objId;
+        QAtomicInteger<quint32> packets;
+        QAtomicInteger<quint32> bytes;
+    } ObjectCounter;
+
+    // power of 2, above the number of object types
+    static const int OBJECT_SLOTS = 1024;
+    // requests are small, a client sending more is dropped
+    static const int MAX_REQUEST_LENGTH = 4096;
+
+    TelemetryManager *m_telemetryManager;
+    UAVObjectManager *m_objectManager;
+    ObjectCounter m_objects[OBJECT_SLOTS];
+    // objects that did not fit in the table
+    QAtomicInteger<quint32> m_otherPackets;
+    QAtomicInteger<quint32> m_otherBytes;
+    // the latencies are per statistics period, Prometheus wants them cumulative
+    UAVTalk::LatencyStats m_latency;
+    QHash<QTcpSocket *, QByteArray> m_requests;
+
+    QByteArray metrics() const;
+    static void appendCounter(QByteArray &out, const char *name, const char *help, const char *type, double value);
+    static void appendHistogram(QByteArray &out, const char *stage, const LatencyHistogram &histogram);
+};
+
+#endif // METRICSSERVER_H
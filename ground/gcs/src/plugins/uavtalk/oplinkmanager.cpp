@@ -26,6 +26,7 @@
  */
 
 #include "oplinkmanager.h"
+#include "oplinkstatuscache.h"
 
 #include <coreplugin/icore.h>
 #include <coreplugin/connectionmanager.h>
@@ -38,6 +39,9 @@
 
 OPLinkManager::OPLinkManager() : QObject(), m_isConnected(false), m_opLinkType(OPLinkManager::OPLINK_UNKNOWN)
 {
+    m_statusCache = new OPLinkStatusCache(this);
+    connect(m_statusCache, SIGNAL(boardTypeChanged(int)), this, SLOT(onBoardTypeChanged(int)));
+
     // connect to the connection manager
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
 
@@ -69,23 +73,22 @@ void OPLinkManager::onDeviceConnect()
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     Q_ASSERT(objManager);
 
-    m_opLinkStatus = OPLinkStatus::GetInstance(objManager);
-    Q_ASSERT(m_opLinkStatus);
+    OPLinkStatus *opLinkStatus = OPLinkStatus::GetInstance(objManager);
+    Q_ASSERT(opLinkStatus);
 
-    // start monitoring OPLinkStatus
-    connect(m_opLinkStatus, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(onOPLinkStatusUpdate()), Qt::UniqueConnection);
+    // start monitoring OPLinkStatus, the board type is only notified when it changes
+    m_statusCache->setStatusObject(opLinkStatus);
 }
 
 void OPLinkManager::onDeviceDisconnect()
 {
     onOPLinkDisconnect();
+    m_statusCache->setStatusObject(NULL);
 }
 
-void OPLinkManager::onOPLinkStatusUpdate()
+void OPLinkManager::onBoardTypeChanged(int boardType)
 {
-    int type = m_opLinkStatus->boardType();
-
-    switch (type) {
+    switch (boardType) {
     case 0x03:
         m_opLinkType = OPLINK_MINI;
         onOPLinkConnect();
@@ -100,8 +103,6 @@ void OPLinkManager::onOPLinkStatusUpdate()
         break;
     default:
         m_opLinkType = OPLINK_UNKNOWN;
-        // stop monitoring status updates...
-        m_opLinkStatus->disconnect(this);
         break;
     }
 }
@@ -111,9 +112,6 @@ void OPLinkManager::onOPLinkConnect()
     if (m_isConnected) {
         return;
     }
-    // stop monitoring status updates...
-    m_opLinkStatus->disconnect(this);
-
     m_isConnected = true;
     emit connected();
 }
@@ -123,9 +121,6 @@ void OPLinkManager::onOPLinkDisconnect()
     if (!m_isConnected) {
         return;
     }
-    // stop monitoring status updates...
-    m_opLinkStatus->disconnect(this);
-
     m_isConnected = false;
     emit disconnected();
 }
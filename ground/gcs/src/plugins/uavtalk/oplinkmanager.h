@@ -32,7 +32,7 @@
 
 #include <QObject>
 
-class OPLinkStatus;
+class OPLinkStatusCache;
 
 class UAVTALK_EXPORT OPLinkManager : public QObject {
     Q_OBJECT
@@ -55,6 +55,12 @@ public:
 
     bool isConnected() const;
 
+    // link state and quality of the connected OPLink
+    OPLinkStatusCache *statusCache() const
+    {
+        return m_statusCache;
+    }
+
 signals:
     void connected();
     void disconnected();
@@ -62,14 +68,14 @@ signals:
 private slots:
     void onDeviceConnect();
     void onDeviceDisconnect();
-    void onOPLinkStatusUpdate();
+    void onBoardTypeChanged(int boardType);
     void onOPLinkConnect();
     void onOPLinkDisconnect();
 
 private:
     bool m_isConnected;
     OPLinkType m_opLinkType;
-    OPLinkStatus *m_opLinkStatus;
+    OPLinkStatusCache *m_statusCache;
 };
 
 #endif // OPLINK_MANAGER_H
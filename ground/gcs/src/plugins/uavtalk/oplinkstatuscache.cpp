@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ *
+ * @file       oplinkstatuscache.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Incrementally computed OPLink link state and quality
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "oplinkstatuscache.h"
+
+#include <oplinkstatus.h>
+
+#include <QtGlobal>
+
+// smoothing factors of the fast and slow RSSI averages
+#define RSSI_FAST_ALPHA 0.5
+#define RSSI_SLOW_ALPHA 0.1
+
+// changes below these are not notified
+#define RSSI_THRESHOLD  1.0
+#define TREND_THRESHOLD 1.0
+#define LOSS_THRESHOLD  1.0
+
+OPLinkStatusCache::OPLinkStatusCache(QObject *parent) : QObject(parent), m_status(NULL)
+{
+    reset();
+}
+
+void OPLinkStatusCache::reset()
+{
+    m_updates       = 0;
+    m_boardType     = 0;
+    m_linkState     = OPLinkStatus::LINKSTATE_DISABLED;
+    m_rssiFast      = -127;
+    m_rssiSlow      = -127;
+    for (int i = 0; i < LOSS_WINDOW; i++) {
+        m_loss[i] = 0;
+    }
+    m_lossSum       = 0;
+    m_lossIndex     = 0;
+    m_notifiedRssi  = m_rssiSlow;
+    m_notifiedTrend = 0;
+    m_notifiedLoss  = 0;
+}
+
+void OPLinkStatusCache::setStatusObject(OPLinkStatus *status)
+{
+    if (status == m_status) {
+        return;
+    }
+    if (m_status) {
+        disconnect(m_status, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(statusUpdated(UAVObject *)));
+    }
+    m_status = status;
+
+    int boardType = m_boardType;
+    int linkState = m_linkState;
+    reset();
+    if (boardType != m_boardType) {
+        emit boardTypeChanged(m_boardType);
+    }
+    if (linkState != m_linkState) {
+        emit linkStateChanged(m_linkState);
+    }
+    emit qualityChanged();
+
+    if (m_status) {
+        connect(m_status, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(statusUpdated(UAVObject *)));
+    }
+}
+
+bool OPLinkStatusCache::isLinkConnected() const
+{
+    return m_linkState == OPLinkStatus::LINKSTATE_CONNECTED;
+}
+
+double OPLinkStatusCache::packetLoss() const
+{
+    int count = qMin(m_updates, (long)LOSS_WINDOW);
+
+    return count ? (double)m_lossSum / count : 0;
+}
+
+void OPLinkStatusCache::statusUpdated(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+
+    OPLinkStatus::DataFields data = m_status->getData();
+
+    if (data.BoardType != m_boardType) {
+        m_boardType = data.BoardType;
+        emit boardTypeChanged(m_boardType);
+    }
+    bool wasConnected = isLinkConnected();
+    if (data.LinkState != m_linkState) {
+        m_linkState = data.LinkState;
+        emit linkStateChanged(m_linkState);
+    }
+
+    // no signal when the link is down
+    double sample = isLinkConnected() ? data.RSSI : -127;
+    if (m_updates == 0 || isLinkConnected() != wasConnected) {
+        m_rssiFast = sample;
+        m_rssiSlow = sample;
+    } else {
+        m_rssiFast += RSSI_FAST_ALPHA * (sample - m_rssiFast);
+        m_rssiSlow += RSSI_SLOW_ALPHA * (sample - m_rssiSlow);
+    }
+
+    // sliding window sum, the oldest sample is replaced
+    int loss = 100 - qMin((int)data.RxGood, 100);
+    m_lossSum += loss - m_loss[m_lossIndex];
+
+    m_loss[m_lossIndex] = loss;
+    m_lossIndex         = (m_lossIndex + 1) % LOSS_WINDOW;
+
+    m_updates++;
+
+    if (qAbs(rssi() - m_notifiedRssi) >= RSSI_THRESHOLD
+        || qAbs(rssiTrend() - m_notifiedTrend) >= TREND_THRESHOLD
+        || qAbs(packetLoss() - m_notifiedLoss) >= LOSS_THRESHOLD) {
+        m_notifiedRssi  = rssi();
+        m_notifiedTrend = rssiTrend();
+        m_notifiedLoss  = packetLoss();
+        emit qualityChanged();
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ *
+ * @file       oplinkstatuscache.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Incrementally computed OPLink link state and quality
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OPLINKSTATUSCACHE_H
+#define OPLINKSTATUSCACHE_H
+
+#include "uavtalk_global.h"
+
+#include <QObject>
+
+class UAVObject;
+class OPLinkStatus;
+
+/**
+ * Cache of the OPLinkStatus object.
+ * The derived link quality metrics are updated incrementally on each status update
+ * and subscribers are only notified when something meaningful changed.
+ */
+class UAVTALK_EXPORT OPLinkStatusCache : public QObject {
+    Q_OBJECT
+
+public:
+    // number of status updates in the packet loss window
+    static const int LOSS_WINDOW = 10;
+
+    OPLinkStatusCache(QObject *parent = 0);
+
+    // starts monitoring the status object, NULL stops and resets the cache
+    void setStatusObject(OPLinkStatus *status);
+
+    bool isValid() const
+    {
+        return m_updates > 0;
+    }
+    int boardType() const
+    {
+        return m_boardType;
+    }
+    // OPLinkStatus::LINKSTATE_*
+    int linkState() const
+    {
+        return m_linkState;
+    }
+    bool isLinkConnected() const;
+    // smoothed RSSI (dBm)
+    double rssi() const
+    {
+        return m_rssiSlow;
+    }
+    // positive when the RSSI improves (dB)
+    double rssiTrend() const
+    {
+        return m_rssiFast - m_rssiSlow;
+    }
+    // packets not received well over the last updates (%)
+    double packetLoss() const;
+
+signals:
+    void boardTypeChanged(int boardType);
+    void linkStateChanged(int linkState);
+    // rssi, trend or packet loss changed by more than a threshold
+    void qualityChanged();
+
+private slots:
+    void statusUpdated(UAVObject *obj);
+
+private:
+    OPLinkStatus *m_status;
+    long m_updates;
+
+    int m_boardType;
+    int m_linkState;
+
+    double m_rssiFast;
+    double m_rssiSlow;
+
+    int m_loss[LOSS_WINDOW];
+    int m_lossSum;
+    int m_lossIndex;
+
+    // values last notified through qualityChanged()
+    double m_notifiedRssi;
+    double m_notifiedTrend;
+    double m_notifiedLoss;
+
+    void reset();
+};
+
+#endif // OPLINKSTATUSCACHE_H
@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ *
+ * @file       recordpool.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Free list of the short-lived telemetry records
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef RECORDPOOL_H
+#define RECORDPOOL_H
+
+#include <QtGlobal>
+#include <QVector>
+
+/**
+ * Counters of a RecordPool, allocated and reused are totals since the pool was created
+ */
+typedef struct {
+    quint32 allocated;
+    quint32 reused;
+    quint32 inUse;
+    quint32 free;
+} RecordPoolStats;
+
+/**
+ * Keeps the released records for the next acquire() instead of deleting them,
+ * so a steady stream of queue entries and transactions stops hitting the allocator
+ * once the pool has grown to the working set. At most maxFree records are kept.
+ * Not thread safe, the owner serializes the calls.
+ */
+template<typename T>
+class RecordPool {
+public:
+    RecordPool(int maxFree) : maxFree(maxFree)
+    {
+        stats.allocated = 0;
+        stats.reused    = 0;
+        stats.inUse     = 0;
+        stats.free      = 0;
+    }
+
+    ~RecordPool()
+    {
+        // the records still in use belong to the caller
+        qDeleteAll(freeRecords);
+    }
+
+    // A default initialized record
+    T *acquire()
+    {
+        T *record;
+
+        if (freeRecords.isEmpty()) {
+            record = new T();
+            ++stats.allocated;
+        } else {
+            record  = freeRecords.takeLast();
+            *record = T();
+            ++stats.reused;
+        }
+        ++stats.inUse;
+        return record;
+    }
+
+    void release(T *record)
+    {
+        --stats.inUse;
+        if (freeRecords.size() < maxFree) {
+            freeRecords.append(record);
+        } else {
+            delete record;
+        }
+    }
+
+    RecordPoolStats getStats() const
+    {
+        RecordPoolStats result = stats;
+
+        result.free = freeRecords.size();
+        return result;
+    }
+
+private:
+    int maxFree;
+    QVector<T *> freeRecords;
+    RecordPoolStats stats;
+};
+
+#endif // RECORDPOOL_H
@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ *
+ * @file       replaybenchmark.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Benchmark of the telemetry receive path replaying a log file
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "replaybenchmark.h"
+#include "telemetrymanager.h"
+
+#include <utils/logfile.h>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+ReplayBenchmark::ReplayBenchmark(TelemetryManager *telemetryManager, const QString &fileName, QObject *parent) :
+    QObject(parent), m_telemetryManager(telemetryManager), m_fileName(fileName), m_logFile(NULL), m_lastProbe(0)
+{
+    // 0 replays as fast as possible
+    m_speeds << 1.0 << 10.0 << 0.0;
+
+    m_probeTimer.setTimerType(Qt::PreciseTimer);
+    m_probeTimer.setInterval(PROBE_PERIOD_MS);
+    connect(&m_probeTimer, SIGNAL(timeout()), this, SLOT(probe()));
+}
+
+void ReplayBenchmark::start()
+{
+    qDebug() << "ReplayBenchmark - replaying" << m_fileName;
+    QMetaObject::invokeMethod(this, "startRun", Qt::QueuedConnection);
+}
+
+void ReplayBenchmark::frame(qint64 timestamp, const quint8 *packet, int length)
+{
+    Q_UNUSED(timestamp);
+    Q_UNUSED(packet);
+    Q_UNUSED(length);
+
+    m_objects.fetchAndAddRelaxed(1);
+}
+
+void ReplayBenchmark::startRun()
+{
+    if (m_results.count() >= m_speeds.count()) {
+        report();
+        QCoreApplication::quit();
+        return;
+    }
+
+    double speed = m_speeds.at(m_results.count());
+
+    m_logFile = new LogFile();
+    m_logFile->setFileName(m_fileName);
+    if (!m_logFile->open(QIODevice::ReadOnly)) {
+        qWarning() << "ReplayBenchmark - can not open" << m_fileName;
+        delete m_logFile;
+        m_logFile = NULL;
+        QCoreApplication::exit(1);
+        return;
+    }
+    if (speed > 0) {
+        m_logFile->setReplaySpeed(speed);
+    }
+    connect(m_logFile, SIGNAL(replayCompleted()), this, SLOT(runFinished()), Qt::QueuedConnection);
+    connect(m_logFile, SIGNAL(replayFinished()), this, SLOT(runFinished()), Qt::QueuedConnection);
+
+    m_objects.store(0);
+    m_eventLatency.reset();
+    m_telemetryManager->addFrameTap(this);
+
+    // the log file is moved to the telemetry thread, the replay is started from there once UAVTalk reads it
+    m_telemetryManager->start(m_logFile);
+    QMetaObject::invokeMethod(m_logFile, speed > 0 ? "startReplay" : "replayAll", Qt::QueuedConnection);
+
+    m_runTime.start();
+    m_lastProbe = LatencyHistogram::timestamp();
+    m_probeTimer.start();
+}
+
+void ReplayBenchmark::runFinished()
+{
+    if (!m_logFile) {
+        return;
+    }
+
+    Result result;
+    result.speed        = m_speeds.at(m_results.count());
+    result.seconds      = m_runTime.nsecsElapsed() / 1e9;
+    result.objects      = m_objects.load();
+    result.eventLatency = m_eventLatency;
+    result.residentKiB  = residentMemoryKiB();
+    m_results << result;
+
+    m_probeTimer.stop();
+    m_telemetryManager->removeFrameTap(this);
+    m_telemetryManager->stop();
+    // deleted from the telemetry thread, after the telemetry stack is torn down
+    m_logFile->disconnect(this);
+    m_logFile->deleteLater();
+    m_logFile = NULL;
+
+    QMetaObject::invokeMethod(this, "startRun", Qt::QueuedConnection);
+}
+
+/**
+ * Sample how late the GUI thread runs its timers
+ */
+void ReplayBenchmark::probe()
+{
+    qint64 now = LatencyHistogram::timestamp();
+
+    m_eventLatency.add(now - m_lastProbe - PROBE_PERIOD_MS * 1000);
+    m_lastProbe = now;
+}
+
+void ReplayBenchmark::report()
+{
+    QTextStream out(stdout);
+
+    out << "speed\tobjects\tseconds\tobjects/s\tGUI latency p50 / p99 / max\tresident KiB\n";
+    foreach(const Result &result, m_results) {
+        out << (result.speed > 0 ? QString("%1x").arg(result.speed) : QString("max")) << '\t'
+            << result.objects << '\t'
+            << QString::number(result.seconds, 'f', 2) << '\t'
+            << QString::number(result.seconds > 0 ? result.objects / result.seconds : 0, 'f', 0) << '\t'
+            << result.eventLatency.toString() << '\t'
+            << result.residentKiB << '\n';
+    }
+    out.flush();
+}
+
+/**
+ * Resident memory of the process, -1 where it is not known
+ */
+qint64 ReplayBenchmark::residentMemoryKiB()
+{
+#ifdef Q_OS_LINUX
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        foreach(const QByteArray &line, status.readAll().split('\n')) {
+            if (line.startsWith("VmRSS:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+#endif
+    return -1;
+}
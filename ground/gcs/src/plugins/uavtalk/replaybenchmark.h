@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ *
+ * @file       replaybenchmark.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Benchmark of the telemetry receive path replaying a log file
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef REPLAYBENCHMARK_H
+#define REPLAYBENCHMARK_H
+
+#include "uavtalk.h"
+#include "latencyhistogram.h"
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+
+class LogFile;
+class TelemetryManager;
+
+/**
+ * Replays a log file through the TelemetryManager (UAVTalk, Telemetry and the UAVObjectManager
+ * of the running GCS) at 1x, 10x and maximum speed, then prints for each run the objects received
+ * per second, the latency of the GUI thread event loop and the resident memory, and quits.
+ *
+ * Started with the -replay-benchmark <log file> command line option, see UAVTalkPlugin.
+ */
+class ReplayBenchmark : public QObject, public UAVTalk::FrameTap {
+    Q_OBJECT
+
+public:
+    ReplayBenchmark(TelemetryManager *telemetryManager, const QString &fileName, QObject *parent = 0);
+
+    void start();
+
+    // UAVTalk::FrameTap, counts the received objects
+    void frame(qint64 timestamp, const quint8 *packet, int length);
+
+private slots:
+    void startRun();
+    void runFinished();
+    void probe();
+
+private:
+    typedef struct {
+        double  speed;
+        quint32 objects;
+        double  seconds;
+        LatencyHistogram eventLatency;
+        qint64  residentKiB;
+    } Result;
+
+    // how often the GUI thread event loop latency is sampled
+    static const int PROBE_PERIOD_MS = 10;
+
+    TelemetryManager *m_telemetryManager;
+    QString m_fileName;
+    QList<double> m_speeds;
+    QList<Result> m_results;
+
+    LogFile *m_logFile;
+    QAtomicInt m_objects;
+    QElapsedTimer m_runTime;
+    QTimer m_probeTimer;
+    qint64 m_lastProbe;
+    LatencyHistogram m_eventLatency;
+
+    void report();
+    static qint64 residentMemoryKiB();
+};
+
+#endif // REPLAYBENCHMARK_H
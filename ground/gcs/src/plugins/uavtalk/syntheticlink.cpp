@@ -0,0 +1,370 @@
+/**
+ ******************************************************************************
+ *
+ * @file       syntheticlink.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Synthetic UAVTalk link for profiling the telemetry receive path
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "syntheticlink.h"
+
+#include "uavobjectmanager.h"
+#include "uavdataobject.h"
+#include "uavobjectfield.h"
+#include "gcstelemetrystats.h"
+#include "flighttelemetrystats.h"
+
+#include <coreplugin/icore.h>
+#include <extensionsystem/pluginmanager.h>
+#include <utils/crc.h>
+
+#include <QDebug>
+#include <QSettings>
+#include <QStringList>
+#include <QtEndian>
+
+#include <math.h>
+
+// UAVTalk v1 framing, see UAVTalk
+#define SYNC_VAL       0x3C
+#define TYPE_MASK      0xF8
+#define TYPE_VER       0x20
+#define TYPE_OBJ       (TYPE_VER | 0x00)
+#define TYPE_OBJ_REQ   (TYPE_VER | 0x01)
+#define TYPE_OBJ_ACK   (TYPE_VER | 0x02)
+#define TYPE_ACK       (TYPE_VER | 0x03)
+#define TYPE_NACK      (TYPE_VER | 0x04)
+#define HEADER_LENGTH  10
+#define MAX_PAYLOAD_LENGTH 256
+
+SyntheticLink::Config SyntheticLink::readConfig()
+{
+    QSettings settings;
+    Config config;
+
+    settings.beginGroup("SyntheticLink");
+    QString objects = settings.value("Objects", "GyroState:1000,AttitudeState:1000").toString();
+    foreach(QString entry, objects.split(',', QString::SkipEmptyParts)) {
+        QStringList parts = entry.trimmed().split(':');
+        double rate = parts.size() == 2 ? parts.at(1).toDouble() : 0;
+
+        if (rate > 0) {
+            config.objects << qMakePair(parts.at(0), rate);
+        }
+    }
+    config.settingsBurstPeriod = settings.value("SettingsBurstPeriod", 5000).toInt();
+    config.corruptionRate = settings.value("CorruptionRate", 0.0).toDouble();
+    config.latency = settings.value("Latency", 0).toInt();
+    config.jitter  = settings.value("Jitter", 0).toInt();
+    config.seed    = settings.value("Seed", 1).toUInt();
+    settings.endGroup();
+    return config;
+}
+
+SyntheticLink::SyntheticLink(UAVObjectManager *objectManager, const Config &config, QObject *parent) :
+    QIODevice(parent), m_objectManager(objectManager), m_config(config), m_random(config.seed),
+    m_nextBurst(0), m_flightStatus(FlightTelemetryStats::STATUS_DISCONNECTED), m_lastRelease(0),
+    m_packets(0), m_corrupted(0)
+{
+    // moves with the device to the telemetry thread
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(GENERATE_PERIOD_MS);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(generate()));
+
+    for (int i = 0; i < config.objects.size(); i++) {
+        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(objectManager->getObject(config.objects.at(i).first));
+        if (!obj || obj->getNumBytes() >= MAX_PAYLOAD_LENGTH) {
+            qWarning() << "SyntheticLink - can't stream" << config.objects.at(i).first;
+            continue;
+        }
+        Stream stream;
+        stream.object  = obj;
+        stream.period  = 1.0 / config.objects.at(i).second;
+        stream.next    = 0;
+        stream.samples = 0;
+        stream.data    = obj->packedData();
+        m_streams << stream;
+    }
+}
+
+bool SyntheticLink::open(OpenMode mode)
+{
+    m_readBuffer.clear();
+    m_writeBuffer.clear();
+    m_delayed.clear();
+    m_lastRelease  = 0;
+    m_nextBurst    = m_config.settingsBurstPeriod;
+    m_flightStatus = FlightTelemetryStats::STATUS_DISCONNECTED;
+    m_packets      = 0;
+    m_corrupted    = 0;
+    for (int i = 0; i < m_streams.size(); i++) {
+        m_streams[i].next    = 0;
+        m_streams[i].samples = 0;
+    }
+    m_clock.start();
+    m_timer->start();
+    return QIODevice::open(mode);
+}
+
+void SyntheticLink::close()
+{
+    m_timer->stop();
+    if (m_clock.isValid()) {
+        qDebug() << "SyntheticLink - sent" << m_packets << "packets in" << m_clock.elapsed() / 1000.0 << "s,"
+                 << m_corrupted << "corrupted";
+    }
+    QIODevice::close();
+}
+
+qint64 SyntheticLink::bytesAvailable() const
+{
+    return m_readBuffer.size() + QIODevice::bytesAvailable();
+}
+
+qint64 SyntheticLink::readData(char *data, qint64 maxSize)
+{
+    qint64 size = qMin(maxSize, (qint64)m_readBuffer.size());
+
+    memcpy(data, m_readBuffer.constData(), size);
+    m_readBuffer.remove(0, size);
+    return size;
+}
+
+/**
+ * Parse what the GCS sends, complete v1 packets only.
+ */
+qint64 SyntheticLink::writeData(const char *data, qint64 maxSize)
+{
+    m_writeBuffer.append(data, maxSize);
+
+    int pos = 0;
+    while (true) {
+        int sync = m_writeBuffer.indexOf((char)SYNC_VAL, pos);
+        if (sync < 0) {
+            pos = m_writeBuffer.size();
+            break;
+        }
+        pos = sync;
+        if (m_writeBuffer.size() - pos < HEADER_LENGTH) {
+            break;
+        }
+        const quint8 *packet = (const quint8 *)m_writeBuffer.constData() + pos;
+        quint8 type = packet[1];
+        int length  = qFromLittleEndian<quint16>(&packet[2]);
+        if ((type & TYPE_MASK) != TYPE_VER || length < HEADER_LENGTH || length > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+            pos++;
+            continue;
+        }
+        if (m_writeBuffer.size() - pos < length + 1) {
+            break;
+        }
+        if (Utils::Crc::updateCRC(0, packet, length) != packet[length]) {
+            pos++;
+            continue;
+        }
+        received(type, qFromLittleEndian<quint32>(&packet[4]), qFromLittleEndian<quint16>(&packet[8]),
+                 &packet[HEADER_LENGTH], length - HEADER_LENGTH);
+        pos += length + 1;
+    }
+    m_writeBuffer.remove(0, pos);
+    release();
+    return maxSize;
+}
+
+void SyntheticLink::received(quint8 type, quint32 objId, quint16 instId, const quint8 *data, int length)
+{
+    if (type == TYPE_OBJ_ACK) {
+        queue(packet(TYPE_ACK, objId, instId, QByteArray()), false);
+    }
+
+    if (type == TYPE_OBJ_REQ) {
+        UAVObject *obj = m_objectManager->getObject(objId, instId);
+        if (obj && obj->getNumBytes() < MAX_PAYLOAD_LENGTH) {
+            queue(packet(TYPE_OBJ, objId, instId, obj->packedData()), false);
+        } else {
+            queue(packet(TYPE_NACK, objId, instId, QByteArray()), false);
+        }
+    } else if ((type == TYPE_OBJ || type == TYPE_OBJ_ACK) && objId == GCSTelemetryStats::OBJID) {
+        // the flight side of the handshake, see TelemetryMonitor::processStatsUpdates()
+        UAVObjectField *field = m_objectManager->getObject(objId)->getField("Status");
+        if (!field || (int)field->getDataOffset() >= length) {
+            return;
+        }
+        quint8 gcsStatus = data[field->getDataOffset()];
+        if (gcsStatus == GCSTelemetryStats::STATUS_HANDSHAKEREQ) {
+            m_flightStatus = FlightTelemetryStats::STATUS_HANDSHAKEACK;
+        } else if (gcsStatus == GCSTelemetryStats::STATUS_CONNECTED) {
+            m_flightStatus = FlightTelemetryStats::STATUS_CONNECTED;
+        } else {
+            m_flightStatus = FlightTelemetryStats::STATUS_DISCONNECTED;
+        }
+        sendFlightStats();
+    }
+}
+
+void SyntheticLink::sendFlightStats()
+{
+    UAVObject *obj = m_objectManager->getObject(FlightTelemetryStats::OBJID);
+    UAVObjectField *field = obj ? obj->getField("Status") : NULL;
+
+    if (!field) {
+        return;
+    }
+    QByteArray data = obj->packedData();
+    data[field->getDataOffset()] = m_flightStatus;
+    queue(packet(TYPE_OBJ, FlightTelemetryStats::OBJID, 0, data), false);
+}
+
+void SyntheticLink::generate()
+{
+    double now = m_clock.nsecsElapsed() / 1e9;
+
+    for (int i = 0; i < m_streams.size(); i++) {
+        Stream &stream = m_streams[i];
+        // don't catch up after a stall of the thread, keep the rate
+        if (now - stream.next > 1.0) {
+            stream.next = now;
+        }
+        while (stream.next <= now) {
+            updateStream(stream);
+            queue(packet(TYPE_OBJ, stream.object->getObjID(), 0, stream.data), true);
+            stream.next += stream.period;
+        }
+    }
+
+    if (m_config.settingsBurstPeriod > 0 && m_clock.elapsed() >= m_nextBurst) {
+        foreach(QList<UAVDataObject *> list, m_objectManager->getDataObjects()) {
+            UAVDataObject *obj = list.first();
+            if (obj->isSettingsObject() && obj->getNumBytes() < MAX_PAYLOAD_LENGTH) {
+                queue(packet(TYPE_OBJ, obj->getObjID(), 0, obj->packedData()), true);
+            }
+        }
+        m_nextBurst += m_config.settingsBurstPeriod;
+    }
+
+    release();
+}
+
+/**
+ * Next values of the streamed object: a sine wave of its own in each float element.
+ */
+void SyntheticLink::updateStream(Stream &stream)
+{
+    double t = stream.samples++ * stream.period;
+    int element = 0;
+
+    foreach(UAVObjectField * field, stream.object->getFields()) {
+        if (field->getType() != UAVObjectField::FLOAT32) {
+            continue;
+        }
+        for (quint32 i = 0; i < field->getNumElements(); i++, element++) {
+            float value = 10.0 * sin(2 * M_PI * (0.2 + 0.1 * element) * t + element);
+            quint32 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            qToLittleEndian<quint32>(bits, (uchar *)stream.data.data() + field->getDataOffset() + i * sizeof(bits));
+        }
+    }
+}
+
+QByteArray SyntheticLink::packet(quint8 type, quint32 objId, quint16 instId, const QByteArray &data) const
+{
+    QByteArray packet(HEADER_LENGTH + data.size() + 1, 0);
+    quint8 *p = (quint8 *)packet.data();
+
+    p[0] = SYNC_VAL;
+    p[1] = type;
+    qToLittleEndian<quint16>(HEADER_LENGTH + data.size(), &p[2]);
+    qToLittleEndian<quint32>(objId, &p[4]);
+    qToLittleEndian<quint16>(instId, &p[8]);
+    memcpy(&p[HEADER_LENGTH], data.constData(), data.size());
+    p[HEADER_LENGTH + data.size()] = Utils::Crc::updateCRC(0, p, HEADER_LENGTH + data.size());
+    return packet;
+}
+
+void SyntheticLink::queue(QByteArray packet, bool corruptible)
+{
+    if (corruptible && m_config.corruptionRate > 0 &&
+        std::uniform_real_distribution<double>(0, 1)(m_random) < m_config.corruptionRate) {
+        int bit = std::uniform_int_distribution<int>(0, packet.size() * 8 - 1)(m_random);
+        packet[bit / 8] = packet.at(bit / 8) ^ (1 << (bit % 8));
+        m_corrupted++;
+    }
+    m_packets++;
+
+    qint64 releaseTime = m_clock.elapsed() + m_config.latency;
+    if (m_config.jitter > 0) {
+        releaseTime += std::uniform_int_distribution<int>(0, m_config.jitter)(m_random);
+    }
+    // a serial link does not reorder the packets
+    m_lastRelease = qMax(m_lastRelease, releaseTime);
+    m_delayed.enqueue(qMakePair(m_lastRelease, packet));
+}
+
+void SyntheticLink::release()
+{
+    qint64 now  = m_clock.elapsed();
+    bool queued = false;
+
+    while (!m_delayed.isEmpty() && m_delayed.head().first <= now) {
+        m_readBuffer.append(m_delayed.dequeue().second);
+        queued = true;
+    }
+    if (queued) {
+        emit readyRead();
+    }
+}
+
+QList<Core::IConnection::device> SyntheticConnection::availableDevices()
+{
+    QList<device> list;
+    device d;
+
+    d.name = "Synthetic load";
+    d.displayName = d.name;
+    d.description = tr("Synthetic UAVTalk stream, see the SyntheticLink settings");
+    list << d;
+    return list;
+}
+
+QIODevice *SyntheticConnection::openDevice(const QString &deviceName)
+{
+    Q_UNUSED(deviceName);
+
+    UAVObjectManager *objectManager = ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>();
+    SyntheticLink *link = new SyntheticLink(objectManager, SyntheticLink::readConfig());
+
+    if (!link->open(QIODevice::ReadWrite)) {
+        delete link;
+        return NULL;
+    }
+    return link;
+}
+
+QString SyntheticConnection::connectionName()
+{
+    return QString("Synthetic UAVTalk load");
+}
+
+QString SyntheticConnection::shortName()
+{
+    return QString("Synthetic");
+}
@@ -0,0 +1,143 @@
+/**
+ ******************************************************************************
+ *
+ * @file       syntheticlink.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Synthetic UAVTalk link for profiling the telemetry receive path
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef SYNTHETICLINK_H
+#define SYNTHETICLINK_H
+
+#include "uavtalk_global.h"
+
+#include <coreplugin/iconnection.h>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QList>
+#include <QPair>
+#include <QQueue>
+#include <QTimer>
+
+#include <random>
+
+class UAVObjectManager;
+class UAVDataObject;
+
+/**
+ * A device that plays the part of a flight controller: it streams object updates at the
+ * configured rates and answers the telemetry handshake, the object requests and the acks of the GCS.
+ * The packets can be corrupted and delayed to exercise the error and latency paths.
+ * The random choices come from a seeded generator so that a run can be reproduced.
+ */
+class UAVTALK_EXPORT SyntheticLink : public QIODevice {
+    Q_OBJECT
+
+public:
+    typedef struct {
+        // objects streamed and their updates per second
+        QList<QPair<QString, double> > objects;
+        // every settings object is sent at this period (ms), 0 for never
+        int settingsBurstPeriod;
+        // fraction of the streamed packets with a bit flipped
+        double corruptionRate;
+        // delay (ms) of the packets, plus up to jitter ms, the order is kept
+        int latency;
+        int jitter;
+        quint32 seed;
+    } Config;
+
+    // Settings group "SyntheticLink": Objects ("GyroState:1000,AttitudeState:1000"),
+    // SettingsBurstPeriod, CorruptionRate, Latency, Jitter and Seed
+    static Config readConfig();
+
+    SyntheticLink(UAVObjectManager *objectManager, const Config &config, QObject *parent = 0);
+
+    bool isSequential() const
+    {
+        return true;
+    }
+    bool open(OpenMode mode);
+    void close();
+    qint64 bytesAvailable() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize);
+    qint64 writeData(const char *data, qint64 maxSize);
+
+private slots:
+    void generate();
+
+private:
+    typedef struct {
+        UAVDataObject *object;
+        double period;
+        double next;
+        quint32 samples;
+        QByteArray data;
+    } Stream;
+
+    // how often the packets due are generated, the rates don't depend on it
+    static const int GENERATE_PERIOD_MS = 5;
+
+    UAVObjectManager *m_objectManager;
+    Config m_config;
+    QList<Stream> m_streams;
+    std::mt19937 m_random;
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_nextBurst;
+    quint8 m_flightStatus;
+
+    // packets with the time (ms) they can be read, then the bytes to read
+    QQueue<QPair<qint64, QByteArray> > m_delayed;
+    qint64 m_lastRelease;
+    QByteArray m_readBuffer;
+    // bytes written by the GCS not parsed yet
+    QByteArray m_writeBuffer;
+
+    quint64 m_packets;
+    quint64 m_corrupted;
+
+    void updateStream(Stream &stream);
+    QByteArray packet(quint8 type, quint32 objId, quint16 instId, const QByteArray &data) const;
+    void queue(QByteArray packet, bool corruptible);
+    void release();
+    void received(quint8 type, quint32 objId, quint16 instId, const quint8 *data, int length);
+    void sendFlightStats();
+};
+
+/**
+ * Offers the synthetic link in the connection list, enabled by the -synthetic-link command line option.
+ */
+class UAVTALK_EXPORT SyntheticConnection : public Core::IConnection {
+    Q_OBJECT
+
+public:
+    QList<Core::IConnection::device> availableDevices();
+    QIODevice *openDevice(const QString &deviceName);
+    QString connectionName();
+    QString shortName();
+};
+
+#endif // SYNTHETICLINK_H
@@ -28,7 +28,8 @@
 #include "telemetry.h"
 #include "oplinksettings.h"
 #include "objectpersistence.h"
-#include <QTime>
+#include "gcsreceiver.h"
+#include "manualcontrolcommand.h"
 #include <QtGlobal>
 #include <stdlib.h>
 #include <QDebug>
@@ -36,10 +37,42 @@
 /**
  * Constructor
  */
-Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMngr), utalk(utalk)
+Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMngr), utalk(utalk),
+    queuePool(QUEUE_POOL_SIZE), transactionPool(TRANSACTION_POOL_SIZE)
 {
     mutex = new QMutex(QMutex::Recursive);
 
+    // Setup and start the periodic timer
+    updateClock.start();
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
+    updateTimer->start(1000);
+
+    // Setup the transactions
+    transactionWindow   = DEFAULT_TRANSACTION_WINDOW;
+    pendingTransactions = 0;
+    requestTimeoutMs    = REQ_TIMEOUT_MS;
+    rttAverage   = -1;
+    rttVariation = 0;
+
+    updatePeriodScale = 1.0;
+
+    // Setup the pacing of the regular updates, unlimited until the link capacity is known
+    linkCapacity = 0;
+    pacingBudget = 0;
+    pacingTimeMs = 0;
+    pacingTimer  = new QTimer(this);
+    pacingTimer->setSingleShot(true);
+    connect(pacingTimer, SIGNAL(timeout()), this, SLOT(processPacedUpdates()));
+
+    // One timer for all the transaction timeouts, running only while a response is awaited
+    timeoutWheel.resize(WHEEL_SLOTS);
+    wheelTick  = 0;
+    armedTransactions = 0;
+    wheelTimer = new QTimer(this);
+    connect(wheelTimer, SIGNAL(timeout()), this, SLOT(processTimeouts()));
+
     // Register all objects in the list
     foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
         foreach(UAVObject * object, instances) {
@@ -59,16 +92,11 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
     // these slots will be executed in the telemetry thread
     // TODO should send a status (SUCCESS, FAILED, TIMEOUT)
     connect(utalk, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    connect(utalk, SIGNAL(transactionProgress(UAVObject *)), this, SLOT(transactionProgress(UAVObject *)));
 
     // Get GCS stats object
     gcsStatsObj = GCSTelemetryStats::GetInstance(objMngr);
 
-    // Setup and start the periodic timer
-    timeToNextUpdateMs = 0;
-    updateTimer = new QTimer(this);
-    connect(updateTimer, SIGNAL(timeout()), this, SLOT(processPeriodicUpdates()));
-    updateTimer->start(1000);
-
     // Setup and start the stats timer
     txErrors  = 0;
     txRetries = 0;
@@ -77,6 +105,9 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr) : objMngr(objMng
 Telemetry::~Telemetry()
 {
     closeAllTransactions();
+    clearObjectQueue(objControlQueue);
+    clearObjectQueue(objPriorityQueue);
+    clearObjectQueue(objQueue);
     foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
         foreach(UAVObject * object, instances) {
             // 'forget' all objects
@@ -103,19 +134,17 @@ void Telemetry::registerObject(UAVObject *obj)
 void Telemetry::addObject(UAVObject *obj)
 {
     // Check if object type is already in the list
-    for (int n = 0; n < objList.length(); ++n) {
-        if (objList[n].obj->getObjID() == obj->getObjID()) {
-            // Object type (not instance!) is already in the list, do nothing
-            return;
-        }
+    if (objTimes.contains(obj->getObjID())) {
+        // Object type (not instance!) is already in the list, do nothing
+        return;
     }
 
     // If this point is reached, then the object type is new, let's add it
     ObjectTimeInfo timeInfo;
     timeInfo.obj = obj;
-    timeInfo.timeToNextUpdateMs = 0;
-    timeInfo.updatePeriodMs     = 0;
-    objList.append(timeInfo);
+    timeInfo.updatePeriodMs = 0;
+    timeInfo.generation     = 0;
+    objTimes.insert(obj->getObjID(), timeInfo);
 }
 
 /**
@@ -124,11 +153,21 @@ void Telemetry::addObject(UAVObject *obj)
 void Telemetry::setUpdatePeriod(UAVObject *obj, qint32 periodMs)
 {
     // Find object type (not instance!) and update its period
-    for (int n = 0; n < objList.length(); ++n) {
-        if (objList[n].obj->getObjID() == obj->getObjID()) {
-            objList[n].updatePeriodMs     = periodMs;
-            objList[n].timeToNextUpdateMs = quint32((float)periodMs * (float)qrand() / (float)RAND_MAX); // avoid bunching of updates
-        }
+    QHash<quint32, ObjectTimeInfo>::iterator it = objTimes.find(obj->getObjID());
+
+    if (it == objTimes.end() || it->updatePeriodMs == periodMs) {
+        // same period, keep the schedule
+        return;
+    }
+    it->updatePeriodMs = periodMs;
+    it->generation++;
+    if (periodMs > 0) {
+        PeriodicUpdate update;
+        update.dueMs      = updateClock.elapsed() + qint64((float)periodMs * updatePeriodScale * (float)qrand() / (float)RAND_MAX); // avoid bunching of updates
+        update.objId      = it.key();
+        update.generation = it->generation;
+        updateQueue.push(update);
+        scheduleNextUpdate();
     }
 }
 
@@ -252,6 +291,13 @@ void Telemetry::transactionCompleted(UAVObject *obj, bool success)
         } else {
             obj->setIsKnown(false);
             qWarning() << "Telemetry - !!! transaction failed for object" << obj->toStringBrief();
+            emit objectRejected(obj);
+        }
+
+        // Measure the round trip time, only on the first attempt as the response to a retry is ambiguous
+        // and not on all instances transfers that take several round trips
+        if (success && transInfo->retriesRemaining == MAX_RETRIES && !transInfo->allInstances) {
+            updateRoundTripTime(updateClock.elapsed() - transInfo->sendTimeMs);
         }
 
         // Remove this transaction as it's complete.
@@ -260,15 +306,28 @@ void Telemetry::transactionCompleted(UAVObject *obj, bool success)
         // Send signal
         obj->emitTransactionCompleted(success);
 
-        // Process new object updates from queue
-        processObjectQueue();
+        // Process new object updates from queue, the transaction window has room again
+        processObjectQueues();
     } else {
         qWarning() << "Telemetry - Error: received a transaction completed when did not expect it for" << obj->toStringBrief();
     }
 }
 
 /**
- * Called when a transaction is not completed within the timeout period (timer event)
+ * Called when a part of an all instances transaction is acked (uavtalk event)
+ */
+void Telemetry::transactionProgress(UAVObject *obj)
+{
+    ObjectTransactionInfo *transInfo = findTransaction(obj);
+
+    if (transInfo && transInfo->wheelSlot >= 0) {
+        // restart the timeout for the remaining instances
+        armTimeout(transInfo, transInfo->timeoutMs);
+    }
+}
+
+/**
+ * Called when a transaction is not completed within the timeout period (timing wheel event)
  */
 void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
 {
@@ -298,7 +357,7 @@ void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
         obj->emitTransactionCompleted(false);
 
         // Process new object updates from queue
-        processObjectQueue();
+        processObjectQueues();
     }
 }
 
@@ -324,8 +383,9 @@ void Telemetry::processObjectTransaction(ObjectTransactionInfo *transInfo)
     // Check if a response is needed now or will arrive asynchronously
     if (transInfo->objRequest || transInfo->acked) {
         if (sent) {
-            // Start timer if a response is expected
-            transInfo->timer->start(REQ_TIMEOUT_MS);
+            // Start timer if a response is expected, backing off on each retry
+            transInfo->sendTimeMs = updateClock.elapsed();
+            armTimeout(transInfo, qMin(requestTimeoutMs << (MAX_RETRIES - transInfo->retriesRemaining), (int)MAX_REQ_TIMEOUT_MS));
         } else {
             // message was not sent, the transaction will not complete and will timeout
             // there is no need to wait to close the transaction and notify of completion failure
@@ -348,54 +408,148 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
     objInfo.obj   = obj;
     objInfo.event = event;
     objInfo.allInstances = allInstances;
-    if (priority) {
-        if (objPriorityQueue.length() < MAX_QUEUE_SIZE) {
-            objPriorityQueue.enqueue(objInfo);
-        } else {
-            ++txErrors;
-            qWarning().nospace() << "Telemetry - !!! priority event queue is full, event lost " << obj->toStringBrief();
-            obj->emitTransactionCompleted(false);
-        }
+    // The flight control objects go before everything else so that the uplink never starves them
+    quint32 objId = obj->getObjID();
+    if (objId == GCSReceiver::OBJID || objId == ManualControlCommand::OBJID) {
+        enqueueObject(objControlQueue, objInfo);
+    } else if (priority) {
+        enqueueObject(objPriorityQueue, objInfo);
     } else {
-        if (objQueue.length() < MAX_QUEUE_SIZE) {
-            objQueue.enqueue(objInfo);
-        } else {
-            ++txErrors;
-            qWarning().nospace() << "Telemetry - !!! event queue is full, event lost " << obj->toStringBrief();
-            obj->emitTransactionCompleted(false);
-        }
+        enqueueObject(objQueue, objInfo);
     }
 
     // Process the transaction
     processObjectQueue();
 }
 
+/**
+ * Queue an event, unless the same event of the object is already queued:
+ * the object is packed when sent, so the latest value wins.
+ * \return true if the event was queued
+ */
+bool Telemetry::enqueueObject(QQueue<ObjectQueueInfo *> &queue, const ObjectQueueInfo &objInfo)
+{
+    QPair<UAVObject *, int> key(objInfo.obj, objInfo.event | (objInfo.allInstances ? 0x100 : 0));
+
+    if (queuedEvents.contains(key)) {
+        return false;
+    }
+    queuedEvents.insert(key);
+    ObjectQueueInfo *entry = queuePool.acquire();
+    *entry = objInfo;
+    queue.enqueue(entry);
+    return true;
+}
+
+Telemetry::ObjectQueueInfo Telemetry::dequeueObject(QQueue<ObjectQueueInfo *> &queue)
+{
+    ObjectQueueInfo *entry  = queue.dequeue();
+    ObjectQueueInfo objInfo = *entry;
+
+    queuePool.release(entry);
+    queuedEvents.remove(QPair<UAVObject *, int>(objInfo.obj, objInfo.event | (objInfo.allInstances ? 0x100 : 0)));
+    return objInfo;
+}
+
+void Telemetry::clearObjectQueue(QQueue<ObjectQueueInfo *> &queue)
+{
+    while (!queue.isEmpty()) {
+        dequeueObject(queue);
+    }
+}
+
+/**
+ * Pace the regular events to their share of the link capacity (token bucket).
+ * \return 0 if the event can be sent now, otherwise the delay in ms when it can
+ */
+qint32 Telemetry::pacingDelay(const ObjectQueueInfo &objInfo)
+{
+    if (linkCapacity <= 0) {
+        return 0;
+    }
+    qint64 rate = (qint64)linkCapacity * REGULAR_LINK_SHARE / 100;
+    qint64 now  = updateClock.elapsed();
+
+    // refill the budget, up to 100 ms of updates (and at least one large object)
+    qint64 burst = qMax(rate / 10, (qint64)512);
+    pacingBudget = qMin(pacingBudget + (now - pacingTimeMs) * rate / 1000, burst);
+    pacingTimeMs = now;
+
+    qint64 size = PACKET_OVERHEAD + objInfo.obj->getNumBytes();
+    if (objInfo.allInstances) {
+        size *= objMngr->getNumInstances(objInfo.obj->getObjID());
+    }
+    // an event larger than the burst goes once the budget is full
+    if (pacingBudget < size && pacingBudget < burst) {
+        return qMax((qint32)((size - pacingBudget) * 1000 / qMax(rate, (qint64)1)), 1);
+    }
+    pacingBudget -= size;
+    return 0;
+}
+
+/**
+ * Check if the event starts a transaction that waits for a response (ack or object)
+ */
+bool Telemetry::needsResponse(const ObjectQueueInfo &objInfo)
+{
+    if (objInfo.event == EV_UPDATE_REQ) {
+        return true;
+    }
+    if (objInfo.event == EV_UNPACKED || objInfo.event == EV_NONE) {
+        return false;
+    }
+    return UAVObject::GetGcsTelemetryAcked(objInfo.obj->getMetadata());
+}
+
+/**
+ * Process the queued events as long as there are some and the transaction window is not full
+ */
+void Telemetry::processObjectQueues()
+{
+    for (int n = objControlQueue.size() + objPriorityQueue.size() + objQueue.size(); n > 0 && processObjectQueue(); --n) {}
+}
+
 /**
  * Process events from the object queue
+ * \return true if an event was processed, false if there are none or they must wait
  */
-void Telemetry::processObjectQueue()
+bool Telemetry::processObjectQueue()
 {
-    // Get object information from queue (first the priority and then the regular queue)
+    // Get object information from queue (first the flight control, the priority and then the regular queue)
+    // the events waiting for a response are held while the transaction window is full
     ObjectQueueInfo objInfo;
-
-    if (!objPriorityQueue.isEmpty()) {
-        objInfo = objPriorityQueue.dequeue();
-    } else if (!objQueue.isEmpty()) {
-        objInfo = objQueue.dequeue();
+    QQueue<ObjectQueueInfo *> *queue = NULL;
+    bool windowFull = pendingTransactions >= transactionWindow;
+
+    if (!objControlQueue.isEmpty() && !(windowFull && needsResponse(*objControlQueue.head()))) {
+        queue = &objControlQueue;
+    } else if (!objPriorityQueue.isEmpty() && !(windowFull && needsResponse(*objPriorityQueue.head()))) {
+        queue = &objPriorityQueue;
+    } else if (!objQueue.isEmpty() && !(windowFull && needsResponse(*objQueue.head()))) {
+        qint32 delay = pacingDelay(*objQueue.head());
+        if (delay > 0) {
+            // no bandwidth left for the regular updates, they wait in the queue
+            if (!pacingTimer->isActive()) {
+                pacingTimer->start(delay);
+            }
+            return false;
+        }
+        queue = &objQueue;
     } else {
-        return;
+        return false;
     }
+    objInfo = dequeueObject(*queue);
 
     // Check if a connection has been established, only process GCSTelemetryStats updates
     // (used to establish the connection)
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
     if (gcsStats.Status != GCSTelemetryStats::STATUS_CONNECTED) {
-        objQueue.clear();
+        clearObjectQueue(objQueue);
         if ((objInfo.obj->getObjID() != GCSTelemetryStats::OBJID) &&
             (objInfo.obj->getObjID() != OPLinkSettings::OBJID) &&
             (objInfo.obj->getObjID() != ObjectPersistence::OBJID)) {
             objInfo.obj->emitTransactionCompleted(false);
-            return;
+            return true;
         }
     }
 
@@ -409,12 +563,15 @@ void Telemetry::processObjectQueue()
         // If a single instance transaction is running, then starting an "all instance" transaction is not allowed
         // TODO make the above logic a reality...
         if (findTransaction(objInfo.obj)) {
-            qWarning().nospace() << "Telemetry - !!! Making request for an object " << objInfo.obj->toStringBrief() << " for which a request is already in progress";
-            // objInfo.obj->emitTransactionCompleted(false);
-            return;
+            // keep the event queued, the queue is processed again when the transaction completes
+#ifdef VERBOSE_TELEMETRY
+            qDebug().nospace() << "Telemetry - deferring request for object " << objInfo.obj->toStringBrief() << " for which a request is already in progress";
+#endif
+            enqueueObject(*queue, objInfo);
+            return false;
         }
         UAVObject::Metadata metadata     = objInfo.obj->getMetadata();
-        ObjectTransactionInfo *transInfo = new ObjectTransactionInfo(this);
+        ObjectTransactionInfo *transInfo = transactionPool.acquire();
         transInfo->obj   = objInfo.obj;
         transInfo->allInstances = objInfo.allInstances;
         transInfo->retriesRemaining = MAX_RETRIES;
@@ -424,7 +581,6 @@ void Telemetry::processObjectQueue()
         } else if (objInfo.event == EV_UPDATE_REQ) {
             transInfo->objRequest = true;
         }
-        transInfo->telem = this;
         // Insert the transaction into the transaction map.
         openTransaction(transInfo);
         processObjectTransaction(transInfo);
@@ -445,11 +601,11 @@ void Telemetry::processObjectQueue()
     if (objInfo.event == EV_UNPACKED) {
         processObjectQueue();
     }
+    return true;
 }
 
 /**
- * Check is any objects are pending for periodic updates
- * TODO: Clean-up
+ * Send the periodic updates that are due, the updates are kept in a min-heap by due time
  */
 void Telemetry::processPeriodicUpdates()
 {
@@ -458,49 +614,99 @@ void Telemetry::processPeriodicUpdates()
     // Stop timer
     updateTimer->stop();
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update (will be used for setting timeToNextUpdateMs)
-    qint32 minDelay  = MAX_UPDATE_PERIOD_MS;
-    ObjectTimeInfo *objinfo;
-    qint32 elapsedMs = 0;
-    QTime time;
-    qint32 offset;
-    bool allInstances;
-    for (int n = 0; n < objList.length(); ++n) {
-        objinfo = &objList[n];
-        // If object is configured for periodic updates
-        if (objinfo->updatePeriodMs > 0) {
-            objinfo->timeToNextUpdateMs -= timeToNextUpdateMs;
-            // Check if time for the next update
-            if (objinfo->timeToNextUpdateMs <= 0) {
-                // Reset timer
-                offset = (-objinfo->timeToNextUpdateMs) % objinfo->updatePeriodMs;
-                objinfo->timeToNextUpdateMs = objinfo->updatePeriodMs - offset;
-                // Send object
-                time.start();
-                allInstances = !objinfo->obj->isSingleInstance();
-                processObjectUpdates(objinfo->obj, EV_UPDATED_PERIODIC, allInstances, false);
-                elapsedMs    = time.elapsed();
-                // Update timeToNextUpdateMs with the elapsed delay of sending the object;
-                timeToNextUpdateMs += elapsedMs;
-            }
-            // Update minimum delay
-            if (objinfo->timeToNextUpdateMs < minDelay) {
-                minDelay = objinfo->timeToNextUpdateMs;
-            }
+    qint64 now = updateClock.elapsed();
+    while (!updateQueue.empty() && updateQueue.top().dueMs <= now) {
+        PeriodicUpdate update = updateQueue.top();
+        updateQueue.pop();
+
+        // Ignore the updates of a previous period
+        QHash<quint32, ObjectTimeInfo>::const_iterator it = objTimes.constFind(update.objId);
+        if (it == objTimes.constEnd() || it->generation != update.generation || it->updatePeriodMs <= 0) {
+            continue;
         }
+        UAVObject *obj = it->obj;
+
+        // Schedule the next update, skipping the periods that were missed
+        qint64 periodMs = qMax((qint64)1, qRound64(it->updatePeriodMs * updatePeriodScale));
+        update.dueMs = now + periodMs - (now - update.dueMs) % periodMs;
+        updateQueue.push(update);
+
+        // Send object
+        processObjectUpdates(obj, EV_UPDATED_PERIODIC, !obj->isSingleInstance(), false);
     }
 
-    // Check if delay for the next update is too short
-    if (minDelay < MIN_UPDATE_PERIOD_MS) {
-        minDelay = MIN_UPDATE_PERIOD_MS;
+    scheduleNextUpdate();
+}
+
+/**
+ * Restart the timer for the next periodic update
+ */
+void Telemetry::scheduleNextUpdate()
+{
+    if (QThread::currentThread() != thread()) {
+        // new objects are registered from the thread creating them, the timer belongs to the telemetry thread
+        QMetaObject::invokeMethod(this, "processPeriodicUpdates", Qt::QueuedConnection);
+        return;
     }
+    qint64 delay = MAX_UPDATE_PERIOD_MS;
 
-    // Done
-    timeToNextUpdateMs = minDelay;
+    if (!updateQueue.empty()) {
+        delay = qBound((qint64)MIN_UPDATE_PERIOD_MS, updateQueue.top().dueMs - updateClock.elapsed(), (qint64)MAX_UPDATE_PERIOD_MS);
+    }
+    if (!updateTimer->isActive() || updateTimer->remainingTime() > delay) {
+        updateTimer->start(delay);
+    }
+}
 
-    // Restart timer
-    updateTimer->start(timeToNextUpdateMs);
+/**
+ * Send the regular updates that were waiting for bandwidth
+ */
+void Telemetry::processPacedUpdates()
+{
+    QMutexLocker locker(mutex);
+
+    processObjectQueues();
+}
+
+void Telemetry::setTransactionWindow(int window)
+{
+    QMutexLocker locker(mutex);
+
+    transactionWindow = qMax(window, 1);
+    processObjectQueues();
+}
+
+/**
+ * Update the smoothed round trip time and its variation (Jacobson/Karels),
+ * the request timeout follows them so that slow links do not retry for nothing
+ */
+void Telemetry::updateRoundTripTime(qint64 rttMs)
+{
+    if (rttAverage < 0) {
+        rttAverage   = rttMs;
+        rttVariation = rttMs / 2.0;
+    } else {
+        rttVariation = 0.75 * rttVariation + 0.25 * qAbs(rttAverage - rttMs);
+        rttAverage   = 0.875 * rttAverage + 0.125 * rttMs;
+    }
+    requestTimeoutMs = qBound((int)MIN_REQ_TIMEOUT_MS, (int)(rttAverage + 4 * rttVariation), (int)MAX_REQ_TIMEOUT_MS);
+}
+
+void Telemetry::setUpdatePeriodScale(double scale)
+{
+    QMutexLocker locker(mutex);
+
+    // the updates already scheduled keep their due time, the next ones use the new periods
+    updatePeriodScale = qMax(scale, 1.0);
+}
+
+void Telemetry::setLinkCapacity(qint32 bytesPerSecond)
+{
+    QMutexLocker locker(mutex);
+
+    linkCapacity = bytesPerSecond;
+    pacingBudget = 0;
+    pacingTimeMs = updateClock.elapsed();
 }
 
 Telemetry::TelemetryStats Telemetry::getStats()
@@ -530,6 +736,27 @@ Telemetry::TelemetryStats Telemetry::getStats()
     return stats;
 }
 
+Telemetry::PoolStats Telemetry::getPoolStats()
+{
+    QMutexLocker locker(mutex);
+
+    PoolStats stats;
+
+    stats.queueEntries = queuePool.getStats();
+    stats.transactions = transactionPool.getStats();
+    return stats;
+}
+
+UAVTalk::LatencyStats Telemetry::getLatencyStats()
+{
+    return utalk->getLatencyStats();
+}
+
+UAVTalk::BandwidthStats Telemetry::getBandwidthStats()
+{
+    return utalk->getBandwidthStats();
+}
+
 void Telemetry::resetStats()
 {
     QMutexLocker locker(mutex);
@@ -602,89 +829,125 @@ void Telemetry::newInstance(UAVObject *obj)
 
 ObjectTransactionInfo *Telemetry::findTransaction(UAVObject *obj)
 {
-    quint32 objId  = obj->getObjID();
-    quint16 instId = obj->getInstID();
+    quint32 objId = obj->getObjID();
 
-    // Lookup the transaction in the transaction map
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId, NULL);
-    if (objTransactions != NULL) {
-        ObjectTransactionInfo *trans = objTransactions->value(instId, NULL);
-        if (trans == NULL) {
-            // see if there is an ALL_INSTANCES transaction
-            trans = objTransactions->value(UAVTalk::ALL_INSTANCES, NULL);
-        }
-        return trans;
+    // Lookup the transaction of the instance, or else an ALL_INSTANCES transaction
+    ObjectTransactionInfo *trans = transMap.value(UAVTalk::transactionKey(objId, obj->getInstID()), NULL);
+    if (trans == NULL) {
+        trans = transMap.value(UAVTalk::transactionKey(objId, UAVTalk::ALL_INSTANCES), NULL);
     }
-    return NULL;
+    return trans;
 }
 
 void Telemetry::openTransaction(ObjectTransactionInfo *trans)
 {
-    quint32 objId  = trans->obj->getObjID();
     quint16 instId = trans->allInstances ? UAVTalk::ALL_INSTANCES : trans->obj->getInstID();
 
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId, NULL);
-    if (objTransactions == NULL) {
-        objTransactions = new QMap<quint32, ObjectTransactionInfo *>();
-        transMap.insert(objId, objTransactions);
+    transMap.insert(UAVTalk::transactionKey(trans->obj->getObjID(), instId), trans);
+    if (trans->objRequest || trans->acked) {
+        ++pendingTransactions;
     }
-    objTransactions->insert(instId, trans);
 }
 
 void Telemetry::closeTransaction(ObjectTransactionInfo *trans)
 {
-    quint32 objId  = trans->obj->getObjID();
     quint16 instId = trans->allInstances ? UAVTalk::ALL_INSTANCES : trans->obj->getInstID();
 
-    QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId, NULL);
-    if (objTransactions != NULL) {
-        objTransactions->remove(instId);
-        // Keep the map even if it is empty
-        // There are at most 100 different object IDs...
+    disarmTimeout(trans);
+    if (transMap.remove(UAVTalk::transactionKey(trans->obj->getObjID(), instId)) > 0) {
+        if (trans->objRequest || trans->acked) {
+            --pendingTransactions;
+        }
     }
-    delete trans;
+    transactionPool.release(trans);
 }
 
 void Telemetry::closeAllTransactions()
 {
-    foreach(quint32 objId, transMap.keys()) {
-        QMap<quint32, ObjectTransactionInfo *> *objTransactions = transMap.value(objId, NULL);
-        foreach(quint32 instId, objTransactions->keys()) {
-            ObjectTransactionInfo *trans = objTransactions->value(instId, NULL);
-
-            qWarning() << "Telemetry - closing active transaction for object" << trans->obj->toStringBrief();
-            objTransactions->remove(instId);
-            delete trans;
-        }
-        transMap.remove(objId);
-        delete objTransactions;
+    foreach(ObjectTransactionInfo * trans, transMap) {
+        qWarning() << "Telemetry - closing active transaction for object" << trans->obj->toStringBrief();
+        transactionPool.release(trans);
     }
+    transMap.clear();
+    for (int i = 0; i < timeoutWheel.size(); ++i) {
+        timeoutWheel[i].clear();
+    }
+    armedTransactions = 0;
+    wheelTimer->stop();
+    pendingTransactions = 0;
 }
 
-ObjectTransactionInfo::ObjectTransactionInfo(QObject *parent) : QObject(parent)
+/**
+ * (Re)start the timeout of a transaction, it expires in the first wheel tick after timeoutMs
+ */
+void Telemetry::armTimeout(ObjectTransactionInfo *trans, qint32 timeoutMs)
 {
-    obj = 0;
-    allInstances     = false;
-    objRequest       = false;
-    retriesRemaining = 0;
-    acked = false;
-    telem = 0;
-    // Setup transaction timer
-    timer = new QTimer(this);
-    timer->setSingleShot(true);
-    connect(timer, SIGNAL(timeout()), this, SLOT(timeout()));
+    disarmTimeout(trans);
+
+    qint64 now = updateClock.elapsed();
+    if (armedTransactions == 0) {
+        // the wheel was idle, it restarts from now
+        wheelTick = now / WHEEL_TICK_MS;
+        wheelTimer->start(WHEEL_TICK_MS);
+    }
+    trans->timeoutMs  = timeoutMs;
+    trans->deadlineMs = now + timeoutMs;
+    trans->wheelSlot  = qMax(trans->deadlineMs / WHEEL_TICK_MS, wheelTick) % WHEEL_SLOTS;
+    timeoutWheel[trans->wheelSlot].insert(trans);
+    ++armedTransactions;
 }
 
-ObjectTransactionInfo::~ObjectTransactionInfo()
+void Telemetry::disarmTimeout(ObjectTransactionInfo *trans)
 {
-    telem = 0;
-    timer->stop();
-    delete timer;
+    if (trans->wheelSlot < 0) {
+        return;
+    }
+    timeoutWheel[trans->wheelSlot].remove(trans);
+    trans->wheelSlot = -1;
+    if (--armedTransactions == 0) {
+        wheelTimer->stop();
+    }
 }
 
-void ObjectTransactionInfo::timeout()
+/**
+ * Advance the timing wheel to now and time out the expired transactions
+ */
+void Telemetry::processTimeouts()
 {
-    if (!telem.isNull()) {
-        telem->transactionTimeout(this);
+    QMutexLocker locker(mutex);
+
+    qint64 now = updateClock.elapsed();
+
+    // a tick is processed once all the deadlines it holds are due
+    while (armedTransactions > 0 && (wheelTick + 1) * WHEEL_TICK_MS <= now + 1) {
+        int slot = wheelTick % WHEEL_SLOTS;
+        bool expired = true;
+        while (expired) {
+            // the slot also holds the transactions of the next revolutions,
+            // and timing one out can close or re-arm others, so look it up again each time
+            expired = false;
+            foreach(ObjectTransactionInfo * trans, timeoutWheel.at(slot)) {
+                if (trans->deadlineMs <= now) {
+                    disarmTimeout(trans);
+                    transactionTimeout(trans);
+                    expired = true;
+                    break;
+                }
+            }
+        }
+        ++wheelTick;
     }
 }
+
+ObjectTransactionInfo::ObjectTransactionInfo()
+{
+    obj = 0;
+    allInstances     = false;
+    objRequest       = false;
+    retriesRemaining = 0;
+    acked = false;
+    sendTimeMs       = 0;
+    timeoutMs        = 0;
+    deadlineMs       = 0;
+    wheelSlot        = -1;
+}
@@ -31,27 +31,34 @@
 #include "uavtalk.h"
 #include "uavobjectmanager.h"
 #include "gcstelemetrystats.h"
+#include "recordpool.h"
 #include <QMutex>
 #include <QMutexLocker>
 #include <QTimer>
 #include <QQueue>
 #include <QMap>
-
-class ObjectTransactionInfo : public QObject {
-    Q_OBJECT
-
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QElapsedTimer>
+#include <functional>
+#include <queue>
+#include <vector>
+
+class ObjectTransactionInfo {
 public:
-    ObjectTransactionInfo(QObject *parent);
-    ~ObjectTransactionInfo();
+    ObjectTransactionInfo();
     UAVObject *obj;
     bool allInstances;
     bool objRequest;
     qint32 retriesRemaining;
     bool acked;
-    QPointer<class Telemetry>telem;
-    QTimer *timer;
-private slots:
-    void timeout();
+    qint64 sendTimeMs;
+    // timeout of the current attempt and when it expires
+    qint32 timeoutMs;
+    qint64 deadlineMs;
+    // slot in the timing wheel of the Telemetry, -1 when no response is awaited
+    int wheelSlot;
 };
 
 class Telemetry : public QObject {
@@ -73,19 +80,46 @@ public:
         quint32 rxCrcErrors;
     } TelemetryStats;
 
+    typedef struct {
+        RecordPoolStats queueEntries;
+        RecordPoolStats transactions;
+    } PoolStats;
+
     Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr);
     ~Telemetry();
     TelemetryStats getStats();
+    UAVTalk::LatencyStats getLatencyStats();
+    UAVTalk::BandwidthStats getBandwidthStats();
     void resetStats();
-    void transactionTimeout(ObjectTransactionInfo *info);
+    // Counters of the queue entry and transaction pools
+    PoolStats getPoolStats();
+    // Capacity of the link in bytes per second, 0 when unknown
+    void setLinkCapacity(qint32 bytesPerSecond);
+    // Number of transactions waiting for a response at the same time, on different objects
+    void setTransactionWindow(int window);
+    // Factor applied to the periods of the periodic updates (>= 1), see TelemetryMonitor
+    void setUpdatePeriodScale(double scale);
 
 private:
     // Constants
+    // initial request timeout, then adapted to the round trip time
     static const int REQ_TIMEOUT_MS = 250;
+    static const int MIN_REQ_TIMEOUT_MS = 100;
+    static const int MAX_REQ_TIMEOUT_MS = 3000;
+    static const int DEFAULT_TRANSACTION_WINDOW = 4;
     static const int MAX_RETRIES    = 2;
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
-    static const int MAX_QUEUE_SIZE = 20;
+    // share of the link capacity the regular updates can use, in percent
+    static const int REGULAR_LINK_SHARE   = 75;
+    // UAVTalk header and checksum
+    static const int PACKET_OVERHEAD      = 11;
+    // timing wheel of the transaction timeouts, one revolution covers MAX_REQ_TIMEOUT_MS
+    static const int WHEEL_TICK_MS = 10;
+    static const int WHEEL_SLOTS   = 512;
+    // free records kept by the pools, above the usual working set
+    static const int QUEUE_POOL_SIZE       = 256;
+    static const int TRANSACTION_POOL_SIZE = 32;
 
     // Types
     /**
@@ -103,9 +137,22 @@ private:
     typedef struct {
         UAVObject *obj;
         qint32    updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
-        qint32    timeToNextUpdateMs; /** Time delay to the next update */
+        quint32   generation; /** Incremented when the period changes, to ignore the previous schedule */
     } ObjectTimeInfo;
 
+    /**
+     * Scheduled periodic update, in the min-heap of updates by due time
+     */
+    typedef struct PeriodicUpdate {
+        qint64  dueMs;
+        quint32 objId;
+        quint32 generation;
+        bool operator>(const PeriodicUpdate &other) const
+        {
+            return dueMs > other.dueMs;
+        }
+    } PeriodicUpdate;
+
     typedef struct {
         UAVObject *obj;
         EventMask event;
@@ -116,14 +163,41 @@ private:
     UAVObjectManager *objMngr;
     UAVTalk *utalk;
     GCSTelemetryStats *gcsStatsObj;
-    QList<ObjectTimeInfo> objList;
-    QQueue<ObjectQueueInfo> objQueue;
-    QQueue<ObjectQueueInfo> objPriorityQueue;
-    QMap<quint32, QMap<quint32, ObjectTransactionInfo *> *> transMap;
+    QHash<quint32, ObjectTimeInfo> objTimes;
+    std::priority_queue<PeriodicUpdate, std::vector<PeriodicUpdate>, std::greater<PeriodicUpdate> > updateQueue;
+    QElapsedTimer updateClock;
+    // events of the flight control objects, then the priority and the regular events
+    QQueue<ObjectQueueInfo *> objControlQueue;
+    QQueue<ObjectQueueInfo *> objPriorityQueue;
+    QQueue<ObjectQueueInfo *> objQueue;
+    // the queue entries and transactions come from these pools
+    RecordPool<ObjectQueueInfo> queuePool;
+    RecordPool<ObjectTransactionInfo> transactionPool;
+    // the queued events, an object event is queued once (the object is packed when sent)
+    QSet<QPair<UAVObject *, int> > queuedEvents;
+    // transactions waiting for a response, at most transactionWindow
+    int transactionWindow;
+    int pendingTransactions;
+    double rttAverage;
+    double rttVariation;
+    int requestTimeoutMs;
+    // periods of the periodic updates are stretched by this factor when the link is congested
+    double updatePeriodScale;
+    // pacing of the regular events to the link capacity
+    qint32 linkCapacity;
+    qint64 pacingBudget;
+    qint64 pacingTimeMs;
+    QTimer *pacingTimer;
+    // pending transactions by UAVTalk::transactionKey()
+    QHash<quint64, ObjectTransactionInfo *> transMap;
+    // armed transactions by expiry tick modulo WHEEL_SLOTS, checked by wheelTimer while any is armed
+    QVector<QSet<ObjectTransactionInfo *> > timeoutWheel;
+    qint64 wheelTick;
+    int armedTransactions;
+    QTimer *wheelTimer;
     QMutex *mutex;
     QTimer *updateTimer;
     QTimer *statsTimer;
-    qint32 timeToNextUpdateMs;
     quint32 txErrors;
     quint32 txRetries;
 
@@ -136,12 +210,27 @@ private:
     void updateObject(UAVObject *obj, quint32 eventMask);
     void processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances, bool priority);
     void processObjectTransaction(ObjectTransactionInfo *transInfo);
-    void processObjectQueue();
+    bool processObjectQueue();
+    void processObjectQueues();
+    bool needsResponse(const ObjectQueueInfo &objInfo);
+    void updateRoundTripTime(qint64 rttMs);
+    bool enqueueObject(QQueue<ObjectQueueInfo *> &queue, const ObjectQueueInfo &objInfo);
+    ObjectQueueInfo dequeueObject(QQueue<ObjectQueueInfo *> &queue);
+    void clearObjectQueue(QQueue<ObjectQueueInfo *> &queue);
+    qint32 pacingDelay(const ObjectQueueInfo &objInfo);
+    void scheduleNextUpdate();
 
     ObjectTransactionInfo *findTransaction(UAVObject *obj);
     void openTransaction(ObjectTransactionInfo *trans);
     void closeTransaction(ObjectTransactionInfo *trans);
     void closeAllTransactions();
+    void transactionTimeout(ObjectTransactionInfo *info);
+    void armTimeout(ObjectTransactionInfo *trans, qint32 timeoutMs);
+    void disarmTimeout(ObjectTransactionInfo *trans);
+
+signals:
+    // the flight side answered with a NACK, it does not know this object definition
+    void objectRejected(UAVObject *obj);
 
 private slots:
     void objectUpdatedAuto(UAVObject *obj);
@@ -152,7 +241,10 @@ private slots:
     void newObject(UAVObject *obj);
     void newInstance(UAVObject *obj);
     void processPeriodicUpdates();
+    void processPacedUpdates();
+    void processTimeouts();
     void transactionCompleted(UAVObject *obj, bool success);
+    void transactionProgress(UAVObject *obj);
 };
 
 #endif // TELEMETRY_H
@@ -0,0 +1,215 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryconnection.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      One telemetry link to one vehicle
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "telemetryconnection.h"
+#include "telemetry.h"
+#include "telemetrymonitor.h"
+
+TelemetryConnection::TelemetryConnection(UAVObjectManager *objectManager, QThread *thread) : QObject(),
+    m_uavobjectManager(objectManager), m_uavTalk(NULL), m_telemetry(NULL), m_telemetryMonitor(NULL), m_telemetryDevice(NULL),
+    m_connectionState(TELEMETRY_DISCONNECTED), m_poolStats()
+{
+    moveToThread(thread);
+
+    // connect to start stop signals
+    connect(this, SIGNAL(myStart()), this, SLOT(onStart()), Qt::QueuedConnection);
+    connect(this, SIGNAL(myStop()), this, SLOT(onStop()), Qt::QueuedConnection);
+}
+
+TelemetryConnection::~TelemetryConnection()
+{}
+
+UAVObjectManager *TelemetryConnection::objectManager() const
+{
+    return m_uavobjectManager;
+}
+
+bool TelemetryConnection::isConnected() const
+{
+    return m_connectionState == TELEMETRY_CONNECTED;
+}
+
+TelemetryConnection::ConnectionState TelemetryConnection::connectionState() const
+{
+    return m_connectionState;
+}
+
+UAVTalk::LatencyStats TelemetryConnection::latencyStats() const
+{
+    QMutexLocker locker(&m_latencyMutex);
+
+    return m_latencyStats;
+}
+
+Telemetry::PoolStats TelemetryConnection::poolStats() const
+{
+    QMutexLocker locker(&m_latencyMutex);
+
+    return m_poolStats;
+}
+
+UAVTalk::BandwidthStats TelemetryConnection::bandwidthStats() const
+{
+    QMutexLocker locker(&m_latencyMutex);
+
+    return m_bandwidthStats;
+}
+
+void TelemetryConnection::start(QIODevice *dev)
+{
+    m_connectionState = TELEMETRY_CONNECTING;
+    emit connecting();
+
+    m_telemetryDevice = dev;
+    // OP-1383
+    // take ownership of the device by moving it to the connection thread (see TelemetryConnection constructor)
+    // this removes the following runtime Qt warning and incidentally fixes GCS crashes:
+    // QObject: Cannot create children for a parent that is in a different thread.
+    // (Parent is QSerialPort(0x56af73f8), parent's thread is QThread(0x23f69ae8), current thread is QThread(0x2649cfd8)
+    m_telemetryDevice->moveToThread(thread());
+    emit myStart();
+}
+
+void TelemetryConnection::addFrameTap(UAVTalk::FrameTap *tap)
+{
+    QMutexLocker locker(&m_frameTapMutex);
+
+    if (!m_frameTaps.contains(tap)) {
+        m_frameTaps.append(tap);
+    }
+    if (m_uavTalk) {
+        m_uavTalk->addFrameTap(tap);
+    }
+}
+
+void TelemetryConnection::removeFrameTap(UAVTalk::FrameTap *tap)
+{
+    QMutexLocker locker(&m_frameTapMutex);
+
+    m_frameTaps.removeAll(tap);
+    if (m_uavTalk) {
+        m_uavTalk->removeFrameTap(tap);
+    }
+}
+
+void TelemetryConnection::markControlSample(quint32 objId, qint64 timestamp)
+{
+    QMutexLocker locker(&m_frameTapMutex);
+
+    if (m_uavTalk) {
+        m_uavTalk->markControlSample(objId, timestamp);
+    }
+}
+
+void TelemetryConnection::onStart()
+{
+    {
+        QMutexLocker locker(&m_frameTapMutex);
+        m_uavTalk = new UAVTalk(m_telemetryDevice, m_uavobjectManager);
+        foreach(UAVTalk::FrameTap * tap, m_frameTaps) {
+            m_uavTalk->addFrameTap(tap);
+        }
+    }
+    // This thread is the I/O thread of the link: the device, UAVTalk, Telemetry and TelemetryMonitor
+    // all live here, so decoding, acks, retries and transaction timeouts never wait for the GUI thread.
+    // The GUI only gets the queued object update signals it subscribed to.
+    connect(m_telemetryDevice, SIGNAL(readyRead()), m_uavTalk, SLOT(processInputStream()));
+
+    m_telemetry = new Telemetry(m_uavTalk, m_uavobjectManager);
+    // serial ports tell their baud rate (10 bits per byte), the other links are not paced
+    QVariant baudRate = m_telemetryDevice->property("baudRate");
+    if (baudRate.isValid() && baudRate.toInt() > 0) {
+        m_telemetry->setLinkCapacity(baudRate.toInt() / 10);
+    }
+    m_telemetryMonitor = new TelemetryMonitor(m_uavobjectManager, m_telemetry);
+
+    connect(m_telemetryMonitor, SIGNAL(connected()), this, SLOT(onConnect()));
+    connect(m_telemetryMonitor, SIGNAL(disconnected()), this, SLOT(onDisconnect()));
+    connect(m_telemetryMonitor, SIGNAL(telemetryUpdated(double, double)), this, SLOT(onTelemetryUpdate(double, double)));
+    connect(m_telemetryMonitor, SIGNAL(retrievalProgress(int, int)), this, SIGNAL(retrievalProgress(int, int)));
+    connect(m_telemetryMonitor, SIGNAL(latencyUpdated()), this, SLOT(onLatencyUpdate()));
+}
+
+void TelemetryConnection::stop()
+{
+    m_connectionState = TELEMETRY_DISCONNECTING;
+    emit disconnecting();
+    emit myStop();
+}
+
+void TelemetryConnection::onStop()
+{
+    if (!m_telemetryMonitor) {
+        // never started
+        return;
+    }
+    m_telemetryMonitor->disconnect(this);
+    delete m_telemetryMonitor;
+    m_telemetryMonitor = NULL;
+    delete m_telemetry;
+    m_telemetry = NULL;
+    {
+        QMutexLocker locker(&m_frameTapMutex);
+        delete m_uavTalk;
+        m_uavTalk = NULL;
+    }
+    {
+        QMutexLocker locker(&m_latencyMutex);
+        m_latencyStats   = UAVTalk::LatencyStats();
+        m_poolStats      = Telemetry::PoolStats();
+        m_bandwidthStats = UAVTalk::BandwidthStats();
+    }
+    onDisconnect();
+}
+
+void TelemetryConnection::onLatencyUpdate()
+{
+    {
+        QMutexLocker locker(&m_latencyMutex);
+        m_latencyStats   = m_telemetryMonitor->getLatencyStats();
+        m_poolStats      = m_telemetryMonitor->getPoolStats();
+        m_bandwidthStats = m_telemetryMonitor->getBandwidthStats();
+    }
+    emit latencyUpdated();
+}
+
+void TelemetryConnection::onConnect()
+{
+    m_connectionState = TELEMETRY_CONNECTED;
+    emit connected();
+}
+
+void TelemetryConnection::onDisconnect()
+{
+    m_connectionState = TELEMETRY_DISCONNECTED;
+    emit disconnected();
+}
+
+void TelemetryConnection::onTelemetryUpdate(double txRate, double rxRate)
+{
+    emit telemetryUpdated(txRate, rxRate);
+}
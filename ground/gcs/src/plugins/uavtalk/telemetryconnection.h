@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryconnection.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      One telemetry link to one vehicle
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef TELEMETRYCONNECTION_H
+#define TELEMETRYCONNECTION_H
+
+#include "uavtalk_global.h"
+#include "uavtalk.h"
+#include "telemetry.h"
+#include "uavobjectmanager.h"
+#include <QIODevice>
+#include <QObject>
+#include <QMutex>
+#include <QThread>
+
+class TelemetryMonitor;
+
+/**
+ * One telemetry link: the UAVTalk codec, Telemetry and TelemetryMonitor of a device
+ * and the object manager they update. Lives in the thread given at construction,
+ * which is the I/O thread of the link, start() and stop() may be called from any thread.
+ */
+class UAVTALK_EXPORT TelemetryConnection : public QObject {
+    Q_OBJECT
+
+public:
+    enum ConnectionState {
+        TELEMETRY_DISCONNECTED,
+        TELEMETRY_CONNECTED,
+        TELEMETRY_DISCONNECTING,
+        TELEMETRY_CONNECTING
+    };
+
+    TelemetryConnection(UAVObjectManager *objectManager, QThread *thread);
+    ~TelemetryConnection();
+
+    void start(QIODevice *dev);
+    void stop();
+    bool isConnected() const;
+    ConnectionState connectionState() const;
+    // The objects of the vehicle on this link
+    UAVObjectManager *objectManager() const;
+    // Receive latencies over the last statistics period, empty when not connected
+    UAVTalk::LatencyStats latencyStats() const;
+    // Queue entries and transactions in use, as of the last statistics period
+    Telemetry::PoolStats poolStats() const;
+    // Packets and bytes by object over the last statistics period, empty when not connected
+    UAVTalk::BandwidthStats bandwidthStats() const;
+    // Tap the object packets of the current and next connections, see UAVTalk::addFrameTap()
+    void addFrameTap(UAVTalk::FrameTap *tap);
+    void removeFrameTap(UAVTalk::FrameTap *tap);
+    // Time the input of the next control object update was sampled, see UAVTalk::markControlSample()
+    void markControlSample(quint32 objId, qint64 timestamp);
+
+signals:
+    void connecting();
+    void connected();
+    void disconnecting();
+    void disconnected();
+    void telemetryUpdated(double txRate, double rxRate);
+    void retrievalProgress(int retrieved, int total);
+    void latencyUpdated();
+    void myStart();
+    void myStop();
+
+private slots:
+    void onConnect();
+    void onDisconnect();
+    void onTelemetryUpdate(double txRate, double rxRate);
+    void onLatencyUpdate();
+    void onStart();
+    void onStop();
+
+private:
+    UAVObjectManager *m_uavobjectManager;
+    UAVTalk *m_uavTalk;
+    Telemetry *m_telemetry;
+    TelemetryMonitor *m_telemetryMonitor;
+    QIODevice *m_telemetryDevice;
+    ConnectionState m_connectionState;
+    // copy of the monitor latencies, read from other threads
+    UAVTalk::LatencyStats m_latencyStats;
+    Telemetry::PoolStats m_poolStats;
+    UAVTalk::BandwidthStats m_bandwidthStats;
+    mutable QMutex m_latencyMutex;
+    QList<UAVTalk::FrameTap *> m_frameTaps;
+    // guards m_frameTaps and the lifetime of m_uavTalk as seen from other threads
+    QMutex m_frameTapMutex;
+
+};
+
+#endif // TELEMETRYCONNECTION_H
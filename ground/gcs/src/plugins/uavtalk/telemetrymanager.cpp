@@ -27,127 +27,147 @@
  */
 
 #include "telemetrymanager.h"
-#include "telemetry.h"
-#include "telemetrymonitor.h"
+#include "uavobjectsinit.h"
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/threadmanager.h>
 
-TelemetryManager::TelemetryManager() : QObject(), m_connectionState(TELEMETRY_DISCONNECTED)
+TelemetryManager::TelemetryManager() : QObject()
 {
-    moveToThread(Core::ICore::instance()->threadManager()->getRealTimeThread());
-
     // Get UAVObjectManager instance
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    m_uavobjectManager = pm->getObject<UAVObjectManager>();
 
-    // connect to start stop signals
-    connect(this, SIGNAL(myStart()), this, SLOT(onStart()), Qt::QueuedConnection);
-    connect(this, SIGNAL(myStop()), this, SLOT(onStop()), Qt::QueuedConnection);
+    init(pm->getObject<UAVObjectManager>(), Core::ICore::instance()->threadManager()->getRealTimeThread());
+}
+
+TelemetryManager::TelemetryManager(UAVObjectManager *objectManager, QThread *thread) : QObject()
+{
+    init(objectManager, thread);
+}
+
+void TelemetryManager::init(UAVObjectManager *objectManager, QThread *thread)
+{
+    m_primaryConnection = new TelemetryConnection(objectManager, thread);
+    m_connections.append(m_primaryConnection);
+
+    connect(m_primaryConnection, SIGNAL(connecting()), this, SIGNAL(connecting()));
+    connect(m_primaryConnection, SIGNAL(connected()), this, SIGNAL(connected()));
+    connect(m_primaryConnection, SIGNAL(disconnecting()), this, SIGNAL(disconnecting()));
+    connect(m_primaryConnection, SIGNAL(disconnected()), this, SIGNAL(disconnected()));
+    connect(m_primaryConnection, SIGNAL(telemetryUpdated(double, double)), this, SIGNAL(telemetryUpdated(double, double)));
+    connect(m_primaryConnection, SIGNAL(retrievalProgress(int, int)), this, SIGNAL(retrievalProgress(int, int)));
+    connect(m_primaryConnection, SIGNAL(latencyUpdated()), this, SIGNAL(latencyUpdated()));
 }
 
 TelemetryManager::~TelemetryManager()
-{}
+{
+    foreach(TelemetryConnection * connection, m_connectionThreads.keys()) {
+        removeConnection(connection);
+    }
+    delete m_primaryConnection;
+}
 
 bool TelemetryManager::isConnected() const
 {
-    return m_connectionState == TELEMETRY_CONNECTED;
+    return m_primaryConnection->isConnected();
 }
 
 TelemetryManager::ConnectionState TelemetryManager::connectionState() const
 {
-    return m_connectionState;
+    return static_cast<ConnectionState>(m_primaryConnection->connectionState());
 }
 
-void TelemetryManager::start(QIODevice *dev)
+UAVTalk::LatencyStats TelemetryManager::latencyStats() const
 {
-    m_connectionState = TELEMETRY_CONNECTING;
-    emit connecting();
-
-    m_telemetryDevice = dev;
-    // OP-1383
-    // take ownership of the device by moving it to the TelemetryManager thread (see TelemetryManager constructor)
-    // this removes the following runtime Qt warning and incidentally fixes GCS crashes:
-    // QObject: Cannot create children for a parent that is in a different thread.
-    // (Parent is QSerialPort(0x56af73f8), parent's thread is QThread(0x23f69ae8), current thread is QThread(0x2649cfd8)
-    m_telemetryDevice->moveToThread(thread());
-    emit myStart();
-}
-
-void TelemetryManager::onStart()
-{
-    m_uavTalk = new UAVTalk(m_telemetryDevice, m_uavobjectManager);
-    if (false) {
-        // UAVTalk must be thread safe and for that:
-        // 1- all public methods must lock a mutex
-        // 2- the reader thread must lock that mutex too
-        // The reader thread locks the mutex once a packet is read and decoded.
-        // It is assumed that the UAVObjectManager is thread safe
-
-        // Create the reader and move it to the reader thread
-        IODeviceReader *reader = new IODeviceReader(m_uavTalk);
-        reader->moveToThread(&m_telemetryReaderThread);
-        // The reader will be deleted (later) when the thread finishes
-        connect(&m_telemetryReaderThread, &QThread::finished, reader, &QObject::deleteLater);
-        // Connect IO device to reader
-        connect(m_telemetryDevice, SIGNAL(readyRead()), reader, SLOT(read()));
-        // start the reader thread
-        m_telemetryReaderThread.start();
-    } else {
-        // Connect IO device to reader
-        connect(m_telemetryDevice, SIGNAL(readyRead()), m_uavTalk, SLOT(processInputStream()));
-    }
+    return m_primaryConnection->latencyStats();
+}
+
+Telemetry::PoolStats TelemetryManager::poolStats() const
+{
+    return m_primaryConnection->poolStats();
+}
 
-    m_telemetry = new Telemetry(m_uavTalk, m_uavobjectManager);
-    m_telemetryMonitor = new TelemetryMonitor(m_uavobjectManager, m_telemetry);
+UAVTalk::BandwidthStats TelemetryManager::bandwidthStats() const
+{
+    return m_primaryConnection->bandwidthStats();
+}
 
-    connect(m_telemetryMonitor, SIGNAL(connected()), this, SLOT(onConnect()));
-    connect(m_telemetryMonitor, SIGNAL(disconnected()), this, SLOT(onDisconnect()));
-    connect(m_telemetryMonitor, SIGNAL(telemetryUpdated(double, double)), this, SLOT(onTelemetryUpdate(double, double)));
+void TelemetryManager::start(QIODevice *dev)
+{
+    m_primaryConnection->start(dev);
 }
 
 void TelemetryManager::stop()
 {
-    m_connectionState = TELEMETRY_DISCONNECTING;
-    emit disconnecting();
-    emit myStop();
+    m_primaryConnection->stop();
+}
 
-    if (false) {
-        m_telemetryReaderThread.quit();
-        m_telemetryReaderThread.wait();
-    }
+void TelemetryManager::addFrameTap(UAVTalk::FrameTap *tap)
+{
+    m_primaryConnection->addFrameTap(tap);
 }
 
-void TelemetryManager::onStop()
+void TelemetryManager::removeFrameTap(UAVTalk::FrameTap *tap)
 {
-    m_telemetryMonitor->disconnect(this);
-    delete m_telemetryMonitor;
-    delete m_telemetry;
-    delete m_uavTalk;
-    onDisconnect();
+    m_primaryConnection->removeFrameTap(tap);
 }
 
-void TelemetryManager::onConnect()
+void TelemetryManager::markControlSample(quint32 objId, qint64 timestamp)
 {
-    m_connectionState = TELEMETRY_CONNECTED;
-    emit connected();
+    m_primaryConnection->markControlSample(objId, timestamp);
 }
 
-void TelemetryManager::onDisconnect()
+TelemetryConnection *TelemetryManager::primaryConnection() const
 {
-    m_connectionState = TELEMETRY_DISCONNECTED;
-    emit disconnected();
+    return m_primaryConnection;
 }
 
-void TelemetryManager::onTelemetryUpdate(double txRate, double rxRate)
+QList<TelemetryConnection *> TelemetryManager::connections() const
 {
-    emit telemetryUpdated(txRate, rxRate);
+    return m_connections;
 }
 
-IODeviceReader::IODeviceReader(UAVTalk *uavTalk) : m_uavTalk(uavTalk)
-{}
+TelemetryConnection *TelemetryManager::addConnection(QIODevice *dev)
+{
+    // a vehicle of its own, with the same object definitions as the global manager
+    UAVObjectManager *objectManager = new UAVObjectManager();
+
+    UAVObjectsInitialize(objectManager);
 
-void IODeviceReader::read()
+    // one thread per link, so the decoding of several vehicles runs in parallel
+    QThread *thread = new QThread();
+    thread->setObjectName(QString("Telemetry%1").arg(m_connections.size()));
+    // no thread manager in the headless tools
+    if (Core::ThreadManager::instance()) {
+        Core::ThreadManager::instance()->manageThread(thread, Core::ThreadManager::TelemetryRole);
+    }
+    thread->start();
+
+    TelemetryConnection *connection = new TelemetryConnection(objectManager, thread);
+    m_connections.append(connection);
+    m_connectionThreads.insert(connection, thread);
+    connection->start(dev);
+    emit connectionAdded(connection);
+    return connection;
+}
+
+void TelemetryManager::removeConnection(TelemetryConnection *connection)
 {
-    m_uavTalk->processInputStream();
+    QThread *thread = m_connectionThreads.take(connection);
+
+    if (!thread) {
+        // the primary connection is stopped, not removed
+        return;
+    }
+    m_connections.removeAll(connection);
+    emit connectionRemoved(connection);
+
+    // tear the link down in its own thread, then the thread itself
+    UAVObjectManager *objectManager = connection->objectManager();
+    connect(connection, SIGNAL(destroyed()), thread, SLOT(quit()), Qt::DirectConnection);
+    connection->stop();
+    connection->deleteLater();
+    thread->wait();
+    delete thread;
+    delete objectManager;
 }
@@ -31,31 +31,61 @@
 
 #include "uavtalk_global.h"
 #include "uavtalk.h"
+#include "telemetryconnection.h"
 #include "uavobjectmanager.h"
 #include <QIODevice>
 #include <QObject>
+#include <QHash>
+#include <QList>
 
-class Telemetry;
-class TelemetryMonitor;
-
+/**
+ * Owns the telemetry connections of the GCS.
+ *
+ * The primary connection updates the global UAVObjectManager and is what the
+ * start(), stop() and state methods below act on. Further connections, one per
+ * extra vehicle, each get their own object manager and thread; gadgets bind to a
+ * vehicle through TelemetryConnection::objectManager().
+ */
 class UAVTALK_EXPORT TelemetryManager : public QObject {
     Q_OBJECT
 
 public:
     enum ConnectionState {
-        TELEMETRY_DISCONNECTED,
-        TELEMETRY_CONNECTED,
-        TELEMETRY_DISCONNECTING,
-        TELEMETRY_CONNECTING
+        TELEMETRY_DISCONNECTED  = TelemetryConnection::TELEMETRY_DISCONNECTED,
+        TELEMETRY_CONNECTED     = TelemetryConnection::TELEMETRY_CONNECTED,
+        TELEMETRY_DISCONNECTING = TelemetryConnection::TELEMETRY_DISCONNECTING,
+        TELEMETRY_CONNECTING    = TelemetryConnection::TELEMETRY_CONNECTING
     };
 
     TelemetryManager();
+    // Without the GCS (headless tools): the primary connection updates objectManager from thread
+    TelemetryManager(UAVObjectManager *objectManager, QThread *thread);
     ~TelemetryManager();
 
     void start(QIODevice *dev);
     void stop();
     bool isConnected() const;
     ConnectionState connectionState() const;
+    // Receive latencies over the last statistics period, empty when not connected
+    UAVTalk::LatencyStats latencyStats() const;
+    // Queue entries and transactions in use, see TelemetryConnection::poolStats()
+    Telemetry::PoolStats poolStats() const;
+    // Packets and bytes by object over the last statistics period, refreshed with latencyUpdated()
+    UAVTalk::BandwidthStats bandwidthStats() const;
+    // Tap the object packets of the current and next connections, see UAVTalk::addFrameTap()
+    void addFrameTap(UAVTalk::FrameTap *tap);
+    void removeFrameTap(UAVTalk::FrameTap *tap);
+    // Time the input of the next control object update was sampled, see UAVTalk::markControlSample()
+    void markControlSample(quint32 objId, qint64 timestamp);
+
+    // The connection of the global object manager, always present
+    TelemetryConnection *primaryConnection() const;
+    // Every connection, the primary one first
+    QList<TelemetryConnection *> connections() const;
+    // Starts a connection with its own object manager and thread, dev must outlive it
+    TelemetryConnection *addConnection(QIODevice *dev);
+    // Stops and deletes a connection made by addConnection() along with its object manager
+    void removeConnection(TelemetryConnection *connection);
 
 signals:
     void connecting();
@@ -63,36 +93,19 @@ signals:
     void disconnecting();
     void disconnected();
     void telemetryUpdated(double txRate, double rxRate);
-    void myStart();
-    void myStop();
-
-private slots:
-    void onConnect();
-    void onDisconnect();
-    void onTelemetryUpdate(double txRate, double rxRate);
-    void onStart();
-    void onStop();
+    void retrievalProgress(int retrieved, int total);
+    void latencyUpdated();
+    void connectionAdded(TelemetryConnection *connection);
+    // emitted before the connection and its object manager are deleted
+    void connectionRemoved(TelemetryConnection *connection);
 
 private:
-    UAVObjectManager *m_uavobjectManager;
-    UAVTalk *m_uavTalk;
-    Telemetry *m_telemetry;
-    TelemetryMonitor *m_telemetryMonitor;
-    QIODevice *m_telemetryDevice;
-    ConnectionState m_connectionState;
-    QThread m_telemetryReaderThread;
-};
-
-
-class IODeviceReader : public QObject {
-    Q_OBJECT
-public:
-    IODeviceReader(UAVTalk *uavTalk);
-
-    UAVTalk *m_uavTalk;
+    void init(UAVObjectManager *objectManager, QThread *thread);
 
-public slots:
-    void read();
+    TelemetryConnection *m_primaryConnection;
+    QList<TelemetryConnection *> m_connections;
+    // threads of the connections made by addConnection()
+    QHash<TelemetryConnection *, QThread *> m_connectionThreads;
 };
 
 #endif // TELEMETRY_MANAGER_H
@@ -30,6 +30,9 @@
 #include "coreplugin/connectionmanager.h"
 #include "coreplugin/icore.h"
 
+#include <QSettings>
+#include <QStringList>
+
 /**
  * Constructor
  */
@@ -39,14 +42,22 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel) :
     gcsStatsObj(GCSTelemetryStats::GetInstance(objMngr)),
     flightStatsObj(FlightTelemetryStats::GetInstance(objMngr)),
     firmwareIAPObj(FirmwareIAPObj::GetInstance(objMngr)),
+    opLinkStatusObj(OPLinkStatus::GetInstance(objMngr)),
     statsTimer(new QTimer(this)),
-    objPending(NULL),
+    retrievedCount(0),
     mutex(new QMutex(QMutex::Recursive)),
-    connectionTimer(new QTime())
+    connectionTimer(new QTime()),
+    poolStats(tel->getPoolStats()),
+    updatePeriodScale(1.0),
+    lastFlightTxRetries(0),
+    lastFlightRxFailures(0)
 {
     // Listen for flight stats updates
     connect(flightStatsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(flightStatsUpdated(UAVObject *)));
 
+    // Learn the object definitions unknown to the firmware
+    connect(tel, SIGNAL(objectRejected(UAVObject *)), this, SLOT(objectRejected(UAVObject *)));
+
     // Start update timer
     connect(statsTimer, SIGNAL(timeout()), this, SLOT(processStatsUpdates()));
     statsTimer->start(STATS_CONNECT_PERIOD_MS);
@@ -63,34 +74,99 @@ TelemetryMonitor::~TelemetryMonitor()
 }
 
 /**
- * Initiate object retrieval, initialize queue with objects to be retrieved.
+ * Initiate object retrieval: the firmware description comes first, it holds the hash of the firmware
+ * object definitions. The object IDs are hashes of the definitions too, the objects rejected by
+ * a firmware of the same hash on a previous connection are then skipped instead of requested.
  */
 void TelemetryMonitor::startRetrievingObjects()
 {
-    // Clear object queue
-    queue.clear();
-    // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the queue
+    stopRetrievingObjects();
+    connectionTime.start();
+    connect(firmwareIAPObj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(firmwareDescriptionRetrieved(UAVObject *, bool)));
+    firmwareIAPObj->requestUpdate();
+}
+
+/**
+ * Called when the firmware description is retrieved, or not
+ */
+void TelemetryMonitor::firmwareDescriptionRetrieved(UAVObject *obj, bool success)
+{
+    Q_UNUSED(obj);
+    QMutexLocker locker(mutex);
+
+    disconnect(firmwareIAPObj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(firmwareDescriptionRetrieved(UAVObject *, bool)));
+
+    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
+    if (gcsStats.Status != GCSTelemetryStats::STATUS_CONNECTED) {
+        return;
+    }
+
+    // see UAVObjectUtilManager::getBoardDescriptionStruct()
+    firmwareUavoHash.clear();
+    if (success) {
+        FirmwareIAPObj::DataFields firmwareIapData = firmwareIAPObj->getData();
+        QByteArray description((const char *)firmwareIapData.Description, FirmwareIAPObj::DESCRIPTION_NUMELEM);
+        if (description.startsWith("OpFw")) {
+            firmwareUavoHash = description.mid(60, 20);
+        }
+    }
+    rejectedObjects = loadRejectedObjects();
+    retrieveObjects();
+}
+
+/**
+ * All the objects to be retrieved are requested in one burst,
+ * the telemetry keeps several requests in flight, and the completions are tracked in a bitmap.
+ */
+void TelemetryMonitor::retrieveObjects()
+{
+    int skipped = 0;
+
+    // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the list
     QList< QList<UAVObject *> > objs = objMngr->getObjects();
     for (int n = 0; n < objs.length(); ++n) {
         UAVObject *obj = objs[n][0];
         UAVMetaObject *mobj = dynamic_cast<UAVMetaObject *>(obj);
         UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
         UAVObject::Metadata mdata = obj->getMetadata();
+        bool retrieve = false;
         if (mobj != NULL) {
-            queue.enqueue(obj);
+            retrieve = true;
         } else if (dobj != NULL) {
             if (dobj->isSettingsObject()) {
-                queue.enqueue(obj);
+                retrieve = true;
             } else {
-                if (UAVObject::GetFlightTelemetryUpdateMode(mdata) == UAVObject::UPDATEMODE_ONCHANGE) {
-                    queue.enqueue(obj);
-                }
+                // the firmware description is already there
+                retrieve = UAVObject::GetFlightTelemetryUpdateMode(mdata) == UAVObject::UPDATEMODE_ONCHANGE && obj != firmwareIAPObj;
             }
         }
+        if (retrieve && rejectedObjects.contains(obj->getObjID())) {
+            obj->setIsKnown(false);
+            ++skipped;
+        } else if (retrieve) {
+            retrieveList.append(obj);
+        }
     }
+    retrieved = QBitArray(retrieveList.length());
+    retrievedCount = 0;
+
     // Start retrieving
-    qDebug() << "TelemetryMonitor::startRetrievingObjects - retrieving" << queue.length() << "objects";
-    retrieveNextObject();
+    qDebug() << "TelemetryMonitor::retrieveObjects - retrieving" << retrieveList.length() << "objects, skipping"
+             << skipped << "objects unknown to the firmware";
+    emit retrievalProgress(0, retrieveList.length());
+    if (retrieveList.isEmpty()) {
+        objectsRetrieved();
+        return;
+    }
+    for (int n = 0; n < retrieveList.length(); ++n) {
+        UAVObject *obj = retrieveList[n];
+        retrieveIndex.insert(obj, n);
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    }
+    // Request updates, in a separate loop as a request can complete right away
+    foreach(UAVObject * obj, retrieveList) {
+        obj->requestUpdate();
+    }
 }
 
 /**
@@ -98,61 +174,119 @@ void TelemetryMonitor::startRetrievingObjects()
  */
 void TelemetryMonitor::stopRetrievingObjects()
 {
-    qDebug() << "TelemetryMonitor::stopRetrievingObjects - object retrieval has been cancelled";
-    queue.clear();
+    disconnect(firmwareIAPObj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(firmwareDescriptionRetrieved(UAVObject *, bool)));
+    if (retrievedCount < retrieveList.length()) {
+        qDebug() << "TelemetryMonitor::stopRetrievingObjects - object retrieval has been cancelled";
+    }
+    for (int n = 0; n < retrieveList.length(); ++n) {
+        if (!retrieved.testBit(n)) {
+            disconnect(retrieveList[n], SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+        }
+    }
+    retrieveList.clear();
+    retrieveIndex.clear();
+    retrieved.clear();
+    retrievedCount = 0;
 }
 
 /**
- * Retrieve the next object in the queue
+ * All the objects have been retrieved
  */
-void TelemetryMonitor::retrieveNextObject()
+void TelemetryMonitor::objectsRetrieved()
 {
-    // If queue is empty return
-    if (queue.isEmpty()) {
-        qDebug() << "TelemetryMonitor::retrieveNextObject - object retrieval completed";
-        if (firmwareIAPObj->getBoardType()) {
-            emit connected();
-        } else {
-            connect(firmwareIAPObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(firmwareIAPUpdated(UAVObject *)));
-        }
-        return;
+    qDebug() << "TelemetryMonitor::objectsRetrieved - object retrieval completed in" << connectionTime.elapsed() << "ms";
+    saveRejectedObjects();
+    if (firmwareIAPObj->getBoardType()) {
+        emit connected();
+    } else {
+        connect(firmwareIAPObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(firmwareIAPUpdated(UAVObject *)));
     }
+}
 
-    // Get next object from the queue
-    UAVObject *obj = queue.dequeue();
-    // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
+/**
+ * Called by the retrieved objects when a transaction is completed.
+ */
+void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
+{
+    Q_UNUSED(success);
+    QMutexLocker locker(mutex);
+
+    int index = retrieveIndex.value(obj, -1);
+    if (index < 0 || retrieved.testBit(index)) {
+        qCritical() << "TelemetryMonitor::transactionCompleted - unexpected object" << obj;
+        return;
+    }
 
-    // Connect to object
-    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    // Disconnect from sending object
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+    retrieved.setBit(index);
+    ++retrievedCount;
+    emit retrievalProgress(retrievedCount, retrieveList.length());
 
-    // Request update
-    obj->requestUpdate();
-    objPending = obj;
+    // Wait for the other objects if telemetry is still available
+    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
+    if (gcsStats.Status != GCSTelemetryStats::STATUS_CONNECTED) {
+        stopRetrievingObjects();
+    } else if (retrievedCount == retrieveList.length()) {
+        stopRetrievingObjects();
+        objectsRetrieved();
+    }
 }
 
 /**
- * Called by the retrieved object when a transaction is completed.
+ * Called by the telemetry when the flight side answers with a NACK
  */
-void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
+void TelemetryMonitor::objectRejected(UAVObject *obj)
 {
-    Q_UNUSED(success);
     QMutexLocker locker(mutex);
 
-    if (obj == objPending) {
-        // Disconnect from sending object
-        obj->disconnect(this);
-        objPending = NULL;
-
-        // Process next object if telemetry is still available
-        GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
-        if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
-            retrieveNextObject();
-        } else {
-            stopRetrievingObjects();
-        }
+    rejectedObjects.insert(obj->getObjID());
+}
+
+/**
+ * The objects rejected by the firmware, by firmware UAVO hash.
+ * Unknown without a firmware hash, all the objects are then retrieved.
+ */
+QSet<quint32> TelemetryMonitor::loadRejectedObjects() const
+{
+    QSet<quint32> objects;
+
+    if (firmwareUavoHash.isEmpty()) {
+        return objects;
+    }
+
+    QSettings settings;
+    settings.beginGroup("TelemetryMonitor");
+    settings.beginGroup("RejectedObjects");
+    foreach(QString id, settings.value(QString(firmwareUavoHash.toHex())).toStringList()) {
+        objects.insert(id.toUInt(NULL, 16));
+    }
+    settings.endGroup();
+    settings.endGroup();
+    return objects;
+}
+
+void TelemetryMonitor::saveRejectedObjects() const
+{
+    if (firmwareUavoHash.isEmpty()) {
+        return;
+    }
+
+    QStringList ids;
+    foreach(quint32 id, rejectedObjects) {
+        ids << QString::number(id, 16);
+    }
+
+    QSettings settings;
+    settings.beginGroup("TelemetryMonitor");
+    settings.beginGroup("RejectedObjects");
+    if (ids.isEmpty()) {
+        settings.remove(QString(firmwareUavoHash.toHex()));
     } else {
-        qCritical() << "TelemetryMonitor::retrieveNextObject - unexpected object" << obj;
+        settings.setValue(QString(firmwareUavoHash.toHex()), ids);
     }
+    settings.endGroup();
+    settings.endGroup();
 }
 
 /**
@@ -186,6 +320,27 @@ void TelemetryMonitor::firmwareIAPUpdated(UAVObject *obj)
     }
 }
 
+UAVTalk::LatencyStats TelemetryMonitor::getLatencyStats()
+{
+    QMutexLocker locker(mutex);
+
+    return latencyStats;
+}
+
+Telemetry::PoolStats TelemetryMonitor::getPoolStats()
+{
+    QMutexLocker locker(mutex);
+
+    return poolStats;
+}
+
+UAVTalk::BandwidthStats TelemetryMonitor::getBandwidthStats()
+{
+    QMutexLocker locker(mutex);
+
+    return bandwidthStats;
+}
+
 /**
  * Called periodically to update the statistics and connection status.
  */
@@ -198,8 +353,18 @@ void TelemetryMonitor::processStatsUpdates()
     FlightTelemetryStats::DataFields flightStats = flightStatsObj->getData();
     Telemetry::TelemetryStats telStats     = tel->getStats();
 
+    latencyStats   = tel->getLatencyStats();
+    poolStats      = tel->getPoolStats();
+    bandwidthStats = tel->getBandwidthStats();
     tel->resetStats();
 
+    // Slow down the periodic updates while the link is congested
+    if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
+        updateRateControl(linkCongested(telStats, flightStats));
+    }
+    lastFlightTxRetries  = flightStats.TxRetries;
+    lastFlightRxFailures = flightStats.RxFailures;
+
     // Update stats object
     gcsStats.TxDataRate    = (float)telStats.txBytes / ((float)statsTimer->interval() / 1000.0);
     gcsStats.TxBytes      += telStats.txBytes;
@@ -241,6 +406,7 @@ void TelemetryMonitor::processStatsUpdates()
     }
 
     emit telemetryUpdated((double)gcsStats.TxDataRate, (double)gcsStats.RxDataRate);
+    emit latencyUpdated();
 
     // Set data
     gcsStatsObj->setData(gcsStats);
@@ -260,6 +426,48 @@ void TelemetryMonitor::processStatsUpdates()
     if (gcsStats.Status == GCSTelemetryStats::STATUS_DISCONNECTED && gcsStats.Status != oldStatus) {
         statsTimer->setInterval(STATS_CONNECT_PERIOD_MS);
         qDebug() << "TelemetryMonitor::processStatsUpdates - connection with the autopilot lost";
+        updatePeriodScale = 1.0;
+        tel->setUpdatePeriodScale(updatePeriodScale);
         emit disconnected();
     }
 }
+
+/**
+ * Tell whether the link was congested during the last statistics period:
+ * our transactions needed retries, the autopilot retried or dropped our packets,
+ * the local OPLink modem dropped packets or the received objects came late
+ */
+bool TelemetryMonitor::linkCongested(const Telemetry::TelemetryStats &telStats, const FlightTelemetryStats::DataFields &flightStats)
+{
+    if (telStats.txObjects > 0 && telStats.txRetries * 100 > telStats.txObjects * CONGESTION_RETRY_PERCENT) {
+        return true;
+    }
+    // the flight counters are cumulative, they restart from 0 when the board reboots
+    if (flightStats.TxRetries > lastFlightTxRetries || flightStats.RxFailures > lastFlightRxFailures) {
+        if (lastFlightTxRetries != 0 || lastFlightRxFailures != 0) {
+            return true;
+        }
+    }
+    OPLinkStatus::DataFields opLinkStatus = opLinkStatusObj->getData();
+    if (opLinkStatus.LinkState == OPLinkStatus::LINKSTATE_CONNECTED && opLinkStatus.TxDropped > 0) {
+        return true;
+    }
+    if (latencyStats.total.count() > 0 && latencyStats.total.percentile(95) > CONGESTION_LATENCY_US) {
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Multiplicative slow down of the periodic updates on congestion, additive recovery otherwise
+ */
+void TelemetryMonitor::updateRateControl(bool congested)
+{
+    double scale = congested ? qMin(updatePeriodScale * 2.0, (double)MAX_PERIOD_SCALE) : qMax(updatePeriodScale - 0.25, 1.0);
+
+    if (scale != updatePeriodScale) {
+        qDebug() << "TelemetryMonitor - update periods scaled by" << scale << (congested ? "(link congested)" : "");
+        updatePeriodScale = scale;
+        tel->setUpdatePeriodScale(updatePeriodScale);
+    }
+}
@@ -32,6 +32,10 @@
 #include <QQueue>
 #include <QTimer>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QBitArray>
+#include <QHash>
+#include <QSet>
 #include <QMutex>
 #include <QMutexLocker>
 #include "uavobjectmanager.h"
@@ -39,6 +43,7 @@
 #include "flighttelemetrystats.h"
 #include "firmwareiapobj.h"
 #include "systemstats.h"
+#include "oplinkstatus.h"
 #include "telemetry.h"
 
 class TelemetryMonitor : public QObject {
@@ -48,10 +53,21 @@ public:
     TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel);
     ~TelemetryMonitor();
 
+    // Receive latencies over the last statistics period
+    UAVTalk::LatencyStats getLatencyStats();
+    // Counters of the telemetry record pools, as of the last statistics period
+    Telemetry::PoolStats getPoolStats();
+    // Packets and bytes by object over the last statistics period
+    UAVTalk::BandwidthStats getBandwidthStats();
+
 signals:
     void connected();
     void disconnected();
     void telemetryUpdated(double txRate, double rxRate);
+    // progress of the objects retrieval on connection
+    void retrievalProgress(int retrieved, int total);
+    // new receive latencies, see getLatencyStats()
+    void latencyUpdated();
 
 public slots:
     void transactionCompleted(UAVObject *obj, bool success);
@@ -59,25 +75,53 @@ public slots:
     void flightStatsUpdated(UAVObject *obj);
     void firmwareIAPUpdated(UAVObject *obj);
 
+private slots:
+    void firmwareDescriptionRetrieved(UAVObject *obj, bool success);
+    void objectRejected(UAVObject *obj);
+
 private:
     static const int STATS_UPDATE_PERIOD_MS  = 4000;
     static const int STATS_CONNECT_PERIOD_MS = 2000;
     static const int CONNECTION_TIMEOUT_MS   = 8000;
+    // rate control: the link is congested above these retry rate and receive latency (95th percentile),
+    // the update periods are then doubled, up to MAX_PERIOD_SCALE, and recover by a quarter per period
+    static const int CONGESTION_RETRY_PERCENT = 5;
+    static const int CONGESTION_LATENCY_US    = 250000;
+    static const int MAX_PERIOD_SCALE         = 8;
 
     UAVObjectManager *objMngr;
     Telemetry *tel;
-    QQueue<UAVObject *> queue;
     GCSTelemetryStats *gcsStatsObj;
     FlightTelemetryStats *flightStatsObj;
     FirmwareIAPObj *firmwareIAPObj;
+    OPLinkStatus *opLinkStatusObj;
     QTimer *statsTimer;
-    UAVObject *objPending;
+    // objects to retrieve on connection, and which ones are retrieved
+    QList<UAVObject *> retrieveList;
+    QHash<UAVObject *, int> retrieveIndex;
+    QBitArray retrieved;
+    int retrievedCount;
+    // UAVO hash of the firmware and the object definitions it rejected, learnt on the previous connections
+    QByteArray firmwareUavoHash;
+    QSet<quint32> rejectedObjects;
     QMutex *mutex;
     QTime *connectionTimer;
+    QElapsedTimer connectionTime;
+    UAVTalk::LatencyStats latencyStats;
+    Telemetry::PoolStats poolStats;
+    UAVTalk::BandwidthStats bandwidthStats;
+    double updatePeriodScale;
+    quint32 lastFlightTxRetries;
+    quint32 lastFlightRxFailures;
 
     void startRetrievingObjects();
-    void retrieveNextObject();
+    void retrieveObjects();
     void stopRetrievingObjects();
+    QSet<quint32> loadRejectedObjects() const;
+    void saveRejectedObjects() const;
+    void objectsRetrieved();
+    bool linkCongested(const Telemetry::TelemetryStats &telStats, const FlightTelemetryStats::DataFields &flightStats);
+    void updateRateControl(bool congested);
 };
 
 #endif // TELEMETRYMONITOR_H
@@ -0,0 +1,149 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryserver.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Shares the telemetry stream of the current connection over TCP
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "telemetryserver.h"
+#include "telemetrymanager.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+TelemetryServer::TelemetryServer(TelemetryManager *telemetryManager, QObject *parent) :
+    QTcpServer(parent), m_telemetryManager(telemetryManager), m_flushQueued(false)
+{
+    connect(this, SIGNAL(newConnection()), this, SLOT(clientConnected()));
+}
+
+TelemetryServer::~TelemetryServer()
+{
+    m_telemetryManager->removeFrameTap(this);
+}
+
+bool TelemetryServer::start(quint16 port)
+{
+    if (!listen(QHostAddress::Any, port)) {
+        qWarning() << "TelemetryServer - failed to listen on port" << port << ":" << errorString();
+        return false;
+    }
+    qDebug() << "TelemetryServer - listening on port" << serverPort();
+    m_telemetryManager->addFrameTap(this);
+    return true;
+}
+
+void TelemetryServer::frame(qint64 timestamp, const quint8 *packet, int length)
+{
+    Q_UNUSED(timestamp);
+
+    QMutexLocker locker(&m_pendingMutex);
+
+    m_pending.append((const char *)packet, length);
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+    }
+}
+
+void TelemetryServer::flush()
+{
+    QByteArray batch;
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        m_flushQueued = false;
+        batch.swap(m_pending);
+    }
+
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    QHash<QTcpSocket *, Client>::iterator it;
+    for (it = m_clients.begin(); it != m_clients.end(); ++it) {
+        Client &client = it.value();
+        if (client.backlogBytes + batch.size() > MAX_CLIENT_BACKLOG) {
+            if (client.droppedBatches++ == 0) {
+                qDebug() << "TelemetryServer - client" << it.key()->peerAddress().toString() << "is too slow, dropping data";
+            }
+            continue;
+        }
+        client.backlog.enqueue(batch);
+        client.backlogBytes += batch.size();
+        writeBacklog(it.key(), client);
+    }
+}
+
+void TelemetryServer::writeBacklog(QTcpSocket *socket, Client &client)
+{
+    while (!client.backlog.isEmpty() && socket->bytesToWrite() < MAX_SOCKET_PENDING) {
+        QByteArray batch = client.backlog.dequeue();
+        client.backlogBytes -= batch.size();
+        socket->write(batch);
+    }
+}
+
+void TelemetryServer::clientConnected()
+{
+    while (hasPendingConnections()) {
+        QTcpSocket *socket = nextPendingConnection();
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        connect(socket, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+        connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(clientBytesWritten()));
+        connect(socket, SIGNAL(readyRead()), this, SLOT(clientReadyRead()));
+
+        Client client;
+        client.backlogBytes   = 0;
+        client.droppedBatches = 0;
+        m_clients.insert(socket, client);
+        qDebug() << "TelemetryServer - client connected from" << socket->peerAddress().toString();
+    }
+}
+
+void TelemetryServer::clientDisconnected()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    if (m_clients.contains(socket)) {
+        qDebug() << "TelemetryServer - client disconnected, dropped batches:" << m_clients[socket].droppedBatches;
+        m_clients.remove(socket);
+        socket->deleteLater();
+    }
+}
+
+void TelemetryServer::clientBytesWritten()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    QHash<QTcpSocket *, Client>::iterator it = m_clients.find(socket);
+
+    if (it != m_clients.end()) {
+        writeBacklog(socket, it.value());
+    }
+}
+
+void TelemetryServer::clientReadyRead()
+{
+    // the stream is read only, discard what clients send
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+
+    socket->readAll();
+}
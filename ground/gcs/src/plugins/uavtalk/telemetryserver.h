@@ -0,0 +1,94 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryserver.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Shares the telemetry stream of the current connection over TCP
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TELEMETRYSERVER_H
+#define TELEMETRYSERVER_H
+
+#include "uavtalk_global.h"
+#include "uavtalk.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+class TelemetryManager;
+
+/**
+ * Sends a copy of the UAVTalk object packets of the vehicle link to any number of TCP clients,
+ * so that other GCS instances or tools can follow the same connection (read only).
+ *
+ * Packets tapped from the link are collected into one batch per event loop iteration,
+ * the batch is then queued by reference (QByteArray is implicitly shared) to every client.
+ * Each client has a bounded backlog: when a client does not keep up, whole batches are dropped
+ * for that client only, the link and the other clients are not slowed down.
+ * Batches only hold complete packets so the stream stays parsable after a drop.
+ */
+class UAVTALK_EXPORT TelemetryServer : public QTcpServer, public UAVTalk::FrameTap {
+    Q_OBJECT
+
+public:
+    TelemetryServer(TelemetryManager *telemetryManager, QObject *parent = 0);
+    ~TelemetryServer();
+
+    bool start(quint16 port);
+
+    // UAVTalk::FrameTap, called from the telemetry thread
+    void frame(qint64 timestamp, const quint8 *packet, int length);
+
+private slots:
+    void flush();
+    void clientConnected();
+    void clientDisconnected();
+    void clientBytesWritten();
+    void clientReadyRead();
+
+private:
+    typedef struct {
+        QQueue<QByteArray> backlog;
+        qint64 backlogBytes;
+        quint32 droppedBatches;
+    } Client;
+
+    // batches waiting for a client, beyond this new batches are dropped
+    static const int MAX_CLIENT_BACKLOG = 256 * 1024;
+    // data handed to the socket ahead of the network
+    static const int MAX_SOCKET_PENDING = 64 * 1024;
+
+    TelemetryManager *m_telemetryManager;
+    QHash<QTcpSocket *, Client> m_clients;
+
+    // packets tapped since the last flush()
+    QMutex m_pendingMutex;
+    QByteArray m_pending;
+    bool m_flushQueued;
+
+    void writeBacklog(QTcpSocket *socket, Client &client);
+};
+
+#endif // TELEMETRYSERVER_H
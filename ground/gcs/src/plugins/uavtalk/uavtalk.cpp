@@ -28,10 +28,13 @@
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/generalsettings.h>
 #include <utils/crc.h>
+#include "gcsreceiver.h"
+#include "manualcontrolcommand.h"
 
 #include <QtEndian>
 #include <QDebug>
 #include <QEventLoop>
+#include <QThreadStorage>
 
 #ifdef VERBOSE_UAVTALK
 // uncomment and adapt the following lines to filter verbose logging to include specific object(s) only
@@ -46,23 +49,63 @@
 
 using namespace Utils;
 
+namespace {
+// arrival time of the packet being unpacked, see UAVTalk::unpackTimestamp()
+QThreadStorage<qint64> unpackTime;
+
+class UnpackTimeScope {
+public:
+    UnpackTimeScope(qint64 time)
+    {
+        unpackTime.setLocalData(time);
+    }
+    ~UnpackTimeScope()
+    {
+        unpackTime.setLocalData(0);
+    }
+};
+}
+
 /**
  * Constructor
  */
 UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive)
 {
-    rxState = STATE_SYNC;
-    rxPacketLength = 0;
+    transmitSnapshots = false;
+    txFlushQueued     = false;
+    txPending.reserve(TX_BATCH_SIZE);
+    rxDeviceTime = 0;
+    rxReadTime   = 0;
+
+    txV2            = false;
+    txSequence      = 0;
+    rxSequence      = 0;
+    rxSequenceValid = false;
+    v2ProbesSent    = 0;
+    txMultiCount    = 0;
+    txMultiType     = TYPE_MULTI;
+    txBatchAcked    = false;
 
     memset(&stats, 0, sizeof(ComStats));
+    memset(objectCounters, 0, sizeof(objectCounters));
+    memset(&otherCounters, 0, sizeof(ObjectCounters));
+    statsPeriod.start();
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
-    useUDPMirror = settings->useUDPMirror();
+    // there are no settings when used outside of the GCS (headless tools)
+    Core::Internal::GeneralSettings *settings = pm ? pm->getObject<Core::Internal::GeneralSettings>() : NULL;
+    useUDPMirror = settings && settings->useUDPMirror();
+    v2Enabled    = settings && settings->uavTalkV2();
+    deltaEnabled = settings && settings->uavTalkDelta();
+    udpMirror    = NULL;
     if (useUDPMirror) {
         qDebug() << "UAVTalk::UAVTalk -*** UDP mirror is enabled ***";
     }
-    if (useUDPMirror) {
+    if (useUDPMirror && settings->udpMirrorBatched()) {
+        udpMirror    = new UDPMirror(QHostAddress(settings->udpMirrorHost()), settings->udpMirrorPort(),
+                                     settings->udpMirrorCompressed(), this);
+        useUDPMirror = false;
+    } else if (useUDPMirror) {
         udpSocketTx = new QUdpSocket(this);
         udpSocketRx = new QUdpSocket(this);
         udpSocketTx->bind(9000);
@@ -88,6 +131,14 @@ void UAVTalk::resetStats()
     QMutexLocker locker(&mutex);
 
     memset(&stats, 0, sizeof(ComStats));
+    latency.device.reset();
+    latency.decode.reset();
+    latency.total.reset();
+    latency.objects.clear();
+    latency.control.reset();
+    memset(objectCounters, 0, sizeof(objectCounters));
+    memset(&otherCounters, 0, sizeof(ObjectCounters));
+    statsPeriod.start();
 }
 
 /**
@@ -100,6 +151,181 @@ UAVTalk::ComStats UAVTalk::getStats()
     return stats;
 }
 
+/**
+ * Get the receive latencies since the last resetStats()
+ */
+UAVTalk::LatencyStats UAVTalk::getLatencyStats()
+{
+    QMutexLocker locker(&mutex);
+
+    return latency;
+}
+
+/**
+ * Get the packets and bytes by object since the last resetStats()
+ */
+UAVTalk::BandwidthStats UAVTalk::getBandwidthStats()
+{
+    QMutexLocker locker(&mutex);
+
+    BandwidthStats bandwidth;
+
+    bandwidth.periodMs = statsPeriod.elapsed();
+    bandwidth.txBytes  = stats.txBytes;
+    bandwidth.rxBytes  = stats.rxBytes;
+    for (int i = 0; i < OBJECT_COUNTER_SLOTS; ++i) {
+        if (objectCounters[i].objId != 0) {
+            bandwidth.objects.append(objectCounters[i]);
+        }
+    }
+    if (otherCounters.txPackets != 0 || otherCounters.rxPackets != 0) {
+        bandwidth.objects.append(otherCounters);
+    }
+    return bandwidth;
+}
+
+/**
+ * Counters of an object, the slot is taken on first use. Called with the lock held.
+ */
+UAVTalk::ObjectCounters *UAVTalk::objectCountersOf(quint32 objId)
+{
+    if (objId == 0) {
+        return &otherCounters;
+    }
+    quint32 index = (objId * 2654435761u) & (OBJECT_COUNTER_SLOTS - 1);
+    for (int probe = 0; probe < OBJECT_COUNTER_SLOTS / 4; ++probe) {
+        ObjectCounters *counters = &objectCounters[(index + probe) & (OBJECT_COUNTER_SLOTS - 1)];
+        if (counters->objId == objId) {
+            return counters;
+        }
+        if (counters->objId == 0) {
+            counters->objId = objId;
+            return counters;
+        }
+    }
+    return &otherCounters;
+}
+
+/**
+ * Select if objects are transmitted from their snapshot (see UAVObject::readSnapshot())
+ * instead of their live data. Used by readers that must not block the telemetry receiver (logging).
+ */
+void UAVTalk::setTransmitSnapshots(bool enable)
+{
+    QMutexLocker locker(&mutex);
+
+    transmitSnapshots = enable;
+}
+
+/**
+ * Allow the v2 framing (larger payloads, sequence numbers, CRC-16 and multi object frames).
+ *
+ * The v2 framing is negotiated: when enabled, a v2 probe is sent regularly and the link
+ * switches to v2 as soon as a v2 frame is received. A v1 only peer drops the probes
+ * as bad packets and the link keeps using v1. v2 frames are always understood.
+ */
+void UAVTalk::setFramingV2Enabled(bool enable)
+{
+    QMutexLocker locker(&mutex);
+
+    v2Enabled = enable;
+}
+
+/**
+ * Returns true when the link transmits v2 frames.
+ */
+bool UAVTalk::isFramingV2() const
+{
+    return txV2;
+}
+
+/**
+ * Allow sending the object updates as deltas once the link uses the v2 framing.
+ *
+ * An update is sent as the XOR of the last update sent for the same object instance,
+ * run length encoded, with a full update every DELTA_KEYFRAME_INTERVAL updates.
+ * Each delta carries the checksum of the state it applies to: a receiver that does not
+ * hold that state drops the delta and requests the object, which restarts the deltas
+ * with a full update. Deltas are always understood, whatever this setting.
+ */
+void UAVTalk::setDeltaUpdatesEnabled(bool enable)
+{
+    QMutexLocker locker(&mutex);
+
+    deltaEnabled = enable;
+    txDeltas.clear();
+}
+
+/**
+ * Give the time the input of the next update of a control object (ManualControlCommand, GCSReceiver)
+ * was sampled, the time until it is written on the device goes in LatencyStats::control.
+ * \param[in] timestamp in microseconds, see LatencyHistogram::timestamp()
+ */
+void UAVTalk::markControlSample(quint32 objId, qint64 timestamp)
+{
+    QMutexLocker locker(&mutex);
+
+    controlSamples.insert(objId, timestamp);
+}
+
+qint64 UAVTalk::unpackTimestamp()
+{
+    return unpackTime.hasLocalData() ? unpackTime.localData() : 0;
+}
+
+/**
+ * Add a tap receiving the object packets.
+ */
+void UAVTalk::addFrameTap(FrameTap *tap)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!frameTaps.contains(tap)) {
+        frameTaps.append(tap);
+    }
+}
+
+/**
+ * Remove a tap, once this function returns the tap is not called anymore.
+ */
+void UAVTalk::removeFrameTap(FrameTap *tap)
+{
+    QMutexLocker locker(&mutex);
+
+    frameTaps.removeAll(tap);
+}
+
+/**
+ * Write the packets waiting in the transmit batch to the device.
+ * The batch is flushed when full and once control returns to the event loop,
+ * call it to write the packets right away.
+ */
+void UAVTalk::flush()
+{
+    QMutexLocker locker(&mutex);
+
+    txFlushQueued = false;
+    queueMultiFrameV2();
+    writePending();
+}
+
+/**
+ * Write the transmit batch to the device.
+ */
+void UAVTalk::writePending()
+{
+    if (txPending.isEmpty()) {
+        return;
+    }
+    if (!io.isNull() && io->isWritable()) {
+        io->write(txPending);
+        if (useUDPMirror) {
+            udpSocketRx->writeDatagram(txPending, QHostAddress::LocalHost, udpSocketTx->localPort());
+        }
+    }
+    txPending.resize(0);
+}
+
 void UAVTalk::dummyUDPRead()
 {
     QUdpSocket *socket = qobject_cast<QUdpSocket *>(sender());
@@ -207,254 +433,476 @@ bool UAVTalk::objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVO
 
 /**
  * Called each time there are data in the input buffer
+ *
+ * All available bytes are read at once and decoded as whole packets.
+ * An incomplete trailing packet is kept in rxStream until more data arrives.
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
-
     if (io && io->isReadable()) {
         while (io->bytesAvailable() > 0) {
-            int ret = io->read((char *)&tmp, 1);
-            if (ret != -1) {
-                processInputByte(tmp);
+            // the transports that timestamp their input (RawHID) tell when the oldest unread data arrived
+            QVariant deviceTime = io->property("readTimestamp");
+            QByteArray data     = io->readAll();
+            if (data.isEmpty()) {
+                break;
+            }
+            rxReadTime   = LatencyHistogram::timestamp();
+            rxDeviceTime = deviceTime.isValid() ? deviceTime.toLongLong() : 0;
+            if (rxDeviceTime > rxReadTime) {
+                rxDeviceTime = 0;
+            }
+            if (rxDeviceTime) {
+                QMutexLocker locker(&mutex);
+                latency.device.add(rxReadTime - rxDeviceTime);
+            }
+            if (rxStream.isEmpty()) {
+                // implicitly shared, no copy
+                rxStream = data;
             } else {
-                // TODOD
+                rxStream.append(data);
             }
-            if (rxState == STATE_COMPLETE) {
-                mutex.lock();
-                if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
-                    stats.rxObjectBytes += rxLength;
-                    stats.rxObjects++;
-                } else {
-                    // TODO...
-                }
-                mutex.unlock();
-
-                if (useUDPMirror) {
-                    // it is safe to do this outside of the above critical section as the rxDataArray is
-                    // accessed from this thread only
-                    udpSocketTx->writeDatagram(rxDataArray, QHostAddress::LocalHost, udpSocketRx->localPort());
-                }
+            int consumed = processInputBuffer((const quint8 *)rxStream.constData(), rxStream.size());
+            if (consumed >= rxStream.size()) {
+                rxStream.clear();
+            } else if (consumed > 0) {
+                rxStream.remove(0, consumed);
             }
         }
     }
 }
 
 /**
- * Process an byte from the telemetry stream.
- * \param[in] rxbyte Received byte
- * \return Success (true), Failure (false)
+ * Decode all complete packets from a block of telemetry stream.
+ *
+ * Byte accounting matches a byte per byte receiver exactly: bytes skipped while looking for
+ * a sync byte are sync errors and, on a header error, decoding resumes right after the
+ * offending byte.
+ *
+ * \param[in] data Received bytes
+ * \param[in] length Number of bytes in \a data
+ * \return Number of bytes consumed, the remaining bytes are the start of an incomplete packet
  */
-bool UAVTalk::processInputByte(quint8 rxbyte)
+int UAVTalk::processInputBuffer(const quint8 *data, int length)
 {
-    if (rxState == STATE_COMPLETE || rxState == STATE_ERROR) {
-        rxState = STATE_SYNC;
-
-        if (useUDPMirror) {
-            rxDataArray.clear();
+    int pos = 0;
+
+    while (pos < length) {
+        // Look for the next sync byte, everything before it is a sync error
+        const quint8 *sync = (const quint8 *)memchr(data + pos, SYNC_VAL, length - pos);
+        int skipped = (sync != NULL) ? (int)(sync - (data + pos)) : (length - pos);
+        if (skipped > 0) {
+            QMutexLocker locker(&mutex);
+            stats.rxBytes      += skipped;
+            stats.rxSyncErrors += skipped;
+            pos += skipped;
         }
-    }
-
-    // Update stats
-    stats.rxBytes++;
-
-    // update packet byte count
-    rxPacketLength++;
-
-    if (useUDPMirror) {
-        rxDataArray.append(rxbyte);
-    }
-
-    // Receive state machine
-    switch (rxState) {
-    case STATE_SYNC:
-
-        if (rxbyte != SYNC_VAL) {
-            // continue until sync byte is matched
-            stats.rxSyncErrors++;
+        if (sync == NULL) {
             break;
         }
 
-        // Initialize and update CRC
-        rxCS = Crc::updateCRC(0, rxbyte);
-
-        rxPacketLength = 1;
-
-        // case local byte counter, don't forget to zero it after use.
-        rxCount = 0;
-
-        rxState = STATE_TYPE;
-        break;
+        const quint8 *packet = data + pos;
+        int available = length - pos;
 
-    case STATE_TYPE:
+        // Number of bytes consumed by the current packet (or packet error)
+        int consumed  = 0;
 
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
-
-        if ((rxbyte & TYPE_MASK) != TYPE_VER) {
-            qWarning() << "UAVTalk - error : bad type";
-            stats.rxErrors++;
-            rxState = STATE_ERROR;
+        // Validate type
+        if (available < 2) {
             break;
         }
+        quint8 type = packet[1];
+        if ((type & TYPE_MASK) == TYPE_VER2) {
+            consumed = processInputFrameV2(packet, available);
+            if (consumed == 0) {
+                break;
+            }
+            pos += consumed;
+            continue;
+        }
+        if ((type & TYPE_MASK) != TYPE_VER) {
+            qWarning() << "UAVTalk - error : bad type";
+            consumed = 2;
+        }
 
-        rxType     = rxbyte;
-
-        packetSize = 0;
-
-        rxState    = STATE_SIZE;
-        break;
-
-    case STATE_SIZE:
+        // Validate packet size
+        quint16 packetSize = 0;
+        if (consumed == 0) {
+            if (available < 4) {
+                break;
+            }
+            packetSize = qFromLittleEndian<quint16>(&packet[2]);
+            if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+                // incorrect packet size
+                qWarning() << "UAVTalk - error : incorrect packet size";
+                consumed = 4;
+            }
+        }
 
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
+        // Validate object and payload length
+        quint32 objId  = 0;
+        quint16 instId = 0;
+        quint16 dataLength = 0;
+        if (consumed == 0) {
+            if (available < HEADER_LENGTH) {
+                break;
+            }
+            objId  = qFromLittleEndian<quint32>(&packet[4]);
+            instId = qFromLittleEndian<quint16>(&packet[8]);
+
+            // Search for object, if not found drop the packet
+            UAVObject *rxObj = objMngr->getObject(objId);
+            if (rxObj == NULL && type != TYPE_OBJ_REQ) {
+                qWarning().noquote() << "UAVTalk - error : unknown object" << QString::number(objId, 16).toUpper();
+                consumed = HEADER_LENGTH;
+            } else {
+                // Determine data length
+                if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
+                    dataLength = 0;
+                } else if (rxObj) {
+                    dataLength = rxObj->getNumBytes();
+                } else {
+                    dataLength = packetSize - HEADER_LENGTH;
+                }
 
-        if (rxCount == 0) {
-            packetSize += rxbyte;
-            rxCount++;
-            break;
+                if (dataLength >= MAX_PAYLOAD_LENGTH) {
+                    // packet error - exceeded payload max length
+                    qWarning().noquote() << "UAVTalk - error : exceeded payload max length" << QString::number(objId, 16).toUpper();
+                    consumed = HEADER_LENGTH;
+                } else if (HEADER_LENGTH + dataLength != packetSize) {
+                    // packet error - mismatched packet size
+                    qWarning().noquote() << "UAVTalk - error : mismatched packet size" << QString::number(objId, 16).toUpper();
+                    consumed = HEADER_LENGTH;
+                }
+            }
         }
-        packetSize += (quint32)rxbyte << 8;
-        rxCount     = 0;
-
 
-        if (packetSize < HEADER_LENGTH || packetSize > HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
-            // incorrect packet size
-            qWarning() << "UAVTalk - error : incorrect packet size";
+        if (consumed > 0) {
+            // header error, resume looking for sync right after the offending byte
+            QMutexLocker locker(&mutex);
+            stats.rxBytes  += consumed;
             stats.rxErrors++;
-            rxState = STATE_ERROR;
-            break;
+            pos += consumed;
+            continue;
         }
 
-        rxState = STATE_OBJID;
-        break;
-
-    case STATE_OBJID:
+        // Wait for the payload and checksum
+        if (available < packetSize + CHECKSUM_LENGTH) {
+            break;
+        }
+        consumed = packetSize + CHECKSUM_LENGTH;
 
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
+        // Checksum the whole packet at once
+        if (Crc::updateCRC(0, packet, packetSize) != packet[packetSize]) {
+            // packet error - faulty CRC
+            qWarning().noquote() << "UAVTalk - error : failed CRC check" << QString::number(objId, 16).toUpper();
+            QMutexLocker locker(&mutex);
+            stats.rxBytes += consumed;
+            stats.rxCrcErrors++;
+            pos += consumed;
+            continue;
+        }
 
-        rxTmpBuffer[rxCount++] = rxbyte;
-        if (rxCount < 4) {
-            break;
+        mutex.lock();
+        stats.rxBytes += consumed;
+        if (receiveObject(type, objId, instId, &packet[HEADER_LENGTH], dataLength)) {
+            stats.rxObjectBytes += dataLength;
+            stats.rxObjects++;
+            if (type == TYPE_OBJ || type == TYPE_OBJ_ACK) {
+                qint64 unpacked = LatencyHistogram::timestamp();
+                qint64 total    = unpacked - (rxDeviceTime ? rxDeviceTime : rxReadTime);
+                latency.decode.add(unpacked - rxReadTime);
+                latency.total.add(total);
+                latency.objects[objId].add(total);
+                foreach(FrameTap * tap, frameTaps) {
+                    tap->frame(rxDeviceTime ? rxDeviceTime : rxReadTime, packet, consumed);
+                }
+            }
+        } else {
+            // TODO...
+        }
+        mutex.unlock();
+
+        if (udpMirror) {
+            udpMirror->frame(UDPMirror::RX, packet, consumed);
+        } else if (useUDPMirror) {
+            // it is safe to do this outside of the above critical section as the rx stream is
+            // accessed from this thread only
+            udpSocketTx->writeDatagram((const char *)packet, consumed, QHostAddress::LocalHost, udpSocketRx->localPort());
         }
-        rxCount  = 0;
 
-        rxObjId  = (qint32)qFromLittleEndian<quint32>(rxTmpBuffer);
+        pos += consumed;
+    }
 
-        // Message always contain an instance ID
-        rxInstId = 0;
-        rxState  = STATE_INSTID;
-        break;
+    return pos;
+}
 
-    case STATE_INSTID:
+/**
+ * Decode a v2 frame.
+ *
+ * \param[in] packet Frame, starting with the sync byte
+ * \param[in] available Number of bytes available from \a packet
+ * \return Number of bytes consumed, 0 if the frame is not complete yet
+ */
+int UAVTalk::processInputFrameV2(const quint8 *packet, int available)
+{
+    if (available < 4) {
+        return 0;
+    }
+    quint8 type = packet[1];
+    quint16 packetSize = qFromLittleEndian<quint16>(&packet[2]);
+    if (packetSize < HEADER_LENGTH_V2 || packetSize > HEADER_LENGTH_V2 + MAX_PAYLOAD_LENGTH_V2) {
+        // incorrect packet size, resume looking for sync after it
+        qWarning() << "UAVTalk - error : incorrect v2 packet size";
+        QMutexLocker locker(&mutex);
+        stats.rxBytes += 4;
+        stats.rxErrors++;
+        return 4;
+    }
 
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
+    // Wait for the payload and checksum
+    if (available < packetSize + CHECKSUM_LENGTH_V2) {
+        return 0;
+    }
+    int consumed = packetSize + CHECKSUM_LENGTH_V2;
 
-        rxTmpBuffer[rxCount++] = rxbyte;
-        if (rxCount < 2) {
-            break;
-        }
-        rxCount  = 0;
+    QMutexLocker locker(&mutex);
+    stats.rxBytes += consumed;
 
-        rxInstId = (qint16)qFromLittleEndian<quint16>(rxTmpBuffer);
+    if (Crc::updateCRC16(0xFFFF, packet, packetSize) != qFromLittleEndian<quint16>(&packet[packetSize])) {
+        qWarning() << "UAVTalk - error : failed v2 CRC check";
+        stats.rxCrcErrors++;
+        return consumed;
+    }
 
-        // Search for object, if not found reset state machine
-        {
-            UAVObject *rxObj = objMngr->getObject(rxObjId);
-            if (rxObj == NULL && rxType != TYPE_OBJ_REQ) {
-                qWarning().noquote() << "UAVTalk - error : unknown object" << QString::number(rxObjId, 16).toUpper();
-                stats.rxErrors++;
-                rxState = STATE_ERROR;
-                break;
-            }
+    // Count the frames lost since the previous one
+    quint16 sequence = qFromLittleEndian<quint16>(&packet[4]);
+    if (rxSequenceValid) {
+        stats.rxLostFrames += (quint16)(sequence - rxSequence);
+    }
+    rxSequence      = sequence + 1;
+    rxSequenceValid = true;
 
-            // Determine data length
-            if (rxType == TYPE_OBJ_REQ || rxType == TYPE_ACK || rxType == TYPE_NACK) {
-                rxLength = 0;
-            } else {
-                if (rxObj) {
-                    rxLength = rxObj->getNumBytes();
-                } else {
-                    rxLength = packetSize - rxPacketLength;
-                }
-            }
+    // The peer speaks v2, answer in v2 as well
+    if (v2Enabled && !txV2) {
+        qDebug() << "UAVTalk - peer supports v2 framing, switching to v2";
+        txV2 = true;
+    }
 
-            // Check length and determine next state
-            if (rxLength >= MAX_PAYLOAD_LENGTH) {
-                // packet error - exceeded payload max length
-                qWarning().noquote() << "UAVTalk - error : exceeded payload max length" << QString::number(rxObjId, 16).toUpper();
+    quint32 objId = qFromLittleEndian<quint32>(&packet[6]);
+    quint16 instId = qFromLittleEndian<quint16>(&packet[10]);
+    const quint8 *payload = &packet[HEADER_LENGTH_V2];
+    int payloadLength     = packetSize - HEADER_LENGTH_V2;
+
+    // back to the v1 type codes used by the object handling
+    type = TYPE_VER | (type & ~TYPE_MASK);
+
+    if (type == TYPE_MULTI || type == TYPE_DELTA || type == TYPE_MULTI_ACK) {
+        bool received = true;
+        int offset    = 0;
+        while (offset < payloadLength) {
+            const quint8 *record = payload + offset;
+            int recordLength     = (payloadLength - offset >= RECORD_HEADER_LENGTH) ?
+                                   qFromLittleEndian<quint16>(&record[6]) : -1;
+            if (recordLength < 0 || offset + RECORD_HEADER_LENGTH + recordLength > payloadLength) {
+                qWarning() << "UAVTalk - error : truncated multi object frame";
                 stats.rxErrors++;
-                rxState = STATE_ERROR;
                 break;
             }
-
-            // Check the lengths match
-            if ((rxPacketLength + rxLength) != packetSize) {
-                // packet error - mismatched packet size
-                qWarning().noquote() << "UAVTalk - error : mismatched packet size" << QString::number(rxObjId, 16).toUpper();
-                stats.rxErrors++;
-                rxState = STATE_ERROR;
+            quint32 recordObjId  = qFromLittleEndian<quint32>(&record[0]);
+            quint16 recordInstId = qFromLittleEndian<quint16>(&record[4]);
+            if (type == TYPE_DELTA) {
+                receiveDeltaV2(recordObjId, recordInstId, &record[RECORD_HEADER_LENGTH], recordLength);
+            } else if (!receiveFrameV2(TYPE_OBJ, recordObjId, recordInstId, &record[RECORD_HEADER_LENGTH], recordLength)
+                       && type == TYPE_MULTI_ACK) {
+                // failed to update an object, the whole frame is nacked
+                transmitObject(TYPE_NACK, recordObjId, recordInstId, NULL);
+                received = false;
                 break;
             }
+            objId   = recordObjId;
+            instId  = recordInstId;
+            offset += RECORD_HEADER_LENGTH + recordLength;
         }
-
-        // If there is a payload get it, otherwise receive checksum
-        if (rxLength > 0) {
-            rxState = STATE_DATA;
-        } else {
-            rxState = STATE_CS;
+        if (type == TYPE_MULTI_ACK && received && offset == payloadLength && offset > 0) {
+            // a single ack for the frame, given for its last record
+            transmitObject(TYPE_ACK, objId, instId, objMngr->getObject(objId, instId));
         }
-        break;
+    } else if (type == TYPE_NACK && objId == 0) {
+        // v2 probe, nothing else to do
+    } else {
+        receiveFrameV2(type, objId, instId, payload, payloadLength);
+    }
 
-    case STATE_DATA:
+    return consumed;
+}
 
-        // Update CRC
-        rxCS = Crc::updateCRC(rxCS, rxbyte);
+/**
+ * Validate and receive one object message of a v2 frame, the lock must be held.
+ * Frame taps and the UDP mirror are given the equivalent v1 packet.
+ * \return true if the object was received
+ */
+bool UAVTalk::receiveFrameV2(quint8 type, quint32 objId, quint16 instId, const quint8 *data, int length)
+{
+    UAVObject *rxObj = objMngr->getObject(objId);
 
-        rxBuffer[rxCount++] = rxbyte;
-        if (rxCount < rxLength) {
-            break;
+    if (rxObj == NULL && type != TYPE_OBJ_REQ) {
+        qWarning().noquote() << "UAVTalk - error : unknown object" << QString::number(objId, 16).toUpper();
+        stats.rxErrors++;
+        return false;
+    }
+    int dataLength = length;
+    if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
+        dataLength = 0;
+    } else if (rxObj) {
+        dataLength = rxObj->getNumBytes();
+    }
+    if (dataLength != length) {
+        qWarning().noquote() << "UAVTalk - error : mismatched packet size" << QString::number(objId, 16).toUpper();
+        stats.rxErrors++;
+        return false;
+    }
+
+    int packetLength = 0;
+    if (!frameTaps.isEmpty() || udpMirror || useUDPMirror) {
+        rxV1Buffer[0] = SYNC_VAL;
+        rxV1Buffer[1] = type;
+        qToLittleEndian<quint16>(HEADER_LENGTH + length, &rxV1Buffer[2]);
+        qToLittleEndian<quint32>(objId, &rxV1Buffer[4]);
+        qToLittleEndian<quint16>(instId, &rxV1Buffer[8]);
+        memcpy(&rxV1Buffer[HEADER_LENGTH], data, length);
+        rxV1Buffer[HEADER_LENGTH + length] = Crc::updateCRC(0, rxV1Buffer, HEADER_LENGTH + length);
+        packetLength = HEADER_LENGTH + length + CHECKSUM_LENGTH;
+    }
+
+    bool received = receiveObject(type, objId, instId, data, length);
+    if (received) {
+        stats.rxObjectBytes += length;
+        stats.rxObjects++;
+        if (type == TYPE_OBJ || type == TYPE_OBJ_ACK) {
+            // keep the base of the deltas of that object
+            QHash<quint64, QByteArray>::iterator state = rxDeltas.find(deltaKey(objId, instId));
+            if (state != rxDeltas.end()) {
+                state->resize(length);
+                memcpy(state->data(), data, length);
+            }
+            qint64 unpacked = LatencyHistogram::timestamp();
+            qint64 total    = unpacked - (rxDeviceTime ? rxDeviceTime : rxReadTime);
+            latency.decode.add(unpacked - rxReadTime);
+            latency.total.add(total);
+            latency.objects[objId].add(total);
+            foreach(FrameTap * tap, frameTaps) {
+                tap->frame(rxDeviceTime ? rxDeviceTime : rxReadTime, rxV1Buffer, packetLength);
+            }
         }
-        rxCount = 0;
+    }
 
-        rxState = STATE_CS;
-        break;
+    if (udpMirror) {
+        udpMirror->frame(UDPMirror::RX, rxV1Buffer, packetLength);
+    } else if (useUDPMirror) {
+        udpSocketTx->writeDatagram((const char *)rxV1Buffer, packetLength, QHostAddress::LocalHost, udpSocketRx->localPort());
+    }
+    return received;
+}
 
-    case STATE_CS:
+/**
+ * Receive a delta record of a v2 frame, the lock must be held.
+ */
+void UAVTalk::receiveDeltaV2(quint32 objId, quint16 instId, const quint8 *data, int length)
+{
+    UAVObject *rxObj = objMngr->getObject(objId);
 
-        // The CRC byte
-        rxCSPacket = rxbyte;
+    if (rxObj == NULL) {
+        qWarning().noquote() << "UAVTalk - error : unknown object" << QString::number(objId, 16).toUpper();
+        stats.rxErrors++;
+        return;
+    }
 
-        if (rxCS != rxCSPacket) {
-            // packet error - faulty CRC
-            qWarning().noquote() << "UAVTalk - error : failed CRC check" << QString::number(rxObjId, 16).toUpper();
-            stats.rxCrcErrors++;
-            rxState = STATE_ERROR;
-            break;
-        }
+    quint64 key = deltaKey(objId, instId);
+    QHash<quint64, QByteArray>::iterator base = rxDeltas.find(key);
+    QByteArray state;
+    if (base == rxDeltas.end()) {
+        // first delta of that object, track it from now on and ask for a full update
+        rxDeltas.insert(key, QByteArray());
+        transmitSingleObject(TYPE_OBJ_REQ, objId, instId, NULL);
+        return;
+    }
+    // the delta must apply to the last state received
+    bool valid = base->size() == (int)rxObj->getNumBytes() && length >= 1
+                 && Crc::updateCRC(0, (const quint8 *)base->constData(), base->size()) == data[0];
+    if (valid) {
+        state = *base;
+        valid = applyDelta((quint8 *)state.data(), state.size(), &data[1], length - 1);
+    }
+    if (!valid) {
+        qWarning().noquote() << "UAVTalk - error : delta does not match the last received state" << QString::number(objId, 16).toUpper();
+        stats.rxErrors++;
+        transmitSingleObject(TYPE_OBJ_REQ, objId, instId, NULL);
+        return;
+    }
+    receiveFrameV2(TYPE_OBJ, objId, instId, (const quint8 *)state.constData(), state.size());
+}
 
-        if (rxPacketLength != packetSize + CHECKSUM_LENGTH) {
-            // packet error - mismatched packet size
-            qWarning().noquote() << "UAVTalk - error : mismatched packet size" << QString::number(rxObjId, 16).toUpper();
-            stats.rxErrors++;
-            rxState = STATE_ERROR;
+/**
+ * Encode the XOR of data and base as runs of (unchanged bytes count, changed bytes count, changed bytes XOR),
+ * trailing unchanged bytes are omitted.
+ * \return The encoded length or -1 if it does not fit in maxLength
+ */
+int UAVTalk::encodeDelta(const quint8 *base, const quint8 *data, int length, quint8 *out, int maxLength)
+{
+    int encoded = 0;
+    int pos     = 0;
+
+    while (pos < length) {
+        int same = 0;
+        while (pos < length && same < 255 && base[pos] == data[pos]) {
+            ++pos;
+            ++same;
+        }
+        if (pos == length) {
             break;
         }
+        int start   = pos;
+        int changed = 0;
+        while (pos < length && changed < 255 && base[pos] != data[pos]) {
+            ++pos;
+            ++changed;
+        }
+        if (encoded + 2 + changed > maxLength) {
+            return -1;
+        }
+        out[encoded++] = same;
+        out[encoded++] = changed;
+        for (int i = start; i < pos; ++i) {
+            out[encoded++] = base[i] ^ data[i];
+        }
+    }
+    return encoded;
+}
 
-        rxState = STATE_COMPLETE;
-        break;
-
-    default:
+/**
+ * Apply a delta made by encodeDelta() to state.
+ * \return false if the delta is malformed or exceeds the state
+ */
+bool UAVTalk::applyDelta(quint8 *state, int stateLength, const quint8 *delta, int length)
+{
+    int pos = 0;
+    int i   = 0;
 
-        qWarning() << "UAVTalk - error : bad state";
-        rxState = STATE_ERROR;
-        break;
+    while (i < length) {
+        if (length - i < 2) {
+            return false;
+        }
+        pos += delta[i];
+        int changed = delta[i + 1];
+        i += 2;
+        if (pos + changed > stateLength || i + changed > length) {
+            return false;
+        }
+        for (int n = 0; n < changed; ++n) {
+            state[pos++] ^= delta[i++];
+        }
     }
-
-    // Done
     return true;
 }
 
@@ -474,14 +922,16 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
  * \param[in] length Buffer length
  * \return Success (true), Failure (false)
  */
-bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length)
+bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, const quint8 *data, qint32 length)
 {
-    Q_UNUSED(length);
-
     UAVObject *obj    = NULL;
     bool error        = false;
     bool allInstances = (instId == ALL_INSTANCES);
 
+    ObjectCounters *counters = objectCountersOf(objId);
+    ++counters->rxPackets;
+    counters->rxBytes += HEADER_LENGTH + length + CHECKSUM_LENGTH;
+
     // Process message type
     switch (type) {
     case TYPE_OBJ:
@@ -540,6 +990,17 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
         VERBOSE_FILTER(objId) qDebug() << "UAVTalk - received object request" << objId << instId << (obj != NULL ? obj->toStringBrief() : "<null object>");
 #endif
         if (obj != NULL) {
+            // The requester may have lost the base of the deltas, restart with a full update
+            if (allInstances) {
+                QMutableHashIterator<quint64, DeltaState> it(txDeltas);
+                while (it.hasNext()) {
+                    if ((it.next().key() >> 16) == objId) {
+                        it.remove();
+                    }
+                }
+            } else {
+                txDeltas.remove(deltaKey(objId, instId));
+            }
             // Object found, transmit it
             // The sent object will ack the object request on the receiver side
             error = !transmitObject(TYPE_OBJ, objId, instId, obj);
@@ -601,8 +1062,11 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
  * If the object instance could not be found in the list, then a
  * new one is created.
  */
-UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data)
+UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, const quint8 *data)
 {
+    // the packets of a block all arrived with the block
+    UnpackTimeScope timeScope(rxDeviceTime ? rxDeviceTime : rxReadTime);
+
     // Get object
     UAVObject *obj = objMngr->getObject(objId, instId);
 
@@ -651,7 +1115,8 @@ void UAVTalk::updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *o
                 closeTransaction(trans);
                 emit transactionCompleted(obj, true);
             } else {
-                // TODO extend timeout?
+                // the transfer goes on, let the timeout restart
+                emit transactionProgress(obj);
             }
         } else {
             closeTransaction(trans);
@@ -704,7 +1169,9 @@ bool UAVTalk::transmitObject(quint8 type, quint32 objId, quint16 instId, UAVObje
         if (allInstances) {
             // Send all instances in reverse order
             // This allows the receiver to detect when the last object has been received (i.e. when instance 0 is received)
+            // On v2 links the acked instances are packed in TYPE_MULTI_ACK frames, each acked once
             ret = true;
+            txBatchAcked = (type == TYPE_OBJ_ACK);
             quint32 numInst = objMngr->getNumInstances(objId);
             for (quint32 n = 0; n < numInst; ++n) {
                 quint32 i    = numInst - n - 1;
@@ -714,6 +1181,10 @@ bool UAVTalk::transmitObject(quint8 type, quint32 objId, quint16 instId, UAVObje
                     break;
                 }
             }
+            if (txBatchAcked) {
+                queueMultiFrameV2();
+                txBatchAcked = false;
+            }
         } else {
             ret = transmitSingleObject(type, objId, instId, obj);
         }
@@ -766,7 +1237,7 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     }
 
     // Check length
-    if (length >= MAX_PAYLOAD_LENGTH) {
+    if (length >= (txV2 ? MAX_PAYLOAD_LENGTH_V2 : MAX_PAYLOAD_LENGTH)) {
         qWarning() << "UAVTalk - error transmitting : object exceeds max payload length" << obj->toStringBrief();
         ++stats.txErrors;
         return false;
@@ -774,7 +1245,8 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
 
     // Copy data (if any)
     if (length > 0) {
-        if (!obj->pack(&txBuffer[HEADER_LENGTH])) {
+        bool packed = transmitSnapshots ? obj->readSnapshot(&txBuffer[HEADER_LENGTH]) : obj->pack(&txBuffer[HEADER_LENGTH]);
+        if (!packed) {
             qWarning() << "UAVTalk - error transmitting : failed to pack object" << obj->toStringBrief();
             ++stats.txErrors;
             return false;
@@ -787,12 +1259,103 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     // Calculate checksum
     txBuffer[HEADER_LENGTH + length] = Crc::updateCRC(0, txBuffer, HEADER_LENGTH + length);
 
-    // Send buffer, check that the transmit backlog does not grow above limit
+    // Queue the packet in the transmit batch, check that the transmit backlog does not grow above limit
+    int packetLength = HEADER_LENGTH + length + CHECKSUM_LENGTH;
+    // the control updates are small and must not be dropped nor wait, they are written at once
+    bool control     = (type == TYPE_OBJ) && (objId == GCSReceiver::OBJID || objId == ManualControlCommand::OBJID);
     if (!io.isNull() && io->isWritable()) {
-        if (io->bytesToWrite() < TX_BUFFER_SIZE) {
-            io->write((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH);
-            if (useUDPMirror) {
-                udpSocketRx->writeDatagram((const char *)txBuffer, HEADER_LENGTH + length + CHECKSUM_LENGTH, QHostAddress::LocalHost, udpSocketTx->localPort());
+        // an acked all instances transfer is queued whole, it is paced by its acks
+        if (txBatchAcked || control || io->bytesToWrite() + txPending.size() + txMulti.size() < TX_BUFFER_SIZE) {
+            if (v2Enabled && !txV2 && v2ProbesSent < V2_PROBE_COUNT
+                && (!v2ProbeTimer.isValid() || v2ProbeTimer.elapsed() >= V2_PROBE_PERIOD)) {
+                // let the peer know we speak v2
+                queueFrameV2(TYPE_NACK, 0, 0, NULL, 0);
+                v2ProbeTimer.start();
+                ++v2ProbesSent;
+            }
+            if (!txV2) {
+                if (txPending.size() + packetLength > TX_BATCH_SIZE) {
+                    flush();
+                }
+                txPending.append((const char *)txBuffer, packetLength);
+                stats.txBytes += packetLength;
+            } else if (type == TYPE_OBJ) {
+                const quint8 *data = &txBuffer[HEADER_LENGTH];
+                const quint8 *recordData = data;
+                int recordLength = length;
+                quint8 recordType = TYPE_MULTI;
+                if (deltaEnabled) {
+                    DeltaState &state = txDeltas[deltaKey(objId, instId)];
+                    if (length > 1 && state.data.size() == length && state.deltas < DELTA_KEYFRAME_INTERVAL) {
+                        const quint8 *base = (const quint8 *)state.data.constData();
+                        int encoded = encodeDelta(base, data, length, &deltaBuffer[1], length - 1);
+                        if (encoded >= 0) {
+                            deltaBuffer[0] = Crc::updateCRC(0, base, length);
+                            recordData     = deltaBuffer;
+                            recordLength   = 1 + encoded;
+                            recordType     = TYPE_DELTA;
+                        }
+                    }
+                    state.deltas = (recordType == TYPE_DELTA) ? state.deltas + 1 : 0;
+                    state.data.resize(length);
+                    memcpy(state.data.data(), data, length);
+                }
+                // updates go together in a multi object frame, full updates and deltas apart
+                if (txMultiCount > 0 && (txMultiType != recordType
+                                         || txMulti.size() + RECORD_HEADER_LENGTH + recordLength > MAX_PAYLOAD_LENGTH_V2)) {
+                    queueMultiFrameV2();
+                }
+                char record[RECORD_HEADER_LENGTH];
+                qToLittleEndian<quint32>(objId, (uchar *)&record[0]);
+                qToLittleEndian<quint16>(instId, (uchar *)&record[4]);
+                qToLittleEndian<quint16>(recordLength, (uchar *)&record[6]);
+                txMulti.append(record, RECORD_HEADER_LENGTH);
+                txMulti.append((const char *)recordData, recordLength);
+                txMultiType = recordType;
+                ++txMultiCount;
+            } else if (type == TYPE_OBJ_ACK && txBatchAcked) {
+                if (deltaEnabled) {
+                    DeltaState &state = txDeltas[deltaKey(objId, instId)];
+                    state.deltas = 0;
+                    state.data.resize(length);
+                    memcpy(state.data.data(), &txBuffer[HEADER_LENGTH], length);
+                }
+                // instances of the same object go together, acked once per frame
+                if (txMultiCount > 0 && (txMultiType != TYPE_MULTI_ACK
+                                         || txMulti.size() + RECORD_HEADER_LENGTH + length > MAX_PAYLOAD_LENGTH_V2)) {
+                    queueMultiFrameV2();
+                }
+                char record[RECORD_HEADER_LENGTH];
+                qToLittleEndian<quint32>(objId, (uchar *)&record[0]);
+                qToLittleEndian<quint16>(instId, (uchar *)&record[4]);
+                qToLittleEndian<quint16>(length, (uchar *)&record[6]);
+                txMulti.append(record, RECORD_HEADER_LENGTH);
+                txMulti.append((const char *)&txBuffer[HEADER_LENGTH], length);
+                txMultiType = TYPE_MULTI_ACK;
+                ++txMultiCount;
+            } else {
+                if (deltaEnabled && type == TYPE_OBJ_ACK) {
+                    // the peer receives the acked update whole
+                    DeltaState &state = txDeltas[deltaKey(objId, instId)];
+                    state.deltas = 0;
+                    state.data.resize(length);
+                    memcpy(state.data.data(), &txBuffer[HEADER_LENGTH], length);
+                }
+                // keep the order with the updates waiting in the multi object frame
+                queueMultiFrameV2();
+                queueFrameV2(type, objId, instId, &txBuffer[HEADER_LENGTH], length);
+            }
+            if (control) {
+                flush();
+                QHash<quint32, qint64>::iterator sample = controlSamples.find(objId);
+                if (sample != controlSamples.end()) {
+                    latency.control.add(LatencyHistogram::timestamp() - sample.value());
+                    controlSamples.erase(sample);
+                }
+            } else if (!txFlushQueued) {
+                // the packets sent from the same event are written at once
+                txFlushQueued = true;
+                QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
             }
         } else {
             qWarning() << "UAVTalk - error transmitting : io device full";
@@ -805,71 +1368,123 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
         return false;
     }
 
+    if (!frameTaps.isEmpty() && (type == TYPE_OBJ || type == TYPE_OBJ_ACK)) {
+        qint64 timestamp = LatencyHistogram::timestamp();
+        foreach(FrameTap * tap, frameTaps) {
+            tap->frame(timestamp, txBuffer, packetLength);
+        }
+    }
+    if (udpMirror) {
+        udpMirror->frame(UDPMirror::TX, txBuffer, packetLength);
+    }
+
     // Update stats
     ++stats.txObjects;
     stats.txObjectBytes += length;
-    stats.txBytes += HEADER_LENGTH + length + CHECKSUM_LENGTH;
+    ObjectCounters *counters = objectCountersOf(objId);
+    ++counters->txPackets;
+    counters->txBytes += packetLength;
 
     // Done
     return true;
 }
 
+/**
+ * Queue a v2 frame in the transmit batch.
+ */
+void UAVTalk::queueFrameV2(quint8 type, quint32 objId, quint16 instId, const quint8 *data, int length)
+{
+    quint8 header[HEADER_LENGTH_V2];
+
+    header[0] = SYNC_VAL;
+    header[1] = TYPE_VER2 | (type & ~TYPE_MASK);
+    qToLittleEndian<quint16>(HEADER_LENGTH_V2 + length, &header[2]);
+    qToLittleEndian<quint16>(txSequence++, &header[4]);
+    qToLittleEndian<quint32>(objId, &header[6]);
+    qToLittleEndian<quint16>(instId, &header[10]);
+
+    quint8 checksum[CHECKSUM_LENGTH_V2];
+    quint16 crc = Crc::updateCRC16(0xFFFF, header, HEADER_LENGTH_V2);
+    qToLittleEndian<quint16>(Crc::updateCRC16(crc, data, length), checksum);
+
+    int frameLength = HEADER_LENGTH_V2 + length + CHECKSUM_LENGTH_V2;
+    if (txPending.size() + frameLength > TX_BATCH_SIZE) {
+        writePending();
+    }
+    txPending.append((const char *)header, HEADER_LENGTH_V2);
+    if (length > 0) {
+        txPending.append((const char *)data, length);
+    }
+    txPending.append((const char *)checksum, CHECKSUM_LENGTH_V2);
+    stats.txBytes += frameLength;
+}
+
+/**
+ * Queue the multi object frame being assembled, a single full update goes as a plain object frame.
+ */
+void UAVTalk::queueMultiFrameV2()
+{
+    if (txMultiCount == 0) {
+        return;
+    }
+    QByteArray records = txMulti;
+    int count = txMultiCount;
+    txMulti.resize(0);
+    txMultiCount = 0;
+
+    const quint8 *data = (const quint8 *)records.constData();
+    if (txMultiType == TYPE_DELTA) {
+        queueFrameV2(TYPE_DELTA, 0, 0, data, records.size());
+    } else if (count == 1) {
+        queueFrameV2(txMultiType == TYPE_MULTI_ACK ? TYPE_OBJ_ACK : TYPE_OBJ,
+                     qFromLittleEndian<quint32>(&data[0]), qFromLittleEndian<quint16>(&data[4]),
+                     &data[RECORD_HEADER_LENGTH], records.size() - RECORD_HEADER_LENGTH);
+    } else if (txMultiType == TYPE_MULTI_ACK) {
+        queueFrameV2(TYPE_MULTI_ACK, qFromLittleEndian<quint32>(&data[0]), 0, data, records.size());
+    } else {
+        queueFrameV2(TYPE_MULTI, 0, 0, data, records.size());
+    }
+}
+
+/**
+ * Lookup the transaction of an instance, or the ALL_INSTANCES one of its object.
+ * The returned pointer is valid until the next change of the transactions.
+ */
 UAVTalk::Transaction *UAVTalk::findTransaction(quint32 objId, quint16 instId)
 {
-    // Lookup the transaction in the transaction map
-    QMap<quint32, Transaction *> *objTransactions = transMap.value(objId, NULL);
-    if (objTransactions != NULL) {
-        Transaction *trans = objTransactions->value(instId, NULL);
-        if (trans == NULL) {
-            // see if there is an ALL_INSTANCES transaction
-            trans = objTransactions->value(ALL_INSTANCES, NULL);
+    QHash<quint64, Transaction>::iterator i = transMap.find(transactionKey(objId, instId));
+
+    if (i == transMap.end()) {
+        // see if there is an ALL_INSTANCES transaction
+        i = transMap.find(transactionKey(objId, ALL_INSTANCES));
+        if (i == transMap.end()) {
+            return NULL;
         }
-        return trans;
     }
-    return NULL;
+    return &i.value();
 }
 
 void UAVTalk::openTransaction(quint8 type, quint32 objId, quint16 instId)
 {
-    Transaction *trans = new Transaction();
-
-    trans->respType   = (type == TYPE_OBJ_REQ) ? TYPE_OBJ : TYPE_ACK;
-    trans->respObjId  = objId;
-    trans->respInstId = instId;
+    Transaction trans;
 
-    QMap<quint32, Transaction *> *objTransactions = transMap.value(trans->respObjId, NULL);
-    if (objTransactions == NULL) {
-        objTransactions = new QMap<quint32, Transaction *>();
-        transMap.insert(trans->respObjId, objTransactions);
-    }
-    objTransactions->insert(trans->respInstId, trans);
+    trans.respType   = (type == TYPE_OBJ_REQ) ? TYPE_OBJ : TYPE_ACK;
+    trans.respObjId  = objId;
+    trans.respInstId = instId;
+    transMap.insert(transactionKey(objId, instId), trans);
 }
 
 void UAVTalk::closeTransaction(Transaction *trans)
 {
-    QMap<quint32, Transaction *> *objTransactions = transMap.value(trans->respObjId, NULL);
-    if (objTransactions != NULL) {
-        objTransactions->remove(trans->respInstId);
-        // Keep the map even if it is empty
-        // There are at most 100 different object IDs...
-        delete trans;
-    }
+    transMap.remove(transactionKey(trans->respObjId, trans->respInstId));
 }
 
 void UAVTalk::closeAllTransactions()
 {
-    foreach(quint32 objId, transMap.keys()) {
-        QMap<quint32, Transaction *> *objTransactions = transMap.value(objId, NULL);
-        foreach(quint32 instId, objTransactions->keys()) {
-            Transaction *trans = objTransactions->value(instId, NULL);
-
-            qWarning() << "UAVTalk - closing active transaction for object" << trans->respObjId;
-            objTransactions->remove(instId);
-            delete trans;
-        }
-        transMap.remove(objId);
-        delete objTransactions;
+    foreach(const Transaction &trans, transMap) {
+        qWarning() << "UAVTalk - closing active transaction for object" << trans.respObjId;
     }
+    transMap.clear();
 }
 
 const char *UAVTalk::typeToString(quint8 type)
@@ -898,6 +1513,11 @@ const char *UAVTalk::typeToString(quint8 type)
     case TYPE_NACK:
         return "nack";
 
+        break;
+
+    case TYPE_MULTI:
+        return "multi object";
+
         break;
     }
     return "<error>";
@@ -29,23 +29,31 @@
 
 #include "uavobjectmanager.h"
 #include "uavtalk_global.h"
+#include "latencyhistogram.h"
+#include "udpmirror.h"
 
 #include <QtCore>
 #include <QIODevice>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QMap>
+#include <QHash>
 #include <QThread>
+#include <QElapsedTimer>
 #include <QtNetwork/QUdpSocket>
 
 class UAVTALK_EXPORT UAVTalk : public QObject {
     Q_OBJECT
 
-    friend class IODeviceReader;
-
 public:
     static const quint16 ALL_INSTANCES = 0xFFFF;
 
+    // Key of the flat transaction tables, one entry per (object, instance)
+    static inline quint64 transactionKey(quint32 objId, quint16 instId)
+    {
+        return ((quint64)objId << 16) | instId;
+    }
+
     typedef struct {
         quint32 txBytes;
         quint32 txObjectBytes;
@@ -58,20 +66,76 @@ public:
         quint32 rxErrors;
         quint32 rxSyncErrors;
         quint32 rxCrcErrors;
+        quint32 rxLostFrames; // gaps in the v2 framing sequence numbers
     } ComStats;
 
+    // Receives a copy of the object packets going through the link, validated received packets
+    // and transmitted packets. Called with the UAVTalk lock held, from the receiving or transmitting thread.
+    class FrameTap {
+    public:
+        virtual ~FrameTap() {}
+        // timestamp in microseconds, see LatencyHistogram::timestamp()
+        virtual void frame(qint64 timestamp, const quint8 *packet, int length) = 0;
+    };
+
+    // Receive latencies, see processInputStream()
+    typedef struct {
+        LatencyHistogram device; // arrival on the device to read by UAVTalk
+        LatencyHistogram decode; // read to object unpacked (objectUnpacked() handlers included)
+        LatencyHistogram total; // arrival on the device to object unpacked
+        QHash<quint32, LatencyHistogram> objects; // total, by object id
+        LatencyHistogram control; // control input sampled to written on the device, see markControlSample()
+    } LatencyStats;
+
+    // Packets and bytes by object, the bytes are those of the v1 packets
+    // (v2 frames and deltas are smaller on the wire), acks and requests included
+    typedef struct {
+        quint32 objId;
+        quint32 txPackets;
+        quint32 txBytes;
+        quint32 rxPackets;
+        quint32 rxBytes;
+    } ObjectCounters;
+
+    typedef struct {
+        qint64  periodMs; // since resetStats()
+        quint32 txBytes; // whole link, for the share of each object
+        quint32 rxBytes;
+        QVector<ObjectCounters> objects; // unordered, objId 0 gathers the objects the table had no room for
+    } BandwidthStats;
+
     UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr);
     ~UAVTalk();
 
     ComStats getStats();
+    LatencyStats getLatencyStats();
+    BandwidthStats getBandwidthStats();
+    // resets the latencies and the bandwidth counters too
     void resetStats();
 
+    void setTransmitSnapshots(bool enable);
+    void setFramingV2Enabled(bool enable);
+    bool isFramingV2() const;
+    void setDeltaUpdatesEnabled(bool enable);
+    void addFrameTap(FrameTap *tap);
+    void removeFrameTap(FrameTap *tap);
+
+    void markControlSample(quint32 objId, qint64 timestamp);
+
+    // Arrival time of the packet being unpacked by the calling thread, in microseconds
+    // (see LatencyHistogram::timestamp()). Valid in the directly connected objectUnpacked() handlers, 0 otherwise.
+    static qint64 unpackTimestamp();
+
     bool sendObject(UAVObject *obj, bool acked, bool allInstances);
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
     void cancelTransaction(UAVObject *obj);
 
 signals:
     void transactionCompleted(UAVObject *obj, bool success);
+    void transactionProgress(UAVObject *obj);
+
+public slots:
+    void flush();
 
 private slots:
     void processInputStream();
@@ -85,6 +149,11 @@ private:
         quint16 respInstId;
     } Transaction;
 
+    typedef struct {
+        QByteArray data; // last update sent
+        int deltas; // deltas sent since the last full update
+    } DeltaState;
+
     // Constants
     static const int TYPE_MASK     = 0xF8;
     static const int TYPE_VER      = 0x20;
@@ -103,12 +172,40 @@ private:
 
     static const int MAX_PACKET_LENGTH  = (HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
 
+    // v2 framing, used once both ends have shown they support it (see setFramingV2Enabled())
+    static const int TYPE_VER2     = 0x40;
+    // v2 only, several TYPE_OBJ updates in one frame
+    static const int TYPE_MULTI    = (TYPE_VER | 0x05);
+    // v2 only, same as TYPE_MULTI with each update given as a delta, see encodeDelta()
+    static const int TYPE_DELTA    = (TYPE_VER | 0x06);
+    // v2 only, consecutive instances of one object in one frame, acked by a single TYPE_ACK of the last record
+    static const int TYPE_MULTI_ACK = (TYPE_VER | 0x07);
+
+    // v2 header : sync(1), type (1), size(2), sequence(2), object ID(4), instance ID(2)
+    static const int HEADER_LENGTH_V2 = 12;
+
+    static const int MAX_PAYLOAD_LENGTH_V2 = 1024;
+
+    // CRC-16, little endian
+    static const int CHECKSUM_LENGTH_V2    = 2;
+
+    // multi object record : object ID(4), instance ID(2), data length(2)
+    static const int RECORD_HEADER_LENGTH  = 8;
+
+    // the v2 probe (a NACK of object 0) is repeated until the peer answers in v2
+    static const int V2_PROBE_PERIOD = 1000;
+    static const int V2_PROBE_COUNT  = 10;
+
+    // a full update is sent after that many deltas of an object
+    static const int DELTA_KEYFRAME_INTERVAL = 16;
+
     static const int TX_BUFFER_SIZE     = 2 * 1024;
 
-    // Types
-    typedef enum {
-        STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_DATA, STATE_CS, STATE_COMPLETE, STATE_ERROR
-    } RxStateType;
+    // packets are written together up to this size, several HID reports (62 data bytes each)
+    static const int TX_BATCH_SIZE      = 512;
+
+    // per object counters, open addressing by object id, power of 2 above the number of object types
+    static const int OBJECT_COUNTER_SLOTS = 1024;
 
     // Variables
     QPointer<QIODevice> io;
@@ -116,44 +213,88 @@ private:
     UAVObjectManager *objMngr;
 
     ComStats stats;
+    LatencyStats latency;
+    ObjectCounters objectCounters[OBJECT_COUNTER_SLOTS];
+    ObjectCounters otherCounters;
+    QElapsedTimer statsPeriod;
 
     QMutex mutex;
 
-    QMap<quint32, QMap<quint32, Transaction *> *> transMap;
-
-    quint8 rxBuffer[MAX_PACKET_LENGTH];
-
-    quint8 txBuffer[MAX_PACKET_LENGTH];
-
-    // Variables used by the receive state machine
-    // state machine variables
-    qint32 rxCount;
-    qint32 packetSize;
-    RxStateType rxState;
-    // data variables
-    quint8 rxTmpBuffer[4];
-    quint8 rxType;
-    quint32 rxObjId;
-    quint16 rxInstId;
-    quint16 rxLength;
-    quint16 rxPacketLength;
-    quint8 rxCSPacket;
-    quint8 rxCS;
-
+    // pending transactions by transactionKey(), held by value
+    QHash<quint64, Transaction> transMap;
+
+    // always holds a v1 packet, v2 frames are built from it
+    quint8 txBuffer[HEADER_LENGTH + MAX_PAYLOAD_LENGTH_V2 + CHECKSUM_LENGTH];
+
+    // packets not written to the device yet, see flush()
+    QByteArray txPending;
+    bool txFlushQueued;
+
+    // Variables used by the block decoder
+    // bytes read from the device that have not been consumed yet (at most one partial packet)
+    QByteArray rxStream;
+    // timestamps of the block being decoded: arrival on the device (0 if unknown) and read
+    qint64 rxDeviceTime;
+    qint64 rxReadTime;
+
+    // pack objects from their snapshot instead of their live data
+    bool transmitSnapshots;
+
+    // v2 framing state: allowed, in use for transmission, sequence numbers
+    bool v2Enabled;
+    bool txV2;
+    quint16 txSequence;
+    quint16 rxSequence;
+    bool rxSequenceValid;
+    int v2ProbesSent;
+    QElapsedTimer v2ProbeTimer;
+    // records of the multi object frame being assembled, queued on flush()
+    QByteArray txMulti;
+    int txMultiCount;
+    quint8 txMultiType;
+    // acked all instances transfer in progress, on v2 links its updates go in TYPE_MULTI_ACK frames
+    bool txBatchAcked;
+    // delta updates: last state sent and received by object instance (see deltaKey())
+    bool deltaEnabled;
+    QHash<quint64, DeltaState> txDeltas;
+    QHash<quint64, QByteArray> rxDeltas;
+    quint8 deltaBuffer[MAX_PAYLOAD_LENGTH_V2];
+    // v1 copy of a received v2 frame for the frame taps and the UDP mirror
+    quint8 rxV1Buffer[HEADER_LENGTH + MAX_PAYLOAD_LENGTH_V2 + CHECKSUM_LENGTH];
+
+    QList<FrameTap *> frameTaps;
+
+    // input sample time of the pending update of the control objects, see markControlSample()
+    QHash<quint32, qint64> controlSamples;
+
+    // one datagram per packet on udpSocketTx/udpSocketRx, or batched through udpMirror
     bool useUDPMirror;
     QUdpSocket *udpSocketTx;
     QUdpSocket *udpSocketRx;
-    QByteArray rxDataArray;
+    UDPMirror *udpMirror;
 
     // Methods
     bool objectTransaction(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
-    bool processInputByte(quint8 rxbyte);
-    bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length);
-    UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
+    int processInputBuffer(const quint8 *data, int length);
+    int processInputFrameV2(const quint8 *packet, int available);
+    bool receiveFrameV2(quint8 type, quint32 objId, quint16 instId, const quint8 *data, int length);
+    void receiveDeltaV2(quint32 objId, quint16 instId, const quint8 *data, int length);
+    static quint64 deltaKey(quint32 objId, quint16 instId)
+    {
+        return ((quint64)objId << 16) | instId;
+    }
+    static int encodeDelta(const quint8 *base, const quint8 *data, int length, quint8 *out, int maxLength);
+    static bool applyDelta(quint8 *state, int stateLength, const quint8 *delta, int length);
+    bool receiveObject(quint8 type, quint32 objId, quint16 instId, const quint8 *data, qint32 length);
+    ObjectCounters *objectCountersOf(quint32 objId);
+    UAVObject *updateObject(quint32 objId, quint16 instId, const quint8 *data);
     void updateAck(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
     void updateNack(quint32 objId, quint16 instId, UAVObject *obj);
     bool transmitObject(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
     bool transmitSingleObject(quint8 type, quint32 objId, quint16 instId, UAVObject *obj);
+    void queueFrameV2(quint8 type, quint32 objId, quint16 instId, const quint8 *data, int length);
+    void queueMultiFrameV2();
+    void writePending();
 
     Transaction *findTransaction(quint32 objId, quint16 instId);
     void openTransaction(quint8 type, quint32 objId, quint16 instId);
@@ -13,19 +13,36 @@ include(uavtalk_dependencies.pri)
 
 HEADERS += \
     uavtalk_global.h \
+    latencyhistogram.h \
+    recordpool.h \
+    udpmirror.h \
     uavtalk.h \
     telemetry.h \
     telemetrymonitor.h \
+    telemetryconnection.h \
     telemetrymanager.h \
+    telemetryserver.h \
+    syntheticlink.h \
+    replaybenchmark.h \
+    metricsserver.h \
     oplinkmanager.h \
+    oplinkstatuscache.h \
     uavtalkplugin.h
 
 SOURCES += \
+    latencyhistogram.cpp \
+    udpmirror.cpp \
     uavtalk.cpp \
     telemetry.cpp \
     telemetrymonitor.cpp \
+    telemetryconnection.cpp \
     telemetrymanager.cpp \
+    telemetryserver.cpp \
+    syntheticlink.cpp \
+    replaybenchmark.cpp \
+    metricsserver.cpp \
     oplinkmanager.cpp \
+    oplinkstatuscache.cpp \
     uavtalkplugin.cpp
 
 OTHER_FILES += UAVTalk.pluginspec
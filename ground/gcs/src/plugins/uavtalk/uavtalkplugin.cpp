@@ -28,12 +28,18 @@
 #include "uavtalkplugin.h"
 
 #include "telemetrymanager.h"
+#include "telemetryserver.h"
+#include "replaybenchmark.h"
+#include "metricsserver.h"
 #include "oplinkmanager.h"
+#include "syntheticlink.h"
 
 #include <coreplugin/icore.h>
 #include <coreplugin/connectionmanager.h>
+#include <coreplugin/generalsettings.h>
+#include <extensionsystem/pluginmanager.h>
 
-UAVTalkPlugin::UAVTalkPlugin() : telemetryManager(0)
+UAVTalkPlugin::UAVTalkPlugin() : telemetryManager(0), telemetryServer(0), replayBenchmark(0), metricsServer(0), metricsPort(0)
 {}
 
 UAVTalkPlugin::~UAVTalkPlugin()
@@ -51,9 +57,18 @@ void UAVTalkPlugin::extensionsInitialized()
 bool UAVTalkPlugin::initialize(const QStringList & arguments, QString *errorString)
 {
     // Done
-    Q_UNUSED(arguments);
     Q_UNUSED(errorString);
 
+    int index = arguments.indexOf(QLatin1String("-replay-benchmark"));
+    if (index >= 0 && index + 1 < arguments.count()) {
+        replayBenchmarkFile = arguments.at(index + 1);
+    }
+
+    index = arguments.indexOf(QLatin1String("-metrics-port"));
+    if (index >= 0 && index + 1 < arguments.count()) {
+        metricsPort = arguments.at(index + 1).toUShort();
+    }
+
     // Create TelemetryManager
     telemetryManager = new TelemetryManager();
     addAutoReleasedObject(telemetryManager);
@@ -62,16 +77,58 @@ bool UAVTalkPlugin::initialize(const QStringList & arguments, QString *errorStri
     OPLinkManager *opLinkManager = new OPLinkManager();
     addAutoReleasedObject(opLinkManager);
 
+    // synthetic load for profiling, offered in the connection list
+    if (arguments.contains(QLatin1String("-synthetic-link"))) {
+        addAutoReleasedObject(new SyntheticConnection());
+    }
+
     // Connect to connection manager so we get notified when the user connect to his device
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
     QObject::connect(cm, SIGNAL(deviceConnected(QIODevice *)), this, SLOT(onDeviceConnect(QIODevice *)));
     QObject::connect(cm, SIGNAL(deviceAboutToDisconnect()), this, SLOT(onDeviceDisconnect()));
 
+    // The general settings are read once all plugins are initialized
+    connect(Core::ICore::instance(), SIGNAL(coreOpened()), this, SLOT(onCoreOpened()));
+
     return true;
 }
 
 void UAVTalkPlugin::shutdown()
-{}
+{
+    delete metricsServer;
+    metricsServer = 0;
+    delete replayBenchmark;
+    replayBenchmark = 0;
+    delete telemetryServer;
+    telemetryServer = 0;
+}
+
+void UAVTalkPlugin::onCoreOpened()
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
+
+    if (settings && settings->useTelemetryServer()) {
+        telemetryServer = new TelemetryServer(telemetryManager);
+        if (!telemetryServer->start(settings->telemetryServerPort())) {
+            delete telemetryServer;
+            telemetryServer = 0;
+        }
+    }
+
+    if (!replayBenchmarkFile.isEmpty()) {
+        replayBenchmark = new ReplayBenchmark(telemetryManager, replayBenchmarkFile);
+        replayBenchmark->start();
+    }
+
+    if (metricsPort) {
+        metricsServer = new MetricsServer(telemetryManager);
+        if (!metricsServer->start(metricsPort)) {
+            delete metricsServer;
+            metricsServer = 0;
+        }
+    }
+}
 
 void UAVTalkPlugin::onDeviceConnect(QIODevice *dev)
 {
@@ -32,6 +32,9 @@
 #include "uavtalk.h"
 
 class TelemetryManager;
+class TelemetryServer;
+class ReplayBenchmark;
+class MetricsServer;
 
 class UAVTALK_EXPORT UAVTalkPlugin : public ExtensionSystem::IPlugin {
     Q_OBJECT
@@ -48,9 +51,15 @@ public:
 protected slots:
     void onDeviceConnect(QIODevice *dev);
     void onDeviceDisconnect();
+    void onCoreOpened();
 
 private:
     TelemetryManager *telemetryManager;
+    TelemetryServer *telemetryServer;
+    ReplayBenchmark *replayBenchmark;
+    QString replayBenchmarkFile;
+    MetricsServer *metricsServer;
+    quint16 metricsPort;
 };
 
 #endif // UAVTALKPLUGIN_H
@@ -0,0 +1,104 @@
+/**
+ ******************************************************************************
+ *
+ * @file       udpmirror.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Batched mirror of the telemetry stream to UDP
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "udpmirror.h"
+
+#include <QtEndian>
+#include <QMutexLocker>
+
+UDPMirror::UDPMirror(const QHostAddress &address, quint16 port, bool compress, QObject *parent) :
+    QObject(parent), m_address(address), m_port(port), m_compress(compress),
+    m_sequence(0), m_flushQueued(false)
+{
+    m_socket = new QUdpSocket(this);
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(dummyRead()));
+    m_records.reserve(m_compress ? COMPRESSED_BATCH_SIZE : BATCH_SIZE);
+}
+
+/**
+ * Add a packet to the next datagram.
+ * Can be called from any thread.
+ */
+void UDPMirror::frame(Direction direction, const quint8 *packet, int length)
+{
+    QMutexLocker locker(&m_mutex);
+
+    int batchSize = m_compress ? COMPRESSED_BATCH_SIZE : BATCH_SIZE;
+
+    if (HEADER_LENGTH + m_records.size() + RECORD_HEADER_LENGTH + length > batchSize) {
+        sendDatagram();
+    }
+
+    quint8 header[RECORD_HEADER_LENGTH];
+    header[0] = direction;
+    qToLittleEndian<quint16>(length, &header[1]);
+    m_records.append((const char *)header, RECORD_HEADER_LENGTH);
+    m_records.append((const char *)packet, length);
+
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Send the collected packets as one datagram.
+ */
+void UDPMirror::flush()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_flushQueued = false;
+    sendDatagram();
+}
+
+void UDPMirror::sendDatagram()
+{
+    if (m_records.isEmpty()) {
+        return;
+    }
+
+    quint8 header[HEADER_LENGTH];
+    header[0] = VERSION;
+    header[1] = m_compress ? FLAG_COMPRESSED : 0;
+    qToLittleEndian<quint32>(m_sequence++, &header[2]);
+
+    QByteArray datagram((const char *)header, HEADER_LENGTH);
+    datagram.append(m_compress ? qCompress(m_records) : m_records);
+    m_socket->writeDatagram(datagram, m_address, m_port);
+
+    m_records.resize(0);
+}
+
+void UDPMirror::dummyRead()
+{
+    QByteArray junk;
+
+    while (m_socket->hasPendingDatagrams()) {
+        junk.resize(m_socket->pendingDatagramSize());
+        m_socket->readDatagram(junk.data(), junk.size());
+    }
+}
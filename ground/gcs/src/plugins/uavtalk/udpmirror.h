@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ *
+ * @file       udpmirror.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief      Batched mirror of the telemetry stream to UDP
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UDPMIRROR_H
+#define UDPMIRROR_H
+
+#include "uavtalk_global.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QHostAddress>
+#include <QtNetwork/QUdpSocket>
+
+/**
+ * Copies the UAVTalk packets sent and received on a link to a UDP destination
+ * for external tools, packing as many packets as fit in one datagram.
+ *
+ * Datagram layout (little endian):
+ *   version (1), flags (1), sequence number (4), records
+ * where each record is
+ *   direction (1, RX or TX), packet length (2), packet
+ * With FLAG_COMPRESSED the records are compressed with qCompress().
+ * The sequence number increments by one per datagram so that receivers can detect losses.
+ *
+ * Packets are collected until the datagram is full or control returns to the event loop.
+ */
+class UAVTALK_EXPORT UDPMirror : public QObject {
+    Q_OBJECT
+
+public:
+    enum Direction { RX = 0, TX = 1 };
+
+    static const quint8 VERSION         = 1;
+    static const quint8 FLAG_COMPRESSED = 0x01;
+
+    UDPMirror(const QHostAddress &address, quint16 port, bool compress, QObject *parent = 0);
+
+    void frame(Direction direction, const quint8 *packet, int length);
+
+public slots:
+    void flush();
+
+private slots:
+    void dummyRead();
+
+private:
+    static const int HEADER_LENGTH         = 6;
+    static const int RECORD_HEADER_LENGTH  = 3;
+    // keeps plain datagrams within an ethernet MTU, compressed ones shrink well below it
+    static const int BATCH_SIZE            = 1400;
+    static const int COMPRESSED_BATCH_SIZE = 8192;
+
+    QMutex m_mutex;
+    QUdpSocket *m_socket;
+    QHostAddress m_address;
+    quint16 m_port;
+    bool m_compress;
+    quint32 m_sequence;
+    // records of the next datagram
+    QByteArray m_records;
+    bool m_flushQueued;
+
+    void sendDatagram();
+};
+
+#endif // UDPMIRROR_H
@@ -30,7 +30,7 @@
 #include <QSerialPort>
 #include <QDebug>
 
-port::port(QString name, bool debug) : mstatus(port::closed), debug(debug)
+port::port(QString name, bool debug) : mstatus(port::closed), rxBuffPos(0), debug(debug)
 {
     timer.start();
     sport = new QSerialPort(name, this);
@@ -60,23 +60,32 @@ port::portstatus port::status()
 
 int16_t port::pfSerialRead(void)
 {
-    char c[1];
-
-    // TODO why the wait ? (gcs uploader dfu does not have it)
-    sport->waitForBytesWritten(1);
-    if (sport->bytesAvailable() || sport->waitForReadyRead(0)) {
-        sport->read(c, 1);
-        if (debug) {
-            if (((uint8_t)c[0]) == 0xe1 || rxDebugBuff.count() > 50) {
-                qDebug() << "PORT R " << rxDebugBuff.toHex();
-                rxDebugBuff.clear();
-            }
-            rxDebugBuff.append(c[0]);
+    // fetch whatever the port has in one go and hand it out byte by byte
+    if (rxBuffPos >= rxBuff.size()) {
+        if (!sport->bytesAvailable() && !sport->waitForReadyRead(0)) {
+            return -1;
         }
-    } else {
-        return -1;
+        rxBuff    = sport->readAll();
+        rxBuffPos = 0;
+        if (rxBuff.isEmpty()) {
+            return -1;
+        }
+    }
+    char c = rxBuff.at(rxBuffPos++);
+    if (debug) {
+        if (((uint8_t)c) == 0xe1 || rxDebugBuff.count() > 50) {
+            qDebug() << "PORT R " << rxDebugBuff.toHex();
+            rxDebugBuff.clear();
+        }
+        rxDebugBuff.append(c);
     }
-    return (uint8_t)c[0];
+    return (uint8_t)c;
+}
+
+bool port::waitForData(int msecs)
+{
+    // the wait also lets QSerialPort flush pending writes, there is no event loop in this thread
+    return rxBuffPos < rxBuff.size() || sport->bytesAvailable() || sport->waitForReadyRead(msecs);
 }
 
 void port::pfSerialWrite(uint8_t c)
@@ -96,6 +105,16 @@ void port::pfSerialWrite(uint8_t c)
     sport->waitForBytesWritten(1);
 }
 
+void port::pfSerialWrite(const uint8_t *buf, uint16_t length)
+{
+    sport->write((const char *)buf, length);
+    if (debug) {
+        qDebug() << "PORT T " << QByteArray((const char *)buf, length).toHex();
+    }
+    // there is no event loop in this thread, push the frame out before returning
+    while (sport->bytesToWrite() > 0 && sport->waitForBytesWritten(100)) {}
+}
+
 uint32_t port::pfGetTime(void)
 {
     return timer.elapsed();
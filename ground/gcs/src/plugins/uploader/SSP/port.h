@@ -49,6 +49,8 @@ public:
 
     virtual int16_t pfSerialRead(void); // function to read a character from the serial input stream
     virtual void pfSerialWrite(uint8_t); // function to write a byte to be sent out the serial port
+    virtual void pfSerialWrite(const uint8_t *buf, uint16_t length); // function to write a whole frame
+    virtual bool waitForData(int msecs); // blocks until input is available or msecs elapsed
     virtual uint32_t pfGetTime(void);
 
     uint8_t retryCount; // how many times have we tried to transmit the 'send' packet
@@ -81,6 +83,8 @@ private:
     portstatus mstatus;
     QTime timer;
     QSerialPort *sport;
+    QByteArray rxBuff; // bytes read from the serial port but not yet consumed
+    int rxBuffPos;
 
     bool debug;
     QByteArray rxDebugBuff;
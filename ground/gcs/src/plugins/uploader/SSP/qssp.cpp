@@ -408,13 +408,18 @@ uint16_t qssp::ssp_Synchronise()
 void qssp::sf_SendPacket()
 {
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
-
-    // use the raw serial write function so the SYNC byte does not get 'escaped'
-    thisport->pfSerialWrite(SYNC);
-    for (uint8_t x = 0; x < packetLen; x++) {
-        sf_write_byte(thisport->txBuf[x]);
+    uint16_t packetLen = thisport->txBuf[LENGTH] + 3;
+    // SYNC byte plus the packet with every byte escaped in the worst case
+    uint8_t frame[1 + 2 * (255 + 3)];
+    uint16_t frameLen = 0;
+
+    // the SYNC byte does not get 'escaped'
+    frame[frameLen++] = SYNC;
+    for (uint16_t x = 0; x < packetLen; x++) {
+        frameLen = sf_EscapeByte(thisport->txBuf[x], frame, frameLen);
     }
+    // write the frame at once instead of waiting on the port after every byte
+    thisport->pfSerialWrite(frame, frameLen);
     thisport->retryCount++;
 }
 
@@ -479,25 +484,27 @@ void qssp::sf_SendAckPacket(uint8_t seqNumber)
 }
 
 /*!
- * \brief   writes a byte out the output channel. Adds escape byte where needed
- * \param   thisport = which port to use
+ * \brief   appends a byte to an outgoing frame. Adds escape byte where needed
  * \param	c = byte to send
- * \return  none.
+ * \param	frame = frame being assembled
+ * \param	pos = current length of the frame
+ * \return  new length of the frame.
  *
  * \note
  *
  */
-void qssp::sf_write_byte(uint8_t c)
+uint16_t qssp::sf_EscapeByte(uint8_t c, uint8_t *frame, uint16_t pos)
 {
     if (c == SYNC) { // check for SYNC byte
-        thisport->pfSerialWrite(ESC); // since we are not starting a packet we must ESCAPE the SYNCH byte
-        thisport->pfSerialWrite(ESC_SYNC); // now send the escaped synch char
+        frame[pos++] = ESC; // since we are not starting a packet we must ESCAPE the SYNCH byte
+        frame[pos++] = ESC_SYNC; // now send the escaped synch char
     } else if (c == ESC) { // Check for ESC character
-        thisport->pfSerialWrite(ESC); // if it is, we need to send it twice
-        thisport->pfSerialWrite(ESC);
+        frame[pos++] = ESC; // if it is, we need to send it twice
+        frame[pos++] = ESC;
     } else {
-        thisport->pfSerialWrite(c); // otherwise write the byte to serial port
+        frame[pos++] = c; // otherwise write the byte as is
     }
+    return pos;
 }
 
 /************************************************************************************************************
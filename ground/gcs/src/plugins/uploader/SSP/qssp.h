@@ -89,7 +89,7 @@ private:
 
     // static void      sf_SendSynchPacket( Port_t *thisport );
     uint16_t    sf_crc16(uint16_t crc, uint8_t data);
-    void        sf_write_byte(uint8_t c);
+    uint16_t    sf_EscapeByte(uint8_t c, uint8_t *frame, uint16_t pos);
     void        sf_SetSendTimeout();
     uint16_t    sf_CheckTimeout();
     int16_t     sf_DecodeState(uint8_t c);
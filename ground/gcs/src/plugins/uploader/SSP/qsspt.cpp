@@ -29,7 +29,7 @@
 
 #include <QDebug>
 
-qsspt::qsspt(port *info, bool debug) : qssp(info, debug), endthread(false), datapending(false), debug(debug)
+qsspt::qsspt(port *info, bool debug) : qssp(info, debug), mport(info), endthread(false), datapending(false), dataacked(false), debug(debug)
 {}
 
 qsspt::~qsspt()
@@ -41,7 +41,6 @@ qsspt::~qsspt()
 
 void qsspt::run()
 {
-    // TODO the loop is non blocking and will spin as fast as the CPU allows
     while (!endthread) {
         receivestatus = ssp_ReceiveProcess();
         sendstatus    = ssp_SendProcess();
@@ -52,7 +51,13 @@ void qsspt::run()
         }
         sendbufmutex.unlock();
         if (sendstatus == SSP_TX_ACKED) {
+            msendwait.lock();
+            dataacked = true;
             sendwait.wakeAll();
+            msendwait.unlock();
+        } else if (receivestatus != SSP_RX_COMPLETE && !datapending) {
+            // nothing to process, sleep until the next bytes arrive rather than spinning
+            mport->waitForData(1);
         }
     }
 }
@@ -66,6 +71,8 @@ bool qsspt::sendData(uint8_t *buf, uint16_t size)
     if (datapending) {
         return false;
     }
+    msendwait.lock();
+    dataacked = false;
     sendbufmutex.lock();
     datapending = true;
     mbuf  = buf;
@@ -73,8 +80,8 @@ bool qsspt::sendData(uint8_t *buf, uint16_t size)
     sendbufmutex.unlock();
     // TODO why do we wait 10 seconds ? why do we then ignore the timeout ?
     // There is a ssp_SendDataBlock method...
-    msendwait.lock();
-    sendwait.wait(&msendwait, 10000);
+    // the ACK can arrive before we get to wait, hence the flag
+    while (!dataacked && sendwait.wait(&msendwait, 10000)) {}
     msendwait.unlock();
     return true;
 }
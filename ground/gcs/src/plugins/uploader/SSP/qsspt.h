@@ -47,6 +47,7 @@ public:
     bool sendData(uint8_t *buf, uint16_t size);
 
 private:
+    port *mport;
     uint8_t *mbuf;
     uint16_t msize;
     QQueue<QByteArray> queue;
@@ -54,6 +55,7 @@ private:
     QMutex sendbufmutex;
     bool endthread;
     bool datapending;
+    bool dataacked;
     uint16_t sendstatus;
     uint16_t receivestatus;
     QWaitCondition sendwait;
@@ -0,0 +1,171 @@
+/**
+ ******************************************************************************
+ *
+ * @file       batchflasher.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup YModemUploader YModem Serial Uploader Plugin
+ * @{
+ * @brief      Flashes every board in bootloader mode in parallel
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "batchflasher.h"
+#include "uploadergadgetwidget.h"
+
+#include <ophid/inc/ophid_hidapi.h>
+#include <ophid/inc/ophid_usbmon.h>
+
+#include <QFile>
+
+#define DFU_DEBUG true
+
+using namespace DFU;
+
+BatchFlasher::BatchFlasher(QObject *parent) : QObject(parent),
+    m_pending(0), m_succeeded(0), m_failed(0), m_boot(false)
+{}
+
+BatchFlasher::~BatchFlasher()
+{
+    clear();
+}
+
+bool BatchFlasher::isRunning() const
+{
+    return m_pending > 0;
+}
+
+/**
+   Opens every board in bootloader mode and starts its upload.
+   Boards that cannot be opened or have no bundled firmware are reported
+   through boardFinished() right away.
+ */
+int BatchFlasher::start(bool boot)
+{
+    if (isRunning()) {
+        return 0;
+    }
+    clear();
+    m_boot = boot;
+
+    QStringList paths = opHID_hidapi::devicePaths(0x20a0, USBMonitor::Bootloader);
+    foreach(QString path, paths) {
+        Board board;
+
+        board.dfu  = new DFUObject(DFU_DEBUG, path);
+        board.done = false;
+        m_boards << board;
+    }
+
+    int started = 0;
+    for (int i = 0; i < m_boards.count(); i++) {
+        DFUObject *dfu = m_boards[i].dfu;
+        if (!dfu->ready()) {
+            boardDone(i, false, tr("could not open the board"));
+            continue;
+        }
+        dfu->AbortOperation();
+        if (!dfu->enterDFU(0) || !dfu->findDevices() || dfu->numberOfDevices != 1) {
+            boardDone(i, false, tr("could not enter DFU mode"));
+            continue;
+        }
+        m_boards[i].firmware = UploaderGadgetWidget::firmwareForBoard(dfu->devices[0].ID);
+        if (m_boards[i].firmware.isEmpty()) {
+            boardDone(i, false, tr("unknown board id '0x%1'").arg(QString::number(dfu->devices[0].ID, 16)));
+            continue;
+        }
+        if (!QFile::exists(m_boards[i].firmware)) {
+            boardDone(i, false, tr("firmware image %1 is missing").arg(m_boards[i].firmware));
+            continue;
+        }
+        connect(dfu, SIGNAL(progressUpdated(int)), this, SLOT(onProgress(int)));
+        connect(dfu, SIGNAL(uploadFinished(DFU::Status)), this, SLOT(onUploadFinished(DFU::Status)));
+        if (!dfu->UploadFirmwareAndDescription(m_boards[i].firmware, 0, true)) {
+            boardDone(i, false, tr("could not start the upload"));
+            continue;
+        }
+        m_pending++;
+        started++;
+    }
+    if (!m_pending) {
+        emit finished(m_succeeded, m_failed);
+    }
+    return started;
+}
+
+void BatchFlasher::onProgress(int percent)
+{
+    int board = indexOf(sender());
+
+    if (board >= 0) {
+        emit boardProgress(board, percent);
+    }
+}
+
+void BatchFlasher::onUploadFinished(DFU::Status status)
+{
+    int board = indexOf(sender());
+
+    if (board < 0 || m_boards[board].done) {
+        return;
+    }
+    DFUObject *dfu = m_boards[board].dfu;
+    bool success   = (status == DFU::Last_operation_Success);
+    if (success && m_boot) {
+        dfu->JumpToApp(false, false);
+    }
+    m_pending--;
+    boardDone(board, success, success ? tr("upgraded to %1").arg(m_boards[board].firmware) : dfu->StatusToString(status));
+    if (!m_pending) {
+        emit finished(m_succeeded, m_failed);
+    }
+}
+
+int BatchFlasher::indexOf(QObject *dfu) const
+{
+    for (int i = 0; i < m_boards.count(); i++) {
+        if (m_boards[i].dfu == dfu) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void BatchFlasher::boardDone(int board, bool success, const QString &message)
+{
+    m_boards[board].done = true;
+    if (success) {
+        m_succeeded++;
+    } else {
+        m_failed++;
+    }
+    emit boardFinished(board, success, message);
+}
+
+void BatchFlasher::clear()
+{
+    foreach(Board board, m_boards) {
+        // the upload thread emits uploadFinished() just before returning
+        board.dfu->wait();
+        delete board.dfu;
+    }
+    m_boards.clear();
+    m_pending   = 0;
+    m_succeeded = 0;
+    m_failed    = 0;
+}
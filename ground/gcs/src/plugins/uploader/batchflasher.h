@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ *
+ * @file       batchflasher.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup YModemUploader YModem Serial Uploader Plugin
+ * @{
+ * @brief      Flashes every board in bootloader mode in parallel
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef BATCHFLASHER_H
+#define BATCHFLASHER_H
+
+#include "dfu.h"
+
+#include <QObject>
+#include <QList>
+#include <QString>
+
+/**
+   Upgrades all the boards waiting in bootloader mode at the same time.
+
+   Each board is opened through its own HID path and gets its own DFUObject
+   thread, so the transfers run concurrently instead of one board after the
+   other. The firmware is picked from the bundled images by board id.
+ */
+class BatchFlasher : public QObject {
+    Q_OBJECT
+
+public:
+    BatchFlasher(QObject *parent = 0);
+    ~BatchFlasher();
+
+    // Opens the boards and starts the uploads, returns the number of boards started
+    int start(bool boot);
+    bool isRunning() const;
+
+signals:
+    void boardProgress(int board, int percent);
+    void boardFinished(int board, bool success, QString message);
+    void finished(int succeeded, int failed);
+
+private slots:
+    void onProgress(int percent);
+    void onUploadFinished(DFU::Status status);
+
+private:
+    struct Board {
+        DFUObject *dfu;
+        QString firmware;
+        bool done;
+    };
+
+    QList<Board> m_boards;
+    int m_pending;
+    int m_succeeded;
+    int m_failed;
+    bool m_boot;
+
+    int indexOf(QObject *dfu) const;
+    void boardDone(int board, bool success, const QString &message);
+    void clear();
+};
+
+#endif // BATCHFLASHER_H
@@ -31,7 +31,6 @@
 #include <QFileDialog>
 #include <QDebug>
 #include <QDir>
-#include <QCryptographicHash>
 
 DeviceWidget::DeviceWidget(QWidget *parent) :
     QWidget(parent)
@@ -327,20 +326,19 @@ void DeviceWidget::loadFirmware(QString fwfilename)
         return;
     }
 
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
+    // the upload itself reuses this cached image
+    loadedFW = DFU::FirmwareImage::load(filename);
+    if (!loadedFW.isValid()) {
         status("Can't open file", STATUSICON_FAIL);
         return;
     }
 
-    loadedFW = file.readAll();
-
-    QByteArray desc = loadedFW.right(100);
+    QByteArray desc = loadedFW.contents().right(100);
     QPixmap px;
-    if (loadedFW.length() > (int)m_dfu->devices[deviceID].SizeOfCode) {
+    if (loadedFW.contents().length() > (int)m_dfu->devices[deviceID].SizeOfCode) {
         myDevice->lblCRCL->setText(tr("Can't calculate, file too big for device"));
     } else {
-        myDevice->lblCRCL->setText(QString::number(DFUObject::CRCFromQBArray(loadedFW, m_dfu->devices[deviceID].SizeOfCode)));
+        myDevice->lblCRCL->setText(QString::number(loadedFW.crc(m_dfu->devices[deviceID].SizeOfCode)));
     }
 
     // myDevice->lblFirmwareSizeL->setText(QString("Firmware size: ")+QVariant(loadedFW.length()).toString()+ QString(" bytes"));
@@ -392,19 +390,17 @@ void DeviceWidget::uploadFirmware()
         return;
     }
 
-    bool verify     = false;
-    /* TODO: does not work properly on current Bootloader!
-       if (m_dfu->devices[deviceID].Readable)
-        verify = true;
-     */
+    // verified by the CRC the bootloader reports, reading the image back
+    // does not work properly on current Bootloader
+    bool verify     = true;
 
-    QByteArray desc = loadedFW.right(100);
-    if (desc.startsWith("OpFw")) {
+    QByteArray desc = loadedFW.description();
+    if (!desc.isEmpty()) {
         descriptionArray = desc;
         // Now do sanity checking:
         // - Check whether board type matches firmware:
         int board = m_dfu->devices[deviceID].ID;
-        int firmwareBoard = ((quint16)(quint8)desc.at(12) << 8) + (quint16)(quint8)desc.at(13);
+        int firmwareBoard = loadedFW.boardId();
         if ((board == 0x0401 && firmwareBoard == 0x0402) ||
             (board == 0x0901 && firmwareBoard == 0x0902) || // L3GD20 revo supports Revolution firmware
             (board == 0x0902 && firmwareBoard == 0x0903) || // RevoMini1 supported by RevoMini2 firmware
@@ -417,10 +413,8 @@ void DeviceWidget::uploadFirmware()
             updateButtons(true);
             return;
         }
-        // Check the firmware embedded in the file:
-        QByteArray firmwareHash = desc.mid(40, 20);
-        QByteArray fileHash     = QCryptographicHash::hash(loadedFW.left(loadedFW.length() - 100), QCryptographicHash::Sha1);
-        if (firmwareHash != fileHash) {
+        // Check the firmware embedded in the file, hashed when it was loaded:
+        if (!loadedFW.isIntact()) {
             status("Error: firmware file corrupt", STATUSICON_FAIL);
             updateButtons(true);
             return;
@@ -449,7 +443,7 @@ void DeviceWidget::uploadFirmware()
     connect(m_dfu, SIGNAL(progressUpdated(int)), this, SLOT(setProgress(int)));
     connect(m_dfu, SIGNAL(operationProgress(QString)), this, SLOT(dfuStatus(QString)));
     connect(m_dfu, SIGNAL(uploadFinished(DFU::Status)), this, SLOT(uploadFinished(DFU::Status)));
-    bool retstatus = m_dfu->UploadFirmware(filename, verify, deviceID);
+    bool retstatus = m_dfu->UploadFirmware(filename, verify, deviceID, true);
     if (!retstatus) {
         emit uploadEnded(false);
         status("Could not start upload!", STATUSICON_FAIL);
@@ -34,6 +34,7 @@
 #include "uploadergadgetwidget.h"
 
 #include "dfu.h"
+#include "firmwareimage.h"
 #include "uavobjectutilmanager.h"
 #include "devicedescriptorstruct.h"
 
@@ -56,7 +57,7 @@ public:
 private:
     deviceDescriptorStruct onBoardDescription;
     deviceDescriptorStruct LoadedDescription;
-    QByteArray loadedFW;
+    DFU::FirmwareImage loadedFW;
     Ui_deviceWidget *myDevice;
     int deviceID;
     DFUObject *m_dfu;
@@ -26,6 +26,7 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "dfu.h"
+#include "firmwareimage.h"
 
 #include "SSP/port.h"
 #include "SSP/qsspt.h"
@@ -34,9 +35,13 @@
 #include <ophid/inc/ophid_usbmon.h>
 #include <ophid/inc/ophid_usbsignal.h>
 
+#include <utils/crc.h>
+#include <coreplugin/threadmanager.h>
+
 #include <QEventLoop>
 #include <QFile>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QDebug>
 
 #include <iostream>
@@ -54,6 +59,10 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
 
     qRegisterMetaType<DFU::Status>("Status");
 
+    if (Core::ThreadManager::instance()) {
+        Core::ThreadManager::instance()->manageThread(this, Core::ThreadManager::DfuRole);
+    }
+
     if (use_serial) {
         info = new port(portname, false);
         info->rxBuf      = sspRxBuf;
@@ -87,6 +96,9 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
         connect(serialhandle, SIGNAL(finished()), info, SLOT(deleteLater()));
 
         // start the serialhandle thread
+        if (Core::ThreadManager::instance()) {
+            Core::ThreadManager::instance()->manageThread(serialhandle, Core::ThreadManager::DfuRole);
+        }
         serialhandle->start();
     } else {
         hidHandle = new opHID_hidapi();
@@ -141,6 +153,26 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
     }
 }
 
+DFUObject::DFUObject(bool _debug, const QString &hidPath) :
+    debug(_debug), use_serial(false), mready(false)
+{
+    numberOfDevices = 0;
+    serialhandle    = NULL;
+
+    qRegisterMetaType<DFU::Status>("Status");
+
+    if (Core::ThreadManager::instance()) {
+        Core::ThreadManager::instance()->manageThread(this, Core::ThreadManager::DfuRole);
+    }
+
+    hidHandle = new opHID_hidapi();
+    if (hidHandle->openPath(hidPath) == 1) {
+        mready = true;
+    } else {
+        hidHandle->close(0);
+    }
+}
+
 DFUObject::~DFUObject()
 {
     if (use_serial) {
@@ -230,8 +262,8 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
         qDebug() << "Number of packets:" << numberOfPackets << " Size of last packet:" << lastPacketCount;
     }
 
+    // no fixed delay here: callers wait for the erase with WaitForStatus()
     int result = sendData(buf, BUF_LEN);
-    QThread::msleep(1000);
 
     if (debug) {
         qDebug() << result << " bytes sent";
@@ -246,7 +278,7 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
    Does the actual data upload to the board. Needs to be called once the
    board is ready to accept data following a StartUpload command, and it is erased.
  */
-bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
+bool DFUObject::UploadData(qint32 const & numberOfBytes, const QByteArray & data)
 {
     int lastPacketCount;
     qint32 numberOfPackets = numberOfBytes / 4 / 14;
@@ -267,13 +299,17 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
     int packetsize;
     float percentage;
     int laspercentage = 0;
+    // the bootloader does not ack data packets, so they are streamed back to back
+    // and the interrupt endpoint is the only flow control
+    QElapsedTimer timer;
+    timer.start();
     for (qint32 packetcount = 0; packetcount < numberOfPackets; ++packetcount) {
         percentage = (float)(packetcount + 1) / numberOfPackets * 100;
         if (laspercentage != (int)percentage) {
             printProgBar((int)percentage, "UPLOADING");
         }
         laspercentage = (int)percentage;
-        if (packetcount == numberOfPackets) {
+        if (packetcount == numberOfPackets - 1) {
             packetsize = lastPacketCount;
         } else {
             packetsize = 14;
@@ -283,7 +319,7 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
         buf[3]  = packetcount >> 16; // DFU Count
         buf[4]  = packetcount >> 8; // DFU Count
         buf[5]  = packetcount; // DFU Count
-        char *pointer = data.data();
+        const char *pointer = data.constData();
         pointer = pointer + 4 * 14 * packetcount;
         // if (debug) {
         // qDebug() << "Packet Number=" << packetcount << "Data0=" << (int)data[0] << " Data1=" << (int)data[1] << " Data0=" << (int)data[2] << " Data0=" << (int)data[3] << " buf6=" << (int)buf[6] << " buf7=" << (int)buf[7] << " buf8=" << (int)buf[8] << " buf9=" << (int)buf[9];
@@ -309,6 +345,10 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
         // qDebug() << "UPLOAD:" << "Data=" << (int)buf[6] << (int)buf[7] << (int)buf[8] << (int)buf[9] << ";" << result << " bytes sent";
         // }
     }
+    qint64 elapsed = qMax(timer.elapsed(), (qint64)1);
+    int rate = (int)(numberOfBytes * 1000LL / elapsed);
+    cout << "\nUploaded " << numberOfBytes << " bytes in " << elapsed << "ms (" << rate << " bytes/s)\n";
+    emit operationProgress(QString("Uploaded %1 bytes at %2 kB/s").arg(numberOfBytes).arg(rate / 1024.0, 0, 'f', 1));
     return true;
 }
 
@@ -340,6 +380,9 @@ DFU::Status DFUObject::UploadDescription(QVariant desc)
     if (!StartUpload(array.length(), DFU::Descript, 0)) {
         return DFU::abort;
     }
+    if (WaitForStatus(DFU::uploadingStarting, ERASE_TIMEOUT_MS) != DFU::uploading) {
+        return DFU::abort;
+    }
     if (!UploadData(array.length(), array)) {
         return DFU::abort;
     }
@@ -408,7 +451,14 @@ void DFUObject::run()
         break;
     case DFU::Upload:
     {
-        DFU::Status ret = UploadFirmwareT(requestFilename, requestVerify, requestDevice);
+        DFU::Status ret = UploadFirmwareT(requestFilename, requestVerify, requestDevice, requestSkipUnchanged);
+        if (ret == DFU::Last_operation_Success && requestDescription) {
+            // cached by the upload above
+            QByteArray desc = FirmwareImage::load(requestFilename).description();
+            if (!desc.isEmpty()) {
+                ret = UploadDescription(desc);
+            }
+        }
         emit(uploadFinished(ret));
         break;
     }
@@ -600,8 +650,12 @@ DFU::Status DFUObject::StatusRequest()
     const int MaxSendRetry = 10, SendRetryIntervalMS = 1000;
     while (result < 0 && retry_cnt < MaxSendRetry) {
         retry_cnt++;
-        qWarning() << "StatusRequest failed, sleeping" << SendRetryIntervalMS << "ms";
-        QThread::msleep(SendRetryIntervalMS);
+        // a HID send already blocks until the endpoint takes the report or
+        // times out, only the serial link needs a pause before retrying
+        if (use_serial) {
+            qWarning() << "StatusRequest failed, sleeping" << SendRetryIntervalMS << "ms";
+            QThread::msleep(SendRetryIntervalMS);
+        }
         qWarning() << "StatusRequest retry attempt" << retry_cnt;
         result = sendData(buf, BUF_LEN);
     }
@@ -623,6 +677,25 @@ DFU::Status DFUObject::StatusRequest()
     }
 }
 
+/**
+   Polls the bootloader until it leaves the transient state (e.g. uploadingStarting
+   while it erases), each request completing as soon as the status report is back
+ */
+DFU::Status DFUObject::WaitForStatus(DFU::Status transient, int timeoutMs)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    DFU::Status ret = StatusRequest();
+    while (ret == transient && timer.elapsed() < timeoutMs) {
+        ret = StatusRequest();
+    }
+    if (debug) {
+        qDebug() << "WaitForStatus:" << StatusToString(ret) << "after" << timer.elapsed() << "ms";
+    }
+    return ret;
+}
+
 /**
    Ask the bootloader for the list of devices available
  */
@@ -738,7 +811,7 @@ bool DFUObject::EndOperation()
 /**
    Starts a firmware upload (asynchronous)
  */
-bool DFUObject::UploadFirmware(const QString &sfile, const bool &verify, int device)
+bool DFUObject::UploadFirmware(const QString &sfile, const bool &verify, int device, const bool &skipUnchanged)
 {
     if (isRunning()) {
         return false;
@@ -747,11 +820,67 @@ bool DFUObject::UploadFirmware(const QString &sfile, const bool &verify, int dev
     requestFilename    = sfile;
     requestDevice = device;
     requestVerify = verify;
+    requestSkipUnchanged = skipUnchanged;
+    requestDescription   = false;
     start();
     return true;
 }
 
-DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify, int device)
+/**
+   Starts a firmware and description upload (asynchronous), verified by CRC
+ */
+bool DFUObject::UploadFirmwareAndDescription(const QString &sfile, int device, const bool &skipUnchanged)
+{
+    if (isRunning()) {
+        return false;
+    }
+    requestedOperation = DFU::Upload;
+    requestFilename    = sfile;
+    requestDevice = device;
+    requestVerify = true;
+    requestSkipUnchanged = skipUnchanged;
+    requestDescription   = true;
+    start();
+    return true;
+}
+
+/**
+   Checks the firmware in flash against crc, the bootloader computes the CRC
+   of the whole code area when asked for its capabilities.
+ */
+bool DFUObject::VerifyFirmwareCRC(quint32 crc, int device)
+{
+    char buf[BUF_LEN];
+
+    buf[0] = 0x02; // reportID
+    buf[1] = DFU::Req_Capabilities; // DFU Command
+    buf[2] = 0;
+    buf[3] = 0;
+    buf[4] = 0;
+    buf[5] = 0;
+    buf[6] = device + 1;
+    buf[7] = 0;
+    buf[8] = 0;
+    buf[9] = 0;
+
+    if (sendData(buf, BUF_LEN) < 1 || receiveData(buf, BUF_LEN) < 1 || buf[1] != DFU::Rep_Capabilities) {
+        return false;
+    }
+
+    quint32 aux;
+    aux = (quint8)buf[10];
+    aux = aux << 8 | (quint8)buf[11];
+    aux = aux << 8 | (quint8)buf[12];
+    aux = aux << 8 | (quint8)buf[13];
+    devices[device].FW_CRC = aux;
+
+    if (debug) {
+        qDebug() << "Verify CRC: expected" << crc << "device" << aux;
+    }
+    return aux == crc;
+}
+
+DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify, int device, const bool &skipUnchanged)
 {
     DFU::Status ret;
 
@@ -759,27 +888,20 @@ DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify,
         qDebug() << "Starting Firmware Uploading...";
     }
 
-    QFile file(sfile);
+    FirmwareImage image = FirmwareImage::load(sfile);
 
-    if (!file.open(QIODevice::ReadOnly)) {
+    if (!image.isValid()) {
         if (debug) {
             qDebug() << "Failed to open file" << sfile;
         }
         return DFU::abort;
     }
 
-    QByteArray arr = file.readAll();
+    const QByteArray &arr = image.data();
 
     if (debug) {
         qDebug() << "Bytes Loaded=" << arr.length();
     }
-    if (arr.length() % 4 != 0) {
-        int pad = arr.length() / 4;
-        ++pad;
-        pad = pad * 4;
-        pad = pad - arr.length();
-        arr.append(QByteArray(pad, (char)255));
-    }
     if (devices[device].SizeOfCode < (quint32)arr.length()) {
         if (debug) {
             qDebug() << "ERROR file to big for device";
@@ -787,11 +909,20 @@ DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify,
         return DFU::abort;;
     }
 
-    quint32 crc = DFUObject::CRCFromQBArray(arr, devices[device].SizeOfCode);
+    quint32 crc = image.crc(devices[device].SizeOfCode);
     if (debug) {
         qDebug() << "NEW FIRMWARE CRC=" << crc;
     }
 
+    // the bootloader erases the whole code area before an upload, so the only
+    // delta it allows is skipping boards which already run this image
+    if (skipUnchanged && crc == devices[device].FW_CRC) {
+        emit operationProgress("Firmware unchanged, skipping upload");
+        printProgBar(100, "UNCHANGED");
+        cout << "Firmware unchanged, upload skipped\n";
+        return DFU::Last_operation_Success;
+    }
+
     if (!StartUpload(arr.length(), DFU::FW, crc)) {
         ret = StatusRequest();
         if (debug) {
@@ -806,22 +937,12 @@ DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify,
     if (debug) {
         qDebug() << "Erasing memory";
     }
-    if (StatusRequest() == DFU::abort) {
-        return DFU::abort;
+    ret = WaitForStatus(DFU::uploadingStarting, ERASE_TIMEOUT_MS);
+    if (debug) {
+        qDebug() << "Erase returned: " << StatusToString(ret);
     }
-
-    // TODO: why is there a loop there? The "if" statement
-    // will cause a break or return anyway!!
-    for (int x = 0; x < 3; ++x) {
-        ret = StatusRequest();
-        if (debug) {
-            qDebug() << "Erase returned: " << StatusToString(ret);
-        }
-        if (ret == DFU::uploading) {
-            break;
-        } else {
-            return ret;
-        }
+    if (ret != DFU::uploading) {
+        return ret;
     }
 
     emit operationProgress("Uploading firmware");
@@ -847,13 +968,12 @@ DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify,
     }
 
     if (verify) {
+        // a CRC request instead of reading the whole image back
         emit operationProgress("Verifying firmware");
         cout << "Starting code verification\n";
-        QByteArray arr2;
-        StartDownloadT(&arr2, arr.length(), DFU::FW);
-        if (arr != arr2) {
+        if (!VerifyFirmwareCRC(crc, device)) {
             cout << "Verify:FAILED\n";
-            return DFU::abort;
+            return DFU::CRC_Fail;
         }
     }
 
@@ -867,27 +987,20 @@ DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify,
 DFU::Status DFUObject::CompareFirmware(const QString &sfile, const CompareType &type, int device)
 {
     cout << "Starting Firmware Compare...\n";
-    QFile file(sfile);
-    if (!file.open(QIODevice::ReadOnly)) {
+    FirmwareImage image = FirmwareImage::load(sfile);
+    if (!image.isValid()) {
         if (debug) {
             qDebug() << "Cant open file";
         }
         return DFU::abort;
     }
-    QByteArray arr = file.readAll();
+    const QByteArray &arr = image.data();
 
     if (debug) {
         qDebug() << "Bytes Loaded=" << arr.length();
     }
-    if (arr.length() % 4 != 0) {
-        int pad = arr.length() / 4;
-        ++pad;
-        pad = pad * 4;
-        pad = pad - arr.length();
-        arr.append(QByteArray(pad, (char)255));
-    }
     if (type == DFU::crccompare) {
-        quint32 crc = DFUObject::CRCFromQBArray(arr, devices[device].SizeOfCode);
+        quint32 crc = image.crc(devices[device].SizeOfCode);
         if (crc == devices[device].FW_CRC) {
             cout << "Compare Successfull CRC MATCH!\n";
         } else {
@@ -906,7 +1019,7 @@ DFU::Status DFUObject::CompareFirmware(const QString &sfile, const CompareType &
     }
 }
 
-void DFUObject::CopyWords(char *source, char *destination, int count)
+void DFUObject::CopyWords(const char *source, char *destination, int count)
 {
     for (int x = 0; x < count; x = x + 4) {
         *(destination + x)     = source[x + 3];
@@ -998,59 +1111,35 @@ void DFUObject::printProgBar(int const & percent, QString const & label)
  */
 quint32 DFUObject::CRC32WideFast(quint32 Crc, quint32 Size, quint32 *Buffer)
 {
-    // Size = Size >> 2; // /4  Size passed in as a byte count, assumed to be a multiple of 4
-
-    while (Size--) {
-        // Nibble lookup table for 0x04C11DB7 polynomial
-        static const quint32 CrcTable[16] = {
-            0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
-            0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
-        };
-
-        Crc     = Crc ^ *((quint32 *)Buffer); // Apply all 32-bits
-
-        Buffer += 1;
-
-        // Process 32-bits, 4 at a time, or 8 rounds
-
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28]; // Assumes 32-bit reg, masking index to 4-bits
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28]; // 0x04C11DB7 Polynomial used in STM32
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-    }
-
-    return Crc;
+    // Size is a number of words, 0x04C11DB7 Polynomial used in STM32
+    return Utils::Crc::updateCRC32(Crc, Buffer, Size);
 }
 
 /**
    Utility function
  */
-quint32 DFUObject::CRCFromQBArray(QByteArray array, quint32 Size)
+quint32 DFUObject::CRCFromQBArray(const QByteArray &array, quint32 Size)
 {
-    quint32 pad   = Size - array.length();
-
-    array.append(QByteArray(pad, (char)255));
-    int num_words = Size / 4;
-    quint32 *t    = (quint32 *)malloc(Size);
-    for (int x = 0; x < num_words; x++) {
+    // the array is read in place, the code area past its end is erased flash (0xFF)
+    const quint8 *bytes  = (const quint8 *)array.constData();
+    const quint32 length = array.length();
+    quint32 words[256];
+    quint32 count = 0;
+    quint32 crc   = 0xFFFFFFFF;
+
+    for (quint32 x = 0; x < Size / 4; x++) {
         quint32 aux = 0;
-        aux  = (char)array[x * 4 + 3] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 2] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 1] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 0] & 0xFF;
-        t[x] = aux;
-    }
-    quint32 ret = DFUObject::CRC32WideFast(0xFFFFFFFF, num_words, t);
-    free(t);
-
-    return ret;
+        for (int b = 3; b >= 0; b--) {
+            quint32 pos = x * 4 + b;
+            aux = aux << 8 | (pos < length ? bytes[pos] : 0xFF);
+        }
+        words[count++] = aux;
+        if (count == sizeof(words) / sizeof(words[0])) {
+            crc   = DFUObject::CRC32WideFast(crc, count, words);
+            count = 0;
+        }
+    }
+    return DFUObject::CRC32WideFast(crc, count, words);
 }
 
 /**
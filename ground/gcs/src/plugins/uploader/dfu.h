@@ -38,6 +38,7 @@
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
 
 #define BUF_LEN             64
+#define ERASE_TIMEOUT_MS    30000
 
 // serial
 class qsspt;
@@ -130,9 +131,11 @@ class DFUObject : public QThread {
     Q_OBJECT;
 
 public:
-    static quint32 CRCFromQBArray(QByteArray array, quint32 Size);
+    static quint32 CRCFromQBArray(const QByteArray &array, quint32 Size);
 
     DFUObject(bool debug, bool use_serial, QString port);
+    // USB only, opens the board in bootloader at hidPath (see opHID_hidapi::devicePaths)
+    DFUObject(bool debug, const QString &hidPath);
 
     virtual ~DFUObject();
 
@@ -142,6 +145,8 @@ public:
     int JumpToApp(bool safeboot, bool erase);
     int ResetDevice(void);
     DFU::Status StatusRequest();
+    // Polls the status for as long as the bootloader reports transient, up to timeoutMs
+    DFU::Status WaitForStatus(DFU::Status transient, int timeoutMs);
     bool EndOperation();
     int AbortOperation(void);
     bool ready()
@@ -151,7 +156,10 @@ public:
 
     // Upload (send to device) commands
     DFU::Status UploadDescription(QVariant description);
-    bool UploadFirmware(const QString &sfile, const bool &verify, int device);
+    // skipUnchanged leaves the flash alone when it already holds the same image (same CRC)
+    bool UploadFirmware(const QString &sfile, const bool &verify, int device, const bool &skipUnchanged = false);
+    // Same as UploadFirmware, then uploads the description packaged in the .opfw file
+    bool UploadFirmwareAndDescription(const QString &sfile, int device, const bool &skipUnchanged);
 
     // Download (get from device) commands:
     // DownloadDescription is synchronous
@@ -207,15 +215,16 @@ private:
         return command | 0x20;
     }
 
-    void CopyWords(char *source, char *destination, int count);
+    void CopyWords(const char *source, char *destination, int count);
     void printProgBar(int const & percent, QString const & label);
     bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc);
-    bool UploadData(qint32 const & numberOfPackets, QByteArray & data);
+    bool UploadData(qint32 const & numberOfPackets, const QByteArray & data);
 
     // Thread management:
     // Same as startDownload except that we store in an external array:
     bool StartDownloadT(QByteArray *fw, qint32 const & numberOfBytes, TransferTypes const & type);
-    DFU::Status UploadFirmwareT(const QString &sfile, const bool &verify, int device);
+    DFU::Status UploadFirmwareT(const QString &sfile, const bool &verify, int device, const bool &skipUnchanged);
+    bool VerifyFirmwareCRC(quint32 crc, int device);
     QMutex mutex;
     DFU::Commands requestedOperation;
     qint32 requestSize;
@@ -223,6 +232,8 @@ private:
     QByteArray *requestStorage;
     QString requestFilename;
     bool requestVerify;
+    bool requestSkipUnchanged;
+    bool requestDescription;
     int requestDevice;
 
 protected:
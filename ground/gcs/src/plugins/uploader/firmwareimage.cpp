@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ *
+ * @file       firmwareimage.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief      Cached firmware images for the uploader
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "firmwareimage.h"
+
+#include "dfu.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+
+using namespace DFU;
+
+#define DESCRIPTION_SIZE 100
+
+struct FirmwareImage::Data {
+    QDateTime  modified;
+    qint64     size;
+    QByteArray contents;
+    QByteArray data;
+    QByteArray description;
+    bool       intact;
+    int        boardId;
+
+    // CRC per code area size, boards of one type share it
+    QMutex crcLock;
+    QHash<quint32, quint32> crcs;
+};
+
+namespace {
+QMutex cacheLock;
+QHash<QString, FirmwareImage> cache;
+}
+
+FirmwareImage::FirmwareImage()
+{}
+
+/**
+   Returns the image for filename, reading it only if it is not cached
+   or changed on disk since. Returns an invalid image if it can't be read.
+ */
+FirmwareImage FirmwareImage::load(const QString &filename)
+{
+    QFileInfo info(filename);
+    QMutexLocker lock(&cacheLock);
+
+    QHash<QString, FirmwareImage>::const_iterator it = cache.constFind(filename);
+
+    if (it != cache.constEnd() && it->d->modified == info.lastModified() && it->d->size == info.size()) {
+        return it.value();
+    }
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return FirmwareImage();
+    }
+
+    FirmwareImage image;
+    image.d = QSharedPointer<Data>(new Data);
+    image.d->modified = info.lastModified();
+    image.d->size     = info.size();
+    image.d->contents = file.readAll();
+    image.d->data     = image.d->contents;
+    if (image.d->data.length() % 4 != 0) {
+        image.d->data.append(QByteArray(4 - image.d->data.length() % 4, (char)255));
+    }
+    image.d->intact  = false;
+    image.d->boardId = 0;
+
+    QByteArray desc = image.d->contents.right(DESCRIPTION_SIZE);
+    if (image.d->contents.length() > DESCRIPTION_SIZE && desc.startsWith("OpFw")) {
+        image.d->description = desc;
+        image.d->boardId     = ((quint16)(quint8)desc.at(12) << 8) + (quint16)(quint8)desc.at(13);
+        QByteArray fileHash = QCryptographicHash::hash(image.d->contents.left(image.d->contents.length() - DESCRIPTION_SIZE),
+                                                       QCryptographicHash::Sha1);
+        image.d->intact = (desc.mid(40, 20) == fileHash);
+    }
+
+    cache.insert(filename, image);
+    return image;
+}
+
+bool FirmwareImage::isValid() const
+{
+    return !d.isNull();
+}
+
+const QByteArray &FirmwareImage::contents() const
+{
+    static const QByteArray empty;
+
+    return d ? d->contents : empty;
+}
+
+const QByteArray &FirmwareImage::data() const
+{
+    static const QByteArray empty;
+
+    return d ? d->data : empty;
+}
+
+const QByteArray &FirmwareImage::description() const
+{
+    static const QByteArray empty;
+
+    return d ? d->description : empty;
+}
+
+bool FirmwareImage::isIntact() const
+{
+    return d && d->intact;
+}
+
+int FirmwareImage::boardId() const
+{
+    return d ? d->boardId : 0;
+}
+
+quint32 FirmwareImage::crc(quint32 sizeOfCode) const
+{
+    if (!d) {
+        return 0;
+    }
+    QMutexLocker lock(&d->crcLock);
+    QHash<quint32, quint32>::const_iterator it = d->crcs.constFind(sizeOfCode);
+    if (it != d->crcs.constEnd()) {
+        return it.value();
+    }
+    quint32 crc = DFUObject::CRCFromQBArray(d->data, sizeOfCode);
+    d->crcs.insert(sizeOfCode, crc);
+    return crc;
+}
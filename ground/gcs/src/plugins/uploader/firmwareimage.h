@@ -0,0 +1,66 @@
+/**
+ ******************************************************************************
+ *
+ * @file       firmwareimage.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Uploader Uploader Plugin
+ * @{
+ * @brief      Cached firmware images for the uploader
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef FIRMWAREIMAGE_H
+#define FIRMWAREIMAGE_H
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+
+namespace DFU {
+/**
+ * A firmware file together with what the uploader derives from it.
+ * Images are cached by file name, modification time and size and share
+ * their data, so repeated and parallel flashes read and check a file once.
+ */
+class FirmwareImage {
+public:
+    FirmwareImage();
+
+    static FirmwareImage load(const QString &filename);
+
+    bool isValid() const;
+    // file contents as read
+    const QByteArray &contents() const;
+    // contents padded to whole words with erased flash (0xFF)
+    const QByteArray &data() const;
+    // the description block of packaged (.opfw) images, empty otherwise
+    const QByteArray &description() const;
+    // packaged image whose code matches the hash in its description
+    bool isIntact() const;
+    // board the packaged image was built for, 0 if not packaged
+    int boardId() const;
+    // CRC the bootloader reports for this image in a code area of sizeOfCode bytes
+    quint32 crc(quint32 sizeOfCode) const;
+
+private:
+    struct Data;
+    QSharedPointer<Data> d;
+};
+}
+
+#endif // FIRMWAREIMAGE_H
@@ -24,6 +24,7 @@ HEADERS += \
     uploadergadgetwidget.h \
     uploaderplugin.h \
     dfu.h \
+    firmwareimage.h \
     devicewidget.h \
     SSP/port.h \
     SSP/qssp.h \
@@ -32,7 +33,8 @@ HEADERS += \
     runningdevicewidget.h \
     uploader_global.h \
     enums.h \
-    rebootdialog.h
+    rebootdialog.h \
+    batchflasher.h
 
 SOURCES += \
     uploadergadget.cpp \
@@ -42,12 +44,14 @@ SOURCES += \
     uploadergadgetwidget.cpp \
     uploaderplugin.cpp \
     dfu.cpp \
+    firmwareimage.cpp \
     devicewidget.cpp \
     SSP/port.cpp \
     SSP/qssp.cpp \
     SSP/qsspt.cpp \
     runningdevicewidget.cpp \
-    rebootdialog.cpp
+    rebootdialog.cpp \
+    batchflasher.cpp
 
 OTHER_FILES += Uploader.pluginspec
 
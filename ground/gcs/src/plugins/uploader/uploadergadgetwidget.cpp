@@ -34,6 +34,7 @@
 #include "flightstatus.h"
 #include "devicewidget.h"
 #include "runningdevicewidget.h"
+#include "firmwareimage.h"
 
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
@@ -42,6 +43,7 @@
 #include <uavtalk/telemetrymanager.h>
 #include <uavtalk/oplinkmanager.h>
 #include "rebootdialog.h"
+#include "batchflasher.h"
 
 #include <QDesktopServices>
 #include <QMessageBox>
@@ -148,6 +150,9 @@ UploaderGadgetWidget::UploaderGadgetWidget(QWidget *parent) : QWidget(parent)
     m_resetOnly = false;
     m_dfu = NULL;
     m_autoUpdateClosing = false;
+    m_batchFlasher = new BatchFlasher(this);
+    connect(m_batchFlasher, SIGNAL(boardFinished(int, bool, QString)), this, SLOT(batchFlashBoardFinished(int, bool, QString)));
+    connect(m_batchFlasher, SIGNAL(finished(int, int)), this, SLOT(batchFlashFinished(int, int)));
 
     // Listen to autopilot connection events
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -164,6 +169,7 @@ UploaderGadgetWidget::UploaderGadgetWidget(QWidget *parent) : QWidget(parent)
     connect(m_config->safeBootButton, SIGNAL(clicked()), this, SLOT(systemSafeBoot()));
     connect(m_config->eraseBootButton, SIGNAL(clicked()), this, SLOT(systemEraseBoot()));
     connect(m_config->rescueButton, SIGNAL(clicked()), this, SLOT(systemRescue()));
+    connect(m_config->batchFlashButton, SIGNAL(clicked()), this, SLOT(systemBatchFlash()));
 
     getSerialPorts();
 
@@ -172,6 +178,7 @@ UploaderGadgetWidget::UploaderGadgetWidget(QWidget *parent) : QWidget(parent)
     connect(m_config->autoUpdateOkButton, SIGNAL(clicked()), this, SLOT(closeAutoUpdate()));
     m_config->autoUpdateButton->setEnabled(autoUpdateCapable());
     m_config->autoUpdateEraseButton->setEnabled(autoUpdateCapable());
+    m_config->batchFlashButton->setEnabled(autoUpdateCapable());
     m_config->autoUpdateGroupBox->setVisible(false);
 
     m_config->refreshPorts->setIcon(QIcon(":uploader/images/view-refresh.svg"));
@@ -677,6 +684,60 @@ bool UploaderGadgetWidget::autoUpdateCapable()
     return QDir(":/firmware").exists();
 }
 
+/**
+   Returns the firmware bundled for a board id, empty when there is none
+ */
+QString UploaderGadgetWidget::firmwareForBoard(int boardId)
+{
+    QString filename;
+
+    switch (boardId) {
+    case 0x0301:
+        filename = "fw_oplinkmini";
+        break;
+    case 0x0401:
+    case 0x0402:
+        filename = "fw_coptercontrol";
+        break;
+    case 0x0501:
+        filename = "fw_osd";
+        break;
+    case 0x0902:
+        filename = "fw_revoproto";
+        break;
+    case 0x0903:
+        filename = "fw_revolution";
+        break;
+    case 0x0904:
+        filename = "fw_discoveryf4bare";
+        break;
+    case 0x0905:
+        filename = "fw_revonano";
+        break;
+    case 0x9201:
+        filename = "fw_sparky2";
+        break;
+    case 0x1001:
+        filename = "fw_spracingf3";
+        break;
+    case 0x1002:
+        filename = "fw_spracingf3evo";
+        break;
+    case 0x1003:
+        filename = "fw_nucleof303re";
+        break;
+    case 0x1005:
+        filename = "fw_pikoblx";
+        break;
+    case 0x1006:
+        filename = "fw_tinyfish";
+        break;
+    default:
+        return QString();
+    }
+    return ":/firmware/" + filename + ".opfw";
+}
+
 bool UploaderGadgetWidget::autoUpdate(bool erase)
 {
     ExtensionSystem::PluginManager *pluginManager = ExtensionSystem::PluginManager::instance();
@@ -759,66 +820,24 @@ bool UploaderGadgetWidget::autoUpdate(bool erase)
 
     QString filename;
     emit progressUpdate(LOADING_FW, QVariant());
-    switch (m_dfu->devices[0].ID) {
-    case 0x0301:
-        filename = "fw_oplinkmini";
-        break;
-    case 0x0401:
-    case 0x0402:
-        filename = "fw_coptercontrol";
-        break;
-    case 0x0501:
-        filename = "fw_osd";
-        break;
-    case 0x0902:
-        filename = "fw_revoproto";
-        break;
-    case 0x0903:
-        filename = "fw_revolution";
-        break;
-    case 0x0904:
-        filename = "fw_discoveryf4bare";
-        break;
-    case 0x0905:
-        filename = "fw_revonano";
-        break;
-    case 0x9201:
-        filename = "fw_sparky2";
-        break;
-    case 0x1001:
-        filename = "fw_spracingf3";
-        break;
-    case 0x1002:
-        filename = "fw_spracingf3evo";
-        break;
-    case 0x1003:
-        filename = "fw_nucleof303re";
-        break;
-    case 0x1005:
-        filename = "fw_pikoblx";
-        break;
-    case 0x1006:
-        filename = "fw_tinyfish";
-        break;
-    default:
+    filename = firmwareForBoard(m_dfu->devices[0].ID);
+    if (filename.isEmpty()) {
         emit progressUpdate(FAILURE, QVariant(tr("Unknown board id '0x%1'").arg(QString::number(m_dfu->devices[0].ID, 16))));
         emit autoUpdateFailed();
         return false;
     }
-    filename = ":/firmware/" + filename + ".opfw";
-    QByteArray firmware;
     if (!QFile::exists(filename)) {
         emit progressUpdate(FAILURE, QVariant(tr("Firmware image not found.")));
         emit autoUpdateFailed();
         return false;
     }
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
+    // cached, the upload below reuses it instead of reading the file again
+    DFU::FirmwareImage firmware = DFU::FirmwareImage::load(filename);
+    if (!firmware.isValid()) {
         emit progressUpdate(FAILURE, QVariant(tr("Could not open firmware image for reading.")));
         emit autoUpdateFailed();
         return false;
     }
-    firmware = file.readAll();
     QEventLoop eventLoop2;
     connect(m_dfu, SIGNAL(progressUpdated(int)), this, SLOT(autoUpdateFlashProgress(int)));
     connect(m_dfu, SIGNAL(uploadFinished(DFU::Status)), &eventLoop2, SLOT(quit()));
@@ -829,13 +848,14 @@ bool UploaderGadgetWidget::autoUpdate(bool erase)
         return false;
     }
     m_dfu->AbortOperation();
-    if (!m_dfu->UploadFirmware(filename, false, 0)) {
+    // boards already running this image are not flashed again
+    if (!m_dfu->UploadFirmware(filename, false, 0, true)) {
         emit progressUpdate(FAILURE, QVariant(tr("Firmware upload failed.")));
         emit autoUpdateFailed();
         return false;
     }
     eventLoop2.exec();
-    QByteArray desc = firmware.right(100);
+    QByteArray desc = firmware.contents().right(100);
     emit progressUpdate(UPLOADING_DESC, QVariant());
     if (m_dfu->UploadDescription(desc) != DFU::Last_operation_Success) {
         emit progressUpdate(FAILURE, QVariant(tr("Failed to upload firmware description.")));
@@ -1166,6 +1186,68 @@ void UploaderGadgetWidget::clearLog()
 /**
  * Remove all the device widgets...
  */
+/**
+   Upgrades all the boards connected in bootloader mode at once
+ */
+void UploaderGadgetWidget::systemBatchFlash()
+{
+    if (m_batchFlasher->isRunning()) {
+        return;
+    }
+
+    Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
+
+    cm->disconnectDevice();
+    // stop the polling thread: otherwise it will mess up DFU
+    cm->suspendPolling();
+
+    while (m_config->systemElements->count()) {
+        QWidget *qw = m_config->systemElements->widget(0);
+        m_config->systemElements->removeTab(0);
+        delete qw;
+    }
+
+    // The boards are opened one by one, a shared handle would get in the way
+    if (m_dfu) {
+        delete m_dfu;
+        m_dfu = NULL;
+    }
+
+    m_config->batchFlashButton->setEnabled(false);
+    m_config->rescueButton->setEnabled(false);
+    m_config->autoUpdateButton->setEnabled(false);
+    m_config->autoUpdateEraseButton->setEnabled(false);
+
+    clearLog();
+    log("Upgrading all the boards in bootloader mode...");
+    int started = m_batchFlasher->start(true);
+    if (started) {
+        log(QString("Flashing %1 board(s).").arg(started));
+    }
+}
+
+void UploaderGadgetWidget::batchFlashBoardFinished(int board, bool success, QString message)
+{
+    log(QString("Board %1: %2 (%3)").arg(board + 1).arg(success ? "OK" : "FAILED").arg(message));
+}
+
+void UploaderGadgetWidget::batchFlashFinished(int succeeded, int failed)
+{
+    if (!succeeded && !failed) {
+        log("No board in bootloader mode was found.");
+    } else {
+        log(QString("Batch upgrade done: %1 succeeded, %2 failed.").arg(succeeded).arg(failed));
+    }
+
+    Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
+    cm->resumePolling();
+
+    m_config->batchFlashButton->setEnabled(autoUpdateCapable());
+    m_config->rescueButton->setEnabled(true);
+    m_config->autoUpdateButton->setEnabled(autoUpdateCapable());
+    m_config->autoUpdateEraseButton->setEnabled(autoUpdateCapable());
+}
+
 UploaderGadgetWidget::~UploaderGadgetWidget()
 {
     while (m_config->systemElements->count()) {
@@ -41,6 +41,7 @@ using namespace DFU;
 using namespace uploader;
 
 class Ui_UploaderWidget;
+class BatchFlasher;
 
 class FlightStatus;
 class UAVObject;
@@ -122,6 +123,7 @@ public:
 
     void log(QString str);
     bool autoUpdateCapable();
+    static QString firmwareForBoard(int boardId);
 
 public slots:
     void onAutopilotConnect();
@@ -144,6 +146,7 @@ signals:
 private:
     Ui_UploaderWidget *m_config;
     DFUObject *m_dfu;
+    BatchFlasher *m_batchFlasher;
     IAPStep m_currentIAPStep;
     bool m_resetOnly;
     bool m_autoUpdateClosing;
@@ -170,6 +173,9 @@ private slots:
     void systemReboot();
     void commonSystemBoot(bool safeboot = false, bool erase = false);
     void systemRescue();
+    void systemBatchFlash();
+    void batchFlashBoardFinished(int board, bool success, QString message);
+    void batchFlashFinished(int succeeded, int failed);
     void getSerialPorts();
     void uploadStarted();
     void uploadEnded(bool succeed);
@@ -34,6 +34,7 @@ VideoGadgetConfiguration::VideoGadgetConfiguration(QString classId, QSettings &s
     m_autoStart          = settings.value("autoStart").toBool();
     m_displayControls    = settings.value("displayControls").toBool();
     m_respectAspectRatio = settings.value("respectAspectRatio").toBool();
+    m_lowLatency         = settings.value("lowLatency").toBool();
     m_pipelineDesc       = settings.value("pipelineDesc").toString();
     m_pipelineInfo       = settings.value("pipelineInfo").toString();
 }
@@ -45,6 +46,7 @@ VideoGadgetConfiguration::VideoGadgetConfiguration(const VideoGadgetConfiguratio
     m_autoStart          = obj.m_autoStart;
     m_displayControls    = obj.m_displayControls;
     m_respectAspectRatio = obj.m_respectAspectRatio;
+    m_lowLatency         = obj.m_lowLatency;
     m_pipelineDesc       = obj.m_pipelineDesc;
     m_pipelineInfo       = obj.m_pipelineInfo;
 }
@@ -68,6 +70,7 @@ void VideoGadgetConfiguration::saveConfig(QSettings &settings) const
     settings.setValue("autoStart", m_autoStart);
     settings.setValue("displayControls", m_displayControls);
     settings.setValue("respectAspectRatio", m_respectAspectRatio);
+    settings.setValue("lowLatency", m_lowLatency);
     settings.setValue("pipelineDesc", m_pipelineDesc);
     settings.setValue("pipelineInfo", m_pipelineInfo);
 }
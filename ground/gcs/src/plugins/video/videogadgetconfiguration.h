@@ -73,6 +73,14 @@ public:
     {
         m_respectAspectRatio = respectAspectRatio;
     }
+    bool lowLatency() const
+    {
+        return m_lowLatency;
+    }
+    void setLowLatency(bool lowLatency)
+    {
+        m_lowLatency = lowLatency;
+    }
     QString pipelineDesc() const
     {
         return m_pipelineDesc;
@@ -97,6 +105,7 @@ private:
     // controls
     bool m_displayControls;
     bool m_autoStart;
+    bool m_lowLatency;
     QString m_pipelineDesc;
     QString m_pipelineInfo;
 };
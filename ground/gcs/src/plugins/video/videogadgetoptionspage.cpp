@@ -51,6 +51,7 @@ QWidget *VideoGadgetOptionsPage::createPage(QWidget *parent)
     m_page->displayControlsCheckBox->setChecked(m_config->displayControls());
     m_page->autoStartCheckBox->setChecked(m_config->autoStart());
     m_page->respectAspectRatioCheckBox->setChecked(m_config->respectAspectRatio());
+    m_page->lowLatencyCheckBox->setChecked(m_config->lowLatency());
     m_page->descPlainTextEdit->setPlainText(m_config->pipelineDesc());
     m_page->infoPlainTextEdit->setPlainText(m_config->pipelineInfo());
 
@@ -65,6 +66,7 @@ void VideoGadgetOptionsPage::apply()
     m_config->setDisplayControls(m_page->displayControlsCheckBox->isChecked());
     m_config->setAutoStart(m_page->autoStartCheckBox->isChecked());
     m_config->setRespectAspectRatio(m_page->respectAspectRatioCheckBox->isChecked());
+    m_config->setLowLatency(m_page->lowLatencyCheckBox->isChecked());
     m_config->setPipelineDesc(m_page->descPlainTextEdit->toPlainText());
     m_config->setPipelineInfo(m_page->infoPlainTextEdit->toPlainText());
 }
@@ -27,6 +27,7 @@
 #include "videogadgetconfiguration.h"
 #include "videogadgetwidget.h"
 #include "pipeline.h"
+#include "gst_util.h"
 
 #include <QtCore>
 #include <QDebug>
@@ -36,7 +37,7 @@
 #include <QWidget>
 
 VideoGadgetWidget::VideoGadgetWidget(QWidget *parent) :
-    QFrame(parent)
+    QFrame(parent), m_latencyAverage(-1), m_latencyMax(-1)
 {
     m_ui = new Ui_Form();
     m_ui->setupUi(this);
@@ -45,6 +46,9 @@ VideoGadgetWidget::VideoGadgetWidget(QWidget *parent) :
 
     connect(videoWidget(), &VideoWidget::stateChanged, this, &VideoGadgetWidget::onStateChanged);
     connect(videoWidget(), &VideoWidget::message, this, &VideoGadgetWidget::msg);
+    connect(videoWidget(), &VideoWidget::decoderChanged, this, &VideoGadgetWidget::onDecoderChanged);
+    connect(videoWidget(), &VideoWidget::frameStatsChanged, this, &VideoGadgetWidget::onFrameStatsChanged);
+    connect(videoWidget(), &VideoWidget::latencyChanged, this, &VideoGadgetWidget::onLatencyChanged);
 
     connect(m_ui->startButton, &QPushButton::clicked, this, &VideoGadgetWidget::start);
     connect(m_ui->pauseButton, &QPushButton::clicked, this, &VideoGadgetWidget::pause);
@@ -65,6 +69,14 @@ void VideoGadgetWidget::setConfiguration(VideoGadgetConfiguration *config)
     videoWidget()->setVisible(config->displayVideo());
     // m_ui->control->setEnabled(config->displayControls());
     bool restart = false;
+    if (videoWidget()->lowLatency() != config->lowLatency()) {
+        // the pipeline is tuned when it is created
+        if (videoWidget()->isPlaying()) {
+            restart = true;
+            stop();
+        }
+        videoWidget()->setLowLatency(config->lowLatency());
+    }
     if (videoWidget()->pipelineDesc() != config->pipelineDesc()) {
         if (videoWidget()->isPlaying()) {
             restart = true;
@@ -82,6 +94,8 @@ void VideoGadgetWidget::start()
 {
     msg(QString("starting..."));
     m_ui->startButton->setEnabled(false);
+    m_latencyAverage = -1;
+    m_latencyMax     = -1;
     videoWidget()->start();
 }
 
@@ -157,6 +171,50 @@ void VideoGadgetWidget::onStateChanged(Pipeline::State oldState, Pipeline::State
     m_ui->stopButton->setEnabled(stopEnabled);
 }
 
+void VideoGadgetWidget::onDecoderChanged(QString decoder, bool hardware)
+{
+    Q_UNUSED(decoder);
+    Q_UNUSED(hardware);
+    updateStats();
+}
+
+void VideoGadgetWidget::onFrameStatsChanged(quint64 processed, quint64 dropped)
+{
+    Q_UNUSED(processed);
+    Q_UNUSED(dropped);
+    updateStats();
+}
+
+void VideoGadgetWidget::onLatencyChanged(double averageMs, double maxMs)
+{
+    m_latencyAverage = averageMs;
+    m_latencyMax     = maxMs;
+    updateStats();
+}
+
+void VideoGadgetWidget::updateStats()
+{
+    QString decoder = videoWidget()->decoderName();
+    QString text;
+
+    if (!decoder.isEmpty()) {
+        text = QString("%0 (%1)").arg(decoder).arg(gst::isHardwareDecoder(decoder) ? tr("HW") : tr("SW"));
+    }
+    if (videoWidget()->processedFrames() > 0 || videoWidget()->droppedFrames() > 0) {
+        if (!text.isEmpty()) {
+            text += " - ";
+        }
+        text += tr("dropped %0 / %1").arg(videoWidget()->droppedFrames()).arg(videoWidget()->processedFrames());
+    }
+    if (m_latencyAverage >= 0) {
+        if (!text.isEmpty()) {
+            text += " - ";
+        }
+        text += tr("latency %0 ms (max %1 ms)").arg(m_latencyAverage, 0, 'f', 0).arg(m_latencyMax, 0, 'f', 0);
+    }
+    m_ui->statsLabel->setText(text);
+}
+
 void VideoGadgetWidget::msg(const QString &str)
 {
     if (m_ui) {
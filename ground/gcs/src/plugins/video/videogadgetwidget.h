@@ -55,12 +55,19 @@ private slots:
     void console();
 
     void onStateChanged(Pipeline::State oldState, Pipeline::State newState, Pipeline::State pendingState);
+    void onDecoderChanged(QString decoder, bool hardware);
+    void onFrameStatsChanged(quint64 processed, quint64 dropped);
+    void onLatencyChanged(double averageMs, double maxMs);
 
 private:
     Ui_Form *m_ui;
     VideoGadgetConfiguration *config;
+    // frame latency over the last second, negative until measured
+    double m_latencyAverage;
+    double m_latencyMax;
 
     void msg(const QString &str);
+    void updateStats();
 
     VideoWidget *videoWidget();
 };
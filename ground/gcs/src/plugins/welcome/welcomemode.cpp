@@ -34,6 +34,7 @@
 #include <coreplugin/coreconstants.h>
 #include <coreplugin/uniqueidmanager.h>
 #include <coreplugin/modemanager.h>
+#include <coreplugin/framescheduler.h>
 
 #include <utils/styledbar.h>
 #include <utils/welcomemodetreewidget.h>
@@ -104,7 +105,8 @@ QWidget *WelcomeMode::widget()
     if (!m_quickWidgetProxy) {
         m_quickWidgetProxy = new QuickWidgetProxy();
         // qWidget->setResizeMode(QQuickWidget::SizeRootObjectToView);
-        m_quickWidgetProxy->engine()->rootContext()->setContextProperty("welcomePlugin", this);
+        m_quickWidgetProxy->rootContext()->setContextProperty("welcomePlugin", this);
+        Core::FrameScheduler::instance()->addWindow(m_quickWidgetProxy->quickWindow());
         m_quickWidgetProxy->setSource(QUrl("qrc:/welcome/qml/main.qml"));
     }
     return m_quickWidgetProxy->widget();
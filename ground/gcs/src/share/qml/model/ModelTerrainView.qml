@@ -97,6 +97,8 @@ Item {
             // use ShaderGen pseudoloader to generate the shaders expected by osgEarth
             // see http://docs.osgearth.org/en/latest/faq.html#i-added-a-node-but-it-has-no-texture-lighting-etc-in-osgearth-why
             source: pfdContext.modelFile + ".osgearth_shadergen"
+            // don't block the gui while browsing the models
+            async: true
 
             optimizeMode: OptimizeMode.OptimizeAndCheck
         }
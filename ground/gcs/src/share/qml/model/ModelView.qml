@@ -69,7 +69,8 @@ Item {
         OSGFileNode {
             id: fileNode
             source: pfdContext.modelFile
-            async: false
+            // don't block the gui while browsing the models
+            async: true
             optimizeMode: OptimizeMode.OptimizeAndCheck
         }
 
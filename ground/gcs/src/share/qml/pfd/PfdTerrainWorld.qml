@@ -45,6 +45,11 @@ OSGViewport {
     manipulator: geoTransformManipulator
     //incrementalCompile: true
 
+    // redrawn when the uav, camera or sky change and while tiles are loading
+    updateMode: UpdateMode.OnDemand
+    lodScale: pfdContext.terrainLodScale
+    maximumPagedLODs: pfdContext.terrainCacheSize
+
     OSGCamera {
         id: camera
 
@@ -73,7 +78,8 @@ OSGViewport {
     OSGFileNode {
         id: terrainFileNode
         source: pfdContext.terrainFile
-        async: false
+        // don't block the gui while the terrain file is loading
+        async: true
     }
 
     Rectangle {
@@ -21,6 +21,8 @@ import QtQuick 2.4
 
 Image {
     id: sceneItem
+    // svg rendering happens off the GUI thread, cached sizes are served right away
+    asynchronous: true
     property variant sceneSize
     property string elementName
     property string svgFileName: "pfd/pfd.svg"
@@ -55,7 +57,8 @@ Image {
         if (params != "")
             params = "?" + params
 
-        source = "image://svg/"+svgFileName+"!"+elementName+params
+        // the image provider is shared by all the gadgets, pass it the resolved file
+        source = "image://svg/"+svgRenderer.filePath(svgFileName)+"!"+elementName+params
         scaledBounds = svgRenderer.scaledElementBounds(svgFileName, elementName)
     }
 }
@@ -5,4 +5,5 @@ SUBDIRS = \
     libs \
     app \
     plugins \
+    tools \
     share
@@ -0,0 +1,23 @@
+#
+# Benchmark of the crc implementations of the utils library.
+#
+
+include(../../../gcs.pri)
+
+TEMPLATE = app
+TARGET = crcbenchmark
+DESTDIR = $$GCS_APP_PATH
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../libs/utils/utils.pri)
+
+SOURCES += main.cpp
+
+!win32:!macx {
+    QMAKE_RPATHDIR  = $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_LIBRARY_PATH, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH))
+    include(../../rpath.pri)
+}
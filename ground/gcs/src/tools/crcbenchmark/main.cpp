@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Benchmark of the UAVTalk and bootloader crc implementations
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <utils/crc.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Utils;
+
+namespace {
+// Reference of the bootloader crc32, the nibble table implementation it replaces
+quint32 crc32Nibbles(quint32 crc, const quint32 *data, quint32 words)
+{
+    static const quint32 table[16] = {
+        0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+        0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+    };
+
+    while (words--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc << 4) ^ table[crc >> 28];
+        }
+    }
+    return crc;
+}
+
+// Mega bytes per second
+double rate(qint64 bytes, qint64 nsecs)
+{
+    return nsecs > 0 ? bytes * 1000.0 / nsecs : 0;
+}
+}
+
+int main(int argc, char * *argv)
+{
+    QCoreApplication app(argc, argv);
+
+    // packet sizes seen by UAVTalk, and a firmware image
+    const int sizes[] = { 16, 64, 256, 1024, 256 * 1024 };
+    const qint64 total = 256 * 1024 * 1024;
+
+    QVector<quint8> buffer(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+    for (int i = 0; i < buffer.size(); i++) {
+        buffer[i] = rand();
+    }
+
+    printf("%10s %12s %12s %12s %12s\n", "size", "crc8 MB/s", "sliced MB/s", "crc32 MB/s", "sliced MB/s");
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int size   = sizes[s];
+        int rounds = total / size;
+        const quint32 *words = reinterpret_cast<const quint32 *>(buffer.constData());
+        QElapsedTimer timer;
+        quint8 crc8a = 0, crc8b = 0;
+        quint32 crc32a = 0xFFFFFFFF, crc32b = 0xFFFFFFFF;
+
+        timer.start();
+        for (int i = 0; i < rounds; i++) {
+            crc8a = Crc::updateCRCBytewise(crc8a, buffer.constData(), size);
+        }
+        qint64 bytewise = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < rounds; i++) {
+            crc8b = Crc::updateCRC(crc8b, buffer.constData(), size);
+        }
+        qint64 sliced8 = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < rounds; i++) {
+            crc32a = crc32Nibbles(crc32a, words, size / 4);
+        }
+        qint64 nibbles = timer.nsecsElapsed();
+
+        timer.restart();
+        for (int i = 0; i < rounds; i++) {
+            crc32b = Crc::updateCRC32(crc32b, words, size / 4);
+        }
+        qint64 sliced32 = timer.nsecsElapsed();
+
+        if (crc8a != crc8b || crc32a != crc32b) {
+            fprintf(stderr, "crc mismatch for %d bytes\n", size);
+            return 1;
+        }
+        printf("%10d %12.1f %12.1f %12.1f %12.1f\n", size,
+               rate(total, bytewise), rate(total, sliced8), rate(total, nibbles), rate(total, sliced32));
+    }
+    return 0;
+}
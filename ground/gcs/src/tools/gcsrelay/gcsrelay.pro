@@ -0,0 +1,35 @@
+#
+# Headless telemetry relay: vehicle link, .opl logging and the telemetry server, no GUI.
+#
+
+include(../../../gcs.pri)
+
+TEMPLATE = app
+TARGET = gcsrelay
+DESTDIR = $$GCS_APP_PATH
+
+QT -= gui
+QT += network serialport
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$GCS_SOURCE_TREE/src/plugins
+LIBS += -L$$GCS_PLUGIN_PATH/$$ORG_BIG_NAME
+
+include(../../plugins/uavtalk/uavtalk.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+
+HEADERS += relay.h
+
+SOURCES += \
+    main.cpp \
+    relay.cpp
+
+!win32:!macx {
+    target.path = /bin
+    INSTALLS += target
+    QMAKE_RPATHDIR  = $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_LIBRARY_PATH, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_PLUGIN_PATH/$$ORG_BIG_NAME, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH))
+    include(../../rpath.pri)
+}
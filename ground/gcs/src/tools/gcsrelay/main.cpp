@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Headless telemetry relay of a vehicle link, no GUI
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "relay.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+// SIGINT and SIGTERM quit the event loop through this pair, so that the log is complete
+int signalFds[2];
+
+void signalHandler(int)
+{
+    char c = 1;
+
+    if (write(signalFds[0], &c, sizeof(c)) < 0) {
+        _exit(1);
+    }
+}
+
+void installSignalHandlers(QCoreApplication *app)
+{
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, signalFds) != 0) {
+        return;
+    }
+    QSocketNotifier *notifier = new QSocketNotifier(signalFds[1], QSocketNotifier::Read, app);
+    QObject::connect(notifier, SIGNAL(activated(int)), app, SLOT(quit()));
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = signalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags   = SA_RESTART;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+}
+#endif // Q_OS_UNIX
+
+int main(int argc, char * *argv)
+{
+    QElapsedTimer startup;
+
+    startup.start();
+
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("gcsrelay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs the telemetry of a vehicle link without the GCS user interface.\n"
+                                     "The object packets received are sent to the clients of the telemetry server\n"
+                                     "(other GCS instances or tools) and can be written to a .opl log.");
+    parser.addHelpOption();
+    QCommandLineOption serialOption(QStringList() << "s" << "serial",
+                                    "Serial port of the vehicle link.", "port");
+    parser.addOption(serialOption);
+    QCommandLineOption baudOption(QStringList() << "b" << "baud",
+                                  "Baud rate of the serial port (default: 57600).", "rate", "57600");
+    parser.addOption(baudOption);
+    QCommandLineOption tcpOption(QStringList() << "t" << "tcp",
+                                 "TCP vehicle link, instead of a serial port.", "host:port");
+    parser.addOption(tcpOption);
+    QCommandLineOption serverOption(QStringList() << "p" << "server-port",
+                                    "Port of the telemetry server (default: 9001), 0 for no server.", "port", "9001");
+    parser.addOption(serverOption);
+    QCommandLineOption logOption(QStringList() << "l" << "log",
+                                 "Write the object packets received to a .opl log.", "file");
+    parser.addOption(logOption);
+    parser.process(app);
+
+    Relay relay;
+
+    if (parser.isSet(tcpOption)) {
+        QString link = parser.value(tcpOption);
+        int colon    = link.lastIndexOf(':');
+        quint16 port = colon > 0 ? link.mid(colon + 1).toUShort() : 0;
+        if (!port) {
+            fprintf(stderr, "Invalid TCP link: %s\n", qPrintable(link));
+            return 1;
+        }
+        relay.setTcpLink(link.left(colon), port);
+    } else if (parser.isSet(serialOption)) {
+        int baudRate = parser.value(baudOption).toInt();
+        if (baudRate <= 0) {
+            fprintf(stderr, "Invalid baud rate: %s\n", qPrintable(parser.value(baudOption)));
+            return 1;
+        }
+        relay.setSerialLink(parser.value(serialOption), baudRate);
+    } else {
+        parser.showHelp(1);
+    }
+
+    quint16 serverPort = parser.value(serverOption).toUShort();
+    if (serverPort && !relay.startServer(serverPort)) {
+        return 1;
+    }
+    if (parser.isSet(logOption) && !relay.startLogging(parser.value(logOption))) {
+        fprintf(stderr, "Failed to open the log %s\n", qPrintable(parser.value(logOption)));
+        return 1;
+    }
+
+#ifdef Q_OS_UNIX
+    installSignalHandlers(&app);
+#endif
+    relay.start();
+    qDebug() << "Relay - started in" << startup.elapsed() << "ms";
+
+    return app.exec();
+}
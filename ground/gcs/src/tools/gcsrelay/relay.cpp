@@ -0,0 +1,241 @@
+/**
+ ******************************************************************************
+ *
+ * @file       relay.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Headless relay of a vehicle link to the telemetry server and a log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "relay.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavtalk/telemetrymanager.h"
+#include "uavtalk/telemetryserver.h"
+#include "uavtalk/latencyhistogram.h"
+#include "utils/logfile.h"
+
+#include <QDebug>
+#include <QEventLoop>
+#include <QMutexLocker>
+#include <QtNetwork/QTcpSocket>
+#include <QtSerialPort/QSerialPort>
+
+#include <string.h>
+
+Relay::Relay(QObject *parent) : QObject(parent), m_server(NULL), m_baudRate(57600), m_tcpPort(0),
+    m_device(NULL), m_linkStarted(false), m_logFile(NULL), m_logStart(0), m_flushQueued(false)
+{
+    m_objectManager = new UAVObjectManager();
+    UAVObjectsInitialize(m_objectManager);
+
+    // same priority as the real time thread of the GCS
+    m_telemetryThread.setObjectName("Telemetry");
+    m_telemetryThread.start(QThread::TimeCriticalPriority);
+
+    m_telemetryManager = new TelemetryManager(m_objectManager, &m_telemetryThread);
+    connect(m_telemetryManager, SIGNAL(connected()), this, SLOT(telemetryConnected()));
+    connect(m_telemetryManager, SIGNAL(disconnected()), this, SLOT(telemetryDisconnected()));
+
+    m_retryTimer.setSingleShot(true);
+    m_retryTimer.setInterval(RETRY_INTERVAL);
+    connect(&m_retryTimer, SIGNAL(timeout()), this, SLOT(openLink()));
+}
+
+Relay::~Relay()
+{
+    m_retryTimer.stop();
+    delete m_server;
+    m_telemetryManager->removeFrameTap(this);
+
+    if (m_linkStarted) {
+        // let the connection stop in its thread before the thread ends
+        QEventLoop loop;
+        connect(m_telemetryManager, SIGNAL(disconnected()), &loop, SLOT(quit()));
+        QTimer::singleShot(RETRY_INTERVAL, &loop, SLOT(quit()));
+        m_telemetryManager->stop();
+        loop.exec();
+    }
+    if (m_device) {
+        m_device->deleteLater();
+    }
+    m_telemetryThread.quit();
+    m_telemetryThread.wait();
+    delete m_telemetryManager;
+
+    if (m_logFile) {
+        flushLog();
+        m_logFile->close();
+        delete m_logFile;
+    }
+    delete m_objectManager;
+}
+
+void Relay::setSerialLink(const QString &portName, qint32 baudRate)
+{
+    m_serialPort = portName;
+    m_baudRate   = baudRate;
+    m_tcpHost.clear();
+}
+
+void Relay::setTcpLink(const QString &host, quint16 port)
+{
+    m_tcpHost = host;
+    m_tcpPort = port;
+    m_serialPort.clear();
+}
+
+bool Relay::startServer(quint16 port)
+{
+    m_server = new TelemetryServer(m_telemetryManager);
+    if (!m_server->start(port)) {
+        delete m_server;
+        m_server = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool Relay::startLogging(const QString &fileName)
+{
+    m_logFile = new LogFile();
+    m_logFile->setFileName(fileName);
+    // the records are timed when the packets are received, not when written
+    m_logFile->useProvidedTimeStamp(true);
+    if (!m_logFile->open(QIODevice::WriteOnly)) {
+        delete m_logFile;
+        m_logFile = NULL;
+        return false;
+    }
+    m_logStart = LatencyHistogram::timestamp();
+    m_telemetryManager->addFrameTap(this);
+    return true;
+}
+
+void Relay::start()
+{
+    openLink();
+}
+
+/**
+ * Open the link to the vehicle, the telemetry takes the device over once it is open.
+ */
+void Relay::openLink()
+{
+    if (!m_tcpHost.isEmpty()) {
+        QTcpSocket *socket = new QTcpSocket();
+        m_device = socket;
+        connect(socket, &QTcpSocket::connected, this, [this, socket]() {
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            qDebug() << "Relay - connected to" << m_tcpHost << m_tcpPort;
+            m_linkStarted = true;
+            m_telemetryManager->start(socket);
+        });
+        connect(socket, SIGNAL(disconnected()), this, SLOT(linkLost()));
+        connect(socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(linkLost()));
+        socket->connectToHost(m_tcpHost, m_tcpPort);
+        return;
+    }
+
+    QSerialPort *port = new QSerialPort(m_serialPort);
+    port->setBaudRate(m_baudRate);
+    if (!port->open(QIODevice::ReadWrite)) {
+        qWarning() << "Relay - failed to open" << m_serialPort << ":" << port->errorString();
+        delete port;
+        m_retryTimer.start();
+        return;
+    }
+    qDebug() << "Relay - opened" << m_serialPort << "at" << m_baudRate << "baud";
+    m_device = port;
+    connect(port, static_cast<void(QSerialPort::*) (QSerialPort::SerialPortError)>(&QSerialPort::error),
+            this, [this](QSerialPort::SerialPortError error) {
+        if (error == QSerialPort::ResourceError) {
+            linkLost();
+        }
+    });
+    m_linkStarted = true;
+    m_telemetryManager->start(port);
+}
+
+/**
+ * The device is gone (unplugged, peer closed): stop the telemetry, drop the device and try again later.
+ */
+void Relay::linkLost()
+{
+    if (!m_device) {
+        return;
+    }
+    qWarning() << "Relay - link lost:" << m_device->errorString();
+    m_device->disconnect(this);
+    if (m_linkStarted) {
+        m_telemetryManager->stop();
+        m_linkStarted = false;
+    }
+    // deleted by the thread it belongs to, after the telemetry has stopped with it
+    m_device->deleteLater();
+    m_device = NULL;
+    m_retryTimer.start();
+}
+
+void Relay::telemetryConnected()
+{
+    qDebug() << "Relay - telemetry connected";
+}
+
+void Relay::telemetryDisconnected()
+{
+    qDebug() << "Relay - telemetry disconnected";
+}
+
+void Relay::frame(qint64 timestamp, const quint8 *packet, int length)
+{
+    quint32 time = (quint32)((timestamp - m_logStart) / 1000);
+    qint64 size  = length;
+
+    QMutexLocker locker(&m_pendingMutex);
+
+    m_pending.append((const char *)&time, sizeof(time));
+    m_pending.append((const char *)&size, sizeof(size));
+    m_pending.append((const char *)packet, length);
+    if (!m_flushQueued) {
+        m_flushQueued = true;
+        QMetaObject::invokeMethod(this, "flushLog", Qt::QueuedConnection);
+    }
+}
+
+void Relay::flushLog()
+{
+    QByteArray records;
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        m_flushQueued = false;
+        records.swap(m_pending);
+    }
+
+    const char *data = records.constData();
+    const char *end  = data + records.size();
+    while (data < end) {
+        quint32 time;
+        qint64 size;
+        memcpy(&time, data, sizeof(time));
+        memcpy(&size, data + sizeof(time), sizeof(size));
+        data += sizeof(time) + sizeof(size);
+        m_logFile->setNextTimeStamp(time);
+        m_logFile->write(data, size);
+        data += size;
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ *
+ * @file       relay.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Headless relay of a vehicle link to the telemetry server and a log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef RELAY_H
+#define RELAY_H
+
+#include "uavtalk/uavtalk.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+
+class UAVObjectManager;
+class TelemetryManager;
+class TelemetryServer;
+class LogFile;
+
+/**
+ * Runs the telemetry of one vehicle link without the GCS plugins: the object manager,
+ * UAVTalk and the telemetry on a thread of their own. The object packets received are
+ * sent to the clients of a TelemetryServer and written to a .opl log.
+ * The link is opened again a few seconds after it is lost.
+ */
+class Relay : public QObject, public UAVTalk::FrameTap {
+    Q_OBJECT
+
+public:
+    Relay(QObject *parent = 0);
+    ~Relay();
+
+    // Link to the vehicle, a serial port or a TCP host:port, see openLink()
+    void setSerialLink(const QString &portName, qint32 baudRate);
+    void setTcpLink(const QString &host, quint16 port);
+
+    bool startServer(quint16 port);
+    bool startLogging(const QString &fileName);
+    void start();
+
+    // UAVTalk::FrameTap, called from the telemetry thread
+    void frame(qint64 timestamp, const quint8 *packet, int length);
+
+private slots:
+    void openLink();
+    void linkLost();
+    void telemetryConnected();
+    void telemetryDisconnected();
+    void flushLog();
+
+private:
+    static const int RETRY_INTERVAL = 3000;
+
+    UAVObjectManager *m_objectManager;
+    QThread m_telemetryThread;
+    TelemetryManager *m_telemetryManager;
+    TelemetryServer *m_server;
+
+    QString m_serialPort;
+    qint32 m_baudRate;
+    QString m_tcpHost;
+    quint16 m_tcpPort;
+    QIODevice *m_device;
+    // the telemetry has been given the device
+    bool m_linkStarted;
+    QTimer m_retryTimer;
+
+    LogFile *m_logFile;
+    qint64 m_logStart;
+    // records tapped since the last flushLog(): ms since the log start, size, packet
+    QMutex m_pendingMutex;
+    QByteArray m_pending;
+    bool m_flushQueued;
+};
+
+#endif // RELAY_H
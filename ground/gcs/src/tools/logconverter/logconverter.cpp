@@ -0,0 +1,268 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logconverter.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Converts a flight log to CSV files, one per object, or to a MAT-file
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "logconverter.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavdataobject.h"
+#include "uavtalk/uavtalk.h"
+#include "utils/logfile.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+
+LogConverter::LogConverter(const QString &logFileName, const QString &outputPath, Format format) :
+    m_logFileName(logFileName), m_outputPath(outputPath), m_format(format), m_logFile(NULL), m_updateCount(0)
+{}
+
+LogConverter::~LogConverter()
+{
+    closeOutputs();
+}
+
+bool LogConverter::convert()
+{
+    QString outputDir = m_format == Mat ? QFileInfo(m_outputPath).absolutePath() : m_outputPath;
+
+    if (!QDir().mkpath(outputDir)) {
+        m_errorString = tr("unable to create %1").arg(outputDir);
+        return false;
+    }
+
+    UAVObjectManager objMngr;
+    UAVObjectsInitialize(&objMngr);
+
+    LogFile logFile;
+    logFile.setFileName(m_logFileName);
+    if (!logFile.open(QIODevice::ReadOnly)) {
+        m_errorString = tr("unable to open %1").arg(m_logFileName);
+        return false;
+    }
+    m_logFile = &logFile;
+
+    UAVTalk uavTalk(&logFile, &objMngr);
+    // everything runs in this thread, the records are decoded as soon as they are replayed
+    connect(&logFile, SIGNAL(readyRead()), &uavTalk, SLOT(processInputStream()), Qt::DirectConnection);
+
+    foreach(QList<UAVDataObject *> instances, objMngr.getDataObjects()) {
+        foreach(UAVDataObject * obj, instances) {
+            connect(obj, &UAVObject::objectUpdated, this, &LogConverter::objectUpdated, Qt::DirectConnection);
+        }
+    }
+    connect(&objMngr, &UAVObjectManager::newInstance, this, &LogConverter::newInstance, Qt::DirectConnection);
+
+    bool ok = logFile.replayAll();
+    if (!ok) {
+        m_errorString = tr("%1 is corrupted, the conversion stopped at %2 ms").arg(m_logFileName).arg(logFile.replayTimeStamp());
+    }
+
+    logFile.close();
+    m_logFile = NULL;
+    closeOutputs();
+
+    if (m_format == Mat && !writeMatFile()) {
+        ok = false;
+    }
+    m_samples.clear();
+
+    return ok;
+}
+
+void LogConverter::newInstance(UAVObject *obj)
+{
+    if (obj->isMetaDataObject()) {
+        return;
+    }
+    connect(obj, &UAVObject::objectUpdated, this, &LogConverter::objectUpdated, Qt::DirectConnection);
+    // the new instance was unpacked before being registered
+    objectUpdated(obj);
+}
+
+void LogConverter::objectUpdated(UAVObject *obj)
+{
+    if (m_format == Mat) {
+        appendSamples(obj);
+        m_updateCount++;
+        return;
+    }
+
+    ObjectOutput *out = output(obj);
+
+    if (!out) {
+        return;
+    }
+    QTextStream &stream = *out->stream;
+    stream << m_logFile->replayTimeStamp() << ',' << obj->getInstID();
+    foreach(UAVObjectField * field, obj->getFields()) {
+        bool numeric = field->isNumeric();
+        for (quint32 i = 0; i < field->getNumElements(); i++) {
+            stream << ',';
+            if (numeric) {
+                stream << field->getDouble(i);
+            } else {
+                stream << field->getValue(i).toString();
+            }
+        }
+    }
+    stream << '\n';
+    m_updateCount++;
+}
+
+/**
+ * Get the output of an object, the file is created and the header written on the first update
+ */
+LogConverter::ObjectOutput *LogConverter::output(UAVObject *obj)
+{
+    QHash<quint32, ObjectOutput>::iterator i = m_outputs.find(obj->getObjID());
+
+    if (i != m_outputs.end()) {
+        return i->stream ? &i.value() : NULL;
+    }
+
+    ObjectOutput out;
+    out.file   = new QFile(QDir(m_outputPath).filePath(obj->getName() + ".csv"));
+    out.stream = NULL;
+    if (out.file->open(QFile::WriteOnly | QFile::Truncate)) {
+        out.stream = new QTextStream(out.file);
+        QTextStream &stream = *out.stream;
+        stream << "Time,Instance";
+        foreach(UAVObjectField * field, obj->getFields()) {
+            quint32 numElements = field->getNumElements();
+            if (numElements == 1) {
+                stream << ',' << field->getName();
+            } else {
+                QStringList elementNames = field->getElementNames();
+                for (quint32 n = 0; n < numElements; n++) {
+                    stream << ',' << field->getName() << '.' << elementNames.value(n, QString::number(n));
+                }
+            }
+        }
+        stream << '\n';
+    } else {
+        // don't try again for every update
+        qWarning() << "LogConverter - unable to create" << out.file->fileName();
+    }
+    i = m_outputs.insert(obj->getObjID(), out);
+    return out.stream ? &i.value() : NULL;
+}
+
+void LogConverter::closeOutputs()
+{
+    foreach(ObjectOutput out, m_outputs) {
+        if (out.stream) {
+            out.stream->flush();
+            delete out.stream;
+        }
+        delete out.file;
+    }
+    m_outputs.clear();
+}
+
+/**
+ * Append an update to the samples of its object, each field being a
+ * numElements x N matrix filled column after column
+ */
+void LogConverter::appendSamples(UAVObject *obj)
+{
+    QHash<quint32, ObjectSamples>::iterator i = m_samples.find(obj->getObjID());
+
+    if (i == m_samples.end()) {
+        ObjectSamples samples;
+        samples.name            = obj->getName();
+        samples.singleInstance  = obj->isSingleInstance();
+        samples.timestamps.name = "timestamp";
+        samples.timestamps.rows = 1;
+        samples.instances.name  = "instanceID";
+        samples.instances.rows  = 1;
+        foreach(UAVObjectField * field, obj->getFields()) {
+            // strings have no numeric representation, OPLogConvert.m has none either
+            if (field->getType() == UAVObjectField::STRING) {
+                continue;
+            }
+            Utils::MatFileWriter::Matrix matrix;
+            matrix.name = field->getName();
+            matrix.rows = field->getNumElements();
+            samples.fields.append(matrix);
+        }
+        i = m_samples.insert(obj->getObjID(), samples);
+    }
+
+    ObjectSamples &samples = i.value();
+    samples.timestamps.values.append(m_logFile->replayTimeStamp());
+    if (!samples.singleInstance) {
+        samples.instances.values.append(obj->getInstID());
+    }
+    int n = 0;
+    foreach(UAVObjectField * field, obj->getFields()) {
+        if (field->getType() == UAVObjectField::STRING) {
+            continue;
+        }
+        QVector<double> &values = samples.fields[n++].values;
+        for (quint32 e = 0; e < field->getNumElements(); e++) {
+            values.append(field->getDouble(e));
+        }
+    }
+}
+
+/**
+ * Write all the objects to <output path>.mat, one struct variable per object
+ */
+bool LogConverter::writeMatFile()
+{
+    QSaveFile file(m_outputPath + ".mat");
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_errorString = tr("unable to create %1").arg(file.fileName());
+        return false;
+    }
+
+    Utils::MatFileWriter writer(&file);
+    foreach(ObjectSamples samples, m_samples) {
+        QList<Utils::MatFileWriter::Matrix> fields;
+        int count = samples.timestamps.values.size();
+
+        samples.timestamps.cols = count;
+        fields << samples.timestamps;
+        if (!samples.singleInstance) {
+            samples.instances.cols = count;
+            fields << samples.instances;
+        }
+        foreach(Utils::MatFileWriter::Matrix field, samples.fields) {
+            field.cols = count;
+            fields << field;
+        }
+        if (!writer.writeStruct(samples.name, fields)) {
+            m_errorString = tr("unable to write %1").arg(file.fileName());
+            file.cancelWriting();
+            return false;
+        }
+    }
+
+    if (!file.commit()) {
+        m_errorString = tr("unable to write %1").arg(file.fileName());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logconverter.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Converts a flight log to CSV files, one per object, or to a MAT-file
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOGCONVERTER_H
+#define LOGCONVERTER_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QTextStream>
+
+#include "utils/matfilewriter.h"
+
+class UAVObject;
+class LogFile;
+
+/**
+ * Decodes a .opl/.oplx log as fast as possible (no replay pacing, no GCS plugins)
+ * and writes the updates of each object to <output path>/<object name>.csv
+ * or, in Mat format, to a single <output path>.mat holding one struct per object,
+ * laid out as OPLogConvert.m builds them.
+ * Several converters can run in parallel, each one in its own thread with its own
+ * object manager.
+ */
+class LogConverter : public QObject {
+    Q_OBJECT
+
+public:
+    enum Format { Csv, Mat };
+
+    LogConverter(const QString &logFileName, const QString &outputPath, Format format = Csv);
+    ~LogConverter();
+
+    bool convert();
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+    quint64 updateCount() const
+    {
+        return m_updateCount;
+    }
+
+private slots:
+    void objectUpdated(UAVObject *obj);
+    void newInstance(UAVObject *obj);
+
+private:
+    typedef struct {
+        QFile *file;
+        QTextStream *stream;
+    } ObjectOutput;
+
+    // samples of an object kept in memory until the MAT-file is written
+    typedef struct {
+        QString name;
+        bool singleInstance;
+        Utils::MatFileWriter::Matrix timestamps;
+        Utils::MatFileWriter::Matrix instances;
+        QList<Utils::MatFileWriter::Matrix> fields;
+    } ObjectSamples;
+
+    QString m_logFileName;
+    QString m_outputPath;
+    Format m_format;
+    QString m_errorString;
+    LogFile *m_logFile;
+    quint64 m_updateCount;
+    QHash<quint32, ObjectOutput> m_outputs;
+    QHash<quint32, ObjectSamples> m_samples;
+
+    ObjectOutput *output(UAVObject *obj);
+    void closeOutputs();
+    void appendSamples(UAVObject *obj);
+    bool writeMatFile();
+};
+
+#endif // LOGCONVERTER_H
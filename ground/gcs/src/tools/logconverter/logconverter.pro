@@ -0,0 +1,34 @@
+#
+# Headless converter of .opl/.oplx flight logs to CSV files.
+#
+
+include(../../../gcs.pri)
+
+TEMPLATE = app
+TARGET = logconverter
+DESTDIR = $$GCS_APP_PATH
+
+QT += network concurrent
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$GCS_SOURCE_TREE/src/plugins
+LIBS += -L$$GCS_PLUGIN_PATH/$$ORG_BIG_NAME
+
+include(../../plugins/uavtalk/uavtalk.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+
+HEADERS += logconverter.h
+
+SOURCES += \
+    main.cpp \
+    logconverter.cpp
+
+!win32:!macx {
+    target.path = /bin
+    INSTALLS += target
+    QMAKE_RPATHDIR  = $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_LIBRARY_PATH, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_PLUGIN_PATH/$$ORG_BIG_NAME, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH))
+    include(../../rpath.pri)
+}
@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Headless converter of flight logs to CSV or MAT-files
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "logconverter.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QDir>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <stdio.h>
+
+namespace {
+QString outputRoot;
+LogConverter::Format outputFormat = LogConverter::Csv;
+
+// Result of the conversion of one log, empty when successful
+QString convertLog(const QString &logFileName)
+{
+    QFileInfo info(logFileName);
+    QString outputPath = outputRoot.isEmpty() ?
+                         info.absoluteDir().filePath(info.completeBaseName()) :
+                         QDir(outputRoot).filePath(info.completeBaseName());
+
+    LogConverter converter(logFileName, outputPath, outputFormat);
+
+    if (!converter.convert()) {
+        return converter.errorString();
+    }
+    return QString();
+}
+}
+
+int main(int argc, char * *argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("logconverter");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Converts flight logs (.opl, .oplx) to CSV files, one file per object,\n"
+                                     "or to MATLAB MAT-files holding one struct per object (as OPLogConvert.m).\n"
+                                     "The logs are decoded as fast as possible, several logs are converted in parallel.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("logs", "Log files to convert.", "<log> [<log>...]");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "Write the CSV files to <dir>/<log name>/ (the MAT-file to <dir>/<log name>.mat) instead of next to the logs.", "dir");
+    parser.addOption(outputOption);
+    QCommandLineOption formatOption(QStringList() << "f" << "format",
+                                    "Output format: csv (default) or mat.", "format", "csv");
+    parser.addOption(formatOption);
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+                                  "Number of logs converted in parallel (default: number of cores).", "jobs");
+    parser.addOption(jobsOption);
+    parser.process(app);
+
+    QStringList logs = parser.positionalArguments();
+    if (logs.isEmpty()) {
+        parser.showHelp(1);
+    }
+    outputRoot = parser.value(outputOption);
+    QString format = parser.value(formatOption).toLower();
+    if (format == "mat") {
+        outputFormat = LogConverter::Mat;
+    } else if (format != "csv") {
+        fprintf(stderr, "Invalid output format: %s\n", qPrintable(parser.value(formatOption)));
+        return 1;
+    }
+    if (parser.isSet(jobsOption)) {
+        int jobs = parser.value(jobsOption).toInt();
+        if (jobs < 1) {
+            fprintf(stderr, "Invalid number of jobs: %s\n", qPrintable(parser.value(jobsOption)));
+            return 1;
+        }
+        QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList errors = QtConcurrent::blockingMapped(logs, convertLog);
+
+    int failed = 0;
+    for (int i = 0; i < logs.size(); i++) {
+        if (!errors.at(i).isEmpty()) {
+            fprintf(stderr, "%s: %s\n", qPrintable(logs.at(i)), qPrintable(errors.at(i)));
+            failed++;
+        }
+    }
+    printf("%d of %d logs converted in %.1f s\n", logs.size() - failed, logs.size(), timer.elapsed() / 1000.0);
+
+    return failed ? 1 : 0;
+}
@@ -68,6 +68,7 @@ struct Context {
     QString setters;
     QString notifications;
     // implementation
+    QString fieldsDefinitions;
     QString fieldsInit;
     QString fieldsDefault;
     QString propertiesImpl;
@@ -294,32 +295,39 @@ void generateFieldInfo(Context &ctxt, FieldContext &fieldCtxt)
 
 void generateFieldInit(Context &ctxt, FieldContext &fieldCtxt)
 {
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    // :fieldName\n");
+    // Static metadata shared by all instances, fields do not own copies of it
+    ctxt.fieldsDefinitions += generate(ctxt, fieldCtxt, "// :fieldName\n");
 
     // Setup element names
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    QStringList :fieldNameElemNames;\n");
     QStringList elemNames = fieldCtxt.field->elementNames;
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    :fieldNameElemNames");
+    ctxt.fieldsDefinitions += generate(ctxt, fieldCtxt, "static constexpr const char *:fieldNameElemNames[] = {");
     for (int m = 0; m < elemNames.length(); ++m) {
-        ctxt.fieldsInit += QString(" << \"%1\"").arg(elemNames[m]);
+        ctxt.fieldsDefinitions += QString("%1 \"%2\"").arg(m > 0 ? "," : "").arg(elemNames[m]);
     }
-    ctxt.fieldsInit += ";\n";
+    ctxt.fieldsDefinitions += " };\n";
 
     if (fieldCtxt.field->type == FIELDTYPE_ENUM) {
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    QStringList :fieldNameEnumOptions;\n");
         QStringList options = fieldCtxt.field->options;
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    :fieldNameEnumOptions");
+        ctxt.fieldsDefinitions += generate(ctxt, fieldCtxt, "static constexpr const char *:fieldNameEnumOptions[] = {");
         for (int m = 0; m < options.length(); ++m) {
-            ctxt.fieldsInit += QString(" << \"%1\"").arg(options[m]);
+            ctxt.fieldsDefinitions += QString("%1 \"%2\"").arg(m > 0 ? "," : "").arg(options[m]);
         }
-        ctxt.fieldsInit += ";\n";
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt,
-                                    "    fields.append(new UAVObjectField(\":fieldName\", tr(\":fieldDesc\"), \":fieldUnits\", UAVObjectField::ENUM, :fieldNameElemNames, :fieldNameEnumOptions, \":fieldLimitValues\"));\n");
+        ctxt.fieldsDefinitions += " };\n";
+        ctxt.fieldsDefinitions += generate(ctxt, fieldCtxt,
+                                           "static constexpr UAVObjectField::Definition :fieldNameDefinition = {\n"
+                                           "    \":ClassName\", \":fieldName\", QT_TRANSLATE_NOOP(\":ClassName\", \":fieldDesc\"), \":fieldUnits\", UAVObjectField::ENUM,\n"
+                                           "    :elementCount, :fieldNameElemNames, :enumCount, :fieldNameEnumOptions, \":fieldLimitValues\"\n"
+                                           "};\n");
     } else {
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt,
-                                    "    fields.append(new UAVObjectField(\":fieldName\", tr(\":fieldDesc\"), \":fieldUnits\", UAVObjectField::%1, :fieldNameElemNames, QStringList(), \":fieldLimitValues\"));\n")
-                           .arg(fieldTypeStrCPPClass(fieldCtxt.field->type));
+        ctxt.fieldsDefinitions += generate(ctxt, fieldCtxt,
+                                           "static constexpr UAVObjectField::Definition :fieldNameDefinition = {\n"
+                                           "    \":ClassName\", \":fieldName\", QT_TRANSLATE_NOOP(\":ClassName\", \":fieldDesc\"), \":fieldUnits\", UAVObjectField::%1,\n"
+                                           "    :elementCount, :fieldNameElemNames, 0, NULL, \":fieldLimitValues\"\n"
+                                           "};\n")
+                                  .arg(fieldTypeStrCPPClass(fieldCtxt.field->type));
     }
+
+    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    fields.append(new UAVObjectField(:fieldNameDefinition));\n");
 }
 
 void generateFieldDefault(Context &ctxt, FieldContext &fieldCtxt)
@@ -399,7 +407,8 @@ void generateEnum(Context &ctxt, FieldContext &fieldCtxt)
     }
 }
 
-void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
+// dataMember is the member of DataFields holding the property value (i.e. Field or Field[index])
+void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt, const QString &dataMember)
 {
     ctxt.properties        += generate(ctxt, fieldCtxt,
                                        "    Q_PROPERTY(:propType :propName READ :propName WRITE set:PropName NOTIFY :propNameChanged)\n");
@@ -408,7 +417,11 @@ void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
     ctxt.setters           += generate(ctxt, fieldCtxt, "    void set:PropName(const :propRefType value);\n");
 
     ctxt.notifications     += generate(ctxt, fieldCtxt, "    void :propNameChanged(const :propRefType value);\n");
-    ctxt.notificationsImpl += generate(ctxt, fieldCtxt, "    emit :propNameChanged(:propName());\n");
+
+    // only notify properties that changed since the last notification
+    ctxt.notificationsImpl += generate(ctxt, fieldCtxt,
+                                       "    if (!notified_ || (data.%1 != notifiedData_.%1)) {\n"
+                                       "        emit :propNameChanged(static_cast<:propType>(data.%1));\n").arg(dataMember);
 
     if (DEPRECATED) {
         // generate deprecated property for retro compatibility
@@ -429,9 +442,10 @@ void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
                                                "    /*DEPRECATED*/ void :fieldNameChanged(:fieldType value);\n");
 
             ctxt.notificationsImpl += generate(ctxt, fieldCtxt,
-                                               "    /*DEPRECATED*/ emit :fieldNameChanged(get:fieldName());\n");
+                                               "        /*DEPRECATED*/ emit :fieldNameChanged(get:fieldName());\n");
         }
     }
+    ctxt.notificationsImpl += "    }\n";
 }
 
 void generateSimpleProperty(Context &ctxt, FieldContext &fieldCtxt)
@@ -440,7 +454,7 @@ void generateSimpleProperty(Context &ctxt, FieldContext &fieldCtxt)
         generateEnum(ctxt, fieldCtxt);
     }
 
-    generateBaseProperty(ctxt, fieldCtxt);
+    generateBaseProperty(ctxt, fieldCtxt, fieldCtxt.fieldName);
 
     // getter implementation
     ctxt.propertiesImpl += generate(ctxt, fieldCtxt,
@@ -546,7 +560,7 @@ void generateIndexedProperty(Context &ctxt, FieldContext &fieldCtxt)
         elementCtxt.hasDeprecatedNotification = ((elementCtxt.fieldName != elementCtxt.propName) || (elementCtxt.fieldType != elementCtxt.propType)) && DEPRECATED;
 
 
-        generateBaseProperty(ctxt, elementCtxt);
+        generateBaseProperty(ctxt, elementCtxt, QString("%1[%2]").arg(fieldCtxt.fieldName).arg(elementIndex));
 
         ctxt.propertiesImpl += generate(ctxt, elementCtxt,
                                         ":propType :ClassName:::propName() const { return %1(%2); }\n").arg(fieldCtxt.propName).arg(elementIndex);
@@ -600,7 +614,7 @@ bool UAVObjectGeneratorGCS::generate(UAVObjectParser *parser, QString templatepa
 
         objInc.append(QString("#include \"%1.h\"\n").arg(object->namelc));
 
-        gcsObjInit += ::generate(ctxt, "    objMngr->registerObject( new :ClassName() );\n");
+        gcsObjInit += ::generate(ctxt, "    objMngr->registerObjectType(:ClassName::OBJID, :ClassName::NAME, &:ClassName::create);\n");
         gcsObjInit += ::generate(ctxt, "    :ClassName::registerQMLTypes();\n");
     }
 
@@ -724,6 +738,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *object)
     outInclude.replace("$(PROPERTY_SETTERS)", ctxt.setters);
     outInclude.replace("$(PROPERTY_NOTIFICATIONS)", ctxt.notifications);
 
+    outCode.replace("$(FIELDSDEFINITIONS)", ctxt.fieldsDefinitions);
     outCode.replace("$(FIELDSINIT)", ctxt.fieldsInit);
     outCode.replace("$(FIELDSDEFAULT)", ctxt.fieldsDefault);
     outCode.replace("$(PROPERTIES_IMPL)", ctxt.propertiesImpl);
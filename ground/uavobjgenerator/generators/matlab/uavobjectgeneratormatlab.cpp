@@ -59,7 +59,7 @@ bool UAVObjectGeneratorMatlab::generate(UAVObjectParser *parser, QString templat
     matlabCodeTemplate.replace(QString("$(ALLOCATIONCODE)"), matlabAllocationCode);
     matlabCodeTemplate.replace(QString("$(EXPORTCSVCODE)"), matlabExportCsvCode);
 
-    bool res = writeFile(matlabOutputPath.absolutePath() + "/OPLogConvert.m", matlabCodeTemplate);
+    bool res = writeFileIfDifferent(matlabOutputPath.absolutePath() + "/OPLogConvert.m", matlabCodeTemplate);
     if (!res) {
         cout << "Error: Could not write output files" << endl;
         return false;
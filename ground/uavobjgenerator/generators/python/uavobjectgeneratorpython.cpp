@@ -69,6 +69,7 @@ bool UAVObjectGeneratorPython::process_object(ObjectInfo *info)
         // Class header
         datafields.append(QString("# Field %1 definition\n").arg(info->fields[n]->name));
         datafields.append(QString("class %1Field(UAVObjectField):\n").arg(info->fields[n]->name));
+        datafields.append(QString("    name = \"%1\"\n").arg(info->fields[n]->name));
         // Only for enum types
         if (info->fields[n]->type == FIELDTYPE_ENUM) {
             datafields.append(QString("    # Enumeration options\n"));
@@ -26,6 +26,8 @@
 
 #include "uavobjectgeneratorwireshark.h"
 
+#include <QMap>
+
 using namespace std;
 
 bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString templatepath, QString outputpath)
@@ -83,18 +85,37 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString temp
                     uavobjectsOutputPath.absoluteFilePath(uavostaticfiles[i]));
     }
 
-    /* Generate the per-object files from the templates, and keep track of the list of generated filenames */
-    QString objFileNames;
+    /* Generate the dissector tables of all the objects, sorted by id for the lookup of the dissector */
+    QMap<quint32, ObjectInfo *> objects;
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo *info = parser->getObjectByIndex(objidx);
-        process_object(info, uavobjectsOutputPath);
-        objFileNames.append(" packet-op-uavobjects-" + info->namelc + ".c");
+        objects.insert(info->id, info);
+    }
+    foreach(ObjectInfo * info, objects) {
+        process_object(info);
+    }
+
+    QString outCode = wiresharkCodeTemplate;
+
+    replaceCommonTags(outCode);
+    outCode.replace(QString("$(SUBTREESTATICS)"), subtreeStatics);
+    outCode.replace(QString("$(SUBTREES)"), subtrees);
+    outCode.replace(QString("$(FIELDHANDLES)"), fieldHandles);
+    outCode.replace(QString("$(ENUMFIELDNAMES)"), enumFieldNames);
+    outCode.replace(QString("$(FIELDTABLES)"), fieldTables);
+    outCode.replace(QString("$(OBJECTTABLE)"), objectTable);
+    outCode.replace(QString("$(HEADERFIELDS)"), QString("   static hf_register_info hf[] = {\r\n") + headerFields + QString("   };\r\n"));
+
+    bool res = writeFileIfDifferent(uavobjectsOutputPath.absolutePath() + "/packet-op-uavobjects.c", outCode);
+    if (!res) {
+        cout << "Error: Could not write wireshark code files" << endl;
+        return false;
     }
 
     /* Write the uavobject dissector's Makefile.common */
-    wiresharkMakeTemplate.replace(QString("$(UAVOBJFILENAMES)"), objFileNames);
-    bool res = writeFileIfDifferent(uavobjectsOutputPath.absolutePath() + "/Makefile.common",
-                                    wiresharkMakeTemplate);
+    wiresharkMakeTemplate.replace(QString("$(UAVOBJFILENAMES)"), QString(" packet-op-uavobjects.c"));
+    res = writeFileIfDifferent(uavobjectsOutputPath.absolutePath() + "/Makefile.common",
+                               wiresharkMakeTemplate);
     if (!res) {
         cout << "Error: Could not write wireshark Makefile" << endl;
         return false;
@@ -105,185 +126,117 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser *parser, QString temp
 
 
 /**
- * Generate the Flight object files
+ * Generate the dissector tables of an object: the field handles and their
+ * registration, and the field table giving the position of each field
  **/
-bool UAVObjectGeneratorWireshark::process_object(ObjectInfo *info, QDir outputpath)
+bool UAVObjectGeneratorWireshark::process_object(ObjectInfo *info)
 {
     if (info == NULL) {
         return false;
     }
 
-    // Prepare output strings
-    QString outCode = wiresharkCodeTemplate;
-
-    // Replace common tags
-    replaceCommonTags(outCode, info);
+    QString table;
+    int numEntries = 0;
+    int offset     = 0;
 
-    // Replace the $(SUBTREES) and $(SUBTREESTATICS) tags
-    QString subtrees;
-    QString subtreestatics;
-    subtreestatics.append(QString("static gint ett_uavo = -1;\r\n"));
-    subtrees.append(QString("&ett_uavo,\r\n"));
     for (int n = 0; n < info->fields.length(); ++n) {
-        if (info->fields[n]->numElements > 1) {
-            /* Reserve a subtree for each array */
-            subtreestatics.append(QString("static gint ett_%1_%2 = -1;\r\n")
-                                  .arg(info->namelc)
-                                  .arg(info->fields[n]->name));
-            subtrees.append(QString("&ett_%1_%2,\r\n")
-                            .arg(info->namelc)
-                            .arg(info->fields[n]->name));
-        }
-    }
-    outCode.replace(QString("$(SUBTREES)"), subtrees);
-    outCode.replace(QString("$(SUBTREESTATICS)"), subtreestatics);
+        FieldInfo *field = info->fields[n];
+        QString hfField  = QString("hf_op_uavobjects_%1_%2").arg(info->namelc).arg(field->name);
+        QString display;
 
-    // Replace the $(FIELDHANDLES) tag
-    QString type;
-    QString fields;
-    for (int n = 0; n < info->fields.length(); ++n) {
-        fields.append(QString("static int hf_op_uavobjects_%1_%2 = -1;\r\n")
-                      .arg(info->namelc)
-                      .arg(info->fields[n]->name));
-        if (info->fields[n]->numElements > 1) {
-            QStringList elemNames = info->fields[n]->elementNames;
-            for (int m = 0; m < elemNames.length(); ++m) {
-                fields.append(QString("static int hf_op_uavobjects_%1_%2_%3 = -1;\r\n")
-                              .arg(info->namelc)
-                              .arg(info->fields[n]->name)
-                              .arg(elemNames[m]));
-            }
-        }
-    }
-    outCode.replace(QString("$(FIELDHANDLES)"), fields);
+        if (field->type == FIELDTYPE_ENUM) {
+            display = QString("BASE_DEC, VALS(uavobjects_%1_%2), 0x0, NULL, HFILL").arg(info->namelc).arg(field->name);
 
-    // Replace the $(ENUMFIELDNAMES) tag
-    QString enums;
-    for (int n = 0; n < info->fields.length(); ++n) {
-        // Only for enum types
-        if (info->fields[n]->type == FIELDTYPE_ENUM) {
-            enums.append(QString("/* Field %1 information */\r\n").arg(info->fields[n]->name));
-            enums.append(QString("/* Enumeration options for field %1 */\r\n").arg(info->fields[n]->name));
-            enums.append(QString("static const value_string uavobjects_%1_%2[]= {\r\n")
-                         .arg(info->namelc)
-                         .arg(info->fields[n]->name));
+            enumFieldNames.append(QString("/* Enumeration options for field %1.%2 */\r\n").arg(info->name).arg(field->name));
+            enumFieldNames.append(QString("static const value_string uavobjects_%1_%2[]= {\r\n")
+                                  .arg(info->namelc)
+                                  .arg(field->name));
             // Go through each option
-            QStringList options = info->fields[n]->options;
+            QStringList options = field->options;
             for (int m = 0; m < options.length(); ++m) {
-                enums.append(QString("\t{ %1, \"%2\" },\r\n")
-                             .arg(m)
-                             .arg(options[m].replace(QRegExp(ENUM_SPECIAL_CHARS), "")));
+                enumFieldNames.append(QString("\t{ %1, \"%2\" },\r\n")
+                                      .arg(m)
+                                      .arg(options[m].replace(QRegExp(ENUM_SPECIAL_CHARS), "")));
             }
-            enums.append(QString("\t{ 0, NULL }\r\n"));
-            enums.append(QString("};\r\n"));
-        }
-    }
-    outCode.replace(QString("$(ENUMFIELDNAMES)"), enums);
-
-    // Replace the $(POPULATETREE) tag
-    QString treefields;
-    for (int n = 0; n < info->fields.length(); ++n) {
-        if (info->fields[n]->numElements == 1) {
-            treefields.append(QString("    ptvcursor_add(cursor, hf_op_uavobjects_%1_%2, sizeof(%3), ENC_LITTLE_ENDIAN);\r\n")
-                              .arg(info->namelc)
-                              .arg(info->fields[n]->name)
-                              .arg(fieldTypeStrGlib[info->fields[n]->type]));
+            enumFieldNames.append(QString("\t{ 0, NULL }\r\n"));
+            enumFieldNames.append(QString("};\r\n"));
+        } else if (field->type == FIELDTYPE_FLOAT32) {
+            display = QString("BASE_NONE, NULL, 0x0, NULL, HFILL");
         } else {
-            treefields.append(QString("    {\r\n"));
-            treefields.append(QString("      proto_item * it = NULL;\r\n"));
-            treefields.append(QString("      it = ptvcursor_add_no_advance(cursor, hf_op_uavobjects_%1_%2, 1, ENC_NA);\r\n")
-                              .arg(info->namelc)
-                              .arg(info->fields[n]->name));
-            treefields.append(QString("      ptvcursor_push_subtree(cursor, it, ett_%1_%2);\r\n")
-                              .arg(info->namelc)
-                              .arg(info->fields[n]->name));
-            /* Populate each array element into the table */
-            QStringList elemNames = info->fields[n]->elementNames;
-            for (int m = 0; m < elemNames.length(); ++m) {
-                treefields.append(QString("    ptvcursor_add(cursor, hf_op_uavobjects_%1_%2_%3, sizeof(%4), ENC_LITTLE_ENDIAN);\r\n")
-                                  .arg(info->namelc)
-                                  .arg(info->fields[n]->name)
-                                  .arg(elemNames[m])
-                                  .arg(fieldTypeStrGlib[info->fields[n]->type]));
-            }
-            treefields.append(QString("      ptvcursor_pop_subtree(cursor);\r\n"));
-            treefields.append(QString("    }\r\n"));
+            display = QString("BASE_DEC, NULL, 0x0, NULL, HFILL");
         }
-    }
-    outCode.replace(QString("$(POPULATETREE)"), treefields);
 
-    // Replace the $(HEADERFIELDS) tag
-    QString headerfields;
-    headerfields.append(QString("   static hf_register_info hf[] = {\r\n"));
-    for (int n = 0; n < info->fields.length(); ++n) {
-        // For non-array fields
-        if (info->fields[n]->numElements == 1) {
-            headerfields.append(QString("\t { &hf_op_uavobjects_%1_%2,\r\n")
+        fieldHandles.append(QString("static int %1 = -1;\r\n").arg(hfField));
+        if (field->numElements == 1) {
+            headerFields.append(QString("\t { &%1,\r\n").arg(hfField));
+            headerFields.append(QString("\t   { \"%1\", \"%2.%3\", %4,\r\n")
+                                .arg(field->name)
                                 .arg(info->namelc)
-                                .arg(info->fields[n]->name));
-            headerfields.append(QString("\t   { \"%1\", \"%2.%3\", %4,\r\n")
-                                .arg(info->fields[n]->name)
-                                .arg(info->namelc)
-                                .arg(info->fields[n]->name)
-                                .arg(fieldTypeStrHf[info->fields[n]->type]));
-            if (info->fields[n]->type == FIELDTYPE_ENUM) {
-                headerfields.append(QString("\t     BASE_DEC, VALS(uavobjects_%1_%2), 0x0, NULL, HFILL \r\n")
-                                    .arg(info->namelc)
-                                    .arg(info->fields[n]->name));
-            } else if (info->fields[n]->type == FIELDTYPE_FLOAT32) {
-                headerfields.append(QString("\t     BASE_NONE, NULL, 0x0, NULL, HFILL \r\n"));
-            } else {
-                headerfields.append(QString("\t     BASE_DEC, NULL, 0x0, NULL, HFILL\r\n"));
-            }
-            headerfields.append(QString("\t   },\r\n"));
-            headerfields.append(QString("\t },\r\n"));
+                                .arg(field->name)
+                                .arg(fieldTypeStrHf[field->type]));
+            headerFields.append(QString("\t     %1 }\r\n").arg(display));
+            headerFields.append(QString("\t },\r\n"));
+
+            table.append(QString("    { &%1, NULL, %2, %3, 0 },\r\n").arg(hfField).arg(offset).arg(field->numBytes));
+            numEntries++;
         } else {
-            headerfields.append(QString("\t { &hf_op_uavobjects_%1_%2,\r\n")
-                                .arg(info->namelc)
-                                .arg(info->fields[n]->name));
-            headerfields.append(QString("\t   { \"%1\", \"%2.%3\", FT_NONE,\r\n")
-                                .arg(info->fields[n]->name)
-                                .arg(info->namelc)
-                                .arg(info->fields[n]->name));
-            headerfields.append(QString("\t     BASE_NONE, NULL, 0x0, NULL, HFILL\r\n"));
-            headerfields.append(QString("\t   },\r\n"));
-            headerfields.append(QString("\t },\r\n"));
+            /* Reserve a subtree for each array */
+            QString ettField = QString("ett_%1_%2").arg(info->namelc).arg(field->name);
+            subtreeStatics.append(QString("static gint %1 = -1;\r\n").arg(ettField));
+            subtrees.append(QString("&%1,\r\n").arg(ettField));
 
-            QStringList elemNames = info->fields[n]->elementNames;
+            headerFields.append(QString("\t { &%1,\r\n").arg(hfField));
+            headerFields.append(QString("\t   { \"%1\", \"%2.%3\", FT_NONE,\r\n")
+                                .arg(field->name)
+                                .arg(info->namelc)
+                                .arg(field->name));
+            headerFields.append(QString("\t     BASE_NONE, NULL, 0x0, NULL, HFILL }\r\n"));
+            headerFields.append(QString("\t },\r\n"));
+
+            table.append(QString("    { &%1, &%2, %3, %4, %5 },\r\n")
+                         .arg(hfField)
+                         .arg(ettField)
+                         .arg(offset)
+                         .arg(field->numBytes * field->numElements)
+                         .arg(field->numElements));
+            numEntries++;
+
+            /* Each array element has its own handle and entry */
+            QStringList elemNames = field->elementNames;
             for (int m = 0; m < elemNames.length(); ++m) {
-                headerfields.append(QString("\t { &hf_op_uavobjects_%1_%2_%3,\r\n")
-                                    .arg(info->namelc)
-                                    .arg(info->fields[n]->name)
-                                    .arg(elemNames[m]));
-                headerfields.append(QString("\t   { \"%1\", \"%2.%3.%4\", %5,\r\n")
+                QString hfElement = QString("%1_%2").arg(hfField).arg(elemNames[m]);
+                fieldHandles.append(QString("static int %1 = -1;\r\n").arg(hfElement));
+
+                headerFields.append(QString("\t { &%1,\r\n").arg(hfElement));
+                headerFields.append(QString("\t   { \"%1\", \"%2.%3.%4\", %5,\r\n")
                                     .arg(elemNames[m])
                                     .arg(info->namelc)
-                                    .arg(info->fields[n]->name)
+                                    .arg(field->name)
                                     .arg(elemNames[m])
-                                    .arg(fieldTypeStrHf[info->fields[n]->type]));
-                if (info->fields[n]->type == FIELDTYPE_ENUM) {
-                    headerfields.append(QString("\t     BASE_DEC, VALS(uavobjects_%1_%2), 0x0, NULL, HFILL \r\n")
-                                        .arg(info->namelc)
-                                        .arg(info->fields[n]->name));
-                } else if (info->fields[n]->type == FIELDTYPE_FLOAT32) {
-                    headerfields.append(QString("\t     BASE_NONE, NULL, 0x0, NULL, HFILL \r\n"));
-                } else {
-                    headerfields.append(QString("\t     BASE_DEC, NULL, 0x0, NULL, HFILL\r\n"));
-                }
-                headerfields.append(QString("\t   },\r\n"));
-                headerfields.append(QString("\t },\r\n"));
+                                    .arg(fieldTypeStrHf[field->type]));
+                headerFields.append(QString("\t     %1 }\r\n").arg(display));
+                headerFields.append(QString("\t },\r\n"));
+
+                table.append(QString("    { &%1, NULL, %2, %3, 0 },\r\n")
+                             .arg(hfElement)
+                             .arg(offset + m * field->numBytes)
+                             .arg(field->numBytes));
+                numEntries++;
             }
         }
+        offset += field->numBytes * field->numElements;
     }
-    headerfields.append(QString("   };\r\n"));
-    outCode.replace(QString("$(HEADERFIELDS)"), headerfields);
 
-    // Write the flight code
-    bool res = writeFileIfDifferent(outputpath.absolutePath() + "/packet-op-uavobjects-" + info->namelc + ".c", outCode);
-    if (!res) {
-        cout << "Error: Could not write wireshark code files" << endl;
-        return false;
-    }
+    fieldTables.append(QString("static const uavo_field_t uavo_%1_fields[] = {\r\n").arg(info->namelc));
+    fieldTables.append(table);
+    fieldTables.append(QString("};\r\n"));
+
+    objectTable.append(QString("    { 0x%1, \"%2\", %3, %4, uavo_%5_fields },\r\n")
+                       .arg(QString().setNum(info->id, 16).toUpper())
+                       .arg(info->name)
+                       .arg(offset)
+                       .arg(numEntries)
+                       .arg(info->namelc));
 
     return true;
 }
@@ -39,7 +39,11 @@ public:
     QDir wiresharkOutputPath;
 
 private:
-    bool process_object(ObjectInfo *info, QDir outputpath);
+    // the sections of the dissector, appended to for each object
+    QString subtreeStatics, subtrees, fieldHandles, enumFieldNames;
+    QString fieldTables, objectTable, headerFields;
+
+    bool process_object(ObjectInfo *info);
 };
 
 #endif
@@ -25,6 +25,8 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include <QtCore/QCoreApplication>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QDomDocument>
 #include <QFile>
 #include <QString>
 #include <QStringList>
@@ -79,6 +81,28 @@ int usage_err()
     return RETURN_ERR_USAGE;
 }
 
+/**
+ * XML file read and parsed, but not processed yet
+ */
+struct XMLDocument {
+    QFileInfo    fileinfo;
+    QDomDocument doc;
+    bool parsed;
+};
+
+/**
+ * read and parse a XML file, can be run concurrently
+ */
+XMLDocument loadXML(const QFileInfo &fileinfo)
+{
+    XMLDocument xml;
+
+    xml.fileinfo = fileinfo;
+    xml.doc    = QDomDocument("UAVObjects");
+    xml.parsed = xml.doc.setContent(readFile(fileinfo.absoluteFilePath()));
+    return xml;
+}
+
 /**
  * entrance
  */
@@ -146,8 +170,9 @@ int main(int argc, char *argv[])
     xmlPath.setNameFilters(filters);
     QFileInfoList xmlList   = xmlPath.entryInfoList();
 
-    // Read in each XML file and parse object(s) in them
+    // Select the XML files to parse
 
+    QList<QFileInfo> selectedList;
     for (int n = 0; n < xmlList.length(); ++n) {
         QFileInfo fileinfo = xmlList[n];
         if (!do_allObjects) {
@@ -158,13 +183,24 @@ int main(int argc, char *argv[])
                 continue;
             }
         }
+        selectedList.append(fileinfo);
+    }
+
+    // Read and parse the XML files in parallel
+
+    QList<XMLDocument> xmlDocuments = QtConcurrent::blockingMapped(selectedList, loadXML);
+
+    // Process the object(s) in each XML file, in order as objects can be derived from others
+
+    foreach(const XMLDocument &xml, xmlDocuments) {
+        QFileInfo fileinfo = xml.fileinfo;
+
         if (verbose) {
             cout << "Parsing XML file: " << fileinfo.fileName().toStdString() << endl;
         }
         QString filename = fileinfo.fileName();
-        QString xmlstr   = readFile(fileinfo.absoluteFilePath());
 
-        QString res = parser->parseXML(xmlstr, filename);
+        QString res = xml.parsed ? parser->parseDocument(xml.doc, filename) : QString("Improperly formated XML file");
 
         if (!res.isNull()) {
             if (!verbose) {
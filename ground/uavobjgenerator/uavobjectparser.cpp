@@ -144,6 +144,15 @@ QString UAVObjectParser::parseXML(QString & xml, QString & filename)
         return QString("Improperly formated XML file");
     }
 
+    return parseDocument(doc, filename);
+}
+
+/**
+ * Process an already parsed XML document.
+ * Documents must be processed in order as objects can reference fields of previously processed objects.
+ */
+QString UAVObjectParser::parseDocument(const QDomDocument & doc, QString & filename)
+{
     // Read all objects contained in the XML file, creating an new ObjectInfo for each
     QDomElement docElement = doc.documentElement();
     QDomNode node = docElement.firstChild();
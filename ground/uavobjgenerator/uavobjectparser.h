@@ -109,6 +109,7 @@ public:
     // Functions
     UAVObjectParser();
     QString parseXML(QString & xml, QString & filename);
+    QString parseDocument(const QDomDocument & doc, QString & filename);
     int getNumObjects();
     QList<ObjectInfo *> getObjectInfo();
     QString getObjectName(int objIndex);
@@ -0,0 +1,76 @@
+##
+##############################################################################
+#
+# @file       example_decodelog.py
+# @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+# @brief      Decode a whole log at once and print a summary of its objects
+#
+# @see        The GNU Public License (GPL) Version 3
+#
+#############################################################################/
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+# for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+#
+
+
+import logging
+import os
+import sys
+import time
+
+from librepilot.uavtalk.uavtalk import *
+from librepilot.uavtalk.objectManager import *
+from librepilot.uavtalk import logdecoder
+
+
+def printUsage():
+    appName = os.path.basename(sys.argv[0])
+    print
+    print "usage:"
+    print "  %s filename " % appName
+    print
+    print "  for example: %s /tmp/OP-2015-04-28_23-16-33.opl" % appName
+    print
+
+if __name__ == '__main__':
+
+    if len(sys.argv) != 2:
+        print "ERROR: Incorrect number of arguments"
+        printUsage()
+        sys.exit(2)
+
+    script, filename = sys.argv
+    if not os.path.exists(filename):
+        sys.exit('ERROR: Log %s was not found!' % filename)
+
+    logging.basicConfig(level=logging.INFO)
+
+    objMan = ObjManager(UavTalk(None, filename))
+    objMan.importDefinitions()
+
+    decoder = logdecoder.LogDecoder(objMan)
+    start = time.time()
+    logs = decoder.decodeFile(filename)
+    print "Decoded in %.2fs (%s parser)" % (time.time() - start,
+                                            "native" if logdecoder._logdecoder else "python")
+    print "Frames: %(frames)d, CRC errors: %(crcErrors)d, unknown objects: %(unknownObjects)d" % decoder.stats
+    print
+    for name in sorted(logs):
+        print "%-40s %8d updates" % (name, len(logs[name]))
+
+    if logdecoder.numpy is not None and "AttitudeState" in logs:
+        attitude = logs["AttitudeState"].columns()
+        print
+        print "AttitudeState roll: min %.1f max %.1f" % (attitude["Roll"].min(), attitude["Roll"].max())
@@ -35,51 +35,61 @@ from librepilot.uavtalk.uavobject import *
 
 # Field TxDataRate definition
 class TxDataRateField(UAVObjectField):
+    name = "TxDataRate"
     def __init__(self):
         UAVObjectField.__init__(self, 6, 1)
 
 # Field TxBytes definition
 class TxBytesField(UAVObjectField):
+    name = "TxBytes"
     def __init__(self):
         UAVObjectField.__init__(self, 5, 1)
 
 # Field TxFailures definition
 class TxFailuresField(UAVObjectField):
+    name = "TxFailures"
     def __init__(self):
         UAVObjectField.__init__(self, 5, 1)
 
 # Field TxRetries definition
 class TxRetriesField(UAVObjectField):
+    name = "TxRetries"
     def __init__(self):
         UAVObjectField.__init__(self, 5, 1)
 
 # Field RxDataRate definition
 class RxDataRateField(UAVObjectField):
+    name = "RxDataRate"
     def __init__(self):
         UAVObjectField.__init__(self, 6, 1)
 
 # Field RxBytes definition
 class RxBytesField(UAVObjectField):
+    name = "RxBytes"
     def __init__(self):
         UAVObjectField.__init__(self, 5, 1)
 
 # Field RxFailures definition
 class RxFailuresField(UAVObjectField):
+    name = "RxFailures"
     def __init__(self):
         UAVObjectField.__init__(self, 5, 1)
 
 # Field RxSyncErrors definition
 class RxSyncErrorsField(UAVObjectField):
+    name = "RxSyncErrors"
     def __init__(self):
         UAVObjectField.__init__(self, 5, 1)
 
 # Field RxCrcErrors definition
 class RxCrcErrorsField(UAVObjectField):
+    name = "RxCrcErrors"
     def __init__(self):
         UAVObjectField.__init__(self, 5, 1)
 
 # Field Status definition
 class StatusField(UAVObjectField):
+    name = "Status"
     # Enumeration options
     DISCONNECTED = 0
     HANDSHAKEREQ = 1
@@ -0,0 +1,370 @@
+##
+##############################################################################
+#
+# @file       logdecoder.py
+# @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+# @brief      Fast decoding of whole UAVTalk logs into columns
+#
+# @see        The GNU Public License (GPL) Version 3
+#
+#############################################################################/
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+# for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+#
+
+"""
+Decodes a whole log at once instead of replaying it through UavTalk.
+
+The updates of each object are kept as columns (timestamps, instance ids and
+serialized data) that numpy maps without copies, for example:
+
+    objMan = ObjManager(UavTalk(None, None))
+    objMan.importDefinitions()
+    log = LogDecoder(objMan).decodeFile("flight.opl")
+    attitude = log["AttitudeState"].columns()
+    print attitude["timestamp"], attitude["Roll"]
+
+The frames are parsed by the native _logdecoder extension (built by setup.py
+from native/logdecoder.cpp and the GCS CRC code) and by a slower pure python
+version of the same parser when the extension is not available.
+"""
+
+import mmap
+import os
+import struct
+
+from librepilot.uavtalk.uavobject import UAVObjectField
+
+try:
+    from librepilot.uavtalk import _logdecoder
+except ImportError:
+    _logdecoder = None
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+SYNC = 0x3C
+VERSION_MASK = 0xF8
+VERSION = 0x20
+VERSION2 = 0x40
+TYPE_MASK = 0x07
+TYPE_OBJ = 0x00
+TYPE_OBJ_ACK = 0x02
+TYPE_MULTI = 0x05
+TYPE_DELTA = 0x06
+TYPE_MULTI_ACK = 0x07
+
+HEADER_LENGTH = 10
+HEADER_LENGTH_V2 = 12
+MAX_PAYLOAD_LENGTH = 255
+MAX_PAYLOAD_LENGTH_V2 = 1024
+RECORD_HEADER_LENGTH = 8
+
+LOG_SUFFIX = ".opl"
+LOG_RECORD_HEADER_LENGTH = 12 # timestamp (4), data size (8)
+LOG_RECORD_MAX_SIZE = 1024 * 1024
+
+_DTYPES = {
+    UAVObjectField.FType.INT8: "i1",
+    UAVObjectField.FType.INT16: "<i2",
+    UAVObjectField.FType.INT32: "<i4",
+    UAVObjectField.FType.UINT8: "u1",
+    UAVObjectField.FType.UINT16: "<u2",
+    UAVObjectField.FType.UINT32: "<u4",
+    UAVObjectField.FType.FLOAT32: "<f4",
+    UAVObjectField.FType.ENUM: "u1",
+}
+
+
+def _crcTable8():
+    table = []
+    for b in range(256):
+        crc = b
+        for bit in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+        table.append(crc)
+    return table
+
+
+def _crcTable16():
+    table = []
+    for b in range(256):
+        crc = b << 8
+        for bit in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+        table.append(crc)
+    return table
+
+
+class _PythonDecoder(object):
+    """Same parser as native/logdecoder.cpp, see there for the details"""
+
+    crcTable8 = None
+    crcTable16 = None
+
+    def __init__(self, sizes):
+        if _PythonDecoder.crcTable8 is None:
+            _PythonDecoder.crcTable8 = _crcTable8()
+            _PythonDecoder.crcTable16 = _crcTable16()
+        self.sizes = sizes
+        self.objects = {}
+        self.bases = {}
+        self.stats = dict(frames=0, crcErrors=0, sizeErrors=0, unknownObjects=0, deltaErrors=0, corruptedRecords=0)
+
+    def _crc8(self, data):
+        crc = 0
+        table = self.crcTable8
+        for b in data:
+            crc = table[crc ^ b]
+        return crc
+
+    def _crc16(self, data):
+        crc = 0xFFFF
+        table = self.crcTable16
+        for b in data:
+            crc = ((crc << 8) & 0xFFFF) ^ table[(crc >> 8) ^ b]
+        return crc
+
+    def _object(self, objId, instId, data, timestamp):
+        size = self.sizes.get(objId)
+        if size is None:
+            self.stats["unknownObjects"] += 1
+            return
+        if size != len(data):
+            self.stats["sizeErrors"] += 1
+            return
+        columns = self.objects.get(objId)
+        if columns is None:
+            columns = self.objects[objId] = ([], [], [])
+        columns[0].append(timestamp)
+        columns[1].append(instId)
+        columns[2].append(bytes(data))
+        if (objId, instId) in self.bases:
+            self.bases[(objId, instId)] = bytearray(data)
+
+    def _delta(self, objId, instId, data, timestamp):
+        size = self.sizes.get(objId)
+        if size is None:
+            self.stats["unknownObjects"] += 1
+            return
+        base = self.bases.get((objId, instId))
+        if base is None:
+            # track that object from now on, the next full update is the base
+            self.bases[(objId, instId)] = bytearray()
+            self.stats["deltaErrors"] += 1
+            return
+        state = bytearray(base)
+        valid = len(state) == size and len(data) >= 1 and self._crc8(state) == data[0]
+        pos = 0
+        i = 1
+        while valid and i < len(data):
+            if len(data) - i < 2:
+                valid = False
+                break
+            pos += data[i]
+            changed = data[i + 1]
+            i += 2
+            if pos + changed > len(state) or i + changed > len(data):
+                valid = False
+                break
+            for n in range(changed):
+                state[pos] ^= data[i]
+                pos += 1
+                i += 1
+        if not valid:
+            self.stats["deltaErrors"] += 1
+            return
+        self._object(objId, instId, state, timestamp)
+
+    def _records(self, rxType, payload, timestamp):
+        offset = 0
+        while offset < len(payload):
+            if len(payload) - offset < RECORD_HEADER_LENGTH:
+                self.stats["sizeErrors"] += 1
+                return
+            objId, instId, length = struct.unpack_from("<IHH", payload, offset)
+            data = payload[offset + RECORD_HEADER_LENGTH:offset + RECORD_HEADER_LENGTH + length]
+            if len(data) != length:
+                self.stats["sizeErrors"] += 1
+                return
+            if rxType == TYPE_DELTA:
+                self._delta(objId, instId, data, timestamp)
+            else:
+                self._object(objId, instId, data, timestamp)
+            offset += RECORD_HEADER_LENGTH + length
+
+    def scan(self, buffer, timestamp=0):
+        """Decode the frames of a bytearray, returns the number of bytes consumed"""
+        pos = 0
+        length = len(buffer)
+        while pos < length:
+            pos = buffer.find(b"\x3c", pos)
+            if pos < 0:
+                return length
+            if length - pos < 4:
+                return pos
+            version = buffer[pos + 1] & VERSION_MASK
+            rxType = buffer[pos + 1] & TYPE_MASK
+            size = buffer[pos + 2] | (buffer[pos + 3] << 8)
+            if version == VERSION and HEADER_LENGTH <= size <= HEADER_LENGTH + MAX_PAYLOAD_LENGTH:
+                if length - pos < size + 1:
+                    return pos
+                if self._crc8(buffer[pos:pos + size]) != buffer[pos + size]:
+                    self.stats["crcErrors"] += 1
+                    pos += 1
+                    continue
+                self.stats["frames"] += 1
+                if rxType in (TYPE_OBJ, TYPE_OBJ_ACK):
+                    objId, instId = struct.unpack_from("<IH", buffer, pos + 4)
+                    self._object(objId, instId, buffer[pos + HEADER_LENGTH:pos + size], timestamp)
+                pos += size + 1
+            elif version == VERSION2 and HEADER_LENGTH_V2 <= size <= HEADER_LENGTH_V2 + MAX_PAYLOAD_LENGTH_V2:
+                if length - pos < size + 2:
+                    return pos
+                if self._crc16(buffer[pos:pos + size]) != buffer[pos + size] | (buffer[pos + size + 1] << 8):
+                    self.stats["crcErrors"] += 1
+                    pos += 1
+                    continue
+                self.stats["frames"] += 1
+                payload = buffer[pos + HEADER_LENGTH_V2:pos + size]
+                if rxType in (TYPE_OBJ, TYPE_OBJ_ACK):
+                    objId, instId = struct.unpack_from("<IH", buffer, pos + 6)
+                    self._object(objId, instId, payload, timestamp)
+                elif rxType in (TYPE_MULTI, TYPE_DELTA, TYPE_MULTI_ACK):
+                    self._records(rxType, payload, timestamp)
+                pos += size + 2
+            else:
+                pos += 1
+        return pos
+
+    def scanLog(self, buffer):
+        pending = bytearray()
+        pos = 0
+        while len(buffer) - pos >= LOG_RECORD_HEADER_LENGTH:
+            timestamp, size = struct.unpack_from("<Iq", buffer, pos)
+            if size < 1 or size > LOG_RECORD_MAX_SIZE or size > len(buffer) - pos - LOG_RECORD_HEADER_LENGTH:
+                self.stats["corruptedRecords"] += 1
+                return
+            pos += LOG_RECORD_HEADER_LENGTH
+            pending += buffer[pos:pos + size]
+            pos += size
+            del pending[:self.scan(pending, timestamp)]
+
+    def result(self):
+        objects = {}
+        for objId, (timestamps, instIds, data) in self.objects.items():
+            objects[objId] = (len(timestamps), struct.pack("<%dI" % len(timestamps), *timestamps),
+                              struct.pack("<%dH" % len(instIds), *instIds), b"".join(data))
+        return objects, self.stats
+
+
+def decode(data, sizes, log=False):
+    """
+    Decode the UAVTalk frames of a buffer (a .opl log when log is True), see _logdecoder.decode()
+    """
+    if _logdecoder is not None:
+        return _logdecoder.decode(data, sizes, log)
+    decoder = _PythonDecoder(sizes)
+    if log:
+        decoder.scanLog(bytearray(data))
+    else:
+        decoder.scan(bytearray(data))
+    return decoder.result()
+
+
+class ObjectLog(object):
+    """
+    The updates of one object: the GCS timestamps in ms (0 for raw streams),
+    the instance ids and the serialized data of each update.
+    """
+
+    def __init__(self, obj, count, timestamps, instIds, data):
+        self.obj = obj
+        self.count = count
+        self.timestamps = timestamps
+        self.instIds = instIds
+        self.data = data
+
+    def __len__(self):
+        return self.count
+
+    def dtype(self):
+        """numpy dtype of one update, from the field definitions of the object"""
+        names = []
+        fields = []
+        for n, field in enumerate(self.obj.fields):
+            name = field.name if field.name else "Field%d" % n
+            if field.numElements > 1:
+                fields.append((name, _DTYPES[field.ftype], (field.numElements,)))
+            else:
+                fields.append((name, _DTYPES[field.ftype]))
+        return numpy.dtype(fields)
+
+    def array(self):
+        """The updates as a numpy structured array, sharing the decoded data"""
+        return numpy.frombuffer(self.data, dtype=self.dtype(), count=self.count)
+
+    def columns(self):
+        """The updates as a dict of numpy arrays, one per field plus timestamp and instId"""
+        array = self.array()
+        columns = dict((name, array[name]) for name in array.dtype.names)
+        columns["timestamp"] = numpy.frombuffer(self.timestamps, dtype="<u4", count=self.count)
+        columns["instId"] = numpy.frombuffer(self.instIds, dtype="<u2", count=self.count)
+        return columns
+
+    def objects(self):
+        """Iterate over the updates as (timestamp, instId, obj), obj being deserialized in place"""
+        size = self.obj.getSerialisedSize()
+        timestamps = struct.unpack("<%dI" % self.count, self.timestamps)
+        instIds = struct.unpack("<%dH" % self.count, self.instIds)
+        for n in range(self.count):
+            self.obj.deserialize(bytearray(self.data[n * size:(n + 1) * size]))
+            yield timestamps[n], instIds[n], self.obj
+
+
+class LogDecoder(object):
+    """Decodes whole logs or UAVTalk streams with the object definitions of an ObjManager"""
+
+    def __init__(self, objMan):
+        self.objMan = objMan
+        self.stats = {}
+
+    def decode(self, data, log=False):
+        """
+        Decode a buffer (bytes, bytearray or mmap), a .opl log when log is True.
+        Returns a dict of ObjectLog, by object name.
+        """
+        sizes = dict((objId, obj.getSerialisedSize()) for objId, obj in self.objMan.objs.items())
+        objects, self.stats = decode(data, sizes, log)
+        logs = {}
+        for objId, columns in objects.items():
+            obj = self.objMan.getObj(objId)
+            logs[obj.name] = ObjectLog(obj, *columns)
+        return logs
+
+    def decodeFile(self, fileName, log=None):
+        """Decode a file, a .opl log unless log is False or the file name tells otherwise"""
+        if log is None:
+            log = fileName.lower().endswith(LOG_SUFFIX)
+        with open(fileName, "rb") as f:
+            if os.fstat(f.fileno()).st_size == 0:
+                return {}
+            data = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+            try:
+                return self.decode(data, log)
+            finally:
+                data.close()
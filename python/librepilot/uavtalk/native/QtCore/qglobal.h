@@ -0,0 +1,23 @@
+/*
+ * Minimal stand-in for the Qt global header, so that the GCS CRC code
+ * (ground/gcs/src/libs/utils/crc.cpp) builds into the python extension
+ * without Qt.
+ */
+#ifndef QGLOBAL_H
+#define QGLOBAL_H
+
+#include <stdint.h>
+
+typedef int8_t qint8;
+typedef uint8_t quint8;
+typedef int16_t qint16;
+typedef uint16_t quint16;
+typedef int32_t qint32;
+typedef uint32_t quint32;
+typedef int64_t qint64;
+typedef uint64_t quint64;
+
+#define Q_DECL_EXPORT
+#define Q_DECL_IMPORT
+
+#endif // QGLOBAL_H
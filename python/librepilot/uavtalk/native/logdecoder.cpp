@@ -0,0 +1,400 @@
+/*
+ * @file       logdecoder.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Native UAVTalk log decoder, see librepilot/uavtalk/logdecoder.py
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <string.h>
+#include <map>
+#include <string>
+
+#include "crc.h"
+
+using namespace Utils;
+
+namespace {
+// Same framing as the GCS uavtalk plugin (uavtalk.h)
+const quint8 SYNC_VAL       = 0x3C;
+const quint8 VERSION_MASK   = 0xF8;
+const quint8 TYPE_VER       = 0x20;
+const quint8 TYPE_VER_V2    = 0x40;
+const quint8 TYPE_MASK      = 0x07;
+const quint8 TYPE_OBJ       = 0x00;
+const quint8 TYPE_OBJ_ACK   = 0x02;
+const quint8 TYPE_MULTI     = 0x05;
+const quint8 TYPE_DELTA     = 0x06;
+const quint8 TYPE_MULTI_ACK = 0x07;
+const int HEADER_LENGTH         = 10;
+const int HEADER_LENGTH_V2      = 12;
+const int MAX_PAYLOAD_LENGTH    = 255;
+const int MAX_PAYLOAD_LENGTH_V2 = 1024;
+const int CHECKSUM_LENGTH       = 1;
+const int CHECKSUM_LENGTH_V2    = 2;
+const int RECORD_HEADER_LENGTH  = 8;
+
+// .opl log records: timestamp (4), data size (8), data
+const int LOG_RECORD_HEADER_LENGTH = 12;
+const qint64 LOG_RECORD_MAX_SIZE   = 1024 * 1024;
+
+inline quint16 le16(const quint8 *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+inline quint32 le32(const quint8 *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((quint32)p[3] << 24);
+}
+
+inline void append16(std::string &s, quint16 v)
+{
+    char b[2] = { (char)(v & 0xFF), (char)(v >> 8) };
+
+    s.append(b, 2);
+}
+
+inline void append32(std::string &s, quint32 v)
+{
+    char b[4] = { (char)(v & 0xFF), (char)((v >> 8) & 0xFF), (char)((v >> 16) & 0xFF), (char)(v >> 24) };
+
+    s.append(b, 4);
+}
+
+/**
+ * The updates of one object, as columns: timestamps (uint32),
+ * instance ids (uint16) and the serialized data, all little endian
+ */
+struct ObjectColumns {
+    int size;
+    Py_ssize_t count;
+    std::string timestamps;
+    std::string instIds;
+    std::string data;
+};
+
+struct Decoder {
+    std::map<quint32, ObjectColumns> objects;
+    // last state of the objects updated by deltas, empty until a full update is seen
+    std::map<quint64, std::string> bases;
+
+    Py_ssize_t frames;
+    Py_ssize_t crcErrors;
+    Py_ssize_t sizeErrors;
+    Py_ssize_t unknownObjects;
+    Py_ssize_t deltaErrors;
+    Py_ssize_t corruptedRecords;
+
+    Decoder() : frames(0), crcErrors(0), sizeErrors(0), unknownObjects(0), deltaErrors(0), corruptedRecords(0)
+    {}
+
+    static quint64 key(quint32 objId, quint16 instId)
+    {
+        return ((quint64)objId << 16) | instId;
+    }
+
+    void object(quint32 objId, quint16 instId, const quint8 *data, int length, quint32 timestamp)
+    {
+        std::map<quint32, ObjectColumns>::iterator obj = objects.find(objId);
+
+        if (obj == objects.end()) {
+            unknownObjects++;
+            return;
+        }
+        if (obj->second.size != length) {
+            sizeErrors++;
+            return;
+        }
+        obj->second.count++;
+        append32(obj->second.timestamps, timestamp);
+        append16(obj->second.instIds, instId);
+        obj->second.data.append((const char *)data, length);
+
+        std::map<quint64, std::string>::iterator base = bases.find(key(objId, instId));
+        if (base != bases.end()) {
+            base->second.assign((const char *)data, length);
+        }
+    }
+
+    // same checks as UAVTalk::receiveDeltaV2() and UAVTalk::applyDelta()
+    void delta(quint32 objId, quint16 instId, const quint8 *data, int length, quint32 timestamp)
+    {
+        std::map<quint32, ObjectColumns>::iterator obj = objects.find(objId);
+
+        if (obj == objects.end()) {
+            unknownObjects++;
+            return;
+        }
+        std::map<quint64, std::string>::iterator base = bases.find(key(objId, instId));
+        if (base == bases.end()) {
+            // track that object from now on, the next full update is the base
+            bases.insert(std::make_pair(key(objId, instId), std::string()));
+            deltaErrors++;
+            return;
+        }
+        std::string state = base->second;
+        int stateLength   = (int)state.size();
+        bool valid = stateLength == obj->second.size && length >= 1
+                     && Crc::updateCRC(0, (const quint8 *)state.data(), stateLength) == data[0];
+        int pos    = 0;
+        int i      = 1;
+        while (valid && i < length) {
+            if (length - i < 2) {
+                valid = false;
+                break;
+            }
+            pos += data[i];
+            int changed = data[i + 1];
+            i += 2;
+            if (pos + changed > stateLength || i + changed > length) {
+                valid = false;
+                break;
+            }
+            for (int n = 0; n < changed; ++n) {
+                state[pos++] ^= data[i++];
+            }
+        }
+        if (!valid) {
+            deltaErrors++;
+            return;
+        }
+        object(objId, instId, (const quint8 *)state.data(), stateLength, timestamp);
+    }
+
+    void records(quint8 type, const quint8 *payload, int length, quint32 timestamp)
+    {
+        int offset = 0;
+
+        while (offset < length) {
+            const quint8 *record = payload + offset;
+            if (length - offset < RECORD_HEADER_LENGTH
+                || offset + RECORD_HEADER_LENGTH + le16(&record[6]) > length) {
+                sizeErrors++;
+                return;
+            }
+            int recordLength = le16(&record[6]);
+            if (type == TYPE_DELTA) {
+                delta(le32(&record[0]), le16(&record[4]), &record[RECORD_HEADER_LENGTH], recordLength, timestamp);
+            } else {
+                object(le32(&record[0]), le16(&record[4]), &record[RECORD_HEADER_LENGTH], recordLength, timestamp);
+            }
+            offset += RECORD_HEADER_LENGTH + recordLength;
+        }
+    }
+
+    /**
+     * Decode the frames of a buffer.
+     * \return Number of bytes consumed, the rest is the start of an incomplete frame
+     */
+    size_t scan(const quint8 *buffer, size_t length, quint32 timestamp)
+    {
+        size_t pos = 0;
+
+        while (pos < length) {
+            const quint8 *sync = (const quint8 *)memchr(buffer + pos, SYNC_VAL, length - pos);
+            if (!sync) {
+                return length;
+            }
+            pos = sync - buffer;
+            const quint8 *packet = sync;
+            size_t available     = length - pos;
+            if (available < 4) {
+                return pos;
+            }
+            quint8 version = packet[1] & VERSION_MASK;
+            int size = le16(&packet[2]);
+            if (version == TYPE_VER && size >= HEADER_LENGTH && size <= HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+                if (available < (size_t)(size + CHECKSUM_LENGTH)) {
+                    return pos;
+                }
+                if (Crc::updateCRC(0, packet, size) != packet[size]) {
+                    // probably not a frame, look for the next sync byte
+                    crcErrors++;
+                    pos++;
+                    continue;
+                }
+                frames++;
+                quint8 type = packet[1] & TYPE_MASK;
+                if (type == TYPE_OBJ || type == TYPE_OBJ_ACK) {
+                    object(le32(&packet[4]), le16(&packet[8]), &packet[HEADER_LENGTH], size - HEADER_LENGTH, timestamp);
+                }
+                pos += size + CHECKSUM_LENGTH;
+            } else if (version == TYPE_VER_V2 && size >= HEADER_LENGTH_V2 && size <= HEADER_LENGTH_V2 + MAX_PAYLOAD_LENGTH_V2) {
+                if (available < (size_t)(size + CHECKSUM_LENGTH_V2)) {
+                    return pos;
+                }
+                if (Crc::updateCRC16(0xFFFF, packet, size) != le16(&packet[size])) {
+                    crcErrors++;
+                    pos++;
+                    continue;
+                }
+                frames++;
+                quint8 type = packet[1] & TYPE_MASK;
+                if (type == TYPE_OBJ || type == TYPE_OBJ_ACK) {
+                    object(le32(&packet[6]), le16(&packet[10]), &packet[HEADER_LENGTH_V2], size - HEADER_LENGTH_V2, timestamp);
+                } else if (type == TYPE_MULTI || type == TYPE_DELTA || type == TYPE_MULTI_ACK) {
+                    records(type, &packet[HEADER_LENGTH_V2], size - HEADER_LENGTH_V2, timestamp);
+                }
+                pos += size + CHECKSUM_LENGTH_V2;
+            } else {
+                pos++;
+            }
+        }
+        return pos;
+    }
+
+    /**
+     * Decode a .opl log, each frame gets the timestamp of the record completing it
+     */
+    void scanLog(const quint8 *buffer, size_t length)
+    {
+        std::string pending;
+        size_t pos = 0;
+
+        while (length - pos >= (size_t)LOG_RECORD_HEADER_LENGTH) {
+            quint32 timestamp = le32(&buffer[pos]);
+            qint64 size = (qint64)le32(&buffer[pos + 4]) | ((qint64)le32(&buffer[pos + 8]) << 32);
+            if (size < 1 || size > LOG_RECORD_MAX_SIZE || (size_t)size > length - pos - LOG_RECORD_HEADER_LENGTH) {
+                // same limits as the GCS replay, the rest of the log is unusable
+                corruptedRecords++;
+                return;
+            }
+            const quint8 *data = &buffer[pos + LOG_RECORD_HEADER_LENGTH];
+            pos += LOG_RECORD_HEADER_LENGTH + size;
+            if (pending.empty()) {
+                // frames are usually complete within a record, only keep the tail
+                size_t consumed = scan(data, size, timestamp);
+                pending.assign((const char *)data + consumed, size - consumed);
+            } else {
+                pending.append((const char *)data, size);
+                size_t consumed = scan((const quint8 *)pending.data(), pending.size(), timestamp);
+                pending.erase(0, consumed);
+            }
+        }
+    }
+};
+
+PyObject *bytes(const std::string &s)
+{
+    return PyBytes_FromStringAndSize(s.data(), s.size());
+}
+
+bool setItem(PyObject *dict, const char *name, Py_ssize_t value)
+{
+    PyObject *v = PyLong_FromSsize_t(value);
+    bool ok     = v && PyDict_SetItemString(dict, name, v) == 0;
+
+    Py_XDECREF(v);
+    return ok;
+}
+
+const char decodeDoc[] =
+    "decode(data, sizes, log) -> (objects, stats)\n\n"
+    "Decode the UAVTalk frames (v1 and v2) of a buffer, a .opl log when log is true.\n"
+    "sizes maps the known object ids to their serialized size. objects maps the ids\n"
+    "of the objects received to (count, timestamps, instIds, data), the columns being\n"
+    "little endian uint32, uint16 and the serialized objects.";
+
+PyObject *decode(PyObject *, PyObject *args)
+{
+    Py_buffer buffer;
+    PyObject *sizes;
+    int log = 0;
+
+    if (!PyArg_ParseTuple(args, "s*O!|i:decode", &buffer, &PyDict_Type, &sizes, &log)) {
+        return NULL;
+    }
+
+    Decoder decoder;
+    PyObject *key;
+    PyObject *value;
+    Py_ssize_t i = 0;
+    while (PyDict_Next(sizes, &i, &key, &value)) {
+        ObjectColumns obj;
+        quint32 objId = (quint32)PyLong_AsUnsignedLong(key);
+        obj.size  = (int)PyLong_AsLong(value);
+        obj.count = 0;
+        if (PyErr_Occurred()) {
+            PyBuffer_Release(&buffer);
+            return NULL;
+        }
+        decoder.objects[objId] = obj;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    if (log) {
+        decoder.scanLog((const quint8 *)buffer.buf, buffer.len);
+    } else {
+        decoder.scan((const quint8 *)buffer.buf, buffer.len, 0);
+    }
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&buffer);
+
+    PyObject *objects = PyDict_New();
+    PyObject *stats   = PyDict_New();
+    bool ok = objects && stats;
+    for (std::map<quint32, ObjectColumns>::const_iterator obj = decoder.objects.begin(); ok && obj != decoder.objects.end(); ++obj) {
+        if (obj->second.count == 0) {
+            continue;
+        }
+        PyObject *objId   = PyLong_FromUnsignedLong(obj->first);
+        PyObject *columns = Py_BuildValue("(nNNN)", obj->second.count, bytes(obj->second.timestamps),
+                                          bytes(obj->second.instIds), bytes(obj->second.data));
+        ok = objId && columns && PyDict_SetItem(objects, objId, columns) == 0;
+        Py_XDECREF(objId);
+        Py_XDECREF(columns);
+    }
+    ok = ok && setItem(stats, "frames", decoder.frames)
+         && setItem(stats, "crcErrors", decoder.crcErrors)
+         && setItem(stats, "sizeErrors", decoder.sizeErrors)
+         && setItem(stats, "unknownObjects", decoder.unknownObjects)
+         && setItem(stats, "deltaErrors", decoder.deltaErrors)
+         && setItem(stats, "corruptedRecords", decoder.corruptedRecords);
+    if (!ok) {
+        Py_XDECREF(objects);
+        Py_XDECREF(stats);
+        return NULL;
+    }
+    return Py_BuildValue("(NN)", objects, stats);
+}
+
+PyMethodDef methods[] = {
+    { "decode", decode, METH_VARARGS, decodeDoc },
+    { NULL,     NULL,   0,            NULL      }
+};
+}
+
+#if PY_MAJOR_VERSION >= 3
+static struct PyModuleDef module = {
+    PyModuleDef_HEAD_INIT, "_logdecoder", "Native UAVTalk log decoder", -1, methods, NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit__logdecoder(void)
+{
+    return PyModule_Create(&module);
+}
+#else
+PyMODINIT_FUNC init_logdecoder(void)
+{
+    Py_InitModule3("_logdecoder", methods, "Native UAVTalk log decoder");
+}
+#endif
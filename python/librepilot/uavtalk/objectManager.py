@@ -31,6 +31,7 @@ import logging
 import sys
 import os
 import inspect
+import time
 
 from librepilot.uavtalk.uavobject import *
 
@@ -42,6 +43,7 @@ class ObjManager(object):
     
     def __init__(self, uavTalk):
         self.objs = {}
+        self.objsByName = {}
         self.uavTalk = uavTalk
         uavTalk.setObjMan(self)
         
@@ -49,6 +51,8 @@ class ObjManager(object):
     def addObj(self, obj):
         obj.objMan = self
         self.objs[obj.objId] = obj
+        if obj.name is not None:
+            self.objsByName[obj.name] = obj
         
     def getObj(self, objId):
         try:
@@ -57,10 +61,7 @@ class ObjManager(object):
             return None
         
     def getObjByName(self, name):
-        for objId, obj in self.objs.items():
-            if obj.name == name:
-                return obj
-        return None
+        return self.objsByName.get(name)
         
     def importDefinitions(self, uavObjDefPath=None):
         # when the uavObjDefPath is nor defined, assume it is installed together with this module
@@ -95,10 +96,10 @@ class ObjManager(object):
         
     def objUpdate(self, obj, rxData):
         obj.deserialize(rxData)
-        obj.updateCnt += 1
         for observer in obj.observers:
             observer.call(obj)
         obj.updateEvent.acquire()
+        obj.updateCnt += 1
         obj.updateEvent.notifyAll()
         obj.updateEvent.release()
         
@@ -106,37 +107,55 @@ class ObjManager(object):
         logging.debug("Requesting %s" % obj)
         self.uavTalk.sendObjReq(obj)
         
+    def _waitUpdateCnt(self, obj, cnt, deadline):
+        # the count is checked under the lock, an update arriving before we wait is not missed
+        obj.updateEvent.acquire()
+        try:
+            while obj.updateCnt == cnt:
+                remaining = deadline - time.time()
+                if remaining <= 0:
+                    return False
+                obj.updateEvent.wait(remaining)
+            return True
+        finally:
+            obj.updateEvent.release()
+
     def waitObjUpdate(self, obj, request=True, timeout=.5):
         logging.debug("Waiting for %s " % obj)
         cnt = obj.updateCnt
         if request:
             self.requestObjUpdate(obj)
-        obj.updateEvent.acquire()
-        obj.updateEvent.wait(timeout)
-        obj.updateEvent.release()
-        timeout = (cnt == obj.updateCnt)
+        updated = self._waitUpdateCnt(obj, cnt, time.time() + timeout)
         logging.debug("-> Waiting for %s Done. " % (obj))
-        if timeout:
+        if not updated:
             s = "Timeout waiting for %s" % obj
             logging.debug(s)
             raise TimeoutException(s)
+
+    def waitObjUpdates(self, objs, request=True, timeout=.5):
+        # sends all the requests before waiting, so they are served in one go instead of
+        # one round trip each, returns the objects which were not updated within timeout
+        counts = [(obj, obj.updateCnt) for obj in objs]
+        if request:
+            for obj in objs:
+                self.requestObjUpdate(obj)
+        deadline = time.time() + timeout
+        return [obj for obj, cnt in counts if not self._waitUpdateCnt(obj, cnt, deadline)]
         
     def objLocallyUpdated(self, obj):
         # TODO: should check meta-data what to do
         self.uavTalk.sendObject(obj)
         
-    def requestAllObjUpdate(self):
-        for objId, obj in self.objs.items():
-            if not obj.isMetaData():
-                #print "GetMeta %s" % obj
-                try:
-                    logging.debug("Getting %s" % obj)
-                    self.waitObjUpdate(obj, request=True, timeout=.1)
-                    logging.debug("  Getting %s" % obj.metadata)
-                    self.waitObjUpdate(obj.metadata, request=True, timeout=.1)
-                except TimeoutException:
-                    logging.debug("  TIMEOUT")
-                    pass
+    def requestAllObjUpdate(self, timeout=1):
+        objs = [obj for obj in self.objs.values() if not obj.isMetaData()]
+        logging.debug("Getting %d objects" % len(objs))
+        for obj in self.waitObjUpdates(objs, request=True, timeout=timeout):
+            logging.debug("  TIMEOUT %s" % obj)
+        # only the metadata of objects present on the board is of interest
+        metas = [obj.metadata for obj in objs if obj.updateCnt > 0]
+        logging.debug("Getting %d metadata objects" % len(metas))
+        for obj in self.waitObjUpdates(metas, request=True, timeout=timeout):
+            logging.debug("  TIMEOUT %s" % obj)
                     
     def disableAllAutomaticUpdates(self):
 
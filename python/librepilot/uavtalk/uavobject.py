@@ -67,6 +67,9 @@ class UAVObjectField(object):
         FLOAT32 = 6
         ENUM = 7
 
+    # field name, set by the generated field classes
+    name = None
+
     def __init__(self, ftype, numElements):
 
         self.ftype = ftype
@@ -214,21 +217,29 @@ class UAVObject(object):
 
 
 class MetaFlagsField(UAVObjectField):
+    name = "Flags"
+
     def __init__(self):
         UAVObjectField.__init__(self, UAVObjectField.FType.UINT16, 1)
 
 
 class MetaFlightTelemetryUpdatePeriod(UAVObjectField):
+    name = "FlightTelemetryUpdatePeriod"
+
     def __init__(self):
         UAVObjectField.__init__(self, UAVObjectField.FType.UINT16, 1)
 
 
 class MetaGCSTelemetryUpdatePeriod(UAVObjectField):
+    name = "GCSTelemetryUpdatePeriod"
+
     def __init__(self):
         UAVObjectField.__init__(self, UAVObjectField.FType.UINT16, 1)
 
 
 class MetaLoggingUpdatePeriod(UAVObjectField):
+    name = "LoggingUpdatePeriod"
+
     def __init__(self):
         UAVObjectField.__init__(self, UAVObjectField.FType.UINT16, 1)
 
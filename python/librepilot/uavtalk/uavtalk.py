@@ -33,20 +33,31 @@ import threading
 from librepilot.uavtalk.objectManager import TimeoutException
 
 SYNC = 0x3C
-VERSION_MASK = 0xFC
+VERSION_MASK = 0xF8
 VERSION = 0x20
-TYPE_MASK  = 0x03
+VERSION2 = 0x40 # v2 framing, negotiated (see UavTalk)
+TYPE_MASK  = 0x07
 TYPE_OBJ = 0x00
 TYPE_OBJ_REQ = 0x01
 TYPE_OBJ_ACK = 0x02
 TYPE_ACK = 0x03
 TYPE_NACK = 0x04
+TYPE_MULTI = 0x05 # v2 only, several TYPE_OBJ updates in one frame
 
 HEADER_LENGTH = 10 # sync(1), type (1), size(2), object ID (4), instance ID(2 )
+HEADER_LENGTH_V2 = 12 # sync(1), type (1), size(2), sequence(2), object ID (4), instance ID(2 )
 
 MAX_PAYLOAD_LENGTH = 255
+MAX_PAYLOAD_LENGTH_V2 = 1024
 CHECKSUM_LENGTH = 1
+CHECKSUM_LENGTH_V2 = 2 # CRC-16/CCITT, little endian
 MAX_PACKET_LENGTH = (HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH)
+
+RECORD_HEADER_LENGTH = 8 # multi object record: object ID (4), instance ID (2), data length (2)
+
+# the v2 probe (a NACK of object 0) is repeated until the peer answers in v2
+V2_PROBE_PERIOD = 1.0
+V2_PROBE_COUNT = 10
     
 
         
@@ -99,6 +110,39 @@ class Crc(object):
     def addList(self, values):
         for v in values:
             self.add(v)
+
+
+class Crc16(object):
+    """CRC-16/CCITT (polynomial 0x1021, not reflected) used by the v2 framing"""
+
+    crcTable = None
+
+    def __init__(self):
+        if Crc16.crcTable is None:
+            table = []
+            for b in range(256):
+                crc = b << 8
+                for bit in range(8):
+                    if crc & 0x8000:
+                        crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+                    else:
+                        crc = (crc << 1) & 0xFFFF
+                table.append(crc)
+            Crc16.crcTable = tuple(table)
+        self.reset()
+
+    def reset(self):
+        self.crc = 0xFFFF
+
+    def read(self):
+        return self.crc
+
+    def add(self, value):
+        self.crc = ((self.crc << 8) & 0xFFFF) ^ Crc16.crcTable[((self.crc >> 8) ^ value) & 0xFF]
+
+    def addList(self, values):
+        for v in values:
+            self.add(v)
         
         
 class UavTalkRecThread(threading.Thread):
@@ -109,12 +153,15 @@ class UavTalkRecThread(threading.Thread):
     STATE_INSTID = 4
     STATE_DATA = 5
     STATE_CS = 6
+    STATE_SEQ = 7 # v2 only, between size and object ID
     
     def __init__(self, uavTalk):
         threading.Thread.__init__(self)
         self.uavTalk = uavTalk
         self.rxState = self.STATE_SYNC
         self.rxCrc = Crc()
+        self.rxCrc16 = Crc16()
+        self.rxV2 = False
         self.stop = False
         
     def run(self):
@@ -143,18 +190,24 @@ class UavTalkRecThread(threading.Thread):
                 
     def _consumeByte(self, rx):
         self.rxCrc.add(rx)        
+        if self.rxState != UavTalkRecThread.STATE_CS:
+            self.rxCrc16.add(rx)
         
         if self.rxState == UavTalkRecThread.STATE_SYNC:
             if rx == SYNC:
                 self.rxCrc.reset(rx)       
+                self.rxCrc16.reset()
+                self.rxCrc16.add(rx)
                 self.rxState += 1
 #            else:
 #                logging.warning("NoSync")
                 
         elif self.rxState == UavTalkRecThread.STATE_TYPE:
-            if (rx & VERSION_MASK != VERSION):
-                self.rxState == UavTalkRecThread.STATE_SYNC
+            version = rx & VERSION_MASK
+            if version != VERSION and version != VERSION2:
+                self.rxState = UavTalkRecThread.STATE_SYNC
             else:
+                self.rxV2 = (version == VERSION2)
                 self.rxType = rx & TYPE_MASK
                 self.rxCount = 0
                 self.rxSize = 0
@@ -167,14 +220,30 @@ class UavTalkRecThread(threading.Thread):
             
             if self.rxCount == 2:    
                 # Received complete packet size, check for valid packet size
-                if (self.rxSize < HEADER_LENGTH) or (self.rxSize > HEADER_LENGTH + MAX_PAYLOAD_LENGTH):
-                    logging.error("INVALID Packet Size. Should be: "+str(HEADER_LENGTH + self.obj.getSerialisedSize())+
-                                  " got "+str(self.rxSize) + " for obj "+str(self.obj.name))
+                if self.rxV2:
+                    headerLength, maxPayloadLength = HEADER_LENGTH_V2, MAX_PAYLOAD_LENGTH_V2
+                else:
+                    headerLength, maxPayloadLength = HEADER_LENGTH, MAX_PAYLOAD_LENGTH
+                if (self.rxSize < headerLength) or (self.rxSize > headerLength + maxPayloadLength):
+                    logging.error("INVALID Packet Size " + str(self.rxSize))
                     self.rxState = UavTalkRecThread.STATE_SYNC
+                elif self.rxV2:
+                    self.rxCount = 0
+                    self.rxSeq = 0
+                    self.rxState = UavTalkRecThread.STATE_SEQ
                 else:
                     self.rxCount = 0
                     self.rxObjId = 0
                     self.rxState = UavTalkRecThread.STATE_OBJID
+
+        elif self.rxState == UavTalkRecThread.STATE_SEQ:
+            self.rxSeq |= (rx << (8 * self.rxCount))
+            self.rxCount += 1
+
+            if self.rxCount == 2:
+                self.rxCount = 0
+                self.rxObjId = 0
+                self.rxState = UavTalkRecThread.STATE_OBJID
                     
         elif self.rxState == UavTalkRecThread.STATE_OBJID:
             self.rxObjId >>= 8
@@ -196,6 +265,16 @@ class UavTalkRecThread(threading.Thread):
 
             self.rxCount = 0
 
+            if self.rxV2:
+                # v2 frames are validated once complete, they may hold several objects
+                self.rxData = []
+                self.rxDataSize = self.rxSize - HEADER_LENGTH_V2
+                if self.rxDataSize > 0:
+                    self.rxState = UavTalkRecThread.STATE_DATA
+                else:
+                    self.rxState = UavTalkRecThread.STATE_CS
+                return
+
             # Received complete ObjID
             self.obj = self.uavTalk.objMan.getObj(self.rxObjId)
             if self.obj is not None:
@@ -210,7 +289,7 @@ class UavTalkRecThread(threading.Thread):
                     self.rxCount = 0
                     self.rxData = []
 
-                    if self.rxType == TYPE_OBJ_REQ | self.rxType == TYPE_ACK | self.rxType == TYPE_NACK:
+                    if self.rxType in (TYPE_OBJ_REQ, TYPE_ACK, TYPE_NACK):
                         self.rxDataSize = 0
 
                     if self.rxDataSize > 0:
@@ -226,17 +305,28 @@ class UavTalkRecThread(threading.Thread):
             self.rxData.append(rx)
             self.rxCount += 1
             if self.rxCount == self.rxDataSize:
+                self.rxCount = 0
                 self.rxState += 1
             #else:
             #    logging.error("Obj %x INVALID SIZE", self.rxObjId)
                 
         elif self.rxState == UavTalkRecThread.STATE_CS:
+            if self.rxV2:
+                # little endian CRC-16 of everything before it
+                if self.rxCount == 0:
+                    self.rxCs = rx
+                    self.rxCount += 1
+                    return
+                if self.rxCs | (rx << 8) != self.rxCrc16.read():
+                    logging.debug("CRC ERROR")
+                else:
+                    self.uavTalk._onReceivedFrameV2(self.rxType, self.rxSeq, self.rxObjId, self.rxData)
             # by now, the CS has been added to the CRC calc, so now the CRC calc should read 0
-            if self.rxCrc.read() != 0:
+            elif self.rxCrc.read() != 0:
                 logging.debug("CRC ERROR")
             else:
                 self.uavTalk._onRecevedPacket(self.obj, self.rxType, self.rxData)    
-                self.rxState = UavTalkRecThread.STATE_SYNC
+            self.rxState = UavTalkRecThread.STATE_SYNC
             
         else:
             logging.error("INVALID STATE")
@@ -244,12 +334,26 @@ class UavTalkRecThread(threading.Thread):
 
 
 class UavTalk(object):
+    """
+    UAVTalk link over a serial port (or reading a log file).
+
+    With v2=True the v2 framing (larger payloads, sequence numbers, CRC-16 and
+    multi object frames) is negotiated: a v2 probe is sent regularly and the link
+    switches to v2 once a v2 frame is received. v2 frames are always understood.
+    """
 
-    def __init__(self, serial, logFile):
+    def __init__(self, serial, logFile, v2=False):
         self.logFile = logFile
         self.serial = serial
         self.objMan = None
         self.txLock = threading.Lock()
+        self.v2Enabled = v2
+        self.txV2 = False
+        self.txSequence = 0
+        self.rxSequence = None
+        self.rxLostFrames = 0
+        self.v2ProbesSent = 0
+        self.v2ProbeTime = None
         
     def setObjMan(self, objMan):
         self.objMan = objMan
@@ -272,6 +376,47 @@ class UavTalk(object):
             self.sendObjectAck(obj)
             
         self.objMan.objUpdate(obj, rxData)
+
+    def _onReceivedFrameV2(self, rxType, sequence, objId, rxData):
+        # count the frames lost since the previous one
+        if self.rxSequence is not None:
+            self.rxLostFrames += (sequence - self.rxSequence) & 0xFFFF
+        self.rxSequence = (sequence + 1) & 0xFFFF
+
+        if self.v2Enabled and not self.txV2:
+            logging.info("Peer supports v2 framing, switching to v2")
+            self.txV2 = True
+
+        if rxType == TYPE_MULTI:
+            offset = 0
+            while offset < len(rxData):
+                record = rxData[offset:offset + RECORD_HEADER_LENGTH]
+                if len(record) < RECORD_HEADER_LENGTH:
+                    logging.error("Truncated multi object frame")
+                    break
+                recObjId = record[0] | (record[1] << 8) | (record[2] << 16) | (record[3] << 24)
+                length = record[6] | (record[7] << 8)
+                data = rxData[offset + RECORD_HEADER_LENGTH:offset + RECORD_HEADER_LENGTH + length]
+                if len(data) != length:
+                    logging.error("Truncated multi object frame")
+                    break
+                self._onReceivedObject(TYPE_OBJ, recObjId, data)
+                offset += RECORD_HEADER_LENGTH + length
+        elif rxType == TYPE_NACK and objId == 0:
+            # v2 probe
+            pass
+        else:
+            self._onReceivedObject(rxType, objId, rxData)
+
+    def _onReceivedObject(self, rxType, objId, rxData):
+        obj = self.objMan.getObj(objId)
+        if obj is None:
+            logging.warning("Rec UNKNOWN Obj %x", objId)
+        elif rxType in (TYPE_OBJ, TYPE_OBJ_ACK) and len(rxData) != obj.getSerialisedSize():
+            logging.error("packet Size MISMATCH. Should be: " + str(obj.getSerialisedSize()) +
+                          " got " + str(len(rxData)) + " for obj " + str(obj.name))
+        else:
+            self._onRecevedPacket(obj, rxType, rxData)
          
     def sendObjReq(self, obj):
         self._sendpacket(TYPE_OBJ_REQ, obj.objId)
@@ -291,6 +436,17 @@ class UavTalk(object):
         # logging.debug("Enter lock " + str(obj_type) + " " + name)
         self.txLock.acquire()
         try:
+            if self.v2Enabled and not self.txV2 and self.v2ProbesSent < V2_PROBE_COUNT and \
+               (self.v2ProbeTime is None or time.time() - self.v2ProbeTime >= V2_PROBE_PERIOD):
+                # let the peer know we speak v2
+                self._sendframeV2(TYPE_NACK, 0)
+                self.v2ProbeTime = time.time()
+                self.v2ProbesSent += 1
+
+            if self.txV2:
+                self._sendframeV2(obj_type, obj_id, data)
+                return
+
             header = [SYNC, obj_type | VERSION, 0, 0, 0, 0, 0, 0, 0, 0]
             length = HEADER_LENGTH
             if data is not None:
@@ -313,3 +469,25 @@ class UavTalk(object):
         finally:
             self.txLock.release()
         # logging.debug("Released lock " + str(obj_type) + " " + name)
+
+    def _sendframeV2(self, obj_type, obj_id, data=None):
+        # called with txLock held
+        length = HEADER_LENGTH_V2
+        if data is not None:
+            length += len(data)
+        header = [SYNC, obj_type | VERSION2, length & 0xFF, (length >> 8) & 0xFF,
+                  self.txSequence & 0xFF, (self.txSequence >> 8) & 0xFF, 0, 0, 0, 0, 0, 0]
+        self.txSequence = (self.txSequence + 1) & 0xFFFF
+        for i in xrange(6, 10):
+            header[i] = obj_id & 0xff
+            obj_id >>= 8
+
+        crc = Crc16()
+        crc.addList(header)
+        self.serial.write("".join(map(chr, header)))
+
+        if data is not None:
+            crc.addList(data)
+            self.serial.write("".join(map(chr, data)))
+
+        self.serial.write(chr(crc.read() & 0xFF) + chr(crc.read() >> 8))
@@ -1,9 +1,20 @@
-from distutils.core import setup
+from distutils.core import setup, Extension
 import glob
 
+# native log decoder, sharing the CRC code of the GCS (built without Qt,
+# see native/QtCore/qglobal.h), the python version is used when it fails to build
+logdecoder = Extension('librepilot.uavtalk._logdecoder',
+                       sources=['librepilot/uavtalk/native/logdecoder.cpp',
+                                '../ground/gcs/src/libs/utils/crc.cpp'],
+                       include_dirs=['librepilot/uavtalk/native',
+                                     '../ground/gcs/src/libs/utils'],
+                       define_macros=[('QTCREATOR_UTILS_STATIC_LIB', None)],
+                       optional=True)
+
 setup(name='LibrePilot UAVTalk',
       version='1.0',
       description='LibrePilot UAVTalk',
       url='http://www.librepilot.org',
       packages=['librepilot', 'librepilot.uavtalk', 'librepilot.uavobjects'],
+      ext_modules=[logdecoder],
      )